@@ -150,6 +150,39 @@
 #define U_ATOMIC_DECREMENT(pPtr) __atomic_fetch_sub(pPtr, 1, __ATOMIC_SEQ_CST)
 #endif
 
+/** U_ATOMIC_GET_ACQUIRE: return the value of a variable atomically,
+ * such that no memory access which follows it in the code can be
+ * moved ahead of it; use this, in conjunction with
+ * U_ATOMIC_SET_RELEASE(), to hand data from one thread to another
+ * without a mutex.  The variable should be declared volatile.
+ */
+#ifdef _MSC_VER
+/** Microsoft Visual C++ definition; with the default /volatile:ms
+ * a fetch of a volatile has acquire semantics.
+ */
+# define U_ATOMIC_GET_ACQUIRE(pPtr) *pPtr
+#else
+/** Default (GCC) definition.
+ */
+#define U_ATOMIC_GET_ACQUIRE(pPtr) __atomic_load_n(pPtr, __ATOMIC_ACQUIRE)
+#endif
+
+/** U_ATOMIC_SET_RELEASE: set the value of a variable atomically,
+ * such that no memory access which precedes it in the code can be
+ * moved after it; see U_ATOMIC_GET_ACQUIRE().  The variable should
+ * be declared volatile.
+ */
+#ifdef _MSC_VER
+/** Microsoft Visual C++ definition; with the default /volatile:ms
+ * a store to a volatile has release semantics.
+ */
+# define U_ATOMIC_SET_RELEASE(pPtr, value) *pPtr = value
+#else
+/** Default (GCC) definition.
+ */
+#define U_ATOMIC_SET_RELEASE(pPtr, value) __atomic_store_n(pPtr, value, __ATOMIC_RELEASE)
+#endif
+
 /** @}*/
 
 #endif // _U_COMPILER_H_
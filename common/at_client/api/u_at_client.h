@@ -427,6 +427,36 @@ extern "C" {
 # define U_AT_CLIENT_ACTIVITY_PIN_HYSTERESIS_INTERVAL_MS 10
 #endif
 
+#ifndef U_AT_CLIENT_STATS_MAX_NUM_COMMANDS
+/** The maximum number of different AT commands for which statistics
+ * are kept, see uAtClientStatsGet().
+ */
+# define U_AT_CLIENT_STATS_MAX_NUM_COMMANDS 16
+#endif
+
+#ifndef U_AT_CLIENT_STATS_MAX_NUM_URCS
+/** The maximum number of different URCs for which statistics are
+ * kept, see uAtClientStatsGet().
+ */
+# define U_AT_CLIENT_STATS_MAX_NUM_URCS 16
+#endif
+
+#ifndef U_AT_CLIENT_STATS_PREFIX_MAX_LENGTH_BYTES
+/** The maximum length of the AT command or URC prefix by which
+ * statistics are kept, not including the null terminator; longer
+ * prefixes are truncated.
+ */
+# define U_AT_CLIENT_STATS_PREFIX_MAX_LENGTH_BYTES 15
+#endif
+
+/** The number of buckets in the response time histogram of the
+ * statistics for an AT command: bucket zero counts response times
+ * of 0 ms and bucket n counts response times from 2 ^ (n - 1) ms
+ * up to (2 ^ n) - 1 ms, the last bucket also counting anything
+ * longer.
+ */
+#define U_AT_CLIENT_STATS_HISTOGRAM_NUM_BUCKETS 16
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -477,6 +507,60 @@ typedef struct {
     int32_t code;
 } uAtClientDeviceError_t;
 
+/** The statistics for one AT command, as returned by
+ * uAtClientStatsGet(); all counts may wrap.  The mean response
+ * time is responseTotalMs divided by numResponses.
+ */
+typedef struct {
+    char prefix[U_AT_CLIENT_STATS_PREFIX_MAX_LENGTH_BYTES + 1]; /**< the command,
+                                                                     e.g. "AT+CSQ", up to
+                                                                     but not including
+                                                                     any '=' or '?'. */
+    uint32_t count;         /**< the number of times the command was started. */
+    uint32_t bytesWritten;  /**< the number of bytes written while this
+                                 command was in progress. */
+    uint32_t bytesRead;     /**< the number of bytes read while this
+                                 command was in progress. */
+    uint32_t numTimeouts;   /**< the number of times no final response
+                                 arrived within the AT timeout. */
+    uint32_t numCmeErrors;  /**< the number of +CME ERROR or +CMS ERROR
+                                 final responses. */
+    uint32_t numErrors;     /**< the number of ERROR or ABORTED final
+                                 responses. */
+    uint32_t numResponses;  /**< the number of final responses, of any
+                                 kind, for which a response time was
+                                 measured. */
+    int32_t responseMinMs;  /**< the shortest response time, measured from
+                                 uAtClientCommandStop() to the final
+                                 response; -1 if there have been none. */
+    int32_t responseMaxMs;  /**< the longest response time; -1 if there
+                                 have been none. */
+    uint32_t responseTotalMs; /**< the sum of all of the response times. */
+    uint32_t responseHistogram[U_AT_CLIENT_STATS_HISTOGRAM_NUM_BUCKETS]; /**< see
+                                                                              #U_AT_CLIENT_STATS_HISTOGRAM_NUM_BUCKETS. */
+} uAtClientStatsCommand_t;
+
+/** The statistics for one URC, as returned by uAtClientStatsGet().
+ */
+typedef struct {
+    char prefix[U_AT_CLIENT_STATS_PREFIX_MAX_LENGTH_BYTES + 1]; /**< the URC prefix,
+                                                                     e.g. "+CEREG:". */
+    uint32_t count;         /**< the number of times the URC was handled. */
+} uAtClientStatsUrc_t;
+
+/** The statistics for an AT client, as returned by
+ * uAtClientStatsGet().
+ */
+typedef struct {
+    size_t numCommands;     /**< the number of valid entries in command[]. */
+    uAtClientStatsCommand_t command[U_AT_CLIENT_STATS_MAX_NUM_COMMANDS];
+    uint32_t numCommandsNotRecorded; /**< the number of commands started
+                                          that were not recorded because
+                                          command[] was full. */
+    size_t numUrcs;         /**< the number of valid entries in urc[]. */
+    uAtClientStatsUrc_t urc[U_AT_CLIENT_STATS_MAX_NUM_URCS];
+} uAtClientStats_t;
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: INITIALISATION AND CONFIGURATION
  * -------------------------------------------------------------- */
@@ -1414,6 +1498,29 @@ void uAtClientUrcHandlerHijackExt(uAtClientHandle_t atHandle,
  */
 int32_t uAtClientUrcHandlerStackMinFree(uAtClientHandle_t atHandle);
 
+/** Get the URC matching statistics for an AT client: the number
+ * of bytes of received data that have been compared against URC
+ * prefixes and the number of times that URC matching has been
+ * attempted, both counted since the AT client was added.  URC
+ * prefixes are matched through an index built as URC handlers are
+ * set (unless U_CFG_AT_CLIENT_URC_INDEX_DISABLE is defined or
+ * there is no memory for the index, in which case each prefix is
+ * compared in turn) so the number of bytes compared per attempt
+ * should not grow with the number of URC handlers.  The counters
+ * are not reset and will wrap.
+ *
+ * @param atHandle             the handle of the AT client.
+ * @param[out] pBytesCompared  a place to put the number of bytes
+ *                             compared; may be NULL.
+ * @param[out] pMatchAttempts  a place to put the number of match
+ *                             attempts; may be NULL.
+ * @return                     zero on success else negative error
+ *                             code.
+ */
+int32_t uAtClientUrcMatchStatsGet(uAtClientHandle_t atHandle,
+                                  uint32_t *pBytesCompared,
+                                  uint32_t *pMatchAttempts);
+
 /** Make an asynchronous callback that is run in its own task
  * context with a stack size of
  * #U_AT_CLIENT_CALLBACK_TASK_STACK_SIZE_BYTES running at
@@ -1844,6 +1951,77 @@ int32_t uAtClientGetAti(uAtClientHandle_t atHandle,
                         char *pBuffer,
                         size_t lengthBytes);
 
+/** Get the number of bytes that have been read into the receive
+ * buffer of an AT client and the number of bytes that have been
+ * moved around within it, e.g. when the unread data is moved
+ * down to the start of the buffer, since the AT client was added.
+ * Dividing each by the time over which the traffic flowed gives
+ * bytes moved per second of traffic.  Only available if
+ * U_CFG_AT_CLIENT_MEASURE_BYTES_MOVED is defined, since counting
+ * costs a little on every move.  The counters are not reset and
+ * will wrap.
+ *
+ * @param atHandle            the handle of the AT client.
+ * @param[out] pBytesRead     a place to put the number of bytes
+ *                            read into the receive buffer; may
+ *                            be NULL.
+ * @param[out] pBytesMoved    a place to put the number of bytes
+ *                            moved within the receive buffer;
+ *                            may be NULL.
+ * @return                    zero on success else negative error
+ *                            code; #U_ERROR_COMMON_NOT_SUPPORTED if
+ *                            U_CFG_AT_CLIENT_MEASURE_BYTES_MOVED is
+ *                            not defined.
+ */
+int32_t uAtClientReceiveBytesMovedGet(uAtClientHandle_t atHandle,
+                                      uint32_t *pBytesRead,
+                                      uint32_t *pBytesMoved);
+
+/** Get the statistics for an AT client: for each AT command (up
+ * to #U_AT_CLIENT_STATS_MAX_NUM_COMMANDS of them), how many times
+ * it was sent, the bytes written and read, the response times and
+ * the number of timeouts and errors, and for each URC (up to
+ * #U_AT_CLIENT_STATS_MAX_NUM_URCS of them) how many times it
+ * was handled.  AT commands are told apart by the string passed to
+ * uAtClientCommandStart(), up to any '=' or '?'.  The statistics
+ * are kept from the first AT command or URC handler of the AT
+ * client, or since uAtClientStatsReset() was last called, and
+ * take around 2 kbytes of heap per AT client; if this is not
+ * acceptable, define U_CFG_AT_CLIENT_STATS_DISABLE.
+ *
+ * @param atHandle     the handle of the AT client.
+ * @param[out] pStats  a place to put the statistics; cannot be NULL.
+ * @return             zero on success else negative error code;
+ *                     #U_ERROR_COMMON_NOT_SUPPORTED if
+ *                     U_CFG_AT_CLIENT_STATS_DISABLE is defined.
+ */
+int32_t uAtClientStatsGet(uAtClientHandle_t atHandle,
+                          uAtClientStats_t *pStats);
+
+/** Reset the statistics for an AT client.
+ *
+ * @param atHandle  the handle of the AT client.
+ */
+void uAtClientStatsReset(uAtClientHandle_t atHandle);
+
+/** Helper function: get a percentile of the response times of
+ * an AT command from its response time histogram, e.g. use
+ * 99 to get the 99th percentile.  Since the histogram has
+ * power-of-two buckets the value returned is the upper limit
+ * of the bucket in which the percentile falls (but no more than
+ * responseMaxMs).
+ *
+ * @param[in] pCommand  the statistics for the AT command, as
+ *                      returned by uAtClientStatsGet(); cannot
+ *                      be NULL.
+ * @param percentile    the percentile, 1 to 100.
+ * @return              the response time in milliseconds, else
+ *                      negative error code, e.g. if there have
+ *                      been no responses.
+ */
+int32_t uAtClientStatsPercentileMs(const uAtClientStatsCommand_t *pCommand,
+                                   int32_t percentile);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,204 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_AT_CLIENT_QUEUE_H_
+#define _U_AT_CLIENT_QUEUE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_at_client.h"
+
+/** \addtogroup _AT-client
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the AT client command queue API,
+ * which sits on top of the AT client API.  Rather than locking
+ * the AT client and blocking for the whole of an AT command/response
+ * sequence, a caller submits the command to the queue, along
+ * with a callback that parses the response and a callback that
+ * is called on completion, and returns immediately.  A single
+ * dispatcher task per AT client takes commands from the queue
+ * and performs them, one at a time, in order of priority and,
+ * within a priority, in the order they were submitted.  This
+ * means that, for instance, short status polls can be performed
+ * ahead of long data transfers that are already queued.
+ *
+ * Commands submitted through the queue are interleaved with any
+ * commands sent by calling the AT client API directly in the
+ * normal way, uAtClientLock() providing the serialisation.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_AT_CLIENT_QUEUE_TASK_STACK_SIZE_BYTES
+/** The stack size for the dispatcher task of an AT client command
+ * queue; the write, parse and completion callbacks are called from
+ * this task.
+ */
+# define U_AT_CLIENT_QUEUE_TASK_STACK_SIZE_BYTES U_AT_CLIENT_CALLBACK_TASK_STACK_SIZE_BYTES
+#endif
+
+#ifndef U_AT_CLIENT_QUEUE_TASK_PRIORITY
+/** The priority of the dispatcher task of an AT client command
+ * queue.
+ */
+# define U_AT_CLIENT_QUEUE_TASK_PRIORITY U_AT_CLIENT_CALLBACK_TASK_PRIORITY
+#endif
+
+#ifndef U_AT_CLIENT_QUEUE_MAX_NUM_COMMANDS
+/** The maximum number of commands that may be waiting in an AT
+ * client command queue, across all priorities.
+ */
+# define U_AT_CLIENT_QUEUE_MAX_NUM_COMMANDS 16
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** The handle of an AT client command queue.
+ */
+typedef void *uAtClientQueueHandle_t;
+
+/** The priorities that a queued command may have; commands of a
+ * higher priority are always sent before commands of a lower
+ * priority that are waiting in the queue, a command that has
+ * already been sent is not interrupted.
+ */
+typedef enum {
+    U_AT_CLIENT_QUEUE_PRIORITY_HIGH, /**< for short commands, e.g. status polls. */
+    U_AT_CLIENT_QUEUE_PRIORITY_NORMAL,
+    U_AT_CLIENT_QUEUE_PRIORITY_LOW,  /**< for long commands, e.g. data transfers. */
+    U_AT_CLIENT_QUEUE_PRIORITY_MAX_NUM
+} uAtClientQueuePriority_t;
+
+/** A command to be submitted to an AT client command queue.
+ * All of the callbacks are called from the dispatcher task of
+ * the queue and the write and parse callbacks are called while
+ * the AT client is locked, so they must not lock it again.
+ */
+typedef struct {
+    const char *pCommand; /**< the command, e.g. "AT+CSQ"; this is
+                               passed to uAtClientCommandStart()
+                               and is copied, so it need not be
+                               kept after submission. */
+    void (*pWrite) (uAtClientHandle_t atHandle, void *pParam); /**< called
+                                                                    after uAtClientCommandStart()
+                                                                    to write any parameters,
+                                                                    e.g. with uAtClientWriteInt(),
+                                                                    may be NULL. */
+    const char *pResponsePrefix; /**< the prefix of the information response,
+                                      e.g. "+CSQ:", passed to
+                                      uAtClientResponseStart(); copied,
+                                      may be NULL. */
+    int32_t (*pParse) (uAtClientHandle_t atHandle, void *pParam); /**< called
+                                                                       after uAtClientResponseStart()
+                                                                       to read the information
+                                                                       response, e.g. with
+                                                                       uAtClientReadInt(); a
+                                                                       negative return value is
+                                                                       passed to pCompletion in
+                                                                       place of the outcome of
+                                                                       uAtClientUnlock().  If NULL,
+                                                                       and pResponsePrefix is
+                                                                       NULL, only the final
+                                                                       response is waited for. */
+    void (*pCompletion) (uAtClientHandle_t atHandle, int32_t errorCode,
+                         void *pParam); /**< called when the command has
+                                             been performed, or when the
+                                             queue is closed before it
+                                             could be, with zero on success
+                                             else negative error code; may
+                                             be NULL. */
+    void *pParam;         /**< passed to each of the callbacks, may be NULL. */
+    int32_t timeoutMs;    /**< the AT timeout to use for this command, -1 for
+                               the current timeout of the AT client. */
+    uAtClientQueuePriority_t priority; /**< the priority of the command. */
+} uAtClientQueueCommand_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Open a command queue on an AT client, starting the dispatcher
+ * task for it.  There is no point in opening more than one command
+ * queue on an AT client, since the commands of each would not be
+ * prioritised against the other.  The command queue must be closed
+ * before the AT client is removed.
+ *
+ * @param atHandle  the handle of the AT client.
+ * @return          the handle of the command queue or NULL on
+ *                  failure.
+ */
+uAtClientQueueHandle_t uAtClientQueueOpen(uAtClientHandle_t atHandle);
+
+/** Close a command queue.  Any command that is being performed
+ * is allowed to complete, any commands still waiting in the queue
+ * are completed with #U_ERROR_COMMON_CANCELLED without being sent.
+ * This must not be called from one of the callbacks of a command
+ * in the queue.
+ *
+ * @param queueHandle  the handle of the command queue.
+ */
+void uAtClientQueueClose(uAtClientQueueHandle_t queueHandle);
+
+/** Submit a command to a command queue; this returns immediately,
+ * the outcome being reported through the pCompletion callback
+ * of the command.  May be called from one of the callbacks of
+ * a command in the queue.
+ *
+ * @param queueHandle   the handle of the command queue.
+ * @param[in] pCommand  the command; the structure is copied, as
+ *                      are the strings it points to, so nothing
+ *                      need be kept after submission.  Cannot be
+ *                      NULL.
+ * @return              zero on success else negative error code;
+ *                      #U_ERROR_COMMON_BUSY if there are already
+ *                      #U_AT_CLIENT_QUEUE_MAX_NUM_COMMANDS commands
+ *                      waiting in the queue.
+ */
+int32_t uAtClientQueueSubmit(uAtClientQueueHandle_t queueHandle,
+                             const uAtClientQueueCommand_t *pCommand);
+
+/** Get the number of commands waiting in a command queue, not
+ * including any command that is currently being performed.
+ *
+ * @param queueHandle  the handle of the command queue.
+ * @return             the number of commands waiting, else
+ *                     negative error code.
+ */
+int32_t uAtClientQueueGetNum(uAtClientQueueHandle_t queueHandle);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_AT_CLIENT_QUEUE_H_
+
+// End of file
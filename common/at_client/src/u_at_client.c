@@ -183,6 +183,19 @@
 # define U_AT_CLIENT_CALLBACK_QUEUE_YIELD_MS 50
 #endif
 
+#ifndef U_AT_CLIENT_RECEIVE_BUFFER_COMPACT_FREE_PERCENT
+/** The receive buffer is not compacted, i.e. the unread data
+ * moved down to the start of it, every time that something is
+ * read from it: instead the unread data is left where it is and
+ * is only moved down once the free space at the end of the
+ * buffer falls below this percentage of the buffer size, or
+ * when there is nothing left to move.  Set this to 100 to
+ * compact the buffer on every rewind, as was the behaviour
+ * in the past.
+ */
+# define U_AT_CLIENT_RECEIVE_BUFFER_COMPACT_FREE_PERCENT 50
+#endif
+
 /** Guard for the URC task data receive loop to make
  * sure it can't be drowned by the incoming stream,
  * preventing control commands from getting in.
@@ -329,9 +342,37 @@ typedef struct uAtClientUrc_t {
     size_t prefixLength;       /** The length of pPrefix. */
     void (*pHandler) (uAtClientHandle_t, void *); /** The handler to call if pPrefix is matched. */
     void *pHandlerParam;       /** The parameter to pass to pHandler. */
+    int32_t sequence;          /** Incremented for each URC added, used to
+                                   pick the most recently added URC where more
+                                   than one prefix matches. */
+    uAtClientStatsUrc_t *pStats; /** Where to count this URC, NULL if nowhere. */
     struct uAtClientUrc_t *pNext;
 } uAtClientUrc_t;
 
+/** A node in the URC prefix index, a trie built over the prefixes
+ * in the URC list so that matching a URC costs a walk along the
+ * received characters rather than a compare against every prefix.
+ * The nodes are held in a single array, node zero being the root;
+ * the children of a node are linked through nextSibling in
+ * ascending order of character.
+ */
+typedef struct {
+    char character;            /** The character this node matches. */
+    int16_t firstChild;        /** Index of the first child, -1 if none. */
+    int16_t nextSibling;       /** Index of the next sibling, -1 if none. */
+    uAtClientUrc_t *pUrc;      /** The URC whose prefix ends at this node, else NULL. */
+} uAtClientUrcIndexNode_t;
+
+/** A URC prefix index: the nodes follow this structure in the
+ * same allocation.  When the index is rebuilt the old one may
+ * still be in use by a URC match in another task; it is then
+ * kept on a list, through pRetiredNext, until it can be freed.
+ */
+typedef struct uAtClientUrcIndex_t {
+    uAtClientUrcIndexNode_t *pNode; /** The nodes, node zero being the root. */
+    struct uAtClientUrcIndex_t *pRetiredNext; /** The next retired index. */
+} uAtClientUrcIndex_t;
+
 /** The definition of a tag.
  */
 typedef struct {
@@ -418,6 +459,15 @@ typedef struct {
     uPortMutexHandle_t *pNextFree;
 } uAtClientMutexStack_t;
 
+/** The statistics for the AT command in progress.
+ */
+typedef struct {
+    uAtClientStatsCommand_t *pCommand; /** Where to record statistics for the
+                                           AT command in progress, NULL if nowhere. */
+    int32_t stopTimeMs;      /** The time at which uAtClientCommandStop() was called. */
+    bool responsePending;    /** True if the final response has not yet been recorded. */
+} uAtClientStatsInProgress_t;
+
 /** Definition of an AT client instance.
  */
 typedef struct uAtClientInstance_t {
@@ -445,6 +495,17 @@ typedef struct uAtClientInstance_t {
     uAtClientTag_t stopTag; /** The stop tag for the current scope. */
     uAtClientUrc_t *pUrcList; /** Linked-list anchor for URC handlers. */
     uAtClientUrc_t *pUrcRead;  /** Pointer used when reading the URC handlers. */
+    uAtClientUrcIndex_t *pUrcIndex; /** Prefix index over pUrcList, NULL if there is none. */
+    uAtClientUrcIndex_t *pUrcIndexRetired; /** Old indexes waiting to be freed. */
+    int32_t urcSequenceNext; /** The sequence number to give the next URC handler added. */
+    uint32_t urcBytesCompared; /** The number of bytes compared while matching URC prefixes. */
+    uint32_t urcMatchAttempts; /** The number of times URC matching has been attempted. */
+    uAtClientStats_t *pStats; /** Statistics, allocated when first needed. */
+    uAtClientStatsInProgress_t statsInProgress; /** Statistics for the AT command in progress. */
+#ifdef U_CFG_AT_CLIENT_MEASURE_BYTES_MOVED
+    uint32_t receiveBytesMoved; /** The number of bytes moved within the receive buffer. */
+    uint32_t receiveBytesRead; /** The number of bytes read into the receive buffer. */
+#endif
     uTimeoutStart_t lastResponseStop; /** The time the last response ended in milliseconds. */
     int32_t lockTimeMs; /** The time when the stream was locked. */
     uTimeoutStart_t lastTxTime; /** The time when the last transmit activity was carried out. */
@@ -838,6 +899,18 @@ static void removeAtClientInstance(const uAtClientInstance_t *pClient)
     }
 }
 
+// Free a URC prefix index and any retired after it.
+static void urcIndexFree(uAtClientUrcIndex_t *pIndex)
+{
+    uAtClientUrcIndex_t *pNext;
+
+    while (pIndex != NULL) {
+        pNext = pIndex->pRetiredNext;
+        uPortFree(pIndex);
+        pIndex = pNext;
+    }
+}
+
 // Remove an AT client.
 // gMutex should be locked before this is called.
 static void removeClient(uAtClientInstance_t *pClient)
@@ -883,12 +956,17 @@ static void removeClient(uAtClientInstance_t *pClient)
             break;
     }
 
-    // Free any URC handlers it had.
+    // Free any URC handlers it had, and the index over them.
     while (pClient->pUrcList != NULL) {
         pUrc = pClient->pUrcList;
         pClient->pUrcList = pUrc->pNext;
         uPortFree(pUrc);
     }
+    urcIndexFree(pClient->pUrcIndex);
+    urcIndexFree(pClient->pUrcIndexRetired);
+
+    // Free any statistics
+    uPortFree(pClient->pStats);
 
     // Remove any activity pin
     uPortFree(pClient->pActivityPin);
@@ -930,6 +1008,147 @@ static void removeClient(uAtClientInstance_t *pClient)
     uPortFree(pClient);
 }
 
+// Add a URC to the URC prefix index; pIndex must have room for
+// at least pUrc->prefixLength nodes beyond *pNumNodes.
+static void urcIndexAdd(uAtClientUrcIndexNode_t *pIndex, size_t *pNumNodes,
+                        uAtClientUrc_t *pUrc)
+{
+    int16_t node = 0;
+    int16_t *pLink;
+    char c;
+
+    for (size_t x = 0; x < pUrc->prefixLength; x++) {
+        c = *(pUrc->pPrefix + x);
+        // Find where c is, or should be, among the children of node
+        pLink = &(pIndex[node].firstChild);
+        while ((*pLink >= 0) && (pIndex[*pLink].character < c)) {
+            pLink = &(pIndex[*pLink].nextSibling);
+        }
+        if ((*pLink < 0) || (pIndex[*pLink].character != c)) {
+            // Not there, insert a new node
+            pIndex[*pNumNodes].character = c;
+            pIndex[*pNumNodes].firstChild = -1;
+            pIndex[*pNumNodes].nextSibling = *pLink;
+            pIndex[*pNumNodes].pUrc = NULL;
+            *pLink = (int16_t) *pNumNodes;
+            (*pNumNodes)++;
+        }
+        node = *pLink;
+    }
+    pIndex[node].pUrc = pUrc;
+}
+
+// Rebuild the URC prefix index from the URC list; urcPermittedMutex
+// should be locked before this is called.  If there is no memory
+// for the index, pUrcIndex is left as NULL and URC matching falls
+// back to walking the URC list.
+// URCs are also matched by the response paths, which hold the
+// stream mutex but not urcPermittedMutex, so the new index is
+// built before being swapped in with a single pointer store and
+// the old one is only freed if the stream mutex can be had, i.e.
+// if no match can be in progress; otherwise it is retired and
+// freed on a later rebuild or when the AT client is removed.
+static void urcIndexBuild(uAtClientInstance_t *pClient)
+{
+    uAtClientUrcIndex_t *pIndexOld = pClient->pUrcIndex;
+    uAtClientUrcIndex_t *pIndex = NULL;
+#ifndef U_CFG_AT_CLIENT_URC_INDEX_DISABLE
+    size_t numNodes = 1; // The root
+    uAtClientUrc_t *pUrc;
+
+    for (pUrc = pClient->pUrcList; pUrc != NULL; pUrc = pUrc->pNext) {
+        numNodes += pUrc->prefixLength;
+    }
+    if ((pClient->pUrcList != NULL) && (numNodes <= INT16_MAX)) {
+        pIndex = (uAtClientUrcIndex_t *) pUPortMalloc(sizeof(*pIndex) +
+                                                      (numNodes * sizeof(*(pIndex->pNode))));
+        if (pIndex != NULL) {
+            pIndex->pNode = (uAtClientUrcIndexNode_t *) (pIndex + 1);
+            pIndex->pRetiredNext = NULL;
+            pIndex->pNode->character = 0;
+            pIndex->pNode->firstChild = -1;
+            pIndex->pNode->nextSibling = -1;
+            pIndex->pNode->pUrc = NULL;
+            numNodes = 1;
+            for (pUrc = pClient->pUrcList; pUrc != NULL; pUrc = pUrc->pNext) {
+                urcIndexAdd(pIndex->pNode, &numNodes, pUrc);
+            }
+        }
+    }
+#endif
+
+    pClient->pUrcIndex = pIndex;
+    if (pIndexOld != NULL) {
+        pIndexOld->pRetiredNext = pClient->pUrcIndexRetired;
+        pClient->pUrcIndexRetired = pIndexOld;
+    }
+    if ((pClient->pUrcIndexRetired != NULL) &&
+        (uPortMutexTryLock(pClient->streamMutex, 0) == 0)) {
+        // Nothing can be matching a URC: no-one can hold an old index
+        urcIndexFree(pClient->pUrcIndexRetired);
+        pClient->pUrcIndexRetired = NULL;
+        uPortMutexUnlock(pClient->streamMutex);
+    }
+}
+
+// Find the URC whose prefix is at the start of pData using the
+// given URC prefix index, or NULL if there is none; where more than
+// one prefix matches, the most recently added URC is returned, just
+// as a walk of the URC list would do.
+static uAtClientUrc_t *pUrcIndexMatch(uAtClientInstance_t *pClient,
+                                      const uAtClientUrcIndex_t *pUrcIndex,
+                                      const char *pData, size_t length)
+{
+    const uAtClientUrcIndexNode_t *pIndex = pUrcIndex->pNode;
+    uAtClientUrc_t *pUrc = NULL;
+    int16_t node = pIndex->firstChild;
+    char c;
+
+    for (size_t x = 0; (x < length) && (node >= 0); x++) {
+        c = *(pData + x);
+        while ((node >= 0) && (pIndex[node].character < c)) {
+            pClient->urcBytesCompared++;
+            node = pIndex[node].nextSibling;
+        }
+        if (node >= 0) {
+            pClient->urcBytesCompared++;
+            if (pIndex[node].character == c) {
+                if ((pIndex[node].pUrc != NULL) &&
+                    ((pUrc == NULL) || (pIndex[node].pUrc->sequence > pUrc->sequence))) {
+                    pUrc = pIndex[node].pUrc;
+                }
+                node = pIndex[node].firstChild;
+            } else {
+                node = -1;
+            }
+        }
+    }
+
+    return pUrc;
+}
+
+// Compare the prefix of a URC with the start of pData, the
+// way it was done before there was a URC index, counting the
+// bytes compared.
+static bool urcPrefixMatch(uAtClientInstance_t *pClient,
+                           const uAtClientUrc_t *pUrc,
+                           const char *pData, size_t length)
+{
+    bool match = false;
+    size_t x = 0;
+
+    if (length >= pUrc->prefixLength) {
+        match = true;
+        while (match && (x < pUrc->prefixLength)) {
+            match = (*(pData + x) == *(pUrc->pPrefix + x));
+            x++;
+        }
+        pClient->urcBytesCompared += x;
+    }
+
+    return match;
+}
+
 // Get the next URC handler from pUrcRead.
 static int32_t urcHandlerGetNext(uAtClientInstance_t *pClient,
                                  const char **ppPrefix,
@@ -1225,12 +1444,165 @@ static void clearError(uAtClientInstance_t *pClient)
     setError(pClient, U_ERROR_COMMON_SUCCESS);
 }
 
+// Get the statistics of an AT client, allocating them if they
+// have not yet been allocated; returns NULL if there are none.
+// pClient->mutex should be locked before this is called.
+static uAtClientStats_t *pStatsGet(uAtClientInstance_t *pClient)
+{
+#ifndef U_CFG_AT_CLIENT_STATS_DISABLE
+    if (pClient->pStats == NULL) {
+        pClient->pStats = (uAtClientStats_t *) pUPortMalloc(sizeof(uAtClientStats_t));
+        if (pClient->pStats != NULL) {
+            memset(pClient->pStats, 0, sizeof(*(pClient->pStats)));
+        }
+    }
+#endif
+
+    return pClient->pStats;
+}
+
+// Copy a prefix for the statistics, stopping at any of the
+// characters in pStop and truncating as necessary.
+static void statsPrefixCopy(char *pDest, const char *pSrc,
+                           const char *pStop)
+{
+    size_t x = 0;
+
+    while ((x < U_AT_CLIENT_STATS_PREFIX_MAX_LENGTH_BYTES) &&
+           (*pSrc != 0) && (strchr(pStop, *pSrc) == NULL)) {
+        *pDest = *pSrc;
+        pDest++;
+        pSrc++;
+        x++;
+    }
+    *pDest = 0;
+}
+
+// Begin recording statistics for an AT command.
+// pClient->mutex should be locked before this is called.
+static void statsCommandStart(uAtClientInstance_t *pClient,
+                              const char *pCommand)
+{
+    uAtClientStats_t *pStats;
+    uAtClientStatsCommand_t *pCommandStats = NULL;
+    char prefix[U_AT_CLIENT_STATS_PREFIX_MAX_LENGTH_BYTES + 1];
+
+    if (pCommand != NULL) {
+        pStats = pStatsGet(pClient);
+        if (pStats != NULL) {
+            statsPrefixCopy(prefix, pCommand, "=?\r");
+            for (size_t x = 0; (pCommandStats == NULL) && (x < pStats->numCommands); x++) {
+                if (strcmp(pStats->command[x].prefix, prefix) == 0) {
+                    pCommandStats = &(pStats->command[x]);
+                }
+            }
+            if (pCommandStats == NULL) {
+                if (pStats->numCommands < sizeof(pStats->command) / sizeof(pStats->command[0])) {
+                    pCommandStats = &(pStats->command[pStats->numCommands]);
+                    pStats->numCommands++;
+                    memcpy(pCommandStats->prefix, prefix, sizeof(pCommandStats->prefix));
+                    pCommandStats->responseMinMs = -1;
+                    pCommandStats->responseMaxMs = -1;
+                } else {
+                    pStats->numCommandsNotRecorded++;
+                }
+            }
+            if (pCommandStats != NULL) {
+                pCommandStats->count++;
+            }
+        }
+    }
+
+    pClient->statsInProgress.pCommand = pCommandStats;
+    pClient->statsInProgress.responsePending = false;
+}
+
+// Get the place to count a URC in the statistics, NULL if there
+// is none. pClient->mutex should be locked before this is called.
+static uAtClientStatsUrc_t *pStatsUrcGet(uAtClientInstance_t *pClient,
+                                         const char *pPrefix)
+{
+    uAtClientStats_t *pStats = pStatsGet(pClient);
+    uAtClientStatsUrc_t *pUrcStats = NULL;
+    char prefix[U_AT_CLIENT_STATS_PREFIX_MAX_LENGTH_BYTES + 1];
+
+    if (pStats != NULL) {
+        statsPrefixCopy(prefix, pPrefix, "");
+        for (size_t x = 0; (pUrcStats == NULL) && (x < pStats->numUrcs); x++) {
+            if (strcmp(pStats->urc[x].prefix, prefix) == 0) {
+                pUrcStats = &(pStats->urc[x]);
+            }
+        }
+        if ((pUrcStats == NULL) &&
+            (pStats->numUrcs < sizeof(pStats->urc) / sizeof(pStats->urc[0]))) {
+            pUrcStats = &(pStats->urc[pStats->numUrcs]);
+            pStats->numUrcs++;
+            memcpy(pUrcStats->prefix, prefix, sizeof(pUrcStats->prefix));
+        }
+    }
+
+    return pUrcStats;
+}
+
+// Record the final response to an AT command in the statistics.
+static void statsResponse(uAtClientInstance_t *pClient,
+                          uAtClientDeviceErrorType_t errorType)
+{
+    uAtClientStatsInProgress_t *pInProgress = &(pClient->statsInProgress);
+    uAtClientStatsCommand_t *pCommandStats = pInProgress->pCommand;
+    int32_t durationMs;
+    size_t bucket = 0;
+
+    if ((pCommandStats != NULL) && pInProgress->responsePending) {
+        durationMs = uPortGetTickTimeMs() - pInProgress->stopTimeMs;
+        if (durationMs < 0) {
+            durationMs = 0;
+        }
+        pCommandStats->numResponses++;
+        pCommandStats->responseTotalMs += (uint32_t) durationMs;
+        if ((pCommandStats->responseMinMs < 0) ||
+            (durationMs < pCommandStats->responseMinMs)) {
+            pCommandStats->responseMinMs = durationMs;
+        }
+        if (durationMs > pCommandStats->responseMaxMs) {
+            pCommandStats->responseMaxMs = durationMs;
+        }
+        // The bucket is the number of bits in the duration
+        while ((durationMs > 0) &&
+               (bucket < U_AT_CLIENT_STATS_HISTOGRAM_NUM_BUCKETS - 1)) {
+            durationMs >>= 1;
+            bucket++;
+        }
+        pCommandStats->responseHistogram[bucket]++;
+        switch (errorType) {
+            case U_AT_CLIENT_DEVICE_ERROR_TYPE_CME:
+            case U_AT_CLIENT_DEVICE_ERROR_TYPE_CMS:
+                pCommandStats->numCmeErrors++;
+                break;
+            case U_AT_CLIENT_DEVICE_ERROR_TYPE_ERROR:
+            case U_AT_CLIENT_DEVICE_ERROR_TYPE_ABORTED:
+                pCommandStats->numErrors++;
+                break;
+            default:
+                break;
+        }
+        pInProgress->responsePending = false;
+    }
+}
+
 // Increment the number of consecutive timeouts
 // and call the callback if there is one
 static void consecutiveTimeout(uAtClientInstance_t *pClient)
 {
     uAtClientCallback_t cb = {0}; // Keep Valgrind happy (otherwise the last four bytes will be uninitialised)
 
+    // Record the timeout against the AT command in progress
+    if ((pClient->statsInProgress.pCommand != NULL) &&
+        pClient->statsInProgress.responsePending) {
+        pClient->statsInProgress.pCommand->numTimeouts++;
+        pClient->statsInProgress.responsePending = false;
+    }
+
     U_PORT_MUTEX_LOCK(gMutexEventQueue);
 
     pClient->numConsecutiveAtTimeouts++;
@@ -1273,6 +1645,23 @@ static int32_t pollTimeRemaining(int32_t atTimeoutMs,
     return timeRemainingMs;
 }
 
+// Move data within the receive buffer, counting the
+// bytes moved if U_CFG_AT_CLIENT_MEASURE_BYTES_MOVED is defined.
+static void bufferMove(const uAtClientInstance_t *pClient, char *pDest,
+                       const char *pSrc, size_t length)
+{
+    if ((length > 0) && (pDest != pSrc)) {
+        memmove(pDest, pSrc, length);
+#ifdef U_CFG_AT_CLIENT_MEASURE_BYTES_MOVED
+        // Cast away the const: the counter is a statistic,
+        // not part of the state of the AT client
+        ((uAtClientInstance_t *) pClient)->receiveBytesMoved += length;
+#else
+        (void) pClient;
+#endif
+    }
+}
+
 // Zero the buffer.
 // totalReset also clears out any buffered data that
 // may be awaiting processing by a receive intercept
@@ -1308,9 +1697,9 @@ static void bufferReset(const uAtClientInstance_t *pClient,
         }
         // If there is stuff buffered, which will be beyond
         // length, need to move that down when we reset
-        memmove(((char *) pBuffer) + sizeof(uAtClientReceiveBuffer_t),
-                ((char *) pBuffer) + sizeof(uAtClientReceiveBuffer_t) + pBuffer->length,
-                pBuffer->lengthBuffered - pBuffer->length);
+        bufferMove(pClient, U_AT_CLIENT_DATA_BUFFER_PTR(pBuffer),
+                   U_AT_CLIENT_DATA_BUFFER_PTR(pBuffer) + pBuffer->length,
+                   pBuffer->lengthBuffered - pBuffer->length);
         U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pBuffer));
         pBuffer->lengthBuffered -= pBuffer->length;
     }
@@ -1318,8 +1707,12 @@ static void bufferReset(const uAtClientInstance_t *pClient,
     pBuffer->length = 0;
 }
 
-// Set the read position to 0 and move the buffer's
-// unread content to the beginning.
+// Set the read position to 0 and move the buffer's unread
+// content to the beginning, but only if there is nothing to
+// move or the free space at the end of the buffer has fallen
+// below U_AT_CLIENT_RECEIVE_BUFFER_COMPACT_FREE_PERCENT; otherwise
+// the unread content is left where it is, everything that reads
+// from the buffer working from readIndex.
 static void bufferRewind(const uAtClientInstance_t *pClient)
 {
     uAtClientReceiveBuffer_t *pBuffer = pClient->pReceiveBuffer;
@@ -1329,7 +1722,10 @@ static void bufferRewind(const uAtClientInstance_t *pClient)
 
     LOG(100);
     if ((pBuffer->readIndex > 0) &&
-        (pBuffer->length >= pBuffer->readIndex)) {
+        (pBuffer->length >= pBuffer->readIndex) &&
+        ((pBuffer->lengthBuffered <= pBuffer->readIndex) ||
+         ((pBuffer->dataBufferSize - pBuffer->lengthBuffered) * 100 <
+          pBuffer->dataBufferSize * U_AT_CLIENT_RECEIVE_BUFFER_COMPACT_FREE_PERCENT))) {
         if (pBuffer->lengthBuffered < pBuffer->readIndex) {
             // This should never occur, but if it did
             // it would not be good so best be safe.
@@ -1347,9 +1743,9 @@ static void bufferRewind(const uAtClientInstance_t *pClient)
         LOG(101);
         // Move what has not been read to the
         // beginning of the buffer
-        memmove(((char *) pBuffer) + sizeof(uAtClientReceiveBuffer_t),
-                ((char *) pBuffer) + sizeof(uAtClientReceiveBuffer_t) + pBuffer->readIndex,
-                pBuffer->lengthBuffered);
+        bufferMove(pClient, U_AT_CLIENT_DATA_BUFFER_PTR(pBuffer),
+                   U_AT_CLIENT_DATA_BUFFER_PTR(pBuffer) + pBuffer->readIndex,
+                   pBuffer->lengthBuffered);
         U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pBuffer));
         pBuffer->readIndex = 0;
         LOG(102);
@@ -1502,6 +1898,11 @@ static bool bufferFill(uAtClientInstance_t *pClient,
         }
     }
 
+    // Since the unread data is not always moved down to the
+    // start of the buffer, give bufferRewind() the chance to
+    // do that now, before we read more in
+    bufferRewind(pClient);
+
     // Reset buffer if it has become full
     if (pReceiveBuffer->lengthBuffered == pReceiveBuffer->dataBufferSize) {
         if (pClient->debugOn) {
@@ -1541,6 +1942,12 @@ static bool bufferFill(uAtClientInstance_t *pClient,
         LOG_BUFFER_FILL(4);
 
         if (readLength > 0) {
+#ifdef U_CFG_AT_CLIENT_MEASURE_BYTES_MOVED
+            pClient->receiveBytesRead += readLength;
+#endif
+            if (pClient->statsInProgress.pCommand != NULL) {
+                pClient->statsInProgress.pCommand->bytesRead += readLength;
+            }
             // lengthBuffered is advanced by the amount we have
             // read in; may not be the same as the amount of data
             // available in the buffer for the AT client as
@@ -1606,9 +2013,9 @@ static bool bufferFill(uAtClientInstance_t *pClient,
 
                     // First, move the processed stuff, "length" from pData onwards,
                     // down to join the end of the "unread" section.
-                    memmove(U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
-                            pReceiveBuffer->length + readLength,
-                            pData, length);
+                    bufferMove(pClient, U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
+                               pReceiveBuffer->length + readLength,
+                               pData, length);
                     U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pReceiveBuffer));
 
                     // We now have:
@@ -1641,9 +2048,9 @@ static bool bufferFill(uAtClientInstance_t *pClient,
                          pReceiveBuffer->lengthBuffered) - pDataIntercept;
                     LOG_BUFFER_FILL(9);
                     // Move it
-                    memmove(U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
-                            pReceiveBuffer->length + readLength + length,
-                            pDataIntercept, y);
+                    bufferMove(pClient, U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
+                               pReceiveBuffer->length + readLength + length,
+                               pDataIntercept, y);
                     U_ASSERT(U_AT_CLIENT_GUARD_CHECK(pReceiveBuffer));
                     // Lastly, we need to adjust the things that were at or
                     // beyond pDataIntercept to take account of the move.
@@ -1683,8 +2090,7 @@ static bool bufferFill(uAtClientInstance_t *pClient,
     LOG_BUFFER_FILL(15);
     if (readLength > 0) {
         printAt(pClient, U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
-                pReceiveBuffer->length + pReceiveBuffer->readIndex,
-                readLength, false);
+                pReceiveBuffer->length, readLength, false);
         pReceiveBuffer->length += readLength;
         LOG_BUFFER_FILL(16);
     }
@@ -1769,7 +2175,7 @@ static bool bufferMatch(const uAtClientInstance_t *pClient,
                                pString, length) == 0)) {
             // Consume the matching part
             readIndex += length;
-            pReceiveBuffer->readIndex += readIndex;
+            pReceiveBuffer->readIndex = readIndex;
             found = true;
         }
     }
@@ -1869,6 +2275,9 @@ static bool consumeToStopTag(uAtClientInstance_t *pClient)
         } else {
             // Otherwise consume up to the stop tag
             found = consumeToString(pClient, pClient->stopTag.pTagDef->pString);
+            if (found && (pClient->stopTag.pTagDef == &gResponseStopTag)) {
+                statsResponse(pClient, U_AT_CLIENT_DEVICE_ERROR_TYPE_NO_ERROR);
+            }
             if (!found) {
                 setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
                 if (pClient->debugOn) {
@@ -1903,44 +2312,63 @@ static void informationResponseStop(uAtClientInstance_t *pClient)
 // up to CR/LF.
 static bool bufferMatchOneUrc(uAtClientInstance_t *pClient)
 {
-    size_t prefixLength = 0;
+    uAtClientReceiveBuffer_t *pReceiveBuffer = pClient->pReceiveBuffer;
+    uAtClientUrc_t *pUrc = NULL;
+    // Read the index pointer just the once since it may be
+    // swapped by urcIndexBuild() in another task
+    const uAtClientUrcIndex_t *pUrcIndex = pClient->pUrcIndex;
+    const char *pData;
+    size_t length;
     bool found = false;
     int32_t now;
     uErrorCode_t savedError;
 
     bufferRewind(pClient);
 
-    for (uAtClientUrc_t *pUrc = pClient->pUrcList;
-         !found && (pUrc != NULL);
-         pUrc = pUrc->pNext) {
-        prefixLength = pUrc->prefixLength;
-        if (pClient->pReceiveBuffer->length >= prefixLength) {
-            // Do the check ignoring nulls at the start in case
-            // a URC is emitted near power-on which can suffer from
-            // such nulls
-            if (bufferMatch(pClient, pUrc->pPrefix, prefixLength, true)) {
-                setScope(pClient, U_AT_CLIENT_SCOPE_INFORMATION);
-                now = uPortGetTickTimeMs();
-                // Before heading off into URCness, save
-                // the current error state and reset
-                // it so that the URC doesn't suffer the error
-                savedError = pClient->error;
-                pClient->error = U_ERROR_COMMON_SUCCESS;
-                if (processAsync(pClient->magicNumber) && pUrc->pHandler) {
-                    pUrc->pHandler(pClient, pUrc->pHandlerParam);
-                }
-                informationResponseStop(pClient);
-                // Put the error state back again
-                pClient->error = savedError;
-                // Put the error state back again
-                // Add the amount of time spent in the URC
-                // world to the start time
-                pClient->lockTimeMs += uPortGetTickTimeMs() - now;
-                found = true;
+    pData = U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) + pReceiveBuffer->readIndex;
+    length = pReceiveBuffer->length - pReceiveBuffer->readIndex;
+    // Note: bufferMatch() has the option of ignoring nulls at the
+    // start but that only takes effect where there are fewer
+    // characters in the buffer than the length of the prefix,
+    // in which case there can be no match, hence it is not
+    // replicated here
+    if (pClient->pUrcList != NULL) {
+        pClient->urcMatchAttempts++;
+        if (pUrcIndex != NULL) {
+            pUrc = pUrcIndexMatch(pClient, pUrcIndex, pData, length);
+        } else {
+            pUrc = pClient->pUrcList;
+            while ((pUrc != NULL) && !urcPrefixMatch(pClient, pUrc, pData, length)) {
+                pUrc = pUrc->pNext;
             }
         }
     }
 
+    if (pUrc != NULL) {
+        if (pUrc->pStats != NULL) {
+            pUrc->pStats->count++;
+        }
+        // Consume the prefix
+        pReceiveBuffer->readIndex += pUrc->prefixLength;
+        setScope(pClient, U_AT_CLIENT_SCOPE_INFORMATION);
+        now = uPortGetTickTimeMs();
+        // Before heading off into URCness, save
+        // the current error state and reset
+        // it so that the URC doesn't suffer the error
+        savedError = pClient->error;
+        pClient->error = U_ERROR_COMMON_SUCCESS;
+        if (processAsync(pClient->magicNumber) && pUrc->pHandler) {
+            pUrc->pHandler(pClient, pUrc->pHandlerParam);
+        }
+        informationResponseStop(pClient);
+        // Put the error state back again
+        pClient->error = savedError;
+        // Add the amount of time spent in the URC
+        // world to the start time
+        pClient->lockTimeMs += uPortGetTickTimeMs() - now;
+        found = true;
+    }
+
     return found;
 }
 
@@ -2080,6 +2508,7 @@ static void setDeviceError(uAtClientInstance_t *pClient,
 
     pClient->deviceError.type = errorType;
     pClient->deviceError.code = 0;
+    statsResponse(pClient, errorType);
 
     if ((errorType == U_AT_CLIENT_DEVICE_ERROR_TYPE_CMS) ||
         (errorType == U_AT_CLIENT_DEVICE_ERROR_TYPE_CME)) {
@@ -2157,6 +2586,7 @@ static bool processResponse(uAtClientInstance_t *pClient,
                         gResponseStopTag.length, false)) {
             setScope(pClient, U_AT_CLIENT_SCOPE_RESPONSE);
             pClient->stopTag.found = true;
+            statsResponse(pClient, U_AT_CLIENT_DEVICE_ERROR_TYPE_NO_ERROR);
         } else {
             // The response has not ended, check for an error
             if (!deviceErrorInBuffer(pClient)) {
@@ -2175,10 +2605,12 @@ static bool processResponse(uAtClientInstance_t *pClient,
                         // between it and where we are now to read
                         pTmp = pMemStr(U_AT_CLIENT_DATA_BUFFER_PTR(pClient->pReceiveBuffer) +
                                        pClient->pReceiveBuffer->readIndex,
-                                       pClient->pReceiveBuffer->length,
+                                       pClient->pReceiveBuffer->length -
+                                       pClient->pReceiveBuffer->readIndex,
                                        U_AT_CLIENT_CRLF, U_AT_CLIENT_CRLF_LENGTH_BYTES);
                         if ((pTmp != NULL) &&
-                            (pTmp - U_AT_CLIENT_DATA_BUFFER_PTR(pClient->pReceiveBuffer)) > 0) {
+                            (pTmp - (U_AT_CLIENT_DATA_BUFFER_PTR(pClient->pReceiveBuffer) +
+                                     pClient->pReceiveBuffer->readIndex)) > 0) {
                             // There is a CR/LF after some stuff
                             // to read and there was no prefix,
                             // so return now so that the caller
@@ -2258,6 +2690,7 @@ static size_t write(uAtClientInstance_t *pClient,
     uAtClientTag_t savedStopTag;
     bool savedDelimiterRequired;
     uAtClientDeviceError_t savedDeviceError;
+    uAtClientStatsInProgress_t savedStatsInProgress;
     uDeviceSerial_t *pDeviceSerial;
 
     while (((pData < pDataEnd) || andFlush) &&
@@ -2290,6 +2723,7 @@ static size_t write(uAtClientInstance_t *pClient,
             savedStopTag = pClient->stopTag;
             savedDelimiterRequired = pClient->delimiterRequired;
             savedDeviceError = pClient->deviceError;
+            savedStatsInProgress = pClient->statsInProgress;
             // Reset the scope, stopTag and delimiterRequired
             pClient->scope = U_AT_CLIENT_SCOPE_NONE;
             pClient->stopTag.pTagDef = &gNoStopTag;
@@ -2314,6 +2748,7 @@ static size_t write(uAtClientInstance_t *pClient,
             pClient->stopTag = savedStopTag;
             pClient->delimiterRequired = savedDelimiterRequired;
             pClient->deviceError = savedDeviceError;
+            pClient->statsInProgress = savedStatsInProgress;
             // Set the adjusted lock time, allowing for potential
             // wrap in uPortGetTickTimeMs()
             wakeUpDurationMs = uPortGetTickTimeMs() - wakeUpDurationMs;
@@ -2374,6 +2809,9 @@ static size_t write(uAtClientInstance_t *pClient,
                     pDataToWrite += thisLengthWritten;
                     lengthToWrite -= thisLengthWritten;
                     pClient->lastTxTime = uTimeoutStart();
+                    if (pClient->statsInProgress.pCommand != NULL) {
+                        pClient->statsInProgress.pCommand->bytesWritten += thisLengthWritten;
+                    }
                 } else {
                     setError(pClient, U_ERROR_COMMON_DEVICE_ERROR);
                 }
@@ -2662,7 +3100,8 @@ static void urcCallback(const uAtClientStreamHandle_t *pStream,
                                     // If no bufferMatch was found, look for CR/LF
                                 } else if (pMemStr(U_AT_CLIENT_DATA_BUFFER_PTR(pReceiveBuffer) +
                                                    pReceiveBuffer->readIndex,
-                                                   pReceiveBuffer->length,
+                                                   pReceiveBuffer->length -
+                                                   pReceiveBuffer->readIndex,
                                                    U_AT_CLIENT_CRLF, U_AT_CLIENT_CRLF_LENGTH_BYTES) != NULL) {
                                     // Consume everything up to the CR/LF
                                     consumeToString(pClient, U_AT_CLIENT_CRLF);
@@ -3320,6 +3759,7 @@ int32_t uAtClientUnlock(uAtClientHandle_t atHandle)
     streamMutex = mutexStackPop(&(pClient->lockedStreamMutexStack));
     if (streamMutex != NULL) {
         unlockNoDataCheck(pClient, streamMutex);
+        pClient->statsInProgress.pCommand = NULL;
 
         switch (pClient->stream.type) {
             case U_AT_CLIENT_STREAM_TYPE_UART:
@@ -3399,6 +3839,7 @@ void uAtClientCommandStart(uAtClientHandle_t atHandle,
             }
         }
 
+        statsCommandStart(pClient, pCommand);
         // Send the command, no delimiter at first
         pClient->delimiterRequired = false;
         // Note: allow pCommand to be NULL here only
@@ -3547,6 +3988,9 @@ void uAtClientCommandStop(uAtClientHandle_t atHandle)
         write(pClient, U_AT_CLIENT_COMMAND_DELIMITER,
               U_AT_CLIENT_COMMAND_DELIMITER_LENGTH_BYTES,
               true);
+        // The response time is measured from here
+        pClient->statsInProgress.stopTimeMs = uPortGetTickTimeMs();
+        pClient->statsInProgress.responsePending = true;
     }
 
     U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
@@ -4029,6 +4473,7 @@ int32_t uAtClientSetUrcHandler(uAtClientHandle_t atHandle,
                 pUrc->prefixLength = prefixLength;
                 pUrc->pHandler = pHandler;
                 pUrc->pHandlerParam = pHandlerParam;
+                pUrc->pStats = pStatsUrcGet(pClient, pPrefix);
 
                 errorCode = U_ERROR_COMMON_SUCCESS;
             }
@@ -4053,8 +4498,11 @@ int32_t uAtClientSetUrcHandler(uAtClientHandle_t atHandle,
         // locked pClient->mutex
         U_PORT_MUTEX_LOCK(pClient->urcPermittedMutex);
 
+        pUrc->sequence = pClient->urcSequenceNext;
+        pClient->urcSequenceNext++;
         pUrc->pNext = pClient->pUrcList;
         pClient->pUrcList = pUrc;
+        urcIndexBuild(pClient);
 
         U_PORT_MUTEX_UNLOCK(pClient->urcPermittedMutex);
     }
@@ -4086,6 +4534,7 @@ void uAtClientRemoveUrcHandler(uAtClientHandle_t atHandle,
             } else {
                 pClient->pUrcList = pCurrent->pNext;
             }
+            urcIndexBuild(pClient);
 
             U_PORT_MUTEX_UNLOCK(pClient->urcPermittedMutex);
 
@@ -4157,6 +4606,30 @@ void uAtClientUrcHandlerHijackExt(uAtClientHandle_t atHandle,
     U_PORT_MUTEX_UNLOCK(pClient->urcPermittedMutex);
 }
 
+// Get the URC matching statistics.
+int32_t uAtClientUrcMatchStatsGet(uAtClientHandle_t atHandle,
+                                  uint32_t *pBytesCompared,
+                                  uint32_t *pMatchAttempts)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    uErrorCode_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pClient != NULL) {
+        // No locking here: this may be called from a URC handler,
+        // which is already inside urcPermittedMutex, and the
+        // counters are single 32-bit words
+        if (pBytesCompared != NULL) {
+            *pBytesCompared = pClient->urcBytesCompared;
+        }
+        if (pMatchAttempts != NULL) {
+            *pMatchAttempts = pClient->urcMatchAttempts;
+        }
+        errorCode = U_ERROR_COMMON_SUCCESS;
+    }
+
+    return (int32_t) errorCode;
+}
+
 // Get the stack high watermark for the URC task.
 int32_t uAtClientUrcHandlerStackMinFree(uAtClientHandle_t atHandle)
 {
@@ -4650,4 +5123,119 @@ int32_t uAtClientGetAti(uAtClientHandle_t atHandle,
     return errorCodeOrLength;
 }
 
+// Get the statistics for an AT client.
+int32_t uAtClientStatsGet(uAtClientHandle_t atHandle,
+                          uAtClientStats_t *pStats)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    uErrorCode_t errorCode = U_ERROR_COMMON_NOT_SUPPORTED;
+
+#ifndef U_CFG_AT_CLIENT_STATS_DISABLE
+    errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+    if ((pClient != NULL) && (pStats != NULL)) {
+        U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+        if (pClient->pStats != NULL) {
+            *pStats = *(pClient->pStats);
+        } else {
+            memset(pStats, 0, sizeof(*pStats));
+        }
+        U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+        errorCode = U_ERROR_COMMON_SUCCESS;
+    }
+#else
+    (void) pClient;
+    (void) pStats;
+#endif
+
+    return (int32_t) errorCode;
+}
+
+// Reset the statistics for an AT client.
+void uAtClientStatsReset(uAtClientHandle_t atHandle)
+{
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+    uAtClientStats_t *pStats;
+
+    if (pClient != NULL) {
+        U_AT_CLIENT_LOCK_CLIENT_MUTEX(pClient);
+        pStats = pClient->pStats;
+        if (pStats != NULL) {
+            // The URC entries are pointed-to by the URC
+            // handlers so only their counts are reset
+            memset(pStats->command, 0, sizeof(pStats->command));
+            pStats->numCommands = 0;
+            pStats->numCommandsNotRecorded = 0;
+            for (size_t x = 0; x < pStats->numUrcs; x++) {
+                pStats->urc[x].count = 0;
+            }
+        }
+        pClient->statsInProgress.pCommand = NULL;
+        U_AT_CLIENT_UNLOCK_CLIENT_MUTEX(pClient);
+    }
+}
+
+// Get a percentile of the response times of an AT command.
+int32_t uAtClientStatsPercentileMs(const uAtClientStatsCommand_t *pCommand,
+                                   int32_t percentile)
+{
+    int32_t errorCodeOrMs = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uint32_t total = 0;
+    uint32_t threshold;
+    size_t bucket = 0;
+
+    if ((pCommand != NULL) && (percentile > 0) && (percentile <= 100)) {
+        errorCodeOrMs = (int32_t) U_ERROR_COMMON_EMPTY;
+        for (size_t x = 0; x < U_AT_CLIENT_STATS_HISTOGRAM_NUM_BUCKETS; x++) {
+            total += pCommand->responseHistogram[x];
+        }
+        if (total > 0) {
+            // The number of responses that must be at or
+            // below the percentile, rounded up
+            threshold = (uint32_t) (((uint64_t) total * (uint32_t) percentile + 99) / 100);
+            total = pCommand->responseHistogram[0];
+            while ((total < threshold) &&
+                   (bucket < U_AT_CLIENT_STATS_HISTOGRAM_NUM_BUCKETS - 1)) {
+                bucket++;
+                total += pCommand->responseHistogram[bucket];
+            }
+            // Upper limit of the bucket, capped at the maximum
+            errorCodeOrMs = pCommand->responseMaxMs;
+            if ((bucket < U_AT_CLIENT_STATS_HISTOGRAM_NUM_BUCKETS - 1) &&
+                ((int32_t) ((1UL << bucket) - 1) < errorCodeOrMs)) {
+                errorCodeOrMs = (int32_t) ((1UL << bucket) - 1);
+            }
+        }
+    }
+
+    return errorCodeOrMs;
+}
+
+// Get the number of bytes read into and moved within the receive buffer.
+int32_t uAtClientReceiveBytesMovedGet(uAtClientHandle_t atHandle,
+                                      uint32_t *pBytesRead,
+                                      uint32_t *pBytesMoved)
+{
+    uErrorCode_t errorCode = U_ERROR_COMMON_NOT_SUPPORTED;
+#ifdef U_CFG_AT_CLIENT_MEASURE_BYTES_MOVED
+    uAtClientInstance_t *pClient = (uAtClientInstance_t *) atHandle;
+
+    errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+    if (pClient != NULL) {
+        if (pBytesRead != NULL) {
+            *pBytesRead = pClient->receiveBytesRead;
+        }
+        if (pBytesMoved != NULL) {
+            *pBytesMoved = pClient->receiveBytesMoved;
+        }
+        errorCode = U_ERROR_COMMON_SUCCESS;
+    }
+#else
+    (void) atHandle;
+    (void) pBytesRead;
+    (void) pBytesMoved;
+#endif
+
+    return (int32_t) errorCode;
+}
+
 // End of file
@@ -0,0 +1,346 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the AT client command queue API.
+ *
+ * Design note: the waiting commands are kept in one linked list
+ * per priority, each command being a single allocation holding
+ * a copy of the command structure followed by copies of the
+ * strings it points to.  A counting semaphore, given once per
+ * command submitted and once more when the queue is closed,
+ * wakes the dispatcher task.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcpy(), strlen()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port_os.h"
+#include "u_port_heap.h"
+
+#include "u_at_client.h"
+#include "u_at_client_queue.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A command waiting in the queue.
+ */
+typedef struct uAtClientQueueEntry_t {
+    uAtClientQueueCommand_t command; /** A copy of the command, the strings
+                                         pointing into the space following
+                                         this structure. */
+    struct uAtClientQueueEntry_t *pNext;
+} uAtClientQueueEntry_t;
+
+/** A command queue.
+ */
+typedef struct {
+    uAtClientHandle_t atHandle; /** The AT client that the queue is on. */
+    uPortMutexHandle_t mutex; /** Mutex to protect the lists. */
+    uPortSemaphoreHandle_t semaphore; /** Given for each command submitted. */
+    uPortTaskHandle_t task; /** Handle of the dispatcher task. */
+    uPortMutexHandle_t taskRunningMutex; /** Mutex to determine if the task has exited. */
+    bool closing;  /** Set to true to get the dispatcher task to exit. */
+    size_t numWaiting; /** The number of commands waiting, across all lists. */
+    uAtClientQueueEntry_t *pHead[U_AT_CLIENT_QUEUE_PRIORITY_MAX_NUM]; /** List head for each priority. */
+    uAtClientQueueEntry_t *pTail[U_AT_CLIENT_QUEUE_PRIORITY_MAX_NUM]; /** List tail for each priority. */
+} uAtClientQueue_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Take the highest priority command from the lists; the
+// mutex must be locked before this is called.
+static uAtClientQueueEntry_t *pEntryPop(uAtClientQueue_t *pQueue)
+{
+    uAtClientQueueEntry_t *pEntry = NULL;
+
+    for (size_t x = 0; (pEntry == NULL) &&
+         (x < sizeof(pQueue->pHead) / sizeof(pQueue->pHead[0])); x++) {
+        pEntry = pQueue->pHead[x];
+        if (pEntry != NULL) {
+            pQueue->pHead[x] = pEntry->pNext;
+            if (pQueue->pHead[x] == NULL) {
+                pQueue->pTail[x] = NULL;
+            }
+            pQueue->numWaiting--;
+        }
+    }
+
+    return pEntry;
+}
+
+// Perform a command.
+static void perform(uAtClientHandle_t atHandle,
+                    const uAtClientQueueCommand_t *pCommand)
+{
+    int32_t errorCode;
+    int32_t parseErrorCode = 0;
+
+    uAtClientLock(atHandle);
+    if (pCommand->timeoutMs >= 0) {
+        uAtClientTimeoutSet(atHandle, pCommand->timeoutMs);
+    }
+    uAtClientCommandStart(atHandle, pCommand->pCommand);
+    if (pCommand->pWrite != NULL) {
+        pCommand->pWrite(atHandle, pCommand->pParam);
+    }
+    if ((pCommand->pResponsePrefix != NULL) || (pCommand->pParse != NULL)) {
+        uAtClientCommandStop(atHandle);
+        uAtClientResponseStart(atHandle, pCommand->pResponsePrefix);
+        if (pCommand->pParse != NULL) {
+            parseErrorCode = pCommand->pParse(atHandle, pCommand->pParam);
+        }
+        uAtClientResponseStop(atHandle);
+    } else {
+        uAtClientCommandStopReadResponse(atHandle);
+    }
+    errorCode = uAtClientUnlock(atHandle);
+    if (parseErrorCode < 0) {
+        errorCode = parseErrorCode;
+    }
+
+    if (pCommand->pCompletion != NULL) {
+        pCommand->pCompletion(atHandle, errorCode, pCommand->pParam);
+    }
+}
+
+// The dispatcher task.
+static void dispatcherTask(void *pParam)
+{
+    uAtClientQueue_t *pQueue = (uAtClientQueue_t *) pParam;
+    uAtClientQueueEntry_t *pEntry;
+    bool exitNow = false;
+
+    U_PORT_MUTEX_LOCK(pQueue->taskRunningMutex);
+
+    while (!exitNow) {
+        if (uPortSemaphoreTake(pQueue->semaphore) == 0) {
+            pEntry = NULL;
+            U_PORT_MUTEX_LOCK(pQueue->mutex);
+            exitNow = pQueue->closing;
+            if (!exitNow) {
+                pEntry = pEntryPop(pQueue);
+            }
+            U_PORT_MUTEX_UNLOCK(pQueue->mutex);
+            if (pEntry != NULL) {
+                perform(pQueue->atHandle, &(pEntry->command));
+                uPortFree(pEntry);
+            }
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(pQueue->taskRunningMutex);
+
+    // Delete ourself
+    uPortTaskDelete(NULL);
+}
+
+// Free a queue, which must not have a task running.
+static void queueFree(uAtClientQueue_t *pQueue)
+{
+    if (pQueue->taskRunningMutex != NULL) {
+        uPortMutexDelete(pQueue->taskRunningMutex);
+    }
+    if (pQueue->semaphore != NULL) {
+        uPortSemaphoreDelete(pQueue->semaphore);
+    }
+    if (pQueue->mutex != NULL) {
+        uPortMutexDelete(pQueue->mutex);
+    }
+    uPortFree(pQueue);
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Open a command queue.
+uAtClientQueueHandle_t uAtClientQueueOpen(uAtClientHandle_t atHandle)
+{
+    uAtClientQueue_t *pQueue = NULL;
+
+    if (atHandle != NULL) {
+        pQueue = (uAtClientQueue_t *) pUPortMalloc(sizeof(uAtClientQueue_t));
+        if (pQueue != NULL) {
+            memset(pQueue, 0, sizeof(*pQueue));
+            pQueue->atHandle = atHandle;
+            // The semaphore limit includes one for closing
+            if ((uPortMutexCreate(&(pQueue->mutex)) != 0) ||
+                (uPortSemaphoreCreate(&(pQueue->semaphore), 0,
+                                      U_AT_CLIENT_QUEUE_MAX_NUM_COMMANDS + 1) != 0) ||
+                (uPortMutexCreate(&(pQueue->taskRunningMutex)) != 0) ||
+                (uPortTaskCreate(dispatcherTask, "atQueueTask",
+                                 U_AT_CLIENT_QUEUE_TASK_STACK_SIZE_BYTES,
+                                 (void *) pQueue,
+                                 U_AT_CLIENT_QUEUE_TASK_PRIORITY,
+                                 &(pQueue->task)) != 0)) {
+                queueFree(pQueue);
+                pQueue = NULL;
+            } else {
+                // Pause to allow the task to run and lock its mutex
+                uPortTaskBlock(U_CFG_OS_YIELD_MS);
+            }
+        }
+    }
+
+    return (uAtClientQueueHandle_t) pQueue;
+}
+
+// Close a command queue.
+void uAtClientQueueClose(uAtClientQueueHandle_t queueHandle)
+{
+    uAtClientQueue_t *pQueue = (uAtClientQueue_t *) queueHandle;
+    uAtClientQueueEntry_t *pEntry;
+
+    if (pQueue != NULL) {
+        // Get the task to exit and wait for it to do so
+        U_PORT_MUTEX_LOCK(pQueue->mutex);
+        pQueue->closing = true;
+        U_PORT_MUTEX_UNLOCK(pQueue->mutex);
+        uPortSemaphoreGive(pQueue->semaphore);
+        U_PORT_MUTEX_LOCK(pQueue->taskRunningMutex);
+        U_PORT_MUTEX_UNLOCK(pQueue->taskRunningMutex);
+
+        // Cancel anything left in the queue
+        while ((pEntry = pEntryPop(pQueue)) != NULL) {
+            if (pEntry->command.pCompletion != NULL) {
+                pEntry->command.pCompletion(pQueue->atHandle,
+                                            (int32_t) U_ERROR_COMMON_CANCELLED,
+                                            pEntry->command.pParam);
+            }
+            uPortFree(pEntry);
+        }
+
+        queueFree(pQueue);
+
+        // Pause here to allow the task deletion to
+        // actually occur in the idle thread, required
+        // by some RTOSs (e.g. FreeRTOS)
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+    }
+}
+
+// Submit a command to a command queue.
+int32_t uAtClientQueueSubmit(uAtClientQueueHandle_t queueHandle,
+                             const uAtClientQueueCommand_t *pCommand)
+{
+    uAtClientQueue_t *pQueue = (uAtClientQueue_t *) queueHandle;
+    uErrorCode_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+    uAtClientQueueEntry_t *pEntry;
+    size_t commandLength = 0;
+    size_t prefixLength = 0;
+    char *pDest;
+
+    if ((pQueue != NULL) && (pCommand != NULL) &&
+        (pCommand->priority >= 0) &&
+        (pCommand->priority < U_AT_CLIENT_QUEUE_PRIORITY_MAX_NUM)) {
+        if (pCommand->pCommand != NULL) {
+            commandLength = strlen(pCommand->pCommand) + 1;
+        }
+        if (pCommand->pResponsePrefix != NULL) {
+            prefixLength = strlen(pCommand->pResponsePrefix) + 1;
+        }
+        errorCode = U_ERROR_COMMON_NO_MEMORY;
+        pEntry = (uAtClientQueueEntry_t *) pUPortMalloc(sizeof(uAtClientQueueEntry_t) +
+                                                        commandLength + prefixLength);
+        if (pEntry != NULL) {
+            // Copy the command and the strings into the space
+            // following the structure
+            pEntry->command = *pCommand;
+            pEntry->pNext = NULL;
+            pDest = ((char *) pEntry) + sizeof(uAtClientQueueEntry_t);
+            if (pCommand->pCommand != NULL) {
+                memcpy(pDest, pCommand->pCommand, commandLength);
+                pEntry->command.pCommand = pDest;
+                pDest += commandLength;
+            }
+            if (pCommand->pResponsePrefix != NULL) {
+                memcpy(pDest, pCommand->pResponsePrefix, prefixLength);
+                pEntry->command.pResponsePrefix = pDest;
+            }
+
+            U_PORT_MUTEX_LOCK(pQueue->mutex);
+
+            errorCode = U_ERROR_COMMON_BUSY;
+            if (pQueue->numWaiting < U_AT_CLIENT_QUEUE_MAX_NUM_COMMANDS) {
+                // Add to the end of the list for this priority
+                if (pQueue->pTail[pCommand->priority] != NULL) {
+                    pQueue->pTail[pCommand->priority]->pNext = pEntry;
+                } else {
+                    pQueue->pHead[pCommand->priority] = pEntry;
+                }
+                pQueue->pTail[pCommand->priority] = pEntry;
+                pQueue->numWaiting++;
+                uPortSemaphoreGive(pQueue->semaphore);
+                pEntry = NULL;
+                errorCode = U_ERROR_COMMON_SUCCESS;
+            }
+
+            U_PORT_MUTEX_UNLOCK(pQueue->mutex);
+
+            // Free the entry if it wasn't queued
+            uPortFree(pEntry);
+        }
+    }
+
+    return (int32_t) errorCode;
+}
+
+// Get the number of commands waiting in a command queue.
+int32_t uAtClientQueueGetNum(uAtClientQueueHandle_t queueHandle)
+{
+    uAtClientQueue_t *pQueue = (uAtClientQueue_t *) queueHandle;
+    int32_t errorCodeOrNum = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pQueue != NULL) {
+        U_PORT_MUTEX_LOCK(pQueue->mutex);
+        errorCodeOrNum = (int32_t) pQueue->numWaiting;
+        U_PORT_MUTEX_UNLOCK(pQueue->mutex);
+    }
+
+    return errorCodeOrNum;
+}
+
+// End of file
@@ -59,6 +59,7 @@
 
 #include "u_timeout.h"
 #include "u_at_client.h"
+#include "u_at_client_queue.h"
 #include "u_at_client_test.h"
 #include "u_at_client_test_data.h"
 
@@ -181,6 +182,23 @@ static char gAtServerBuffer[1024];
  */
 static const char *gpInterceptTxDataLast = NULL;
 
+/** The values read by queueParse(), in the order they were read.
+ */
+static int32_t gQueueParsed[5];
+
+/** The number of entries in gQueueParsed[].
+ */
+static size_t gQueueParsedCount = 0;
+
+/** The error codes passed to queueCompletion(), indexed by
+ * the value of the command.
+ */
+static int32_t gQueueErrorCode[5];
+
+/** The number of times queueCompletion() has been called.
+ */
+static size_t gQueueCompletionCount = 0;
+
 # endif
 #endif
 
@@ -856,6 +874,56 @@ static char *pInterceptRx(uAtClientHandle_t atHandle,
     return pData;
 }
 
+// Response parser for the command queue test: the value in the
+// echoed response is read and recorded.
+static int32_t queueParse(uAtClientHandle_t atHandle, void *pParam)
+{
+    int32_t x = uAtClientReadInt(atHandle);
+
+    if (gQueueParsedCount < sizeof(gQueueParsed) / sizeof(gQueueParsed[0])) {
+        gQueueParsed[gQueueParsedCount] = x;
+        gQueueParsedCount++;
+    }
+
+    return (x == (int32_t) (intptr_t) pParam) ? 0 : -1;
+}
+
+// Completion callback for the command queue test.
+static void queueCompletion(uAtClientHandle_t atHandle, int32_t errorCode,
+                            void *pParam)
+{
+    size_t x = (size_t) (intptr_t) pParam;
+
+    (void) atHandle;
+
+    if (x < sizeof(gQueueErrorCode) / sizeof(gQueueErrorCode[0])) {
+        gQueueErrorCode[x] = errorCode;
+    }
+    gQueueCompletionCount++;
+}
+
+// Submit a command to the queue for the command queue test,
+// the command being a string which the echo server will send
+// back as a "+TEST:" information response carrying value.
+static int32_t queueSubmit(uAtClientQueueHandle_t queueHandle,
+                           int32_t value,
+                           uAtClientQueuePriority_t priority)
+{
+    uAtClientQueueCommand_t command = {0};
+    char buffer[32];
+
+    snprintf(buffer, sizeof(buffer), "\r\n+TEST: %d\r\nOK\r\n", (int) value);
+    command.pCommand = buffer;
+    command.pResponsePrefix = "+TEST:";
+    command.pParse = queueParse;
+    command.pCompletion = queueCompletion;
+    command.pParam = (void *) (intptr_t) value;
+    command.timeoutMs = -1;
+    command.priority = priority;
+
+    return uAtClientQueueSubmit(queueHandle, &command);
+}
+
 # endif
 #endif
 
@@ -1207,6 +1275,15 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet1")
     char r = 'R';
     bool restoreStopTag;
     int32_t resourceCount;
+    uint32_t urcBytesCompared = 0;
+    uint32_t urcMatchAttempts = 0;
+    uint32_t bytesRead = 0;
+    uint32_t bytesMoved = 0;
+    uAtClientStats_t *pStats;
+    int32_t statsErrorCode;
+    uint32_t statsNumCommands = 0;
+    uint32_t statsNumCmeErrors = 0;
+    uint32_t statsNumUrcs = 0;
 
     memset(&checkCommandResponse, 0, sizeof(checkCommandResponse));
     checkCommandResponse.pTestSet = gAtClientTestSet1;
@@ -1527,6 +1604,46 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet1")
     // Check the stack extents for the URC and callbacks tasks
     checkStackExtents(atClientHandle);
 
+    // Get the URC matching statistics
+    U_PORT_TEST_ASSERT(uAtClientUrcMatchStatsGet(atClientHandle, &urcBytesCompared,
+                                                 &urcMatchAttempts) == 0);
+    U_TEST_PRINT_LINE("%u byte(s) compared in %u URC match attempt(s).",
+                      urcBytesCompared, urcMatchAttempts);
+    if (uAtClientReceiveBytesMovedGet(atClientHandle, &bytesRead, &bytesMoved) == 0) {
+        U_TEST_PRINT_LINE("%u byte(s) moved in the receive buffer for %u byte(s) read.",
+                          bytesMoved, bytesRead);
+    }
+
+    // Get the statistics
+    pStats = (uAtClientStats_t *) pUPortMalloc(sizeof(*pStats));
+    U_PORT_TEST_ASSERT(pStats != NULL);
+    memset(pStats, 0xff, sizeof(*pStats));
+    statsErrorCode = uAtClientStatsGet(atClientHandle, pStats);
+    if (statsErrorCode == 0) {
+        for (size_t z = 0; z < pStats->numCommands; z++) {
+            U_TEST_PRINT_LINE("\"%s\": %u time(s), %u byte(s) written, %u read,"
+                              " response min/p99/max %d/%d/%d ms, %u timeout(s),"
+                              " %u CME/CMS error(s), %u other error(s).",
+                              pStats->command[z].prefix, pStats->command[z].count,
+                              pStats->command[z].bytesWritten, pStats->command[z].bytesRead,
+                              pStats->command[z].responseMinMs,
+                              uAtClientStatsPercentileMs(&(pStats->command[z]), 99),
+                              pStats->command[z].responseMaxMs,
+                              pStats->command[z].numTimeouts,
+                              pStats->command[z].numCmeErrors,
+                              pStats->command[z].numErrors);
+            statsNumCommands += pStats->command[z].count;
+            statsNumCmeErrors += pStats->command[z].numCmeErrors;
+        }
+        statsNumCommands += pStats->numCommandsNotRecorded;
+        for (size_t z = 0; z < pStats->numUrcs; z++) {
+            U_TEST_PRINT_LINE("URC \"%s\": %u time(s).", pStats->urc[z].prefix,
+                              pStats->urc[z].count);
+            statsNumUrcs += pStats->urc[z].count;
+        }
+    }
+    uPortFree(pStats);
+
     U_TEST_PRINT_LINE("removing AT client...");
     uAtClientRemove(atClientHandle);
     uAtClientDeinit();
@@ -1547,6 +1664,14 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet1")
     U_PORT_TEST_ASSERT(checkUrc.count == U_AT_CLIENT_TEST_NUM_URCS_SET_1);
     U_PORT_TEST_ASSERT(checkUrc.passIndex == U_AT_CLIENT_TEST_NUM_URCS_SET_1);
     U_PORT_TEST_ASSERT(gConsecutiveTimeout == 0);
+    U_PORT_TEST_ASSERT(urcMatchAttempts >= U_AT_CLIENT_TEST_NUM_URCS_SET_1);
+    U_PORT_TEST_ASSERT(urcBytesCompared > 0);
+    if (statsErrorCode != (int32_t) U_ERROR_COMMON_NOT_SUPPORTED) {
+        U_PORT_TEST_ASSERT(statsErrorCode == 0);
+        U_PORT_TEST_ASSERT(statsNumCommands == gAtClientTestSetSize1);
+        U_PORT_TEST_ASSERT(statsNumCmeErrors > 0);
+        U_PORT_TEST_ASSERT(statsNumUrcs == U_AT_CLIENT_TEST_NUM_URCS_SET_1);
+    }
 
     // Check for resource leaks
     uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
@@ -1726,6 +1851,116 @@ U_PORT_TEST_FUNCTION("[atClient]", "atClientCommandSet2")
     U_PORT_TEST_ASSERT(resourceCount <= 0);
 }
 
+/** Add an AT client with a command queue on it and use an AT echo
+ * responder to check that queued commands are performed in order
+ * of priority and that closing the queue cancels those still
+ * waiting.
+ */
+U_PORT_TEST_FUNCTION("[atClient]", "atClientQueue")
+{
+    uAtClientHandle_t atClientHandle;
+    uAtClientQueueHandle_t queueHandle;
+    const uAtClientTestResponseLine_t *pUrc = NULL;
+    int32_t resourceCount;
+
+    gQueueParsedCount = 0;
+    gQueueCompletionCount = 0;
+    for (size_t x = 0; x < sizeof(gQueueErrorCode) / sizeof(gQueueErrorCode[0]); x++) {
+        gQueueErrorCode[x] = 1;
+    }
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Set up everything with the two UARTs
+    twoUartsPreamble();
+
+    // Set up an AT echo responder on UART 1, without URCs
+    U_PORT_TEST_ASSERT(uPortUartEventCallbackSet(gUartBHandle,
+                                                 U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                 atEchoServerCallback, (void *) &pUrc,
+                                                 U_AT_CLIENT_URC_TASK_STACK_SIZE_BYTES,
+                                                 U_AT_CLIENT_URC_TASK_PRIORITY) == 0);
+
+    U_PORT_TEST_ASSERT(uAtClientInit() == 0);
+
+    U_TEST_PRINT_LINE("adding an AT client on UART %d...", U_CFG_TEST_UART_A);
+    atClientHandle = uAtClientAdd(gUartAHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                  NULL, U_AT_CLIENT_TEST_AT_BUFFER_LENGTH_BYTES);
+    U_PORT_TEST_ASSERT(atClientHandle != NULL);
+    uAtClientTimeoutSet(atClientHandle, U_AT_CLIENT_TEST_AT_TIMEOUT_MS);
+
+    U_TEST_PRINT_LINE("opening a command queue...");
+    queueHandle = uAtClientQueueOpen(atClientHandle);
+    U_PORT_TEST_ASSERT(queueHandle != NULL);
+
+    // Lock the AT client so that the dispatcher is held up on the
+    // first command while the rest are submitted
+    uAtClientLock(atClientHandle);
+    U_PORT_TEST_ASSERT(queueSubmit(queueHandle, 0, U_AT_CLIENT_QUEUE_PRIORITY_LOW) == 0);
+    uPortTaskBlock(100);
+    U_PORT_TEST_ASSERT(queueSubmit(queueHandle, 1, U_AT_CLIENT_QUEUE_PRIORITY_LOW) == 0);
+    U_PORT_TEST_ASSERT(queueSubmit(queueHandle, 2, U_AT_CLIENT_QUEUE_PRIORITY_NORMAL) == 0);
+    U_PORT_TEST_ASSERT(queueSubmit(queueHandle, 3, U_AT_CLIENT_QUEUE_PRIORITY_HIGH) == 0);
+    U_PORT_TEST_ASSERT(uAtClientQueueGetNum(queueHandle) == 3);
+    U_TEST_PRINT_LINE("releasing the dispatcher...");
+    uAtClientUnlock(atClientHandle);
+    for (size_t x = 0; (x < 100) && (gQueueCompletionCount < 4); x++) {
+        uPortTaskBlock(100);
+    }
+    U_TEST_PRINT_LINE("%d command(s) completed, values read %d, %d, %d, %d.",
+                      gQueueCompletionCount, gQueueParsed[0], gQueueParsed[1],
+                      gQueueParsed[2], gQueueParsed[3]);
+    U_PORT_TEST_ASSERT(gQueueCompletionCount == 4);
+    U_PORT_TEST_ASSERT(gQueueParsedCount == 4);
+    // The first command was already under way, the rest
+    // should have been performed in order of priority
+    U_PORT_TEST_ASSERT(gQueueParsed[0] == 0);
+    U_PORT_TEST_ASSERT(gQueueParsed[1] == 3);
+    U_PORT_TEST_ASSERT(gQueueParsed[2] == 2);
+    U_PORT_TEST_ASSERT(gQueueParsed[3] == 1);
+    for (size_t x = 0; x < 4; x++) {
+        U_PORT_TEST_ASSERT(gQueueErrorCode[x] == 0);
+    }
+
+    // Now hold up the dispatcher again with one command, submit
+    // another and close the queue while the first is in progress:
+    // the second should be cancelled
+    uAtClientLock(atClientHandle);
+    U_PORT_TEST_ASSERT(queueSubmit(queueHandle, 4, U_AT_CLIENT_QUEUE_PRIORITY_NORMAL) == 0);
+    uPortTaskBlock(100);
+    U_PORT_TEST_ASSERT(queueSubmit(queueHandle, 0, U_AT_CLIENT_QUEUE_PRIORITY_NORMAL) == 0);
+    gQueueErrorCode[0] = 1;
+    uAtClientUnlock(atClientHandle);
+    U_TEST_PRINT_LINE("closing the command queue...");
+    uAtClientQueueClose(queueHandle);
+    U_TEST_PRINT_LINE("command 4 completed with %d, command 0 with %d.",
+                      gQueueErrorCode[4], gQueueErrorCode[0]);
+    U_PORT_TEST_ASSERT(gQueueCompletionCount == 6);
+    U_PORT_TEST_ASSERT(gQueueErrorCode[4] == 0);
+    U_PORT_TEST_ASSERT(gQueueErrorCode[0] == (int32_t) U_ERROR_COMMON_CANCELLED);
+
+    U_TEST_PRINT_LINE("removing AT client...");
+    uAtClientRemove(atClientHandle);
+    uAtClientDeinit();
+
+    uPortUartClose(gUartBHandle);
+    gUartBHandle = -1;
+    uPortUartClose(gUartAHandle);
+    gUartAHandle = -1;
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
 # endif
 #endif
 
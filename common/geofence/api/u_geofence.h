@@ -137,6 +137,35 @@ extern "C" {
 # define U_GEOFENCE_HORIZONTAL_SPEED_MILLIMETRES_PER_SECOND_MAX 500000LL
 #endif
 
+#ifndef U_GEOFENCE_INDEX_SHAPES_MIN
+/** When geofences are applied to a device, if the total number
+ * of shapes (circles and polygons) in those geofences is at least
+ * this many then a spatial index is built over their square extents
+ * (see #U_GEOFENCE_SQUARE_EXTENT_CHECK_UNCERTAINTY_METRES) so that
+ * each position need only be tested against the shapes near it; the
+ * callback is still called for every geofence.  Below this number
+ * it is quicker just to check every shape.  Set this to 0 to never
+ * build a spatial index.
+ */
+# define U_GEOFENCE_INDEX_SHAPES_MIN 16
+#endif
+
+#ifndef U_GEOFENCE_SAFE_RADIUS_SHAPES_MAX
+/** When geofences are applied to a device, if the total number of
+ * shapes in those geofences is no more than this then, for each
+ * shape, the outcome of the last full test of a position against
+ * it is remembered, along with the distance from that position to
+ * the edge of the shape; a later position that, allowing for its
+ * radius of position, is certainly within that distance of the
+ * remembered one has the same outcome, without any calculation.
+ * This applies only where the "flat earth" maths can be used (see
+ * #U_GEOFENCE_SQUARE_EXTENT_CHECK_UNCERTAINTY_METRES) and only
+ * to outcomes that were certain.  The cost is 32 bytes of heap
+ * per shape per device.  Set this to 0 to never remember outcomes.
+ */
+# define U_GEOFENCE_SAFE_RADIUS_SHAPES_MAX 256
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -206,6 +235,10 @@ typedef enum {
 /** Callback that may be called if a position is inside/outside/transiting
  * a geofence.
  *
+ * The callback is called with the geofences locked against change: it
+ * must not create, change, apply, remove or free a geofence, nor wait
+ * on a task that might be doing so.
+ *
  * @param devHandle                      the handle of the device.
  * @param[in] pFence                     the geofence that is being referred
  *                                       to, passed as a void * to avoid
@@ -250,7 +283,12 @@ typedef enum {
  *                                       without calculating the distance
  *                                       this will be LLONG_MIN, which should
  *                                       be interpreted as meaning "not
- *                                       calculated".
+ *                                       calculated".  Where the outcome for a
+ *                                       shape has been carried over from an
+ *                                       earlier position (see
+ *                                       #U_GEOFENCE_SAFE_RADIUS_SHAPES_MAX)
+ *                                       the distance to that shape will be
+ *                                       a lower bound.
  * @param[in,out] pCallbackParam         the pCallbackParam pointer that
  *                                       was passed to uGnssFenceSetCallback(),
  *                                       uCellFenceSetCallback() or
@@ -504,10 +542,32 @@ int32_t uGeofenceSetAltitudeMin(uGeofence_t *pFence,
  */
 int32_t uGeofenceClearMap(uGeofence_t *pFence);
 
+/** Compile the shapes of a geofence into the form that is used when
+ * testing positions against it: each polygon is turned into a
+ * contiguous array of vertices with the per-edge quantities the
+ * tests need worked out in advance.  This is done automatically when
+ * a geofence is applied to a device or, for uGeofenceTest(), when
+ * a position is first tested, hence there is no need to call this
+ * function; it is provided so that, for a geofence with many
+ * vertices, you may choose when the time and heap memory are spent.
+ * The geofence may still be added to after this function has been
+ * called, but any polygon that is added to will need compiling
+ * again.
+ *
+ * @param[in] pFence a pointer to the geofence to compile.
+ * @return           zero on success else negative error code.
+ */
+int32_t uGeofenceFreeze(uGeofence_t *pFence);
+
 /** Test a position against a geofence.  This will not cause
  * any callbacks to be called, it is simply a local test of the
  * geofence.
  *
+ * Any number of tasks may test positions against geofences at the
+ * same time without blocking one another; only a function which
+ * changes a geofence, e.g. uGeofenceAddCircle(), will wait for tests
+ * that are under way to complete.
+ *
  * Note: if a maximum or minimum altitude is set and altitudeMillimetres
  * is INT_MIN (i.e. not present) then false will be returned.
  *
@@ -560,13 +620,81 @@ bool uGeofenceTest(uGeofence_t *pFence, uGeofenceTestType_t testType,
                    int32_t radiusMillimetres,
                    int32_t altitudeUncertaintyMillimetres);
 
+/** Test a sequence of positions, e.g. a recorded track, against a
+ * geofence.  The outcome is exactly as if uGeofenceTest() had been
+ * called for each position in turn, but the Geofence API mutex is
+ * taken only once and the conversion of the positions into the form
+ * needed for testing is done several positions at a time, which is
+ * more efficient.  Positions are tested in order: for
+ * #U_GEOFENCE_TEST_TYPE_TRANSIT, or where the radius of position or
+ * altitude uncertainty makes the outcome uncertain, the outcome for
+ * each position depends on the one before.
+ *
+ * As for uGeofenceTest(), the latitude/longitude values are
+ * multiplied by ten to the power NINE (1e9).
+ *
+ * @param[in] pFence                          a pointer to the geofence
+ *                                            to test; cannot be NULL.
+ * @param testType                            the type of test to perform.
+ * @param pessimisticNotOptimistic            see uGeofenceTest().
+ * @param numPositions                        the number of positions to
+ *                                            test, i.e. the number of
+ *                                            elements in each of the
+ *                                            arrays below.
+ * @param[in] pLatitudeX1e9                   an array of the latitudes of
+ *                                            the positions in degrees times
+ *                                            ten to the power nine; cannot
+ *                                            be NULL unless numPositions
+ *                                            is zero.
+ * @param[in] pLongitudeX1e9                  an array of the longitudes of
+ *                                            the positions in degrees times
+ *                                            ten to the power nine; cannot
+ *                                            be NULL unless numPositions
+ *                                            is zero.
+ * @param[in] pAltitudeMillimetres            an array of the altitudes of
+ *                                            the positions in millimetres,
+ *                                            INT_MIN for a 2D position; may
+ *                                            be NULL if all of the positions
+ *                                            are 2D.
+ * @param[in] pRadiusMillimetres              an array of the radii of the
+ *                                            positions in millimetres; may
+ *                                            be NULL, in which case the
+ *                                            radius of all of the positions
+ *                                            is taken to be zero.
+ * @param[in] pAltitudeUncertaintyMillimetres an array of the altitude
+ *                                            uncertainties of the positions
+ *                                            in millimetres, -1 if not known;
+ *                                            may be NULL if none are known.
+ * @param[out] pPositionState                 a place to put the position
+ *                                            state for each position, an
+ *                                            array of numPositions elements;
+ *                                            #U_GEOFENCE_POSITION_STATE_NONE
+ *                                            will be written for a position
+ *                                            that could not be tested, e.g.
+ *                                            because it is out of range.
+ *                                            May be NULL.
+ * @return                                    on success the number of
+ *                                            positions for which the test
+ *                                            was met, else negative error
+ *                                            code.
+ */
+int32_t uGeofenceTestBatch(uGeofence_t *pFence, uGeofenceTestType_t testType,
+                           bool pessimisticNotOptimistic,
+                           size_t numPositions,
+                           const int64_t *pLatitudeX1e9,
+                           const int64_t *pLongitudeX1e9,
+                           const int32_t *pAltitudeMillimetres,
+                           const int32_t *pRadiusMillimetres,
+                           const int32_t *pAltitudeUncertaintyMillimetres,
+                           uGeofencePositionState_t *pPositionState);
+
 /** When any function of the Geofence API is called it will ensure that
- * a mutex, used for thread-safety, has been created.  This mutex is
- * not intended to be free'd, ever.  However, if you are quite
+ * the mutexes and semaphore used for thread-safety have been created.
+ * These are not intended to be free'd, ever.  However, if you are quite
  * finished with the Geofence API, no fence is in use etc. you may
- * call this function to free the mutex and get that memory back.
+ * call this function to free them and get that memory back.
  * There is no harm in calling a Geofence API function again after
- * this, it will simply recreate the mutex.
+ * this, it will simply recreate them.
  */
 void uGeofenceCleanUp();
 
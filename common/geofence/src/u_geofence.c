@@ -138,6 +138,7 @@
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
 #include "string.h"    // memset()
+#include "stdlib.h"    // qsort()
 #ifdef U_CFG_GEOFENCE
 # include "math.h"     // sqrt(), cos(), etc.
 #endif
@@ -191,6 +192,41 @@
  */
 #define U_GEOFENCE_MAX_SQUARE_EXTENT_HALF_DIAGONAL_METRES 10000000LL
 
+/** The margin by which the distance from a position to the bounding
+ * box of a polygon edge must exceed the distance of interest before
+ * the edge is skipped in a flat X/Y distance check; this soaks up
+ * floating point rounding, it need only be tiny.
+ */
+#define U_GEOFENCE_EDGE_BOX_MARGIN_METRES 0.001
+
+/** The number of children of each node of the spatial index
+ * that is built over the shapes of the geofences applied to
+ * a device.
+ */
+#define U_GEOFENCE_INDEX_NODE_CHILDREN 8
+
+/** The margin, in degrees, added all around the square extent
+ * of a shape when it is put into the spatial index, so that
+ * floating point rounding can never cause the index to miss a
+ * shape that testSquareExtent() would not have eliminated;
+ * about 10 cm, the index need only be a superset.
+ */
+#define U_GEOFENCE_INDEX_MARGIN_DEGREES 0.000001
+
+/** The factor by which the distance to the edge of a shape is
+ * reduced before it is used as a safe radius; this soaks up
+ * the error in the flat earth maths, which grows with distance.
+ */
+#define U_GEOFENCE_SAFE_RADIUS_FACTOR 0.99
+
+#ifndef U_GEOFENCE_TEST_BATCH_CHUNK_SIZE
+/** The number of positions that uGeofenceTestBatch() converts
+ * into the form needed for testing in one go; the working
+ * storage for this, six doubles per position, is on the stack.
+ */
+# define U_GEOFENCE_TEST_BATCH_CHUNK_SIZE 8
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -225,6 +261,28 @@ typedef struct {
     double radiusMetres;
 } uGeofenceCircle_t;
 
+/** Structure to hold a vertex of a compiled polygon, along with
+ * the pre-computed coefficients of the edge that runs from it
+ * to the next vertex of the polygon; a position is tested against
+ * a polygon by walking a contiguous array of these.
+ */
+typedef struct {
+    uGeofenceCoordinates_t coordinates; /**< in degrees. */
+    double latitudeRadians;
+    double longitudeRadians;
+    double cosLatitude;
+    double sinLatitude;
+    double latitudeMin;    /**< the lowest latitude of the edge. */
+    double latitudeMax;    /**< the highest latitude of the edge. */
+    double longitudeWest;  /**< the western end of the edge. */
+    double longitudeSpan;  /**< the eastward span of the edge in degrees, never negative. */
+    double longitudeDelta; /**< next vertex minus this vertex, wrap handled. */
+    double slope;          /**< change in latitude per degree of longitude, zero for a meridian. */
+    double yDeltaMetres;   /**< the change in latitude in metres, for X/Y maths. */
+    double azimuthRadians; /**< the bearing to the next vertex, spherical earth. */
+    double angularLengthRadians; /**< the angle subtended by the edge, spherical earth. */
+} uGeofenceVertex_t;
+
 /** Structure to hold a shape.
  */
 typedef struct {
@@ -235,8 +293,115 @@ typedef struct {
     } u;
     uGeofenceSquare_t squareExtent; /**< the square extent of the shape. */
     bool wgs84Required; /**< true if the shape is so big as to require WGS84 handling. */
+    uGeofenceVertex_t *pCompiled; /**< polygon only: the compiled form of pPolygon,
+                                       compiledVertexCount + 1 entries, the last
+                                       being a repeat of the first to close the
+                                       polygon; NULL if not (yet) compiled. */
+    size_t compiledVertexCount;   /**< the number of vertices in pCompiled, not
+                                       counting the closing repeat. */
 } uGeofenceShape_t;
 
+/** An entry in the spatial index: the square extent of a shape, or
+ * one half of it if the square extent crosses the 180 degree line
+ * of longitude.
+ */
+typedef struct {
+    uGeofenceSquare_t box;
+    size_t fenceIndex; /**< the position of the fence of the shape in
+                            the list of fences of the context. */
+    size_t shapeSlot;  /**< the position of the shape among all of the
+                            shapes of all of the fences of the context. */
+} uGeofenceIndexEntry_t;
+
+/** A node of the spatial index, which is a packed R-tree.
+ */
+typedef struct {
+    uGeofenceSquare_t box; /**< the box around all of the children. */
+    size_t firstChild;     /**< index into the entries for a leaf node,
+                                else index into the nodes. */
+    size_t numChildren;
+} uGeofenceIndexNode_t;
+
+/** A spatial index over the square extents of the shapes of the
+ * fences in a geofence context.  Querying the index with a position
+ * marks the shapes (and their fences) whose square extent the
+ * position may be inside; anything not marked is outside.  The
+ * working storage and marks of a query are kept apart from the
+ * index, in a #uGeofenceIndexQuery_t: the storage for one query,
+ * pScratch, is allocated along with the index and is claimed by a
+ * test of the context, under gSharedMutex, for its duration; only
+ * a test that finds it already claimed, because another task is
+ * testing the same context at the same time, allocates its own.
+ */
+typedef struct {
+    uGeofenceIndexEntry_t *pEntries;
+    size_t numEntries;
+    uGeofenceIndexNode_t *pNodes; /**< leaf nodes first, root node last. */
+    size_t numNodes;
+    size_t numLeafNodes;
+    size_t stackLength;      /**< the working storage a query needs. */
+    size_t *pFenceShapeSlot; /**< for each fence, the slot of its first shape. */
+    size_t numFences;
+    size_t numShapeSlots;
+    size_t *pScratch;  /**< the storage for one query, see indexQuerySize(). */
+    bool scratchInUse; /**< true while a test has pScratch. */
+} uGeofenceIndex_t;
+
+/** The working storage and outcome of a query of a spatial index,
+ * all in one block of storage laid out by indexQueryInit().
+ */
+typedef struct {
+    size_t *pStack;       /**< stackLength entries. */
+    uint8_t *pFenceMarks; /**< a bit for each fence, set if a shape
+                               of the fence is a candidate. */
+    uint8_t *pShapeMarks; /**< a bit for each shape slot, set if
+                               the shape is a candidate. */
+} uGeofenceIndexQuery_t;
+
+/** The outcome of a spatial index query for one fence, as passed
+ * to testPosition().
+ */
+typedef struct {
+    const uint8_t *pShapeMarks; /**< the marks of all of the shape slots. */
+    size_t firstShapeSlot;      /**< the slot of the first shape of the fence. */
+    bool fenceIsCandidate;
+} uGeofenceCandidates_t;
+
+/** The last certain outcome of testing a position against a shape
+ * for one device.
+ */
+typedef struct {
+    uGeofenceCoordinates_t coordinates; /**< the position that was tested. */
+    double safeRadiusMetres; /**< the distance from coordinates to the
+                                  edge of the shape, NAN if there is
+                                  no outcome. */
+    uGeofencePositionState_t positionState;
+} uGeofenceSafeRadius_t;
+
+/** The safe radius of every shape of the fences applied to a device,
+ * as stored in the pSafeRadius field of a geofence context.
+ */
+typedef struct {
+    uGeofenceSafeRadius_t *pShapes; /**< one entry per shape, in the
+                                         order they are walked. */
+    size_t *pFenceShapeSlot; /**< the index into pShapes of the first
+                                  shape of each fence. */
+    size_t numFences;
+} uGeofenceSafeRadiusCache_t;
+
+/** A chunk of the positions passed to uGeofenceTestBatch(), held
+ * as one array per quantity so that the conversion of each
+ * quantity is a simple loop over contiguous memory.
+ */
+typedef struct {
+    double latitude[U_GEOFENCE_TEST_BATCH_CHUNK_SIZE];
+    double longitude[U_GEOFENCE_TEST_BATCH_CHUNK_SIZE];
+    double latitudeRadians[U_GEOFENCE_TEST_BATCH_CHUNK_SIZE];
+    double longitudeRadians[U_GEOFENCE_TEST_BATCH_CHUNK_SIZE];
+    double cosLatitude[U_GEOFENCE_TEST_BATCH_CHUNK_SIZE];
+    double sinLatitude[U_GEOFENCE_TEST_BATCH_CHUNK_SIZE];
+} uGeofenceBatchChunk_t;
+
 #endif // U_CFG_GEOFENCE
 
 /* ----------------------------------------------------------------
@@ -245,10 +410,30 @@ typedef struct {
 
 #ifdef U_CFG_GEOFENCE
 
-/** Mutex to protect the uGeofence API.
+/** Mutex to protect the uGeofence API: held for the duration of
+ * anything that changes a fence (the exclusive path) and taken only
+ * briefly on the way in to a test of a fence (the shared path), so
+ * that tests do not block one another.
  */
 static uPortMutexHandle_t gMutex = NULL;
 
+/** Mutex to protect gSharedCount, the test memory of a fence,
+ * i.e. the positionState and distanceMinMillimetres fields, and
+ * the entries of the safe radius cache of a geofence context, all
+ * of which are written on the shared path.
+ */
+static uPortMutexHandle_t gSharedMutex = NULL;
+
+/** The number of tests of fences that are under way on the shared
+ * path.
+ */
+static int32_t gSharedCount = 0;
+
+/** Given when gSharedCount drops to zero, so that anything waiting
+ * for exclusive access can get it.
+ */
+static uPortSemaphoreHandle_t gSharedNoneSemaphore = NULL;
+
 #endif // U_CFG_GEOFENCE
 
 /* ----------------------------------------------------------------
@@ -261,8 +446,68 @@ static uPortMutexHandle_t gMutex = NULL;
 static void init()
 {
     if (gMutex == NULL) {
-        uPortMutexCreate(&gMutex);
+        // gMutex is created last so that, if it exists,
+        // everything else does also
+        if (gSharedMutex == NULL) {
+            uPortMutexCreate(&gSharedMutex);
+        }
+        if ((gSharedMutex != NULL) && (gSharedNoneSemaphore == NULL)) {
+            uPortSemaphoreCreate(&gSharedNoneSemaphore, 0, 1);
+        }
+        if (gSharedNoneSemaphore != NULL) {
+            uPortMutexCreate(&gMutex);
+        }
+    }
+}
+
+// Get exclusive access to the uGeofence API, waiting for any
+// tests on the shared path to finish; gMutex must exist.
+static void lockExclusive()
+{
+    uPortMutexLock(gMutex);
+    // Holding gMutex means that no new tests can start
+    uPortMutexLock(gSharedMutex);
+    while (gSharedCount > 0) {
+        uPortMutexUnlock(gSharedMutex);
+        uPortSemaphoreTake(gSharedNoneSemaphore);
+        uPortMutexLock(gSharedMutex);
+    }
+    uPortMutexUnlock(gSharedMutex);
+}
+
+// Give up exclusive access to the uGeofence API.
+static void unlockExclusive()
+{
+    uPortMutexUnlock(gMutex);
+}
+
+// Swap exclusive access to the uGeofence API for shared access,
+// without letting anything else in between.
+static void exclusiveToShared()
+{
+    U_PORT_MUTEX_LOCK(gSharedMutex);
+    gSharedCount++;
+    U_PORT_MUTEX_UNLOCK(gSharedMutex);
+    uPortMutexUnlock(gMutex);
+}
+
+// Get shared access to the uGeofence API, which is all that
+// testing a fence requires; gMutex must exist.
+static void lockShared()
+{
+    uPortMutexLock(gMutex);
+    exclusiveToShared();
+}
+
+// Give up shared access to the uGeofence API.
+static void unlockShared()
+{
+    U_PORT_MUTEX_LOCK(gSharedMutex);
+    gSharedCount--;
+    if (gSharedCount == 0) {
+        uPortSemaphoreGive(gSharedNoneSemaphore);
     }
+    U_PORT_MUTEX_UNLOCK(gSharedMutex);
 }
 
 #endif // U_CFG_GEOFENCE
@@ -326,6 +571,7 @@ static void fenceClearMapData(uGeofence_t *pFence)
                         break;
                     case U_GEOFENCE_SHAPE_TYPE_POLYGON:
                         fenceClearMapDataPolygon(&(pShape->u.pPolygon));
+                        uPortFree(pShape->pCompiled);
                         break;
                     default:
                         break;
@@ -396,15 +642,16 @@ static double longitudeSubtractRadians(double aLongitudeRadians,
 }
 
 // Return the number of metres per degree longitude
-// at the given latitude.  Only works  within a space
-// small enough not to require WGS84 coordinates.
-static double longitudeMetresPerDegree(double latitude)
+// at a latitude, given the cosine of that latitude.  Only
+// works within a space small enough not to require WGS84
+// coordinates.
+static double longitudeMetresPerDegreeCos(double cosLatitude)
 {
     // The number of metres per degree longitude at the equator
     // is Pi * d / 360, so at a given latitude we multiply by
     // cos of the latitude in radians
     return U_GEOFENCE_PI_FLOAT * U_GEOFENCE_RADIUS_AT_EQUATOR_METERS * 2 *
-           cos(degreesToRadians(latitude)) / 360;
+           cosLatitude / 360;
 }
 
 // Return the distance between two points on a spherical earth;
@@ -473,39 +720,31 @@ static void reverseHaversine(double latitude, double longitude,
 // Implementation note: it would be possible, of course, to have
 // sub-functions to obtain bearing etc. but then it wouldn't be possible
 // to re-use the cosine/sine values across this function.
-static bool latitudeOfIntersectionSpherical(const uGeofenceCoordinates_t *pA,
-                                            const uGeofenceCoordinates_t *pB,
-                                            double longitude,
+// The radian values, their sines/cosines and the bearing from A
+// to B come pre-computed in the compiled vertices.
+static bool latitudeOfIntersectionSpherical(const uGeofenceVertex_t *pA,
+                                            const uGeofenceVertex_t *pB,
+                                            const uGeofenceVertex_t *pPoint,
                                             double *pIntersectLatitude)
 {
     bool success = true;
     // Return nan by default
     double intersectLatitudeRadians = NAN;
+    double longitude = pPoint->coordinates.longitude;
 
     // EVERYTHING INSIDE HERE IS IN RADIANS
 
     // Throw out the simple cases first, otherwise these can cause
     // infinities to appear in the calculation below
-    if (longitude == pA->longitude) {
-        intersectLatitudeRadians = degreesToRadians(pA->latitude);
-    } else if (longitude == pB->longitude) {
-        intersectLatitudeRadians = degreesToRadians(pB->latitude);
+    if (longitude == pA->coordinates.longitude) {
+        intersectLatitudeRadians = pA->latitudeRadians;
+    } else if (longitude == pB->coordinates.longitude) {
+        intersectLatitudeRadians = pB->latitudeRadians;
     } else {
-        // First need to get the azimuth of our first great circle from the two
-        // points we've been given.
-        double aToBDeltaLongitudeRadians = degreesToRadians(longitudeSubtract(pB->longitude,
-                                                                              pA->longitude));
-        double bLatitudeRadians = degreesToRadians(pB->latitude);
-        // This is just latitudeRadians, not aLatitudeRadians or oneLatitudeRadians,
-        // for reasons that will become clear below
-        double latitudeRadians = degreesToRadians(pA->latitude);
-        double oneLongitudeRadians = degreesToRadians(pA->longitude);
-        double cosBLatitude = cos(bLatitudeRadians);
-
-        // Calculate the bearing from A to B
-        double oneAzimuthRadians = atan2(sin(aToBDeltaLongitudeRadians) * cosBLatitude,
-                                         (cos(latitudeRadians) * sin(bLatitudeRadians)) -
-                                         (sin(latitudeRadians) * cosBLatitude * cos(aToBDeltaLongitudeRadians)));
+        double oneLongitudeRadians = pA->longitudeRadians;
+
+        // The azimuth of our first great circle, the bearing from A to B
+        double oneAzimuthRadians = pA->azimuthRadians;
         if (oneAzimuthRadians < 0) {
             oneAzimuthRadians = (U_GEOFENCE_PI_FLOAT * 2) + oneAzimuthRadians;
         }
@@ -521,10 +760,10 @@ static bool latitudeOfIntersectionSpherical(const uGeofenceCoordinates_t *pA,
         // is that passed in.  The azimuth is 0, north, if pB is above pA,
         // or south if pB is below pA, which comes out in the setting of
         // oneAngle below
-        double twoLongitudeRadians = degreesToRadians(longitude);
+        double twoLongitudeRadians = pPoint->longitudeRadians;
 
         // These values are used multiple times below, so derive them once here
-        double cosLatitude = cos(latitudeRadians);
+        double cosLatitude = pA->cosLatitude;
         double oneTwoDeltaLongitude = longitudeSubtractRadians(twoLongitudeRadians, oneLongitudeRadians);
         double sinHalfOneTwoDeltaLongitude = sin(oneTwoDeltaLongitude / 2);
         // For the generic calculation we would also derive oneTwoDeltaLatitude
@@ -638,8 +877,8 @@ static bool latitudeOfIntersectionSpherical(const uGeofenceCoordinates_t *pA,
                                                    /* cosTwo + */ cosOne * cos(threeAngle));
 
             // Now, finally, we can work out the latitude of point three
-            intersectLatitudeRadians = asin((sin(latitudeRadians) * cos(oneThreeAngularDistance)) +
-                                            (cos(latitudeRadians) * sin(oneThreeAngularDistance) *
+            intersectLatitudeRadians = asin((pA->sinLatitude * cos(oneThreeAngularDistance)) +
+                                            (cosLatitude * sin(oneThreeAngularDistance) *
                                              cos(oneAzimuthRadians)));
         }
     }
@@ -658,26 +897,22 @@ static bool latitudeOfIntersectionSpherical(const uGeofenceCoordinates_t *pA,
 // Implementation note: it would be possible, of course, to have sub-functions
 // to obtain bearing etc. but then it wouldn't be possible to re-use the
 // cosine/sine values across this function.
-static double distanceToSegmentSpherical(const uGeofenceCoordinates_t *pA,
-                                         const uGeofenceCoordinates_t *pB,
-                                         const uGeofenceCoordinates_t *pPoint)
+static double distanceToSegmentSpherical(const uGeofenceVertex_t *pA,
+                                         const uGeofenceVertex_t *pB,
+                                         const uGeofenceVertex_t *pPoint)
 {
     // EVERYTHING INSIDE HERE IS IN RADIANS
 
     double angularDistanceRadians = 0;
-    double aLatitudeRadians = degreesToRadians(pA->latitude);
-    double bLatitudeRadians = degreesToRadians(pB->latitude);
-    double pointLatitudeRadians = degreesToRadians(pPoint->latitude);
-    double aToPointDeltaLatitudeRadians = degreesToRadians(pPoint->latitude - pA->latitude);
-    double aToPointDeltaLongitudeRadians = degreesToRadians(longitudeSubtract(pPoint->longitude,
-                                                                              pA->longitude));
-    double aToBDeltaLongitudeRadians = degreesToRadians(longitudeSubtract(pB->longitude,
-                                                                          pA->longitude));
-    // These values are used multiple times below, so derive them once here
-    double cosPointLatitude = cos(pointLatitudeRadians);
-    double cosALatitude = cos(aLatitudeRadians);
-    double cosBLatitude = cos(bLatitudeRadians);
-    double sinALatitude = sin(aLatitudeRadians);
+    double aToPointDeltaLatitudeRadians = degreesToRadians(pPoint->coordinates.latitude -
+                                                           pA->coordinates.latitude);
+    double aToPointDeltaLongitudeRadians = degreesToRadians(longitudeSubtract(pPoint->coordinates.longitude,
+                                                                              pA->coordinates.longitude));
+    // These values are used multiple times below, so pick them up once here
+    double cosPointLatitude = pPoint->cosLatitude;
+    double cosALatitude = pA->cosLatitude;
+    double cosBLatitude = pB->cosLatitude;
+    double sinALatitude = pA->sinLatitude;
     double sinHalfAToPointDeltaLatitude = sin(aToPointDeltaLatitudeRadians / 2);
     double sinHalfAToPointDeltaLongitude = sin(aToPointDeltaLongitudeRadians / 2);
 
@@ -692,13 +927,11 @@ static double distanceToSegmentSpherical(const uGeofenceCoordinates_t *pA,
     // azimuth being clockwise from north with anticlockwise
     // being negative
     double aToPointAzimuthRadians = atan2(sin(aToPointDeltaLongitudeRadians) * cosPointLatitude,
-                                          (cosALatitude * sin(pointLatitudeRadians)) -
+                                          (cosALatitude * pPoint->sinLatitude) -
                                           (sinALatitude * cosPointLatitude * cos(aToPointDeltaLongitudeRadians)));
 
-    // Calculate the bearing from A to B
-    double aToBAzimuthRadians = atan2(sin(aToBDeltaLongitudeRadians) * cosBLatitude,
-                                      (cosALatitude * sin(bLatitudeRadians)) -
-                                      (sinALatitude * cosBLatitude * cos(aToBDeltaLongitudeRadians)));
+    // The bearing from A to B was worked out when the polygon was compiled
+    double aToBAzimuthRadians = pA->azimuthRadians;
 
     // If the difference in the bearings is greater than 90 degrees
     // then there isn't a normal from the great circle to our point,
@@ -721,25 +954,17 @@ static double distanceToSegmentSpherical(const uGeofenceCoordinates_t *pA,
         if (angularDistanceRadians < 0) {
             angularDistanceRadians = -angularDistanceRadians;
         }
-        // Now check if that is beyond the end of the segment
-        double aToBDeltaLatitudeRadians =  degreesToRadians(pB->latitude - pA->latitude);
-        double sinHalfAToBDeltaLatitude = sin(aToBDeltaLatitudeRadians / 2);
-        double sinHalfAToBDeltaLongitude = sin(aToBDeltaLongitudeRadians / 2);
-        double aToBSquareHalfChord = (sinHalfAToBDeltaLatitude * sinHalfAToBDeltaLatitude) +
-                                     cosALatitude * cosBLatitude *
-                                     sinHalfAToBDeltaLongitude * sinHalfAToBDeltaLongitude;
-        double aToBAngularDistanceRadians = 2 * atan2(sqrt(aToBSquareHalfChord),
-                                                      sqrt(1 - aToBSquareHalfChord));
-        if (aToBAngularDistanceRadians < 0) {
-            aToBAngularDistanceRadians = -aToBAngularDistanceRadians;
-        }
+        // Now check if that is beyond the end of the segment, the angular
+        // length of which was worked out when the polygon was compiled
+        double aToBAngularDistanceRadians = pA->angularLengthRadians;
         if (aToBAngularDistanceRadians < angularDistanceRadians) {
             // The distance is beyond the end of the segment, so the one
             // we want is actually that from our point to point B.  TODO:
             // there might be a shorter way to do this, given all we have above
-            double bToPointDeltaLatitudeRadians = degreesToRadians(pPoint->latitude - pB->latitude);
-            double bToPointDeltaLongitudeRadians = degreesToRadians(longitudeSubtract(pPoint->longitude,
-                                                                                      pB->longitude));
+            double bToPointDeltaLatitudeRadians = degreesToRadians(pPoint->coordinates.latitude -
+                                                                   pB->coordinates.latitude);
+            double bToPointDeltaLongitudeRadians = degreesToRadians(longitudeSubtract(pPoint->coordinates.longitude,
+                                                                                      pB->coordinates.longitude));
             double sinHalfBToPointDeltaLatitude = sin(bToPointDeltaLatitudeRadians / 2);
             double sinHalfBToPointDeltaLongitude = sin(bToPointDeltaLongitudeRadians / 2);
             double bToPointSquareHalfChord = (sinHalfBToPointDeltaLatitude * sinHalfBToPointDeltaLatitude) +
@@ -793,12 +1018,12 @@ static double distanceBetweenPoints(const uGeofenceCoordinates_t *pA,
     return distanceMetres;
 }
 
-// Given a line between two points, populate pLatitude with the
-// latitude at which the given line of longitude, at the given
-// azimuth, cuts it; WGS84, spherical or XY, as appropriate.
-static bool latitudeOfIntersection(const uGeofenceCoordinates_t *pA,
-                                   const uGeofenceCoordinates_t *pB,
-                                   double longitude,
+// Given a polygon edge, from pA to pB, populate pLatitude with the
+// latitude at which the line of longitude of the given point cuts
+// it; WGS84, spherical or XY, as appropriate.
+static bool latitudeOfIntersection(const uGeofenceVertex_t *pA,
+                                   const uGeofenceVertex_t *pB,
+                                   const uGeofenceVertex_t *pPoint,
                                    bool wgs84Required,
                                    double *pLatitude)
 {
@@ -808,16 +1033,15 @@ static bool latitudeOfIntersection(const uGeofenceCoordinates_t *pA,
     if (wgs84Required) {
         // Need to take into account the true shape of the earth, if
         // possible.
-        success = (uGeofenceWgs84LatitudeOfIntersection(pA->latitude,
-                                                        pA->longitude,
-                                                        pB->latitude,
-                                                        pB->longitude,
-                                                        longitude,
+        success = (uGeofenceWgs84LatitudeOfIntersection(pA->coordinates.latitude,
+                                                        pA->coordinates.longitude,
+                                                        pB->coordinates.latitude,
+                                                        pB->coordinates.longitude,
+                                                        pPoint->coordinates.longitude,
                                                         &intersectLatitude) == 0);
         if (!success) {
             // Don't have a WGS84 answer, do it spherically
-            success = latitudeOfIntersectionSpherical(pA, pB,
-                                                      longitude,
+            success = latitudeOfIntersectionSpherical(pA, pB, pPoint,
                                                       &intersectLatitude);
         }
         success = success && (intersectLatitude == intersectLatitude); // nan test
@@ -827,12 +1051,11 @@ static bool latitudeOfIntersection(const uGeofenceCoordinates_t *pA,
         // Note: seems a bit strange to use the aLatitude/aLongitude local variables
         // below but if you don't MSVC somehow gets the contents confused
         // during the calculation
-        double aLatitude = pA->latitude;
-        double aLongitude = pA->longitude;
+        double aLatitude = pA->coordinates.latitude;
+        double aLongitude = pA->coordinates.longitude;
         // codechecker_suppress [readability-suspicious-call-argument]
-        double longitudeDelta = longitudeSubtract(longitude, aLongitude);
-        double slope = (pB->latitude - aLatitude) / longitudeSubtract(pB->longitude, aLongitude);
-        intersectLatitude = aLatitude + (longitudeDelta * slope);
+        double longitudeDelta = longitudeSubtract(pPoint->coordinates.longitude, aLongitude);
+        intersectLatitude = aLatitude + (longitudeDelta * pA->slope);
     }
 
     if (pLatitude != NULL) {
@@ -842,11 +1065,11 @@ static bool latitudeOfIntersection(const uGeofenceCoordinates_t *pA,
     return success;
 }
 
-// The shortest distance from a point to a line segment in metres;
-// WGS84, spherical or XY, calling the above as appropriate.
-static double distanceToSegment(const uGeofenceCoordinates_t *pA,
-                                const uGeofenceCoordinates_t *pB,
-                                const uGeofenceCoordinates_t *pPoint,
+// The shortest distance from a point to a polygon edge, pA to pB,
+// in metres; WGS84, spherical or XY, calling the above as appropriate.
+static double distanceToSegment(const uGeofenceVertex_t *pA,
+                                const uGeofenceVertex_t *pB,
+                                const uGeofenceVertex_t *pPoint,
                                 double metresPerDegreeLongitude,
                                 bool wgs84Required)
 {
@@ -854,12 +1077,12 @@ static double distanceToSegment(const uGeofenceCoordinates_t *pA,
     bool success;
 
     if (wgs84Required) {
-        success = (uGeofenceWgs84DistanceToSegment(pA->latitude,
-                                                   pA->longitude,
-                                                   pB->latitude,
-                                                   pB->longitude,
-                                                   pPoint->latitude,
-                                                   pPoint->longitude,
+        success = (uGeofenceWgs84DistanceToSegment(pA->coordinates.latitude,
+                                                   pA->coordinates.longitude,
+                                                   pB->coordinates.latitude,
+                                                   pB->coordinates.longitude,
+                                                   pPoint->coordinates.latitude,
+                                                   pPoint->coordinates.longitude,
                                                    &distanceMetres) == 0);
         if (!success) {
             // Don't have a WGS84 answer, have to do it spherically
@@ -869,11 +1092,15 @@ static double distanceToSegment(const uGeofenceCoordinates_t *pA,
         // Note: there is an implementation of this, using pure X/Y,
         // over in u_geofence_geodesic.cpp in
         // uGeofenceWgs84DistanceToSegment()
-        double xDeltaPoint =  longitudeSubtract(pPoint->longitude,
-                                                pA->longitude) * metresPerDegreeLongitude;
-        double yDeltaPoint = (pPoint->latitude - pA->latitude) * U_GEOFENCE_METRES_PER_DEGREE_LATITUDE;
-        double xDeltaLine = longitudeSubtract(pB->longitude, pA->longitude) * metresPerDegreeLongitude;
-        double yDeltaLine = (pB->latitude - pA->latitude) * U_GEOFENCE_METRES_PER_DEGREE_LATITUDE;
+        const uGeofenceCoordinates_t *pACoordinates = &(pA->coordinates);
+        const uGeofenceCoordinates_t *pBCoordinates = &(pB->coordinates);
+        const uGeofenceCoordinates_t *pPointCoordinates = &(pPoint->coordinates);
+        double xDeltaPoint =  longitudeSubtract(pPointCoordinates->longitude,
+                                                pACoordinates->longitude) * metresPerDegreeLongitude;
+        double yDeltaPoint = (pPointCoordinates->latitude - pACoordinates->latitude) *
+                             U_GEOFENCE_METRES_PER_DEGREE_LATITUDE;
+        double xDeltaLine = pA->longitudeDelta * metresPerDegreeLongitude;
+        double yDeltaLine = pA->yDeltaMetres;
         // dot represents the proportion of the distance along the line
         // that the "normal" projection of our point lands
         double dot = (xDeltaPoint * xDeltaLine) + (yDeltaPoint * yDeltaLine);
@@ -885,26 +1112,61 @@ static double distanceToSegment(const uGeofenceCoordinates_t *pA,
         double latitude;
         if (param < 0) {
             // Param is out of range, with A beyond our point, so use A
-            longitude = pA->longitude;
-            latitude = pA->latitude;
+            longitude = pACoordinates->longitude;
+            latitude = pACoordinates->latitude;
         } else if (param > 1) {
             // Param is out of range, with B beyond our point, so use B
-            longitude = pB->longitude;
-            latitude = pB->latitude;
+            longitude = pBCoordinates->longitude;
+            latitude = pBCoordinates->latitude;
         } else {
             // In range, just grab the coordinates of where the normal
             // from the line is
-            longitude = pA->longitude + (param * xDeltaLine / metresPerDegreeLongitude);
-            latitude = pA->latitude + (param * yDeltaLine / U_GEOFENCE_METRES_PER_DEGREE_LATITUDE);
+            longitude = pACoordinates->longitude + (param * xDeltaLine / metresPerDegreeLongitude);
+            latitude = pACoordinates->latitude + (param * yDeltaLine / U_GEOFENCE_METRES_PER_DEGREE_LATITUDE);
         }
-        double xDelta = longitudeSubtract(pPoint->longitude, longitude) * metresPerDegreeLongitude;
-        double yDelta = (pPoint->latitude - latitude) * U_GEOFENCE_METRES_PER_DEGREE_LATITUDE;
+        double xDelta = longitudeSubtract(pPointCoordinates->longitude, longitude) * metresPerDegreeLongitude;
+        double yDelta = (pPointCoordinates->latitude - latitude) * U_GEOFENCE_METRES_PER_DEGREE_LATITUDE;
         distanceMetres = sqrt((xDelta * xDelta) + (yDelta * yDelta));
     }
 
     return distanceMetres;
 }
 
+// Return the square of the flat X/Y distance in metres from a point
+// to the bounding box of the polygon edge that starts at pA; since
+// the edge lies within its bounding box this is never more than the
+// square of the distance to the edge itself.
+static double distanceSquaredToEdgeBoxXY(const uGeofenceVertex_t *pA,
+                                         const uGeofenceCoordinates_t *pPoint,
+                                         double metresPerDegreeLongitude)
+{
+    double x = 0;
+    double y = 0;
+    double offset = longitudeSubtract(pPoint->longitude, pA->longitudeWest);
+
+    // The box may be reached going either way around the earth
+    if (offset < 0) {
+        x = -offset;
+        if (offset + 360 - pA->longitudeSpan < x) {
+            x = offset + 360 - pA->longitudeSpan;
+        }
+    } else if (offset > pA->longitudeSpan) {
+        x = offset - pA->longitudeSpan;
+        if (360 - offset < x) {
+            x = 360 - offset;
+        }
+    }
+    if (pPoint->latitude > pA->latitudeMax) {
+        y = pPoint->latitude - pA->latitudeMax;
+    } else if (pPoint->latitude < pA->latitudeMin) {
+        y = pA->latitudeMin - pPoint->latitude;
+    }
+    x *= metresPerDegreeLongitude;
+    y *= U_GEOFENCE_METRES_PER_DEGREE_LATITUDE;
+
+    return (x * x) + (y * y);
+}
+
 #endif // U_CFG_GEOFENCE
 
 /* ----------------------------------------------------------------
@@ -1071,6 +1333,719 @@ static void updateSquareExtentAndWgs84(uGeofenceShape_t *pShape)
     }
 }
 
+// Populate the coordinate-related fields of a compiled vertex; also
+// used for the position under test, so that the radian values and
+// sines/cosines of that are only worked out once.
+static void vertexSetCoordinates(uGeofenceVertex_t *pVertex,
+                                 const uGeofenceCoordinates_t *pCoordinates)
+{
+    pVertex->coordinates = *pCoordinates;
+    pVertex->latitudeRadians = degreesToRadians(pCoordinates->latitude);
+    pVertex->longitudeRadians = degreesToRadians(pCoordinates->longitude);
+    pVertex->cosLatitude = cos(pVertex->latitudeRadians);
+    pVertex->sinLatitude = sin(pVertex->latitudeRadians);
+}
+
+// Populate the edge-related fields of compiled vertex A, the edge
+// being the one that runs from A to B; the coordinate-related
+// fields of both A and B must already have been populated.
+static void vertexSetEdge(uGeofenceVertex_t *pA, const uGeofenceVertex_t *pB)
+{
+    double aLatitude = pA->coordinates.latitude;
+    double bLatitude = pB->coordinates.latitude;
+    double longitudeDelta = longitudeSubtract(pB->coordinates.longitude,
+                                              pA->coordinates.longitude);
+    double longitudeDeltaRadians = degreesToRadians(longitudeDelta);
+    double sinHalfLatitudeDelta = sin(degreesToRadians(bLatitude - aLatitude) / 2);
+    double sinHalfLongitudeDelta = sin(longitudeDeltaRadians / 2);
+    double squareHalfChord;
+
+    // Bounding box, westward-most longitude first so that the
+    // span is always positive, whatever the wrap
+    pA->latitudeMin = aLatitude;
+    pA->latitudeMax = bLatitude;
+    if (bLatitude < aLatitude) {
+        pA->latitudeMin = bLatitude;
+        pA->latitudeMax = aLatitude;
+    }
+    pA->longitudeWest = pA->coordinates.longitude;
+    pA->longitudeSpan = longitudeDelta;
+    if (longitudeDelta < 0) {
+        pA->longitudeWest = pB->coordinates.longitude;
+        pA->longitudeSpan = -longitudeDelta;
+    }
+
+    // The coefficients for flat X/Y maths; a meridian has no slope
+    // but also never needs one as the ray-casting test, a line of
+    // longitude itself, doesn't intersect it
+    pA->longitudeDelta = longitudeDelta;
+    pA->slope = 0;
+    if (longitudeDelta != 0) {
+        pA->slope = (bLatitude - aLatitude) / longitudeDelta;
+    }
+    pA->yDeltaMetres = (bLatitude - aLatitude) * U_GEOFENCE_METRES_PER_DEGREE_LATITUDE;
+
+    // The bearing from A to B and the angular length of the edge
+    // for spherical maths
+    pA->azimuthRadians = atan2(sin(longitudeDeltaRadians) * pB->cosLatitude,
+                               (pA->cosLatitude * pB->sinLatitude) -
+                               (pA->sinLatitude * pB->cosLatitude * cos(longitudeDeltaRadians)));
+    squareHalfChord = (sinHalfLatitudeDelta * sinHalfLatitudeDelta) +
+                      pA->cosLatitude * pB->cosLatitude *
+                      sinHalfLongitudeDelta * sinHalfLongitudeDelta;
+    pA->angularLengthRadians = 2 * atan2(sqrt(squareHalfChord), sqrt(1 - squareHalfChord));
+    if (pA->angularLengthRadians < 0) {
+        pA->angularLengthRadians = -pA->angularLengthRadians;
+    }
+}
+
+// Compile a polygon shape, if it isn't already compiled, turning
+// the linked list of vertices into a contiguous array with all
+// of the per-edge quantities pre-computed.
+static int32_t shapeCompile(uGeofenceShape_t *pShape)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    const uLinkedList_t *pList;
+    uGeofenceVertex_t *pCompiled;
+    size_t vertexCount = 0;
+
+    if ((pShape->type == U_GEOFENCE_SHAPE_TYPE_POLYGON) &&
+        (pShape->pCompiled == NULL)) {
+        pList = pShape->u.pPolygon;
+        while ((pList != NULL) && (pList->p != NULL)) {
+            vertexCount++;
+            pList = pList->pNext;
+        }
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        // +1 for the repeat of the first vertex that closes the polygon
+        pCompiled = (uGeofenceVertex_t *) pUPortMalloc((vertexCount + 1) * sizeof(*pCompiled));
+        if (pCompiled != NULL) {
+            memset(pCompiled, 0, (vertexCount + 1) * sizeof(*pCompiled));
+            pList = pShape->u.pPolygon;
+            for (size_t x = 0; x < vertexCount; x++) {
+                vertexSetCoordinates(&(pCompiled[x]), (const uGeofenceCoordinates_t *) pList->p);
+                pList = pList->pNext;
+            }
+            if (vertexCount > 0) {
+                pCompiled[vertexCount] = pCompiled[0];
+                for (size_t x = 0; x < vertexCount; x++) {
+                    vertexSetEdge(&(pCompiled[x]), &(pCompiled[x + 1]));
+                }
+                // The closing repeat carries the edge of the first vertex,
+                // it is never used but it may as well be consistent
+                pCompiled[vertexCount] = pCompiled[0];
+            }
+            pShape->pCompiled = pCompiled;
+            pShape->compiledVertexCount = vertexCount;
+            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        }
+    }
+
+    return errorCode;
+}
+
+// Discard the compiled form of a shape, e.g. because it has been
+// added to.
+static void shapeUncompile(uGeofenceShape_t *pShape)
+{
+    uPortFree(pShape->pCompiled);
+    pShape->pCompiled = NULL;
+    pShape->compiledVertexCount = 0;
+}
+
+// Return true if all of the shapes of a fence are compiled.
+static bool fenceIsCompiled(const uGeofence_t *pFence)
+{
+    bool isCompiled = true;
+    uLinkedList_t *pList = pFence->pShapes;
+    uGeofenceShape_t *pShape;
+
+    while ((pList != NULL) && isCompiled) {
+        pShape = (uGeofenceShape_t *) pList->p;
+        isCompiled = (pShape == NULL) ||
+                     (pShape->type != U_GEOFENCE_SHAPE_TYPE_POLYGON) ||
+                     (pShape->pCompiled != NULL);
+        pList = pList->pNext;
+    }
+
+    return isCompiled;
+}
+
+// Compile all of the shapes of a fence that are not already compiled.
+static int32_t fenceCompile(const uGeofence_t *pFence)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    uLinkedList_t *pList = pFence->pShapes;
+    uGeofenceShape_t *pShape;
+
+    while ((pList != NULL) && (errorCode == 0)) {
+        pShape = (uGeofenceShape_t *) pList->p;
+        if (pShape != NULL) {
+            errorCode = shapeCompile(pShape);
+        }
+        pList = pList->pNext;
+    }
+
+    return errorCode;
+}
+
+// Get shared access to the uGeofence API in order to test a fence,
+// compiling the fence first if that has not already been done (e.g.
+// because it has just been added to), which requires exclusive access.
+static void lockSharedForTest(const uGeofence_t *pFence)
+{
+    lockShared();
+    if (!fenceIsCompiled(pFence)) {
+        unlockShared();
+        lockExclusive();
+        // Errors are ignored: a shape that could not be compiled
+        // gives an outcome of "none" when tested
+        fenceCompile(pFence);
+        exclusiveToShared();
+    }
+}
+
+#endif // U_CFG_GEOFENCE
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: SPATIAL INDEX
+ * -------------------------------------------------------------- */
+
+#ifdef U_CFG_GEOFENCE
+
+// Set a box to be the entire planet.
+static void indexBoxSetAll(uGeofenceSquare_t *pBox)
+{
+    pBox->min.latitude = -90;
+    pBox->max.latitude = 90;
+    pBox->min.longitude = -180;
+    pBox->max.longitude = 180;
+}
+
+// Extend box A to include box B.
+static void indexBoxExtend(uGeofenceSquare_t *pA, const uGeofenceSquare_t *pB)
+{
+    if (pB->min.latitude < pA->min.latitude) {
+        pA->min.latitude = pB->min.latitude;
+    }
+    if (pB->max.latitude > pA->max.latitude) {
+        pA->max.latitude = pB->max.latitude;
+    }
+    if (pB->min.longitude < pA->min.longitude) {
+        pA->min.longitude = pB->min.longitude;
+    }
+    if (pB->max.longitude > pA->max.longitude) {
+        pA->max.longitude = pB->max.longitude;
+    }
+}
+
+// Return true if a box contains the given point; index boxes never
+// cross the 180 degree line of longitude.
+static bool indexBoxContains(const uGeofenceSquare_t *pBox,
+                             const uGeofenceCoordinates_t *pCoordinates)
+{
+    return (pCoordinates->latitude >= pBox->min.latitude) &&
+           (pCoordinates->latitude <= pBox->max.latitude) &&
+           (pCoordinates->longitude >= pBox->min.longitude) &&
+           (pCoordinates->longitude <= pBox->max.longitude);
+}
+
+// Populate the index entries for a shape from its square extent,
+// returning the number of entries used, one or two.
+static size_t indexEntriesSet(uGeofenceIndexEntry_t *pEntry,
+                              const uGeofenceShape_t *pShape,
+                              size_t fenceIndex, size_t shapeSlot)
+{
+    size_t numEntries = 1;
+    const uGeofenceSquare_t *pSquareExtent = &(pShape->squareExtent);
+    uGeofenceSquare_t *pBox = &(pEntry->box);
+    double longitudeSpan;
+
+    pEntry->fenceIndex = fenceIndex;
+    pEntry->shapeSlot = shapeSlot;
+    if (pSquareExtent->max.latitude != pSquareExtent->max.latitude) { // NAN test
+        // No square extent check is possible, the shape is always a candidate
+        indexBoxSetAll(pBox);
+    } else {
+        pBox->min.latitude = pSquareExtent->min.latitude - U_GEOFENCE_INDEX_MARGIN_DEGREES;
+        pBox->max.latitude = pSquareExtent->max.latitude + U_GEOFENCE_INDEX_MARGIN_DEGREES;
+        // testSquareExtent() is happy with any position that is east of
+        // the minimum longitude and west of the maximum longitude, so
+        // the box runs eastwards from the first to the second, which
+        // may take it across the 180 degree line of longitude
+        longitudeSpan = pSquareExtent->max.longitude - pSquareExtent->min.longitude;
+        if (longitudeSpan < 0) {
+            longitudeSpan += 360;
+        }
+        pBox->min.longitude = pSquareExtent->min.longitude - U_GEOFENCE_INDEX_MARGIN_DEGREES;
+        pBox->max.longitude = pBox->min.longitude + longitudeSpan + (U_GEOFENCE_INDEX_MARGIN_DEGREES * 2);
+        if (pBox->min.longitude < -180) {
+            pBox->min.longitude += 360;
+            pBox->max.longitude += 360;
+        }
+        if (pBox->max.longitude - pBox->min.longitude >= 360) {
+            pBox->min.longitude = -180;
+            pBox->max.longitude = 180;
+        } else if (pBox->max.longitude > 180) {
+            // Split the box in two at the 180 degree line of longitude
+            pEntry[1] = pEntry[0];
+            pEntry[1].box.min.longitude = -180;
+            pEntry[1].box.max.longitude = pBox->max.longitude - 360;
+            pBox->max.longitude = 180;
+            numEntries++;
+        }
+    }
+
+    return numEntries;
+}
+
+// qsort() comparison function: order index entries by the
+// centre of their longitude.
+static int indexCompareLongitude(const void *pA, const void *pB)
+{
+    const uGeofenceSquare_t *pBoxA = &(((const uGeofenceIndexEntry_t *) pA)->box);
+    const uGeofenceSquare_t *pBoxB = &(((const uGeofenceIndexEntry_t *) pB)->box);
+    double a = pBoxA->min.longitude + pBoxA->max.longitude;
+    double b = pBoxB->min.longitude + pBoxB->max.longitude;
+
+    return (a > b) - (a < b);
+}
+
+// qsort() comparison function: order index entries by the
+// centre of their latitude.
+static int indexCompareLatitude(const void *pA, const void *pB)
+{
+    const uGeofenceSquare_t *pBoxA = &(((const uGeofenceIndexEntry_t *) pA)->box);
+    const uGeofenceSquare_t *pBoxB = &(((const uGeofenceIndexEntry_t *) pB)->box);
+    double a = pBoxA->min.latitude + pBoxA->max.latitude;
+    double b = pBoxB->min.latitude + pBoxB->max.latitude;
+
+    return (a > b) - (a < b);
+}
+
+// Return the amount of storage that a query of a spatial index needs.
+static size_t indexQuerySize(const uGeofenceIndex_t *pIndex)
+{
+    return (pIndex->stackLength * sizeof(size_t)) +
+           ((pIndex->numFences + 7) >> 3) + ((pIndex->numShapeSlots + 7) >> 3);
+}
+
+// Lay out a query of a spatial index in pStorage, which must be of
+// at least indexQuerySize(), with all marks clear.
+static void indexQueryInit(const uGeofenceIndex_t *pIndex,
+                           uGeofenceIndexQuery_t *pQuery, size_t *pStorage)
+{
+    size_t fenceMarksSize = (pIndex->numFences + 7) >> 3;
+    size_t shapeMarksSize = (pIndex->numShapeSlots + 7) >> 3;
+
+    // The stack goes first so that it is aligned
+    pQuery->pStack = pStorage;
+    pQuery->pFenceMarks = (uint8_t *) (pQuery->pStack + pIndex->stackLength);
+    pQuery->pShapeMarks = pQuery->pFenceMarks + fenceMarksSize;
+    memset(pQuery->pFenceMarks, 0, fenceMarksSize + shapeMarksSize);
+}
+
+// Free a spatial index.
+static void indexFree(uGeofenceIndex_t *pIndex)
+{
+    if (pIndex != NULL) {
+        uPortFree(pIndex->pEntries);
+        uPortFree(pIndex->pNodes);
+        uPortFree(pIndex->pFenceShapeSlot);
+        uPortFree(pIndex->pScratch);
+        uPortFree(pIndex);
+    }
+}
+
+// Build a spatial index over the shapes of the given list of fences,
+// returning NULL if there are too few shapes to be worth it or if
+// there is not enough memory, in which case all shapes are tested.
+// The index is a packed R-tree, bulk-loaded using the sort-tile-
+// recursive method: sort the shapes into vertical slices by longitude,
+// sort each slice by latitude, pack the result into leaf nodes and
+// then pack each level of nodes into the level above.
+static uGeofenceIndex_t *pIndexBuild(const uLinkedList_t *pFences)
+{
+    uGeofenceIndex_t *pIndex = NULL;
+    const uLinkedList_t *pList;
+    const uLinkedList_t *pShapeList;
+    const uGeofence_t *pFence;
+    uGeofenceIndexNode_t *pNode;
+    size_t numFences = 0;
+    size_t numShapes = 0;
+    size_t numSlices;
+    size_t sliceLength;
+    size_t levelStart;
+    size_t levelLength;
+    size_t numLevels;
+    size_t x;
+    size_t y;
+
+    for (pList = pFences; pList != NULL; pList = pList->pNext) {
+        pFence = (const uGeofence_t *) pList->p;
+        numFences++;
+        if (pFence != NULL) {
+            for (pShapeList = pFence->pShapes; pShapeList != NULL; pShapeList = pShapeList->pNext) {
+                numShapes++;
+            }
+        }
+    }
+
+    if ((U_GEOFENCE_INDEX_SHAPES_MIN > 0) && (numShapes >= U_GEOFENCE_INDEX_SHAPES_MIN)) {
+        pIndex = (uGeofenceIndex_t *) pUPortMalloc(sizeof(*pIndex));
+        if (pIndex != NULL) {
+            memset(pIndex, 0, sizeof(*pIndex));
+            pIndex->numFences = numFences;
+            pIndex->numShapeSlots = numShapes;
+            // Each shape may need two entries
+            pIndex->pEntries = (uGeofenceIndexEntry_t *) pUPortMalloc(numShapes * 2 *
+                                                                      sizeof(*pIndex->pEntries));
+            pIndex->pFenceShapeSlot = (size_t *) pUPortMalloc(numFences * sizeof(size_t));
+            if ((pIndex->pEntries != NULL) && (pIndex->pFenceShapeSlot != NULL)) {
+                // Populate the entries, in the order the fences and
+                // shapes will be walked when testing
+                x = 0;
+                y = 0;
+                for (pList = pFences; pList != NULL; pList = pList->pNext) {
+                    pFence = (const uGeofence_t *) pList->p;
+                    pIndex->pFenceShapeSlot[x] = y;
+                    if (pFence != NULL) {
+                        for (pShapeList = pFence->pShapes; pShapeList != NULL; pShapeList = pShapeList->pNext) {
+                            pIndex->numEntries += indexEntriesSet(&(pIndex->pEntries[pIndex->numEntries]),
+                                                                  (const uGeofenceShape_t *) pShapeList->p,
+                                                                  x, y);
+                            y++;
+                        }
+                    }
+                    x++;
+                }
+                // Sort into slices by longitude and each slice by latitude
+                pIndex->numLeafNodes = (pIndex->numEntries + U_GEOFENCE_INDEX_NODE_CHILDREN - 1) /
+                                       U_GEOFENCE_INDEX_NODE_CHILDREN;
+                numSlices = (size_t) ceil(sqrt((double) pIndex->numLeafNodes));
+                sliceLength = numSlices * U_GEOFENCE_INDEX_NODE_CHILDREN;
+                qsort(pIndex->pEntries, pIndex->numEntries, sizeof(*pIndex->pEntries),
+                      indexCompareLongitude);
+                for (x = 0; x < pIndex->numEntries; x += sliceLength) {
+                    y = pIndex->numEntries - x;
+                    if (y > sliceLength) {
+                        y = sliceLength;
+                    }
+                    qsort(&(pIndex->pEntries[x]), y, sizeof(*pIndex->pEntries),
+                          indexCompareLatitude);
+                }
+                // Work out how many nodes there will be across all levels
+                numLevels = 1;
+                pIndex->numNodes = pIndex->numLeafNodes;
+                for (levelLength = pIndex->numLeafNodes; levelLength > 1;
+                     levelLength = (levelLength + U_GEOFENCE_INDEX_NODE_CHILDREN - 1) /
+                                   U_GEOFENCE_INDEX_NODE_CHILDREN) {
+                    pIndex->numNodes += (levelLength + U_GEOFENCE_INDEX_NODE_CHILDREN - 1) /
+                                        U_GEOFENCE_INDEX_NODE_CHILDREN;
+                    numLevels++;
+                }
+                pIndex->pNodes = (uGeofenceIndexNode_t *) pUPortMalloc(pIndex->numNodes *
+                                                                       sizeof(*pIndex->pNodes));
+                // A query visits one level at a time, so the stack never
+                // holds more than this
+                pIndex->stackLength = (numLevels * (U_GEOFENCE_INDEX_NODE_CHILDREN - 1)) + 1;
+                pIndex->pScratch = (size_t *) pUPortMalloc(indexQuerySize(pIndex));
+            }
+            if ((pIndex->pNodes != NULL) && (pIndex->pScratch != NULL)) {
+                // Pack the leaf nodes, then each level into the next
+                levelStart = 0;
+                levelLength = pIndex->numEntries;
+                y = 0;
+                while (y < pIndex->numNodes) {
+                    for (x = 0; x < levelLength; x += U_GEOFENCE_INDEX_NODE_CHILDREN) {
+                        pNode = &(pIndex->pNodes[y]);
+                        pNode->firstChild = levelStart + x;
+                        pNode->numChildren = levelLength - x;
+                        if (pNode->numChildren > U_GEOFENCE_INDEX_NODE_CHILDREN) {
+                            pNode->numChildren = U_GEOFENCE_INDEX_NODE_CHILDREN;
+                        }
+                        for (size_t z = 0; z < pNode->numChildren; z++) {
+                            if (y < pIndex->numLeafNodes) {
+                                if (z == 0) {
+                                    pNode->box = pIndex->pEntries[pNode->firstChild].box;
+                                }
+                                indexBoxExtend(&(pNode->box), &(pIndex->pEntries[pNode->firstChild + z].box));
+                            } else {
+                                if (z == 0) {
+                                    pNode->box = pIndex->pNodes[pNode->firstChild].box;
+                                }
+                                indexBoxExtend(&(pNode->box), &(pIndex->pNodes[pNode->firstChild + z].box));
+                            }
+                        }
+                        y++;
+                    }
+                    // The level just packed becomes the children of the next
+                    levelStart = y - ((levelLength + U_GEOFENCE_INDEX_NODE_CHILDREN - 1) /
+                                      U_GEOFENCE_INDEX_NODE_CHILDREN);
+                    levelLength = y - levelStart;
+                }
+            } else {
+                // Clean up on error
+                indexFree(pIndex);
+                pIndex = NULL;
+            }
+        }
+    }
+
+    return pIndex;
+}
+
+// Set a bit in a bitmap of marks.
+static void indexMarkSet(uint8_t *pMarks, size_t bit)
+{
+    pMarks[bit >> 3] |= (uint8_t) (1U << (bit & 0x07));
+}
+
+// Return true if a bit in a bitmap of marks is set.
+static bool indexMarkIsSet(const uint8_t *pMarks, size_t bit)
+{
+    return (pMarks[bit >> 3] & (1U << (bit & 0x07))) != 0;
+}
+
+// Claim the storage for a query of a spatial index, with all marks
+// clear: the storage of the index if no one else has it, else
+// storage of our own, returning false if there is no memory for
+// that, in which case all shapes should be tested, which gives the
+// same outcome, just more slowly.  Call indexQueryRelease() when done.
+static bool indexQueryClaim(uGeofenceIndex_t *pIndex,
+                            uGeofenceIndexQuery_t *pQuery)
+{
+    size_t *pStorage = NULL;
+
+    U_PORT_MUTEX_LOCK(gSharedMutex);
+    if (!pIndex->scratchInUse) {
+        pIndex->scratchInUse = true;
+        pStorage = pIndex->pScratch;
+    }
+    U_PORT_MUTEX_UNLOCK(gSharedMutex);
+    if (pStorage == NULL) {
+        // Another task is testing the same context at the same time
+        pStorage = (size_t *) pUPortMalloc(indexQuerySize(pIndex));
+    }
+    if (pStorage != NULL) {
+        indexQueryInit(pIndex, pQuery, pStorage);
+    }
+
+    return (pStorage != NULL);
+}
+
+// Release the storage claimed by indexQueryClaim().
+static void indexQueryRelease(uGeofenceIndex_t *pIndex,
+                              uGeofenceIndexQuery_t *pQuery)
+{
+    if (pQuery->pStack == pIndex->pScratch) {
+        U_PORT_MUTEX_LOCK(gSharedMutex);
+        pIndex->scratchInUse = false;
+        U_PORT_MUTEX_UNLOCK(gSharedMutex);
+    } else {
+        uPortFree(pQuery->pStack);
+    }
+    pQuery->pStack = NULL;
+}
+
+// Query a spatial index with a position, marking every shape, and
+// the fence of every shape, whose square extent the position might
+// be within; the marks in pQuery must be clear.
+static void indexQuery(const uGeofenceIndex_t *pIndex,
+                       const uGeofenceCoordinates_t *pCoordinates,
+                       uGeofenceIndexQuery_t *pQuery)
+{
+    const uGeofenceIndexNode_t *pNode;
+    const uGeofenceIndexEntry_t *pEntry;
+    size_t stackLength = 0;
+
+    // Start at the root, which is the last node
+    pQuery->pStack[stackLength] = pIndex->numNodes - 1;
+    stackLength++;
+    while (stackLength > 0) {
+        stackLength--;
+        pNode = &(pIndex->pNodes[pQuery->pStack[stackLength]]);
+        if (indexBoxContains(&(pNode->box), pCoordinates)) {
+            if (pQuery->pStack[stackLength] < pIndex->numLeafNodes) {
+                for (size_t x = 0; x < pNode->numChildren; x++) {
+                    pEntry = &(pIndex->pEntries[pNode->firstChild + x]);
+                    if (indexBoxContains(&(pEntry->box), pCoordinates)) {
+                        indexMarkSet(pQuery->pShapeMarks, pEntry->shapeSlot);
+                        indexMarkSet(pQuery->pFenceMarks, pEntry->fenceIndex);
+                    }
+                }
+            } else {
+                for (size_t x = 0; x < pNode->numChildren; x++) {
+                    pQuery->pStack[stackLength] = pNode->firstChild + x;
+                    stackLength++;
+                }
+            }
+        }
+    }
+}
+
+// Rebuild the spatial index of a geofence context, e.g. because
+// a fence has been applied or removed.
+static void contextIndexRebuild(uGeofenceContext_t *pFenceContext)
+{
+    indexFree((uGeofenceIndex_t *) pFenceContext->pIndex);
+    pFenceContext->pIndex = pIndexBuild(pFenceContext->pFences);
+}
+
+#endif // U_CFG_GEOFENCE
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: SAFE RADIUS
+ * -------------------------------------------------------------- */
+
+#ifdef U_CFG_GEOFENCE
+
+// Free a safe radius cache.
+static void safeRadiusCacheFree(uGeofenceSafeRadiusCache_t *pCache)
+{
+    if (pCache != NULL) {
+        uPortFree(pCache->pShapes);
+        uPortFree(pCache->pFenceShapeSlot);
+        uPortFree(pCache);
+    }
+}
+
+// Create a safe radius cache, with no outcomes in it, for the given
+// list of fences, returning NULL if there are no shapes, too many
+// shapes or there is not enough memory.
+static uGeofenceSafeRadiusCache_t *pSafeRadiusCacheBuild(const uLinkedList_t *pFences)
+{
+    uGeofenceSafeRadiusCache_t *pCache = NULL;
+    const uLinkedList_t *pList;
+    const uLinkedList_t *pShapeList;
+    const uGeofence_t *pFence;
+    size_t numFences = 0;
+    size_t numShapes = 0;
+
+    for (pList = pFences; pList != NULL; pList = pList->pNext) {
+        pFence = (const uGeofence_t *) pList->p;
+        numFences++;
+        if (pFence != NULL) {
+            for (pShapeList = pFence->pShapes; pShapeList != NULL; pShapeList = pShapeList->pNext) {
+                numShapes++;
+            }
+        }
+    }
+
+    if ((numShapes > 0) && (numShapes <= U_GEOFENCE_SAFE_RADIUS_SHAPES_MAX)) {
+        pCache = (uGeofenceSafeRadiusCache_t *) pUPortMalloc(sizeof(*pCache));
+        if (pCache != NULL) {
+            pCache->numFences = numFences;
+            pCache->pShapes = (uGeofenceSafeRadius_t *) pUPortMalloc(numShapes *
+                                                                     sizeof(*pCache->pShapes));
+            pCache->pFenceShapeSlot = (size_t *) pUPortMalloc(numFences * sizeof(size_t));
+            if ((pCache->pShapes != NULL) && (pCache->pFenceShapeSlot != NULL)) {
+                for (size_t x = 0; x < numShapes; x++) {
+                    pCache->pShapes[x].safeRadiusMetres = NAN;
+                }
+                numFences = 0;
+                numShapes = 0;
+                for (pList = pFences; pList != NULL; pList = pList->pNext) {
+                    pFence = (const uGeofence_t *) pList->p;
+                    pCache->pFenceShapeSlot[numFences] = numShapes;
+                    if (pFence != NULL) {
+                        for (pShapeList = pFence->pShapes; pShapeList != NULL;
+                             pShapeList = pShapeList->pNext) {
+                            numShapes++;
+                        }
+                    }
+                    numFences++;
+                }
+            } else {
+                // Clean up on error
+                safeRadiusCacheFree(pCache);
+                pCache = NULL;
+            }
+        }
+    }
+
+    return pCache;
+}
+
+// Rebuild the safe radius cache of a geofence context, e.g. because
+// a fence has been applied or removed; any outcomes are forgotten.
+static void contextSafeRadiusRebuild(uGeofenceContext_t *pFenceContext)
+{
+    safeRadiusCacheFree((uGeofenceSafeRadiusCache_t *) pFenceContext->pSafeRadius);
+    pFenceContext->pSafeRadius = pSafeRadiusCacheBuild(pFenceContext->pFences);
+}
+
+// Return true if the outcome held in a safe radius entry must also be
+// the outcome for the given position and radius of position, in which
+// case pDistanceMetres is set to a lower bound on the distance from the
+// position to the edge of the shape.  Only valid where the shape may be
+// tested with flat earth maths.
+static bool safeRadiusCovers(const uGeofenceSafeRadius_t *pSafeRadius,
+                             const uGeofenceCoordinates_t *pCoordinates,
+                             double metresPerDegreeLongitude,
+                             int32_t radiusMillimetres,
+                             double *pDistanceMetres)
+{
+    bool covers = false;
+    double safeRadiusMetres = pSafeRadius->safeRadiusMetres * U_GEOFENCE_SAFE_RADIUS_FACTOR;
+    double limitMetres;
+    double x;
+    double y;
+
+    if (safeRadiusMetres == safeRadiusMetres) { // NAN test
+        // The position, plus its radius, must be inside the safe radius
+        limitMetres = safeRadiusMetres - (((double) radiusMillimetres) / 1000) -
+                      U_GEOFENCE_EDGE_BOX_MARGIN_METRES;
+        if (limitMetres > 0) {
+            x = longitudeSubtract(pCoordinates->longitude,
+                                  pSafeRadius->coordinates.longitude) * metresPerDegreeLongitude;
+            y = (pCoordinates->latitude - pSafeRadius->coordinates.latitude) *
+                U_GEOFENCE_METRES_PER_DEGREE_LATITUDE;
+            if ((x * x) + (y * y) < limitMetres * limitMetres) {
+                covers = true;
+                *pDistanceMetres = safeRadiusMetres - sqrt((x * x) + (y * y));
+            }
+        }
+    }
+
+    return covers;
+}
+
+// Remember the outcome of a test of a shape: only a certain
+// outcome for which the distance to the edge of the shape is known,
+// calculated with flat earth maths, may be remembered.
+static void safeRadiusSet(uGeofenceSafeRadius_t *pSafeRadius,
+                          const uGeofenceCoordinates_t *pCoordinates,
+                          uGeofencePositionState_t positionState,
+                          bool certainAndFlat,
+                          double distanceMetres)
+{
+    uGeofenceSafeRadius_t safeRadius = {0};
+
+    safeRadius.safeRadiusMetres = NAN;
+    if (certainAndFlat && (distanceMetres > 0) && // Also false for NAN
+        ((positionState == U_GEOFENCE_POSITION_STATE_INSIDE) ||
+         (positionState == U_GEOFENCE_POSITION_STATE_OUTSIDE))) {
+        safeRadius.coordinates = *pCoordinates;
+        safeRadius.positionState = positionState;
+        safeRadius.safeRadiusMetres = distanceMetres;
+    }
+    // Another task may be testing the same context, so the entry
+    // is only ever copied in or out as a whole, under gSharedMutex
+    U_PORT_MUTEX_LOCK(gSharedMutex);
+    *pSafeRadius = safeRadius;
+    U_PORT_MUTEX_UNLOCK(gSharedMutex);
+}
+
+// Take a copy of a safe radius entry; see safeRadiusSet().
+static void safeRadiusGet(const uGeofenceSafeRadius_t *pSafeRadius,
+                          uGeofenceSafeRadius_t *pCopy)
+{
+    U_PORT_MUTEX_LOCK(gSharedMutex);
+    *pCopy = *pSafeRadius;
+    U_PORT_MUTEX_UNLOCK(gSharedMutex);
+}
+
 #endif // U_CFG_GEOFENCE
 
 /* ----------------------------------------------------------------
@@ -1394,114 +2369,127 @@ static uGeofencePositionState_t testCircle(const uGeofenceCircle_t *pCircle,
 //    3.4) ALSO, IF "IS UNCERTAIN"  is false, check if the shortest
 //         distance from our point to the segment is less than the
 //         radius of position: if so, set "IS UNCERTAIN" to true.
+//         On a flat earth, a segment whose bounding box is further
+//         away than both the radius of position and the nearest
+//         segment so far cannot change the outcome and is skipped.
 //
 // 4: When all segments have been tested or skipped the states of
 //    "IS INSIDE" and "IS UNCERTAIN" are correct.
 //
-static uGeofencePositionState_t testPolygon(const uLinkedList_t *pPolygon,
+static uGeofencePositionState_t testPolygon(const uGeofenceVertex_t *pPolygon,
+                                            size_t vertexCount,
                                             bool wgs84Required,
                                             double metresPerDegreeLongitude,
-                                            const uGeofenceCoordinates_t *pCoordinates,
+                                            const uGeofenceVertex_t *pPoint,
                                             int32_t uncertaintyMillimetres,
                                             double *pDistanceMetres,
                                             bool *pUncertain)
 {
     uGeofencePositionState_t positionState = U_GEOFENCE_POSITION_STATE_NONE;
-    int32_t vertexCount = 0;
     bool isInside = false;
     bool exitNow = false;
     bool calculationFailure = false;
-    const uLinkedList_t *pTmp = pPolygon;
-    uGeofenceCoordinates_t *pSide[2] = {0};
+    bool skipSide;
+    const uGeofenceCoordinates_t *pCoordinates = &(pPoint->coordinates);
+    const uGeofenceVertex_t *pSide[2] = {0};
     double cutLatitude = NAN;
     double distanceMetres;
     double distanceMinMetres = NAN;
+    double distanceThresholdMetres;
 
     *pDistanceMetres = NAN;
     *pUncertain = false;
 
-    // First count the number of vertices
-    while ((pTmp != NULL) && (pTmp->p != NULL)) {
-        vertexCount++;
-        pTmp = pTmp->pNext;
-    }
-    if (vertexCount >= 3) {
+    if ((pPolygon != NULL) && (vertexCount >= 3)) {
         // Check all sides making sure to check the final
-        // side which links back to the first vertex
-        while ((vertexCount >= 0) && !exitNow) {
-            if (pTmp == NULL) {
-                // This sets us up at the beginning and also
-                // at the end, to pick up the first vertexCount
-                // that ends the last side
-                pTmp = pPolygon;
-            }
-            pSide[0] = (uGeofenceCoordinates_t *) pTmp->p;
-            if (pSide[0] != NULL) {
-                // Now have a side which starts at pSide[1] and ends at pSide[0]
-                if ((pSide[0]->latitude == pCoordinates->latitude) &&
-                    (pSide[0]->longitude == pCoordinates->longitude)) {
-                    // Check 2 has been met, we're in
-                    isInside = true;
-                    if (uncertaintyMillimetres > 0) {
-                        // ...uncertainly
-                        *pUncertain = true;
-                    }
-                    exitNow = true;
-                } else {
-                    if (pSide[1] != NULL) {
-                        // These things are used multiple times below so set them out here
-                        double longitude1Delta = longitudeSubtract(pCoordinates->longitude, pSide[1]->longitude);
-                        double longitude0Delta = longitudeSubtract(pCoordinates->longitude, pSide[0]->longitude);
-                        bool sideIsBelow = (pSide[1]->latitude < pCoordinates->latitude) &&
-                                           (pSide[0]->latitude < pCoordinates->latitude);
-                        // Check 3.0
-                        if ((((longitude1Delta > 0) && (longitude0Delta > 0)) ||
-                             ((longitude1Delta < 0) && (longitude0Delta < 0))) || sideIsBelow) {
-                            // No intersection
+        // side which links back to the first vertex; the
+        // compiled polygon has the first vertex repeated
+        // on the end for exactly that purpose
+        for (size_t x = 0; (x <= vertexCount) && !exitNow; x++) {
+            pSide[0] = &(pPolygon[x]);
+            // Now have a side which starts at pSide[1] and ends at pSide[0],
+            // the pre-computed quantities for the side being in pSide[1]
+            if ((pSide[0]->coordinates.latitude == pCoordinates->latitude) &&
+                (pSide[0]->coordinates.longitude == pCoordinates->longitude)) {
+                // Check 2 has been met, we're in
+                isInside = true;
+                if (uncertaintyMillimetres > 0) {
+                    // ...uncertainly
+                    *pUncertain = true;
+                }
+                exitNow = true;
+            } else {
+                if (pSide[1] != NULL) {
+                    // These things are used multiple times below so set them out here
+                    double longitude1Delta = longitudeSubtract(pCoordinates->longitude,
+                                                               pSide[1]->coordinates.longitude);
+                    double longitude0Delta = longitudeSubtract(pCoordinates->longitude,
+                                                               pSide[0]->coordinates.longitude);
+                    bool sideIsBelow = (pSide[1]->latitudeMax < pCoordinates->latitude);
+                    // Check 3.0
+                    if ((((longitude1Delta > 0) && (longitude0Delta > 0)) ||
+                         ((longitude1Delta < 0) && (longitude0Delta < 0))) || sideIsBelow) {
+                        // No intersection
+                    } else {
+                        // Check 3.1
+                        bool vertex1Intersection = (pSide[1]->coordinates.longitude == pCoordinates->longitude) &&
+                                                   (pSide[1]->coordinates.latitude >= pCoordinates->latitude);
+                        bool vertex0Intersection = (pSide[0]->coordinates.longitude == pCoordinates->longitude) &&
+                                                   (pSide[0]->coordinates.latitude >= pCoordinates->latitude);
+                        if (vertex1Intersection || vertex0Intersection) {
+                            if ((vertex1Intersection && (longitude0Delta > 0)) ||
+                                (vertex0Intersection && (longitude1Delta > 0))) {
+                                // Flip
+                                isInside = !isInside;
+                            }
                         } else {
-                            // Check 3.1
-                            bool vertex1Intersection = (pSide[1]->longitude == pCoordinates->longitude) &&
-                                                       (pSide[1]->latitude >= pCoordinates->latitude);
-                            bool vertex0Intersection = (pSide[0]->longitude == pCoordinates->longitude) &&
-                                                       (pSide[0]->latitude >= pCoordinates->latitude);
-                            if (vertex1Intersection || vertex0Intersection) {
-                                if ((vertex1Intersection && (longitude0Delta > 0)) ||
-                                    (vertex0Intersection && (longitude1Delta > 0))) {
-                                    // Flip
-                                    isInside = !isInside;
-                                }
-                            } else {
-                                // Check 3.2
-                                double longitude1DeltaAbs = longitude1Delta;
-                                if (longitude1DeltaAbs < 0) {
-                                    longitude1DeltaAbs = -longitude1DeltaAbs;
-                                }
-                                double longitude0DeltaAbs = longitude0Delta;
-                                if (longitude0DeltaAbs < 0) {
-                                    longitude0DeltaAbs = -longitude0DeltaAbs;
-                                }
-                                if ((longitude1DeltaAbs + longitude0DeltaAbs <= 180)) {
-                                    // Check 3.3: need to do some calculations
-                                    calculationFailure = !latitudeOfIntersection(pSide[1], pSide[0],
-                                                                                 pCoordinates->longitude,
-                                                                                 wgs84Required,
-                                                                                 &cutLatitude);
-                                    if (calculationFailure) {
-                                        exitNow = true;
-                                    } else {
-                                        if (cutLatitude >= pCoordinates->latitude) {
-                                            // Flip
-                                            isInside = !isInside;
-                                        }
+                            // Check 3.2
+                            double longitude1DeltaAbs = longitude1Delta;
+                            if (longitude1DeltaAbs < 0) {
+                                longitude1DeltaAbs = -longitude1DeltaAbs;
+                            }
+                            double longitude0DeltaAbs = longitude0Delta;
+                            if (longitude0DeltaAbs < 0) {
+                                longitude0DeltaAbs = -longitude0DeltaAbs;
+                            }
+                            if ((longitude1DeltaAbs + longitude0DeltaAbs <= 180)) {
+                                // Check 3.3: need to do some calculations
+                                calculationFailure = !latitudeOfIntersection(pSide[1], pSide[0],
+                                                                             pPoint,
+                                                                             wgs84Required,
+                                                                             &cutLatitude);
+                                if (calculationFailure) {
+                                    exitNow = true;
+                                } else {
+                                    if (cutLatitude >= pCoordinates->latitude) {
+                                        // Flip
+                                        isInside = !isInside;
                                     }
                                 }
                             }
                         }
-                        // Check 3.4
-                        if (!*pUncertain && (uncertaintyMillimetres > 0)) {
-                            // Check if the shortest distance between the side
-                            // and our point is less than the uncertainty
-                            distanceMetres = distanceToSegment(pSide[1], pSide[0], pCoordinates,
+                    }
+                    // Check 3.4
+                    if (!*pUncertain && (uncertaintyMillimetres > 0)) {
+                        // Check if the shortest distance between the side
+                        // and our point is less than the uncertainty.  On a
+                        // flat earth, if the bounding box of the side is
+                        // further away than both the uncertainty and the
+                        // nearest side so far then this side can't change
+                        // anything and the calculation can be skipped
+                        skipSide = false;
+                        if (!wgs84Required && (distanceMinMetres == distanceMinMetres)) { // NAN test
+                            distanceThresholdMetres = distanceMinMetres;
+                            if (uncertaintyMillimetres > distanceThresholdMetres * 1000) {
+                                distanceThresholdMetres = ((double) uncertaintyMillimetres) / 1000;
+                            }
+                            distanceThresholdMetres += U_GEOFENCE_EDGE_BOX_MARGIN_METRES;
+                            skipSide = (distanceSquaredToEdgeBoxXY(pSide[1], pCoordinates,
+                                                                   metresPerDegreeLongitude) >
+                                        distanceThresholdMetres * distanceThresholdMetres);
+                        }
+                        if (!skipSide) {
+                            distanceMetres = distanceToSegment(pSide[1], pSide[0], pPoint,
                                                                metresPerDegreeLongitude, wgs84Required);
                             calculationFailure = (distanceMetres != distanceMetres);  // NAN test
                             if (calculationFailure) {
@@ -1515,11 +2503,9 @@ static uGeofencePositionState_t testPolygon(const uLinkedList_t *pPolygon,
                             }
                         }
                     }
-                    pSide[1] = pSide[0];
                 }
+                pSide[1] = pSide[0];
             }
-            vertexCount--;
-            pTmp = pTmp->pNext;
         }
 
         if (!calculationFailure) {
@@ -1541,140 +2527,270 @@ static bool testKeepGoing(uGeofencePositionState_t positionState)
     return !(positionState == U_GEOFENCE_POSITION_STATE_INSIDE);
 }
 
-// Test a single position against a fence.
-bool testPosition(const uGeofence_t *pFence,
-                  uGeofenceTestType_t testType,
-                  bool pessimisticNotOptimistic,
-                  uGeofencePositionState_t *pPositionState,
-                  uGeofenceDynamic_t *pDynamic,
-                  int64_t latitudeX1e9,
-                  int64_t longitudeX1e9,
-                  int32_t altitudeMillimetres,
-                  int32_t radiusMillimetres,
-                  int32_t altitudeUncertaintyMillimetres)
+// Test a position, the coordinate-related fields of pPoint, against
+// a fence; pCandidates and pSafeRadius are as for testPosition().
+static bool testPositionAt(const uGeofence_t *pFence,
+                           uGeofenceTestType_t testType,
+                           bool pessimisticNotOptimistic,
+                           uGeofencePositionState_t *pPositionState,
+                           uGeofenceDynamic_t *pDynamic,
+                           const uGeofenceCandidates_t *pCandidates,
+                           uGeofenceSafeRadius_t *pSafeRadius,
+                           const uGeofenceVertex_t *pPoint,
+                           double metresPerDegreeLongitude,
+                           int32_t altitudeMillimetres,
+                           int32_t radiusMillimetres,
+                           int32_t altitudeUncertaintyMillimetres)
 {
     bool testIsMet = false;
     uGeofencePositionState_t positionState;
     uGeofencePositionState_t previousPositionState = U_GEOFENCE_POSITION_STATE_NONE;
     uLinkedList_t *pList;
     bool uncertain;
-    uGeofenceCoordinates_t coordinates;
+    const uGeofenceCoordinates_t *pCoordinates = &(pPoint->coordinates);
     uGeofenceShape_t *pShape;
     bool wgs84Required;
-    double metresPerDegreeLongitude;
+    bool flat;
+    bool reuse;
+    uGeofenceSafeRadius_t safeRadius;
     double distanceMetres;
     double distanceMinMetres = NAN;
+    size_t shapeSlot = 0;
 
-    if ((pFence != NULL) && (latitudeX1e9 < U_GEOFENCE_LIMIT_LATITUDE_DEGREES_X1E9) &&
-        (latitudeX1e9 > -U_GEOFENCE_LIMIT_LATITUDE_DEGREES_X1E9) &&
-        (longitudeX1e9 < U_GEOFENCE_LIMIT_LONGITUDE_DEGREES_X1E9) &&
-        (longitudeX1e9 >  -U_GEOFENCE_LIMIT_LONGITUDE_DEGREES_X1E9) &&
-        (radiusMillimetres >= 0)) {
-        if (pPositionState != NULL) {
-            previousPositionState = *pPositionState;
+    if (pPositionState != NULL) {
+        previousPositionState = *pPositionState;
+    }
+    // First check the position against the altitude limits of the fence
+    positionState = testAltitude(pFence, altitudeMillimetres, testType,
+                                 pessimisticNotOptimistic, previousPositionState,
+                                 altitudeUncertaintyMillimetres);
+    // Only continue if we're not outside on altitude (since it is global, not shape-related)
+    if (positionState != U_GEOFENCE_POSITION_STATE_OUTSIDE) {
+        // Test if the position is too uncertain or is within the polar danger zone,
+        // in which case we need WGS84 calculations all-round
+        wgs84Required = (radiusMillimetres > U_GEOFENCE_WGS84_THRESHOLD_METRES * 1000) ||
+                        atAPole(pCoordinates->latitude,
+                                // codechecker_suppress [bugprone-integer-division]
+                                (double) (radiusMillimetres / 1000) + 1); // +1 to round up;
+        // Then check the position against all of the shapes in the fence
+        pList = pFence->pShapes;
+        if ((pCandidates != NULL) && !pCandidates->fenceIsCandidate && (pList != NULL)) {
+            // The spatial index says that the position is outside the
+            // square extent of all of the shapes of this fence, which
+            // is what the loop below would conclude
+            positionState = U_GEOFENCE_POSITION_STATE_OUTSIDE;
+            pList = NULL;
         }
-        // First check the position against the altitude limits of the fence
-        positionState = testAltitude(pFence, altitudeMillimetres, testType,
-                                     pessimisticNotOptimistic, previousPositionState,
-                                     altitudeUncertaintyMillimetres);
-        // Only continue if we're not outside on altitude (since it is global, not shape-related)
-        if (positionState != U_GEOFENCE_POSITION_STATE_OUTSIDE) {
-            coordinates.latitude = ((double) latitudeX1e9) / 1000000000ULL;
-            coordinates.longitude = ((double) longitudeX1e9) / 1000000000ULL;
-            // Test if the position is too uncertain or is within the polar danger zone,
-            // in which case we need WGS84 calculations all-round
-            wgs84Required = (radiusMillimetres > U_GEOFENCE_WGS84_THRESHOLD_METRES * 1000) ||
-                            atAPole(coordinates.latitude,
-                                    // codechecker_suppress [bugprone-integer-division]
-                                    (double) (radiusMillimetres / 1000) + 1); // +1 to round up;
-            // Need this for the non-WGS84 world
-            metresPerDegreeLongitude = longitudeMetresPerDegree(coordinates.latitude);
-            // Then check the position against all of the shapes in the fence
-            pList = pFence->pShapes;
-            while (testKeepGoing(positionState) && (pList != NULL)) {
-                pShape = (uGeofenceShape_t *) pList->p;
-                if (pShape != NULL) {
-                    positionState = U_GEOFENCE_POSITION_STATE_NONE;
-                    // Before we bother checking a shape in detail, see if
-                    // we can eliminate it based on square extent or speed
-                    if (radiusMillimetres < U_GEOFENCE_SQUARE_EXTENT_CHECK_UNCERTAINTY_METRES * 1000) {
-                        positionState = testSquareExtent(&(pShape->squareExtent), &coordinates);
+        while (testKeepGoing(positionState) && (pList != NULL)) {
+            pShape = (uGeofenceShape_t *) pList->p;
+            if (pShape != NULL) {
+                positionState = U_GEOFENCE_POSITION_STATE_NONE;
+                // Before we bother checking a shape in detail, see if
+                // we can eliminate it based on square extent or speed
+                if (radiusMillimetres < U_GEOFENCE_SQUARE_EXTENT_CHECK_UNCERTAINTY_METRES * 1000) {
+                    if ((pCandidates != NULL) &&
+                        !indexMarkIsSet(pCandidates->pShapeMarks,
+                                        pCandidates->firstShapeSlot + shapeSlot)) {
+                        // Already eliminated by the spatial index
+                        positionState = U_GEOFENCE_POSITION_STATE_OUTSIDE;
+                    } else {
+                        positionState = testSquareExtent(&(pShape->squareExtent), pCoordinates);
                     }
-                    if ((positionState != U_GEOFENCE_POSITION_STATE_OUTSIDE) && (pDynamic != NULL)) {
-                        positionState = testSpeed(pDynamic);
+                }
+                if ((positionState != U_GEOFENCE_POSITION_STATE_OUTSIDE) && (pDynamic != NULL)) {
+                    positionState = testSpeed(pDynamic);
+                }
+                flat = !(wgs84Required || pShape->wgs84Required);
+                reuse = false;
+                if ((positionState != U_GEOFENCE_POSITION_STATE_OUTSIDE) &&
+                    (pSafeRadius != NULL) && flat) {
+                    safeRadiusGet(&(pSafeRadius[shapeSlot]), &safeRadius);
+                    reuse = safeRadiusCovers(&safeRadius, pCoordinates,
+                                             metresPerDegreeLongitude, radiusMillimetres,
+                                             &distanceMetres);
+                }
+                if (reuse) {
+                    // Close enough to where this shape was last tested
+                    // that the outcome can't have changed
+                    positionState = safeRadius.positionState;
+                    if ((distanceMinMetres != distanceMinMetres) || // NAN test
+                        (distanceMetres < distanceMinMetres)) {
+                        distanceMinMetres = distanceMetres;
                     }
-                    if (positionState != U_GEOFENCE_POSITION_STATE_OUTSIDE) {
-                        uncertain = false;
-                        distanceMetres = NAN;
-                        switch (pShape->type) {
-                            case U_GEOFENCE_SHAPE_TYPE_CIRCLE:
-                                positionState = testCircle(pShape->u.pCircle,
-                                                           wgs84Required || pShape->wgs84Required,
-                                                           metresPerDegreeLongitude,
-                                                           &coordinates,
-                                                           radiusMillimetres,
-                                                           &distanceMetres,
-                                                           &uncertain);
-                                break;
-                            case U_GEOFENCE_SHAPE_TYPE_POLYGON:
-                                positionState = testPolygon(pShape->u.pPolygon,
-                                                            wgs84Required || pShape->wgs84Required,
-                                                            metresPerDegreeLongitude,
-                                                            &coordinates,
-                                                            radiusMillimetres,
-                                                            &distanceMetres,
-                                                            &uncertain);
-                                break;
-                            default:
-                                break;
-                        }
-                        if ((distanceMetres == distanceMetres) && // NAN test
-                            ((distanceMinMetres != distanceMinMetres) || // NAN test
-                             (distanceMetres < distanceMinMetres))) {
-                            distanceMinMetres = distanceMetres;
-                            if (distanceMinMetres < 0) {
-                                distanceMinMetres = 0;
-                            }
-                        }
-                        if (uncertain) {
-                            // Take account of any uncertainty in the outcome
-                            positionState = testAccountForUncertainty(testType,
-                                                                      pessimisticNotOptimistic,
-                                                                      positionState,
-                                                                      previousPositionState);
+                } else if (positionState != U_GEOFENCE_POSITION_STATE_OUTSIDE) {
+                    uncertain = false;
+                    distanceMetres = NAN;
+                    switch (pShape->type) {
+                        case U_GEOFENCE_SHAPE_TYPE_CIRCLE:
+                            positionState = testCircle(pShape->u.pCircle,
+                                                       wgs84Required || pShape->wgs84Required,
+                                                       metresPerDegreeLongitude,
+                                                       pCoordinates,
+                                                       radiusMillimetres,
+                                                       &distanceMetres,
+                                                       &uncertain);
+                            break;
+                        case U_GEOFENCE_SHAPE_TYPE_POLYGON:
+                            // The polygon is compiled before we get
+                            // here, since that is a change to the fence;
+                            // should there not have been the memory for
+                            // it the outcome will be "none"
+                            positionState = testPolygon(pShape->pCompiled,
+                                                        pShape->compiledVertexCount,
+                                                        wgs84Required || pShape->wgs84Required,
+                                                        metresPerDegreeLongitude,
+                                                        pPoint,
+                                                        radiusMillimetres,
+                                                        &distanceMetres,
+                                                        &uncertain);
+                            break;
+                        default:
+                            break;
+                    }
+                    if ((distanceMetres == distanceMetres) && // NAN test
+                        ((distanceMinMetres != distanceMinMetres) || // NAN test
+                         (distanceMetres < distanceMinMetres))) {
+                        distanceMinMetres = distanceMetres;
+                        if (distanceMinMetres < 0) {
+                            distanceMinMetres = 0;
                         }
                     }
-                }
-                pList = pList->pNext;
-            }
-            if (pDynamic != NULL) {
-                pDynamic->lastStatus.distanceMillimetres = LLONG_MIN;
-                if (positionState == U_GEOFENCE_POSITION_STATE_INSIDE) {
-                    pDynamic->lastStatus.distanceMillimetres = 0;
-                } else {
-                    if (distanceMinMetres == distanceMinMetres) { // NAN test
-                        pDynamic->lastStatus.distanceMillimetres = (int64_t) (distanceMinMetres * 1000);
-                        pDynamic->lastStatus.timeoutStart = uTimeoutStart();
+                    if (pSafeRadius != NULL) {
+                        safeRadiusSet(&(pSafeRadius[shapeSlot]), pCoordinates,
+                                      positionState, !uncertain && flat, distanceMetres);
+                    }
+                    if (uncertain) {
+                        // Take account of any uncertainty in the outcome
+                        positionState = testAccountForUncertainty(testType,
+                                                                  pessimisticNotOptimistic,
+                                                                  positionState,
+                                                                  previousPositionState);
                     }
                 }
             }
+            shapeSlot++;
+            pList = pList->pNext;
         }
-        testIsMet = ((testType == U_GEOFENCE_TEST_TYPE_INSIDE) &&
-                     (positionState == U_GEOFENCE_POSITION_STATE_INSIDE)) ||
-                    ((testType == U_GEOFENCE_TEST_TYPE_OUTSIDE) &&
-                     (positionState == U_GEOFENCE_POSITION_STATE_OUTSIDE)) ||
-                    ((testType == U_GEOFENCE_TEST_TYPE_TRANSIT) &&
-                     (previousPositionState != U_GEOFENCE_POSITION_STATE_NONE) &&
-                     (positionState != U_GEOFENCE_POSITION_STATE_NONE) &&
-                     (positionState != previousPositionState));
-        if (pPositionState != NULL) {
-            *pPositionState = positionState;
+        if (pDynamic != NULL) {
+            pDynamic->lastStatus.distanceMillimetres = LLONG_MIN;
+            if (positionState == U_GEOFENCE_POSITION_STATE_INSIDE) {
+                pDynamic->lastStatus.distanceMillimetres = 0;
+            } else {
+                if (distanceMinMetres == distanceMinMetres) { // NAN test
+                    pDynamic->lastStatus.distanceMillimetres = (int64_t) (distanceMinMetres * 1000);
+                    pDynamic->lastStatus.timeoutStart = uTimeoutStart();
+                }
+            }
         }
     }
+    testIsMet = ((testType == U_GEOFENCE_TEST_TYPE_INSIDE) &&
+                 (positionState == U_GEOFENCE_POSITION_STATE_INSIDE)) ||
+                ((testType == U_GEOFENCE_TEST_TYPE_OUTSIDE) &&
+                 (positionState == U_GEOFENCE_POSITION_STATE_OUTSIDE)) ||
+                ((testType == U_GEOFENCE_TEST_TYPE_TRANSIT) &&
+                 (previousPositionState != U_GEOFENCE_POSITION_STATE_NONE) &&
+                 (positionState != U_GEOFENCE_POSITION_STATE_NONE) &&
+                 (positionState != previousPositionState));
+    if (pPositionState != NULL) {
+        *pPositionState = positionState;
+    }
 
     return testIsMet;
 }
 
+// Check that a position is one that can be tested.
+static bool positionIsValid(int64_t latitudeX1e9, int64_t longitudeX1e9,
+                            int32_t radiusMillimetres)
+{
+    return (latitudeX1e9 < U_GEOFENCE_LIMIT_LATITUDE_DEGREES_X1E9) &&
+           (latitudeX1e9 > -U_GEOFENCE_LIMIT_LATITUDE_DEGREES_X1E9) &&
+           (longitudeX1e9 < U_GEOFENCE_LIMIT_LONGITUDE_DEGREES_X1E9) &&
+           (longitudeX1e9 >  -U_GEOFENCE_LIMIT_LONGITUDE_DEGREES_X1E9) &&
+           (radiusMillimetres >= 0);
+}
+
+// Test a single position against a fence.  If pCandidates is not
+// NULL it carries the outcome of a spatial index query for the
+// position, which is only valid when the radius of position is small
+// enough for a square extent check to be made: shapes that the index
+// has found the position to be outside the square extent of are not
+// examined.  If pSafeRadius is not NULL it is the safe radius entries
+// for the shapes of the fence, for the device the position is from:
+// these are both used and updated.
+bool testPosition(const uGeofence_t *pFence,
+                  uGeofenceTestType_t testType,
+                  bool pessimisticNotOptimistic,
+                  uGeofencePositionState_t *pPositionState,
+                  uGeofenceDynamic_t *pDynamic,
+                  const uGeofenceCandidates_t *pCandidates,
+                  uGeofenceSafeRadius_t *pSafeRadius,
+                  int64_t latitudeX1e9,
+                  int64_t longitudeX1e9,
+                  int32_t altitudeMillimetres,
+                  int32_t radiusMillimetres,
+                  int32_t altitudeUncertaintyMillimetres)
+{
+    bool testIsMet = false;
+    uGeofenceCoordinates_t coordinates;
+    uGeofenceVertex_t point = {0};
+
+    if ((pFence != NULL) &&
+        positionIsValid(latitudeX1e9, longitudeX1e9, radiusMillimetres)) {
+        coordinates.latitude = ((double) latitudeX1e9) / 1000000000ULL;
+        coordinates.longitude = ((double) longitudeX1e9) / 1000000000ULL;
+        vertexSetCoordinates(&point, &coordinates);
+        testIsMet = testPositionAt(pFence, testType, pessimisticNotOptimistic,
+                                   pPositionState, pDynamic, pCandidates,
+                                   pSafeRadius, &point, longitudeMetresPerDegreeCos(point.cosLatitude),
+                                   altitudeMillimetres, radiusMillimetres,
+                                   altitudeUncertaintyMillimetres);
+    }
+
+    return testIsMet;
+}
+
+// Convert up to U_GEOFENCE_TEST_BATCH_CHUNK_SIZE positions into
+// the quantities needed to test them; each quantity is worked out
+// for all of the positions in a loop of its own so that a compiler
+// which is able to vectorise the loops may do so.
+static void batchChunkSet(uGeofenceBatchChunk_t *pChunk,
+                          const int64_t *pLatitudeX1e9,
+                          const int64_t *pLongitudeX1e9,
+                          size_t count)
+{
+    for (size_t x = 0; x < count; x++) {
+        pChunk->latitude[x] = ((double) pLatitudeX1e9[x]) / 1000000000ULL;
+    }
+    for (size_t x = 0; x < count; x++) {
+        pChunk->longitude[x] = ((double) pLongitudeX1e9[x]) / 1000000000ULL;
+    }
+    for (size_t x = 0; x < count; x++) {
+        pChunk->latitudeRadians[x] = degreesToRadians(pChunk->latitude[x]);
+    }
+    for (size_t x = 0; x < count; x++) {
+        pChunk->longitudeRadians[x] = degreesToRadians(pChunk->longitude[x]);
+    }
+    for (size_t x = 0; x < count; x++) {
+        pChunk->cosLatitude[x] = cos(pChunk->latitudeRadians[x]);
+    }
+    for (size_t x = 0; x < count; x++) {
+        pChunk->sinLatitude[x] = sin(pChunk->latitudeRadians[x]);
+    }
+}
+
+// Populate the coordinate-related fields of a vertex from entry
+// x of a chunk.
+static void batchChunkGetVertex(const uGeofenceBatchChunk_t *pChunk,
+                                size_t x, uGeofenceVertex_t *pVertex)
+{
+    pVertex->coordinates.latitude = pChunk->latitude[x];
+    pVertex->coordinates.longitude = pChunk->longitude[x];
+    pVertex->latitudeRadians = pChunk->latitudeRadians[x];
+    pVertex->longitudeRadians = pChunk->longitudeRadians[x];
+    pVertex->cosLatitude = pChunk->cosLatitude[x];
+    pVertex->sinLatitude = pChunk->sinLatitude[x];
+}
+
 #endif // U_CFG_GEOFENCE
 
 /* ----------------------------------------------------------------
@@ -1713,14 +2829,36 @@ int32_t uGeofenceApply(uGeofenceContext_t **ppFenceContext,
     int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
 
     if ((ppFenceContext != NULL) && (pFence != NULL)) {
-        errorCode = uGeofenceContextEnsure(ppFenceContext);
-        if ((*ppFenceContext != NULL) &&
-            uLinkedListAdd(&((*ppFenceContext)->pFences), (void *) pFence)) {
-            pFence->referenceCount++;
-            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-        } else {
-            // Clean up on error
-            uPortFree(*ppFenceContext);
+        init();
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+        if (gMutex != NULL) {
+
+            lockExclusive();
+
+            // Compile the shapes of the fence now, rather than leaving
+            // it to the first position test: once the reference count
+            // is non-zero the fence cannot be changed, which is what
+            // allows uGeofenceContextTest() to read it without locking
+            errorCode = fenceCompile(pFence);
+            if (errorCode == 0) {
+                errorCode = uGeofenceContextEnsure(ppFenceContext);
+                if ((*ppFenceContext != NULL) &&
+                    uLinkedListAdd(&((*ppFenceContext)->pFences), (void *) pFence)) {
+                    pFence->referenceCount++;
+                    contextIndexRebuild(*ppFenceContext);
+                    contextSafeRadiusRebuild(*ppFenceContext);
+                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                } else {
+                    // Clean up on error
+                    if (*ppFenceContext != NULL) {
+                        indexFree((uGeofenceIndex_t *) (*ppFenceContext)->pIndex);
+                        safeRadiusCacheFree((uGeofenceSafeRadiusCache_t *) (*ppFenceContext)->pSafeRadius);
+                    }
+                    uPortFree(*ppFenceContext);
+                }
+            }
+
+            unlockExclusive();
         }
     }
 
@@ -1736,8 +2874,15 @@ int32_t uGeofenceRemove(uGeofenceContext_t **ppFenceContext,
     uLinkedList_t *pListNext;
 
     if (ppFenceContext != NULL) {
+        init();
         errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-        if ((*ppFenceContext != NULL) && ((*ppFenceContext)->pFences != NULL)) {
+        if ((*ppFenceContext != NULL) && ((*ppFenceContext)->pFences != NULL) &&
+            (gMutex != NULL)) {
+
+            // The reference count of a fence is only changed
+            // with exclusive access
+            lockExclusive();
+
             if (pFence == NULL) {
                 // Remove all the fences from the instance
                 pList = (*ppFenceContext)->pFences;
@@ -1757,6 +2902,10 @@ int32_t uGeofenceRemove(uGeofenceContext_t **ppFenceContext,
                     pFence->referenceCount--;
                 }
             }
+            contextIndexRebuild(*ppFenceContext);
+            contextSafeRadiusRebuild(*ppFenceContext);
+
+            unlockExclusive();
         }
     }
 
@@ -1844,83 +2993,144 @@ uGeofencePositionState_t uGeofenceContextTest(uDeviceHandle_t devHandle,
 
 #ifdef U_CFG_GEOFENCE
     uGeofencePositionState_t fencePositionState;
+    uGeofencePositionState_t contextPositionState;
     const uGeofence_t *pFence;
     uLinkedList_t *pList;
     uGeofenceDynamic_t dynamic;
     uGeofenceDynamic_t dynamicsMinDistance;
     uGeofenceTestType_t _testType;
     bool _pessimisticNotOptimistic;
-
-    if ((pFenceContext != NULL) && (pFenceContext->pFences != NULL)) {
-        pList = pFenceContext->pFences;
-        _testType = pFenceContext->testType;
-        _pessimisticNotOptimistic = pFenceContext->pessimisticNotOptimistic;
-        if (testType != U_GEOFENCE_TEST_TYPE_NONE) {
-            _testType = testType;
-            _pessimisticNotOptimistic = pessimisticNotOptimistic;
-        }
-        dynamicsMinDistance = pFenceContext->dynamic;
-        while (pList != NULL) {
-            // Test against each fence and call the callback each
-            // time, so that the callback gets to know whether the
-            // position has met the test against each fence
-            pFence = (const uGeofence_t *) pList->p;
-            fencePositionState = pFenceContext->positionState;
-            if (pFence != NULL) {
-                dynamic = dynamicsMinDistance;
-                testPosition(pFence, _testType,
-                             _pessimisticNotOptimistic,
-                             &fencePositionState,
-                             &dynamic,
-                             latitudeX1e9, longitudeX1e9,
-                             altitudeMillimetres,
-                             radiusMillimetres,
-                             altitudeUncertaintyMillimetres);
-                if (pFenceContext->positionState == U_GEOFENCE_POSITION_STATE_NONE) {
-                    // If we've never updated the instance position state, do it now
-                    pFenceContext->positionState = fencePositionState;
-                } else {
-                    // Otherwise, if the instance is inside any fence then its
-                    // over all position state should remain "inside"; in other
-                    // words "inside" should be sticky
-                    if (fencePositionState == U_GEOFENCE_POSITION_STATE_INSIDE) {
-                        pFenceContext->positionState = fencePositionState;
+    uGeofenceIndex_t *pIndex;
+    uGeofenceIndexQuery_t query = {0};
+    uGeofenceCoordinates_t coordinates;
+    uGeofenceCandidates_t candidates = {0};
+    const uGeofenceCandidates_t *pCandidates = NULL;
+    uGeofenceSafeRadiusCache_t *pSafeRadiusCache;
+    uGeofenceSafeRadius_t *pSafeRadius = NULL;
+    size_t fenceIndex = 0;
+    size_t shapeSlot;
+
+    if (pFenceContext != NULL) {
+        init();
+    }
+    if ((pFenceContext != NULL) && (gMutex != NULL)) {
+        // Only shared access is needed: the fences that are applied
+        // to a context cannot be changed (see fenceNotInUse()) and
+        // the test memory of a fence is not used here, so the devices
+        // of the GNSS, cellular and Wi-Fi APIs can all test against
+        // the same fences at once, but the fence list, spatial index
+        // and safe radius cache of the context are replaced by
+        // uGeofenceApply()/uGeofenceRemove(), which need exclusive
+        // access, so they must be kept out while we're in here
+        lockShared();
+        if (pFenceContext->pFences != NULL) {
+            pIndex = (uGeofenceIndex_t *) pFenceContext->pIndex;
+            if ((pIndex != NULL) && (radiusMillimetres >= 0) &&
+                (radiusMillimetres < U_GEOFENCE_SQUARE_EXTENT_CHECK_UNCERTAINTY_METRES * 1000) &&
+                indexQueryClaim(pIndex, &query)) {
+                // Find the shapes that are near enough to the position
+                // to be worth testing; the outcome is kept in storage
+                // claimed for this test alone since another task may
+                // be testing the same context
+                coordinates.latitude = ((double) latitudeX1e9) / 1000000000ULL;
+                coordinates.longitude = ((double) longitudeX1e9) / 1000000000ULL;
+                indexQuery(pIndex, &coordinates, &query);
+                candidates.pShapeMarks = query.pShapeMarks;
+                pCandidates = &candidates;
+            }
+            pSafeRadiusCache = (uGeofenceSafeRadiusCache_t *) pFenceContext->pSafeRadius;
+            pList = pFenceContext->pFences;
+            _testType = pFenceContext->testType;
+            _pessimisticNotOptimistic = pFenceContext->pessimisticNotOptimistic;
+            if (testType != U_GEOFENCE_TEST_TYPE_NONE) {
+                _testType = testType;
+                _pessimisticNotOptimistic = pessimisticNotOptimistic;
+            }
+            // The position state and dynamic of the context may be
+            // being written by another task testing the same context,
+            // so they are only copied in or out under gSharedMutex
+            U_PORT_MUTEX_LOCK(gSharedMutex);
+            contextPositionState = pFenceContext->positionState;
+            dynamicsMinDistance = pFenceContext->dynamic;
+            U_PORT_MUTEX_UNLOCK(gSharedMutex);
+            while (pList != NULL) {
+                // Test against each fence and call the callback each
+                // time, so that the callback gets to know whether the
+                // position has met the test against each fence
+                pFence = (const uGeofence_t *) pList->p;
+                fencePositionState = contextPositionState;
+                if (pFence != NULL) {
+                    dynamic = dynamicsMinDistance;
+                    if (pCandidates != NULL) {
+                        candidates.firstShapeSlot = pIndex->pFenceShapeSlot[fenceIndex];
+                        candidates.fenceIsCandidate = indexMarkIsSet(query.pFenceMarks,
+                                                                     fenceIndex);
                     }
-                }
-                if (positionState == U_GEOFENCE_POSITION_STATE_NONE) {
-                    // If we've never updated the over all instance position state,
-                    // do it now
-                    positionState = fencePositionState;
-                } else {
-                    // Again, for the over all instance position state,
-                    // inside should be sticky
-                    if (fencePositionState == U_GEOFENCE_POSITION_STATE_INSIDE) {
+                    if (pSafeRadiusCache != NULL) {
+                        shapeSlot = pSafeRadiusCache->pFenceShapeSlot[fenceIndex];
+                        pSafeRadius = &(pSafeRadiusCache->pShapes[shapeSlot]);
+                    }
+                    testPosition(pFence, _testType,
+                                 _pessimisticNotOptimistic,
+                                 &fencePositionState,
+                                 &dynamic, pCandidates, pSafeRadius,
+                                 latitudeX1e9, longitudeX1e9,
+                                 altitudeMillimetres,
+                                 radiusMillimetres,
+                                 altitudeUncertaintyMillimetres);
+                    if (contextPositionState == U_GEOFENCE_POSITION_STATE_NONE) {
+                        // If we've never updated the instance position state, do it now
+                        contextPositionState = fencePositionState;
+                    } else {
+                        // Otherwise, if the instance is inside any fence then its
+                        // over all position state should remain "inside"; in other
+                        // words "inside" should be sticky
+                        if (fencePositionState == U_GEOFENCE_POSITION_STATE_INSIDE) {
+                            contextPositionState = fencePositionState;
+                        }
+                    }
+                    if (positionState == U_GEOFENCE_POSITION_STATE_NONE) {
+                        // If we've never updated the over all instance position state,
+                        // do it now
                         positionState = fencePositionState;
+                    } else {
+                        // Again, for the over all instance position state,
+                        // inside should be sticky
+                        if (fencePositionState == U_GEOFENCE_POSITION_STATE_INSIDE) {
+                            positionState = fencePositionState;
+                        }
                     }
-                }
 
-                if ((dynamic.lastStatus.distanceMillimetres != LLONG_MIN) &&
-                    (dynamic.lastStatus.distanceMillimetres < dynamicsMinDistance.lastStatus.distanceMillimetres)) {
-                    dynamicsMinDistance.lastStatus.distanceMillimetres = dynamic.lastStatus.distanceMillimetres;
-                    dynamicsMinDistance.lastStatus.timeoutStart = dynamic.lastStatus.timeoutStart;
-                }
-                if ((pFenceContext->pCallback != NULL) && (devHandle != NULL)) {
-                    pFenceContext->pCallback(devHandle, pFence, pFence->pNameStr,
-                                             fencePositionState,
-                                             latitudeX1e9, longitudeX1e9,
-                                             altitudeMillimetres,
-                                             radiusMillimetres,
-                                             altitudeUncertaintyMillimetres,
-                                             dynamic.lastStatus.distanceMillimetres,
-                                             pFenceContext->pCallbackParam);
+                    if ((dynamic.lastStatus.distanceMillimetres != LLONG_MIN) &&
+                        (dynamic.lastStatus.distanceMillimetres <
+                         dynamicsMinDistance.lastStatus.distanceMillimetres)) {
+                        dynamicsMinDistance.lastStatus = dynamic.lastStatus;
+                    }
+                    if ((pFenceContext->pCallback != NULL) && (devHandle != NULL)) {
+                        pFenceContext->pCallback(devHandle, pFence, pFence->pNameStr,
+                                                 fencePositionState,
+                                                 latitudeX1e9, longitudeX1e9,
+                                                 altitudeMillimetres,
+                                                 radiusMillimetres,
+                                                 altitudeUncertaintyMillimetres,
+                                                 dynamic.lastStatus.distanceMillimetres,
+                                                 pFenceContext->pCallbackParam);
+                    }
                 }
+                fenceIndex++;
+                pList = pList->pNext;
             }
-            pList = pList->pNext;
+            if (pCandidates != NULL) {
+                indexQueryRelease(pIndex, &query);
+            }
+            // Set the new over all position state of the instance
+            // and the dynamic
+            U_PORT_MUTEX_LOCK(gSharedMutex);
+            pFenceContext->positionState = positionState;
+            pFenceContext->dynamic = dynamicsMinDistance;
+            U_PORT_MUTEX_UNLOCK(gSharedMutex);
         }
-        // Set the new over all position state of the instance
-        // and the dynamic
-        pFenceContext->positionState = positionState;
-        pFenceContext->dynamic = dynamicsMinDistance;
+        unlockShared();
     }
 #else
     (void) devHandle;
@@ -1952,6 +3162,8 @@ void uGeofenceContextFree(uGeofenceContext_t **ppFenceContext)
             uLinkedListRemove(&((*ppFenceContext)->pFences), pList->p);
             pList = pListNext;
         }
+        indexFree((uGeofenceIndex_t *) (*ppFenceContext)->pIndex);
+        safeRadiusCacheFree((uGeofenceSafeRadiusCache_t *) (*ppFenceContext)->pSafeRadius);
         uPortFree(*ppFenceContext);
         *ppFenceContext = NULL;
     }
@@ -1975,7 +3187,7 @@ uGeofence_t *pUGeofenceCreate(const char *pNameStr)
 
     if (gMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        lockExclusive();
 
         pFence = (uGeofence_t *) pUPortMalloc(sizeof(*pFence));
         if (pFence != NULL) {
@@ -1985,7 +3197,7 @@ uGeofence_t *pUGeofenceCreate(const char *pNameStr)
             pFence->pNameStr = pNameStr;
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        unlockExclusive();
     }
 #else
     (void) pNameStr;
@@ -2007,7 +3219,7 @@ int32_t uGeofenceFree(uGeofence_t *pFence)
 
     if (gMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        lockExclusive();
 
         errorCode = fenceNotInUse(pFence);
         if (errorCode == 0) {
@@ -2016,7 +3228,7 @@ int32_t uGeofenceFree(uGeofence_t *pFence)
             uPortFree(pFence);
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        unlockExclusive();
     }
 #else
     errorCode = (int32_t) U_ERROR_COMMON_NOT_COMPILED;
@@ -2044,7 +3256,7 @@ int32_t uGeofenceAddCircle(uGeofence_t *pFence,
 
     if (gMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        lockExclusive();
 
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((latitudeX1e9 < U_GEOFENCE_LIMIT_LATITUDE_DEGREES_X1E9) &&
@@ -2089,7 +3301,7 @@ int32_t uGeofenceAddCircle(uGeofence_t *pFence,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        unlockExclusive();
     }
 #else
     errorCode = (int32_t) U_ERROR_COMMON_NOT_COMPILED;
@@ -2122,7 +3334,7 @@ int32_t uGeofenceAddVertex(uGeofence_t *pFence,
 
     if (gMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        lockExclusive();
 
         errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
         if ((latitudeX1e9 < U_GEOFENCE_LIMIT_LATITUDE_DEGREES_X1E9) &&
@@ -2162,6 +3374,8 @@ int32_t uGeofenceAddVertex(uGeofence_t *pFence,
                         // Add it to the list
                         if (uLinkedListAdd(ppPolygon, pVertex)) {
                             errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                            // Any compiled form of the polygon is now out of date
+                            shapeUncompile(pShape);
                             // Update the square extent and set wgs84Required
                             updateSquareExtentAndWgs84(pShape);
                             if (newPolygon) {
@@ -2191,7 +3405,7 @@ int32_t uGeofenceAddVertex(uGeofence_t *pFence,
             }
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        unlockExclusive();
     }
 #else
     errorCode = (int32_t) U_ERROR_COMMON_NOT_COMPILED;
@@ -2218,14 +3432,14 @@ int32_t uGeofenceSetAltitudeMax(uGeofence_t *pFence,
 
     if (gMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        lockExclusive();
 
         errorCode = fenceNotInUse(pFence);
         if (errorCode == 0) {
             pFence->altitudeMillimetresMax = altitudeMillimetres;
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        unlockExclusive();
     }
 #else
     errorCode = (int32_t) U_ERROR_COMMON_NOT_COMPILED;
@@ -2250,14 +3464,14 @@ int32_t uGeofenceSetAltitudeMin(uGeofence_t *pFence,
 
     if (gMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        lockExclusive();
 
         errorCode = fenceNotInUse(pFence);
         if (errorCode == 0) {
             pFence->altitudeMillimetresMin = altitudeMillimetres;
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        unlockExclusive();
     }
 #else
     errorCode = (int32_t) U_ERROR_COMMON_NOT_COMPILED;
@@ -2281,14 +3495,44 @@ int32_t uGeofenceClearMap(uGeofence_t *pFence)
 
     if (gMutex != NULL) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        lockExclusive();
 
         errorCode = fenceNotInUse(pFence);
         if (errorCode == 0) {
             fenceClearMapData(pFence);
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        unlockExclusive();
+    }
+#else
+    errorCode = (int32_t) U_ERROR_COMMON_NOT_COMPILED;
+    (void) pFence;
+#endif
+
+    return errorCode;
+}
+
+// Compile the shapes of a geofence.
+int32_t uGeofenceFreeze(uGeofence_t *pFence)
+{
+    int32_t errorCode;
+
+#ifdef U_CFG_GEOFENCE
+    errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+
+    // Make sure that we are initialised
+    init();
+
+    if (gMutex != NULL) {
+
+        lockExclusive();
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if (pFence != NULL) {
+            errorCode = fenceCompile(pFence);
+        }
+
+        unlockExclusive();
     }
 #else
     errorCode = (int32_t) U_ERROR_COMMON_NOT_COMPILED;
@@ -2317,25 +3561,31 @@ bool uGeofenceTest(uGeofence_t *pFence, uGeofenceTestType_t testType,
 
     if ((gMutex != NULL) && (pFence != NULL)) {
 
-        U_PORT_MUTEX_LOCK(gMutex);
+        // Testing doesn't change the fence, other than its test
+        // memory, hence only shared access is required
+        lockSharedForTest(pFence);
 
         dynamic.lastStatus.distanceMillimetres = LLONG_MIN;
         dynamic.maxHorizontalSpeedMillimetresPerSecond = -1;
+        U_PORT_MUTEX_LOCK(gSharedMutex);
         positionState = pFence->positionState;
+        U_PORT_MUTEX_UNLOCK(gSharedMutex);
         testIsMet = testPosition(pFence, testType,
                                  pessimisticNotOptimistic,
                                  &positionState,
-                                 &dynamic,
+                                 &dynamic, NULL, NULL,
                                  latitudeX1e9, longitudeX1e9,
                                  altitudeMillimetres,
                                  radiusMillimetres,
                                  altitudeUncertaintyMillimetres);
         if (positionState != U_GEOFENCE_POSITION_STATE_NONE) {
+            U_PORT_MUTEX_LOCK(gSharedMutex);
             pFence->positionState = positionState;
             pFence->distanceMinMillimetres = dynamic.lastStatus.distanceMillimetres;
+            U_PORT_MUTEX_UNLOCK(gSharedMutex);
         }
 
-        U_PORT_MUTEX_UNLOCK(gMutex);
+        unlockShared();
     }
 #else
     (void) pFence;
@@ -2351,7 +3601,127 @@ bool uGeofenceTest(uGeofence_t *pFence, uGeofenceTestType_t testType,
     return testIsMet;
 }
 
-// Free gMutex.
+// Test a sequence of positions against a geofence.
+int32_t uGeofenceTestBatch(uGeofence_t *pFence, uGeofenceTestType_t testType,
+                           bool pessimisticNotOptimistic,
+                           size_t numPositions,
+                           const int64_t *pLatitudeX1e9,
+                           const int64_t *pLongitudeX1e9,
+                           const int32_t *pAltitudeMillimetres,
+                           const int32_t *pRadiusMillimetres,
+                           const int32_t *pAltitudeUncertaintyMillimetres,
+                           uGeofencePositionState_t *pPositionState)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+
+#ifdef U_CFG_GEOFENCE
+    uGeofencePositionState_t positionState;
+    uGeofencePositionState_t fencePositionState;
+    int64_t fenceDistanceMinMillimetres;
+    uGeofenceDynamic_t dynamic = {0};
+    uGeofenceBatchChunk_t chunk;
+    uGeofenceVertex_t point = {0};
+    size_t count;
+    size_t y;
+    int32_t altitudeMillimetres = INT_MIN;
+    int32_t radiusMillimetres = 0;
+    int32_t altitudeUncertaintyMillimetres = -1;
+    bool testIsMet;
+
+    // Make sure that we are initialised
+    init();
+
+    if (gMutex != NULL) {
+        errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        if ((pFence != NULL) &&
+            ((numPositions == 0) ||
+             ((pLatitudeX1e9 != NULL) && (pLongitudeX1e9 != NULL)))) {
+
+            lockSharedForTest(pFence);
+
+            // Work on a copy of the test memory of the fence, writing
+            // it back when done
+            U_PORT_MUTEX_LOCK(gSharedMutex);
+            fencePositionState = pFence->positionState;
+            fenceDistanceMinMillimetres = pFence->distanceMinMillimetres;
+            U_PORT_MUTEX_UNLOCK(gSharedMutex);
+
+            errorCodeOrCount = 0;
+            for (size_t x = 0; x < numPositions; x += count) {
+                count = numPositions - x;
+                if (count > U_GEOFENCE_TEST_BATCH_CHUNK_SIZE) {
+                    count = U_GEOFENCE_TEST_BATCH_CHUNK_SIZE;
+                }
+                batchChunkSet(&chunk, pLatitudeX1e9 + x, pLongitudeX1e9 + x, count);
+                // The positions have to be tested in order since, where
+                // the outcome is uncertain, the outcome for one position
+                // depends on the outcome for the one before
+                for (size_t z = 0; z < count; z++) {
+                    y = x + z;
+                    if (pAltitudeMillimetres != NULL) {
+                        altitudeMillimetres = pAltitudeMillimetres[y];
+                    }
+                    if (pRadiusMillimetres != NULL) {
+                        radiusMillimetres = pRadiusMillimetres[y];
+                    }
+                    if (pAltitudeUncertaintyMillimetres != NULL) {
+                        altitudeUncertaintyMillimetres = pAltitudeUncertaintyMillimetres[y];
+                    }
+                    positionState = U_GEOFENCE_POSITION_STATE_NONE;
+                    if (positionIsValid(pLatitudeX1e9[y], pLongitudeX1e9[y], radiusMillimetres)) {
+                        // Exactly as uGeofenceTest() would do it
+                        dynamic.lastStatus.distanceMillimetres = LLONG_MIN;
+                        dynamic.maxHorizontalSpeedMillimetresPerSecond = -1;
+                        positionState = fencePositionState;
+                        batchChunkGetVertex(&chunk, z, &point);
+                        testIsMet = testPositionAt(pFence, testType,
+                                                   pessimisticNotOptimistic,
+                                                   &positionState,
+                                                   &dynamic, NULL, NULL, &point,
+                                                   longitudeMetresPerDegreeCos(chunk.cosLatitude[z]),
+                                                   altitudeMillimetres,
+                                                   radiusMillimetres,
+                                                   altitudeUncertaintyMillimetres);
+                        if (testIsMet) {
+                            errorCodeOrCount++;
+                        }
+                        if (positionState != U_GEOFENCE_POSITION_STATE_NONE) {
+                            fencePositionState = positionState;
+                            fenceDistanceMinMillimetres = dynamic.lastStatus.distanceMillimetres;
+                        }
+                    }
+                    if (pPositionState != NULL) {
+                        pPositionState[y] = positionState;
+                    }
+                }
+            }
+
+            U_PORT_MUTEX_LOCK(gSharedMutex);
+            pFence->positionState = fencePositionState;
+            pFence->distanceMinMillimetres = fenceDistanceMinMillimetres;
+            U_PORT_MUTEX_UNLOCK(gSharedMutex);
+
+            unlockShared();
+        }
+    }
+#else
+    errorCodeOrCount = (int32_t) U_ERROR_COMMON_NOT_COMPILED;
+    (void) pFence;
+    (void) testType;
+    (void) pessimisticNotOptimistic;
+    (void) numPositions;
+    (void) pLatitudeX1e9;
+    (void) pLongitudeX1e9;
+    (void) pAltitudeMillimetres;
+    (void) pRadiusMillimetres;
+    (void) pAltitudeUncertaintyMillimetres;
+    (void) pPositionState;
+#endif
+
+    return errorCodeOrCount;
+}
+
+// Free gMutex and friends.
 void uGeofenceCleanUp()
 {
 #ifdef U_CFG_GEOFENCE
@@ -2359,6 +3729,14 @@ void uGeofenceCleanUp()
         uPortMutexDelete(gMutex);
         gMutex = NULL;
     }
+    if (gSharedNoneSemaphore != NULL) {
+        uPortSemaphoreDelete(gSharedNoneSemaphore);
+        gSharedNoneSemaphore = NULL;
+    }
+    if (gSharedMutex != NULL) {
+        uPortMutexDelete(gSharedMutex);
+        gSharedMutex = NULL;
+    }
 #endif
 }
 
@@ -65,6 +65,13 @@ typedef struct {
     uGeofenceTestType_t testType;
     bool pessimisticNotOptimistic;
     uGeofenceDynamic_t dynamic;
+    void *pIndex; /**< spatial index over the shapes of pFences, built by
+                       uGeofenceApply() and uGeofenceRemove(); NULL if
+                       there are too few shapes to need one. */
+    void *pSafeRadius; /**< the last certain outcome for each shape of
+                            pFences, built by uGeofenceApply() and
+                            uGeofenceRemove(); NULL if there are too
+                            many shapes. */
 } uGeofenceContext_t;
 
 /* ----------------------------------------------------------------
@@ -118,6 +118,61 @@
 # define U_GEOFENCE_TEST_STAR_POINTS_PER_RAY 16
 #endif
 
+#ifndef U_GEOFENCE_TEST_INDEX_GRID_SIDE
+/** The number of fences along each side of the grid of fences used
+ * when testing the spatial index of a geofence context: there
+ * will be the square of this number of fences, each with a circle
+ * and a polygon in it, plus one very large fence.
+ */
+# define U_GEOFENCE_TEST_INDEX_GRID_SIDE 6
+#endif
+
+/** The number of fences used when testing the spatial index.
+ */
+#define U_GEOFENCE_TEST_INDEX_NUM_FENCES ((U_GEOFENCE_TEST_INDEX_GRID_SIDE * \
+                                          U_GEOFENCE_TEST_INDEX_GRID_SIDE) + 1)
+
+#ifndef U_GEOFENCE_TEST_CONCURRENT_NUM_TASKS
+/** The number of tasks that test positions against a fence at the
+ * same time in the concurrency test.
+ */
+# define U_GEOFENCE_TEST_CONCURRENT_NUM_TASKS 2
+#endif
+
+#ifndef U_GEOFENCE_TEST_CONCURRENT_NUM_TESTS
+/** The number of positions each of the tasks of the concurrency
+ * test should test.
+ */
+# define U_GEOFENCE_TEST_CONCURRENT_NUM_TESTS 2000
+#endif
+
+#ifndef U_GEOFENCE_TEST_CONCURRENT_TIMEOUT_MS
+/** How long to wait for the tasks of the concurrency test to finish.
+ */
+# define U_GEOFENCE_TEST_CONCURRENT_TIMEOUT_MS 60000
+#endif
+
+#ifndef U_GEOFENCE_TEST_SAFE_RADIUS_STEP_X1E9
+/** The distance moved east at each step in the safe radius test,
+ * in degrees times ten to the power nine: 7300 is about half
+ * a metre at 52 degrees north.
+ */
+# define U_GEOFENCE_TEST_SAFE_RADIUS_STEP_X1E9 7300
+#endif
+
+#ifndef U_GEOFENCE_TEST_SAFE_RADIUS_NUM_STEPS
+/** The number of steps to take in the safe radius test.
+ */
+# define U_GEOFENCE_TEST_SAFE_RADIUS_NUM_STEPS 1800
+#endif
+
+#ifndef U_GEOFENCE_TEST_INDEX_POINTS_SIDE
+/** The number of points along each side of the grid of positions
+ * tested when testing the spatial index.
+ */
+# define U_GEOFENCE_TEST_INDEX_POINTS_SIDE 30
+#endif
+
 #ifdef _WIN32
 /** The radius of a spherical earth in metres.
  */
@@ -158,6 +213,24 @@ typedef struct {
 } uGeofenceTestKmlStarSet_t;
 #endif
 
+/** Structure to hand to each of the tasks of the concurrency test.
+ */
+typedef struct {
+    uGeofence_t *pFence;
+    uGeofenceContext_t *pContext;
+    size_t numFailures;
+    volatile bool done;
+} uGeofenceTestConcurrent_t;
+
+/** Structure to capture what the callback of a geofence context
+ * reports for each of the fences when testing the spatial index.
+ */
+typedef struct {
+    uGeofencePositionState_t positionState[U_GEOFENCE_TEST_INDEX_NUM_FENCES];
+    int64_t distanceMillimetres[U_GEOFENCE_TEST_INDEX_NUM_FENCES];
+    size_t numCalls;
+} uGeofenceTestIndexResults_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -166,6 +239,41 @@ typedef struct {
  */
 static uGeofence_t *gpFence = NULL;
 
+/** A second geofence, changed while gpFence is being tested in
+ * the concurrency test.
+ */
+static uGeofence_t *gpFenceChanging = NULL;
+
+/** The geofence context tested by all of the tasks in the
+ * concurrency test, to which gpFenceChanging is applied and
+ * from which it is removed while they do so.
+ */
+static uGeofenceContext_t *gpConcurrentContext = NULL;
+
+/** The fences used when testing the spatial index.
+ */
+static uGeofence_t *gpIndexFence[U_GEOFENCE_TEST_INDEX_NUM_FENCES] = {0};
+
+/** The geofence context that gpIndexFence are applied to.
+ */
+static uGeofenceContext_t *gpIndexContext = NULL;
+
+/** What the callback of gpIndexContext reported.
+ */
+static uGeofenceTestIndexResults_t gIndexResults = {0};
+
+/** The positions of a set of test data, as passed to
+ * uGeofenceTestBatch(), and the outcome from testing them one at
+ * a time with uGeofenceTest().
+ */
+static int64_t gBatchLatitudeX1e9[U_GEOFENCE_TEST_DATA_MAX_NUM_POINTS];
+static int64_t gBatchLongitudeX1e9[U_GEOFENCE_TEST_DATA_MAX_NUM_POINTS];
+static int32_t gBatchAltitudeMillimetres[U_GEOFENCE_TEST_DATA_MAX_NUM_POINTS];
+static int32_t gBatchRadiusMillimetres[U_GEOFENCE_TEST_DATA_MAX_NUM_POINTS];
+static int32_t gBatchAltitudeUncertaintyMillimetres[U_GEOFENCE_TEST_DATA_MAX_NUM_POINTS];
+static uGeofencePositionState_t gBatchPositionState[U_GEOFENCE_TEST_DATA_MAX_NUM_POINTS];
+static uGeofencePositionState_t gBatchPositionStateExpected[U_GEOFENCE_TEST_DATA_MAX_NUM_POINTS];
+
 /** String to print for each test type.
  */
 static const char *gpTestTypeString[] = {"none", "in", "out", "transit"};
@@ -623,6 +731,75 @@ static void kmlStarTransformVertex(const uGeofenceTestVertex_t *pVertex,
 
 #endif
 
+// Task for the concurrency test: tests a position that is inside
+// the fence over and over, both on its own and through the context
+// it is applied to.
+static void concurrentTask(void *pParam)
+{
+    uGeofenceTestConcurrent_t *pConcurrent = (uGeofenceTestConcurrent_t *) pParam;
+
+    for (size_t x = 0; x < U_GEOFENCE_TEST_CONCURRENT_NUM_TESTS; x++) {
+        if (!uGeofenceTest(pConcurrent->pFence, U_GEOFENCE_TEST_TYPE_INSIDE, false,
+                           500000, -500000, INT_MIN, 0, -1)) {
+            pConcurrent->numFailures++;
+        }
+        if (uGeofenceContextTest(NULL, pConcurrent->pContext,
+                                 U_GEOFENCE_TEST_TYPE_INSIDE, false,
+                                 500000, -500000, INT_MIN,
+                                 (int32_t) (x % 1000), -1) != U_GEOFENCE_POSITION_STATE_INSIDE) {
+            pConcurrent->numFailures++;
+        }
+    }
+
+    pConcurrent->done = true;
+    uPortTaskDelete(NULL);
+}
+
+// Check that the distance reported through the callback of a geofence
+// context is the same as that for the fence on its own or, if not, that
+// it is a lower bound on it.
+static bool indexDistanceIsGood(int64_t contextDistanceMillimetres,
+                                int64_t fenceDistanceMillimetres)
+{
+    return (contextDistanceMillimetres == fenceDistanceMillimetres) ||
+           ((contextDistanceMillimetres != LLONG_MIN) &&
+            ((fenceDistanceMillimetres == LLONG_MIN) ||
+             (contextDistanceMillimetres < fenceDistanceMillimetres)));
+}
+
+// Callback for the geofence contexts used when testing the spatial
+// index and the safe radius: records the outcome for each fence.
+static void indexCallback(uDeviceHandle_t devHandle,
+                          const void *pFence,
+                          const char *pNameStr,
+                          uGeofencePositionState_t positionState,
+                          int64_t latitudeX1e9,
+                          int64_t longitudeX1e9,
+                          int32_t altitudeMillimetres,
+                          int32_t radiusMillimetres,
+                          int32_t altitudeUncertaintyMillimetres,
+                          int64_t distanceMillimetres,
+                          void *pCallbackParam)
+{
+    uGeofenceTestIndexResults_t *pResults = (uGeofenceTestIndexResults_t *) pCallbackParam;
+
+    (void) devHandle;
+    (void) pNameStr;
+    (void) latitudeX1e9;
+    (void) longitudeX1e9;
+    (void) altitudeMillimetres;
+    (void) radiusMillimetres;
+    (void) altitudeUncertaintyMillimetres;
+
+    for (size_t x = 0; x < U_GEOFENCE_TEST_INDEX_NUM_FENCES; x++) {
+        if (gpIndexFence[x] == pFence) {
+            pResults->positionState[x] = positionState;
+            pResults->distanceMillimetres[x] = distanceMillimetres;
+        }
+    }
+    pResults->numCalls++;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -649,6 +826,7 @@ U_PORT_TEST_FUNCTION("[geofence]", "geofenceBasic")
     size_t numShapes;
     size_t numFailedCalculations;
     int64_t distanceMinMillimetres;
+    int32_t numTestsMet;
 
     uPortDeinit();
 
@@ -727,6 +905,33 @@ U_PORT_TEST_FUNCTION("[geofence]", "geofenceBasic")
                                           U_GEOFENCE_TEST_LONGITUDE_MIN_X1E9, 1000) == 0);
     U_PORT_TEST_ASSERT(uGeofenceFree(gpFence) == 0);
 
+    // Check that a compiled polygon is compiled again when added to:
+    // the point is outside a triangle formed from three corners of a
+    // square but is inside once the fourth corner is added
+    gpFence = pUGeofenceCreate(U_GEOFENCE_TEST_FENCE_NAME);
+    U_PORT_TEST_ASSERT(gpFence != NULL);
+    U_PORT_TEST_ASSERT(uGeofenceFreeze(NULL) < 0);
+    U_PORT_TEST_ASSERT(uGeofenceFreeze(gpFence) == 0);
+    U_PORT_TEST_ASSERT(uGeofenceAddVertex(gpFence, -1000000, -1000000, false) == 0);
+    U_PORT_TEST_ASSERT(uGeofenceAddVertex(gpFence, -1000000, 1000000, false) == 0);
+    U_PORT_TEST_ASSERT(uGeofenceAddVertex(gpFence, 1000000, 1000000, false) == 0);
+    U_PORT_TEST_ASSERT(!uGeofenceTest(gpFence, U_GEOFENCE_TEST_TYPE_INSIDE, false,
+                                      500000, -500000, INT_MIN, 0, -1));
+    U_PORT_TEST_ASSERT(uGeofenceFreeze(gpFence) == 0);
+    U_PORT_TEST_ASSERT(!uGeofenceTest(gpFence, U_GEOFENCE_TEST_TYPE_INSIDE, false,
+                                      500000, -500000, INT_MIN, 0, -1));
+    U_PORT_TEST_ASSERT(uGeofenceAddVertex(gpFence, 1000000, -1000000, false) == 0);
+    U_PORT_TEST_ASSERT(uGeofenceTest(gpFence, U_GEOFENCE_TEST_TYPE_INSIDE, false,
+                                     500000, -500000, INT_MIN, 0, -1));
+    // Invalid parameters to the batch test
+    U_PORT_TEST_ASSERT(uGeofenceTestBatch(NULL, U_GEOFENCE_TEST_TYPE_INSIDE, false,
+                                          0, NULL, NULL, NULL, NULL, NULL, NULL) < 0);
+    U_PORT_TEST_ASSERT(uGeofenceTestBatch(gpFence, U_GEOFENCE_TEST_TYPE_INSIDE, false,
+                                          1, NULL, NULL, NULL, NULL, NULL, NULL) < 0);
+    U_PORT_TEST_ASSERT(uGeofenceTestBatch(gpFence, U_GEOFENCE_TEST_TYPE_INSIDE, false,
+                                          0, NULL, NULL, NULL, NULL, NULL, NULL) == 0);
+    U_PORT_TEST_ASSERT(uGeofenceFree(gpFence) == 0);
+
     // Now run through the test data
     for (size_t x = 0; x < gpUGeofenceTestDataSize; x++) {
         pTestData = gpUGeofenceTestData[x];
@@ -776,6 +981,11 @@ U_PORT_TEST_FUNCTION("[geofence]", "geofenceBasic")
             numShapes++;
             newPolygon = true;
         }
+        // On odd numbers compile the fence up-front, on even numbers
+        // leave it to be compiled when the first position is tested
+        if (x % 2 == 1) {
+            U_PORT_TEST_ASSERT(uGeofenceFreeze(gpFence) == 0);
+        }
         // Test the point(s) against the fence in all permutations of parameters,
         // do it twice, once with prints and then without to get an accurate timing
         for (size_t t = 0; t < 2; t++) {
@@ -872,6 +1082,40 @@ U_PORT_TEST_FUNCTION("[geofence]", "geofenceBasic")
                 }
             }
         }
+        // Check that testing all of the points in one go gives the
+        // same outcome as testing them one at a time
+        for (size_t y = 0; y < pTestData->numPoints; y++) {
+            pTestPoint = pTestData->pPoint[y];
+            pTestPositionVariables = &(pTestPoint->positionVariables);
+            gBatchLatitudeX1e9[y] = pTestPoint->pPosition->latitudeX1e9;
+            gBatchLongitudeX1e9[y] = pTestPoint->pPosition->longitudeX1e9;
+            gBatchAltitudeMillimetres[y] = pTestPositionVariables->altitudeMillimetres;
+            gBatchRadiusMillimetres[y] = pTestPositionVariables->radiusMillimetres;
+            gBatchAltitudeUncertaintyMillimetres[y] = pTestPositionVariables->altitudeUncertaintyMillimetres;
+        }
+        for (size_t z = 0; z < sizeof(gTestParameters) / sizeof(gTestParameters[0]); z++) {
+            numTestsMet = 0;
+            uGeofenceTestResetMemory(gpFence);
+            for (size_t y = 0; y < pTestData->numPoints; y++) {
+                if (uGeofenceTest(gpFence, gTestType[z], gPessimisticNotOptimistic[z],
+                                  gBatchLatitudeX1e9[y], gBatchLongitudeX1e9[y],
+                                  gBatchAltitudeMillimetres[y], gBatchRadiusMillimetres[y],
+                                  gBatchAltitudeUncertaintyMillimetres[y])) {
+                    numTestsMet++;
+                }
+                gBatchPositionStateExpected[y] = uGeofenceTestGetPositionState(gpFence);
+            }
+            uGeofenceTestResetMemory(gpFence);
+            U_PORT_TEST_ASSERT(uGeofenceTestBatch(gpFence, gTestType[z], gPessimisticNotOptimistic[z],
+                                                  pTestData->numPoints,
+                                                  gBatchLatitudeX1e9, gBatchLongitudeX1e9,
+                                                  gBatchAltitudeMillimetres, gBatchRadiusMillimetres,
+                                                  gBatchAltitudeUncertaintyMillimetres,
+                                                  gBatchPositionState) == numTestsMet);
+            for (size_t y = 0; y < pTestData->numPoints; y++) {
+                U_PORT_TEST_ASSERT(gBatchPositionState[y] == gBatchPositionStateExpected[y]);
+            }
+        }
         // On even numbers clear the fence without freeing it,
         // so that it can be re-used above, on odd numbers free it
         // so that it must be recreated when we loop
@@ -900,6 +1144,325 @@ U_PORT_TEST_FUNCTION("[geofence]", "geofenceBasic")
     U_PORT_TEST_ASSERT(resourceCount <= 0);
 }
 
+/** Test positions against a fence from several tasks at once, on
+ * its own and through a geofence context, while another fence is
+ * being changed and applied to/removed from that context: the tests
+ * should neither block nor be disturbed.
+ */
+U_PORT_TEST_FUNCTION("[geofence]", "geofenceConcurrent")
+{
+    int32_t resourceCount;
+    uGeofenceTestConcurrent_t concurrent[U_GEOFENCE_TEST_CONCURRENT_NUM_TASKS] = {0};
+    uPortTaskHandle_t taskHandle;
+    bool allDone = false;
+    size_t numChanges = 0;
+    int32_t startTimeMs;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // A square fence that the tasks will test a position inside
+    gpFence = pUGeofenceCreate(U_GEOFENCE_TEST_FENCE_NAME);
+    U_PORT_TEST_ASSERT(gpFence != NULL);
+    U_PORT_TEST_ASSERT(uGeofenceAddVertex(gpFence, -1000000, -1000000, false) == 0);
+    U_PORT_TEST_ASSERT(uGeofenceAddVertex(gpFence, -1000000, 1000000, false) == 0);
+    U_PORT_TEST_ASSERT(uGeofenceAddVertex(gpFence, 1000000, 1000000, false) == 0);
+    U_PORT_TEST_ASSERT(uGeofenceAddVertex(gpFence, 1000000, -1000000, false) == 0);
+    gpFenceChanging = pUGeofenceCreate(NULL);
+    U_PORT_TEST_ASSERT(gpFenceChanging != NULL);
+    U_PORT_TEST_ASSERT(uGeofenceApply(&gpConcurrentContext, gpFence) == 0);
+
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t x = 0; x < U_GEOFENCE_TEST_CONCURRENT_NUM_TASKS; x++) {
+        concurrent[x].pFence = gpFence;
+        concurrent[x].pContext = gpConcurrentContext;
+        U_PORT_TEST_ASSERT(uPortTaskCreate(concurrentTask, "testGeofence",
+                                           U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES,
+                                           &(concurrent[x]), U_CFG_TEST_OS_TASK_PRIORITY,
+                                           &taskHandle) == 0);
+    }
+    // While they run, keep changing and testing the other fence
+    while (!allDone &&
+           (uPortGetTickTimeMs() - startTimeMs < U_GEOFENCE_TEST_CONCURRENT_TIMEOUT_MS)) {
+        U_PORT_TEST_ASSERT(uGeofenceAddVertex(gpFenceChanging, -1000000, -1000000, false) == 0);
+        U_PORT_TEST_ASSERT(uGeofenceAddVertex(gpFenceChanging, -1000000, 1000000, false) == 0);
+        U_PORT_TEST_ASSERT(uGeofenceAddVertex(gpFenceChanging, 1000000, 1000000, false) == 0);
+        U_PORT_TEST_ASSERT(!uGeofenceTest(gpFenceChanging, U_GEOFENCE_TEST_TYPE_INSIDE, false,
+                                          500000, -500000, INT_MIN, 0, -1));
+        U_PORT_TEST_ASSERT(uGeofenceAddVertex(gpFenceChanging, 1000000, -1000000, false) == 0);
+        U_PORT_TEST_ASSERT(uGeofenceTest(gpFenceChanging, U_GEOFENCE_TEST_TYPE_INSIDE, false,
+                                         500000, -500000, INT_MIN, 0, -1));
+        U_PORT_TEST_ASSERT(uGeofenceApply(&gpConcurrentContext, gpFenceChanging) == 0);
+        U_PORT_TEST_ASSERT(uGeofenceRemove(&gpConcurrentContext, gpFenceChanging) == 0);
+        U_PORT_TEST_ASSERT(uGeofenceClearMap(gpFenceChanging) == 0);
+        numChanges++;
+        allDone = true;
+        for (size_t x = 0; x < U_GEOFENCE_TEST_CONCURRENT_NUM_TASKS; x++) {
+            if (!concurrent[x].done) {
+                allDone = false;
+            }
+        }
+    }
+    U_TEST_PRINT_LINE("%d task(s) each tested %d position(s) while the other fence"
+                      " was changed %d time(s), took %d ms.",
+                      U_GEOFENCE_TEST_CONCURRENT_NUM_TASKS,
+                      U_GEOFENCE_TEST_CONCURRENT_NUM_TESTS, numChanges,
+                      uPortGetTickTimeMs() - startTimeMs);
+    U_PORT_TEST_ASSERT(allDone);
+    // Let the tasks be deleted
+    uPortTaskBlock(U_CFG_OS_YIELD_MS);
+    for (size_t x = 0; x < U_GEOFENCE_TEST_CONCURRENT_NUM_TASKS; x++) {
+        U_PORT_TEST_ASSERT(concurrent[x].numFailures == 0);
+    }
+
+    U_PORT_TEST_ASSERT(uGeofenceRemove(&gpConcurrentContext, NULL) == 0);
+    uGeofenceContextFree(&gpConcurrentContext);
+    U_PORT_TEST_ASSERT(uGeofenceFree(gpFenceChanging) == 0);
+    gpFenceChanging = NULL;
+    U_PORT_TEST_ASSERT(uGeofenceFree(gpFence) == 0);
+    gpFence = NULL;
+    uGeofenceCleanUp();
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test that remembering, for each shape, the last certain outcome
+ * for a device and the distance to the edge of the shape, which lets
+ * uGeofenceContextTest() skip shapes that a position can't have moved
+ * far enough to change, gives the same answers as testing the fence
+ * on its own: the track walks in small steps, as a slow-moving
+ * device would, through a circle and then a square.
+ */
+U_PORT_TEST_FUNCTION("[geofence]", "geofenceSafeRadius")
+{
+    int32_t resourceCount;
+    uGeofence_t *pFence;
+    int64_t latitudeX1e9 = 52000200000LL;
+    int64_t longitudeX1e9 = -5000000LL;
+    bool testIsMet;
+    size_t numCarriedOver = 0;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // A fence with a circle of radius 100 metres and a square
+    // about 200 metres on a side a little to the east of it
+    pFence = pUGeofenceCreate(NULL);
+    U_PORT_TEST_ASSERT(pFence != NULL);
+    gpIndexFence[0] = pFence;
+    U_PORT_TEST_ASSERT(uGeofenceAddCircle(pFence, 52000000000LL, 0, 100000) == 0);
+    U_PORT_TEST_ASSERT(uGeofenceAddVertex(pFence, 51999000000LL, 3000000LL, false) == 0);
+    U_PORT_TEST_ASSERT(uGeofenceAddVertex(pFence, 52001000000LL, 3000000LL, false) == 0);
+    U_PORT_TEST_ASSERT(uGeofenceAddVertex(pFence, 52001000000LL, 6000000LL, false) == 0);
+    U_PORT_TEST_ASSERT(uGeofenceAddVertex(pFence, 51999000000LL, 6000000LL, false) == 0);
+    U_PORT_TEST_ASSERT(uGeofenceApply(&gpIndexContext, pFence) == 0);
+    U_PORT_TEST_ASSERT(uGeofenceSetCallback(&gpIndexContext, U_GEOFENCE_TEST_TYPE_INSIDE,
+                                            false, indexCallback, &gIndexResults) == 0);
+#if U_GEOFENCE_SAFE_RADIUS_SHAPES_MAX > 1
+    U_PORT_TEST_ASSERT(gpIndexContext->pSafeRadius != NULL);
+#endif
+
+    for (size_t x = 0; x < U_GEOFENCE_TEST_SAFE_RADIUS_NUM_STEPS; x++) {
+        memset(&gIndexResults, 0, sizeof(gIndexResults));
+        uGeofenceContextTest((uDeviceHandle_t) &gIndexResults, gpIndexContext,
+                             U_GEOFENCE_TEST_TYPE_NONE, false,
+                             latitudeX1e9, longitudeX1e9, INT_MIN, 3000, -1);
+        U_PORT_TEST_ASSERT(gIndexResults.numCalls == 1);
+        testIsMet = uGeofenceTest(pFence, U_GEOFENCE_TEST_TYPE_INSIDE, false,
+                                  latitudeX1e9, longitudeX1e9, INT_MIN, 3000, -1);
+        if ((uGeofenceTestGetPositionState(pFence) != gIndexResults.positionState[0]) ||
+            !indexDistanceIsGood(gIndexResults.distanceMillimetres[0],
+                                 uGeofenceTestGetDistanceMin(pFence)) ||
+            (testIsMet != (gIndexResults.positionState[0] == U_GEOFENCE_POSITION_STATE_INSIDE))) {
+            U_TEST_PRINT_LINE("step %d: context says %s, %d mm, fence says %s, %d mm.", x,
+                              gpPositionStateString[gIndexResults.positionState[0]],
+                              (int32_t) gIndexResults.distanceMillimetres[0],
+                              gpPositionStateString[uGeofenceTestGetPositionState(pFence)],
+                              (int32_t) uGeofenceTestGetDistanceMin(pFence));
+            U_PORT_TEST_ASSERT(false);
+        }
+        if (gIndexResults.distanceMillimetres[0] != uGeofenceTestGetDistanceMin(pFence)) {
+            numCarriedOver++;
+        }
+        longitudeX1e9 += U_GEOFENCE_TEST_SAFE_RADIUS_STEP_X1E9;
+    }
+    U_TEST_PRINT_LINE("%d of %d step(s) carried over an outcome from an earlier step.",
+                      numCarriedOver, U_GEOFENCE_TEST_SAFE_RADIUS_NUM_STEPS);
+#if U_GEOFENCE_SAFE_RADIUS_SHAPES_MAX > 1
+    U_PORT_TEST_ASSERT(numCarriedOver > U_GEOFENCE_TEST_SAFE_RADIUS_NUM_STEPS / 4);
+#endif
+
+    U_PORT_TEST_ASSERT(uGeofenceRemove(&gpIndexContext, NULL) == 0);
+    uGeofenceContextFree(&gpIndexContext);
+    U_PORT_TEST_ASSERT(uGeofenceFree(pFence) == 0);
+    gpIndexFence[0] = NULL;
+    uGeofenceCleanUp();
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test that the spatial index of a geofence context, which lets
+ * uGeofenceContextTest() skip the shapes that a position is nowhere
+ * near, gives exactly the same answers as testing each fence on its
+ * own.  The fences are laid out across the 180 degree meridian so
+ * that shapes which straddle it are included.
+ */
+U_PORT_TEST_FUNCTION("[geofence]", "geofenceIndex")
+{
+    int32_t resourceCount;
+    uGeofence_t *pFence;
+    int64_t latitudeX1e9;
+    int64_t longitudeX1e9;
+    int32_t radiusMillimetres;
+    bool testIsMet;
+    size_t numFences = U_GEOFENCE_TEST_INDEX_NUM_FENCES;
+    size_t numTests = 0;
+    int32_t startTimeMs;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Create a grid of fences 0.02 degrees apart, each with a circle
+    // of radius 300 metres and, just north of it, a square polygon
+    // 0.004 degrees on a side
+    for (size_t x = 0; x < U_GEOFENCE_TEST_INDEX_GRID_SIDE * U_GEOFENCE_TEST_INDEX_GRID_SIDE; x++) {
+        latitudeX1e9 = 52000000000LL + ((int64_t) (x / U_GEOFENCE_TEST_INDEX_GRID_SIDE)) * 20000000LL;
+        longitudeX1e9 = 179970000000LL + ((int64_t) (x % U_GEOFENCE_TEST_INDEX_GRID_SIDE)) * 20000000LL;
+        if (longitudeX1e9 >= 180000000000LL) {
+            longitudeX1e9 -= 360000000000LL;
+        }
+        pFence = pUGeofenceCreate(NULL);
+        U_PORT_TEST_ASSERT(pFence != NULL);
+        gpIndexFence[x] = pFence;
+        U_PORT_TEST_ASSERT(uGeofenceAddCircle(pFence, latitudeX1e9, longitudeX1e9, 300000) == 0);
+        latitudeX1e9 += 5000000LL;
+        U_PORT_TEST_ASSERT(uGeofenceAddVertex(pFence, latitudeX1e9 - 2000000LL,
+                                              longitudeX1e9 - 2000000LL, false) == 0);
+        U_PORT_TEST_ASSERT(uGeofenceAddVertex(pFence, latitudeX1e9 + 2000000LL,
+                                              longitudeX1e9 - 2000000LL, false) == 0);
+        U_PORT_TEST_ASSERT(uGeofenceAddVertex(pFence, latitudeX1e9 + 2000000LL,
+                                              longitudeX1e9 + 2000000LL, false) == 0);
+        U_PORT_TEST_ASSERT(uGeofenceAddVertex(pFence, latitudeX1e9 - 2000000LL,
+                                              longitudeX1e9 + 2000000LL, false) == 0);
+    }
+    // Plus one fence so large that the index can't bound it
+    pFence = pUGeofenceCreate(NULL);
+    U_PORT_TEST_ASSERT(pFence != NULL);
+    gpIndexFence[numFences - 1] = pFence;
+    U_PORT_TEST_ASSERT(uGeofenceAddCircle(pFence, 0, 0, 8000000000LL) == 0);
+
+    // Apply all of the fences to a context and hook in a callback
+    for (size_t x = 0; x < numFences; x++) {
+        U_PORT_TEST_ASSERT(uGeofenceApply(&gpIndexContext, gpIndexFence[x]) == 0);
+    }
+    U_PORT_TEST_ASSERT(gpIndexContext != NULL);
+#if U_GEOFENCE_INDEX_SHAPES_MIN > 0
+    U_PORT_TEST_ASSERT((U_GEOFENCE_INDEX_SHAPES_MIN > (numFences * 2) - 1) ||
+                       (gpIndexContext->pIndex != NULL));
+#endif
+    U_PORT_TEST_ASSERT(uGeofenceSetCallback(&gpIndexContext, U_GEOFENCE_TEST_TYPE_INSIDE,
+                                            false, indexCallback, &gIndexResults) == 0);
+
+    // Test a grid of positions that covers all of the fences and a
+    // little beyond, with a selection of radii, the largest of which
+    // is too large for the index to be used, and check that the
+    // callback says the same as testing each fence on its own
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t y = 0; y < U_GEOFENCE_TEST_INDEX_POINTS_SIDE * U_GEOFENCE_TEST_INDEX_POINTS_SIDE; y++) {
+        latitudeX1e9 = 51990000000LL + ((int64_t) (y / U_GEOFENCE_TEST_INDEX_POINTS_SIDE)) * 4300000LL;
+        longitudeX1e9 = 179955000000LL + ((int64_t) (y % U_GEOFENCE_TEST_INDEX_POINTS_SIDE)) * 4300000LL;
+        if (longitudeX1e9 >= 180000000000LL) {
+            longitudeX1e9 -= 360000000000LL;
+        }
+        radiusMillimetres = 0;
+        if (y % 3 == 1) {
+            radiusMillimetres = 50000;
+        } else if (y % 3 == 2) {
+            radiusMillimetres = 200000;
+        }
+        memset(&gIndexResults, 0, sizeof(gIndexResults));
+        uGeofenceContextTest((uDeviceHandle_t) &gIndexResults, gpIndexContext,
+                             U_GEOFENCE_TEST_TYPE_NONE, false,
+                             latitudeX1e9, longitudeX1e9, INT_MIN,
+                             radiusMillimetres, -1);
+        U_PORT_TEST_ASSERT(gIndexResults.numCalls == numFences);
+        for (size_t x = 0; x < numFences; x++) {
+            testIsMet = uGeofenceTest(gpIndexFence[x], U_GEOFENCE_TEST_TYPE_INSIDE, false,
+                                      latitudeX1e9, longitudeX1e9, INT_MIN,
+                                      radiusMillimetres, -1);
+            // The distance may be a lower bound if the outcome for a
+            // shape was carried over from an earlier position
+            if ((uGeofenceTestGetPositionState(gpIndexFence[x]) != gIndexResults.positionState[x]) ||
+                !indexDistanceIsGood(gIndexResults.distanceMillimetres[x],
+                                     uGeofenceTestGetDistanceMin(gpIndexFence[x])) ||
+                (testIsMet != (gIndexResults.positionState[x] == U_GEOFENCE_POSITION_STATE_INSIDE))) {
+                U_TEST_PRINT_LINE("position %d, radius %d mm, fence %d: context says %s, %d mm,"
+                                  " fence says %s, %d mm.", y, radiusMillimetres, x,
+                                  gpPositionStateString[gIndexResults.positionState[x]],
+                                  (int32_t) gIndexResults.distanceMillimetres[x],
+                                  gpPositionStateString[uGeofenceTestGetPositionState(gpIndexFence[x])],
+                                  (int32_t) uGeofenceTestGetDistanceMin(gpIndexFence[x]));
+                U_PORT_TEST_ASSERT(false);
+            }
+        }
+        numTests++;
+    }
+    U_TEST_PRINT_LINE("%d positions tested against %d fences in %d ms.", numTests,
+                      numFences, uPortGetTickTimeMs() - startTimeMs);
+
+    // Remove one fence, which should rebuild the index, and check
+    // that a position inside the fence after it is still found
+    U_PORT_TEST_ASSERT(uGeofenceRemove(&gpIndexContext, gpIndexFence[0]) == 0);
+    memset(&gIndexResults, 0, sizeof(gIndexResults));
+    U_PORT_TEST_ASSERT(uGeofenceContextTest((uDeviceHandle_t) &gIndexResults, gpIndexContext,
+                                            U_GEOFENCE_TEST_TYPE_NONE, false,
+                                            52000000000LL, 179990000000LL,
+                                            INT_MIN, 0, -1) == U_GEOFENCE_POSITION_STATE_INSIDE);
+    U_PORT_TEST_ASSERT(gIndexResults.numCalls == numFences - 1);
+
+    // Remove the rest and free everything
+    U_PORT_TEST_ASSERT(uGeofenceRemove(&gpIndexContext, NULL) == 0);
+    uGeofenceContextFree(&gpIndexContext);
+    U_PORT_TEST_ASSERT(gpIndexContext == NULL);
+    for (size_t x = 0; x < numFences; x++) {
+        U_PORT_TEST_ASSERT(uGeofenceFree(gpIndexFence[x]) == 0);
+        gpIndexFence[x] = NULL;
+    }
+    uGeofenceCleanUp();
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
 #ifdef _WIN32
 
 /** Repeat run through the standalone test data but producing
@@ -1152,7 +1715,19 @@ U_PORT_TEST_FUNCTION("[geofence]", "geofenceStars")
 U_PORT_TEST_FUNCTION("[geofence]", "geofenceCleanUp")
 {
     // In case a fence was left hanging
+    if (gpConcurrentContext != NULL) {
+        uGeofenceRemove(&gpConcurrentContext, NULL);
+        uGeofenceContextFree(&gpConcurrentContext);
+    }
     uGeofenceFree(gpFence);
+    uGeofenceFree(gpFenceChanging);
+    if (gpIndexContext != NULL) {
+        uGeofenceRemove(&gpIndexContext, NULL);
+        uGeofenceContextFree(&gpIndexContext);
+    }
+    for (size_t x = 0; x < sizeof(gpIndexFence) / sizeof(gpIndexFence[0]); x++) {
+        uGeofenceFree(gpIndexFence[x]);
+    }
     uGeofenceCleanUp();
 
 #ifdef _WIN32
@@ -0,0 +1,116 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_CRC_H_
+#define _U_CRC_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup __utils
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the 24-bit and 32-bit CRC functions
+ * shared by the RTCM parsing in the GNSS code and by SPARTN.  Each
+ * comes in an incremental form, so that a streaming parser can CRC
+ * data as it arrives, and uses "slicing" tables so that blocks of
+ * data are processed several bytes at a time.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_CRC_SLICES
+/** The number of bytes that the CRC functions process in one step
+ * for blocks of data: 1, 4 or 8.  Each CRC needs this many 1 kbyte
+ * tables in ROM, so 8 is fastest but 1 is smallest.
+ */
+# define U_CRC_SLICES 4
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Perform a CRC-24Q calculation (polynomial 0x864CFB, initial
+ * value zero, no final XOR) on a block of data; this is the CRC
+ * used by RTCM 3 and is also the SPARTN CRC-24.
+ *
+ * @param pData  a pointer to the data to be checked.
+ * @param size   the number of bytes pointed to by pData.
+ * @return       the CRC.
+ */
+uint32_t uCrc24Q(const char *pData, size_t size);
+
+/** Continue a CRC-24Q calculation with more data: the CRC of some
+ * data followed by some more data is
+ * uCrc24QUpdate(uCrc24Q(pData1, size1), pData2, size2) and
+ * uCrc24QUpdate(0, pData, size) is the same as uCrc24Q(pData, size).
+ *
+ * @param crc    the CRC of the data so far, 0 at the start.
+ * @param pData  a pointer to the additional data.
+ * @param size   the number of bytes pointed to by pData.
+ * @return       the CRC of all of the data so far.
+ */
+uint32_t uCrc24QUpdate(uint32_t crc, const char *pData, size_t size);
+
+/** Perform a 32-bit CRC calculation (polynomial 0x04C11DB7, MSB
+ * first, initial value and final XOR 0xFFFFFFFF, sometimes known as
+ * CRC-32/BZIP2) on a block of data; this is the SPARTN CRC-32.
+ *
+ * @param pData  a pointer to the data to be checked.
+ * @param size   the number of bytes pointed to by pData.
+ * @return       the CRC.
+ */
+uint32_t uCrc32(const char *pData, size_t size);
+
+/** Continue a 32-bit CRC calculation with more data, in the same
+ * way as uCrc24QUpdate(); uCrc32Update(0, pData, size) is the
+ * same as uCrc32(pData, size).
+ *
+ * @param crc    the CRC of the data so far, 0 at the start.
+ * @param pData  a pointer to the additional data.
+ * @param size   the number of bytes pointed to by pData.
+ * @return       the CRC of all of the data so far.
+ */
+uint32_t uCrc32Update(uint32_t crc, const char *pData, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_CRC_H_
+
+// End of file
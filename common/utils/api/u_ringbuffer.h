@@ -28,8 +28,9 @@
 
 /** @file
  * @brief Ring buffer wrapper API for linear buffer.
- * All functions except uRingBufferCreate() and uRingBufferDelete()
- * are thread-safe.
+ * All functions except uRingBufferCreate(), uRingBufferCreateSpsc()
+ * and uRingBufferDelete() are thread-safe, subject to the constraints
+ * described for uRingBufferCreateSpsc().
  */
 
 #ifdef __cplusplus
@@ -40,6 +41,14 @@ extern "C" {
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_RING_BUFFER_PARSE_STATE_NUM_VALUES
+/** The number of uint32_t values that a parser may keep, per
+ * read handle, between calls to uRingBufferParseHandle(); see
+ * pURingBufferParseStateUnprotected().
+ */
+# define U_RING_BUFFER_PARSE_STATE_NUM_VALUES 4
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -99,6 +108,29 @@ typedef struct {
                                          as a result of add or forced add
                                          being unable to write into the
                                          ring buffer. */
+    bool isSpsc;                    /**< true if the ring buffer was created
+                                         with uRingBufferCreateSpsc(), in
+                                         which case spscReadIndex and
+                                         spscWriteIndex are used in place
+                                         of the read/write pointers and
+                                         the mutex is not used when
+                                         adding or reading data. */
+    volatile size_t spscReadIndex;  /**< the read index, only written by
+                                         the consumer. */
+    volatile size_t spscWriteIndex; /**< the write index, only written by
+                                         the producer. */
+    void *pParseState;              /**< storage for the state that a parser
+                                         may keep for each read pointer between
+                                         calls to uRingBufferParseHandle(),
+                                         malloc'ed in the
+                                         uRingBufferCreateWithReadHandle() case,
+                                         otherwise NULL; brought in as void *
+                                         since the type is internal. */
+    size_t writeReservedBytes;      /**< the number of bytes handed out
+                                         by uRingBufferReserveSpans()
+                                         and not yet committed with
+                                         uRingBufferCommit(), zero if
+                                         there is no reservation. */
 } uRingBuffer_t;
 
 typedef void *uParseHandle_t; //!< Parser handle.
@@ -148,6 +180,32 @@ void uRingBufferDump(uRingBuffer_t *pRingBuffer);
 int32_t uRingBufferCreate(uRingBuffer_t *pRingBuffer, char *pLinearBuffer,
                           size_t size);
 
+/** Create a new ring buffer from a linear buffer for use by
+ * exactly one producer (one thread calling uRingBufferAdd()) and
+ * exactly one consumer (one thread calling uRingBufferRead() etc.),
+ * e.g. a UART receive task and the task processing what it receives.
+ * Such a ring buffer uses atomic read/write indexes rather than the
+ * mutex when data is added or read, so neither side is ever blocked
+ * by the other.  The constraints are:
+ *
+ * - read handles are not supported, uRingBufferTakeReadHandle() will
+ *   fail, as will uRingBufferParseHandle(),
+ * - uRingBufferForceAdd() behaves exactly as uRingBufferAdd(), since
+ *   the producer cannot move the read index of the consumer,
+ * - uRingBufferFlush(), uRingBufferFlushValue(), uRingBufferReset()
+ *   and uRingBufferConsume() may only be called by the consumer,
+ *   uRingBufferReset() behaving the same as uRingBufferFlush().
+ *
+ * @param[in] pRingBuffer   a pointer to a ring buffer, cannot be NULL.
+ * @param[in] pLinearBuffer a pointer to the linear buffer.
+ * @param size              the size of the linear buffer in bytes; the
+ *                          ring buffer will be of maximum size this
+ *                          number minus one.
+ * @return                  zero on success else negative error code.
+ */
+int32_t uRingBufferCreateSpsc(uRingBuffer_t *pRingBuffer, char *pLinearBuffer,
+                              size_t size);
+
 /** Delete a ring buffer.
  *
  * @param[in] pRingBuffer   a pointer to the ring buffer, cannot be NULL.
@@ -455,11 +513,121 @@ void uRingBufferFlushHandle(uRingBuffer_t *pRingBuffer, int32_t handle);
 size_t uRingBufferStatReadLossHandle(uRingBuffer_t *pRingBuffer,
                                      int32_t handle);
 
+/* ----------------------------------------------------------------
+ * FUNCTIONS: ZERO-COPY
+ * -------------------------------------------------------------- */
+
+/** Get direct access to the data waiting at a read pointer, without
+ * copying it: since the data may wrap around the end of the linear
+ * buffer it is returned as up to two contiguous spans, the second
+ * of which, if present, follows on from the first.  The read pointer
+ * is not moved, call uRingBufferConsume() once the data has been
+ * dealt with.  The spans point into the linear buffer of the ring
+ * buffer: they remain valid until uRingBufferConsume(),
+ * uRingBufferFlush()/uRingBufferFlushHandle() or uRingBufferReset()
+ * is called, PROVIDED nothing else is able to move the read pointer
+ * on; if uRingBufferForceAdd() is used on this ring buffer then,
+ * for a handled read, you should lock the read handle with
+ * uRingBufferLockReadHandle() while the spans are in use.
+ *
+ * @param[in] pRingBuffer a pointer to the ring buffer, cannot be NULL.
+ * @param handle          a read handle, as originally returned by
+ *                        uRingBufferTakeReadHandle(), or 0 for the
+ *                        data of uRingBufferRead() (in which case
+ *                        nothing will be returned if
+ *                        uRingBufferSetReadRequiresHandle() is true).
+ * @param[out] ppData1    a place to put a pointer to the first span,
+ *                        NULL if there is no data; may be NULL.
+ * @param[out] pLength1   a place to put the length of the first span;
+ *                        may be NULL.
+ * @param[out] ppData2    a place to put a pointer to the second span,
+ *                        NULL if the data does not wrap; may be NULL.
+ * @param[out] pLength2   a place to put the length of the second span,
+ *                        zero if the data does not wrap; may be NULL.
+ * @return                the total number of bytes in the spans, i.e.
+ *                        the number of bytes available for reading.
+ */
+size_t uRingBufferPeekSpans(uRingBuffer_t *pRingBuffer, int32_t handle,
+                            const char **ppData1, size_t *pLength1,
+                            const char **ppData2, size_t *pLength2);
+
+/** Move a read pointer on, throwing data away; intended to be used
+ * after data obtained with uRingBufferPeekSpans() has been dealt with.
+ * This is equivalent to calling uRingBufferRead()/uRingBufferReadHandle()
+ * with a NULL data pointer.
+ *
+ * @param[in] pRingBuffer a pointer to the ring buffer, cannot be NULL.
+ * @param handle          a read handle, as originally returned by
+ *                        uRingBufferTakeReadHandle(), or 0 for the
+ *                        data of uRingBufferRead().
+ * @param length          the number of bytes to consume.
+ * @return                the number of bytes consumed, which will be
+ *                        less than length if fewer bytes were available.
+ */
+size_t uRingBufferConsume(uRingBuffer_t *pRingBuffer, int32_t handle,
+                          size_t length);
+
+/** Get direct access to free space in the ring buffer so that data
+ * can be written into it without first being copied somewhere else,
+ * e.g. by passing the spans straight to a UART or I2C read function;
+ * once the data has been written, call uRingBufferCommit() to make
+ * it available to readers.  As with uRingBufferPeekSpans() the space
+ * may wrap around the end of the linear buffer and so is returned
+ * as up to two contiguous spans, the second of which, if present,
+ * follows on from the first.
+ *
+ * Only one reservation may be outstanding at a time: while it is,
+ * a further call to this function will return zero and
+ * uRingBufferAdd()/uRingBufferForceAdd() will fail.  Readers are
+ * unaffected: they will not see any of the reserved space until
+ * it is committed.  uRingBufferReset() cancels any reservation.
+ *
+ * If force is true, room is made as for uRingBufferForceAdd(), i.e.
+ * data is thrown away from any read pointers that are not locked, so
+ * only ask for as much space as you expect to fill.
+ *
+ * @param[in] pRingBuffer a pointer to the ring buffer, cannot be NULL.
+ * @param length          the amount of space wanted.
+ * @param force           if true, make room by throwing away data
+ *                        from read pointers that are not locked.
+ * @param[out] ppData1    a place to put a pointer to the first span,
+ *                        NULL if no space could be reserved; may be NULL.
+ * @param[out] pLength1   a place to put the length of the first span;
+ *                        may be NULL.
+ * @param[out] ppData2    a place to put a pointer to the second span,
+ *                        NULL if the space does not wrap; may be NULL.
+ * @param[out] pLength2   a place to put the length of the second span,
+ *                        zero if the space does not wrap; may be NULL.
+ * @return                the total number of bytes reserved, which
+ *                        may be less than length.
+ */
+size_t uRingBufferReserveSpans(uRingBuffer_t *pRingBuffer, size_t length,
+                               bool force, char **ppData1, size_t *pLength1,
+                               char **ppData2, size_t *pLength2);
+
+/** Make data written into the space obtained with
+ * uRingBufferReserveSpans() available to readers, ending the
+ * reservation; the data is taken to start at the beginning of
+ * the first span and to continue into the second span, if there
+ * is one.  It is fine to commit fewer bytes than were reserved,
+ * including none, the remainder is simply returned to the ring
+ * buffer.
+ *
+ * @param[in] pRingBuffer a pointer to the ring buffer, cannot be NULL.
+ * @param length          the number of bytes written.
+ * @return                the number of bytes committed, which will be
+ *                        less than length if fewer bytes had been
+ *                        reserved.
+ */
+size_t uRingBufferCommit(uRingBuffer_t *pRingBuffer, size_t length);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: PARSER
  * -------------------------------------------------------------- */
 
-/** Run a set of parsers over the contents of the ring buffer.
+/** Run a set of parsers over the contents of the ring buffer.  If a
+ * parser kept state for the read handle last time (see
+ * pURingBufferParseStateUnprotected()) it is resumed first.
  *
  * @param[in] pRingBuffer a pointer to the ring buffer, cannot be NULL.
  * @param handle          a read handle, as originally returned by
@@ -473,6 +641,32 @@ size_t uRingBufferStatReadLossHandle(uRingBuffer_t *pRingBuffer,
 size_t uRingBufferParseHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
                               U_RING_BUFFER_PARSER_f *pParserList, void *pUserParam);
 
+/** As uRingBufferParseHandle() but for a set of parsers where every
+ * message that any of them recognises begins with one of a small
+ * number of start bytes (e.g. 0xB5, '$' and 0xD3 for UBX, NMEA and
+ * RTCM); where the parsers find nothing, rather than moving on by one
+ * byte and running all of the parsers again, the search jumps
+ * straight to the next start byte, which is much quicker over data
+ * that is garbage or of no interest.
+ *
+ * @param[in] pRingBuffer  a pointer to the ring buffer, cannot be NULL.
+ * @param handle           a read handle, as originally returned by
+ *                         uRingBufferTakeReadHandle().
+ * @param[in] pParserList  a pointer to a list of parsers, terminated by
+ *                         a NULL pointer.
+ * @param[in] pStartBytes  the bytes that a message may begin with; if
+ *                         this is NULL this function behaves exactly
+ *                         as uRingBufferParseHandle().
+ * @param numStartBytes    the number of bytes at pStartBytes.
+ * @param[in] pUserParam   a user parameter to pass to each parser in the list.
+ * @return                 the number of bytes lost from the given
+ *                         read handle.
+ */
+size_t uRingBufferParseHandleSync(uRingBuffer_t *pRingBuffer, int32_t handle,
+                                  U_RING_BUFFER_PARSER_f *pParserList,
+                                  const char *pStartBytes, size_t numStartBytes,
+                                  void *pUserParam);
+
 /** Get a byte from the ring buffer while in a parser function.
  *
  * IMPORTANT: unlike all of the other ring-buffer functions, this function
@@ -486,6 +680,31 @@ size_t uRingBufferParseHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
  */
 bool uRingBufferGetByteUnprotected(uParseHandle_t parseHandle, void *p);
 
+/** Get direct access to as many of the following bytes as are
+ * contiguous in the linear buffer of the ring buffer, up to a
+ * maximum, while in a parser function; the bytes are consumed
+ * by the parser exactly as if they had been fetched with
+ * uRingBufferGetByteUnprotected().  Where the data wraps around
+ * the end of the linear buffer a second call will return the
+ * bytes from the start of it.  This is useful where a parser has
+ * a block of bytes to deal with as a whole, e.g. to CRC them.
+ *
+ * IMPORTANT: unlike all of the other ring-buffer functions, this function
+ * is NOT thread-safe, it is ONLY intended to be used from within a
+ * U_RING_BUFFER_PARSER_f function that will be called by uRingBufferParseHandle()
+ * (which adds thread-safety).  The returned pointer must not be used
+ * once the parser function has returned.
+ *
+ * @param parseHandle     the parser handle used to access the ring buffer.
+ * @param[out] ppData     a place to put a pointer to the bytes; cannot
+ *                        be NULL.
+ * @param maxLength       the maximum number of bytes to get.
+ * @return                the number of bytes at *ppData, zero if there
+ *                        is no more data.
+ */
+size_t uRingBufferGetSpanUnprotected(uParseHandle_t parseHandle,
+                                     const char **ppData, size_t maxLength);
+
 /** Number of bytes in the ring buffer while in a parser function.
  *
  * IMPORTANT: unlike all of the other ring-buffer functions, this function
@@ -510,6 +729,41 @@ size_t uRingBufferBytesAvailableUnprotected(uParseHandle_t parseHandle);
  */
 size_t uRingBufferBytesDiscardUnprotected(uParseHandle_t parseHandle);
 
+/** Get the state that a parser may keep between calls to
+ * uRingBufferParseHandle() so that, when a message is only partly
+ * in the ring buffer, the bytes already looked at need not be
+ * looked at again once the rest of the message has arrived.
+ *
+ * A parser which calls this function and then returns
+ * #U_ERROR_COMMON_TIMEOUT has its state kept for the read handle;
+ * the next time uRingBufferParseHandle() is called for that read
+ * handle, provided nothing has been read from it in the meantime
+ * other than the bytes returned as lost by uRingBufferParseHandle(),
+ * that parser is called first, with uRingBufferGetByteUnprotected()
+ * carrying on from the byte after the last one it got and with
+ * *pResume set to true; it should then carry on from the values it
+ * left in the state.  If the parser instead returns
+ * #U_ERROR_COMMON_NOT_FOUND the state is dropped and all of the
+ * parsers are run from the start of the data as normal.
+ *
+ * IMPORTANT: unlike all of the other ring-buffer functions, this function
+ * is NOT thread-safe, it is ONLY intended to be used from within a
+ * U_RING_BUFFER_PARSER_f function that will be called by uRingBufferParseHandle()
+ * (which adds thread-safety).
+ *
+ * @param parseHandle     the parser handle used to access the ring buffer.
+ * @param[out] pResume    a place to put true if the parser is being
+ *                        resumed, else false; cannot be NULL.
+ * @return                a pointer to #U_RING_BUFFER_PARSE_STATE_NUM_VALUES
+ *                        uint32_t values for the parser to use, or NULL
+ *                        if the ring buffer has no storage for parser
+ *                        state (it was not created with
+ *                        uRingBufferCreateWithReadHandle()), in which
+ *                        case the parser must be able to work without it.
+ */
+uint32_t *pURingBufferParseStateUnprotected(uParseHandle_t parseHandle,
+                                            bool *pResume);
+
 #ifdef __cplusplus
 }
 #endif
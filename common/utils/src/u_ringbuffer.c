@@ -34,7 +34,7 @@
 #include "stdio.h"    // snprintf()
 
 #include "u_cfg_sw.h"
-#include "u_compiler.h" // For U_INLINE
+#include "u_compiler.h" // For U_INLINE and U_ATOMIC_XXX()
 
 #include "u_error_common.h"
 #include "u_assert.h"
@@ -60,6 +60,20 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** The state a parser may keep for a read pointer between calls
+ * to uRingBufferParseHandle().
+ */
+typedef struct {
+    U_RING_BUFFER_PARSER_f pParser; /**< the parser that kept the state,
+                                         NULL if there is none. */
+    const char *pStart;             /**< where the partial message starts:
+                                         the state is only valid while the
+                                         read pointer is here. */
+    size_t bytesParsed;             /**< the number of bytes of the partial
+                                         message the parser has been through. */
+    uint32_t value[U_RING_BUFFER_PARSE_STATE_NUM_VALUES];
+} uRingBufferParseState_t;
+
 /** Parsing context.
  */
 typedef struct {
@@ -68,6 +82,9 @@ typedef struct {
     size_t bytesAvailable;
     size_t bytesParsed;
     size_t bytesDiscard;
+    uRingBufferParseState_t *pState; /**< NULL if there is no storage for state. */
+    bool resume;                     /**< true if the parser is being resumed. */
+    bool stateUsed;                  /**< true if the parser asked for pState. */
 } uRingBufferParseContext_t;
 
 /* ----------------------------------------------------------------
@@ -118,6 +135,67 @@ static U_INLINE const char *pPtrOffset(const char *pData, size_t offset,
     return pData;
 }
 
+// Return how many of the given number of bytes starting at pData
+// are contiguous, i.e. lie before the end of the linear buffer.
+static U_INLINE size_t spanLength(const char *pData, size_t length,
+                                  const char *pBuffer, size_t bufferSize)
+{
+    size_t span = (pBuffer + bufferSize) - pData;
+
+    if (span > length) {
+        span = length;
+    }
+
+    return span;
+}
+
+// Forget any parser state kept for the given read pointer if the
+// read pointer has moved from where the partial message started;
+// the ring buffer's mutex should be locked before this is called.
+static void parseStateCheck(uRingBuffer_t *pRingBuffer, size_t x)
+{
+    uRingBufferParseState_t *pState;
+
+    if (pRingBuffer->pParseState != NULL) {
+        pState = ((uRingBufferParseState_t *) pRingBuffer->pParseState) + x;
+        if (pState->pStart != pRingBuffer->pDataRead[x]) {
+            pState->pParser = NULL;
+        }
+    }
+}
+
+// Return the number of the given length of bytes from pData that
+// come before the first one which is any of the given start bytes,
+// or length if there is none.  At most two contiguous searches are
+// made, up to the end of the linear buffer and then on from the
+// start of it; for each of those, memchr() is run for each start
+// byte in turn, each run only going as far as the nearest start
+// byte found so far.
+static size_t startByteFind(const uRingBuffer_t *pRingBuffer, const char *pData,
+                            size_t length, const char *pStartBytes,
+                            size_t numStartBytes)
+{
+    size_t offset = 0;
+    size_t span;
+    const char *pFound = NULL;
+    const char *pTmp;
+
+    while ((pFound == NULL) && (offset < length)) {
+        span = spanLength(pData, length - offset, pRingBuffer->pBuffer, pRingBuffer->size);
+        for (size_t x = 0; (x < numStartBytes) && (span > 0); x++) {
+            pTmp = (const char *) memchr(pData, *(pStartBytes + x), span);
+            if (pTmp != NULL) {
+                pFound = pTmp;
+                span = pTmp - pData;
+            }
+        }
+        offset += span;
+        pData = pRingBuffer->pBuffer;
+    }
+
+    return offset;
+}
+
 // The ring buffer's mutex should be locked before this is called
 static void bufferReset(uRingBuffer_t *pRingBuffer)
 {
@@ -131,8 +209,16 @@ static void bufferReset(uRingBuffer_t *pRingBuffer)
         }
     }
     pRingBuffer->pDataWrite = pRingBuffer->pBuffer;
+    // Any reservation has gone
+    pRingBuffer->writeReservedBytes = 0;
     // The default handle-less read pointer can always be set
     pRingBuffer->pDataRead[0] = pRingBuffer->pDataWrite;
+    if (pRingBuffer->pParseState != NULL) {
+        // Any partial message has gone
+        for (size_t x = 0; x < pRingBuffer->maxNumReadPointers; x++) {
+            ((uRingBufferParseState_t *) pRingBuffer->pParseState)[x].pParser = NULL;
+        }
+    }
 }
 
 static int32_t createCommon(uRingBuffer_t *pRingBuffer, char *pLinearBuffer, size_t size)
@@ -149,6 +235,7 @@ static size_t read(uRingBuffer_t *pRingBuffer, int32_t handle, char *pData,
 {
     size_t bytesRead = 0;
     size_t available;
+    size_t span;
     const char *pSource;
 
     if ((handle >= 0) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
@@ -161,25 +248,31 @@ static size_t read(uRingBuffer_t *pRingBuffer, int32_t handle, char *pData,
             length = available;
         }
 
-        while (bytesRead < length) {
-            if (pData != NULL) {
-                *pData = *pSource;
-                pData++;
+        // At most two copies: up to the end of the linear
+        // buffer and then on from the start of it
+        if (pData != NULL) {
+            span = spanLength(pSource, length, pRingBuffer->pBuffer, pRingBuffer->size);
+            memcpy(pData, pSource, span);
+            if (span < length) {
+                memcpy(pData + span, pRingBuffer->pBuffer, length - span);
             }
-            pSource = pPtrInc(pSource, pRingBuffer->pBuffer, pRingBuffer->size);
-            bytesRead++;
         }
+        pSource = pPtrOffset(pSource, length, pRingBuffer->pBuffer, pRingBuffer->size);
+        bytesRead = length;
         if (destructive) {
             pRingBuffer->pDataRead[handle] = pSource;
+            parseStateCheck(pRingBuffer, handle);
         }
     }
 
     return bytesRead;
 }
 
-// The ring buffer's mutex should be locked before this is called
-static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
-                size_t length, bool destructive)
+// Make room for length bytes at the write pointer, throwing data
+// away from read pointers where that is permitted; the ring
+// buffer's mutex should be locked before this is called.
+static bool makeRoom(uRingBuffer_t *pRingBuffer, size_t length,
+                     bool destructive)
 {
     bool dataFitsInBuffer = true;
     size_t lost;
@@ -214,14 +307,100 @@ static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
         }
     }
 
+    return dataFitsInBuffer;
+}
+
+// The ring buffer's mutex should be locked before this is called
+static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
+                size_t length, bool destructive)
+{
+    bool dataFitsInBuffer = false;
+    size_t span;
+
+    // Can't write while someone else has space reserved
+    if (pRingBuffer->writeReservedBytes == 0) {
+        dataFitsInBuffer = makeRoom(pRingBuffer, length, destructive);
+    }
+
     if (dataFitsInBuffer) {
-        while (length > 0) {
-            *(pRingBuffer->pDataWrite) = *pData;
-            pRingBuffer->pDataWrite = (char *) pPtrInc(pRingBuffer->pDataWrite, pRingBuffer->pBuffer,
-                                                       pRingBuffer->size);
-            length--;
-            pData++;
+        // As for read(), at most two copies
+        span = spanLength(pRingBuffer->pDataWrite, length, pRingBuffer->pBuffer,
+                          pRingBuffer->size);
+        memcpy(pRingBuffer->pDataWrite, pData, span);
+        if (span < length) {
+            memcpy(pRingBuffer->pBuffer, pData + span, length - span);
+        }
+        pRingBuffer->pDataWrite = (char *) pPtrOffset(pRingBuffer->pDataWrite, length,
+                                                      pRingBuffer->pBuffer,
+                                                      pRingBuffer->size);
+    } else {
+        pRingBuffer->statAddLossBytes += length;
+    }
+
+    return dataFitsInBuffer;
+}
+
+// Return the amount of data between a read index and a write
+// index of an SPSC ring buffer.
+static U_INLINE size_t spscDiff(size_t readIndex, size_t writeIndex,
+                                size_t bufferSize)
+{
+    size_t size = writeIndex - readIndex;
+
+    if (writeIndex < readIndex) {
+        size = bufferSize - (readIndex - writeIndex);
+    }
+
+    return size;
+}
+
+// Move an index of an SPSC ring buffer on by offset, which must
+// be less than bufferSize.
+static U_INLINE size_t spscIndexOffset(size_t index, size_t offset,
+                                       size_t bufferSize)
+{
+    index += offset;
+    if (index >= bufferSize) {
+        index -= bufferSize;
+    }
+
+    return index;
+}
+
+// Get the amount of data in an SPSC ring buffer; may be called
+// by the producer or the consumer.
+static size_t spscDataSize(const uRingBuffer_t *pRingBuffer)
+{
+    return spscDiff(U_ATOMIC_GET_ACQUIRE(&pRingBuffer->spscReadIndex),
+                    U_ATOMIC_GET_ACQUIRE(&pRingBuffer->spscWriteIndex),
+                    pRingBuffer->size);
+}
+
+// Add data to an SPSC ring buffer: ONLY the producer may call this.
+// The data is copied in before the write index is released, so the
+// consumer cannot see the new write index before the data.
+static bool spscAdd(uRingBuffer_t *pRingBuffer, const char *pData,
+                    size_t length)
+{
+    bool dataFitsInBuffer = false;
+    size_t writeIndex = pRingBuffer->spscWriteIndex;
+    size_t used;
+    size_t span;
+
+    used = spscDiff(U_ATOMIC_GET_ACQUIRE(&pRingBuffer->spscReadIndex),
+                    writeIndex, pRingBuffer->size);
+    used++; // Account for the fact that we can't have the indexes overlap
+    if ((pRingBuffer->writeReservedBytes == 0) &&
+        (length < pRingBuffer->size) && (used + length <= pRingBuffer->size)) {
+        span = spanLength(pRingBuffer->pBuffer + writeIndex, length,
+                          pRingBuffer->pBuffer, pRingBuffer->size);
+        memcpy(pRingBuffer->pBuffer + writeIndex, pData, span);
+        if (span < length) {
+            memcpy(pRingBuffer->pBuffer, pData + span, length - span);
         }
+        U_ATOMIC_SET_RELEASE(&pRingBuffer->spscWriteIndex,
+                             spscIndexOffset(writeIndex, length, pRingBuffer->size));
+        dataFitsInBuffer = true;
     } else {
         pRingBuffer->statAddLossBytes += length;
     }
@@ -229,6 +408,44 @@ static bool add(uRingBuffer_t *pRingBuffer, const char *pData,
     return dataFitsInBuffer;
 }
 
+// Read data from an SPSC ring buffer: ONLY the consumer may call this.
+// The data is copied out before the read index is released, so the
+// producer cannot overwrite it while it is being copied.
+static size_t spscRead(uRingBuffer_t *pRingBuffer, char *pData,
+                       size_t length, size_t offset, bool destructive)
+{
+    size_t bytesRead = 0;
+    size_t readIndex = pRingBuffer->spscReadIndex;
+    size_t available;
+    size_t span;
+    const char *pSource;
+
+    available = spscDiff(readIndex, U_ATOMIC_GET_ACQUIRE(&pRingBuffer->spscWriteIndex),
+                         pRingBuffer->size);
+    if (offset < available) {
+        available -= offset;
+        if (length > available) {
+            length = available;
+        }
+        readIndex = spscIndexOffset(readIndex, offset, pRingBuffer->size);
+        if (pData != NULL) {
+            pSource = pRingBuffer->pBuffer + readIndex;
+            span = spanLength(pSource, length, pRingBuffer->pBuffer, pRingBuffer->size);
+            memcpy(pData, pSource, span);
+            if (span < length) {
+                memcpy(pData + span, pRingBuffer->pBuffer, length - span);
+            }
+        }
+        if (destructive) {
+            U_ATOMIC_SET_RELEASE(&pRingBuffer->spscReadIndex,
+                                 spscIndexOffset(readIndex, length, pRingBuffer->size));
+        }
+        bytesRead = length;
+    }
+
+    return bytesRead;
+}
+
 // This function does the ring buffer mutex locking itself.
 static size_t lock(uRingBuffer_t *pRingBuffer, int32_t handle, bool lockNotUnlock)
 {
@@ -253,49 +470,62 @@ static size_t lock(uRingBuffer_t *pRingBuffer, int32_t handle, bool lockNotUnloc
     return dataSize;
 }
 
-// This function does the ring buffer mutex locking itself.
-static size_t availableSize(const uRingBuffer_t *pRingBuffer, bool max)
+// Return the space available for adding data; the ring buffer's
+// mutex should be locked before this is called.
+static size_t availableSizeUnprotected(const uRingBuffer_t *pRingBuffer, bool max)
 {
-    size_t size = 0;
+    size_t size = pRingBuffer->size;
     size_t y = 0;
     bool foundADataReadPointer = false;
 
-    if (pRingBuffer->pBuffer != NULL) {
-
-        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
-
-        size = pRingBuffer->size;
-        for (size_t x = 0; x < pRingBuffer->maxNumReadPointers; x++) {
-            // If a read handle is required we ignore the data behind
-            // the "normal" read pointer as it's not possible to get
-            // at it
-            if ((pRingBuffer->pDataRead[x] != NULL) &&
-                ((x > 0) || !pRingBuffer->readHandleRequired)) {
-                // If we're doing max then we only take into account
-                // locked data buffer pointers and we ignore 0 since
-                // it is not lockable
-                if (!max || ((x > 0) && (pRingBuffer->dataReadLockBitmap & (1ULL << (x - 1))))) {
-                    y = pRingBuffer->size - ptrDiff(pRingBuffer->pDataRead[x], pRingBuffer->pDataWrite,
-                                                    pRingBuffer->size);
-                    if (y < size) {
-                        size = y;
-                    }
-                    foundADataReadPointer = true;
+    for (size_t x = 0; x < pRingBuffer->maxNumReadPointers; x++) {
+        // If a read handle is required we ignore the data behind
+        // the "normal" read pointer as it's not possible to get
+        // at it
+        if ((pRingBuffer->pDataRead[x] != NULL) &&
+            ((x > 0) || !pRingBuffer->readHandleRequired)) {
+            // If we're doing max then we only take into account
+            // locked data buffer pointers and we ignore 0 since
+            // it is not lockable
+            if (!max || ((x > 0) && (pRingBuffer->dataReadLockBitmap & (1ULL << (x - 1))))) {
+                y = pRingBuffer->size - ptrDiff(pRingBuffer->pDataRead[x], pRingBuffer->pDataWrite,
+                                                pRingBuffer->size);
+                if (y < size) {
+                    size = y;
                 }
+                foundADataReadPointer = true;
             }
         }
+    }
 
-        if (!max && !foundADataReadPointer) {
-            // If we didn't find a single data read pointer,
-            // and we're not doing max, report what is in the
-            // buffer anyway
-            size = pRingBuffer->size - ptrDiff(pRingBuffer->pBuffer, pRingBuffer->pDataWrite,
-                                               pRingBuffer->size);
-        }
-        if (size > 0) {
-            //  Must keep one to prevent pointer wrap
-            size--;
-        }
+    if (!max && !foundADataReadPointer) {
+        // If we didn't find a single data read pointer,
+        // and we're not doing max, report what is in the
+        // buffer anyway
+        size = pRingBuffer->size - ptrDiff(pRingBuffer->pBuffer, pRingBuffer->pDataWrite,
+                                           pRingBuffer->size);
+    }
+    if (size > 0) {
+        //  Must keep one to prevent pointer wrap
+        size--;
+    }
+
+    return size;
+}
+
+// This function does the ring buffer mutex locking itself.
+static size_t availableSize(const uRingBuffer_t *pRingBuffer, bool max)
+{
+    size_t size = 0;
+
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        // A forced add is no different to an add in this case
+        size = pRingBuffer->size - spscDataSize(pRingBuffer) - 1;
+    } else if (pRingBuffer->pBuffer != NULL) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+        size = availableSizeUnprotected(pRingBuffer, max);
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
     }
@@ -343,6 +573,132 @@ static void printPointer(const char *pTitle, const char *pBuffer, size_t bufferS
     uPortLog("\n");
 }
 
+// Do the work of uRingBufferParseHandle() and uRingBufferParseHandleSync().
+static size_t parseHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
+                          U_RING_BUFFER_PARSER_f *pParserList,
+                          const char *pStartBytes, size_t numStartBytes,
+                          void *pUserParam)
+{
+    int32_t errorCodeOrLength = U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if ((pRingBuffer->pBuffer != NULL) && !pRingBuffer->isSpsc) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+        if ((handle >= 0) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
+            (pRingBuffer->pDataRead[handle] != NULL)) {
+            const char *pOffset = pPtrOffset(pRingBuffer->pDataRead[handle], 0, pRingBuffer->pBuffer,
+                                             pRingBuffer->size);
+            size_t bytesAvailable = ptrDiff(pOffset, pRingBuffer->pDataWrite, pRingBuffer->size);
+            size_t bytesDiscard  = 0;
+            uRingBufferParseState_t *pState = NULL;
+            if (pRingBuffer->pParseState != NULL) {
+                pState = ((uRingBufferParseState_t *) pRingBuffer->pParseState) + handle;
+            }
+            errorCodeOrLength = U_ERROR_COMMON_TIMEOUT;
+            if ((pState != NULL) && (pState->pParser != NULL)) {
+                // A parser stopped part way through a message last
+                // time: if it is in the list, let it carry on from
+                // where it got to
+                U_RING_BUFFER_PARSER_f *pParser = pParserList;
+                while ((*pParser != NULL) && (*pParser != pState->pParser)) {
+                    pParser++;
+                }
+                if ((*pParser != NULL) && (pState->pStart == pOffset) &&
+                    (pState->bytesParsed <= bytesAvailable)) {
+                    uRingBufferParseContext_t ctx = {
+                        .pRingBuffer    = pRingBuffer,
+                        .pSource        = pPtrOffset(pOffset, pState->bytesParsed,
+                                                     pRingBuffer->pBuffer, pRingBuffer->size),
+                        .bytesAvailable = bytesAvailable - pState->bytesParsed,
+                        .bytesParsed    = pState->bytesParsed,
+                        .bytesDiscard   = 0,
+                        .pState         = pState,
+                        .resume         = true,
+                        .stateUsed      = false
+                    };
+                    errorCodeOrLength = (*pParser)(&ctx, pUserParam);
+                    if ((errorCodeOrLength == U_ERROR_COMMON_TIMEOUT) && ctx.stateUsed) {
+                        // Still not all there
+                        pState->bytesParsed = ctx.bytesParsed;
+                        bytesAvailable = 0;
+                    } else {
+                        pState->pParser = NULL;
+                        if (errorCodeOrLength == U_ERROR_COMMON_SUCCESS) {
+                            errorCodeOrLength = ctx.bytesParsed;
+                            bytesAvailable = 0;
+                        } else if (errorCodeOrLength != U_ERROR_COMMON_NOT_FOUND) {
+                            bytesAvailable = 0;
+                        }
+                        // For U_ERROR_COMMON_NOT_FOUND fall through
+                        // to the normal search below
+                    }
+                } else {
+                    pState->pParser = NULL;
+                }
+            }
+            while (bytesAvailable) {
+                U_RING_BUFFER_PARSER_f *pParser = pParserList;
+                if (pStartBytes != NULL) {
+                    // No parser can begin on anything other than a
+                    // start byte, so skip straight to the next one
+                    size_t skip = startByteFind(pRingBuffer, pOffset, bytesAvailable,
+                                                pStartBytes, numStartBytes);
+                    pOffset = pPtrOffset(pOffset, skip, pRingBuffer->pBuffer, pRingBuffer->size);
+                    bytesDiscard += skip;
+                    bytesAvailable -= skip;
+                    if (bytesAvailable == 0) {
+                        break;
+                    }
+                }
+                // find the right protocol
+                errorCodeOrLength = U_ERROR_COMMON_NOT_FOUND;
+                while (*pParser) {
+                    uRingBufferParseContext_t ctx = {
+                        .pRingBuffer    = pRingBuffer,
+                        .pSource        = pOffset,
+                        .bytesAvailable = bytesAvailable,
+                        .bytesParsed    = 0,
+                        .bytesDiscard   = bytesDiscard,
+                        .pState         = pState,
+                        .resume         = false,
+                        .stateUsed      = false
+                    };
+                    errorCodeOrLength = (*pParser)(&ctx, pUserParam);
+                    if (errorCodeOrLength == U_ERROR_COMMON_SUCCESS) {
+                        errorCodeOrLength = ctx.bytesParsed;
+                    } else if ((errorCodeOrLength == U_ERROR_COMMON_TIMEOUT) && ctx.stateUsed) {
+                        // Keep the state so that the parser can carry
+                        // on from here when more data arrives; the bytes
+                        // discarded before pOffset will be returned, so
+                        // this is where the read pointer will be
+                        pState->pParser = *pParser;
+                        pState->pStart = pOffset;
+                        pState->bytesParsed = ctx.bytesParsed;
+                    }
+                    pParser ++;
+                    if (errorCodeOrLength != U_ERROR_COMMON_NOT_FOUND) {
+                        break;
+                    }
+                }
+                if (errorCodeOrLength != U_ERROR_COMMON_NOT_FOUND) {
+                    break;
+                }
+                pOffset = pPtrInc(pOffset, pRingBuffer->pBuffer, pRingBuffer->size);
+                bytesDiscard ++;
+                bytesAvailable --;
+            }
+            if (bytesDiscard > 0) {
+                errorCodeOrLength = bytesDiscard;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+    }
+
+    return errorCodeOrLength;
+}
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: DEBUG
  * -------------------------------------------------------------- */
@@ -360,6 +716,14 @@ void uRingBufferDump(uRingBuffer_t *pRingBuffer)
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
         printHex(pRingBuffer->pBuffer, pRingBuffer->size);
+        if (pRingBuffer->isSpsc) {
+            // The read/write pointers are not used, point them
+            // at the indexes just for the print
+            pRingBuffer->pDataRead[0] = pRingBuffer->pBuffer +
+                                        U_ATOMIC_GET_ACQUIRE(&pRingBuffer->spscReadIndex);
+            pRingBuffer->pDataWrite = pRingBuffer->pBuffer +
+                                      U_ATOMIC_GET_ACQUIRE(&pRingBuffer->spscWriteIndex);
+        }
         for (size_t x = 0; x < pRingBuffer->maxNumReadPointers; x++) {
             if (pRingBuffer->pDataRead[x] != NULL) {
                 snprintf(buffer1, sizeof(buffer1), "%02d", (int)x);
@@ -398,6 +762,20 @@ int32_t uRingBufferCreate(uRingBuffer_t *pRingBuffer, char *pLinearBuffer, size_
     return createCommon(pRingBuffer, pLinearBuffer, size);
 }
 
+int32_t uRingBufferCreateSpsc(uRingBuffer_t *pRingBuffer, char *pLinearBuffer,
+                              size_t size)
+{
+    int32_t errorCode = uRingBufferCreate(pRingBuffer, pLinearBuffer, size);
+
+    if (errorCode == 0) {
+        // The mutex is still created, it is just not used for
+        // adding/reading data
+        pRingBuffer->isSpsc = true;
+    }
+
+    return errorCode;
+}
+
 void uRingBufferDelete(uRingBuffer_t *pRingBuffer)
 {
     if ((pRingBuffer != NULL) && (pRingBuffer->mutex != NULL)) {
@@ -406,6 +784,8 @@ void uRingBufferDelete(uRingBuffer_t *pRingBuffer)
             pRingBuffer->pDataRead = NULL;
             uPortFree(pRingBuffer->statReadLossBytes);
             pRingBuffer->statReadLossBytes = NULL;
+            uPortFree(pRingBuffer->pParseState);
+            pRingBuffer->pParseState = NULL;
         }
         pRingBuffer->maxNumReadPointers = 0;
         uPortMutexDelete((uPortMutexHandle_t) pRingBuffer->mutex);
@@ -418,7 +798,9 @@ bool uRingBufferAdd(uRingBuffer_t *pRingBuffer, const char *pData, size_t length
 {
     bool dataFitsInBuffer = false;
 
-    if (pRingBuffer->pBuffer != NULL) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        dataFitsInBuffer = spscAdd(pRingBuffer, pData, length);
+    } else if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
@@ -434,7 +816,9 @@ bool uRingBufferForceAdd(uRingBuffer_t *pRingBuffer, const char *pData, size_t l
 {
     bool dataFitsInBuffer = false;
 
-    if (pRingBuffer->pBuffer != NULL) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        dataFitsInBuffer = spscAdd(pRingBuffer, pData, length);
+    } else if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
@@ -450,7 +834,9 @@ size_t uRingBufferRead(uRingBuffer_t *pRingBuffer, char *pData, size_t length)
 {
     size_t bytesRead = 0;
 
-    if ((pRingBuffer->pBuffer != NULL) && !pRingBuffer->readHandleRequired) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        bytesRead = spscRead(pRingBuffer, pData, length, 0, true);
+    } else if ((pRingBuffer->pBuffer != NULL) && !pRingBuffer->readHandleRequired) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
@@ -467,7 +853,9 @@ size_t uRingBufferPeek(uRingBuffer_t *pRingBuffer, char *pData, size_t length,
 {
     size_t bytesRead = 0;
 
-    if ((pRingBuffer->pBuffer != NULL) && !pRingBuffer->readHandleRequired) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        bytesRead = spscRead(pRingBuffer, pData, length, offset, false);
+    } else if ((pRingBuffer->pBuffer != NULL) && !pRingBuffer->readHandleRequired) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
@@ -483,7 +871,9 @@ size_t uRingBufferDataSize(const uRingBuffer_t *pRingBuffer)
 {
     size_t dataSize = 0;
 
-    if (pRingBuffer->pBuffer != NULL) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        dataSize = spscDataSize(pRingBuffer);
+    } else if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
@@ -505,11 +895,15 @@ size_t uRingBufferAvailableSize(const uRingBuffer_t *pRingBuffer)
 
 void uRingBufferFlush(uRingBuffer_t *pRingBuffer)
 {
-    if (pRingBuffer->pBuffer != NULL) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        U_ATOMIC_SET_RELEASE(&pRingBuffer->spscReadIndex,
+                             U_ATOMIC_GET_ACQUIRE(&pRingBuffer->spscWriteIndex));
+    } else if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
         pRingBuffer->pDataRead[0] = pRingBuffer->pDataWrite;
+        parseStateCheck(pRingBuffer, 0);
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
     }
@@ -520,8 +914,21 @@ void uRingBufferFlushValue(uRingBuffer_t *pRingBuffer, char value, size_t length
     size_t bytesRead = 0;
     size_t dataSize;
     const char *pData;
+    size_t readIndex;
 
-    if (pRingBuffer->pBuffer != NULL) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        readIndex = pRingBuffer->spscReadIndex;
+        dataSize = spscDataSize(pRingBuffer);
+        if (dataSize >= length) {
+            while ((bytesRead < dataSize) && (*(pRingBuffer->pBuffer + readIndex) == value)) {
+                readIndex = spscIndexOffset(readIndex, 1, pRingBuffer->size);
+                bytesRead++;
+            }
+            if (bytesRead >= length) {
+                U_ATOMIC_SET_RELEASE(&pRingBuffer->spscReadIndex, readIndex);
+            }
+        }
+    } else if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
@@ -534,6 +941,7 @@ void uRingBufferFlushValue(uRingBuffer_t *pRingBuffer, char value, size_t length
             }
             if (bytesRead >= length) {
                 pRingBuffer->pDataRead[0] = pData;
+                parseStateCheck(pRingBuffer, 0);
             }
         }
 
@@ -543,7 +951,10 @@ void uRingBufferFlushValue(uRingBuffer_t *pRingBuffer, char value, size_t length
 
 void uRingBufferReset(uRingBuffer_t *pRingBuffer)
 {
-    if (pRingBuffer->pBuffer != NULL) {
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        // Only the consumer may call this so all it can do is flush
+        uRingBufferFlush(pRingBuffer);
+    } else if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
@@ -598,13 +1009,16 @@ int32_t uRingBufferCreateWithReadHandle(uRingBuffer_t *pRingBuffer, char *pLinea
     maxNumReadHandles++; // Add one more for the non-handled read
     pRingBuffer->pDataRead = (const char **) pUPortMalloc((maxNumReadHandles) * sizeof(const char *));
     pRingBuffer->statReadLossBytes = (size_t *) pUPortMalloc((maxNumReadHandles) * sizeof(size_t));
+    pRingBuffer->pParseState = pUPortMalloc((maxNumReadHandles) * sizeof(uRingBufferParseState_t));
     if ((pRingBuffer->pDataRead != NULL) && (pRingBuffer->statReadLossBytes != NULL) &&
+        (pRingBuffer->pParseState != NULL) &&
         (maxNumReadHandles < (sizeof(pRingBuffer->dataReadLockBitmap) * 8))) {
         pRingBuffer->isMalloced = true;
         pRingBuffer->maxNumReadPointers = maxNumReadHandles;
         for (size_t x = 0; x < pRingBuffer->maxNumReadPointers; x++) {
             pRingBuffer->pDataRead[x] = NULL;
             pRingBuffer->statReadLossBytes[x] = 0;
+            ((uRingBufferParseState_t *) pRingBuffer->pParseState)[x].pParser = NULL;
         }
         errorCode = createCommon(pRingBuffer, pLinearBuffer, size);
     }
@@ -613,6 +1027,8 @@ int32_t uRingBufferCreateWithReadHandle(uRingBuffer_t *pRingBuffer, char *pLinea
         pRingBuffer->pDataRead = NULL;
         uPortFree(pRingBuffer->statReadLossBytes);
         pRingBuffer->statReadLossBytes = NULL;
+        uPortFree(pRingBuffer->pParseState);
+        pRingBuffer->pParseState = NULL;
         pRingBuffer->maxNumReadPointers = 0;
     }
 
@@ -630,6 +1046,7 @@ void uRingBufferSetReadRequiresHandle(uRingBuffer_t *pRingBuffer, bool onNotOff)
             // it off, set the non-handled read
             // pointer so that it gets sensible data
             pRingBuffer->pDataRead[0] = pRingBuffer->pDataWrite;
+            parseStateCheck(pRingBuffer, 0);
         }
         pRingBuffer->readHandleRequired = onNotOff;
 
@@ -658,6 +1075,9 @@ int32_t uRingBufferTakeReadHandle(uRingBuffer_t *pRingBuffer)
             if (pRingBuffer->pDataRead[x] == NULL) {
                 pRingBuffer->pDataRead[x] = pRingBuffer->pDataWrite;
                 pRingBuffer->statReadLossBytes[x] = 0;
+                if (pRingBuffer->pParseState != NULL) {
+                    ((uRingBufferParseState_t *) pRingBuffer->pParseState)[x].pParser = NULL;
+                }
                 readHandle = x;
             }
         }
@@ -782,6 +1202,7 @@ void uRingBufferFlushHandle(uRingBuffer_t *pRingBuffer, int32_t handle)
         if ((handle >= 1) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
             (pRingBuffer->pDataRead[handle] != NULL)) {
             pRingBuffer->pDataRead[handle] = pRingBuffer->pDataWrite;
+            parseStateCheck(pRingBuffer, handle);
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
@@ -809,62 +1230,195 @@ size_t uRingBufferStatReadLossHandle(uRingBuffer_t *pRingBuffer,
 }
 
 /* ----------------------------------------------------------------
- * FUNCTIONS: PARSER
+ * PUBLIC FUNCTIONS: ZERO-COPY
  * -------------------------------------------------------------- */
 
-size_t uRingBufferParseHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
-                              U_RING_BUFFER_PARSER_f *pParserList, void *pUserParam)
+size_t uRingBufferPeekSpans(uRingBuffer_t *pRingBuffer, int32_t handle,
+                            const char **ppData1, size_t *pLength1,
+                            const char **ppData2, size_t *pLength2)
 {
-    int32_t errorCodeOrLength = U_ERROR_COMMON_INVALID_PARAMETER;
-
-    if (pRingBuffer->pBuffer != NULL) {
+    size_t dataSize = 0;
+    const char *pData1 = NULL;
+    size_t length1 = 0;
+    size_t length2 = 0;
+
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        if (handle == 0) {
+            pData1 = pRingBuffer->pBuffer + pRingBuffer->spscReadIndex;
+            dataSize = spscDataSize(pRingBuffer);
+            length1 = spanLength(pData1, dataSize, pRingBuffer->pBuffer,
+                                 pRingBuffer->size);
+            length2 = dataSize - length1;
+        }
+    } else if (pRingBuffer->pBuffer != NULL) {
 
         U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
 
         if ((handle >= 0) && (handle < (int32_t) pRingBuffer->maxNumReadPointers) &&
-            (pRingBuffer->pDataRead[handle] != NULL)) {
-            const char *pOffset = pPtrOffset(pRingBuffer->pDataRead[handle], 0, pRingBuffer->pBuffer,
-                                             pRingBuffer->size);
-            size_t bytesAvailable = ptrDiff(pOffset, pRingBuffer->pDataWrite, pRingBuffer->size);
-            size_t bytesDiscard  = 0;
-            errorCodeOrLength = U_ERROR_COMMON_TIMEOUT;
-            while (bytesAvailable) {
-                U_RING_BUFFER_PARSER_f *pParser = pParserList;
-                // find the right protocol
-                errorCodeOrLength = U_ERROR_COMMON_NOT_FOUND;
-                while (*pParser) {
-                    uRingBufferParseContext_t ctx = {
-                        .pRingBuffer    = pRingBuffer,
-                        .pSource        = pOffset,
-                        .bytesAvailable = bytesAvailable,
-                        .bytesParsed    = 0,
-                        .bytesDiscard   = bytesDiscard
-                    };
-                    errorCodeOrLength = (*pParser)(&ctx, pUserParam);
-                    pParser ++;
-                    if (errorCodeOrLength == U_ERROR_COMMON_SUCCESS) {
-                        errorCodeOrLength = ctx.bytesParsed;
-                    }
-                    if (errorCodeOrLength != U_ERROR_COMMON_NOT_FOUND) {
-                        break;
-                    }
-                }
-                if (errorCodeOrLength != U_ERROR_COMMON_NOT_FOUND) {
-                    break;
-                }
-                pOffset = pPtrInc(pOffset, pRingBuffer->pBuffer, pRingBuffer->size);
-                bytesDiscard ++;
-                bytesAvailable --;
+            (pRingBuffer->pDataRead[handle] != NULL) &&
+            ((handle > 0) || !pRingBuffer->readHandleRequired)) {
+            pData1 = pRingBuffer->pDataRead[handle];
+            dataSize = ptrDiff(pData1, pRingBuffer->pDataWrite, pRingBuffer->size);
+            length1 = spanLength(pData1, dataSize, pRingBuffer->pBuffer,
+                                 pRingBuffer->size);
+            length2 = dataSize - length1;
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+    }
+
+    if (ppData1 != NULL) {
+        *ppData1 = (length1 > 0) ? pData1 : NULL;
+    }
+    if (pLength1 != NULL) {
+        *pLength1 = length1;
+    }
+    if (ppData2 != NULL) {
+        *ppData2 = (length2 > 0) ? pRingBuffer->pBuffer : NULL;
+    }
+    if (pLength2 != NULL) {
+        *pLength2 = length2;
+    }
+
+    return dataSize;
+}
+
+size_t uRingBufferConsume(uRingBuffer_t *pRingBuffer, int32_t handle,
+                          size_t length)
+{
+    size_t bytesConsumed = 0;
+
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        if (handle == 0) {
+            bytesConsumed = spscRead(pRingBuffer, NULL, length, 0, true);
+        }
+    } else if (pRingBuffer->pBuffer != NULL) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+        if ((handle > 0) || !pRingBuffer->readHandleRequired) {
+            bytesConsumed = read(pRingBuffer, handle, NULL, length, 0, true);
+        }
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+    }
+
+    return bytesConsumed;
+}
+
+size_t uRingBufferReserveSpans(uRingBuffer_t *pRingBuffer, size_t length,
+                               bool force, char **ppData1, size_t *pLength1,
+                               char **ppData2, size_t *pLength2)
+{
+    char *pData1 = NULL;
+    size_t length1 = 0;
+    size_t space = 0;
+
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        // Only the producer may call this, no forcing possible
+        if (pRingBuffer->writeReservedBytes == 0) {
+            pData1 = pRingBuffer->pBuffer + pRingBuffer->spscWriteIndex;
+            space = pRingBuffer->size - spscDataSize(pRingBuffer) - 1;
+            if (space > length) {
+                space = length;
             }
-            if (bytesDiscard > 0) {
-                errorCodeOrLength = bytesDiscard;
+            pRingBuffer->writeReservedBytes = space;
+        }
+    } else if (pRingBuffer->pBuffer != NULL) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+        if (pRingBuffer->writeReservedBytes == 0) {
+            pData1 = pRingBuffer->pDataWrite;
+            space = availableSizeUnprotected(pRingBuffer, force);
+            if (space > length) {
+                space = length;
             }
+            // Throw away whatever has to go now, so that nothing
+            // can be read from the space while it is being written
+            if ((space > 0) && !makeRoom(pRingBuffer, space, force)) {
+                space = 0;
+            }
+            pRingBuffer->writeReservedBytes = space;
         }
 
         U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
     }
 
-    return errorCodeOrLength;
+    if (space > 0) {
+        length1 = spanLength(pData1, space, pRingBuffer->pBuffer,
+                             pRingBuffer->size);
+    }
+
+    if (ppData1 != NULL) {
+        *ppData1 = (length1 > 0) ? pData1 : NULL;
+    }
+    if (pLength1 != NULL) {
+        *pLength1 = length1;
+    }
+    if (ppData2 != NULL) {
+        *ppData2 = (space > length1) ? pRingBuffer->pBuffer : NULL;
+    }
+    if (pLength2 != NULL) {
+        *pLength2 = space - length1;
+    }
+
+    return space;
+}
+
+size_t uRingBufferCommit(uRingBuffer_t *pRingBuffer, size_t length)
+{
+    if ((pRingBuffer->pBuffer != NULL) && pRingBuffer->isSpsc) {
+        if (length > pRingBuffer->writeReservedBytes) {
+            length = pRingBuffer->writeReservedBytes;
+        }
+        pRingBuffer->writeReservedBytes = 0;
+        // The data is already in, just release the write index
+        U_ATOMIC_SET_RELEASE(&pRingBuffer->spscWriteIndex,
+                             spscIndexOffset(pRingBuffer->spscWriteIndex, length,
+                                             pRingBuffer->size));
+    } else if (pRingBuffer->pBuffer != NULL) {
+
+        U_PORT_MUTEX_LOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+
+        if (length > pRingBuffer->writeReservedBytes) {
+            length = pRingBuffer->writeReservedBytes;
+        }
+        pRingBuffer->writeReservedBytes = 0;
+        // Readers can only have moved on since the reservation
+        // was made so the space is still ours
+        pRingBuffer->pDataWrite = (char *) pPtrOffset(pRingBuffer->pDataWrite, length,
+                                                      pRingBuffer->pBuffer,
+                                                      pRingBuffer->size);
+
+        U_PORT_MUTEX_UNLOCK((uPortMutexHandle_t) pRingBuffer->mutex);
+    } else {
+        length = 0;
+    }
+
+    return length;
+}
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: PARSER
+ * -------------------------------------------------------------- */
+
+size_t uRingBufferParseHandle(uRingBuffer_t *pRingBuffer, int32_t handle,
+                              U_RING_BUFFER_PARSER_f *pParserList, void *pUserParam)
+{
+    return parseHandle(pRingBuffer, handle, pParserList, NULL, 0, pUserParam);
+}
+
+size_t uRingBufferParseHandleSync(uRingBuffer_t *pRingBuffer, int32_t handle,
+                                  U_RING_BUFFER_PARSER_f *pParserList,
+                                  const char *pStartBytes, size_t numStartBytes,
+                                  void *pUserParam)
+{
+    if (numStartBytes == 0) {
+        pStartBytes = NULL;
+    }
+    return parseHandle(pRingBuffer, handle, pParserList, pStartBytes,
+                       numStartBytes, pUserParam);
 }
 
 bool uRingBufferGetByteUnprotected(uParseHandle_t parseHandle, void *p)
@@ -881,6 +1435,29 @@ bool uRingBufferGetByteUnprotected(uParseHandle_t parseHandle, void *p)
     return true;
 }
 
+size_t uRingBufferGetSpanUnprotected(uParseHandle_t parseHandle,
+                                     const char **ppData, size_t maxLength)
+{
+    uRingBufferParseContext_t *pCtx = (uRingBufferParseContext_t *)parseHandle;
+    const char *pEnd = pCtx->pRingBuffer->pBuffer + pCtx->pRingBuffer->size;
+    size_t length = pCtx->bytesAvailable;
+
+    // Stop at the end of the linear buffer
+    if (length > (size_t) (pEnd - pCtx->pSource)) {
+        length = pEnd - pCtx->pSource;
+    }
+    if (length > maxLength) {
+        length = maxLength;
+    }
+    *ppData = pCtx->pSource;
+    pCtx->pSource = pPtrOffset(pCtx->pSource, length, pCtx->pRingBuffer->pBuffer,
+                               pCtx->pRingBuffer->size);
+    pCtx->bytesParsed += length;
+    pCtx->bytesAvailable -= length;
+
+    return length;
+}
+
 size_t uRingBufferBytesAvailableUnprotected(uParseHandle_t parseHandle)
 {
     uRingBufferParseContext_t *pCtx = (uRingBufferParseContext_t *)parseHandle;
@@ -893,4 +1470,20 @@ size_t uRingBufferBytesDiscardUnprotected(uParseHandle_t parseHandle)
     return pCtx->bytesDiscard;
 }
 
+uint32_t *pURingBufferParseStateUnprotected(uParseHandle_t parseHandle,
+                                            bool *pResume)
+{
+    uRingBufferParseContext_t *pCtx = (uRingBufferParseContext_t *)parseHandle;
+    uint32_t *pValue = NULL;
+
+    *pResume = false;
+    if (pCtx->pState != NULL) {
+        pValue = pCtx->pState->value;
+        *pResume = pCtx->resume;
+        pCtx->stateUsed = true;
+    }
+
+    return pValue;
+}
+
 // End of file
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Test for the CRC API
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // strlen()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port_os.h"
+#include "u_port_debug.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_crc.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX "U_CRC_TEST: "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_UTILS_TEST_CRC_BUFFER_SIZE
+/** The size of the buffer of data to CRC when comparing against
+ * the bit-wise calculation.
+ */
+# define U_UTILS_TEST_CRC_BUFFER_SIZE 256
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** Data to CRC.
+ */
+static char gBuffer[U_UTILS_TEST_CRC_BUFFER_SIZE];
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Bit-at-a-time CRC-24Q, to check the table-driven version against.
+static uint32_t crc24QBitwise(const char *pData, size_t size)
+{
+    uint32_t crc = 0;
+
+    for (size_t x = 0; x < size; x++) {
+        crc ^= ((uint32_t) (uint8_t) * (pData + x)) << 16;
+        for (size_t y = 0; y < 8; y++) {
+            crc <<= 1;
+            if (crc & 0x01000000U) {
+                crc ^= 0x01864CFBU;
+            }
+        }
+    }
+
+    return crc;
+}
+
+// Bit-at-a-time MSB-first CRC-32, to check the table-driven
+// version against.
+static uint32_t crc32Bitwise(const char *pData, size_t size)
+{
+    uint32_t crc = 0xFFFFFFFFU;
+
+    for (size_t x = 0; x < size; x++) {
+        crc ^= ((uint32_t) (uint8_t) * (pData + x)) << 24;
+        for (size_t y = 0; y < 8; y++) {
+            if (crc & 0x80000000U) {
+                crc = (crc << 1) ^ 0x04C11DB7U;
+            } else {
+                crc <<= 1;
+            }
+        }
+    }
+
+    return crc ^ 0xFFFFFFFFU;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: TESTS
+ * -------------------------------------------------------------- */
+
+/** Test the CRC functions against known answers and against a
+ * bit-at-a-time calculation, for all lengths and alignments and
+ * with the data split in two.
+ */
+U_PORT_TEST_FUNCTION("[crc]", "crcBasic")
+{
+    const char *pCheck = "123456789";
+    uint32_t x = 0x12345678;
+    uint32_t crc24Q;
+    uint32_t crc32;
+
+    U_TEST_PRINT_LINE("testing CRC, %d slices.", U_CRC_SLICES);
+
+    // The standard check values
+    U_PORT_TEST_ASSERT(uCrc24Q(pCheck, strlen(pCheck)) == 0x00CDE703U);
+    U_PORT_TEST_ASSERT(uCrc32(pCheck, strlen(pCheck)) == 0xFC891918U);
+    U_PORT_TEST_ASSERT(uCrc24Q(pCheck, 0) == 0);
+    U_PORT_TEST_ASSERT(uCrc32(pCheck, 0) == 0);
+
+    for (size_t y = 0; y < sizeof(gBuffer); y++) {
+        // xorshift
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        gBuffer[y] = (char) x;
+    }
+
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t size = 0; size <= sizeof(gBuffer) - offset; size += 1 + (size >> 4)) {
+            crc24Q = crc24QBitwise(gBuffer + offset, size);
+            crc32 = crc32Bitwise(gBuffer + offset, size);
+            U_PORT_TEST_ASSERT(uCrc24Q(gBuffer + offset, size) == crc24Q);
+            U_PORT_TEST_ASSERT(uCrc32(gBuffer + offset, size) == crc32);
+            for (size_t split = 0; split <= size; split += 1 + (split >> 2)) {
+                U_PORT_TEST_ASSERT(uCrc24QUpdate(uCrc24Q(gBuffer + offset, split),
+                                                 gBuffer + offset + split,
+                                                 size - split) == crc24Q);
+                U_PORT_TEST_ASSERT(uCrc32Update(uCrc32(gBuffer + offset, split),
+                                                gBuffer + offset + split,
+                                                size - split) == crc32);
+            }
+        }
+    }
+
+    // Printed for information: asserting happens in the postamble
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+}
+
+// End of file
@@ -35,6 +35,7 @@
 
 #include "u_cfg_sw.h"
 #include "u_cfg_app_platform_specific.h"
+#include "u_cfg_os_platform_specific.h"
 #include "u_cfg_test_platform_specific.h"
 
 #include "u_error_common.h"
@@ -42,6 +43,7 @@
 #include "u_port.h"
 #include "u_port_debug.h"
 #include "u_port_os.h"
+#include "u_port_heap.h"
 
 #include "u_test_util_resource_check.h"
 
@@ -76,14 +78,58 @@
 # define U_TEST_UTILS_RINGBUFFER_FILL_CHAR 0x5a
 #endif
 
+#ifndef U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE
+/** The size of ring buffer to use for the benchmark.
+ */
+# define U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE 4096
+#endif
+
+#ifndef U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_OPS
+/** The number of add operations to perform for each payload size
+ * in the benchmark.
+ */
+# define U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_OPS 100000
+#endif
+
+#ifndef U_TEST_UTILS_RINGBUFFER_BENCHMARK_PAYLOAD_MAX_SIZE
+/** The largest payload size to use in the benchmark.
+ */
+# define U_TEST_UTILS_RINGBUFFER_BENCHMARK_PAYLOAD_MAX_SIZE 1024
+#endif
+
+#ifndef U_TEST_UTILS_RINGBUFFER_BENCHMARK_TIMEOUT_MS
+/** Guard time for each run of the benchmark.
+ */
+# define U_TEST_UTILS_RINGBUFFER_BENCHMARK_TIMEOUT_MS 60000
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
+#ifdef __linux__
+/** Context for the producer task of the benchmark.
+ */
+typedef struct {
+    uRingBuffer_t *pRingBuffer;
+    size_t payloadSize;
+    size_t numOps;
+    volatile bool done;
+} uTestRingBufferProducer_t;
+#endif
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
 
+#ifdef __linux__
+/** The payload sizes to use in the benchmark.
+ */
+static const size_t gBenchmarkPayloadSize[] = {1, 16, 128,
+                                               U_TEST_UTILS_RINGBUFFER_BENCHMARK_PAYLOAD_MAX_SIZE
+                                              };
+#endif
+
 /* ----------------------------------------------------------------
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
@@ -108,6 +154,122 @@ static void printBuffer(const char *pTitle, const char *pStr, size_t length)
     uPortTaskBlock(10);
 }
 
+// A parser for testing: a message is '<', a length byte and then
+// that many bytes, which are fetched as spans since the message
+// may wrap; pUserParam points to a count of calls.
+static int32_t testParser(uParseHandle_t parseHandle, void *pUserParam)
+{
+    char c;
+    size_t length;
+    const char *pSpan;
+    size_t spanLength;
+
+    (*((size_t *) pUserParam))++;
+    if (!uRingBufferGetByteUnprotected(parseHandle, &c)) {
+        return U_ERROR_COMMON_TIMEOUT;
+    }
+    if (c != '<') {
+        return U_ERROR_COMMON_NOT_FOUND;
+    }
+    if (!uRingBufferGetByteUnprotected(parseHandle, &c)) {
+        return U_ERROR_COMMON_TIMEOUT;
+    }
+    length = (size_t) c;
+    while (length > 0) {
+        spanLength = uRingBufferGetSpanUnprotected(parseHandle, &pSpan, length);
+        if (spanLength == 0) {
+            return U_ERROR_COMMON_TIMEOUT;
+        }
+        length -= spanLength;
+    }
+
+    return U_ERROR_COMMON_SUCCESS;
+}
+
+#ifdef __linux__
+// Producer task for the benchmark: adds payloads containing an
+// incrementing byte count, retrying when the ring buffer is full.
+static void producerTask(void *pParam)
+{
+    uTestRingBufferProducer_t *pProducer = (uTestRingBufferProducer_t *) pParam;
+    char payload[U_TEST_UTILS_RINGBUFFER_BENCHMARK_PAYLOAD_MAX_SIZE];
+    char count = 0;
+
+    for (size_t x = 0; x < pProducer->numOps; x++) {
+        for (size_t y = 0; y < pProducer->payloadSize; y++) {
+            payload[y] = count;
+            count++;
+        }
+        while (!uRingBufferAdd(pProducer->pRingBuffer, payload,
+                               pProducer->payloadSize)) {
+            uPortTaskBlock(0);
+        }
+    }
+
+    pProducer->done = true;
+    uPortTaskDelete(NULL);
+}
+
+// Run one pass of the benchmark, returning the number of add
+// operations per second or negative error code.
+static int32_t benchmark(uRingBuffer_t *pRingBuffer, size_t payloadSize)
+{
+    int32_t opsPerSecond = (int32_t) U_ERROR_COMMON_TIMEOUT;
+    uTestRingBufferProducer_t producer = {0};
+    uPortTaskHandle_t taskHandle;
+    char buffer[U_TEST_UTILS_RINGBUFFER_BENCHMARK_PAYLOAD_MAX_SIZE];
+    size_t totalBytes = payloadSize * U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_OPS;
+    size_t bytesRead = 0;
+    size_t length;
+    char count = 0;
+    bool dataGood = true;
+    int32_t startTimeMs;
+    int32_t durationMs;
+
+    producer.pRingBuffer = pRingBuffer;
+    producer.payloadSize = payloadSize;
+    producer.numOps = U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_OPS;
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(uPortTaskCreate(producerTask, "testProducer",
+                                       U_CFG_TEST_OS_TASK_STACK_SIZE_BYTES +
+                                       U_TEST_UTILS_RINGBUFFER_BENCHMARK_PAYLOAD_MAX_SIZE,
+                                       &producer, U_CFG_TEST_OS_TASK_PRIORITY,
+                                       &taskHandle) == 0);
+    while ((bytesRead < totalBytes) && dataGood &&
+           (uPortGetTickTimeMs() - startTimeMs < U_TEST_UTILS_RINGBUFFER_BENCHMARK_TIMEOUT_MS)) {
+        length = uRingBufferRead(pRingBuffer, buffer, sizeof(buffer));
+        if (length == 0) {
+            uPortTaskBlock(0);
+        }
+        for (size_t x = 0; (x < length) && dataGood; x++) {
+            dataGood = (buffer[x] == count);
+            count++;
+        }
+        bytesRead += length;
+    }
+    durationMs = uPortGetTickTimeMs() - startTimeMs;
+    if (!dataGood) {
+        opsPerSecond = (int32_t) U_ERROR_COMMON_BAD_DATA;
+    } else if (bytesRead == totalBytes) {
+        if (durationMs <= 0) {
+            durationMs = 1;
+        }
+        opsPerSecond = (int32_t) (((int64_t) U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_OPS * 1000) /
+                                  durationMs);
+    }
+
+    // Wait for the producer to exit
+    while (!producer.done &&
+           (uPortGetTickTimeMs() - startTimeMs < U_TEST_UTILS_RINGBUFFER_BENCHMARK_TIMEOUT_MS)) {
+        uPortTaskBlock(U_CFG_OS_YIELD_MS);
+    }
+    U_PORT_TEST_ASSERT(producer.done);
+    uPortTaskBlock(U_CFG_OS_YIELD_MS);
+
+    return opsPerSecond;
+}
+#endif
+
 /* ----------------------------------------------------------------
  * PUBLIC FUNCTIONS: TESTS
  * -------------------------------------------------------------- */
@@ -882,4 +1044,440 @@ U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferBasic")
     U_PORT_TEST_ASSERT(resourceCount <= 0);
 }
 
+/** Test the zero-copy span access to a ring buffer, including
+ * the case where the data wraps around the end of the linear buffer.
+ */
+U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferSpans")
+{
+    int32_t resourceCount;
+    uRingBuffer_t ringBuffer = {0};
+    char linearBuffer[U_TEST_UTILS_RINGBUFFER_SIZE + 1];
+    char bufferIn[U_TEST_UTILS_RINGBUFFER_SIZE * 2];
+    char bufferOut[U_TEST_UTILS_RINGBUFFER_SIZE];
+    const char *pData1;
+    const char *pData2;
+    size_t length1;
+    size_t length2;
+    int32_t handle;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    for (size_t x = 0; x < sizeof(bufferIn); x++) {
+        bufferIn[x] = (char) x;
+    }
+
+    U_TEST_PRINT_LINE("testing ring buffer spans.");
+    U_PORT_TEST_ASSERT(uRingBufferCreateWithReadHandle(&ringBuffer, linearBuffer, sizeof(linearBuffer),
+                                                       U_TEST_UTILS_RINGBUFFER_READ_HANDLES_MAX_NUM) == 0);
+    handle = uRingBufferTakeReadHandle(&ringBuffer);
+    U_PORT_TEST_ASSERT(handle > 0);
+
+    // Nothing there to begin with
+    U_PORT_TEST_ASSERT(uRingBufferPeekSpans(&ringBuffer, handle, &pData1, &length1,
+                                            &pData2, &length2) == 0);
+    U_PORT_TEST_ASSERT((pData1 == NULL) && (length1 == 0));
+    U_PORT_TEST_ASSERT((pData2 == NULL) && (length2 == 0));
+    U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, handle, 1) == 0);
+
+    // Add some data which should be in a single span
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 6));
+    U_PORT_TEST_ASSERT(uRingBufferPeekSpans(&ringBuffer, handle, &pData1, &length1,
+                                            &pData2, &length2) == 6);
+    U_PORT_TEST_ASSERT((pData1 == linearBuffer) && (length1 == 6));
+    U_PORT_TEST_ASSERT((pData2 == NULL) && (length2 == 0));
+    U_PORT_TEST_ASSERT(memcmp(pData1, bufferIn, length1) == 0);
+    // The "normal" read pointer sees the same data
+    U_PORT_TEST_ASSERT(uRingBufferPeekSpans(&ringBuffer, 0, NULL, &length1,
+                                            NULL, NULL) == 6);
+    U_PORT_TEST_ASSERT(length1 == 6);
+    U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, 0, 6) == 6);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+
+    // Consume part of it from the handle, then add more so that
+    // the data wraps
+    U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, handle, 4) == 4);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn + 6,
+                                      sizeof(linearBuffer) - 6 + 2));
+    U_PORT_TEST_ASSERT(uRingBufferPeekSpans(&ringBuffer, handle, &pData1, &length1,
+                                            &pData2, &length2) == 2 + sizeof(linearBuffer) - 6 + 2);
+    U_PORT_TEST_ASSERT((pData1 == linearBuffer + 4) && (length1 == sizeof(linearBuffer) - 4));
+    U_PORT_TEST_ASSERT((pData2 == linearBuffer) && (length2 == 2));
+    memcpy(bufferOut, pData1, length1);
+    memcpy(bufferOut + length1, pData2, length2);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn + 4, length1 + length2) == 0);
+
+    // A copying read across the wrap must give the same answer
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    U_PORT_TEST_ASSERT(uRingBufferPeekHandle(&ringBuffer, handle, bufferOut,
+                                             sizeof(bufferOut), 0) == length1 + length2);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn + 4, length1 + length2) == 0);
+
+    // Consuming more than there is should only consume what is there
+    U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, handle, 100) == length1 + length2);
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle) == 0);
+
+    // With a read handle required, the "normal" read pointer gives nothing
+    uRingBufferSetReadRequiresHandle(&ringBuffer, true);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 1));
+    U_PORT_TEST_ASSERT(uRingBufferPeekSpans(&ringBuffer, 0, &pData1, &length1,
+                                            &pData2, &length2) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, 0, 1) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferPeekSpans(&ringBuffer, handle, &pData1, &length1,
+                                            &pData2, &length2) == 1);
+
+    U_TEST_PRINT_LINE("deleting ring buffer...");
+    uRingBufferGiveReadHandle(&ringBuffer, handle);
+    uRingBufferDelete(&ringBuffer);
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test writing directly into a ring buffer with
+ * uRingBufferReserveSpans()/uRingBufferCommit(), including the
+ * case where the space wraps around the end of the linear buffer.
+ */
+U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferReserve")
+{
+    int32_t resourceCount;
+    uRingBuffer_t ringBuffer = {0};
+    char linearBuffer[U_TEST_UTILS_RINGBUFFER_SIZE + 1];
+    char bufferIn[U_TEST_UTILS_RINGBUFFER_SIZE * 2];
+    char bufferOut[U_TEST_UTILS_RINGBUFFER_SIZE];
+    char *pData1;
+    char *pData2;
+    size_t length1;
+    size_t length2;
+    int32_t handle;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    for (size_t x = 0; x < sizeof(bufferIn); x++) {
+        bufferIn[x] = (char) x;
+    }
+
+    U_TEST_PRINT_LINE("testing ring buffer reserve/commit.");
+    U_PORT_TEST_ASSERT(uRingBufferCreateWithReadHandle(&ringBuffer, linearBuffer, sizeof(linearBuffer),
+                                                       U_TEST_UTILS_RINGBUFFER_READ_HANDLES_MAX_NUM) == 0);
+    handle = uRingBufferTakeReadHandle(&ringBuffer);
+    U_PORT_TEST_ASSERT(handle > 0);
+
+    // Nothing to commit to begin with
+    U_PORT_TEST_ASSERT(uRingBufferCommit(&ringBuffer, 1) == 0);
+
+    // Reserve some space, which should be a single span
+    U_PORT_TEST_ASSERT(uRingBufferReserveSpans(&ringBuffer, 6, false, &pData1, &length1,
+                                               &pData2, &length2) == 6);
+    U_PORT_TEST_ASSERT((pData1 == linearBuffer) && (length1 == 6));
+    U_PORT_TEST_ASSERT((pData2 == NULL) && (length2 == 0));
+    // While it is reserved, no-one else may write and
+    // readers see nothing
+    U_PORT_TEST_ASSERT(uRingBufferReserveSpans(&ringBuffer, 1, true, &pData2, &length2,
+                                               NULL, NULL) == 0);
+    U_PORT_TEST_ASSERT((pData2 == NULL) && (length2 == 0));
+    U_PORT_TEST_ASSERT(!uRingBufferAdd(&ringBuffer, bufferIn, 1));
+    U_PORT_TEST_ASSERT(!uRingBufferForceAdd(&ringBuffer, bufferIn, 1));
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle) == 0);
+    memcpy(pData1, bufferIn, length1);
+    U_PORT_TEST_ASSERT(uRingBufferCommit(&ringBuffer, length1) == length1);
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    U_PORT_TEST_ASSERT(uRingBufferPeekHandle(&ringBuffer, handle, bufferOut,
+                                             sizeof(bufferOut), 0) == 6);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn, 6) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, bufferOut, sizeof(bufferOut)) == 6);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 0));
+
+    // Consume part of it from the handle, then reserve more than
+    // there is room for: should get only what is free, wrapping
+    U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, handle, 4) == 4);
+    U_PORT_TEST_ASSERT(uRingBufferReserveSpans(&ringBuffer, sizeof(bufferIn), false,
+                                               &pData1, &length1,
+                                               &pData2, &length2) == sizeof(linearBuffer) - 2 - 1);
+    U_PORT_TEST_ASSERT((pData1 == linearBuffer + 6) && (length1 == sizeof(linearBuffer) - 6));
+    U_PORT_TEST_ASSERT((pData2 == linearBuffer) && (length2 == 6 - 2 - 1));
+    memcpy(pData1, bufferIn + 6, length1);
+    memcpy(pData2, bufferIn + 6 + length1, length2);
+    // Only commit some of it
+    U_PORT_TEST_ASSERT(uRingBufferCommit(&ringBuffer, length1 + 1) == length1 + 1);
+    U_PORT_TEST_ASSERT(uRingBufferCommit(&ringBuffer, 1) == 0);
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    U_PORT_TEST_ASSERT(uRingBufferPeekHandle(&ringBuffer, handle, bufferOut,
+                                             sizeof(bufferOut), 0) == 2 + length1 + 1);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn + 4, 2 + length1 + 1) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == length1 + 1);
+
+    // Without force there are only two bytes of room left; with force
+    // data is thrown away from the read pointers to make room
+    U_PORT_TEST_ASSERT(uRingBufferReserveSpans(&ringBuffer, 5, false, NULL, NULL,
+                                               NULL, NULL) == 2);
+    U_PORT_TEST_ASSERT(uRingBufferCommit(&ringBuffer, 0) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferReserveSpans(&ringBuffer, 5, true, &pData1, &length1,
+                                               &pData2, &length2) == 5);
+    U_PORT_TEST_ASSERT(uRingBufferStatReadLossHandle(&ringBuffer, handle) == 3);
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle) == 8 - 3);
+    U_PORT_TEST_ASSERT(length1 + length2 == 5);
+    U_PORT_TEST_ASSERT(uRingBufferCommit(&ringBuffer, 5) == 5);
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle) == sizeof(linearBuffer) - 1);
+
+    // A locked read handle cannot have data thrown away
+    U_PORT_TEST_ASSERT(uRingBufferLockReadHandle(&ringBuffer, handle) == sizeof(linearBuffer) - 1);
+    U_PORT_TEST_ASSERT(uRingBufferReserveSpans(&ringBuffer, 5, true, &pData1, &length1,
+                                               &pData2, &length2) == 0);
+    U_PORT_TEST_ASSERT((pData1 == NULL) && (length1 == 0));
+    U_PORT_TEST_ASSERT((pData2 == NULL) && (length2 == 0));
+    uRingBufferUnlockReadHandle(&ringBuffer, handle);
+
+    // A reset cancels a reservation
+    U_PORT_TEST_ASSERT(uRingBufferReserveSpans(&ringBuffer, 3, true, NULL, NULL,
+                                               NULL, NULL) == 3);
+    uRingBufferReset(&ringBuffer);
+    U_PORT_TEST_ASSERT(uRingBufferCommit(&ringBuffer, 3) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 1));
+
+    U_TEST_PRINT_LINE("deleting ring buffer...");
+    uRingBufferGiveReadHandle(&ringBuffer, handle);
+    uRingBufferDelete(&ringBuffer);
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test that uRingBufferParseHandleSync() finds the same messages
+ * as uRingBufferParseHandle(), including across the wrap, while
+ * calling the parsers only at start bytes.
+ */
+U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferParseSync")
+{
+    int32_t resourceCount;
+    uRingBuffer_t ringBuffer = {0};
+    char linearBuffer[U_TEST_UTILS_RINGBUFFER_SIZE * 2];
+    // 7 bytes of garbage, a 5 byte message and 2 more bytes of garbage
+    const char bufferIn[] = "garbage<\3abczz";
+    const size_t expectedReturn[] = {7, 5, 2};
+    U_RING_BUFFER_PARSER_f parserList[] = {testParser, NULL};
+    size_t numCalls[2] = {0};
+    size_t length;
+    int32_t handle;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_TEST_PRINT_LINE("testing ring buffer parsing with start bytes.");
+    U_PORT_TEST_ASSERT(uRingBufferCreateWithReadHandle(&ringBuffer, linearBuffer, sizeof(linearBuffer),
+                                                       U_TEST_UTILS_RINGBUFFER_READ_HANDLES_MAX_NUM) == 0);
+    uRingBufferSetReadRequiresHandle(&ringBuffer, true);
+    handle = uRingBufferTakeReadHandle(&ringBuffer);
+    U_PORT_TEST_ASSERT(handle > 0);
+
+    // Move the pointers along so that the message straddles the wrap
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 10));
+    U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, handle, 10) == 10);
+
+    // Nothing there: both should time out without calling the parser
+    U_PORT_TEST_ASSERT(uRingBufferParseHandleSync(&ringBuffer, handle, parserList, "<", 1,
+                                                  &(numCalls[1])) == (size_t) U_ERROR_COMMON_TIMEOUT);
+    U_PORT_TEST_ASSERT(numCalls[1] == 0);
+
+    // Run through the input with each form, the plain one first,
+    // each time putting the read pointer back to the same place
+    for (size_t x = 0; x < sizeof(numCalls) / sizeof(numCalls[0]); x++) {
+        U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, sizeof(bufferIn) - 1));
+        for (size_t y = 0; y < sizeof(expectedReturn) / sizeof(expectedReturn[0]); y++) {
+            if (x == 0) {
+                length = uRingBufferParseHandle(&ringBuffer, handle, parserList, &(numCalls[x]));
+            } else {
+                length = uRingBufferParseHandleSync(&ringBuffer, handle, parserList,
+                                                    "\xb5<$", 3, &(numCalls[x]));
+            }
+            U_TEST_PRINT_LINE("%s: parse %d returned %d, %d parser call(s) so far.",
+                              x == 0 ? "plain" : "sync", y + 1, (int32_t) length, numCalls[x]);
+            U_PORT_TEST_ASSERT(length == expectedReturn[y]);
+            U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, handle, length) == length);
+        }
+        U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&ringBuffer, handle) == 0);
+        U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, handle, 1) == 0);
+        // Put the write pointer back to where it was
+        U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn,
+                                          sizeof(linearBuffer) - (sizeof(bufferIn) - 1)));
+        U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, handle, sizeof(linearBuffer)) ==
+                           sizeof(linearBuffer) - (sizeof(bufferIn) - 1));
+    }
+    // The plain form calls the parser at each byte of garbage and
+    // twice at the start of the message (once in the call that
+    // returns the garbage in front of it, once in the call that
+    // returns the message), the sync form only at the start of the
+    // message
+    U_PORT_TEST_ASSERT(numCalls[0] == 7 + 2 + 2);
+    U_PORT_TEST_ASSERT(numCalls[1] == 2);
+
+    U_TEST_PRINT_LINE("deleting ring buffer...");
+    uRingBufferGiveReadHandle(&ringBuffer, handle);
+    uRingBufferDelete(&ringBuffer);
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test the single-producer/single-consumer form of ring buffer
+ * from a single task.
+ */
+U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferSpsc")
+{
+    int32_t resourceCount;
+    uRingBuffer_t ringBuffer = {0};
+    char linearBuffer[U_TEST_UTILS_RINGBUFFER_SIZE + 1];
+    char bufferIn[U_TEST_UTILS_RINGBUFFER_SIZE];
+    char bufferOut[U_TEST_UTILS_RINGBUFFER_SIZE];
+    const char *pData1;
+    const char *pData2;
+    size_t length1;
+    size_t length2;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    for (size_t x = 0; x < sizeof(bufferIn); x++) {
+        bufferIn[x] = (char) x;
+    }
+
+    U_TEST_PRINT_LINE("testing single-producer/single-consumer ring buffer.");
+    U_PORT_TEST_ASSERT(uRingBufferCreateSpsc(&ringBuffer, linearBuffer, sizeof(linearBuffer)) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferTakeReadHandle(&ringBuffer) < 0);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&ringBuffer) == sizeof(linearBuffer) - 1);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSizeMax(&ringBuffer) == sizeof(linearBuffer) - 1);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, bufferOut, sizeof(bufferOut)) == 0);
+
+    // Fill it completely, then one more byte should fail, forced or not
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, sizeof(linearBuffer) - 1));
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == sizeof(linearBuffer) - 1);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&ringBuffer) == 0);
+    U_PORT_TEST_ASSERT(!uRingBufferAdd(&ringBuffer, bufferIn, 1));
+    U_PORT_TEST_ASSERT(!uRingBufferForceAdd(&ringBuffer, bufferIn, 1));
+    U_PORT_TEST_ASSERT(uRingBufferStatAddLoss(&ringBuffer) == 2);
+
+    // Peek at an offset, then read part of it
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    U_PORT_TEST_ASSERT(uRingBufferPeek(&ringBuffer, bufferOut, 2, 3) == 2);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn + 3, 2) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferPeek(&ringBuffer, bufferOut, 2, sizeof(linearBuffer)) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, bufferOut, 7) == 7);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn, 7) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == sizeof(linearBuffer) - 1 - 7);
+
+    // Add enough to wrap and check that it reads back correctly,
+    // both through the spans and by copying
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 5));
+    U_PORT_TEST_ASSERT(uRingBufferPeekSpans(&ringBuffer, 0, &pData1, &length1,
+                                            &pData2, &length2) == sizeof(linearBuffer) - 1 - 7 + 5);
+    U_PORT_TEST_ASSERT((pData1 == linearBuffer + 7) && (length1 == sizeof(linearBuffer) - 7));
+    U_PORT_TEST_ASSERT((pData2 == linearBuffer) && (length2 == 5 - 1));
+    U_PORT_TEST_ASSERT(uRingBufferConsume(&ringBuffer, 0, sizeof(linearBuffer) - 1 - 7) ==
+                       sizeof(linearBuffer) - 1 - 7);
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, sizeof(bufferOut));
+    U_PORT_TEST_ASSERT(uRingBufferRead(&ringBuffer, bufferOut, sizeof(bufferOut)) == 5);
+    U_PORT_TEST_ASSERT(memcmp(bufferOut, bufferIn, 5) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+
+    // Flush value and flush
+    memset(bufferOut, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, 3);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferOut, 3));
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 2));
+    uRingBufferFlushValue(&ringBuffer, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, 4);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 5);
+    uRingBufferFlushValue(&ringBuffer, U_TEST_UTILS_RINGBUFFER_FILL_CHAR, 3);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 2);
+    uRingBufferFlush(&ringBuffer);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferAdd(&ringBuffer, bufferIn, 2));
+    uRingBufferReset(&ringBuffer);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&ringBuffer) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferAvailableSize(&ringBuffer) == sizeof(linearBuffer) - 1);
+
+    U_TEST_PRINT_LINE("deleting ring buffer...");
+    uRingBufferDelete(&ringBuffer);
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+#ifdef __linux__
+/** Benchmark: one producer task adding data while this task reads
+ * it, comparing the mutex-protected ring buffer with the
+ * single-producer/single-consumer form, at various payload sizes.
+ */
+U_PORT_TEST_FUNCTION("[ringbuffer]", "ringbufferSpscBenchmark")
+{
+    int32_t resourceCount;
+    uRingBuffer_t ringBuffer = {0};
+    char *pLinearBuffer;
+    int32_t opsPerSecond[2];
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    pLinearBuffer = (char *) pUPortMalloc(U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE);
+    U_PORT_TEST_ASSERT(pLinearBuffer != NULL);
+
+    U_TEST_PRINT_LINE("%d add operations per payload size, ring buffer %d bytes:",
+                      U_TEST_UTILS_RINGBUFFER_BENCHMARK_NUM_OPS,
+                      U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE);
+    U_TEST_PRINT_LINE("payload (bytes)   mutex (ops/s)    SPSC (ops/s)");
+    for (size_t x = 0; x < sizeof(gBenchmarkPayloadSize) / sizeof(gBenchmarkPayloadSize[0]); x++) {
+        U_PORT_TEST_ASSERT(uRingBufferCreate(&ringBuffer, pLinearBuffer,
+                                             U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE) == 0);
+        opsPerSecond[0] = benchmark(&ringBuffer, gBenchmarkPayloadSize[x]);
+        uRingBufferDelete(&ringBuffer);
+        U_PORT_TEST_ASSERT(uRingBufferCreateSpsc(&ringBuffer, pLinearBuffer,
+                                                 U_TEST_UTILS_RINGBUFFER_BENCHMARK_SIZE) == 0);
+        opsPerSecond[1] = benchmark(&ringBuffer, gBenchmarkPayloadSize[x]);
+        uRingBufferDelete(&ringBuffer);
+        U_TEST_PRINT_LINE("%15d %15d %15d", gBenchmarkPayloadSize[x],
+                          opsPerSecond[0], opsPerSecond[1]);
+        U_PORT_TEST_ASSERT(opsPerSecond[0] > 0);
+        U_PORT_TEST_ASSERT(opsPerSecond[1] > 0);
+    }
+
+    uPortFree(pLinearBuffer);
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+#endif
+
 // End of file
\ No newline at end of file
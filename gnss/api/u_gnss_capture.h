@@ -0,0 +1,287 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_CAPTURE_H_
+#define _U_GNSS_CAPTURE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+#include "u_device.h"
+#include "u_device_serial.h"
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines functions that capture the raw
+ * stream of data from a GNSS chip, with time-stamps, and replay it
+ * later, e.g. to reproduce a problem seen in the field or to
+ * benchmark message parsing without a GNSS chip attached.
+ *
+ * Capture is hooked into the point where data from the GNSS chip
+ * is written into the internal ring buffer and so works for any
+ * streaming transport (UART, I2C, SPI or Virtual Serial); it does
+ * not work for #U_GNSS_TRANSPORT_AT.
+ *
+ * Replay is done through a virtual serial device: call
+ * pUGnssCaptureReplayCreate() or pUGnssCaptureReplayCreateFile(),
+ * open() the virtual serial device that is returned and pass it to
+ * uGnssAdd() as the transport handle of a
+ * #U_GNSS_TRANSPORT_VIRTUAL_SERIAL transport; the replayed data then
+ * flows through the ring buffer and the message receive task exactly
+ * as data from a GNSS chip would.  Anything written to the replay
+ * device is thrown away, so don't expect any responses from it,
+ * i.e. don't call uGnssPwrOn() etc.
+ *
+ * The format of a capture is as follows, all multi-byte values
+ * being little-endian:
+ *
+ * - a header of #U_GNSS_CAPTURE_HEADER_LENGTH_BYTES: the four
+ *   characters of #U_GNSS_CAPTURE_MAGIC, a one byte version
+ *   (#U_GNSS_CAPTURE_VERSION) and three reserved bytes, set to zero,
+ * - zero or more records, each of which is a uint32_t time-stamp,
+ *   the number of milliseconds since the capture was started
+ *   (from the monotonic uPortGetTickTimeMs()), followed by a uint16_t
+ *   length, followed by that many bytes of data exactly as they were
+ *   received from the GNSS chip.
+ *
+ * A record is written each time a block of data is read from the
+ * GNSS chip into the ring buffer; a record does not necessarily
+ * begin or end on a message boundary.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The four characters at the start of a capture.
+ */
+#define U_GNSS_CAPTURE_MAGIC "UGCP"
+
+/** The version of the capture format that this code writes and
+ * reads.
+ */
+#define U_GNSS_CAPTURE_VERSION 1
+
+/** The length of the header at the start of a capture.
+ */
+#define U_GNSS_CAPTURE_HEADER_LENGTH_BYTES 8
+
+/** The length of the header at the start of each record in a
+ * capture: a four byte time-stamp and a two byte length.
+ */
+#define U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES 6
+
+#ifndef U_GNSS_CAPTURE_REPLAY_INDEX_STRIDE
+/** When replaying a capture an index of time-stamps and record
+ * offsets is built so that seeking, even in a capture many hours
+ * long, is a binary search rather than a walk through the capture;
+ * the index has one entry per this number of records.  Making this
+ * larger saves memory at the cost of seek time: one index entry
+ * takes 8 bytes on a 32-bit MCU, 16 bytes on a 64-bit machine.
+ */
+# define U_GNSS_CAPTURE_REPLAY_INDEX_STRIDE 16
+#endif
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: CAPTURE
+ * -------------------------------------------------------------- */
+
+/** Start capturing the data stream from a GNSS chip, passing the
+ * capture to a callback.  The callback will be called immediately
+ * with the capture header and then, for each record, with the record
+ * header followed by the record data, potentially in several pieces;
+ * the callback is simply expected to append what it is given to
+ * wherever the capture is being stored.  If a capture is already
+ * running it is stopped first.
+ *
+ * Note that data is only read from the GNSS chip when something
+ * wants it, e.g. the message receive task started by
+ * uGnssMsgReceiveStart(), or a call to uGnssPosGet().
+ *
+ * @param gnssHandle          the handle of the GNSS instance.
+ * @param[in] pCallback       the function that will be called with
+ *                            the captured data; it is called from
+ *                            whichever task is reading data from the
+ *                            GNSS chip at the time and must not call
+ *                            into the GNSS API.  Cannot be NULL.
+ * @param[in] pCallbackParam  a parameter that will be passed to
+ *                            pCallback as its last parameter; may be
+ *                            NULL.
+ * @return                    zero on success else negative error code.
+ */
+int32_t uGnssCaptureStart(uDeviceHandle_t gnssHandle,
+                          void (*pCallback)(uDeviceHandle_t gnssHandle,
+                                            const char *pData,
+                                            size_t size,
+                                            void *pCallbackParam),
+                          void *pCallbackParam);
+
+/** Start capturing the data stream from a GNSS chip to a file; if
+ * the file exists it will be overwritten.  If a capture is already
+ * running it is stopped first.  This requires the uPortFileXxx()
+ * API (see u_port_file.h) to be implemented for the platform,
+ * which is currently only the case for native Linux; for any other
+ * platform use uGnssCaptureStart().
+ *
+ * @param gnssHandle     the handle of the GNSS instance.
+ * @param[in] pFileName  the name of the file to write to, cannot be
+ *                       NULL.
+ * @return               zero on success else negative error code.
+ */
+int32_t uGnssCaptureStartFile(uDeviceHandle_t gnssHandle,
+                              const char *pFileName);
+
+/** Stop capturing the data stream from a GNSS chip; if the capture
+ * was started with uGnssCaptureStartFile() the file is closed.
+ *
+ * @param gnssHandle the handle of the GNSS instance.
+ * @return           on success the number of bytes in the capture,
+ *                   including all headers, else negative error code;
+ *                   if writing to a capture file failed the error
+ *                   from the first failed write is returned.
+ */
+int32_t uGnssCaptureStop(uDeviceHandle_t gnssHandle);
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS: REPLAY
+ * -------------------------------------------------------------- */
+
+/** Create a virtual serial device that will replay a capture held
+ * in memory (for instance in flash).  The virtual serial device
+ * must be opened, with a call to its open() function (the receive
+ * buffer parameters of which are ignored), before it will return
+ * data; replay begins at the start of the capture, or at the point
+ * set by uGnssCaptureReplaySeek(), when open() is called, so open()
+ * the device only once uGnssAdd() has been called and any message
+ * receivers have been started: as with a real GNSS chip, data that
+ * arrives before anyone is listening may be lost.  A truncated final
+ * record, as might be left behind if capture was interrupted, is
+ * ignored.
+ *
+ * @param[in] pCapture  a pointer to the capture; this must remain
+ *                      valid until uGnssCaptureReplayDelete() has been
+ *                      called.  Cannot be NULL.
+ * @param size          the number of bytes at pCapture.
+ * @param realTime      if true the capture is replayed at the speed
+ *                      at which it was captured, else the whole
+ *                      capture is made available immediately and
+ *                      will be replayed as fast as it can be read.
+ * @return              a pointer to the virtual serial device or NULL
+ *                      if the capture is not valid or there is
+ *                      insufficient memory.
+ */
+uDeviceSerial_t *pUGnssCaptureReplayCreate(const char *pCapture,
+                                           size_t size, bool realTime);
+
+/** As pUGnssCaptureReplayCreate() but replays a capture file, e.g.
+ * one written by uGnssCaptureStartFile().  The file is mapped into
+ * memory with uPortFileMap() (see u_port_file.h) so, on platforms
+ * where that is backed by demand-paging (e.g. mmap() on Linux), the
+ * file is not read into RAM up-front and even a capture that is many
+ * hours long can be opened and seeked-in quickly.
+ *
+ * @param[in] pFileName  the name of the capture file, cannot be NULL.
+ * @param realTime       if true the capture is replayed at the speed
+ *                       at which it was captured, else as fast as it
+ *                       can be read.
+ * @return               a pointer to the virtual serial device or NULL
+ *                       if the file could not be mapped, the capture
+ *                       is not valid or there is insufficient memory.
+ */
+uDeviceSerial_t *pUGnssCaptureReplayCreateFile(const char *pFileName,
+                                               bool realTime);
+
+/** Move the replay position of a replay device to the first record
+ * with a time-stamp at or after the given time; if the device is
+ * open replay continues from there, in real-time mode relative to
+ * the moment this function is called.
+ *
+ * @param[in] pDeviceSerial a replay device created by
+ *                          pUGnssCaptureReplayCreate() or
+ *                          pUGnssCaptureReplayCreateFile().
+ * @param timeMs            the capture time to move to in milliseconds.
+ * @return                  zero on success, else negative error code;
+ *                          if timeMs is beyond the end of the capture
+ *                          the replay position is moved to the end and
+ *                          #U_ERROR_COMMON_NOT_FOUND is returned.
+ */
+int32_t uGnssCaptureReplaySeek(uDeviceSerial_t *pDeviceSerial,
+                               int32_t timeMs);
+
+/** Get the capture time of the current replay position of a replay
+ * device.
+ *
+ * @param[in] pDeviceSerial a replay device created by
+ *                          pUGnssCaptureReplayCreate() or
+ *                          pUGnssCaptureReplayCreateFile().
+ * @return                  on success the time-stamp, in milliseconds,
+ *                          of the record that will be replayed next
+ *                          or, if the end of the capture has been
+ *                          reached, the time-stamp of the last record,
+ *                          else negative error code.
+ */
+int32_t uGnssCaptureReplayGetTimeMs(uDeviceSerial_t *pDeviceSerial);
+
+/** Get the length of the capture being replayed by a replay device.
+ *
+ * @param[in] pDeviceSerial a replay device created by
+ *                          pUGnssCaptureReplayCreate() or
+ *                          pUGnssCaptureReplayCreateFile().
+ * @return                  on success the time-stamp, in milliseconds,
+ *                          of the last record in the capture, else
+ *                          negative error code.
+ */
+int32_t uGnssCaptureReplayGetDurationMs(uDeviceSerial_t *pDeviceSerial);
+
+/** Determine whether a replay device has replayed all of its
+ * capture.
+ *
+ * @param[in] pDeviceSerial a replay device created by
+ *                          pUGnssCaptureReplayCreate() or
+ *                          pUGnssCaptureReplayCreateFile().
+ * @return                  true if all of the data in the capture has
+ *                          been read from the replay device.
+ */
+bool uGnssCaptureReplayIsAtEnd(uDeviceSerial_t *pDeviceSerial);
+
+/** Delete a replay device, releasing any file mapping; if the
+ * replay device is being used as the transport of a GNSS instance,
+ * uGnssRemove() must be called first.
+ *
+ * @param[in] pDeviceSerial a replay device created by
+ *                          pUGnssCaptureReplayCreate() or
+ *                          pUGnssCaptureReplayCreateFile().
+ */
+void uGnssCaptureReplayDelete(uDeviceSerial_t *pDeviceSerial);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_CAPTURE_H_
+
+// End of file
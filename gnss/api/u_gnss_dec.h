@@ -24,6 +24,24 @@
 
 #include "u_gnss_dec_ubx_nav_pvt.h"
 #include "u_gnss_dec_ubx_nav_hpposllh.h"
+#include "u_gnss_dec_ubx_nav_status.h"
+#include "u_gnss_dec_ubx_nav_dop.h"
+#include "u_gnss_dec_ubx_nav_cov.h"
+#include "u_gnss_dec_ubx_nav_sat.h"
+#include "u_gnss_dec_ubx_nav_sig.h"
+#include "u_gnss_dec_ubx_rxm_rawx.h"
+#include "u_gnss_dec_ubx_rxm_sfrbx.h"
+#include "u_gnss_dec_ubx_esf_meas.h"
+#include "u_gnss_dec_ubx_esf_ins.h"
+#include "u_gnss_dec_ubx_tim_tp.h"
+#include "u_gnss_dec_ubx_mon_rf.h"
+#include "u_gnss_dec_nmea_gga.h"
+#include "u_gnss_dec_nmea_rmc.h"
+#include "u_gnss_dec_nmea_gsa.h"
+#include "u_gnss_dec_nmea_gsv.h"
+#include "u_gnss_dec_nmea_vtg.h"
+#include "u_gnss_dec_nmea_gst.h"
+#include "u_gnss_dec_nmea_zda.h"
 
 /** \addtogroup _GNSS
  *  @{
@@ -35,7 +53,9 @@
  * supported.  Use this if you wish to access the detailed contents
  * of, for instance, a UBX-NAV-PVT message, or if you wish
  * to obtain high precision position from a HPG GNSS device
- * by requesting it to emit the UBX-NAV-HPPOSLLH message.
+ * by requesting it to emit the UBX-NAV-HPPOSLLH message, or
+ * if you wish to obtain the fields of an NMEA sentence without
+ * having to parse them yourself.
  *
  * The functions are thread-safe with the exception of
  * uGnssDecSetCallback().
@@ -54,10 +74,33 @@ extern "C" {
  * -------------------------------------------------------------- */
 
 /** Union of all decodable message structures.
+ *
+ * Note: this union is as large as its largest member which, with the
+ * default value of #U_GNSS_DEC_UBX_RXM_RAWX_MEAS_MAX_NUM, is
+ * UBX-RXM-RAWX at over 2 kbytes; don't put one of these on the stack
+ * of a small task, see uGnssDecIntoBuffer() for the alternatives.
  */
 typedef union {
     uGnssDecUbxNavPvt_t           ubxNavPvt;      /**< UBX-NAV-PVT. */
     uGnssDecUbxNavHpposllh_t      ubxNavHpposllh; /**< UBX-NAV-HPPOSLLH. */
+    uGnssDecUbxNavStatus_t        ubxNavStatus;   /**< UBX-NAV-STATUS. */
+    uGnssDecUbxNavDop_t           ubxNavDop;      /**< UBX-NAV-DOP. */
+    uGnssDecUbxNavCov_t           ubxNavCov;      /**< UBX-NAV-COV. */
+    uGnssDecUbxNavSat_t           ubxNavSat;      /**< UBX-NAV-SAT. */
+    uGnssDecUbxNavSig_t           ubxNavSig;      /**< UBX-NAV-SIG. */
+    uGnssDecUbxRxmRawx_t          ubxRxmRawx;     /**< UBX-RXM-RAWX. */
+    uGnssDecUbxRxmSfrbx_t         ubxRxmSfrbx;    /**< UBX-RXM-SFRBX. */
+    uGnssDecUbxEsfMeas_t          ubxEsfMeas;     /**< UBX-ESF-MEAS. */
+    uGnssDecUbxEsfIns_t           ubxEsfIns;      /**< UBX-ESF-INS. */
+    uGnssDecUbxTimTp_t            ubxTimTp;       /**< UBX-TIM-TP. */
+    uGnssDecUbxMonRf_t            ubxMonRf;       /**< UBX-MON-RF. */
+    uGnssDecNmeaGga_t             nmeaGga;        /**< NMEA GGA. */
+    uGnssDecNmeaRmc_t             nmeaRmc;        /**< NMEA RMC. */
+    uGnssDecNmeaGsa_t             nmeaGsa;        /**< NMEA GSA. */
+    uGnssDecNmeaGsv_t             nmeaGsv;        /**< NMEA GSV. */
+    uGnssDecNmeaVtg_t             nmeaVtg;        /**< NMEA VTG. */
+    uGnssDecNmeaGst_t             nmeaGst;        /**< NMEA GST. */
+    uGnssDecNmeaZda_t             nmeaZda;        /**< NMEA ZDA. */
 } uGnssDecUnion_t;
 
 /** The result of attempting to decode a message, returned by
@@ -155,12 +198,17 @@ typedef int32_t (uGnssDecFunction_t) (uGnssMessageId_t *pId,
  * and must include all headers; no checking of checksums etc. on the
  * end of a known message is performed, hence they may be omitted.
  *
- * Currently only a very limited set of messages (actually just
- * UBX-NAV-PVT and UBX-NAV-HPPOSLLH, the latter useful if you wish
- * to use a high precision GNSS (HPG) device to its full extent) are
- * supported; see the top of the file u_gnss_dec.c for instructions
- * on how to add more decoders, or use uGnssDecSetCallback() to
- * hook-in your own decoders at run-time.
+ * Currently only a limited set of UBX messages are supported:
+ * UBX-NAV-PVT, UBX-NAV-HPPOSLLH (useful if you wish to use a high
+ * precision GNSS (HPG) device to its full extent), UBX-NAV-STATUS,
+ * UBX-NAV-DOP, UBX-NAV-COV, UBX-NAV-SAT, UBX-NAV-SIG, UBX-RXM-RAWX,
+ * UBX-RXM-SFRBX, UBX-ESF-MEAS, UBX-ESF-INS, UBX-TIM-TP and
+ * UBX-MON-RF, plus the NMEA sentences GGA, RMC, GSA, GSV, VTG, GST
+ * and ZDA from any talker; NMEA fields are decoded into fixed-point
+ * integers, see the individual structure types for the units.
+ * See the top of the file u_gnss_dec.c for instructions on how to
+ * add more decoders, or use uGnssDecSetCallback() to hook-in your
+ * own decoders at run-time.
  *
  * If only a partial decode is possible then the errorCode field of
  * the returned structure will be negative but the protocol type
@@ -186,6 +234,62 @@ typedef int32_t (uGnssDecFunction_t) (uGnssMessageId_t *pId,
  */
 uGnssDec_t *pUGnssDecAlloc(const char *pBuffer, size_t size);
 
+/** As pUGnssDecAlloc() but decoding into memory provided by the
+ * caller, so that no heap is used: useful when decoding at a high
+ * message rate.  The decoded message body is written to pBody and,
+ * on success, the pBody field of pDec is set to point at it.  For
+ * a message with repeated blocks (e.g. the satellites of UBX-NAV-SAT)
+ * the number of blocks decoded is limited by the size of the array
+ * in the message structure, e.g. #U_GNSS_DEC_UBX_NAV_SAT_SV_MAX_NUM.
+ *
+ * Where you know which message you are decoding, pass in the structure
+ * of that message (e.g. a #uGnssDecUbxNavPvt_t for UBX-NAV-PVT) rather
+ * than a #uGnssDecUnion_t: the union is sized by the largest message
+ * and so is far bigger than is usually needed, too big to be put on
+ * the stack of a small task.  With the default repeated-block limits
+ * the sizes of the message structures are approximately:
+ *
+ * - 2064 bytes: UBX-RXM-RAWX (#U_GNSS_DEC_UBX_RXM_RAWX_MEAS_MAX_NUM
+ *   of 32 bytes each),
+ * - 1160 bytes: UBX-NAV-SIG (#U_GNSS_DEC_UBX_NAV_SIG_SIG_MAX_NUM
+ *   of 12 bytes each),
+ * - 776 bytes: UBX-NAV-SAT (#U_GNSS_DEC_UBX_NAV_SAT_SV_MAX_NUM
+ *   of 12 bytes each),
+ * - 136 bytes: UBX-ESF-MEAS,
+ * - 92 bytes: UBX-NAV-PVT,
+ * - 84 bytes: UBX-MON-RF,
+ * - 72 bytes: UBX-RXM-SFRBX,
+ * - 56 bytes or less: all of the others, including the NMEA sentences.
+ *
+ * If you must use the union, or one of the large structures, either
+ * make it static or allocate it once, or override the relevant
+ * repeated-block limits in your build to reduce the sizes.
+ *
+ * Since a callback set with uGnssDecSetCallback() allocates memory
+ * for the message body, it is NOT called by this function.
+ *
+ * @param[in] pBuffer     the buffer containing the message to be
+ *                        decoded; cannot be NULL.
+ * @param size            the amount of data at pBuffer.
+ * @param[out] pDec       a place to put the result of decoding;
+ *                        cannot be NULL.
+ * @param[out] pBody      a place to put the decoded message body,
+ *                        preferably the structure of the message
+ *                        expected, e.g. a #uGnssDecUbxNavPvt_t.
+ * @param bodySize        the amount of storage at pBody; if this is
+ *                        smaller than the structure of the message
+ *                        being decoded #U_ERROR_COMMON_NO_MEMORY
+ *                        will be returned; sizeof(uGnssDecUnion_t)
+ *                        is always sufficient but is large, see
+ *                        above.
+ * @return                zero on success else negative error code,
+ *                        the same value as is written to the
+ *                        errorCode field of pDec.
+ */
+int32_t uGnssDecIntoBuffer(const char *pBuffer, size_t size,
+                           uGnssDec_t *pDec, void *pBody,
+                           size_t bodySize);
+
 /** Free the memory returned by pUGnssDecAlloc().
  *
  * @param[in] pDec the pointer returned by pUGnssDecAlloc(); may
@@ -0,0 +1,99 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_DEC_NMEA_GGA_H_
+#define _U_GNSS_DEC_NMEA_GGA_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the types of an NMEA GGA
+ * sentence, global positioning system fix data.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The sentence formatter of an NMEA GGA sentence, i.e. the
+ * address field without the two-character talker ID.
+ */
+#define U_GNSS_DEC_NMEA_GGA_SENTENCE_FORMATTER "GGA"
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** NMEA GGA sentence structure; the naming of each element
+ * follows that of the interface manual, with values carried as
+ * fixed-point integers: latitude and longitude in units of
+ * 1e-7 degrees (the same as UBX-NAV-PVT) and distances in
+ * millimetres.
+ */
+typedef struct {
+    uint32_t present;      /**< bit N is set if field N of the sentence
+                                (the address field being field 0,
+                                the field numbering being as in
+                                the interface manual) was neither
+                                empty nor corrupt (e.g. holding a
+                                number too long to decode); a member
+                                populated from such a field will
+                                be zero. */
+    uint8_t hour;          /**< UTC hour, 0 to 23 (field 1). */
+    uint8_t min;           /**< UTC minute, 0 to 59 (field 1). */
+    uint8_t sec;           /**< UTC second, 0 to 60 (field 1). */
+    uint16_t millisecond;  /**< UTC millisecond, 0 to 999 (field 1). */
+    int32_t lat;           /**< latitude in 1e-7 degrees, negative
+                                for south (fields 2 and 3). */
+    int32_t lon;           /**< longitude in 1e-7 degrees, negative
+                                for west (fields 4 and 5). */
+    uint8_t quality;       /**< the quality indicator, e.g. 0 for no fix,
+                                1 for autonomous, 2 for differential,
+                                4 for RTK fixed, 5 for RTK float, 6 for
+                                dead reckoning (field 6). */
+    uint8_t numSV;         /**< the number of satellites used (field 7). */
+    uint16_t HDOP;         /**< horizontal dilution of precision times
+                                100 (field 8). */
+    int32_t alt;           /**< altitude above mean sea level in
+                                millimetres (field 9). */
+    int32_t sep;           /**< geoid separation in millimetres
+                                (field 11). */
+    uint32_t diffAge;      /**< age of differential corrections in
+                                milliseconds (field 13). */
+    uint16_t diffStation;  /**< the ID of the station providing
+                                differential corrections (field 14). */
+} uGnssDecNmeaGga_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_DEC_NMEA_GGA_H_
+
+// End of file
@@ -0,0 +1,93 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_DEC_NMEA_GSA_H_
+#define _U_GNSS_DEC_NMEA_GSA_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the types of an NMEA GSA
+ * sentence, dilution of precision and active satellites.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The sentence formatter of an NMEA GSA sentence, i.e. the
+ * address field without the two-character talker ID.
+ */
+#define U_GNSS_DEC_NMEA_GSA_SENTENCE_FORMATTER "GSA"
+
+/** The maximum number of satellite IDs in an NMEA GSA sentence.
+ */
+#define U_GNSS_DEC_NMEA_GSA_SVID_MAX_NUM 12
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** NMEA GSA sentence structure; the naming of each element
+ * follows that of the interface manual, with values carried as
+ * fixed-point integers: DOP values are scaled by 100, e.g. a
+ * value of 156 means a DOP of 1.56.
+ */
+typedef struct {
+    uint32_t present;      /**< bit N is set if field N of the sentence
+                                (the address field being field 0,
+                                the field numbering being as in
+                                the interface manual) was neither
+                                empty nor corrupt (e.g. holding a
+                                number too long to decode); a member
+                                populated from such a field will
+                                be zero. */
+    char opMode;           /**< the operation mode, 'M' for manual,
+                                'A' for automatic (field 1). */
+    uint8_t navMode;       /**< the navigation mode, 1 for no fix,
+                                2 for 2D fix, 3 for 3D fix (field 2). */
+    uint16_t svid[U_GNSS_DEC_NMEA_GSA_SVID_MAX_NUM]; /**< the IDs of the
+                                                          satellites used,
+                                                          zero where
+                                                          there is none
+                                                          (fields 3 to 14). */
+    uint16_t PDOP;         /**< position DOP times 100 (field 15). */
+    uint16_t HDOP;         /**< horizontal DOP times 100 (field 16). */
+    uint16_t VDOP;         /**< vertical DOP times 100 (field 17). */
+    uint8_t systemId;      /**< the NMEA GNSS system ID, NMEA 4.10
+                                and later only (field 18). */
+} uGnssDecNmeaGsa_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_DEC_NMEA_GSA_H_
+
+// End of file
@@ -0,0 +1,94 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_DEC_NMEA_GST_H_
+#define _U_GNSS_DEC_NMEA_GST_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the types of an NMEA GST
+ * sentence, pseudorange error statistics.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The sentence formatter of an NMEA GST sentence, i.e. the
+ * address field without the two-character talker ID.
+ */
+#define U_GNSS_DEC_NMEA_GST_SENTENCE_FORMATTER "GST"
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** NMEA GST sentence structure; the naming of each element
+ * follows that of the interface manual, with values carried as
+ * fixed-point integers: distances are in millimetres and
+ * angles in thousandths of a degree.
+ */
+typedef struct {
+    uint32_t present;      /**< bit N is set if field N of the sentence
+                                (the address field being field 0,
+                                the field numbering being as in
+                                the interface manual) was neither
+                                empty nor corrupt (e.g. holding a
+                                number too long to decode); a member
+                                populated from such a field will
+                                be zero. */
+    uint8_t hour;          /**< UTC hour, 0 to 23 (field 1). */
+    uint8_t min;           /**< UTC minute, 0 to 59 (field 1). */
+    uint8_t sec;           /**< UTC second, 0 to 60 (field 1). */
+    uint16_t millisecond;  /**< UTC millisecond, 0 to 999 (field 1). */
+    uint32_t rangeRms;     /**< RMS value of the standard deviation
+                                of the ranges in millimetres
+                                (field 2). */
+    uint32_t stdMajor;     /**< standard deviation of the semi-major
+                                axis in millimetres (field 3). */
+    uint32_t stdMinor;     /**< standard deviation of the semi-minor
+                                axis in millimetres (field 4). */
+    uint32_t orient;       /**< orientation of the semi-major axis
+                                in thousandths of a degree (field 5). */
+    uint32_t stdLat;       /**< standard deviation of latitude error
+                                in millimetres (field 6). */
+    uint32_t stdLong;      /**< standard deviation of longitude error
+                                in millimetres (field 7). */
+    uint32_t stdAlt;       /**< standard deviation of altitude error
+                                in millimetres (field 8). */
+} uGnssDecNmeaGst_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_DEC_NMEA_GST_H_
+
+// End of file
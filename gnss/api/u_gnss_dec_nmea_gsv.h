@@ -0,0 +1,102 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_DEC_NMEA_GSV_H_
+#define _U_GNSS_DEC_NMEA_GSV_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the types of an NMEA GSV
+ * sentence, satellites in view.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The sentence formatter of an NMEA GSV sentence, i.e. the
+ * address field without the two-character talker ID.
+ */
+#define U_GNSS_DEC_NMEA_GSV_SENTENCE_FORMATTER "GSV"
+
+/** The maximum number of satellites in a single NMEA GSV sentence.
+ */
+#define U_GNSS_DEC_NMEA_GSV_SV_MAX_NUM 4
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A satellite in an NMEA GSV sentence.
+ */
+typedef struct {
+    uint16_t svid;         /**< the satellite ID. */
+    int8_t elv;            /**< elevation in degrees, -90 to 90. */
+    uint16_t az;           /**< azimuth in degrees, 0 to 359. */
+    uint8_t cno;           /**< carrier to noise ratio in dBHz, 0 to 99. */
+} uGnssDecNmeaGsvSv_t;
+
+/** NMEA GSV sentence structure; the naming of each element
+ * follows that of the interface manual, with values carried as
+ * fixed-point integers; a full set of satellites in view is
+ * spread across numMsg GSV sentences, each carrying up to
+ * #U_GNSS_DEC_NMEA_GSV_SV_MAX_NUM satellites.  Which satellites
+ * are present in this sentence may be determined from the
+ * present bit-map: satellite n of this sentence (counting from
+ * zero) is present if bit 4 + (n * 4) is set.
+ */
+typedef struct {
+    uint32_t present;      /**< bit N is set if field N of the sentence
+                                (the address field being field 0,
+                                the field numbering being as in
+                                the interface manual) was neither
+                                empty nor corrupt (e.g. holding a
+                                number too long to decode); a member
+                                populated from such a field will
+                                be zero. */
+    uint8_t numMsg;        /**< the number of GSV sentences in the
+                                set (field 1). */
+    uint8_t msgNum;        /**< the number of this sentence in the
+                                set, starting at 1 (field 2). */
+    uint8_t numSV;         /**< the total number of satellites in view
+                                (field 3). */
+    uGnssDecNmeaGsvSv_t sv[U_GNSS_DEC_NMEA_GSV_SV_MAX_NUM]; /**< the
+                                                                 satellites
+                                                                 (fields 4
+                                                                 to 19). */
+} uGnssDecNmeaGsv_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_DEC_NMEA_GSV_H_
+
+// End of file
@@ -0,0 +1,86 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_DEC_NMEA_VTG_H_
+#define _U_GNSS_DEC_NMEA_VTG_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the types of an NMEA VTG
+ * sentence, course over ground and ground speed.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The sentence formatter of an NMEA VTG sentence, i.e. the
+ * address field without the two-character talker ID.
+ */
+#define U_GNSS_DEC_NMEA_VTG_SENTENCE_FORMATTER "VTG"
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** NMEA VTG sentence structure; the naming of each element
+ * follows that of the interface manual, with values carried as
+ * fixed-point integers: angles are in thousandths of a
+ * degree and speeds in thousandths of the stated unit.
+ */
+typedef struct {
+    uint32_t present;      /**< bit N is set if field N of the sentence
+                                (the address field being field 0,
+                                the field numbering being as in
+                                the interface manual) was neither
+                                empty nor corrupt (e.g. holding a
+                                number too long to decode); a member
+                                populated from such a field will
+                                be zero. */
+    uint32_t cogt;         /**< course over ground (true) in
+                                thousandths of a degree (field 1). */
+    uint32_t cogm;         /**< course over ground (magnetic) in
+                                thousandths of a degree (field 3). */
+    uint32_t sogn;         /**< speed over ground in thousandths
+                                of a knot (field 5). */
+    uint32_t sogk;         /**< speed over ground in metres per
+                                hour, i.e. thousandths of a km/h
+                                (field 7). */
+    char posMode;          /**< the position mode, e.g. 'A' for
+                                autonomous, 'N' for no fix (field 9). */
+} uGnssDecNmeaVtg_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_DEC_NMEA_VTG_H_
+
+// End of file
@@ -0,0 +1,85 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_DEC_NMEA_ZDA_H_
+#define _U_GNSS_DEC_NMEA_ZDA_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the types of an NMEA ZDA
+ * sentence, time and date.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The sentence formatter of an NMEA ZDA sentence, i.e. the
+ * address field without the two-character talker ID.
+ */
+#define U_GNSS_DEC_NMEA_ZDA_SENTENCE_FORMATTER "ZDA"
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** NMEA ZDA sentence structure; the naming of each element
+ * follows that of the interface manual, with values carried as
+ * fixed-point integers.
+ */
+typedef struct {
+    uint32_t present;      /**< bit N is set if field N of the sentence
+                                (the address field being field 0,
+                                the field numbering being as in
+                                the interface manual) was neither
+                                empty nor corrupt (e.g. holding a
+                                number too long to decode); a member
+                                populated from such a field will
+                                be zero. */
+    uint8_t hour;          /**< UTC hour, 0 to 23 (field 1). */
+    uint8_t min;           /**< UTC minute, 0 to 59 (field 1). */
+    uint8_t sec;           /**< UTC second, 0 to 60 (field 1). */
+    uint16_t millisecond;  /**< UTC millisecond, 0 to 999 (field 1). */
+    uint8_t day;           /**< UTC day of the month, 1 to 31 (field 2). */
+    uint8_t month;         /**< UTC month, 1 to 12 (field 3). */
+    uint16_t year;         /**< UTC year, e.g. 2024 (field 4). */
+    int8_t ltzh;           /**< local time zone hours, always 0
+                                (field 5). */
+    uint8_t ltzn;          /**< local time zone minutes, always 0
+                                (field 6). */
+} uGnssDecNmeaZda_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_DEC_NMEA_ZDA_H_
+
+// End of file
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_DEC_UBX_ESF_MEAS_H_
+#define _U_GNSS_DEC_UBX_ESF_MEAS_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the types of a UBX-ESF-MEAS
+ * message.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The message class of a UBX-ESF-MEAS message.
+ */
+#define U_GNSS_DEC_UBX_ESF_MEAS_MESSAGE_CLASS 0x10
+
+/** The message ID of a UBX-ESF-MEAS message.
+ */
+#define U_GNSS_DEC_UBX_ESF_MEAS_MESSAGE_ID 0x02
+
+/** The minimum length of the body of a UBX-ESF-MEAS message.
+ */
+#define U_GNSS_DEC_UBX_ESF_MEAS_BODY_MIN_LENGTH 8
+
+#ifndef U_GNSS_DEC_UBX_ESF_MEAS_DATA_MAX_NUM
+/** The maximum number of measurements that will be decoded from a
+ * UBX-ESF-MEAS message; the message can carry no more than 31.
+ */
+# define U_GNSS_DEC_UBX_ESF_MEAS_DATA_MAX_NUM 31
+#endif
+
+/** Bit mask for the #U_GNSS_DEC_UBX_ESF_MEAS_FLAGS_TIME_MARK_SENT
+ * field of #uGnssDecUbxEsfMeasFlags_t.
+ */
+#define U_GNSS_DEC_UBX_ESF_MEAS_FLAGS_TIME_MARK_SENT_MASK (0x03 << U_GNSS_DEC_UBX_ESF_MEAS_FLAGS_TIME_MARK_SENT)
+
+/** Bit mask for the #U_GNSS_DEC_UBX_ESF_MEAS_FLAGS_NUM_MEAS
+ * field of #uGnssDecUbxEsfMeasFlags_t.
+ */
+#define U_GNSS_DEC_UBX_ESF_MEAS_FLAGS_NUM_MEAS_MASK (0x1f << U_GNSS_DEC_UBX_ESF_MEAS_FLAGS_NUM_MEAS)
+
+/** Bit mask for the #U_GNSS_DEC_UBX_ESF_MEAS_DATA_FIELD field of
+ * an entry in the "data" array of #uGnssDecUbxEsfMeas_t; the
+ * value is a 24-bit signed integer.
+ */
+#define U_GNSS_DEC_UBX_ESF_MEAS_DATA_FIELD_MASK (0x00ffffffUL << U_GNSS_DEC_UBX_ESF_MEAS_DATA_FIELD)
+
+/** Bit mask for the #U_GNSS_DEC_UBX_ESF_MEAS_DATA_TYPE field of
+ * an entry in the "data" array of #uGnssDecUbxEsfMeas_t.
+ */
+#define U_GNSS_DEC_UBX_ESF_MEAS_DATA_TYPE_MASK (0x3fUL << U_GNSS_DEC_UBX_ESF_MEAS_DATA_TYPE)
+
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Bit fields of the "flags" field of #uGnssDecUbxEsfMeas_t; use
+ * these to mask specific bits, e.g.
+ *
+ * `if (flags & (1 << U_GNSS_DEC_UBX_ESF_MEAS_FLAGS_CALIB_TTAG_VALID)) {`
+ *
+ * ...would determine if the calibTtag field is valid.
+ */
+typedef enum {
+    U_GNSS_DEC_UBX_ESF_MEAS_FLAGS_TIME_MARK_SENT = 0,    /**< not a single bit,
+                                                              the start of a 2-bit
+                                                              field, use
+                                                              #U_GNSS_DEC_UBX_ESF_MEAS_FLAGS_TIME_MARK_SENT_MASK
+                                                              to mask it: 0 means
+                                                              none, 1 on ext0,
+                                                              2 on ext1. */
+    U_GNSS_DEC_UBX_ESF_MEAS_FLAGS_TIME_MARK_EDGE = 2,    /**< set for a falling
+                                                              edge, else rising. */
+    U_GNSS_DEC_UBX_ESF_MEAS_FLAGS_CALIB_TTAG_VALID = 3,  /**< the calibTtag
+                                                              field is valid. */
+    U_GNSS_DEC_UBX_ESF_MEAS_FLAGS_NUM_MEAS = 11          /**< not a single bit,
+                                                              the start of a 5-bit
+                                                              field, use
+                                                              #U_GNSS_DEC_UBX_ESF_MEAS_FLAGS_NUM_MEAS_MASK
+                                                              to mask it: the
+                                                              number of measurements
+                                                              in the message. */
+} uGnssDecUbxEsfMeasFlags_t;
+
+/** Bit fields of an entry in the "data" array of
+ * #uGnssDecUbxEsfMeas_t.
+ */
+typedef enum {
+    U_GNSS_DEC_UBX_ESF_MEAS_DATA_FIELD = 0, /**< not a single bit,
+                                                 the start of a 24-bit
+                                                 field, use
+                                                 #U_GNSS_DEC_UBX_ESF_MEAS_DATA_FIELD_MASK
+                                                 to mask it: the data,
+                                                 a signed value. */
+    U_GNSS_DEC_UBX_ESF_MEAS_DATA_TYPE = 24  /**< not a single bit,
+                                                 the start of a 6-bit
+                                                 field, use
+                                                 #U_GNSS_DEC_UBX_ESF_MEAS_DATA_TYPE_MASK
+                                                 to mask it: the type
+                                                 of the data, as listed
+                                                 in the interface manual,
+                                                 e.g. 5 for z-axis gyro
+                                                 angular rate. */
+} uGnssDecUbxEsfMeasData_t;
+
+/** UBX-ESF-MEAS message structure; the naming and type of each
+ * element follows that of the interface manual.
+ */
+typedef struct {
+    uint32_t timeTag;   /**< time tag of the measurement, from
+                             the external sensor. */
+    uint16_t flags;     /**< see #uGnssDecUbxEsfMeasFlags_t; this
+                             includes the number of measurements
+                             in the message, only the first
+                             #U_GNSS_DEC_UBX_ESF_MEAS_DATA_MAX_NUM of
+                             which will be in data. */
+    uint16_t id;        /**< identification number of the data
+                             provider. */
+    uint32_t data[U_GNSS_DEC_UBX_ESF_MEAS_DATA_MAX_NUM]; /**< the measurements,
+                                                              see
+                                                              #uGnssDecUbxEsfMeasData_t. */
+    uint32_t calibTtag; /**< receiver local time calibrated, in
+                             milliseconds; only valid if the
+                             #U_GNSS_DEC_UBX_ESF_MEAS_FLAGS_CALIB_TTAG_VALID
+                             bit of flags is set. */
+} uGnssDecUbxEsfMeas_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_DEC_UBX_ESF_MEAS_H_
+
+// End of file
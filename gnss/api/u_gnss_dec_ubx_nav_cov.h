@@ -0,0 +1,95 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_DEC_UBX_NAV_COV_H_
+#define _U_GNSS_DEC_UBX_NAV_COV_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the types of a UBX-NAV-COV
+ * message.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The message class of a UBX-NAV-COV message.
+ */
+#define U_GNSS_DEC_UBX_NAV_COV_MESSAGE_CLASS 0x01
+
+/** The message ID of a UBX-NAV-COV message.
+ */
+#define U_GNSS_DEC_UBX_NAV_COV_MESSAGE_ID 0x36
+
+/** The minimum length of the body of a UBX-NAV-COV message.
+ */
+#define U_GNSS_DEC_UBX_NAV_COV_BODY_MIN_LENGTH 64
+
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** UBX-NAV-COV message structure; the naming and type of each
+ * element follows that of the interface manual.  The covariance
+ * matrices are symmetric, hence only the upper triangle of each
+ * is present, in the north/east/down frame.
+ */
+typedef struct {
+    uint32_t iTOW;       /**< GPS time of week of the navigation epoch
+                              in milliseconds. */
+    uint8_t version;     /**< message version. */
+    uint8_t posCovValid; /**< non-zero if the position covariance
+                              matrix is valid. */
+    uint8_t velCovValid; /**< non-zero if the velocity covariance
+                              matrix is valid. */
+    // 9 reserved bytes here
+    float posCovNN;      /**< position covariance north-north in m^2. */
+    float posCovNE;      /**< position covariance north-east in m^2. */
+    float posCovND;      /**< position covariance north-down in m^2. */
+    float posCovEE;      /**< position covariance east-east in m^2. */
+    float posCovED;      /**< position covariance east-down in m^2. */
+    float posCovDD;      /**< position covariance down-down in m^2. */
+    float velCovNN;      /**< velocity covariance north-north in m^2/s^2. */
+    float velCovNE;      /**< velocity covariance north-east in m^2/s^2. */
+    float velCovND;      /**< velocity covariance north-down in m^2/s^2. */
+    float velCovEE;      /**< velocity covariance east-east in m^2/s^2. */
+    float velCovED;      /**< velocity covariance east-down in m^2/s^2. */
+    float velCovDD;      /**< velocity covariance down-down in m^2/s^2. */
+} uGnssDecUbxNavCov_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_DEC_UBX_NAV_COV_H_
+
+// End of file
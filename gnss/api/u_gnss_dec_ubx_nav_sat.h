@@ -0,0 +1,190 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_DEC_UBX_NAV_SAT_H_
+#define _U_GNSS_DEC_UBX_NAV_SAT_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the types of a UBX-NAV-SAT
+ * message.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The message class of a UBX-NAV-SAT message.
+ */
+#define U_GNSS_DEC_UBX_NAV_SAT_MESSAGE_CLASS 0x01
+
+/** The message ID of a UBX-NAV-SAT message.
+ */
+#define U_GNSS_DEC_UBX_NAV_SAT_MESSAGE_ID 0x35
+
+/** The minimum length of the body of a UBX-NAV-SAT message.
+ */
+#define U_GNSS_DEC_UBX_NAV_SAT_BODY_MIN_LENGTH 8
+
+#ifndef U_GNSS_DEC_UBX_NAV_SAT_SV_MAX_NUM
+/** The maximum number of satellites that will be decoded from a
+ * UBX-NAV-SAT message; the repeated blocks for any more satellites
+ * than this are ignored.
+ */
+# define U_GNSS_DEC_UBX_NAV_SAT_SV_MAX_NUM 64
+#endif
+
+/** Bit mask for the #U_GNSS_DEC_UBX_NAV_SAT_FLAGS_QUALITY_IND field
+ * of #uGnssDecUbxNavSatFlags_t.
+ */
+#define U_GNSS_DEC_UBX_NAV_SAT_FLAGS_QUALITY_IND_MASK (0x07UL << U_GNSS_DEC_UBX_NAV_SAT_FLAGS_QUALITY_IND)
+
+/** Bit mask for the #U_GNSS_DEC_UBX_NAV_SAT_FLAGS_HEALTH field
+ * of #uGnssDecUbxNavSatFlags_t.
+ */
+#define U_GNSS_DEC_UBX_NAV_SAT_FLAGS_HEALTH_MASK (0x03UL << U_GNSS_DEC_UBX_NAV_SAT_FLAGS_HEALTH)
+
+/** Bit mask for the #U_GNSS_DEC_UBX_NAV_SAT_FLAGS_ORBIT_SOURCE field
+ * of #uGnssDecUbxNavSatFlags_t.
+ */
+#define U_GNSS_DEC_UBX_NAV_SAT_FLAGS_ORBIT_SOURCE_MASK (0x07UL << U_GNSS_DEC_UBX_NAV_SAT_FLAGS_ORBIT_SOURCE)
+
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Bit fields of the "flags" field of #uGnssDecUbxNavSatSv_t; use
+ * these to mask specific bits, e.g.
+ *
+ * `if (flags & (1UL << U_GNSS_DEC_UBX_NAV_SAT_FLAGS_SV_USED)) {`
+ *
+ * ...would determine if the satellite is used for navigation.
+ */
+typedef enum {
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_QUALITY_IND = 0,       /**< not a single bit,
+                                                             the start of a 3-bit
+                                                             field, use
+                                                             #U_GNSS_DEC_UBX_NAV_SAT_FLAGS_QUALITY_IND_MASK
+                                                             to mask it: 0 means
+                                                             no signal, 1 searching,
+                                                             2 acquired, 3 detected
+                                                             but unusable, 4 code
+                                                             locked and time
+                                                             synchronized, 5 to 7
+                                                             code and carrier locked
+                                                             and time synchronized. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_SV_USED = 3,           /**< the satellite is being
+                                                             used for navigation. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_HEALTH = 4,            /**< not a single bit,
+                                                             the start of a 2-bit
+                                                             field, use
+                                                             #U_GNSS_DEC_UBX_NAV_SAT_FLAGS_HEALTH_MASK
+                                                             to mask it: 0 means
+                                                             unknown, 1 healthy,
+                                                             2 unhealthy. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_DIFF_CORR = 6,         /**< differential correction
+                                                             data is available for
+                                                             this satellite. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_SMOOTHED = 7,          /**< carrier smoothed
+                                                             pseudorange is used. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_ORBIT_SOURCE = 8,      /**< not a single bit,
+                                                             the start of a 3-bit
+                                                             field, use
+                                                             #U_GNSS_DEC_UBX_NAV_SAT_FLAGS_ORBIT_SOURCE_MASK
+                                                             to mask it: 0 means
+                                                             no orbit information,
+                                                             1 ephemeris, 2 almanac,
+                                                             3 AssistNow Offline,
+                                                             4 AssistNow Autonomous,
+                                                             5 to 7 other. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_EPH_AVAIL = 11,        /**< ephemeris is available. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_ALM_AVAIL = 12,        /**< almanac is available. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_ANO_AVAIL = 13,        /**< AssistNow Offline data
+                                                             is available. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_AOP_AVAIL = 14,        /**< AssistNow Autonomous
+                                                             data is available. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_SBAS_CORR_USED = 16,   /**< SBAS corrections have
+                                                             been used. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_RTCM_CORR_USED = 17,   /**< RTCM corrections have
+                                                             been used. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_SLAS_CORR_USED = 18,   /**< QZSS SLAS corrections
+                                                             have been used. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_SPARTN_CORR_USED = 19, /**< SPARTN corrections have
+                                                             been used. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_PR_CORR_USED = 20,     /**< pseudorange corrections
+                                                             have been used. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_CR_CORR_USED = 21,     /**< carrier range corrections
+                                                             have been used. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_DO_CORR_USED = 22,     /**< range rate (Doppler)
+                                                             corrections have been
+                                                             used. */
+    U_GNSS_DEC_UBX_NAV_SAT_FLAGS_CLAS_CORR_USED = 23    /**< CLAS corrections have
+                                                             been used. */
+} uGnssDecUbxNavSatFlags_t;
+
+/** The repeated block of a UBX-NAV-SAT message, one per satellite.
+ */
+typedef struct {
+    uint8_t gnssId; /**< the GNSS identifier, as used in the
+                         interface manual, e.g. 0 for GPS. */
+    uint8_t svId;   /**< the satellite identifier. */
+    uint8_t cno;    /**< carrier to noise ratio in dBHz. */
+    int8_t elev;    /**< elevation in degrees, -90 to +90,
+                         unknown if out of range. */
+    int16_t azim;   /**< azimuth in degrees, 0 to 360, unknown
+                         if elevation is out of range. */
+    int16_t prRes;  /**< pseudorange residual in decimetres. */
+    uint32_t flags; /**< see #uGnssDecUbxNavSatFlags_t. */
+} uGnssDecUbxNavSatSv_t;
+
+/** UBX-NAV-SAT message structure; the naming and type of each
+ * element follows that of the interface manual.
+ */
+typedef struct {
+    uint32_t iTOW;   /**< GPS time of week of the navigation epoch
+                          in milliseconds. */
+    uint8_t version; /**< message version. */
+    uint8_t numSvs;  /**< the number of satellites in the message;
+                          only the first
+                          #U_GNSS_DEC_UBX_NAV_SAT_SV_MAX_NUM of them
+                          will be in sv. */
+    // 2 reserved bytes here
+    uGnssDecUbxNavSatSv_t sv[U_GNSS_DEC_UBX_NAV_SAT_SV_MAX_NUM]; /**< the
+                                                                      satellites. */
+} uGnssDecUbxNavSat_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_DEC_UBX_NAV_SAT_H_
+
+// End of file
@@ -0,0 +1,177 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_DEC_UBX_NAV_SIG_H_
+#define _U_GNSS_DEC_UBX_NAV_SIG_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the types of a UBX-NAV-SIG
+ * message.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The message class of a UBX-NAV-SIG message.
+ */
+#define U_GNSS_DEC_UBX_NAV_SIG_MESSAGE_CLASS 0x01
+
+/** The message ID of a UBX-NAV-SIG message.
+ */
+#define U_GNSS_DEC_UBX_NAV_SIG_MESSAGE_ID 0x43
+
+/** The minimum length of the body of a UBX-NAV-SIG message.
+ */
+#define U_GNSS_DEC_UBX_NAV_SIG_BODY_MIN_LENGTH 8
+
+#ifndef U_GNSS_DEC_UBX_NAV_SIG_SIG_MAX_NUM
+/** The maximum number of signals that will be decoded from a
+ * UBX-NAV-SIG message; the repeated blocks for any more signals
+ * than this are ignored.
+ */
+# define U_GNSS_DEC_UBX_NAV_SIG_SIG_MAX_NUM 96
+#endif
+
+/** Bit mask for the #U_GNSS_DEC_UBX_NAV_SIG_SIG_FLAGS_HEALTH field
+ * of #uGnssDecUbxNavSigSigFlags_t.
+ */
+#define U_GNSS_DEC_UBX_NAV_SIG_SIG_FLAGS_HEALTH_MASK (0x03 << U_GNSS_DEC_UBX_NAV_SIG_SIG_FLAGS_HEALTH)
+
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Possible values of the "qualityInd" field of #uGnssDecUbxNavSigSig_t.
+ */
+typedef enum {
+    U_GNSS_DEC_UBX_NAV_SIG_QUALITY_IND_NO_SIGNAL = 0,
+    U_GNSS_DEC_UBX_NAV_SIG_QUALITY_IND_SEARCHING = 1,
+    U_GNSS_DEC_UBX_NAV_SIG_QUALITY_IND_ACQUIRED = 2,
+    U_GNSS_DEC_UBX_NAV_SIG_QUALITY_IND_UNUSABLE = 3,
+    U_GNSS_DEC_UBX_NAV_SIG_QUALITY_IND_CODE_LOCKED = 4,
+    U_GNSS_DEC_UBX_NAV_SIG_QUALITY_IND_CODE_AND_CARRIER_LOCKED_1 = 5,
+    U_GNSS_DEC_UBX_NAV_SIG_QUALITY_IND_CODE_AND_CARRIER_LOCKED_2 = 6,
+    U_GNSS_DEC_UBX_NAV_SIG_QUALITY_IND_CODE_AND_CARRIER_LOCKED_3 = 7
+} uGnssDecUbxNavSigQualityInd_t;
+
+/** Possible values of the "corrSource" field of #uGnssDecUbxNavSigSig_t.
+ */
+typedef enum {
+    U_GNSS_DEC_UBX_NAV_SIG_CORR_SOURCE_NONE = 0,
+    U_GNSS_DEC_UBX_NAV_SIG_CORR_SOURCE_SBAS = 1,
+    U_GNSS_DEC_UBX_NAV_SIG_CORR_SOURCE_BEIDOU = 2,
+    U_GNSS_DEC_UBX_NAV_SIG_CORR_SOURCE_RTCM2 = 3,
+    U_GNSS_DEC_UBX_NAV_SIG_CORR_SOURCE_RTCM3_OSR = 4,
+    U_GNSS_DEC_UBX_NAV_SIG_CORR_SOURCE_RTCM3_SSR = 5,
+    U_GNSS_DEC_UBX_NAV_SIG_CORR_SOURCE_QZSS_SLAS = 6,
+    U_GNSS_DEC_UBX_NAV_SIG_CORR_SOURCE_SPARTN = 7,
+    U_GNSS_DEC_UBX_NAV_SIG_CORR_SOURCE_CLAS = 8
+} uGnssDecUbxNavSigCorrSource_t;
+
+/** Bit fields of the "sigFlags" field of #uGnssDecUbxNavSigSig_t; use
+ * these to mask specific bits, e.g.
+ *
+ * `if (sigFlags & (1 << U_GNSS_DEC_UBX_NAV_SIG_SIG_FLAGS_PR_USED)) {`
+ *
+ * ...would determine if the pseudorange of the signal is used for
+ * navigation.
+ */
+typedef enum {
+    U_GNSS_DEC_UBX_NAV_SIG_SIG_FLAGS_HEALTH = 0,       /**< not a single bit,
+                                                            the start of a 2-bit
+                                                            field, use
+                                                            #U_GNSS_DEC_UBX_NAV_SIG_SIG_FLAGS_HEALTH_MASK
+                                                            to mask it: 0 means
+                                                            unknown, 1 healthy,
+                                                            2 unhealthy. */
+    U_GNSS_DEC_UBX_NAV_SIG_SIG_FLAGS_PR_SMOOTHED = 2,  /**< the pseudorange has
+                                                            been smoothed. */
+    U_GNSS_DEC_UBX_NAV_SIG_SIG_FLAGS_PR_USED = 3,      /**< the pseudorange has
+                                                            been used. */
+    U_GNSS_DEC_UBX_NAV_SIG_SIG_FLAGS_CR_USED = 4,      /**< carrier range has
+                                                            been used. */
+    U_GNSS_DEC_UBX_NAV_SIG_SIG_FLAGS_DO_USED = 5,      /**< range rate (Doppler)
+                                                            has been used. */
+    U_GNSS_DEC_UBX_NAV_SIG_SIG_FLAGS_PR_CORR_USED = 6, /**< pseudorange corrections
+                                                            have been used. */
+    U_GNSS_DEC_UBX_NAV_SIG_SIG_FLAGS_CR_CORR_USED = 7, /**< carrier range corrections
+                                                            have been used. */
+    U_GNSS_DEC_UBX_NAV_SIG_SIG_FLAGS_DO_CORR_USED = 8  /**< range rate (Doppler)
+                                                            corrections have been
+                                                            used. */
+} uGnssDecUbxNavSigSigFlags_t;
+
+/** The repeated block of a UBX-NAV-SIG message, one per signal.
+ */
+typedef struct {
+    uint8_t gnssId;     /**< the GNSS identifier, as used in the
+                             interface manual, e.g. 0 for GPS. */
+    uint8_t svId;       /**< the satellite identifier. */
+    uint8_t sigId;      /**< the signal identifier, as used in
+                             the interface manual. */
+    uint8_t freqId;     /**< GLONASS frequency slot + 7, only
+                             valid for GLONASS. */
+    int16_t prRes;      /**< pseudorange residual in decimetres. */
+    uint8_t cno;        /**< carrier to noise ratio in dBHz. */
+    uint8_t qualityInd; /**< see #uGnssDecUbxNavSigQualityInd_t. */
+    uint8_t corrSource; /**< see #uGnssDecUbxNavSigCorrSource_t. */
+    uint8_t ionoModel;  /**< ionospheric model used: 0 means
+                             none, 1 Klobuchar GPS, 2 SBAS,
+                             3 Klobuchar BeiDou, 8 dual-frequency. */
+    uint16_t sigFlags;  /**< see #uGnssDecUbxNavSigSigFlags_t. */
+    // 4 reserved bytes here
+} uGnssDecUbxNavSigSig_t;
+
+/** UBX-NAV-SIG message structure; the naming and type of each
+ * element follows that of the interface manual.
+ */
+typedef struct {
+    uint32_t iTOW;   /**< GPS time of week of the navigation epoch
+                          in milliseconds. */
+    uint8_t version; /**< message version. */
+    uint8_t numSigs; /**< the number of signals in the message;
+                          only the first
+                          #U_GNSS_DEC_UBX_NAV_SIG_SIG_MAX_NUM of them
+                          will be in sig. */
+    // 2 reserved bytes here
+    uGnssDecUbxNavSigSig_t sig[U_GNSS_DEC_UBX_NAV_SIG_SIG_MAX_NUM]; /**< the
+                                                                         signals. */
+} uGnssDecUbxNavSig_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_DEC_UBX_NAV_SIG_H_
+
+// End of file
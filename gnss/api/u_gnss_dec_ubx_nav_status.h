@@ -0,0 +1,184 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_DEC_UBX_NAV_STATUS_H_
+#define _U_GNSS_DEC_UBX_NAV_STATUS_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup _GNSS
+ *  @{
+ */
+
+/** @file
+ * @brief This header file defines the types of a UBX-NAV-STATUS
+ * message.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The message class of a UBX-NAV-STATUS message.
+ */
+#define U_GNSS_DEC_UBX_NAV_STATUS_MESSAGE_CLASS 0x01
+
+/** The message ID of a UBX-NAV-STATUS message.
+ */
+#define U_GNSS_DEC_UBX_NAV_STATUS_MESSAGE_ID 0x03
+
+/** The minimum length of the body of a UBX-NAV-STATUS message.
+ */
+#define U_GNSS_DEC_UBX_NAV_STATUS_BODY_MIN_LENGTH 16
+
+/** Bit mask for the #U_GNSS_DEC_UBX_NAV_STATUS_FIX_STAT_MAP_MATCHING
+ * field of #uGnssDecUbxNavStatusFixStat_t.
+ */
+#define U_GNSS_DEC_UBX_NAV_STATUS_FIX_STAT_MAP_MATCHING_MASK (0x03 << U_GNSS_DEC_UBX_NAV_STATUS_FIX_STAT_MAP_MATCHING)
+
+/** Bit mask for the #U_GNSS_DEC_UBX_NAV_STATUS_FLAGS2_PSM_STATE
+ * field of #uGnssDecUbxNavStatusFlags2_t.
+ */
+#define U_GNSS_DEC_UBX_NAV_STATUS_FLAGS2_PSM_STATE_MASK (0x03 << U_GNSS_DEC_UBX_NAV_STATUS_FLAGS2_PSM_STATE)
+
+/** Bit mask for the #U_GNSS_DEC_UBX_NAV_STATUS_FLAGS2_SPOOF_DET_STATE
+ * field of #uGnssDecUbxNavStatusFlags2_t.
+ */
+#define U_GNSS_DEC_UBX_NAV_STATUS_FLAGS2_SPOOF_DET_STATE_MASK (0x03 << U_GNSS_DEC_UBX_NAV_STATUS_FLAGS2_SPOOF_DET_STATE)
+
+/** Bit mask for the #U_GNSS_DEC_UBX_NAV_STATUS_FLAGS2_CARR_SOLN
+ * field of #uGnssDecUbxNavStatusFlags2_t.
+ */
+#define U_GNSS_DEC_UBX_NAV_STATUS_FLAGS2_CARR_SOLN_MASK (0x03 << U_GNSS_DEC_UBX_NAV_STATUS_FLAGS2_CARR_SOLN)
+
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Possible values of the "gpsFix" field of #uGnssDecUbxNavStatus_t.
+ */
+typedef enum {
+    U_GNSS_DEC_UBX_NAV_STATUS_GPS_FIX_NO_FIX = 0,
+    U_GNSS_DEC_UBX_NAV_STATUS_GPS_FIX_DEAD_RECKONING_ONLY = 1,
+    U_GNSS_DEC_UBX_NAV_STATUS_GPS_FIX_2D = 2,
+    U_GNSS_DEC_UBX_NAV_STATUS_GPS_FIX_3D = 3,
+    U_GNSS_DEC_UBX_NAV_STATUS_GPS_FIX_GPS_PLUS_DEAD_RECKONING = 4,
+    U_GNSS_DEC_UBX_NAV_STATUS_GPS_FIX_TIME_ONLY = 5
+} uGnssDecUbxNavStatusGpsFix_t;
+
+/** Bit fields of the "flags" field of #uGnssDecUbxNavStatus_t; use
+ * these to mask specific bits, e.g.
+ *
+ * `if (flags & (1 << U_GNSS_DEC_UBX_NAV_STATUS_FLAGS_GPS_FIX_OK)) {`
+ *
+ * ...would determine if the fix is within the DOP and accuracy
+ * masks.
+ */
+typedef enum {
+    U_GNSS_DEC_UBX_NAV_STATUS_FLAGS_GPS_FIX_OK = 0, /**< position and
+                                                         velocity are valid
+                                                         and within the DOP
+                                                         and accuracy masks. */
+    U_GNSS_DEC_UBX_NAV_STATUS_FLAGS_DIFF_SOLN = 1,  /**< differential corrections
+                                                         were applied. */
+    U_GNSS_DEC_UBX_NAV_STATUS_FLAGS_WKN_SET = 2,    /**< week number is valid. */
+    U_GNSS_DEC_UBX_NAV_STATUS_FLAGS_TOW_SET = 3     /**< time of week is valid. */
+} uGnssDecUbxNavStatusFlags_t;
+
+/** Bit fields of the "fixStat" field of #uGnssDecUbxNavStatus_t.
+ */
+typedef enum {
+    U_GNSS_DEC_UBX_NAV_STATUS_FIX_STAT_DIFF_CORR = 0,     /**< differential
+                                                               corrections are
+                                                               available. */
+    U_GNSS_DEC_UBX_NAV_STATUS_FIX_STAT_CARR_SOLN_VALID = 1, /**< the carrSoln
+                                                                 field of flags2
+                                                                 is valid. */
+    U_GNSS_DEC_UBX_NAV_STATUS_FIX_STAT_MAP_MATCHING = 6   /**< not a single bit,
+                                                               the start of a 2-bit
+                                                               field, use
+                                                               #U_GNSS_DEC_UBX_NAV_STATUS_FIX_STAT_MAP_MATCHING_MASK
+                                                               to mask it: 0 means
+                                                               no map matching,
+                                                               1 valid but not used,
+                                                               2 valid and used,
+                                                               3 valid and used
+                                                               for dead reckoning. */
+} uGnssDecUbxNavStatusFixStat_t;
+
+/** Bit fields of the "flags2" field of #uGnssDecUbxNavStatus_t.
+ */
+typedef enum {
+    U_GNSS_DEC_UBX_NAV_STATUS_FLAGS2_PSM_STATE = 0,       /**< not a single bit,
+                                                               the start of a 2-bit
+                                                               field, use
+                                                               #U_GNSS_DEC_UBX_NAV_STATUS_FLAGS2_PSM_STATE_MASK
+                                                               to mask it: 0 means
+                                                               acquisition (or PSM
+                                                               disabled), 1 tracking,
+                                                               2 power optimized
+                                                               tracking, 3 inactive. */
+    U_GNSS_DEC_UBX_NAV_STATUS_FLAGS2_SPOOF_DET_STATE = 3, /**< not a single bit,
+                                                               the start of a 2-bit
+                                                               field, use
+                                                               #U_GNSS_DEC_UBX_NAV_STATUS_FLAGS2_SPOOF_DET_STATE_MASK
+                                                               to mask it: 0 means
+                                                               unknown/deactivated,
+                                                               1 no spoofing indicated,
+                                                               2 spoofing indicated,
+                                                               3 multiple spoofing
+                                                               indications. */
+    U_GNSS_DEC_UBX_NAV_STATUS_FLAGS2_CARR_SOLN = 6        /**< not a single bit,
+                                                               the start of a 2-bit
+                                                               field, use
+                                                               #U_GNSS_DEC_UBX_NAV_STATUS_FLAGS2_CARR_SOLN_MASK
+                                                               to mask it: 0 means
+                                                               no carrier phase range
+                                                               solution, 1 float,
+                                                               2 fixed. */
+} uGnssDecUbxNavStatusFlags2_t;
+
+/** UBX-NAV-STATUS message structure; the naming and type of each
+ * element follows that of the interface manual.
+ */
+typedef struct {
+    uint32_t iTOW;   /**< GPS time of week of the navigation epoch
+                          in milliseconds. */
+    uint8_t gpsFix;  /**< the fix type, see #uGnssDecUbxNavStatusGpsFix_t. */
+    uint8_t flags;   /**< see #uGnssDecUbxNavStatusFlags_t. */
+    uint8_t fixStat; /**< see #uGnssDecUbxNavStatusFixStat_t. */
+    uint8_t flags2;  /**< see #uGnssDecUbxNavStatusFlags2_t. */
+    uint32_t ttff;   /**< time to first fix in milliseconds. */
+    uint32_t msss;   /**< milliseconds since startup/reset. */
+} uGnssDecUbxNavStatus_t;
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_GNSS_DEC_UBX_NAV_STATUS_H_
+
+// End of file
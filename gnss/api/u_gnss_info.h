@@ -84,6 +84,28 @@ typedef struct {
     size_t rxSkippedBytes;        /**< the number of receive bytes skipped. */
 } uGnssCommunicationStats_t;
 
+/** SPI transport statistics, as seen by this MCU, counted from
+ * when the GNSS instance was added.
+ */
+typedef struct {
+    size_t transfers;              /**< the number of SPI transfers that
+                                        returned data, whether from polling
+                                        for data or from sending. */
+    size_t fillBytesDiscarded;     /**< the number of 0xFF fill bytes
+                                        thrown away. */
+    size_t usefulBytes;            /**< the number of bytes received that
+                                        were not fill. */
+    size_t usefulBytesPerTransfer; /**< usefulBytes divided by transfers. */
+    size_t readLength;             /**< the current length of the
+                                        read performed when polling for
+                                        data, which adapts between the
+                                        SPI fill threshold and
+                                        #U_GNSS_SPI_READ_LENGTH_MAX_BYTES
+                                        depending on how busy the GNSS
+                                        chip is; zero if there has not
+                                        yet been a poll. */
+} uGnssSpiStats_t;
+
 /* ----------------------------------------------------------------
  * FUNCTIONS
  * -------------------------------------------------------------- */
@@ -203,6 +225,20 @@ int32_t uGnssInfoGetCommunicationStats(uDeviceHandle_t gnssHandle,
                                        int32_t port,
                                        uGnssCommunicationStats_t *pStats);
 
+/** Get the statistics of an SPI transport as seen by this MCU; use
+ * this to check how much of the SPI bandwidth is spent clocking-in
+ * fill.  No communication with the GNSS chip is involved.
+ *
+ * @param gnssHandle  the handle of the GNSS instance.
+ * @param[out] pStats a pointer to a place to put the stats; cannot
+ *                    be NULL.
+ * @return            zero on success, else negative error code;
+ *                    #U_ERROR_COMMON_NOT_SUPPORTED if the transport
+ *                    is not SPI.
+ */
+int32_t uGnssInfoGetSpiStats(uDeviceHandle_t gnssHandle,
+                             uGnssSpiStats_t *pStats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -52,11 +52,11 @@ extern "C" {
 #endif
 
 #ifndef U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES
-/** A temporary buffer, used as a staging post to get stuff
- * from a streaming source (e.g. I2C or UART or SPI) into the
- * ring buffer; must be less than
- * #U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES - 1 but, since this
- * is just a "chunking" temporary buffer, a rather smaller
+/** The maximum amount of data read from a streaming source
+ * (e.g. I2C or UART or SPI) in one go; the data is read straight
+ * into the ring buffer, this just "chunks" it, hence the name
+ * is historical.  Must be less than
+ * #U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES - 1 but a rather smaller
  * value is usually a good idea anyway.
  */
 # define U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES (U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES / 8)
@@ -350,6 +350,13 @@ int32_t uGnssMsgReceive(uDeviceHandle_t gnssHandle,
  * transport, please instead open a Virtual Serial connection for
  * that case (see uCellMuxAddChannel()).
  *
+ * Note: on a UART or Virtual Serial transport the monitoring task
+ * is woken up by the "data received" event of the transport,
+ * provided no-one else has already set an event callback on it,
+ * so messages are delivered as soon as they arrive; on I2C or SPI
+ * the transport is polled, unless a Data Ready pin has been set
+ * with uGnssMsgSetDataReady().
+ *
  * Note: if you wish to capture multiple message IDs, e.g. "G?GGA"
  * and "G?RMC", then you should make a call to uGnssMsgReceiveStart()
  * for both message IDs, which could be with the same pCallback, (don't
@@ -88,6 +88,20 @@
 # define U_GNSS_SPI_FILL_THRESHOLD_MAX 128
 #endif
 
+#ifndef U_GNSS_SPI_READ_LENGTH_MAX_BYTES
+/** The maximum number of bytes that will be read from a GNSS
+ * chip on an SPI transport when checking for received data; the
+ * read length starts at the SPI fill threshold (see
+ * uGnssSetSpiFillThreshold()), grows while data is flowing, up to
+ * this limit, and drops back to the fill threshold when the GNSS
+ * chip has nothing to send, so that kilobytes of 0xFF fill are not
+ * clocked in when the GNSS chip is idle.  The read is performed in
+ * chunks of up to #U_GNSS_SPI_FILL_THRESHOLD_MAX bytes, so this
+ * does not affect stack usage.
+ */
+# define U_GNSS_SPI_READ_LENGTH_MAX_BYTES 512
+#endif
+
 /** There can be an inverter in-line between an MCU pin
  * and whatever enables power to the GNSS chip or determines
  * that the GNSS chip has data for this MCU to read; OR this value
@@ -60,6 +60,7 @@
 #include "u_gnss_geofence.h"
 
 #include "u_gnss_private.h"
+#include "u_gnss_capture_private.h"
 
 // The headers below are necessary to work around an Espressif linker problem, see uGnssInit()
 #include "u_gnss_pos.h" // For uGnssPosPrivateLink()
@@ -168,6 +169,8 @@ static void deleteGnssInstance(uGnssPrivateInstance_t *pInstance)
             uGnssPrivateCleanUpStreamedPos(pInstance);
             // Stop asynchronus message receive from happening
             uGnssPrivateStopMsgReceive(pInstance);
+            // Stop any capture; nothing is reading now
+            uGnssCapturePrivateCleanUp(pInstance);
             // Free the SPI buffer, if there is one
             if (pInstance->pSpiRingBuffer != NULL) {
                 uRingBufferDelete(pInstance->pSpiRingBuffer);
@@ -179,8 +182,6 @@ static void deleteGnssInstance(uGnssPrivateInstance_t *pInstance)
                 uRingBufferDelete(&(pInstance->ringBuffer));
                 uPortFree(pInstance->pLinearBuffer);
             }
-            // This can go now too
-            uPortFree(pInstance->pTemporaryBuffer);
             // Unlink any geofences and free the fence context
             uGeofenceContextFree((uGeofenceContext_t **) &pInstance->pFenceContext);
             // Delete the transport mutex
@@ -425,52 +426,47 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                             // which we stream messages received from the module
                             pInstance->pLinearBuffer = (char *) pUPortMalloc(U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES);
                             if (pInstance->pLinearBuffer != NULL) {
-                                // Also need a temporary buffer to get stuff out
-                                // of the UART/I2C/SPI in the first place
-                                pInstance->pTemporaryBuffer = (char *) pUPortMalloc(U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES);
-                                if (pInstance->pTemporaryBuffer != NULL) {
-                                    // +2 below to keep one for ourselves and one for the
-                                    // blocking transparent receive function
-                                    errorCode = uRingBufferCreateWithReadHandle(&(pInstance->ringBuffer),
-                                                                                pInstance->pLinearBuffer,
-                                                                                U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES,
-                                                                                U_GNSS_MSG_RECEIVER_MAX_NUM + 2);
-                                    if (errorCode == 0) {
-                                        // No sneaky uRingBufferRead()'s allowed
-                                        uRingBufferSetReadRequiresHandle(&(pInstance->ringBuffer), true);
-                                        // Reserve a handle for us
+                                // +2 below to keep one for ourselves and one for the
+                                // blocking transparent receive function
+                                errorCode = uRingBufferCreateWithReadHandle(&(pInstance->ringBuffer),
+                                                                            pInstance->pLinearBuffer,
+                                                                            U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES,
+                                                                            U_GNSS_MSG_RECEIVER_MAX_NUM + 2);
+                                if (errorCode == 0) {
+                                    // No sneaky uRingBufferRead()'s allowed
+                                    uRingBufferSetReadRequiresHandle(&(pInstance->ringBuffer), true);
+                                    // Reserve a handle for us
+                                    errorCode = uRingBufferTakeReadHandle(&(pInstance->ringBuffer));
+                                    if (errorCode >= 0) {
+                                        pInstance->ringBufferReadHandlePrivate = errorCode;
+                                        // ...and one for uGnssMsgReceive()
                                         errorCode = uRingBufferTakeReadHandle(&(pInstance->ringBuffer));
                                         if (errorCode >= 0) {
-                                            pInstance->ringBufferReadHandlePrivate = errorCode;
-                                            // ...and one for uGnssMsgReceive()
-                                            errorCode = uRingBufferTakeReadHandle(&(pInstance->ringBuffer));
-                                            if (errorCode >= 0) {
-                                                pInstance->ringBufferReadHandleMsgReceive = errorCode;
-                                                if (pInstance->transportType == U_GNSS_TRANSPORT_SPI) {
-                                                    // Finally, if we are on SPI, we need a local receive
-                                                    // buffer to keep stuff that we receive while we are
-                                                    // just sending
-                                                    // +1 below since we lose one byte in the ring buffer implementation
-                                                    pInstance->pSpiLinearBuffer = (char *) pUPortMalloc(U_GNSS_SPI_BUFFER_LENGTH_BYTES + 1);
-                                                    if (pInstance->pSpiLinearBuffer != NULL) {
-                                                        pInstance->pSpiRingBuffer = (uRingBuffer_t *) pUPortMalloc(sizeof(uRingBuffer_t));
-                                                        if (pInstance->pSpiRingBuffer != NULL) {
-                                                            errorCode = uRingBufferCreate(pInstance->pSpiRingBuffer,
-                                                                                          pInstance->pSpiLinearBuffer,
-                                                                                          U_GNSS_SPI_BUFFER_LENGTH_BYTES + 1);
-                                                        }
-                                                    } else {
-                                                        uRingBufferDelete(&(pInstance->ringBuffer));
+                                            pInstance->ringBufferReadHandleMsgReceive = errorCode;
+                                            if (pInstance->transportType == U_GNSS_TRANSPORT_SPI) {
+                                                // Finally, if we are on SPI, we need a local receive
+                                                // buffer to keep stuff that we receive while we are
+                                                // just sending
+                                                // +1 below since we lose one byte in the ring buffer implementation
+                                                pInstance->pSpiLinearBuffer = (char *) pUPortMalloc(U_GNSS_SPI_BUFFER_LENGTH_BYTES + 1);
+                                                if (pInstance->pSpiLinearBuffer != NULL) {
+                                                    pInstance->pSpiRingBuffer = (uRingBuffer_t *) pUPortMalloc(sizeof(uRingBuffer_t));
+                                                    if (pInstance->pSpiRingBuffer != NULL) {
+                                                        errorCode = uRingBufferCreate(pInstance->pSpiRingBuffer,
+                                                                                      pInstance->pSpiLinearBuffer,
+                                                                                      U_GNSS_SPI_BUFFER_LENGTH_BYTES + 1);
                                                     }
                                                 } else {
-                                                    errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                                                    uRingBufferDelete(&(pInstance->ringBuffer));
                                                 }
                                             } else {
-                                                uRingBufferDelete(&(pInstance->ringBuffer));
+                                                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                                             }
                                         } else {
                                             uRingBufferDelete(&(pInstance->ringBuffer));
                                         }
+                                    } else {
+                                        uRingBufferDelete(&(pInstance->ringBuffer));
                                     }
                                 }
                             }
@@ -493,7 +489,6 @@ int32_t uGnssAdd(uGnssModuleType_t moduleType,
                             uRingBufferDelete(&(pInstance->ringBuffer));
                             uPortFree(pInstance->pLinearBuffer);
                         }
-                        uPortFree(pInstance->pTemporaryBuffer);
                         if (pInstance->transportMutex != NULL) {
                             uPortMutexDelete(pInstance->transportMutex);
                         }
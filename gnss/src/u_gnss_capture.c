@@ -0,0 +1,818 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Implementation of the capture and replay API for GNSS.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memcpy(), memcmp(), memset()
+
+#include "u_cfg_sw.h"
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_file.h"
+
+#include "u_at_client.h"
+
+#include "u_ubx_protocol.h"
+
+#include "u_interface.h"
+#include "u_device_serial.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss_private.h"
+#include "u_gnss_msg.h" // U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES
+#include "u_gnss_capture.h"
+#include "u_gnss_capture_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The maximum amount of data in one capture record, limited by
+ * the size of the length field.
+ */
+#define U_GNSS_CAPTURE_RECORD_LENGTH_MAX_BYTES 0xFFFF
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** Context for capture, hung off the GNSS instance.  Once allocated
+ * this is only freed when the GNSS instance is removed since the
+ * data path, uGnssPrivateStreamFillRingBuffer(), checks for it
+ * without locking gUGnssPrivateMutex.
+ */
+typedef struct {
+    uPortMutexHandle_t mutex; /**< protects everything below. */
+    volatile bool active; /**< true while capturing. */
+    void (*pCallback)(uDeviceHandle_t, const char *,
+                      size_t, void *); /**< the destination if not a file. */
+    void *pCallbackParam; /**< user parameter for pCallback. */
+    uPortFileHandle_t fileHandle; /**< the destination, if capturing to file. */
+    int32_t startTimeMs; /**< the tick time when capture started. */
+    int32_t errorCode; /**< the first error writing to file. */
+    size_t size; /**< the number of bytes captured. */
+} uGnssCapture_t;
+
+/** An entry in the index of a replay device.
+ */
+typedef struct {
+    size_t offset; /**< the offset of the record in the capture. */
+    uint32_t timeMs; /**< the time-stamp of the record. */
+} uGnssCaptureReplayIndex_t;
+
+/** The context of a replay device.
+ */
+typedef struct {
+    uPortMutexHandle_t mutex; /**< protects the replay position. */
+    const char *pCapture; /**< the capture. */
+    size_t size; /**< the size of the capture up to the end of the last complete record. */
+    size_t mapSize; /**< non-zero if pCapture was mapped by uPortFileMap(). */
+    bool realTime; /**< replay at capture speed. */
+    bool isOpen; /**< true if open() has been called. */
+    uGnssCaptureReplayIndex_t *pIndex; /**< one entry every #U_GNSS_CAPTURE_REPLAY_INDEX_STRIDE records. */
+    size_t indexLength; /**< the number of entries in pIndex. */
+    uint32_t durationMs; /**< the time-stamp of the last record. */
+    size_t offset; /**< the offset of the record being replayed. */
+    size_t offsetInRecord; /**< how much of the data of that record has been read. */
+    uint32_t replayStartTimeMs; /**< the capture time at which replay (re)started. */
+    int32_t tickStartMs; /**< the tick time at which replay (re)started. */
+} uGnssCaptureReplay_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: CAPTURE
+ * -------------------------------------------------------------- */
+
+// Write to the destination of a capture; pCapture->mutex
+// must be locked before this is called.
+static void captureWrite(uGnssCapture_t *pCapture, uDeviceHandle_t gnssHandle,
+                         const char *pData, size_t size)
+{
+    int32_t x;
+
+    if (pCapture->pCallback != NULL) {
+        pCapture->pCallback(gnssHandle, pData, size, pCapture->pCallbackParam);
+    } else if (pCapture->fileHandle != NULL) {
+        x = uPortFileWrite(pCapture->fileHandle, pData, size);
+        if ((x < 0) && (pCapture->errorCode == 0)) {
+            pCapture->errorCode = x;
+        }
+    }
+    pCapture->size += size;
+}
+
+// Stop a capture; pCapture->mutex must be locked before this
+// is called.
+static int32_t captureStop(uGnssCapture_t *pCapture)
+{
+    int32_t errorCodeOrSize;
+    int32_t x;
+
+    if (pCapture->active) {
+        pCapture->active = false;
+        if (pCapture->fileHandle != NULL) {
+            x = uPortFileClose(pCapture->fileHandle);
+            if ((x < 0) && (pCapture->errorCode == 0)) {
+                pCapture->errorCode = x;
+            }
+            pCapture->fileHandle = NULL;
+        }
+        pCapture->pCallback = NULL;
+        pCapture->pCallbackParam = NULL;
+    }
+
+    errorCodeOrSize = pCapture->errorCode;
+    if (errorCodeOrSize == 0) {
+        errorCodeOrSize = INT32_MAX;
+        if (pCapture->size < INT32_MAX) {
+            errorCodeOrSize = (int32_t) pCapture->size;
+        }
+    }
+
+    return errorCodeOrSize;
+}
+
+// Start a capture, either to pCallback or, if pFileName is
+// not NULL, to a file.
+static int32_t captureStart(uDeviceHandle_t gnssHandle,
+                            void (*pCallback)(uDeviceHandle_t,
+                                              const char *,
+                                              size_t, void *),
+                            void *pCallbackParam,
+                            const char *pFileName)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssCapture_t *pCapture;
+    char header[U_GNSS_CAPTURE_HEADER_LENGTH_BYTES] = U_GNSS_CAPTURE_MAGIC;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && ((pCallback != NULL) || (pFileName != NULL))) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (uGnssPrivateGetStreamType(pInstance->transportType) >= 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                if (pInstance->pCapture == NULL) {
+                    errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    pCapture = (uGnssCapture_t *) pUPortMalloc(sizeof(*pCapture));
+                    if (pCapture != NULL) {
+                        memset(pCapture, 0, sizeof(*pCapture));
+                        errorCode = uPortMutexCreate(&(pCapture->mutex));
+                        if (errorCode == 0) {
+                            pInstance->pCapture = (void *) pCapture;
+                        } else {
+                            uPortFree(pCapture);
+                        }
+                    }
+                }
+                if (errorCode == 0) {
+                    pCapture = (uGnssCapture_t *) pInstance->pCapture;
+
+                    U_PORT_MUTEX_LOCK(pCapture->mutex);
+
+                    captureStop(pCapture);
+                    pCapture->errorCode = 0;
+                    pCapture->size = 0;
+                    if (pFileName != NULL) {
+                        errorCode = uPortFileOpenWrite(&(pCapture->fileHandle), pFileName);
+                    } else {
+                        pCapture->pCallback = pCallback;
+                        pCapture->pCallbackParam = pCallbackParam;
+                    }
+                    if (errorCode == 0) {
+                        header[4] = U_GNSS_CAPTURE_VERSION;
+                        pCapture->startTimeMs = uPortGetTickTimeMs();
+                        captureWrite(pCapture, gnssHandle, header, sizeof(header));
+                        errorCode = pCapture->errorCode;
+                        if (errorCode == 0) {
+                            pCapture->active = true;
+                        } else {
+                            captureStop(pCapture);
+                        }
+                    } else {
+                        pCapture->fileHandle = NULL;
+                    }
+
+                    U_PORT_MUTEX_UNLOCK(pCapture->mutex);
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: REPLAY
+ * -------------------------------------------------------------- */
+
+// Get the time-stamp of the record at the given offset.
+static uint32_t recordTimeMs(const uGnssCaptureReplay_t *pReplay, size_t offset)
+{
+    return uUbxProtocolUint32Decode(pReplay->pCapture + offset);
+}
+
+// Get the data length of the record at the given offset.
+static size_t recordLength(const uGnssCaptureReplay_t *pReplay, size_t offset)
+{
+    return uUbxProtocolUint16Decode(pReplay->pCapture + offset + 4);
+}
+
+// Get the capture time up to which data may be replayed;
+// pReplay->mutex must be locked before this is called.
+static uint32_t replayNowMs(const uGnssCaptureReplay_t *pReplay)
+{
+    uint32_t nowMs = UINT32_MAX;
+
+    if (pReplay->realTime) {
+        nowMs = pReplay->replayStartTimeMs +
+                (uint32_t) (uPortGetTickTimeMs() - pReplay->tickStartMs);
+    }
+
+    return nowMs;
+}
+
+// Restart the replay clock from timeMs or, if the current record
+// is earlier than that, from the time of the current record, so
+// that the current record is never held back; pReplay->mutex must
+// be locked before this is called.
+static void replayClockRestart(uGnssCaptureReplay_t *pReplay, uint32_t timeMs)
+{
+    if ((pReplay->offset < pReplay->size) &&
+        (recordTimeMs(pReplay, pReplay->offset) < timeMs)) {
+        timeMs = recordTimeMs(pReplay, pReplay->offset);
+    }
+    pReplay->replayStartTimeMs = timeMs;
+    pReplay->tickStartMs = uPortGetTickTimeMs();
+}
+
+// Check the records of a capture and build the index; on return
+// pReplay->size will have been reduced to the end of the last
+// complete record.
+static int32_t replayIndexBuild(uGnssCaptureReplay_t *pReplay)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    size_t offset = U_GNSS_CAPTURE_HEADER_LENGTH_BYTES;
+    size_t records = 0;
+    size_t indexSpace = 0;
+    uGnssCaptureReplayIndex_t *pIndex;
+    uint32_t timeMs;
+
+    while ((offset + U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES <= pReplay->size) &&
+           (offset + U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES +
+            recordLength(pReplay, offset) <= pReplay->size) &&
+           (errorCode == 0)) {
+        timeMs = recordTimeMs(pReplay, offset);
+        if (timeMs < pReplay->durationMs) {
+            // Time can't go backwards, this can't be a capture
+            errorCode = (int32_t) U_ERROR_COMMON_BAD_DATA;
+        } else {
+            if ((records % U_GNSS_CAPTURE_REPLAY_INDEX_STRIDE) == 0) {
+                if (pReplay->indexLength >= indexSpace) {
+                    // Grow the index, doubling each time
+                    indexSpace = (indexSpace == 0) ? 64 : indexSpace * 2;
+                    pIndex = (uGnssCaptureReplayIndex_t *) pUPortMalloc(indexSpace *
+                                                                        sizeof(*pIndex));
+                    if (pIndex != NULL) {
+                        if (pReplay->pIndex != NULL) {
+                            memcpy(pIndex, pReplay->pIndex,
+                                   pReplay->indexLength * sizeof(*pIndex));
+                            uPortFree(pReplay->pIndex);
+                        }
+                        pReplay->pIndex = pIndex;
+                    } else {
+                        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+                    }
+                }
+                if (errorCode == 0) {
+                    pReplay->pIndex[pReplay->indexLength].offset = offset;
+                    pReplay->pIndex[pReplay->indexLength].timeMs = timeMs;
+                    pReplay->indexLength++;
+                }
+            }
+            pReplay->durationMs = timeMs;
+            offset += U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES + recordLength(pReplay, offset);
+            records++;
+        }
+    }
+
+    // Anything beyond here is a truncated record
+    pReplay->size = offset;
+
+    return errorCode;
+}
+
+// Move the replay position to the first record with a time-stamp
+// at or after timeMs; pReplay->mutex must be locked before this is
+// called.
+static void replaySeek(uGnssCaptureReplay_t *pReplay, uint32_t timeMs)
+{
+    size_t lower = 0;
+    size_t upper = pReplay->indexLength;
+    size_t middle;
+    size_t offset = U_GNSS_CAPTURE_HEADER_LENGTH_BYTES;
+
+    // Find the last index entry before timeMs
+    while (lower < upper) {
+        middle = lower + ((upper - lower) / 2);
+        if (pReplay->pIndex[middle].timeMs < timeMs) {
+            lower = middle + 1;
+        } else {
+            upper = middle;
+        }
+    }
+    if (lower > 0) {
+        offset = pReplay->pIndex[lower - 1].offset;
+    }
+    // Walk forward from there; this can be no more than
+    // U_GNSS_CAPTURE_REPLAY_INDEX_STRIDE records
+    while ((offset < pReplay->size) && (recordTimeMs(pReplay, offset) < timeMs)) {
+        offset += U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES + recordLength(pReplay, offset);
+    }
+
+    pReplay->offset = offset;
+    pReplay->offsetInRecord = 0;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: REPLAY SERIAL DEVICE
+ * -------------------------------------------------------------- */
+
+// Open the replay device: start the clock.
+static int32_t replayOpen(struct uDeviceSerial_t *pDeviceSerial,
+                          void *pReceiveBuffer,
+                          size_t receiveBufferSizeBytes)
+{
+    uGnssCaptureReplay_t *pReplay = (uGnssCaptureReplay_t *) pUInterfaceContext(pDeviceSerial);
+
+    (void) pReceiveBuffer;
+    (void) receiveBufferSizeBytes;
+
+    U_PORT_MUTEX_LOCK(pReplay->mutex);
+
+    replayClockRestart(pReplay, pReplay->durationMs);
+    pReplay->isOpen = true;
+
+    U_PORT_MUTEX_UNLOCK(pReplay->mutex);
+
+    return (int32_t) U_ERROR_COMMON_SUCCESS;
+}
+
+// Close the replay device.
+static void replayClose(struct uDeviceSerial_t *pDeviceSerial)
+{
+    uGnssCaptureReplay_t *pReplay = (uGnssCaptureReplay_t *) pUInterfaceContext(pDeviceSerial);
+
+    U_PORT_MUTEX_LOCK(pReplay->mutex);
+
+    pReplay->isOpen = false;
+
+    U_PORT_MUTEX_UNLOCK(pReplay->mutex);
+}
+
+// Get the amount of data that is due to be replayed; this
+// doesn't look further ahead than the GNSS code could take
+// in one go.
+static int32_t replayGetReceiveSize(struct uDeviceSerial_t *pDeviceSerial)
+{
+    uGnssCaptureReplay_t *pReplay = (uGnssCaptureReplay_t *) pUInterfaceContext(pDeviceSerial);
+    size_t size = 0;
+    size_t offset;
+    size_t offsetInRecord;
+    uint32_t nowMs;
+
+    U_PORT_MUTEX_LOCK(pReplay->mutex);
+
+    if (pReplay->isOpen) {
+        offset = pReplay->offset;
+        offsetInRecord = pReplay->offsetInRecord;
+        nowMs = replayNowMs(pReplay);
+        while ((offset < pReplay->size) &&
+               (size < U_GNSS_MSG_RING_BUFFER_LENGTH_BYTES) &&
+               (recordTimeMs(pReplay, offset) <= nowMs)) {
+            size += recordLength(pReplay, offset) - offsetInRecord;
+            offsetInRecord = 0;
+            offset += U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES + recordLength(pReplay, offset);
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(pReplay->mutex);
+
+    return (int32_t) size;
+}
+
+// Read data that is due to be replayed.
+static int32_t replayRead(struct uDeviceSerial_t *pDeviceSerial,
+                          void *pBuffer, size_t sizeBytes)
+{
+    uGnssCaptureReplay_t *pReplay = (uGnssCaptureReplay_t *) pUInterfaceContext(pDeviceSerial);
+    size_t readSize = 0;
+    size_t length;
+    size_t x;
+    uint32_t nowMs;
+
+    U_PORT_MUTEX_LOCK(pReplay->mutex);
+
+    if (pReplay->isOpen) {
+        nowMs = replayNowMs(pReplay);
+        while ((pReplay->offset < pReplay->size) && (readSize < sizeBytes) &&
+               (recordTimeMs(pReplay, pReplay->offset) <= nowMs)) {
+            length = recordLength(pReplay, pReplay->offset);
+            x = length - pReplay->offsetInRecord;
+            if (x > sizeBytes - readSize) {
+                x = sizeBytes - readSize;
+            }
+            memcpy(((char *) pBuffer) + readSize,
+                   pReplay->pCapture + pReplay->offset +
+                   U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES + pReplay->offsetInRecord,
+                   x);
+            readSize += x;
+            pReplay->offsetInRecord += x;
+            if (pReplay->offsetInRecord >= length) {
+                pReplay->offset += U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES + length;
+                pReplay->offsetInRecord = 0;
+            }
+        }
+    }
+
+    U_PORT_MUTEX_UNLOCK(pReplay->mutex);
+
+    return (int32_t) readSize;
+}
+
+// Write to the replay device: there's no-one to hear it.
+static int32_t replayWrite(struct uDeviceSerial_t *pDeviceSerial,
+                           const void *pBuffer, size_t sizeBytes)
+{
+    (void) pDeviceSerial;
+    (void) pBuffer;
+
+    return (int32_t) sizeBytes;
+}
+
+// Populate the vector table of a replay device; the rest is
+// left as the defaults.
+static void replayInit(struct uDeviceSerial_t *pDeviceSerial)
+{
+    pDeviceSerial->open = replayOpen;
+    pDeviceSerial->close = replayClose;
+    pDeviceSerial->getReceiveSize = replayGetReceiveSize;
+    pDeviceSerial->read = replayRead;
+    pDeviceSerial->write = replayWrite;
+}
+
+// Get the replay context of a serial device, NULL if the serial
+// device is not a replay device.
+static uGnssCaptureReplay_t *pReplayGet(uDeviceSerial_t *pDeviceSerial)
+{
+    uGnssCaptureReplay_t *pReplay = NULL;
+
+    if ((pDeviceSerial != NULL) && (pDeviceSerial->open == replayOpen)) {
+        pReplay = (uGnssCaptureReplay_t *) pUInterfaceContext(pDeviceSerial);
+    }
+
+    return pReplay;
+}
+
+// Create a replay device; if mapSize is non-zero pCapture was
+// mapped with uPortFileMap() and will be unmapped when the
+// replay device is deleted.
+static uDeviceSerial_t *pReplayCreate(const char *pCapture, size_t size,
+                                      size_t mapSize, bool realTime)
+{
+    uDeviceSerial_t *pDeviceSerial = NULL;
+    uGnssCaptureReplay_t *pReplay;
+
+    if ((pCapture != NULL) && (size >= U_GNSS_CAPTURE_HEADER_LENGTH_BYTES) &&
+        (memcmp(pCapture, U_GNSS_CAPTURE_MAGIC, 4) == 0) &&
+        (*(pCapture + 4) == U_GNSS_CAPTURE_VERSION)) {
+        pDeviceSerial = pUDeviceSerialCreate(replayInit, sizeof(uGnssCaptureReplay_t));
+        if (pDeviceSerial != NULL) {
+            pReplay = (uGnssCaptureReplay_t *) pUInterfaceContext(pDeviceSerial);
+            pReplay->pCapture = pCapture;
+            pReplay->size = size;
+            pReplay->mapSize = mapSize;
+            pReplay->realTime = realTime;
+            pReplay->offset = U_GNSS_CAPTURE_HEADER_LENGTH_BYTES;
+            if ((uPortMutexCreate(&(pReplay->mutex)) != 0) ||
+                (replayIndexBuild(pReplay) != 0)) {
+                if (pReplay->mutex != NULL) {
+                    uPortMutexDelete(pReplay->mutex);
+                }
+                uPortFree(pReplay->pIndex);
+                uDeviceSerialDelete(pDeviceSerial);
+                pDeviceSerial = NULL;
+            }
+        }
+    }
+
+    return pDeviceSerial;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS THAT ARE PRIVATE TO GNSS
+ * -------------------------------------------------------------- */
+
+// Add a block of data from the GNSS chip to any capture.
+void uGnssCapturePrivateAdd(uGnssPrivateInstance_t *pInstance,
+                            const char *pData1, size_t length1,
+                            const char *pData2, size_t length2)
+{
+    uGnssCapture_t *pCapture = (uGnssCapture_t *) pInstance->pCapture;
+    char header[U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES];
+    uint32_t timeMs;
+    uint32_t x32;
+    uint16_t x16;
+    size_t length;
+    size_t x;
+
+    // Check without the mutex first, so that this costs nothing
+    // when there is no capture
+    if ((pCapture != NULL) && pCapture->active) {
+
+        U_PORT_MUTEX_LOCK(pCapture->mutex);
+
+        if (pCapture->active) {
+            timeMs = (uint32_t) (uPortGetTickTimeMs() - pCapture->startTimeMs);
+            while (length1 + length2 > 0) {
+                length = length1 + length2;
+                if (length > U_GNSS_CAPTURE_RECORD_LENGTH_MAX_BYTES) {
+                    length = U_GNSS_CAPTURE_RECORD_LENGTH_MAX_BYTES;
+                }
+                x32 = uUbxProtocolUint32Encode(timeMs);
+                memcpy(header, &x32, sizeof(x32));
+                x16 = uUbxProtocolUint16Encode((uint16_t) length);
+                memcpy(header + sizeof(x32), &x16, sizeof(x16));
+                captureWrite(pCapture, pInstance->gnssHandle, header, sizeof(header));
+                // The data may be in two pieces, the second being
+                // where the ring buffer wrapped
+                x = length;
+                if (x > length1) {
+                    x = length1;
+                }
+                if (x > 0) {
+                    captureWrite(pCapture, pInstance->gnssHandle, pData1, x);
+                    pData1 += x;
+                    length1 -= x;
+                }
+                x = length - x;
+                if (x > 0) {
+                    captureWrite(pCapture, pInstance->gnssHandle, pData2, x);
+                    pData2 += x;
+                    length2 -= x;
+                }
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(pCapture->mutex);
+    }
+}
+
+// Stop any capture and free the capture context.
+void uGnssCapturePrivateCleanUp(uGnssPrivateInstance_t *pInstance)
+{
+    uGnssCapture_t *pCapture = (uGnssCapture_t *) pInstance->pCapture;
+
+    if (pCapture != NULL) {
+
+        U_PORT_MUTEX_LOCK(pCapture->mutex);
+
+        captureStop(pCapture);
+
+        U_PORT_MUTEX_UNLOCK(pCapture->mutex);
+
+        uPortMutexDelete(pCapture->mutex);
+        pInstance->pCapture = NULL;
+        uPortFree(pCapture);
+    }
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: CAPTURE
+ * -------------------------------------------------------------- */
+
+// Start capturing to a callback.
+int32_t uGnssCaptureStart(uDeviceHandle_t gnssHandle,
+                          void (*pCallback)(uDeviceHandle_t gnssHandle,
+                                            const char *pData,
+                                            size_t size,
+                                            void *pCallbackParam),
+                          void *pCallbackParam)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pCallback != NULL) {
+        errorCode = captureStart(gnssHandle, pCallback, pCallbackParam, NULL);
+    }
+
+    return errorCode;
+}
+
+// Start capturing to a file.
+int32_t uGnssCaptureStartFile(uDeviceHandle_t gnssHandle,
+                              const char *pFileName)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pFileName != NULL) {
+        errorCode = captureStart(gnssHandle, NULL, NULL, pFileName);
+    }
+
+    return errorCode;
+}
+
+// Stop capturing.
+int32_t uGnssCaptureStop(uDeviceHandle_t gnssHandle)
+{
+    int32_t errorCodeOrSize = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+    uGnssCapture_t *pCapture;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCodeOrSize = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if (pInstance != NULL) {
+            errorCodeOrSize = 0;
+            pCapture = (uGnssCapture_t *) pInstance->pCapture;
+            if (pCapture != NULL) {
+
+                U_PORT_MUTEX_LOCK(pCapture->mutex);
+
+                errorCodeOrSize = captureStop(pCapture);
+
+                U_PORT_MUTEX_UNLOCK(pCapture->mutex);
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCodeOrSize;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS: REPLAY
+ * -------------------------------------------------------------- */
+
+// Create a replay device for a capture in memory.
+uDeviceSerial_t *pUGnssCaptureReplayCreate(const char *pCapture,
+                                           size_t size, bool realTime)
+{
+    return pReplayCreate(pCapture, size, 0, realTime);
+}
+
+// Create a replay device for a capture file.
+uDeviceSerial_t *pUGnssCaptureReplayCreateFile(const char *pFileName,
+                                               bool realTime)
+{
+    uDeviceSerial_t *pDeviceSerial = NULL;
+    const char *pCapture;
+    size_t size;
+
+    if ((pFileName != NULL) && (uPortFileMap(pFileName, &pCapture, &size) == 0)) {
+        pDeviceSerial = pReplayCreate(pCapture, size, size, realTime);
+        if (pDeviceSerial == NULL) {
+            uPortFileUnmap(pCapture, size);
+        }
+    }
+
+    return pDeviceSerial;
+}
+
+// Move the replay position.
+int32_t uGnssCaptureReplaySeek(uDeviceSerial_t *pDeviceSerial,
+                               int32_t timeMs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssCaptureReplay_t *pReplay = pReplayGet(pDeviceSerial);
+
+    if ((pReplay != NULL) && (timeMs >= 0)) {
+
+        U_PORT_MUTEX_LOCK(pReplay->mutex);
+
+        replaySeek(pReplay, (uint32_t) timeMs);
+        replayClockRestart(pReplay, (uint32_t) timeMs);
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (pReplay->offset >= pReplay->size) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        }
+
+        U_PORT_MUTEX_UNLOCK(pReplay->mutex);
+    }
+
+    return errorCode;
+}
+
+// Get the capture time of the replay position.
+int32_t uGnssCaptureReplayGetTimeMs(uDeviceSerial_t *pDeviceSerial)
+{
+    int32_t errorCodeOrTimeMs = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssCaptureReplay_t *pReplay = pReplayGet(pDeviceSerial);
+
+    if (pReplay != NULL) {
+
+        U_PORT_MUTEX_LOCK(pReplay->mutex);
+
+        errorCodeOrTimeMs = (int32_t) pReplay->durationMs;
+        if (pReplay->offset < pReplay->size) {
+            errorCodeOrTimeMs = (int32_t) recordTimeMs(pReplay, pReplay->offset);
+        }
+
+        U_PORT_MUTEX_UNLOCK(pReplay->mutex);
+    }
+
+    return errorCodeOrTimeMs;
+}
+
+// Get the length of a capture.
+int32_t uGnssCaptureReplayGetDurationMs(uDeviceSerial_t *pDeviceSerial)
+{
+    int32_t errorCodeOrDurationMs = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssCaptureReplay_t *pReplay = pReplayGet(pDeviceSerial);
+
+    if (pReplay != NULL) {
+        // Doesn't change after creation, no need to lock
+        errorCodeOrDurationMs = (int32_t) pReplay->durationMs;
+    }
+
+    return errorCodeOrDurationMs;
+}
+
+// Determine whether all of a capture has been replayed.
+bool uGnssCaptureReplayIsAtEnd(uDeviceSerial_t *pDeviceSerial)
+{
+    bool isAtEnd = false;
+    uGnssCaptureReplay_t *pReplay = pReplayGet(pDeviceSerial);
+
+    if (pReplay != NULL) {
+
+        U_PORT_MUTEX_LOCK(pReplay->mutex);
+
+        isAtEnd = (pReplay->offset >= pReplay->size);
+
+        U_PORT_MUTEX_UNLOCK(pReplay->mutex);
+    }
+
+    return isAtEnd;
+}
+
+// Delete a replay device.
+void uGnssCaptureReplayDelete(uDeviceSerial_t *pDeviceSerial)
+{
+    uGnssCaptureReplay_t *pReplay = pReplayGet(pDeviceSerial);
+
+    if (pReplay != NULL) {
+        uPortMutexDelete(pReplay->mutex);
+        uPortFree(pReplay->pIndex);
+        if (pReplay->mapSize > 0) {
+            uPortFileUnmap(pReplay->pCapture, pReplay->mapSize);
+        }
+        uDeviceSerialDelete(pDeviceSerial);
+    }
+}
+
+// End of file
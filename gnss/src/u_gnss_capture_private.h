@@ -0,0 +1,74 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_GNSS_CAPTURE_PRIVATE_H_
+#define _U_GNSS_CAPTURE_PRIVATE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** @file
+ * @brief This header file defines the hooks by which the rest of
+ * the GNSS API feeds data to, and tidies up after, capture.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Add a block of data received from the GNSS chip to any capture
+ * that is running; this costs nothing more than a couple of checks
+ * if there is no capture.  The block may be in two pieces, e.g.
+ * where it wraps around the end of the ring buffer; it is written
+ * to the capture as a single record.
+ *
+ * Note: this does NOT lock gUGnssPrivateMutex, it is called from
+ * uGnssPrivateStreamFillRingBuffer().
+ *
+ * @param[in] pInstance a pointer to the GNSS instance, cannot be NULL.
+ * @param[in] pData1    the first piece of the block.
+ * @param length1       the length of pData1.
+ * @param[in] pData2    the second piece of the block, may be NULL
+ *                      if length2 is zero.
+ * @param length2       the length of pData2.
+ */
+void uGnssCapturePrivateAdd(uGnssPrivateInstance_t *pInstance,
+                            const char *pData1, size_t length1,
+                            const char *pData2, size_t length2);
+
+/** Stop any capture and free the capture context of a GNSS
+ * instance; nothing must be reading from the GNSS chip when
+ * this is called.
+ *
+ * Note: gUGnssPrivateMutex should be locked before this is called.
+ *
+ * @param[in] pInstance a pointer to the GNSS instance, cannot be NULL.
+ */
+void uGnssCapturePrivateCleanUp(uGnssPrivateInstance_t *pInstance);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _U_GNSS_CAPTURE_PRIVATE_H_
+
+// End of file
@@ -25,7 +25,17 @@
  * API, used for decoding a useful subset of messages from a GNSS
  * device.
  *
- * To add a new message to the set of message decoders:
+ * UBX messages are decoded by walking a table that describes,
+ * field by field, where each field of the message body lands in
+ * the message structure; the UBX tables in this file are written
+ * by the Python script u_gnss_dec_ubx.py, in this directory.
+ * NMEA sentences are decoded in the same way, the NMEA tables
+ * being short enough to be maintained by hand, using gNmeaGga
+ * as an example.  In both cases no heap is used other than that
+ * for the decoded structure in pUGnssDecAlloc(), and NMEA
+ * fields are converted to fixed-point integers without recourse
+ * to strtod(), sscanf() etc.  To add a new UBX message to the
+ * set of message decoders:
  *
  * 1.  Create a .h file in the "api" directory which defines the
  * message; for example, if you were creating a decoder for the
@@ -39,39 +49,36 @@
  * interface manual: see u_gnss_dec_ubx_nav_pvt.h for an example.
  * Make sure to follow the usual pattern for the header file gating
  * \#defines and the _MESSAGE_CLASS, _MESSAGE_ID and _BODY_MIN_LENGTH
- * macros.  You may also choose to define helper functions which
- * convert the elements of the structure as defined by the GNSS
- * device interface manual into more friendly structures.
+ * macros.  If the message has repeated blocks, put them in an
+ * array in the message structure, with a _MAX_NUM macro giving
+ * its size: see u_gnss_dec_ubx_nav_sat.h for an example.  You may
+ * also choose to define helper functions which convert the elements
+ * of the structure as defined by the GNSS device interface manual
+ * into more friendly structures.
  *
  * 2. \#include this new header file in u_gnss_dec.h, add it to
  * ubxlib.h and add the new message struct to the #uGnssDecUnion_t
- * in this file.
+ * in u_gnss_dec.h.
  *
- * 3. Create the static decode function for the message here,
- * following the naming pattern, e.g. for UBX-XXX-YYY the function
- * would be named ubxXxxYyyAlloc(); the function  must have the
- * function signature of #uGnssDecKnownFunction_t.
+ * 3. Add the fields of the message, as they are listed in the
+ * interface manual, to MESSAGE_LIST in u_gnss_dec_ubx.py and run
+ * that script to re-write the tables at the end of this file.
  *
- * 4. Add the static function to the gpFunctionList array and add
- * its message ID to the gIdList array, making sure to put it in the
- * same position in both.
- *
- * 5. If in step (1) you chose to include helper functions, add a
+ * 4. If in step (1) you chose to include helper functions, add a
  * .c file in this src directory, of the same name as the .h file,
  * which implements the helper functions; see u_gnss_dec_ubx_nav_pvt.c
  * for an example.
  *
- * 6. Add at least one test vector for the function to the
+ * 5. Add at least one test vector for the message to the
  * gTestDataKnownSet array in u_gnss_dec_test.c, using the pattern
  * of gUbxNavPvt as an example, and a spot-test for each helper
  * function if there are any (again, see the handling of UBX-NAV-PVT
  * for an example).
  *
- * Obviously it would be possible to add NMEA messages, or RTCM messages,
- * in the same way, just replacing "ubx" with "nmea" or "rtcm", but note
- * that this code does not use NMEA or RTCM messages and we want to avoid
- * code bloat, hence the uGnssDecSetCallback() hook to allow a customer
- * to add their own decoders at run-time.
+ * Obviously it would be possible to add RTCM messages in a similar
+ * way, but note that this code does not use RTCM messages and we want
+ * to avoid code bloat, hence the uGnssDecSetCallback() hook to allow
+ * a customer to add their own decoders at run-time.
  */
 
 #ifdef U_CFG_OVERRIDE
@@ -81,7 +88,7 @@
 #include "stddef.h"    // NULL, size_t etc.
 #include "stdint.h"    // int32_t etc.
 #include "stdbool.h"
-#include "string.h"    // memset()
+#include "string.h"    // memset(), memcpy()
 
 #include "u_error_common.h"
 
@@ -104,35 +111,207 @@
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+/** The number of elements in an array.
+ */
+#define U_GNSS_DEC_ARRAY_COUNT(array) (sizeof(array) / sizeof((array)[0]))
+
+/** Populate a #uGnssDecUbxField_t for the given member of
+ * a structure, found at the given offset in the message body
+ * and of the given #uGnssDecUbxType_t (without the prefix).
+ */
+#define U_GNSS_DEC_UBX_FIELD(structType, member, payloadOffset, type)     \
+    {payloadOffset, U_GNSS_DEC_UBX_TYPE_##type,                           \
+     sizeof(((structType *) 0)->member), offsetof(structType, member)}
+
+/** As U_GNSS_DEC_UBX_FIELD() but where the field populates the
+ * whole of the given type, e.g. an element of an array of uint32_t.
+ */
+#define U_GNSS_DEC_UBX_FIELD_WHOLE(type, payloadOffset, fieldType)        \
+    {payloadOffset, U_GNSS_DEC_UBX_TYPE_##fieldType, sizeof(type), 0}
+
+/** Populate a #uGnssDecNmeaField_t for the given member of a
+ * structure, decoded from the whole of the given NMEA field as
+ * the given #uGnssDecNmeaType_t (without the prefix), with the
+ * given number of decimal places retained (i.e. the value is
+ * multiplied by 10 to the power decimals).
+ */
+#define U_GNSS_DEC_NMEA_FIELD(structType, member, field, type, decimals)     \
+    U_GNSS_DEC_NMEA_FIELD_PART(structType, member, field, type, 0, 0, decimals)
+
+/** As U_GNSS_DEC_NMEA_FIELD() but decoding only count characters
+ * of the NMEA field, starting at the given character offset; use
+ * a count of zero to mean "to the end of the field".
+ */
+#define U_GNSS_DEC_NMEA_FIELD_PART(structType, member, field, type, offset, count, decimals) \
+    {field, U_GNSS_DEC_NMEA_TYPE_##type, offset, count, decimals,             \
+     sizeof(((structType *) 0)->member), offsetof(structType, member)}
+
+/** The fields of a UTC time, hhmmss.ss, in the given NMEA field,
+ * decoded into the hour, min, sec and millisecond members of
+ * a structure.
+ */
+#define U_GNSS_DEC_NMEA_TIME(structType, field)                             \
+    U_GNSS_DEC_NMEA_FIELD_PART(structType, hour, field, DECIMAL, 0, 2, 0),  \
+    U_GNSS_DEC_NMEA_FIELD_PART(structType, min, field, DECIMAL, 2, 2, 0),   \
+    U_GNSS_DEC_NMEA_FIELD_PART(structType, sec, field, DECIMAL, 4, 2, 0),   \
+    U_GNSS_DEC_NMEA_FIELD_PART(structType, millisecond, field, DECIMAL, 6, 0, 3)
+
+/** The fields of a latitude or longitude, ddmm.mmmmm or
+ * dddmm.mmmmm, in the given NMEA field followed by the
+ * hemisphere, N/S or E/W, in the next field, decoded into
+ * the given member of a structure in units of 1e-7 degrees.
+ */
+#define U_GNSS_DEC_NMEA_LAT_LON(structType, member, field)                   \
+    U_GNSS_DEC_NMEA_FIELD(structType, member, field, DEGREES_MINUTES, 7),    \
+    U_GNSS_DEC_NMEA_FIELD(structType, member, (field) + 1, HEMISPHERE, 0)
+
+/** The fields of a satellite in a GSV sentence, starting at
+ * the given NMEA field.
+ */
+#define U_GNSS_DEC_NMEA_GSV_SV(index, field)                                 \
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsv_t, sv[index].svid, field, DECIMAL, 0),      \
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsv_t, sv[index].elv, (field) + 1, DECIMAL, 0), \
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsv_t, sv[index].az, (field) + 2, DECIMAL, 0),  \
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsv_t, sv[index].cno, (field) + 3, DECIMAL, 0)
+
+/** Populate a #uGnssMessageId_t for an NMEA sentence with the
+ * given sentence formatter, e.g. "GGA", from any talker.
+ */
+#define U_GNSS_DEC_NMEA_ID(formatter)                                        \
+    {                                                                        \
+        .type = U_GNSS_PROTOCOL_NMEA,                                        \
+        .id.pNmea = "?" "?" formatter                                        \
+    }
+
+/** The NMEA entries at the end of gIdList; order is important,
+ * MUST be in the same order as gNmeaMessageList.
+ */
+#define U_GNSS_DEC_NMEA_ID_LIST                                              \
+    U_GNSS_DEC_NMEA_ID(U_GNSS_DEC_NMEA_GGA_SENTENCE_FORMATTER),              \
+    U_GNSS_DEC_NMEA_ID(U_GNSS_DEC_NMEA_RMC_SENTENCE_FORMATTER),              \
+    U_GNSS_DEC_NMEA_ID(U_GNSS_DEC_NMEA_GSA_SENTENCE_FORMATTER),              \
+    U_GNSS_DEC_NMEA_ID(U_GNSS_DEC_NMEA_GSV_SENTENCE_FORMATTER),              \
+    U_GNSS_DEC_NMEA_ID(U_GNSS_DEC_NMEA_VTG_SENTENCE_FORMATTER),              \
+    U_GNSS_DEC_NMEA_ID(U_GNSS_DEC_NMEA_GST_SENTENCE_FORMATTER),              \
+    U_GNSS_DEC_NMEA_ID(U_GNSS_DEC_NMEA_ZDA_SENTENCE_FORMATTER)
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
 
-/** Private version of function that can be hooked into
- * pUGnssDecAlloc() by uGnssDecSetCallback() to decode message types
- * that _are_ known to this code.
- *
- * @param[in] pBuffer             the buffer pointer that was passed to
- *                                pUGnssDecAlloc().
- * @param size                    the number of bytes at pBuffer;
- *                                for a known protocol it _might_
- *                                be that any FCS/check-sum bytes
- *                                on the end have been removed
- *                                by the caller, hence the function
- *                                should not _require_ them to be
- *                                present in the count.
- * @param[out] ppBody             a pointer to a place to put the
- *                                decoded message body, which the
- *                                callback should allocate using
- *                                pUPortMalloc(); will never be NULL.
- * @return                        zero on a successful decode, else
- *                                negative error code, preferably
- *                                from the set suggested for the
- *                                errorCode field of #uGnssDec_t.
- */
-typedef int32_t (uGnssDecKnownFunction_t) (const char *pBuffer,
-                                           size_t size,
-                                           uGnssDecUnion_t **ppBody);
+/** The types that a field of a UBX message body is decoded as;
+ * the bit-fields of the interface manual (X1 etc.) are unsigned
+ * and the floating point types (R4 and R8) are carried as their
+ * bit pattern, hence as U4 and U8.
+ */
+typedef enum {
+    U_GNSS_DEC_UBX_TYPE_U1,
+    U_GNSS_DEC_UBX_TYPE_I1,
+    U_GNSS_DEC_UBX_TYPE_U2,
+    U_GNSS_DEC_UBX_TYPE_I2,
+    U_GNSS_DEC_UBX_TYPE_U4,
+    U_GNSS_DEC_UBX_TYPE_I4,
+    U_GNSS_DEC_UBX_TYPE_U8
+} uGnssDecUbxType_t;
+
+/** Description of a field of a UBX message body and where it
+ * goes in the message structure.
+ */
+typedef struct {
+    uint16_t payloadOffset; /**< offset of the field in the message
+                                 body (or in the repeated block). */
+    uint8_t type;           /**< the #uGnssDecUbxType_t of the field. */
+    uint8_t structSize;     /**< size of the structure member. */
+    uint16_t structOffset;  /**< offset of the member in the structure. */
+} uGnssDecUbxField_t;
+
+/** Description of the repeated block of a UBX message body.
+ */
+typedef struct {
+    uint16_t countOffset;       /**< offset in the message body of the
+                                     field giving the number of blocks. */
+    uint8_t countType;          /**< the #uGnssDecUbxType_t of that field. */
+    uint8_t countShift;         /**< the number of bits to shift that field
+                                     down by. */
+    uint16_t countMask;         /**< the mask to apply after shifting. */
+    uint16_t payloadOffset;     /**< offset of the first block in the
+                                     message body. */
+    uint16_t payloadLength;     /**< the length of one block in the
+                                     message body. */
+    uint16_t structOffset;      /**< offset of the array in the structure. */
+    uint16_t structLength;      /**< the size of one element of the array. */
+    uint16_t maxNum;            /**< the number of elements in the array. */
+    const uGnssDecUbxField_t *pFieldList; /**< the fields of a block. */
+    size_t numFields;           /**< the number of entries in pFieldList. */
+} uGnssDecUbxBlock_t;
+
+/** Description of a UBX message that can be decoded.
+ */
+typedef struct {
+    uint16_t id;              /**< message class and ID, as made by
+                                   U_GNSS_UBX_MESSAGE(). */
+    uint16_t bodyMinLength;   /**< the minimum length of the body. */
+    size_t structSize;        /**< the size of the message structure. */
+    const uGnssDecUbxField_t *pFieldList; /**< the fields of the body. */
+    size_t numFields;         /**< the number of entries in pFieldList. */
+    const uGnssDecUbxBlock_t *pBlock;     /**< the repeated block, NULL
+                                               if there is none. */
+    const uGnssDecUbxField_t *pTrailerFieldList; /**< the fields after the
+                                                      repeated blocks, offsets
+                                                      being from the end of
+                                                      the blocks, may be NULL. */
+    size_t numTrailerFields;  /**< the number of entries in
+                                   pTrailerFieldList. */
+} uGnssDecUbxMessage_t;
+
+/** The ways in which an NMEA field may be decoded.
+ */
+typedef enum {
+    U_GNSS_DEC_NMEA_TYPE_DECIMAL,         /**< a signed decimal number,
+                                               e.g. 1.03. */
+    U_GNSS_DEC_NMEA_TYPE_DEGREES_MINUTES, /**< a latitude or longitude,
+                                               ddmm.mmmmm or dddmm.mmmmm,
+                                               decoded in degrees. */
+    U_GNSS_DEC_NMEA_TYPE_HEMISPHERE,      /**< N/S/E/W, the member
+                                               being negated for S or W. */
+    U_GNSS_DEC_NMEA_TYPE_CHAR,            /**< the first character. */
+    U_GNSS_DEC_NMEA_TYPE_YEAR             /**< a year, two-digit years
+                                               being taken to be 20yy. */
+} uGnssDecNmeaType_t;
+
+/** Description of a field of an NMEA sentence and where it
+ * goes in the message structure.
+ */
+typedef struct {
+    uint8_t field;          /**< the field number, the address field
+                                 being field 0. */
+    uint8_t type;           /**< the #uGnssDecNmeaType_t of the field. */
+    uint8_t charOffset;     /**< the character to start at. */
+    uint8_t charCount;      /**< the number of characters, 0 for all. */
+    uint8_t decimals;       /**< the number of decimal places to keep. */
+    uint8_t structSize;     /**< size of the structure member. */
+    uint16_t structOffset;  /**< offset of the member in the structure. */
+} uGnssDecNmeaField_t;
+
+/** Description of an NMEA sentence that can be decoded.
+ */
+typedef struct {
+    const char *pFormatter;   /**< the sentence formatter, e.g. "GGA". */
+    size_t structSize;        /**< the size of the message structure;
+                                   the structure MUST begin with a
+                                   uint32_t "present" bit-map. */
+    const uGnssDecNmeaField_t *pFieldList; /**< the fields, in
+                                                ascending field order. */
+    size_t numFields;         /**< the number of entries in pFieldList. */
+} uGnssDecNmeaMessage_t;
+
+/** The decoder for a message: one of the pointers will be non-NULL.
+ */
+typedef struct {
+    const uGnssDecUbxMessage_t *pUbx;
+    const uGnssDecNmeaMessage_t *pNmea;
+    size_t structSize;
+} uGnssDecDecoder_t;
 
 /* ----------------------------------------------------------------
  * STATIC VARIABLES: MISC
@@ -146,10 +325,581 @@ static uGnssDecFunction_t *gpCallback = NULL;
  */
 static void *gpCallbackParam = NULL;
 
-/** The list of known message IDs; order is important,
- * MUST be in the same order as gpFunctionList (see further
- * down in this file) and both lists must contain the same number
- * of elements.
+/** The width in bytes of each #uGnssDecUbxType_t.
+ */
+static const uint8_t gUbxTypeWidth[] = {1, 1, 2, 2, 4, 4, 8};
+
+/* ----------------------------------------------------------------
+ * STATIC VARIABLES: NMEA MESSAGE TABLES
+ * -------------------------------------------------------------- */
+
+/** The fields of an NMEA GGA sentence.
+ */
+static const uGnssDecNmeaField_t gNmeaGgaFieldList[] = {
+    U_GNSS_DEC_NMEA_TIME(uGnssDecNmeaGga_t, 1),
+    U_GNSS_DEC_NMEA_LAT_LON(uGnssDecNmeaGga_t, lat, 2),
+    U_GNSS_DEC_NMEA_LAT_LON(uGnssDecNmeaGga_t, lon, 4),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGga_t, quality, 6, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGga_t, numSV, 7, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGga_t, HDOP, 8, DECIMAL, 2),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGga_t, alt, 9, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGga_t, sep, 11, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGga_t, diffAge, 13, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGga_t, diffStation, 14, DECIMAL, 0)
+};
+
+/** The fields of an NMEA RMC sentence.
+ */
+static const uGnssDecNmeaField_t gNmeaRmcFieldList[] = {
+    U_GNSS_DEC_NMEA_TIME(uGnssDecNmeaRmc_t, 1),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaRmc_t, status, 2, CHAR, 0),
+    U_GNSS_DEC_NMEA_LAT_LON(uGnssDecNmeaRmc_t, lat, 3),
+    U_GNSS_DEC_NMEA_LAT_LON(uGnssDecNmeaRmc_t, lon, 5),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaRmc_t, spd, 7, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaRmc_t, cog, 8, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD_PART(uGnssDecNmeaRmc_t, day, 9, DECIMAL, 0, 2, 0),
+    U_GNSS_DEC_NMEA_FIELD_PART(uGnssDecNmeaRmc_t, month, 9, DECIMAL, 2, 2, 0),
+    U_GNSS_DEC_NMEA_FIELD_PART(uGnssDecNmeaRmc_t, year, 9, YEAR, 4, 2, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaRmc_t, mv, 10, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaRmc_t, mv, 11, HEMISPHERE, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaRmc_t, posMode, 12, CHAR, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaRmc_t, navStatus, 13, CHAR, 0)
+};
+
+/** The fields of an NMEA GSA sentence.
+ */
+static const uGnssDecNmeaField_t gNmeaGsaFieldList[] = {
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, opMode, 1, CHAR, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, navMode, 2, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, svid[0], 3, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, svid[1], 4, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, svid[2], 5, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, svid[3], 6, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, svid[4], 7, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, svid[5], 8, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, svid[6], 9, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, svid[7], 10, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, svid[8], 11, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, svid[9], 12, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, svid[10], 13, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, svid[11], 14, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, PDOP, 15, DECIMAL, 2),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, HDOP, 16, DECIMAL, 2),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, VDOP, 17, DECIMAL, 2),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsa_t, systemId, 18, DECIMAL, 0)
+};
+
+/** The fields of an NMEA GSV sentence.
+ */
+static const uGnssDecNmeaField_t gNmeaGsvFieldList[] = {
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsv_t, numMsg, 1, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsv_t, msgNum, 2, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGsv_t, numSV, 3, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_GSV_SV(0, 4),
+    U_GNSS_DEC_NMEA_GSV_SV(1, 8),
+    U_GNSS_DEC_NMEA_GSV_SV(2, 12),
+    U_GNSS_DEC_NMEA_GSV_SV(3, 16)
+};
+
+/** The fields of an NMEA VTG sentence.
+ */
+static const uGnssDecNmeaField_t gNmeaVtgFieldList[] = {
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaVtg_t, cogt, 1, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaVtg_t, cogm, 3, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaVtg_t, sogn, 5, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaVtg_t, sogk, 7, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaVtg_t, posMode, 9, CHAR, 0)
+};
+
+/** The fields of an NMEA GST sentence.
+ */
+static const uGnssDecNmeaField_t gNmeaGstFieldList[] = {
+    U_GNSS_DEC_NMEA_TIME(uGnssDecNmeaGst_t, 1),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGst_t, rangeRms, 2, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGst_t, stdMajor, 3, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGst_t, stdMinor, 4, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGst_t, orient, 5, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGst_t, stdLat, 6, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGst_t, stdLong, 7, DECIMAL, 3),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaGst_t, stdAlt, 8, DECIMAL, 3)
+};
+
+/** The fields of an NMEA ZDA sentence.
+ */
+static const uGnssDecNmeaField_t gNmeaZdaFieldList[] = {
+    U_GNSS_DEC_NMEA_TIME(uGnssDecNmeaZda_t, 1),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaZda_t, day, 2, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaZda_t, month, 3, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaZda_t, year, 4, YEAR, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaZda_t, ltzh, 5, DECIMAL, 0),
+    U_GNSS_DEC_NMEA_FIELD(uGnssDecNmeaZda_t, ltzn, 6, DECIMAL, 0)
+};
+
+/** The list of NMEA sentences that can be decoded; order is
+ * important, MUST be in the same order as U_GNSS_DEC_NMEA_ID_LIST.
+ */
+static const uGnssDecNmeaMessage_t gNmeaMessageList[] = {
+    {
+        U_GNSS_DEC_NMEA_GGA_SENTENCE_FORMATTER, sizeof(uGnssDecNmeaGga_t),
+        gNmeaGgaFieldList, U_GNSS_DEC_ARRAY_COUNT(gNmeaGgaFieldList)
+    },
+    {
+        U_GNSS_DEC_NMEA_RMC_SENTENCE_FORMATTER, sizeof(uGnssDecNmeaRmc_t),
+        gNmeaRmcFieldList, U_GNSS_DEC_ARRAY_COUNT(gNmeaRmcFieldList)
+    },
+    {
+        U_GNSS_DEC_NMEA_GSA_SENTENCE_FORMATTER, sizeof(uGnssDecNmeaGsa_t),
+        gNmeaGsaFieldList, U_GNSS_DEC_ARRAY_COUNT(gNmeaGsaFieldList)
+    },
+    {
+        U_GNSS_DEC_NMEA_GSV_SENTENCE_FORMATTER, sizeof(uGnssDecNmeaGsv_t),
+        gNmeaGsvFieldList, U_GNSS_DEC_ARRAY_COUNT(gNmeaGsvFieldList)
+    },
+    {
+        U_GNSS_DEC_NMEA_VTG_SENTENCE_FORMATTER, sizeof(uGnssDecNmeaVtg_t),
+        gNmeaVtgFieldList, U_GNSS_DEC_ARRAY_COUNT(gNmeaVtgFieldList)
+    },
+    {
+        U_GNSS_DEC_NMEA_GST_SENTENCE_FORMATTER, sizeof(uGnssDecNmeaGst_t),
+        gNmeaGstFieldList, U_GNSS_DEC_ARRAY_COUNT(gNmeaGstFieldList)
+    },
+    {
+        U_GNSS_DEC_NMEA_ZDA_SENTENCE_FORMATTER, sizeof(uGnssDecNmeaZda_t),
+        gNmeaZdaFieldList, U_GNSS_DEC_ARRAY_COUNT(gNmeaZdaFieldList)
+    }
+};
+
+/* ----------------------------------------------------------------
+ * STATIC VARIABLES: UBX MESSAGE TABLES GENERATED BY u_gnss_dec_ubx.py
+ * -------------------------------------------------------------- */
+
+// *** DO NOT MODIFY THIS LINE OR BELOW: AUTO-GENERATED BY u_gnss_dec_ubx.py ***
+
+/** The fields of UBX-NAV-PVT.
+ */
+static const uGnssDecUbxField_t gUbxNavPvtFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, iTOW, 0, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, year, 4, U2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, month, 6, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, day, 7, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, hour, 8, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, min, 9, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, sec, 10, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, valid, 11, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, tAcc, 12, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, nano, 16, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, fixType, 20, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, flags, 21, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, flags2, 22, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, numSV, 23, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, lon, 24, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, lat, 28, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, height, 32, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, hMSL, 36, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, hAcc, 40, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, vAcc, 44, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, velN, 48, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, velE, 52, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, velD, 56, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, gSpeed, 60, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, headMot, 64, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, sAcc, 68, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, headAcc, 72, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, pDOP, 76, U2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, flags3, 78, U2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, headVeh, 84, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, magDec, 88, I2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavPvt_t, magAcc, 90, U2),
+};
+
+/** The fields of UBX-NAV-HPPOSLLH.
+ */
+static const uGnssDecUbxField_t gUbxNavHpposllhFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavHpposllh_t, version, 0, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavHpposllh_t, flags, 3, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavHpposllh_t, iTOW, 4, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavHpposllh_t, lon, 8, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavHpposllh_t, lat, 12, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavHpposllh_t, height, 16, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavHpposllh_t, hMSL, 20, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavHpposllh_t, lonHp, 24, I1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavHpposllh_t, latHp, 25, I1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavHpposllh_t, heightHp, 26, I1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavHpposllh_t, hMSLHp, 27, I1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavHpposllh_t, hAcc, 28, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavHpposllh_t, vAcc, 32, U4),
+};
+
+/** The fields of UBX-NAV-STATUS.
+ */
+static const uGnssDecUbxField_t gUbxNavStatusFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavStatus_t, iTOW, 0, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavStatus_t, gpsFix, 4, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavStatus_t, flags, 5, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavStatus_t, fixStat, 6, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavStatus_t, flags2, 7, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavStatus_t, ttff, 8, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavStatus_t, msss, 12, U4),
+};
+
+/** The fields of UBX-NAV-DOP.
+ */
+static const uGnssDecUbxField_t gUbxNavDopFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavDop_t, iTOW, 0, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavDop_t, gDOP, 4, U2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavDop_t, pDOP, 6, U2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavDop_t, tDOP, 8, U2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavDop_t, vDOP, 10, U2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavDop_t, hDOP, 12, U2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavDop_t, nDOP, 14, U2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavDop_t, eDOP, 16, U2),
+};
+
+/** The fields of UBX-NAV-COV.
+ */
+static const uGnssDecUbxField_t gUbxNavCovFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, iTOW, 0, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, version, 4, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, posCovValid, 5, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, velCovValid, 6, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, posCovNN, 16, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, posCovNE, 20, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, posCovND, 24, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, posCovEE, 28, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, posCovED, 32, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, posCovDD, 36, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, velCovNN, 40, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, velCovNE, 44, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, velCovND, 48, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, velCovEE, 52, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, velCovED, 56, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavCov_t, velCovDD, 60, U4),
+};
+
+/** The fields of UBX-NAV-SAT.
+ */
+static const uGnssDecUbxField_t gUbxNavSatFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSat_t, iTOW, 0, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSat_t, version, 4, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSat_t, numSvs, 5, U1),
+};
+
+/** The fields of the repeated block of UBX-NAV-SAT.
+ */
+static const uGnssDecUbxField_t gUbxNavSatBlockFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSatSv_t, gnssId, 0, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSatSv_t, svId, 1, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSatSv_t, cno, 2, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSatSv_t, elev, 3, I1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSatSv_t, azim, 4, I2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSatSv_t, prRes, 6, I2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSatSv_t, flags, 8, U4),
+};
+
+/** The repeated block of UBX-NAV-SAT.
+ */
+static const uGnssDecUbxBlock_t gUbxNavSatBlock = {
+    5, U_GNSS_DEC_UBX_TYPE_U1, 0, 0xff,
+    8, 12,
+    offsetof(uGnssDecUbxNavSat_t, sv[0]),
+    sizeof(((uGnssDecUbxNavSat_t *) 0)->sv[0]),
+    U_GNSS_DEC_ARRAY_COUNT(((uGnssDecUbxNavSat_t *) 0)->sv),
+    gUbxNavSatBlockFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxNavSatBlockFieldList)
+};
+
+/** The fields of UBX-NAV-SIG.
+ */
+static const uGnssDecUbxField_t gUbxNavSigFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSig_t, iTOW, 0, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSig_t, version, 4, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSig_t, numSigs, 5, U1),
+};
+
+/** The fields of the repeated block of UBX-NAV-SIG.
+ */
+static const uGnssDecUbxField_t gUbxNavSigBlockFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSigSig_t, gnssId, 0, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSigSig_t, svId, 1, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSigSig_t, sigId, 2, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSigSig_t, freqId, 3, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSigSig_t, prRes, 4, I2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSigSig_t, cno, 6, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSigSig_t, qualityInd, 7, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSigSig_t, corrSource, 8, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSigSig_t, ionoModel, 9, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxNavSigSig_t, sigFlags, 10, U2),
+};
+
+/** The repeated block of UBX-NAV-SIG.
+ */
+static const uGnssDecUbxBlock_t gUbxNavSigBlock = {
+    5, U_GNSS_DEC_UBX_TYPE_U1, 0, 0xff,
+    8, 16,
+    offsetof(uGnssDecUbxNavSig_t, sig[0]),
+    sizeof(((uGnssDecUbxNavSig_t *) 0)->sig[0]),
+    U_GNSS_DEC_ARRAY_COUNT(((uGnssDecUbxNavSig_t *) 0)->sig),
+    gUbxNavSigBlockFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxNavSigBlockFieldList)
+};
+
+/** The fields of UBX-RXM-RAWX.
+ */
+static const uGnssDecUbxField_t gUbxRxmRawxFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawx_t, rcvTow, 0, U8),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawx_t, week, 8, U2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawx_t, leapS, 10, I1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawx_t, numMeas, 11, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawx_t, recStat, 12, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawx_t, version, 13, U1),
+};
+
+/** The fields of the repeated block of UBX-RXM-RAWX.
+ */
+static const uGnssDecUbxField_t gUbxRxmRawxBlockFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawxMeas_t, prMes, 0, U8),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawxMeas_t, cpMes, 8, U8),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawxMeas_t, doMes, 16, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawxMeas_t, gnssId, 20, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawxMeas_t, svId, 21, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawxMeas_t, sigId, 22, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawxMeas_t, freqId, 23, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawxMeas_t, locktime, 24, U2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawxMeas_t, cno, 26, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawxMeas_t, prStdev, 27, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawxMeas_t, cpStdev, 28, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawxMeas_t, doStdev, 29, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmRawxMeas_t, trkStat, 30, U1),
+};
+
+/** The repeated block of UBX-RXM-RAWX.
+ */
+static const uGnssDecUbxBlock_t gUbxRxmRawxBlock = {
+    11, U_GNSS_DEC_UBX_TYPE_U1, 0, 0xff,
+    16, 32,
+    offsetof(uGnssDecUbxRxmRawx_t, meas[0]),
+    sizeof(((uGnssDecUbxRxmRawx_t *) 0)->meas[0]),
+    U_GNSS_DEC_ARRAY_COUNT(((uGnssDecUbxRxmRawx_t *) 0)->meas),
+    gUbxRxmRawxBlockFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxRxmRawxBlockFieldList)
+};
+
+/** The fields of UBX-RXM-SFRBX.
+ */
+static const uGnssDecUbxField_t gUbxRxmSfrbxFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmSfrbx_t, gnssId, 0, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmSfrbx_t, svId, 1, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmSfrbx_t, sigId, 2, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmSfrbx_t, freqId, 3, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmSfrbx_t, numWords, 4, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmSfrbx_t, chn, 5, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxRxmSfrbx_t, version, 6, U1),
+};
+
+/** The fields of the repeated block of UBX-RXM-SFRBX.
+ */
+static const uGnssDecUbxField_t gUbxRxmSfrbxBlockFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD_WHOLE(uint32_t, 0, U4),
+};
+
+/** The repeated block of UBX-RXM-SFRBX.
+ */
+static const uGnssDecUbxBlock_t gUbxRxmSfrbxBlock = {
+    4, U_GNSS_DEC_UBX_TYPE_U1, 0, 0xff,
+    8, 4,
+    offsetof(uGnssDecUbxRxmSfrbx_t, dwrd[0]),
+    sizeof(((uGnssDecUbxRxmSfrbx_t *) 0)->dwrd[0]),
+    U_GNSS_DEC_ARRAY_COUNT(((uGnssDecUbxRxmSfrbx_t *) 0)->dwrd),
+    gUbxRxmSfrbxBlockFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxRxmSfrbxBlockFieldList)
+};
+
+/** The fields of UBX-ESF-MEAS.
+ */
+static const uGnssDecUbxField_t gUbxEsfMeasFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxEsfMeas_t, timeTag, 0, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxEsfMeas_t, flags, 4, U2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxEsfMeas_t, id, 6, U2),
+};
+
+/** The fields of the repeated block of UBX-ESF-MEAS.
+ */
+static const uGnssDecUbxField_t gUbxEsfMeasBlockFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD_WHOLE(uint32_t, 0, U4),
+};
+
+/** The repeated block of UBX-ESF-MEAS.
+ */
+static const uGnssDecUbxBlock_t gUbxEsfMeasBlock = {
+    4, U_GNSS_DEC_UBX_TYPE_U2, 11, 0x1f,
+    8, 4,
+    offsetof(uGnssDecUbxEsfMeas_t, data[0]),
+    sizeof(((uGnssDecUbxEsfMeas_t *) 0)->data[0]),
+    U_GNSS_DEC_ARRAY_COUNT(((uGnssDecUbxEsfMeas_t *) 0)->data),
+    gUbxEsfMeasBlockFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxEsfMeasBlockFieldList)
+};
+
+/** The fields of UBX-ESF-MEAS after the repeated blocks.
+ */
+static const uGnssDecUbxField_t gUbxEsfMeasTrailerFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxEsfMeas_t, calibTtag, 0, U4),
+};
+
+/** The fields of UBX-ESF-INS.
+ */
+static const uGnssDecUbxField_t gUbxEsfInsFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxEsfIns_t, bitfield0, 0, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxEsfIns_t, iTOW, 8, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxEsfIns_t, xAngRate, 12, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxEsfIns_t, yAngRate, 16, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxEsfIns_t, zAngRate, 20, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxEsfIns_t, xAccel, 24, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxEsfIns_t, yAccel, 28, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxEsfIns_t, zAccel, 32, I4),
+};
+
+/** The fields of UBX-TIM-TP.
+ */
+static const uGnssDecUbxField_t gUbxTimTpFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxTimTp_t, towMS, 0, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxTimTp_t, towSubMS, 4, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxTimTp_t, qErr, 8, I4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxTimTp_t, week, 12, U2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxTimTp_t, flags, 14, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxTimTp_t, refInfo, 15, U1),
+};
+
+/** The fields of UBX-MON-RF.
+ */
+static const uGnssDecUbxField_t gUbxMonRfFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxMonRf_t, version, 0, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxMonRf_t, nBlocks, 1, U1),
+};
+
+/** The fields of the repeated block of UBX-MON-RF.
+ */
+static const uGnssDecUbxField_t gUbxMonRfBlockFieldList[] = {
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxMonRfBlock_t, blockId, 0, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxMonRfBlock_t, flags, 1, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxMonRfBlock_t, antStatus, 2, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxMonRfBlock_t, antPower, 3, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxMonRfBlock_t, postStatus, 4, U4),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxMonRfBlock_t, noisePerMS, 12, U2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxMonRfBlock_t, agcCnt, 14, U2),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxMonRfBlock_t, jamInd, 16, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxMonRfBlock_t, ofsI, 17, I1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxMonRfBlock_t, magI, 18, U1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxMonRfBlock_t, ofsQ, 19, I1),
+    U_GNSS_DEC_UBX_FIELD(uGnssDecUbxMonRfBlock_t, magQ, 20, U1),
+};
+
+/** The repeated block of UBX-MON-RF.
+ */
+static const uGnssDecUbxBlock_t gUbxMonRfBlock = {
+    1, U_GNSS_DEC_UBX_TYPE_U1, 0, 0xff,
+    4, 24,
+    offsetof(uGnssDecUbxMonRf_t, block[0]),
+    sizeof(((uGnssDecUbxMonRf_t *) 0)->block[0]),
+    U_GNSS_DEC_ARRAY_COUNT(((uGnssDecUbxMonRf_t *) 0)->block),
+    gUbxMonRfBlockFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxMonRfBlockFieldList)
+};
+
+/** The list of UBX messages that can be decoded; order is
+ * important, MUST be in the same order as gIdList.
+ */
+static const uGnssDecUbxMessage_t gUbxMessageList[] = {
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_PVT_MESSAGE_CLASS,
+                           U_GNSS_DEC_UBX_NAV_PVT_MESSAGE_ID),
+        U_GNSS_DEC_UBX_NAV_PVT_BODY_MIN_LENGTH, sizeof(uGnssDecUbxNavPvt_t),
+        gUbxNavPvtFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxNavPvtFieldList),
+        NULL, NULL, 0
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_HPPOSLLH_MESSAGE_CLASS,
+                           U_GNSS_DEC_UBX_NAV_HPPOSLLH_MESSAGE_ID),
+        U_GNSS_DEC_UBX_NAV_HPPOSLLH_BODY_MIN_LENGTH, sizeof(uGnssDecUbxNavHpposllh_t),
+        gUbxNavHpposllhFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxNavHpposllhFieldList),
+        NULL, NULL, 0
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_STATUS_MESSAGE_CLASS,
+                           U_GNSS_DEC_UBX_NAV_STATUS_MESSAGE_ID),
+        U_GNSS_DEC_UBX_NAV_STATUS_BODY_MIN_LENGTH, sizeof(uGnssDecUbxNavStatus_t),
+        gUbxNavStatusFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxNavStatusFieldList),
+        NULL, NULL, 0
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_DOP_MESSAGE_CLASS,
+                           U_GNSS_DEC_UBX_NAV_DOP_MESSAGE_ID),
+        U_GNSS_DEC_UBX_NAV_DOP_BODY_MIN_LENGTH, sizeof(uGnssDecUbxNavDop_t),
+        gUbxNavDopFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxNavDopFieldList),
+        NULL, NULL, 0
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_COV_MESSAGE_CLASS,
+                           U_GNSS_DEC_UBX_NAV_COV_MESSAGE_ID),
+        U_GNSS_DEC_UBX_NAV_COV_BODY_MIN_LENGTH, sizeof(uGnssDecUbxNavCov_t),
+        gUbxNavCovFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxNavCovFieldList),
+        NULL, NULL, 0
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_SAT_MESSAGE_CLASS,
+                           U_GNSS_DEC_UBX_NAV_SAT_MESSAGE_ID),
+        U_GNSS_DEC_UBX_NAV_SAT_BODY_MIN_LENGTH, sizeof(uGnssDecUbxNavSat_t),
+        gUbxNavSatFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxNavSatFieldList),
+        &gUbxNavSatBlock, NULL, 0
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_SIG_MESSAGE_CLASS,
+                           U_GNSS_DEC_UBX_NAV_SIG_MESSAGE_ID),
+        U_GNSS_DEC_UBX_NAV_SIG_BODY_MIN_LENGTH, sizeof(uGnssDecUbxNavSig_t),
+        gUbxNavSigFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxNavSigFieldList),
+        &gUbxNavSigBlock, NULL, 0
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_RXM_RAWX_MESSAGE_CLASS,
+                           U_GNSS_DEC_UBX_RXM_RAWX_MESSAGE_ID),
+        U_GNSS_DEC_UBX_RXM_RAWX_BODY_MIN_LENGTH, sizeof(uGnssDecUbxRxmRawx_t),
+        gUbxRxmRawxFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxRxmRawxFieldList),
+        &gUbxRxmRawxBlock, NULL, 0
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_RXM_SFRBX_MESSAGE_CLASS,
+                           U_GNSS_DEC_UBX_RXM_SFRBX_MESSAGE_ID),
+        U_GNSS_DEC_UBX_RXM_SFRBX_BODY_MIN_LENGTH, sizeof(uGnssDecUbxRxmSfrbx_t),
+        gUbxRxmSfrbxFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxRxmSfrbxFieldList),
+        &gUbxRxmSfrbxBlock, NULL, 0
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_ESF_MEAS_MESSAGE_CLASS,
+                           U_GNSS_DEC_UBX_ESF_MEAS_MESSAGE_ID),
+        U_GNSS_DEC_UBX_ESF_MEAS_BODY_MIN_LENGTH, sizeof(uGnssDecUbxEsfMeas_t),
+        gUbxEsfMeasFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxEsfMeasFieldList),
+        &gUbxEsfMeasBlock, gUbxEsfMeasTrailerFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxEsfMeasTrailerFieldList)
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_ESF_INS_MESSAGE_CLASS,
+                           U_GNSS_DEC_UBX_ESF_INS_MESSAGE_ID),
+        U_GNSS_DEC_UBX_ESF_INS_BODY_MIN_LENGTH, sizeof(uGnssDecUbxEsfIns_t),
+        gUbxEsfInsFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxEsfInsFieldList),
+        NULL, NULL, 0
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_TIM_TP_MESSAGE_CLASS,
+                           U_GNSS_DEC_UBX_TIM_TP_MESSAGE_ID),
+        U_GNSS_DEC_UBX_TIM_TP_BODY_MIN_LENGTH, sizeof(uGnssDecUbxTimTp_t),
+        gUbxTimTpFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxTimTpFieldList),
+        NULL, NULL, 0
+    },
+    {
+        U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_MON_RF_MESSAGE_CLASS,
+                           U_GNSS_DEC_UBX_MON_RF_MESSAGE_ID),
+        U_GNSS_DEC_UBX_MON_RF_BODY_MIN_LENGTH, sizeof(uGnssDecUbxMonRf_t),
+        gUbxMonRfFieldList, U_GNSS_DEC_ARRAY_COUNT(gUbxMonRfFieldList),
+        &gUbxMonRfBlock, NULL, 0
+    }
+};
+
+/** The list of known message IDs; order is important, the UBX
+ * entries MUST be in the same order as gUbxMessageList and are
+ * followed by the NMEA entries of U_GNSS_DEC_NMEA_ID_LIST.
  */
 static const uGnssMessageId_t gIdList[] = {
     {
@@ -159,244 +909,611 @@ static const uGnssMessageId_t gIdList[] = {
     {
         .type = U_GNSS_PROTOCOL_UBX,
         .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_HPPOSLLH_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_HPPOSLLH_MESSAGE_ID)
-    }
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_STATUS_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_STATUS_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_DOP_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_DOP_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_COV_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_COV_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_SAT_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_SAT_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_NAV_SIG_MESSAGE_CLASS, U_GNSS_DEC_UBX_NAV_SIG_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_RXM_RAWX_MESSAGE_CLASS, U_GNSS_DEC_UBX_RXM_RAWX_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_RXM_SFRBX_MESSAGE_CLASS, U_GNSS_DEC_UBX_RXM_SFRBX_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_ESF_MEAS_MESSAGE_CLASS, U_GNSS_DEC_UBX_ESF_MEAS_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_ESF_INS_MESSAGE_CLASS, U_GNSS_DEC_UBX_ESF_INS_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_TIM_TP_MESSAGE_CLASS, U_GNSS_DEC_UBX_TIM_TP_MESSAGE_ID)
+    },
+    {
+        .type = U_GNSS_PROTOCOL_UBX,
+        .id.ubx = U_GNSS_UBX_MESSAGE(U_GNSS_DEC_UBX_MON_RF_MESSAGE_CLASS, U_GNSS_DEC_UBX_MON_RF_MESSAGE_ID)
+    },
+    U_GNSS_DEC_NMEA_ID_LIST
 };
 
-// MORE STATIC VARIABLES after the message decoders...
+// *** DO NOT MODIFY THIS LINE OR ABOVE: DO NOT MODIFY AREA ENDS ***
 
 /* ----------------------------------------------------------------
- * STATIC FUNCTIONS: MESSAGE DECODERS
+ * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
-// Decode a UBX-NAV-PVT message.
-static int32_t ubxNavPvtAlloc(const char *pBuffer, size_t size,
-                              uGnssDecUnion_t **ppBody)
+// Store a value in a member of a structure of the given size; use
+// memcpy() to store the value as the member may be a float, a double,
+// an enum or unaligned.
+static void valueStore(char *pMember, size_t size, uint64_t value)
 {
-    int32_t errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
-    uGnssDecUbxNavPvt_t *pBody;
+    uint8_t value8;
+    uint16_t value16;
+    uint32_t value32;
 
-    // No need to check pBuffer or ppBody for NULLity,
-    // we will never give this function NULL for those.
-    if (size >= U_UBX_PROTOCOL_HEADER_LENGTH_BYTES + U_GNSS_DEC_UBX_NAV_PVT_BODY_MIN_LENGTH) {
-        // Move past the header so that we can use payload offsets
-        // throughout, matching the offsets in the interface manual
-        pBuffer += U_UBX_PROTOCOL_HEADER_LENGTH_BYTES;
-        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-        pBody = (uGnssDecUbxNavPvt_t *) pUPortMalloc(sizeof(uGnssDecUbxNavPvt_t));
-        if (pBody != NULL) {
-            memset(pBody, 0, sizeof(*pBody));
-            // All good now, unless we hit a field we can't decode,
-            // in which case we _could_ set U_ERROR_COMMON_BAD_DATA,
-            // but, since this message will have been checked for
-            // integrity before it gets here, it is better to trust
-            // that the module emitted stuff correctly: it knows
-            // more about this than we do
-            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-            pBody->iTOW = (int32_t) uUbxProtocolUint32Decode(pBuffer + 0);
-            pBody->year = uUbxProtocolUint16Decode(pBuffer + 4);
-            pBody->month = (uint8_t) *(pBuffer + 6); // *NOPAD* stop AStyle making * look like a multiply
-            pBody->day = (uint8_t) *(pBuffer + 7); // *NOPAD*
-            pBody->hour = (uint8_t) *(pBuffer + 8); // *NOPAD*
-            pBody->min = (uint8_t) *(pBuffer + 9); // *NOPAD*
-            pBody->sec = (uint8_t) *(pBuffer + 10); // *NOPAD*
-            pBody->valid = (uint8_t) *(pBuffer + 11); // *NOPAD*
-            pBody->tAcc = uUbxProtocolUint32Decode(pBuffer + 12);
-            pBody->nano = (int32_t) uUbxProtocolUint32Decode(pBuffer + 16);
-            pBody->fixType = (uGnssDecUbxNavPvtFixType_t) *(pBuffer + 20); // *NOPAD*
-            pBody->flags = (uint8_t) *(pBuffer + 21); // *NOPAD*
-            pBody->flags2 = (uint8_t) *(pBuffer + 22); // *NOPAD*
-            pBody->numSV = (uint8_t) *(pBuffer + 23); // *NOPAD*
-            pBody->lon = (int32_t) uUbxProtocolUint32Decode(pBuffer + 24);
-            pBody->lat = (int32_t) uUbxProtocolUint32Decode(pBuffer + 28);
-            pBody->height = (int32_t) uUbxProtocolUint32Decode(pBuffer + 32);
-            pBody->hMSL = (int32_t) uUbxProtocolUint32Decode(pBuffer + 36);
-            pBody->hAcc = uUbxProtocolUint32Decode(pBuffer + 40);
-            pBody->vAcc = uUbxProtocolUint32Decode(pBuffer + 44);
-            pBody->velN = (int32_t) uUbxProtocolUint32Decode(pBuffer + 48);
-            pBody->velE = (int32_t) uUbxProtocolUint32Decode(pBuffer + 52);
-            pBody->velD = (int32_t) uUbxProtocolUint32Decode(pBuffer + 56);
-            pBody->gSpeed = (int32_t) uUbxProtocolUint32Decode(pBuffer + 60);
-            pBody->headMot = (int32_t) uUbxProtocolUint32Decode(pBuffer + 64);
-            pBody->sAcc = uUbxProtocolUint32Decode(pBuffer + 68);
-            pBody->headAcc = uUbxProtocolUint32Decode(pBuffer + 72);
-            pBody->pDOP = uUbxProtocolUint16Decode(pBuffer + 76);
-            pBody->flags3 = uUbxProtocolUint16Decode(pBuffer + 78);
-            // 4 reserved bytes here
-            pBody->headVeh = (int32_t) uUbxProtocolUint32Decode(pBuffer + 84);
-            pBody->magDec = (int16_t) uUbxProtocolUint16Decode(pBuffer + 88);
-            pBody->magAcc = (int16_t) uUbxProtocolUint16Decode(pBuffer + 90);
-
-            // Populate the pointer that was passed in
-            *ppBody = (uGnssDecUnion_t *) pBody;
+    switch (size) {
+        case 1:
+            value8 = (uint8_t) value;
+            memcpy(pMember, &value8, sizeof(value8));
+            break;
+        case 2:
+            value16 = (uint16_t) value;
+            memcpy(pMember, &value16, sizeof(value16));
+            break;
+        case 4:
+            value32 = (uint32_t) value;
+            memcpy(pMember, &value32, sizeof(value32));
+            break;
+        case 8:
+            memcpy(pMember, &value, sizeof(value));
+            break;
+        default:
+            break;
+    }
+}
+
+// Read a value of the given type from a UBX message body.
+static uint64_t ubxValueDecode(const char *pPayload, uGnssDecUbxType_t type)
+{
+    uint64_t value = 0;
+
+    switch (type) {
+        case U_GNSS_DEC_UBX_TYPE_U1:
+            value = (uint8_t) *pPayload; // *NOPAD* stop AStyle making * look like a multiply
+            break;
+        case U_GNSS_DEC_UBX_TYPE_I1:
+            value = (uint64_t) (int64_t) (int8_t) *pPayload; // *NOPAD*
+            break;
+        case U_GNSS_DEC_UBX_TYPE_U2:
+            value = uUbxProtocolUint16Decode(pPayload);
+            break;
+        case U_GNSS_DEC_UBX_TYPE_I2:
+            value = (uint64_t) (int64_t) (int16_t) uUbxProtocolUint16Decode(pPayload);
+            break;
+        case U_GNSS_DEC_UBX_TYPE_U4:
+            value = uUbxProtocolUint32Decode(pPayload);
+            break;
+        case U_GNSS_DEC_UBX_TYPE_I4:
+            value = (uint64_t) (int64_t) (int32_t) uUbxProtocolUint32Decode(pPayload);
+            break;
+        case U_GNSS_DEC_UBX_TYPE_U8:
+            value = uUbxProtocolUint64Decode(pPayload);
+            break;
+        default:
+            break;
+    }
+
+    return value;
+}
+
+// Decode a list of fields from a UBX message body into a structure,
+// ignoring any fields that do not fit into the given length.
+static void ubxFieldListDecode(const uGnssDecUbxField_t *pField,
+                               size_t numFields,
+                               const char *pPayload, size_t length,
+                               char *pStruct)
+{
+    for (size_t x = 0; x < numFields; x++, pField++) {
+        if (pField->payloadOffset + gUbxTypeWidth[pField->type] <= length) {
+            valueStore(pStruct + pField->structOffset, pField->structSize,
+                       ubxValueDecode(pPayload + pField->payloadOffset,
+                                      (uGnssDecUbxType_t) pField->type));
         }
     }
+}
 
-    return errorCode;
+// Find the description of a UBX message in gUbxMessageList.
+static const uGnssDecUbxMessage_t *pUbxMessageFind(uint16_t id)
+{
+    const uGnssDecUbxMessage_t *pMessage = NULL;
+
+    for (size_t x = 0; (pMessage == NULL) && (x < U_GNSS_DEC_ARRAY_COUNT(gUbxMessageList)); x++) {
+        if (gUbxMessageList[x].id == id) {
+            pMessage = &(gUbxMessageList[x]);
+        }
+    }
+
+    return pMessage;
 }
 
-// Decode a UBX-NAV-HPPOSLLH message.
-static int32_t ubxNavHpposllhAlloc(const char *pBuffer, size_t size,
-                                   uGnssDecUnion_t **ppBody)
+// Decode a UBX message into its structure, which must be at least
+// pMessage->structSize bytes big.
+static int32_t ubxDecode(const uGnssDecUbxMessage_t *pMessage,
+                         const char *pBuffer, char *pStruct)
 {
     int32_t errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
-    uGnssDecUbxNavHpposllh_t *pBody;
+    const uGnssDecUbxBlock_t *pBlock = pMessage->pBlock;
+    size_t length;
+    size_t count = 0;
+    size_t offset;
 
-    // No need to check pBuffer or ppBody for NULLity,
-    // we will never give this function NULL for those.
-    if (size >= U_UBX_PROTOCOL_HEADER_LENGTH_BYTES + U_GNSS_DEC_UBX_NAV_HPPOSLLH_BODY_MIN_LENGTH) {
+    // No need to check the pointers for NULLity or the buffer
+    // for length, the caller has done all that: just take the
+    // length of the body from the header
+    length = uUbxProtocolUint16Decode(pBuffer + 4);
+    if (length >= pMessage->bodyMinLength) {
         // Move past the header so that we can use payload offsets
         // throughout, matching the offsets in the interface manual
         pBuffer += U_UBX_PROTOCOL_HEADER_LENGTH_BYTES;
-        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-        pBody = (uGnssDecUbxNavHpposllh_t *) pUPortMalloc(sizeof(uGnssDecUbxNavHpposllh_t));
-        if (pBody != NULL) {
-            memset(pBody, 0, sizeof(*pBody));
-            // All good now, unless we hit a field we can't decode,
-            // in which case we _could_ set U_ERROR_COMMON_BAD_DATA,
-            // but, since this message will have been checked for
-            // integrity before it gets here, it is better to trust
-            // that the module emitted stuff correctly: it knows
-            // more about this than we do
-            errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-            pBody->version = (uint8_t) *(pBuffer + 0); // *NOPAD* stop AStyle making * look like a multiply
-            // 2 reserved bytes here
-            pBody->flags = (uint8_t) *(pBuffer + 3); // *NOPAD*
-            pBody->iTOW = (int32_t) uUbxProtocolUint32Decode(pBuffer + 4);
-            pBody->lon = (int32_t) uUbxProtocolUint32Decode(pBuffer + 8);
-            pBody->lat = (int32_t) uUbxProtocolUint32Decode(pBuffer + 12);
-            pBody->height = (int32_t) uUbxProtocolUint32Decode(pBuffer + 16);
-            pBody->hMSL = (int32_t) uUbxProtocolUint32Decode(pBuffer + 20);
-            pBody->lonHp = (int8_t) *(pBuffer + 24); // *NOPAD*
-            pBody->latHp = (int8_t) *(pBuffer + 25); // *NOPAD*
-            pBody->heightHp = (int8_t) *(pBuffer + 26); // *NOPAD*
-            pBody->hMSLHp = (int8_t) *(pBuffer + 27); // *NOPAD*
-            pBody->hAcc = uUbxProtocolUint32Decode(pBuffer + 28);
-            pBody->vAcc = uUbxProtocolUint32Decode(pBuffer + 32);
-
-            // Populate the pointer that was passed in
-            *ppBody = (uGnssDecUnion_t *) pBody;
+        memset(pStruct, 0, pMessage->structSize);
+        // All good now, unless we hit a field we can't decode,
+        // in which case we _could_ set U_ERROR_COMMON_BAD_DATA,
+        // but, since this message will have been checked for
+        // integrity before it gets here, it is better to trust
+        // that the module emitted stuff correctly: it knows
+        // more about this than we do
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        ubxFieldListDecode(pMessage->pFieldList, pMessage->numFields,
+                           pBuffer, length, pStruct);
+        offset = length;
+        if (pBlock != NULL) {
+            if (pBlock->countOffset + gUbxTypeWidth[pBlock->countType] <= length) {
+                count = (size_t) ((ubxValueDecode(pBuffer + pBlock->countOffset,
+                                                  (uGnssDecUbxType_t) pBlock->countType) >>
+                                   pBlock->countShift) & pBlock->countMask);
+            }
+            offset = pBlock->payloadOffset;
+            for (size_t x = 0; (x < count) && (x < pBlock->maxNum) &&
+                 (offset + pBlock->payloadLength <= length); x++) {
+                ubxFieldListDecode(pBlock->pFieldList, pBlock->numFields,
+                                   pBuffer + offset, pBlock->payloadLength,
+                                   pStruct + pBlock->structOffset + (x * pBlock->structLength));
+                offset += pBlock->payloadLength;
+            }
+            // Any trailing fields come after all of the blocks,
+            // including those we had no room for
+            offset = pBlock->payloadOffset + (count * pBlock->payloadLength);
+        }
+        if ((pMessage->pTrailerFieldList != NULL) && (offset < length)) {
+            ubxFieldListDecode(pMessage->pTrailerFieldList, pMessage->numTrailerFields,
+                               pBuffer + offset, length - offset, pStruct);
         }
     }
 
     return errorCode;
 }
 
-/* ----------------------------------------------------------------
- * STATIC VARIABLES: MESSAGE DECODER LIST
- * -------------------------------------------------------------- */
+// Get the next field of an NMEA sentence, starting at *ppCursor,
+// setting *ppField to the start of the field, returning its length
+// and moving *ppCursor on to the start of the following field (NULL
+// if there is none), or returning -1 if there are no more fields;
+// the sentence ends at the end of the buffer, at the '*' that
+// precedes the checksum or at a line ending.
+static int32_t nmeaFieldNext(const char **ppCursor, const char *pEnd,
+                             const char **ppField)
+{
+    int32_t length = -1;
+    const char *pCursor = *ppCursor;
 
-/** A list of message decode functions; order is important,
- * MUST be in the same order as gIdList and both lists
- * must contain the same number of elements.
- */
-static uGnssDecKnownFunction_t *gpFunctionList[] = {
-    ubxNavPvtAlloc,
-    ubxNavHpposllhAlloc
-};
+    if (pCursor != NULL) {
+        *ppField = pCursor;
+        length = 0;
+        while ((pCursor < pEnd) && (*pCursor != ',') && (*pCursor != '*') &&
+               (*pCursor != '\r') && (*pCursor != '\n')) {
+            pCursor++;
+            length++;
+        }
+        // Only a comma means that there is another field to come
+        *ppCursor = NULL;
+        if ((pCursor < pEnd) && (*pCursor == ',')) {
+            *ppCursor = pCursor + 1;
+        }
+    }
 
-/* ----------------------------------------------------------------
- * PUBLIC FUNCTIONS
- * -------------------------------------------------------------- */
+    return length;
+}
 
-// Decode a message buffer received from a GNSS device.
-uGnssDec_t *pUGnssDecAlloc(const char *pBuffer, size_t size)
+// Decode a signed decimal number, e.g. "-12.345", keeping the given
+// number of decimal places, so with decimals set to 2 that example
+// would give -1234; stops at the first character that is not part
+// of a number.  Returns false, with *pValue zero, if the number will
+// not fit into an int64_t, which can only happen if the field is
+// corrupt.
+static bool nmeaDecimalDecode(const char *pField, size_t length,
+                              uint8_t decimals, int64_t *pValue)
+{
+    int64_t value = 0;
+    bool negative = false;
+    bool fraction = false;
+    bool success = true;
+    size_t x = 0;
+
+    if ((length > 0) && ((*pField == '-') || (*pField == '+'))) {
+        negative = (*pField == '-');
+        x++;
+    }
+    for (; success && (x < length) && (!fraction || (decimals > 0)); x++) {
+        if ((pField[x] >= '0') && (pField[x] <= '9')) {
+            if (value > (INT64_MAX - 9) / 10) {
+                success = false;
+            } else {
+                value = (value * 10) + (pField[x] - '0');
+                if (fraction) {
+                    decimals--;
+                }
+            }
+        } else if ((pField[x] == '.') && !fraction) {
+            fraction = true;
+        } else {
+            break;
+        }
+    }
+    // Pad out any decimal places that weren't there
+    for (; success && (decimals > 0); decimals--) {
+        if (value > INT64_MAX / 10) {
+            success = false;
+        } else {
+            value *= 10;
+        }
+    }
+    *pValue = 0;
+    if (success) {
+        *pValue = negative ? -value : value;
+    }
+
+    return success;
+}
+
+// Decode a latitude or longitude, ddmm.mmmmm or dddmm.mmmmm, into
+// degrees with the given number of decimal places; returns false,
+// with *pValue zero, if the field is too long to decode.
+static bool nmeaDegreesMinutesDecode(const char *pField, size_t length,
+                                     uint8_t decimals, int64_t *pValue)
+{
+    size_t degreesLength = 0;
+    int64_t minutes;
+    bool success;
+
+    // The degrees are everything up to the two digits of
+    // whole minutes before the decimal point
+    while ((degreesLength < length) && (pField[degreesLength] != '.')) {
+        degreesLength++;
+    }
+    if (degreesLength > 2) {
+        degreesLength -= 2;
+    } else {
+        degreesLength = 0;
+    }
+    success = nmeaDecimalDecode(pField, degreesLength, decimals, pValue) &&
+              nmeaDecimalDecode(pField + degreesLength, length - degreesLength,
+                                decimals, &minutes) &&
+              (minutes <= INT64_MAX - 30);
+    if (success) {
+        // Add the minutes, rounded, converted to degrees
+        minutes = (minutes + 30) / 60;
+        success = (*pValue <= INT64_MAX - minutes);
+        if (success) {
+            *pValue += minutes;
+        }
+    }
+    if (!success) {
+        *pValue = 0;
+    }
+
+    return success;
+}
+
+// Decode the fields of an NMEA sentence into its structure, which
+// must be at least pMessage->structSize bytes big.
+static int32_t nmeaDecode(const uGnssDecNmeaMessage_t *pMessage,
+                          const char *pBuffer, size_t size,
+                          char *pStruct)
+{
+    const char *pEnd = pBuffer + size;
+    const char *pCursor = pBuffer;
+    const char *pField = NULL;
+    const uGnssDecNmeaField_t *pFieldDesc = pMessage->pFieldList;
+    const uGnssDecNmeaField_t *pFieldDescEnd = pFieldDesc + pMessage->numFields;
+    uint32_t present = 0;
+    int32_t length;
+    size_t partLength;
+    int64_t value;
+    int32_t value32;
+    bool decoded;
+
+    memset(pStruct, 0, pMessage->structSize);
+    // Walk the sentence once, field by field, applying each
+    // field description as its field comes by; the caller has
+    // already checked that the address field is followed by a
+    // comma so we know there is at least one field
+    for (size_t field = 0; (pFieldDesc < pFieldDescEnd) &&
+         ((length = nmeaFieldNext(&pCursor, pEnd, &pField)) >= 0); field++) {
+        if ((length > 0) && (field > 0) && (field < 32)) {
+            present |= 1UL << field;
+        }
+        for (; (pFieldDesc < pFieldDescEnd) && (pFieldDesc->field == field); pFieldDesc++) {
+            if (pFieldDesc->charOffset < length) {
+                partLength = length - pFieldDesc->charOffset;
+                if ((pFieldDesc->charCount > 0) && (partLength > pFieldDesc->charCount)) {
+                    partLength = pFieldDesc->charCount;
+                }
+                value = 0;
+                decoded = true;
+                switch (pFieldDesc->type) {
+                    case U_GNSS_DEC_NMEA_TYPE_DECIMAL:
+                        decoded = nmeaDecimalDecode(pField + pFieldDesc->charOffset,
+                                                    partLength, pFieldDesc->decimals,
+                                                    &value);
+                        break;
+                    case U_GNSS_DEC_NMEA_TYPE_DEGREES_MINUTES:
+                        decoded = nmeaDegreesMinutesDecode(pField + pFieldDesc->charOffset,
+                                                           partLength, pFieldDesc->decimals,
+                                                           &value);
+                        break;
+                    case U_GNSS_DEC_NMEA_TYPE_YEAR:
+                        decoded = nmeaDecimalDecode(pField + pFieldDesc->charOffset,
+                                                    partLength, pFieldDesc->decimals,
+                                                    &value);
+                        if (decoded && (partLength <= 2)) {
+                            value += 2000;
+                        }
+                        break;
+                    case U_GNSS_DEC_NMEA_TYPE_CHAR:
+                        value = (uint8_t) pField[pFieldDesc->charOffset];
+                        break;
+                    case U_GNSS_DEC_NMEA_TYPE_HEMISPHERE:
+                        // Negate the (always 32-bit) member that was
+                        // populated by the previous field
+                        if ((pField[pFieldDesc->charOffset] == 'S') ||
+                            (pField[pFieldDesc->charOffset] == 'W')) {
+                            memcpy(&value32, pStruct + pFieldDesc->structOffset, sizeof(value32));
+                            value = -((int64_t) value32);
+                        } else {
+                            // Leave the member alone
+                            partLength = 0;
+                        }
+                        break;
+                    default:
+                        break;
+                }
+                if (!decoded) {
+                    // A number too big to hold means that the field
+                    // is corrupt: treat it as empty
+                    if (field < 32) {
+                        present &= ~(1UL << field);
+                    }
+                } else if (partLength > 0) {
+                    valueStore(pStruct + pFieldDesc->structOffset,
+                               pFieldDesc->structSize, (uint64_t) value);
+                }
+            }
+        }
+    }
+    memcpy(pStruct, &present, sizeof(present));
+
+    return (int32_t) U_ERROR_COMMON_SUCCESS;
+}
+
+// Find the description of an NMEA sentence in gNmeaMessageList
+// from the NMEA address field, e.g. "GPGGA".
+static const uGnssDecNmeaMessage_t *pNmeaMessageFind(const char *pAddress)
+{
+    const uGnssDecNmeaMessage_t *pMessage = NULL;
+
+    // Only standard sentences, a two-character talker ID
+    // followed by a three-character sentence formatter
+    if ((strlen(pAddress) == 5) && (*pAddress != 'P')) {
+        for (size_t x = 0; (pMessage == NULL) && (x < U_GNSS_DEC_ARRAY_COUNT(gNmeaMessageList)); x++) {
+            if (strcmp(pAddress + 2, gNmeaMessageList[x].pFormatter) == 0) {
+                pMessage = &(gNmeaMessageList[x]);
+            }
+        }
+    }
+
+    return pMessage;
+}
+
+// Determine the protocol and message ID of a message and check that
+// its header is sound, returning true and populating pDecoder if
+// it is a message that we can decode.
+static bool idDecode(const char *pBuffer, size_t size, uGnssDec_t *pDec,
+                     uGnssDecDecoder_t *pDecoder)
 {
-    uGnssDec_t *pDec = NULL;
     uint8_t *pBufferUint8 = (uint8_t *) pBuffer; // To avoid problems with signed char compares
-    uGnssDecKnownFunction_t *pFunction = NULL;
     size_t x;
     size_t y;
 
-    pDec = (uGnssDec_t *) pUPortMalloc(sizeof(uGnssDec_t));
-    if (pDec != NULL) {
-        memset(pDec, 0, sizeof(*pDec));
-        pDec->errorCode = (int32_t) U_ERROR_COMMON_EMPTY;
-        pDec->id.type = U_GNSS_PROTOCOL_UNKNOWN;
-        if ((pBufferUint8 != NULL) && (size > 0)) {
-            // Determine the protocol type/message ID and make
-            // sure the header is sound
-            pDec->errorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
-            if ((*pBufferUint8 == 0xB5) && (size >= 1) && (*(pBufferUint8 + 1) == 0x62)) {
-                // Likely a UBX message
+    memset(pDecoder, 0, sizeof(*pDecoder));
+    memset(pDec, 0, sizeof(*pDec));
+    pDec->errorCode = (int32_t) U_ERROR_COMMON_EMPTY;
+    pDec->id.type = U_GNSS_PROTOCOL_UNKNOWN;
+    if ((pBufferUint8 != NULL) && (size > 0)) {
+        // Determine the protocol type/message ID and make
+        // sure the header is sound
+        pDec->errorCode = (int32_t) U_ERROR_COMMON_UNKNOWN;
+        if ((*pBufferUint8 == 0xB5) && (size >= 1) && (*(pBufferUint8 + 1) == 0x62)) {
+            // Likely a UBX message
+            pBufferUint8 += 2;
+            pDec->id.type = U_GNSS_PROTOCOL_UBX;
+            pDec->errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
+            if (size >= U_UBX_PROTOCOL_HEADER_LENGTH_BYTES) {
+                // Grab the message class and message ID, check the length,
+                // allowing the checksum bytes to be omitted
+                pDec->id.id.ubx = U_GNSS_UBX_MESSAGE(*pBufferUint8, *(pBufferUint8 + 1));
                 pBufferUint8 += 2;
-                pDec->id.type = U_GNSS_PROTOCOL_UBX;
-                pDec->errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
-                if (size >= U_UBX_PROTOCOL_HEADER_LENGTH_BYTES) {
-                    // Grab the message class and message ID, check the length,
-                    // allowing the checksum bytes to be omitted
-                    pDec->id.id.ubx = U_GNSS_UBX_MESSAGE(*pBufferUint8, *(pBufferUint8 + 1));
-                    pBufferUint8 += 2;
-                    y = *pBufferUint8 + ((uint16_t) *(pBufferUint8 + 1) << 8); // *NOPAD*
-                    if (size >= y + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES) {
-                        pDec->errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                    }
-                }
-            } else if (*pBufferUint8 == '$') {
-                // Likely an NMEA message
-                pBufferUint8++;
-                y = size - 1;
-                pDec->id.type = U_GNSS_PROTOCOL_NMEA;
-                pDec->errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
-                for (x = 0; (((*pBufferUint8 >= 'A') && (*pBufferUint8 <= 'Z')) ||
-                             ((*pBufferUint8 >= '0') && (*pBufferUint8 <= '9'))) &&
-                     (x < y) && (x < sizeof(pDec->nmea) - 1); x++) {
-                    // Looking for up to U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS
-                    // characters in the range 0-9, A-Z, followed by a comma
-                    pDec->nmea[x] = *pBufferUint8;
-                    pBufferUint8++;
-                }
-                if ((x < y) && (*pBufferUint8 == ',')) {
-                    pDec->id.id.pNmea = pDec->nmea;
+                y = *pBufferUint8 + ((uint16_t) *(pBufferUint8 + 1) << 8); // *NOPAD*
+                if (size >= y + U_UBX_PROTOCOL_HEADER_LENGTH_BYTES) {
                     pDec->errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                 }
-                // No need to add a terminator since we zeroed the structure to begin with
-            } else if (*pBufferUint8 == 0xD3) {
-                // Likely an RTCM message
+            }
+        } else if (*pBufferUint8 == '$') {
+            // Likely an NMEA message
+            pBufferUint8++;
+            y = size - 1;
+            pDec->id.type = U_GNSS_PROTOCOL_NMEA;
+            pDec->errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
+            for (x = 0; (((*pBufferUint8 >= 'A') && (*pBufferUint8 <= 'Z')) ||
+                         ((*pBufferUint8 >= '0') && (*pBufferUint8 <= '9'))) &&
+                 (x < y) && (x < sizeof(pDec->nmea) - 1); x++) {
+                // Looking for up to U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS
+                // characters in the range 0-9, A-Z, followed by a comma
+                pDec->nmea[x] = *pBufferUint8;
                 pBufferUint8++;
-                pDec->id.type = U_GNSS_PROTOCOL_RTCM;
-                pDec->errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
-                // Length is only in the first three bits of the first length byte,
-                // the rest must be zero
-                if ((size >= 1 /* D3 */ + 2 /* length */) &&
-                    ((*pBufferUint8 & 0xFC) == 0)) {
-                    y = ((uint16_t) (*pBufferUint8 & 0x03) << 8) + *(pBufferUint8 + 1);
-                    pBufferUint8 += 2;
-                    if (size >= 1 /* D3 */ + 2 /* length */ + 2 /* ID */) {
-                        // Grab the ID from the next two bytes
-                        pDec->id.id.rtcm = (*(pBufferUint8 + 1) >> 4) + (uint16_t) (((uint16_t) * pBufferUint8) <<
-                                                                                    4); // *NOPAD*
-                        if (size >= 1 /* D3 */ + 2 /* length */ + y /* length includes the message ID */ ) {
-                            // Check the length, allowing the CRC bytes to be omitted
-                            pDec->errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
-                        }
+            }
+            if ((x < y) && (*pBufferUint8 == ',')) {
+                pDec->id.id.pNmea = pDec->nmea;
+                pDec->errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+            // No need to add a terminator since we zeroed the structure to begin with
+        } else if (*pBufferUint8 == 0xD3) {
+            // Likely an RTCM message
+            pBufferUint8++;
+            pDec->id.type = U_GNSS_PROTOCOL_RTCM;
+            pDec->errorCode = (int32_t) U_ERROR_COMMON_TRUNCATED;
+            // Length is only in the first three bits of the first length byte,
+            // the rest must be zero
+            if ((size >= 1 /* D3 */ + 2 /* length */) &&
+                ((*pBufferUint8 & 0xFC) == 0)) {
+                y = ((uint16_t) (*pBufferUint8 & 0x03) << 8) + *(pBufferUint8 + 1);
+                pBufferUint8 += 2;
+                if (size >= 1 /* D3 */ + 2 /* length */ + 2 /* ID */) {
+                    // Grab the ID from the next two bytes
+                    pDec->id.id.rtcm = (*(pBufferUint8 + 1) >> 4) + (uint16_t) (((uint16_t) * pBufferUint8) <<
+                                                                                4); // *NOPAD*
+                    if (size >= 1 /* D3 */ + 2 /* length */ + y /* length includes the message ID */ ) {
+                        // Check the length, allowing the CRC bytes to be omitted
+                        pDec->errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                     }
                 }
             }
-            if (pDec->errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
-                // Got a known protocol, an ID and a valid length, see if we have
-                // a decoder for this message ID
-                pDec->errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
-                for (x = 0; (pFunction == NULL) && (x < sizeof(gIdList) / sizeof(gIdList[0])); x++) {
-                    if (uGnssMsgIdIsWanted(&(pDec->id), (uGnssMessageId_t *) & (gIdList[x]))) {
-                        pFunction = gpFunctionList[x];
-                    }
+        }
+        if (pDec->errorCode == (int32_t) U_ERROR_COMMON_SUCCESS) {
+            // Got a known protocol, an ID and a valid length, see if we have
+            // a decoder for this message ID
+            pDec->errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (pDec->id.type == U_GNSS_PROTOCOL_UBX) {
+                pDecoder->pUbx = pUbxMessageFind(pDec->id.id.ubx);
+                if (pDecoder->pUbx != NULL) {
+                    pDecoder->structSize = pDecoder->pUbx->structSize;
                 }
-                if (pFunction != NULL) {
-                    // Found a matching decoder, run it
-                    pDec->errorCode = pFunction(pBuffer, size, &(pDec->pBody));
+            } else if (pDec->id.type == U_GNSS_PROTOCOL_NMEA) {
+                pDecoder->pNmea = pNmeaMessageFind(pDec->nmea);
+                if (pDecoder->pNmea != NULL) {
+                    pDecoder->structSize = pDecoder->pNmea->structSize;
                 }
             }
-            if ((pDec->errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) &&
-                (gpCallback != NULL)) {
-                // Couldn't decode the message: let the user callback try
-                pDec->errorCode = gpCallback(&(pDec->id), pBuffer, size, &(pDec->pBody), gpCallbackParam);
+        }
+    }
+
+    return (pDecoder->structSize > 0);
+}
+
+// Run the decoder found by idDecode(), writing to pStruct, which
+// must be at least pDecoder->structSize bytes big.
+static int32_t decode(const uGnssDecDecoder_t *pDecoder,
+                      const char *pBuffer, size_t size, char *pStruct)
+{
+    int32_t errorCode;
+
+    if (pDecoder->pUbx != NULL) {
+        errorCode = ubxDecode(pDecoder->pUbx, pBuffer, pStruct);
+    } else {
+        errorCode = nmeaDecode(pDecoder->pNmea, pBuffer, size, pStruct);
+    }
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Decode a message buffer received from a GNSS device.
+uGnssDec_t *pUGnssDecAlloc(const char *pBuffer, size_t size)
+{
+    uGnssDec_t *pDec = NULL;
+    uGnssDecDecoder_t decoder;
+
+    pDec = (uGnssDec_t *) pUPortMalloc(sizeof(uGnssDec_t));
+    if (pDec != NULL) {
+        if (idDecode(pBuffer, size, pDec, &decoder)) {
+            // Found a matching decoder, run it
+            pDec->errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            pDec->pBody = (uGnssDecUnion_t *) pUPortMalloc(decoder.structSize);
+            if (pDec->pBody != NULL) {
+                pDec->errorCode = decode(&decoder, pBuffer, size, (char *) pDec->pBody);
+                if (pDec->errorCode != 0) {
+                    uPortFree(pDec->pBody);
+                    pDec->pBody = NULL;
+                }
             }
         }
+        if ((pBuffer != NULL) && (size > 0) &&
+            (pDec->errorCode != (int32_t) U_ERROR_COMMON_SUCCESS) &&
+            (gpCallback != NULL)) {
+            // Couldn't decode the message: let the user callback try
+            pDec->errorCode = gpCallback(&(pDec->id), pBuffer, size, &(pDec->pBody), gpCallbackParam);
+        }
     }
 
     return pDec;
 }
 
+// Decode a message buffer into memory provided by the caller.
+int32_t uGnssDecIntoBuffer(const char *pBuffer, size_t size,
+                           uGnssDec_t *pDec, void *pBody,
+                           size_t bodySize)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uGnssDecDecoder_t decoder;
+
+    if (pDec != NULL) {
+        if (idDecode(pBuffer, size, pDec, &decoder)) {
+            pDec->errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+            if ((pBody != NULL) && (bodySize >= decoder.structSize)) {
+                pDec->errorCode = decode(&decoder, pBuffer, size, (char *) pBody);
+                if (pDec->errorCode == 0) {
+                    pDec->pBody = (uGnssDecUnion_t *) pBody;
+                }
+            }
+        }
+        errorCode = pDec->errorCode;
+    }
+
+    return errorCode;
+}
+
 // Free the memory returned by pUGnssDecAlloc().
 void uGnssDecFree(uGnssDec_t *pDec)
 {
@@ -413,7 +1530,7 @@ int32_t uGnssDecGetIdList(const uGnssMessageId_t **ppIdList)
         *ppIdList = gIdList;
     }
 
-    return sizeof(gIdList) / sizeof(gIdList[0]);
+    return U_GNSS_DEC_ARRAY_COUNT(gIdList);
 }
 
 // Add a custom decoder.
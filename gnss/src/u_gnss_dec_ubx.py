@@ -0,0 +1,415 @@
+#!/usr/bin/env python
+
+'''Update the file u_gnss_dec.c with UBX message field tables.'''
+
+from multiprocessing import Process, freeze_support # Needed to make Windows behave
+                                                    # when run under multiprocessing,
+from signal import signal, SIGINT   # For CTRL-C handling
+import os
+import sys # For exit() and stdout
+import argparse
+import shutil
+
+# This script re-writes the end of the file u_gnss_dec.c with
+# C tables that describe, field by field, each of the UBX messages
+# that u_gnss_dec.c is able to decode; u_gnss_dec.c then uses these
+# tables to decode a message into the structure for that message,
+# e.g. uGnssDecUbxNavPvt_t, which must already have been written,
+# by hand, in the corresponding header file in the "api" directory,
+# e.g. u_gnss_dec_ubx_nav_pvt.h.
+#
+# It works like this:
+#
+# 1. MESSAGE_LIST, below, contains an entry for each UBX message,
+#    written in the terms of the GNSS device interface manual: the
+#    name of the message, e.g. "NAV-PVT", and, for each field of the
+#    message body, its offset, its type (e.g. "U4") and its name,
+#    which must be the name of the corresponding member of the
+#    message structure.  A message may also contain a single
+#    repeated block, e.g. one block per satellite, with its own
+#    list of fields, and a list of trailing fields that come after
+#    the repeated blocks.  Reserved fields are simply left out.
+#
+# 2. From the name of the message it derives the names of the
+#    message structure, e.g. uGnssDecUbxNavPvt_t, and of the macros
+#    in the header file, e.g. U_GNSS_DEC_UBX_NAV_PVT_MESSAGE_CLASS,
+#    U_GNSS_DEC_UBX_NAV_PVT_MESSAGE_ID and
+#    U_GNSS_DEC_UBX_NAV_PVT_BODY_MIN_LENGTH.
+#
+# 3. It writes a field list for each message, a message list
+#    and the list of message IDs that uGnssDecGetIdList() returns;
+#    structure offsets and sizes are written in terms of offsetof()
+#    and sizeof() so that the compiler checks that the field names
+#    match those of the message structure.
+#
+# 4. It looks for two markers in the file:
+#
+#    // *** DO NOT MODIFY THIS LINE OR BELOW: AUTO-GENERATED BY u_gnss_dec_ubx.py ***
+#
+#   ...and
+#
+#    // *** DO NOT MODIFY THIS LINE OR ABOVE: DO NOT MODIFY AREA ENDS ***
+#
+#    ...erases anything between them and writes the tables there
+#    instead.  A backup is made of the current file, just in case.
+
+# The file to be read/modified
+TARGET_FILE_NAME = "u_gnss_dec.c"
+
+# The file extension to be used for the back-up of the file
+BACKUP_EXTENSION = "_bak"
+
+# The marker to look for, beyond which we can re-write the target
+# file up to FILE_REWRITE_MARKER_END
+FILE_REWRITE_MARKER_START = "// *** DO NOT MODIFY THIS LINE OR BELOW: AUTO-GENERATED BY u_gnss_dec_ubx.py ***"
+
+# The marker up to which the target file can be re-written
+FILE_REWRITE_MARKER_END = "// *** DO NOT MODIFY THIS LINE OR ABOVE: DO NOT MODIFY AREA ENDS ***"
+
+# The interface manual field types and the entry of
+# uGnssDecUbxType_t in u_gnss_dec.c that each is decoded as: bit
+# fields are unsigned and floating point types are carried as
+# their bit pattern
+TYPE_LIST = {"U1": "U1", "X1": "U1", "I1": "I1",
+             "U2": "U2", "X2": "U2", "I2": "I2",
+             "U4": "U4", "X4": "U4", "I4": "I4", "R4": "U4",
+             "U8": "U8", "X8": "U8", "I8": "U8", "R8": "U8"}
+
+# The width in bytes of each interface manual field type
+TYPE_WIDTH_LIST = {"U1": 1, "X1": 1, "I1": 1,
+                   "U2": 2, "X2": 2, "I2": 2,
+                   "U4": 4, "X4": 4, "I4": 4, "R4": 4,
+                   "U8": 8, "X8": 8, "I8": 8, "R8": 8}
+
+# The UBX messages: see the description at the top of this file.
+# A repeated block has the following entries:
+# - "member": the name of the array in the message structure,
+# - "type": the C type of an element of that array,
+# - "offset": the offset of the first block in the message body,
+# - "length": the length of one block in the message body,
+# - "count": the offset, type, bit-shift and bit-mask of the field
+#   of the message body that gives the number of blocks,
+# - "fields": the fields of a block, offsets being from the start
+#   of the block; a field name of None means the whole element.
+# The offsets of any "trailer" fields are from the end of the
+# repeated blocks.
+MESSAGE_LIST = [
+    {"name": "NAV-PVT",
+     "fields": [(0, "U4", "iTOW"), (4, "U2", "year"), (6, "U1", "month"),
+                (7, "U1", "day"), (8, "U1", "hour"), (9, "U1", "min"),
+                (10, "U1", "sec"), (11, "X1", "valid"), (12, "U4", "tAcc"),
+                (16, "I4", "nano"), (20, "U1", "fixType"), (21, "X1", "flags"),
+                (22, "X1", "flags2"), (23, "U1", "numSV"), (24, "I4", "lon"),
+                (28, "I4", "lat"), (32, "I4", "height"), (36, "I4", "hMSL"),
+                (40, "U4", "hAcc"), (44, "U4", "vAcc"), (48, "I4", "velN"),
+                (52, "I4", "velE"), (56, "I4", "velD"), (60, "I4", "gSpeed"),
+                (64, "I4", "headMot"), (68, "U4", "sAcc"), (72, "U4", "headAcc"),
+                (76, "U2", "pDOP"), (78, "X2", "flags3"), (84, "I4", "headVeh"),
+                (88, "I2", "magDec"), (90, "U2", "magAcc")]},
+    {"name": "NAV-HPPOSLLH",
+     "fields": [(0, "U1", "version"), (3, "X1", "flags"), (4, "U4", "iTOW"),
+                (8, "I4", "lon"), (12, "I4", "lat"), (16, "I4", "height"),
+                (20, "I4", "hMSL"), (24, "I1", "lonHp"), (25, "I1", "latHp"),
+                (26, "I1", "heightHp"), (27, "I1", "hMSLHp"), (28, "U4", "hAcc"),
+                (32, "U4", "vAcc")]},
+    {"name": "NAV-STATUS",
+     "fields": [(0, "U4", "iTOW"), (4, "U1", "gpsFix"), (5, "X1", "flags"),
+                (6, "X1", "fixStat"), (7, "X1", "flags2"), (8, "U4", "ttff"),
+                (12, "U4", "msss")]},
+    {"name": "NAV-DOP",
+     "fields": [(0, "U4", "iTOW"), (4, "U2", "gDOP"), (6, "U2", "pDOP"),
+                (8, "U2", "tDOP"), (10, "U2", "vDOP"), (12, "U2", "hDOP"),
+                (14, "U2", "nDOP"), (16, "U2", "eDOP")]},
+    {"name": "NAV-COV",
+     "fields": [(0, "U4", "iTOW"), (4, "U1", "version"), (5, "U1", "posCovValid"),
+                (6, "U1", "velCovValid"), (16, "R4", "posCovNN"),
+                (20, "R4", "posCovNE"), (24, "R4", "posCovND"),
+                (28, "R4", "posCovEE"), (32, "R4", "posCovED"),
+                (36, "R4", "posCovDD"), (40, "R4", "velCovNN"),
+                (44, "R4", "velCovNE"), (48, "R4", "velCovND"),
+                (52, "R4", "velCovEE"), (56, "R4", "velCovED"),
+                (60, "R4", "velCovDD")]},
+    {"name": "NAV-SAT",
+     "fields": [(0, "U4", "iTOW"), (4, "U1", "version"), (5, "U1", "numSvs")],
+     "block": {"member": "sv", "type": "uGnssDecUbxNavSatSv_t",
+               "offset": 8, "length": 12, "count": (5, "U1", 0, 0xff),
+               "fields": [(0, "U1", "gnssId"), (1, "U1", "svId"), (2, "U1", "cno"),
+                          (3, "I1", "elev"), (4, "I2", "azim"), (6, "I2", "prRes"),
+                          (8, "X4", "flags")]}},
+    {"name": "NAV-SIG",
+     "fields": [(0, "U4", "iTOW"), (4, "U1", "version"), (5, "U1", "numSigs")],
+     "block": {"member": "sig", "type": "uGnssDecUbxNavSigSig_t",
+               "offset": 8, "length": 16, "count": (5, "U1", 0, 0xff),
+               "fields": [(0, "U1", "gnssId"), (1, "U1", "svId"), (2, "U1", "sigId"),
+                          (3, "U1", "freqId"), (4, "I2", "prRes"), (6, "U1", "cno"),
+                          (7, "U1", "qualityInd"), (8, "U1", "corrSource"),
+                          (9, "U1", "ionoModel"), (10, "X2", "sigFlags")]}},
+    {"name": "RXM-RAWX",
+     "fields": [(0, "R8", "rcvTow"), (8, "U2", "week"), (10, "I1", "leapS"),
+                (11, "U1", "numMeas"), (12, "X1", "recStat"), (13, "U1", "version")],
+     "block": {"member": "meas", "type": "uGnssDecUbxRxmRawxMeas_t",
+               "offset": 16, "length": 32, "count": (11, "U1", 0, 0xff),
+               "fields": [(0, "R8", "prMes"), (8, "R8", "cpMes"), (16, "R4", "doMes"),
+                          (20, "U1", "gnssId"), (21, "U1", "svId"), (22, "U1", "sigId"),
+                          (23, "U1", "freqId"), (24, "U2", "locktime"), (26, "U1", "cno"),
+                          (27, "X1", "prStdev"), (28, "X1", "cpStdev"),
+                          (29, "X1", "doStdev"), (30, "X1", "trkStat")]}},
+    {"name": "RXM-SFRBX",
+     "fields": [(0, "U1", "gnssId"), (1, "U1", "svId"), (2, "U1", "sigId"),
+                (3, "U1", "freqId"), (4, "U1", "numWords"), (5, "U1", "chn"),
+                (6, "U1", "version")],
+     "block": {"member": "dwrd", "type": "uint32_t",
+               "offset": 8, "length": 4, "count": (4, "U1", 0, 0xff),
+               "fields": [(0, "U4", None)]}},
+    {"name": "ESF-MEAS",
+     "fields": [(0, "U4", "timeTag"), (4, "X2", "flags"), (6, "U2", "id")],
+     "block": {"member": "data", "type": "uint32_t",
+               "offset": 8, "length": 4, "count": (4, "X2", 11, 0x1f),
+               "fields": [(0, "X4", None)]},
+     "trailer": [(0, "U4", "calibTtag")]},
+    {"name": "ESF-INS",
+     "fields": [(0, "X4", "bitfield0"), (8, "U4", "iTOW"), (12, "I4", "xAngRate"),
+                (16, "I4", "yAngRate"), (20, "I4", "zAngRate"), (24, "I4", "xAccel"),
+                (28, "I4", "yAccel"), (32, "I4", "zAccel")]},
+    {"name": "TIM-TP",
+     "fields": [(0, "U4", "towMS"), (4, "U4", "towSubMS"), (8, "I4", "qErr"),
+                (12, "U2", "week"), (14, "X1", "flags"), (15, "X1", "refInfo")]},
+    {"name": "MON-RF",
+     "fields": [(0, "U1", "version"), (1, "U1", "nBlocks")],
+     "block": {"member": "block", "type": "uGnssDecUbxMonRfBlock_t",
+               "offset": 4, "length": 24, "count": (1, "U1", 0, 0xff),
+               "fields": [(0, "U1", "blockId"), (1, "X1", "flags"),
+                          (2, "U1", "antStatus"), (3, "U1", "antPower"),
+                          (4, "X4", "postStatus"), (12, "U2", "noisePerMS"),
+                          (14, "U2", "agcCnt"), (16, "U1", "jamInd"),
+                          (17, "I1", "ofsI"), (18, "U1", "magI"),
+                          (19, "I1", "ofsQ"), (20, "U1", "magQ")]}}
+]
+
+def signal_handler(sig, frame):
+    '''CTRL-C Handler'''
+    del sig
+    del frame
+    sys.stdout.write('\n')
+    print("CTRL-C received, EXITING.")
+    sys.exit(-1)
+
+def camel_case(message_name):
+    '''Convert a message name, e.g. "NAV-PVT", to camel case, e.g. "NavPvt"'''
+    camel = ""
+    for bit in message_name.split("-"):
+        camel += bit[0].upper() + bit[1:].lower()
+    return camel
+
+def macro_prefix(message_name):
+    '''Convert a message name, e.g. "NAV-PVT", to a macro prefix, e.g. "U_GNSS_DEC_UBX_NAV_PVT"'''
+    return "U_GNSS_DEC_UBX_" + message_name.replace("-", "_").upper()
+
+def check_fields(message_name, field_list, length=None):
+    '''Check that the fields are in order, do not overlap and have known types'''
+    success = True
+    next_offset = 0
+
+    for field in field_list:
+        if field[1] not in TYPE_LIST:
+            print(f"{message_name}: field \"{field[2]}\" has unknown type \"{field[1]}\".")
+            success = False
+        elif field[0] < next_offset:
+            print(f"{message_name}: field \"{field[2]}\" at offset {field[0]}" \
+                  f" overlaps the field before it.")
+            success = False
+        else:
+            next_offset = field[0] + TYPE_WIDTH_LIST[field[1]]
+            if length is not None and next_offset > length:
+                print(f"{message_name}: field \"{field[2]}\" runs off the end of" \
+                      f" the block, which is of length {length}.")
+                success = False
+    return success
+
+def field_lines(struct_type, field_list):
+    '''Return the lines of C for a list of fields'''
+    line_list = []
+
+    for field in field_list:
+        if field[2]:
+            line_list.append(f"    U_GNSS_DEC_UBX_FIELD({struct_type}, {field[2]}," \
+                             f" {field[0]}, {TYPE_LIST[field[1]]}),\n")
+        else:
+            line_list.append(f"    U_GNSS_DEC_UBX_FIELD_WHOLE({struct_type}," \
+                             f" {field[0]}, {TYPE_LIST[field[1]]}),\n")
+    return line_list
+
+def message_lines(message):
+    '''Return the lines of C describing a message and the name of its descriptor'''
+    line_list = []
+    camel = camel_case(message["name"])
+    struct_type = "uGnssDecUbx" + camel + "_t"
+    block_name = "NULL"
+    trailer_name = "NULL"
+    trailer_count = "0"
+
+    line_list.append(f"/** The fields of UBX-{message['name']}.\n */\n")
+    line_list.append(f"static const uGnssDecUbxField_t gUbx{camel}FieldList[] = {{\n")
+    line_list += field_lines(struct_type, message["fields"])
+    line_list.append("};\n\n")
+    if "block" in message:
+        block = message["block"]
+        line_list.append(f"/** The fields of the repeated block of UBX-{message['name']}.\n */\n")
+        line_list.append(f"static const uGnssDecUbxField_t gUbx{camel}BlockFieldList[] = {{\n")
+        line_list += field_lines(block["type"], block["fields"])
+        line_list.append("};\n\n")
+        block_name = f"&gUbx{camel}Block"
+        count = block["count"]
+        line_list.append(f"/** The repeated block of UBX-{message['name']}.\n */\n")
+        line_list.append(f"static const uGnssDecUbxBlock_t gUbx{camel}Block = {{\n")
+        line_list.append(f"    {count[0]}, U_GNSS_DEC_UBX_TYPE_{TYPE_LIST[count[1]]}," \
+                         f" {count[2]}, 0x{count[3]:02x},\n")
+        line_list.append(f"    {block['offset']}, {block['length']},\n")
+        line_list.append(f"    offsetof({struct_type}, {block['member']}[0]),\n")
+        line_list.append(f"    sizeof((({struct_type} *) 0)->{block['member']}[0]),\n")
+        line_list.append(f"    U_GNSS_DEC_ARRAY_COUNT((({struct_type} *) 0)->{block['member']}),\n")
+        line_list.append(f"    gUbx{camel}BlockFieldList," \
+                         f" U_GNSS_DEC_ARRAY_COUNT(gUbx{camel}BlockFieldList)\n")
+        line_list.append("};\n\n")
+    if "trailer" in message:
+        line_list.append(f"/** The fields of UBX-{message['name']} after the repeated blocks.\n */\n")
+        line_list.append(f"static const uGnssDecUbxField_t gUbx{camel}TrailerFieldList[] = {{\n")
+        line_list += field_lines(struct_type, message["trailer"])
+        line_list.append("};\n\n")
+        trailer_name = f"gUbx{camel}TrailerFieldList"
+        trailer_count = f"U_GNSS_DEC_ARRAY_COUNT(gUbx{camel}TrailerFieldList)"
+
+    descriptor = f"    {{\n        U_GNSS_UBX_MESSAGE({macro_prefix(message['name'])}_MESSAGE_CLASS,\n" \
+                 f"                           {macro_prefix(message['name'])}_MESSAGE_ID),\n" \
+                 f"        {macro_prefix(message['name'])}_BODY_MIN_LENGTH, sizeof({struct_type}),\n" \
+                 f"        gUbx{camel}FieldList, U_GNSS_DEC_ARRAY_COUNT(gUbx{camel}FieldList),\n" \
+                 f"        {block_name}, {trailer_name}, {trailer_count}\n    }}"
+
+    return line_list, descriptor
+
+def generate_lines():
+    '''Return the lines of C for all of the messages, or an empty list on error'''
+    line_list = []
+    descriptor_list = []
+    id_list = []
+
+    for message in MESSAGE_LIST:
+        if not check_fields(message["name"], message["fields"]):
+            return []
+        if "block" in message and not check_fields(message["name"],
+                                                   message["block"]["fields"],
+                                                   message["block"]["length"]):
+            return []
+        if "trailer" in message and not check_fields(message["name"], message["trailer"]):
+            return []
+        lines, descriptor = message_lines(message)
+        line_list += lines
+        descriptor_list.append(descriptor)
+        id_list.append(f"    {{\n        .type = U_GNSS_PROTOCOL_UBX,\n" \
+                       f"        .id.ubx = U_GNSS_UBX_MESSAGE({macro_prefix(message['name'])}_MESSAGE_CLASS," \
+                       f" {macro_prefix(message['name'])}_MESSAGE_ID)\n    }}")
+        print(f"UBX-{message['name']}: {len(message['fields'])} field(s)" +  \
+              (f", a repeated block of {len(message['block']['fields'])} field(s)" \
+               if "block" in message else "") +                           \
+              (f", {len(message['trailer'])} trailing field(s)"             \
+               if "trailer" in message else "") + ".")
+
+    line_list.append("/** The list of UBX messages that can be decoded; order is\n" \
+                     " * important, MUST be in the same order as gIdList.\n */\n")
+    line_list.append("static const uGnssDecUbxMessage_t gUbxMessageList[] = {\n")
+    line_list.append(",\n".join(descriptor_list) + "\n};\n\n")
+    line_list.append("/** The list of known message IDs; order is important, the UBX\n" \
+                     " * entries MUST be in the same order as gUbxMessageList and are\n" \
+                     " * followed by the NMEA entries of U_GNSS_DEC_NMEA_ID_LIST.\n */\n")
+    line_list.append("static const uGnssMessageId_t gIdList[] = {\n")
+    line_list.append(",\n".join(id_list + ["    U_GNSS_DEC_NMEA_ID_LIST"]) + "\n};\n")
+
+    return line_list
+
+def rewrite_line_list(generated_line_list, input_line_list):
+    '''Re-write the line_list with the generated lines'''
+    output_line_list = []
+    start_marker_index = -1
+    end_marker_index = -1
+    output_line_list_one = []
+    output_line_list_three = []
+
+    for idx, line in enumerate(input_line_list):
+        # Make a list of all lines up to and include the start marker
+        output_line_list_one.append(line)
+        if line.startswith(FILE_REWRITE_MARKER_START):
+            start_marker_index = idx
+            break
+
+    if start_marker_index >= 0:
+        # Make a list of all lines from [including] the end marker to the end of the list
+        for idx, line in enumerate(input_line_list[start_marker_index:]):
+            if end_marker_index < 0 and line.startswith(FILE_REWRITE_MARKER_END):
+                end_marker_index = idx
+            if end_marker_index >= 0:
+                output_line_list_three.append(line)
+
+    if start_marker_index < 0:
+        print("Could not find the start marker \"{}\" in the file, stopping.".  \
+              format(FILE_REWRITE_MARKER_START))
+    else:
+        if end_marker_index < 0:
+            print("Could not find the end marker \"{}\" in the file, stopping.".  \
+                  format(FILE_REWRITE_MARKER_END))
+        else:
+            # Combine the three lists
+            output_line_list = output_line_list_one + ["\n"] + generated_line_list + \
+                               ["\n"] + output_line_list_three
+
+    return output_line_list
+
+def main(target_file):
+    '''Main as a function'''
+    return_value = 1
+    line_list = []
+
+    signal(SIGINT, signal_handler)
+
+    if os.path.isfile(target_file):
+        with open(target_file, "r", encoding="utf8") as file:
+            # Read the lot in
+            print(f"Reading file {target_file}...")
+            line_list = file.readlines()
+        generated_line_list = generate_lines()
+        if line_list and generated_line_list:
+            print(f"Tables for {len(MESSAGE_LIST)} UBX message(s) created, re-writing file...")
+            line_list = rewrite_line_list(generated_line_list, line_list)
+            if line_list:
+                # Done everything; make a back-up copy of the file
+                print(f"Copying {target_file} to {target_file + BACKUP_EXTENSION}...")
+                shutil.copyfile(target_file, target_file + BACKUP_EXTENSION)
+                #... and write line_list back to the file
+                with open(target_file, "w", encoding="utf8") as file:
+                    file.writelines(line_list)
+                    print(f"{target_file} has been re-written.")
+                    return_value = 0
+    else:
+        print(f"\"{target_file}\" is not a file.")
+
+    return return_value
+
+if __name__ == "__main__":
+    PARSER = argparse.ArgumentParser(description="A script to"        \
+                                     " update the UBX message field"  \
+                                     " tables in " + TARGET_FILE_NAME + ".\n")
+    PARSER.add_argument("-f", default=TARGET_FILE_NAME, help="the" \
+                        " file name to update, default " + TARGET_FILE_NAME)
+    ARGS = PARSER.parse_args()
+
+    # Call main()
+    RETURN_VALUE = main(ARGS.f)
+
+    sys.exit(RETURN_VALUE)
+
+# A main is required because Windows needs it in order to
+# behave when this module is called during multiprocessing
+# see https://docs.python.org/2/library/multiprocessing.html#windows
+if __name__ == '__main__':
+    freeze_support()
+    PROCESS = Process(target=main)
+    PROCESS.start()
@@ -404,4 +404,38 @@ int32_t uGnssInfoGetCommunicationStats(uDeviceHandle_t gnssHandle,
     return errorCode;
 }
 
+// Get the SPI transport statistics as seen by this MCU.
+int32_t uGnssInfoGetSpiStats(uDeviceHandle_t gnssHandle,
+                             uGnssSpiStats_t *pStats)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_INITIALISED;
+    uGnssPrivateInstance_t *pInstance;
+
+    if (gUGnssPrivateMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gUGnssPrivateMutex);
+
+        errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+        pInstance = pUGnssPrivateGetInstance(gnssHandle);
+        if ((pInstance != NULL) && (pStats != NULL)) {
+            errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+            if (pInstance->pSpiRingBuffer != NULL) {
+                memset(pStats, 0, sizeof(*pStats));
+                pStats->transfers = pInstance->spiTransfers;
+                pStats->fillBytesDiscarded = pInstance->spiFillBytesDiscarded;
+                pStats->usefulBytes = pInstance->spiUsefulBytes;
+                if (pStats->transfers > 0) {
+                    pStats->usefulBytesPerTransfer = pStats->usefulBytes / pStats->transfers;
+                }
+                pStats->readLength = pInstance->spiReadLength;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            }
+        }
+
+        U_PORT_MUTEX_UNLOCK(gUGnssPrivateMutex);
+    }
+
+    return errorCode;
+}
+
 // End of file
@@ -77,6 +77,7 @@
 #include "u_port_i2c.h"
 #include "u_port_spi.h"
 #include "u_port_gpio.h"
+#include "u_port_event_queue.h"
 
 #include "u_at_client.h"
 
@@ -84,6 +85,8 @@
 
 #include "u_hex_bin_convert.h"
 
+#include "u_device_serial.h"
+
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss.h"
@@ -109,15 +112,37 @@
 # define U_GNSS_MSG_RECEIVE_TASK_PRIORITY (U_CFG_OS_PRIORITY_MAX - 5)
 #endif
 
+#ifndef U_GNSS_MSG_RECEIVE_EVENT_TASK_STACK_SIZE_BYTES
+/** The number of bytes of stack for the task in which the "data
+ * received" event of a UART or virtual serial transport is
+ * delivered; all the callback does is give a semaphore to wake
+ * up the asynchronous message receive task.
+ */
+# define U_GNSS_MSG_RECEIVE_EVENT_TASK_STACK_SIZE_BYTES U_PORT_EVENT_QUEUE_MIN_TASK_STACK_SIZE_BYTES
+#endif
+
 #ifndef U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS
 /** How long the asynchronous message receive task guarantees to give
- * to the rest of the system; if this is made larger the asynchronous
- * receive task won't be able to service the input stream so often
- * and hence the UART/I2C transport may overflow.
+ * to the rest of the system when polling a transport that offers
+ * no "data received" event (I2C or SPI); if this is made larger the
+ * asynchronous receive task won't be able to service the input stream
+ * so often and hence the I2C/SPI transport may overflow.  A Data Ready
+ * pin, if set with uGnssMsgSetDataReady(), cuts the wait short.
  */
 # define U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS 50
 #endif
 
+#ifndef U_GNSS_MSG_RECEIVE_TASK_EVENT_WAIT_MAX_MS
+/** Where the asynchronous message receive task is woken up by
+ * the "data received" event of the transport (UART or virtual
+ * serial), the longest it will wait for an event before looking
+ * for data anyway, just in case; this is the same as the longest
+ * wait when polling so that, should an event be missed, reception
+ * is no slower than it would be without events.
+ */
+# define U_GNSS_MSG_RECEIVE_TASK_EVENT_WAIT_MAX_MS (U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS * 2)
+#endif
+
 #if U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS < U_CFG_OS_YIELD_MS
 /* U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS must be at least as big as U_CFG_OS_YIELD_MS
  * or the asynchronous message receive task will be all-consuming.
@@ -142,12 +167,18 @@
 static void dataReadyCallback(uGnssPrivateInstance_t *pInstance)
 {
     uGnssPrivateDataReadyMcu_t *pDataReadyMcu;
+    uGnssPrivateMsgReceive_t *pMsgReceive;
 
     if ((pInstance != NULL) && (pInstance->pDataReadyMcu != NULL)) {
         pDataReadyMcu = pInstance->pDataReadyMcu;
         // Give the semaphore to indicate to the message
         // receive functions that there is data
         uPortSemaphoreGiveIrq(pDataReadyMcu->semaphoreHandle);
+        pMsgReceive = pInstance->pMsgReceive;
+        if ((pMsgReceive != NULL) && (pMsgReceive->dataSemaphoreHandle != NULL)) {
+            // Wake up the message receive task also
+            uPortSemaphoreGiveIrq(pMsgReceive->dataSemaphoreHandle);
+        }
         if (pDataReadyMcu->pCallback != NULL) {
             // Call the optional user callback
             pDataReadyMcu->pCallback(pInstance->gnssHandle,
@@ -156,6 +187,172 @@ static void dataReadyCallback(uGnssPrivateInstance_t *pInstance)
     }
 }
 
+// Callback for the "data received" event of a UART transport.
+static void uartEventCallback(int32_t handle, uint32_t eventBitMap,
+                              void *pParameters)
+{
+    uGnssPrivateMsgReceive_t *pMsgReceive = (uGnssPrivateMsgReceive_t *) pParameters;
+
+    (void) handle;
+    (void) eventBitMap;
+
+    uPortSemaphoreGive(pMsgReceive->dataSemaphoreHandle);
+}
+
+// Callback for the "data received" event of a virtual serial transport.
+static void serialEventCallback(struct uDeviceSerial_t *pDeviceSerial,
+                                uint32_t eventBitMap, void *pParameters)
+{
+    uGnssPrivateMsgReceive_t *pMsgReceive = (uGnssPrivateMsgReceive_t *) pParameters;
+
+    (void) pDeviceSerial;
+    (void) eventBitMap;
+
+    uPortSemaphoreGive(pMsgReceive->dataSemaphoreHandle);
+}
+
+// Have the "data received" event of the transport, if it has one,
+// wake up the message receive task; if the event is already in use
+// by someone else the message receive task will just poll.  The
+// filter carries U_GNSS_PRIVATE_MSG_RECEIVE_EVENT_FILTER_OURS so
+// that uGnssPrivateMsgReceiveDataEventIsOurs() can tell later
+// whether the callback has been replaced.
+static bool dataEventSet(uGnssPrivateInstance_t *pInstance)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
+    uDeviceSerial_t *pDeviceSerial;
+
+    switch (uGnssPrivateGetStreamType(pInstance->transportType)) {
+        case U_GNSS_PRIVATE_STREAM_TYPE_UART:
+            if (uPortUartEventCallbackFilterGet(pInstance->transportHandle.uart) == 0) {
+                errorCode = uPortUartEventCallbackSet(pInstance->transportHandle.uart,
+                                                      U_GNSS_PRIVATE_MSG_RECEIVE_EVENT_FILTER_OURS |
+                                                      U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED,
+                                                      uartEventCallback, pInstance->pMsgReceive,
+                                                      U_GNSS_MSG_RECEIVE_EVENT_TASK_STACK_SIZE_BYTES,
+                                                      U_GNSS_MSG_RECEIVE_TASK_PRIORITY);
+            }
+            break;
+        case U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL:
+            pDeviceSerial = pInstance->transportHandle.pDeviceSerial;
+            if ((pDeviceSerial->eventCallbackSet != NULL) &&
+                (pDeviceSerial->eventCallbackFilterGet != NULL) &&
+                (pDeviceSerial->eventCallbackFilterGet(pDeviceSerial) == 0)) {
+                errorCode = pDeviceSerial->eventCallbackSet(pDeviceSerial,
+                                                            U_GNSS_PRIVATE_MSG_RECEIVE_EVENT_FILTER_OURS |
+                                                            U_DEVICE_SERIAL_EVENT_BITMASK_DATA_RECEIVED,
+                                                            serialEventCallback,
+                                                            pInstance->pMsgReceive,
+                                                            U_GNSS_MSG_RECEIVE_EVENT_TASK_STACK_SIZE_BYTES,
+                                                            U_GNSS_MSG_RECEIVE_TASK_PRIORITY);
+            }
+            break;
+        default:
+            break;
+    }
+
+    return (errorCode == 0);
+}
+
+// Return the list of the reader index that a message ID belongs in.
+// For the wanted message ID of a reader this is either one of the
+// buckets or, if the message ID includes a wildcard, the wildcard
+// list.  For the message ID of a received message it is the bucket
+// where any readers of that specific message ID will be, or NULL
+// if no reader can be indexed under it.
+static uGnssPrivateMsgReader_t **ppReaderIndexList(uGnssPrivateMsgReceive_t *pMsgReceive,
+                                                   const uGnssPrivateMessageId_t *pId,
+                                                   bool isWanted)
+{
+    uGnssPrivateMsgReader_t **ppList = NULL;
+    uint32_t key = 0;
+    const char *pNmea;
+
+    switch (pId->type) {
+        case U_GNSS_PROTOCOL_UBX:
+            if (!isWanted ||
+                (((pId->id.ubx & U_GNSS_UBX_MESSAGE_ID_ALL) != U_GNSS_UBX_MESSAGE_ID_ALL) &&
+                 ((pId->id.ubx >> 8) != U_GNSS_UBX_MESSAGE_CLASS_ALL))) {
+                key = 0x10000 | pId->id.ubx;
+            }
+            break;
+        case U_GNSS_PROTOCOL_RTCM:
+            if (!isWanted || (pId->id.rtcm != U_GNSS_RTCM_MESSAGE_ID_ALL)) {
+                key = 0x20000 | pId->id.rtcm;
+            }
+            break;
+        case U_GNSS_PROTOCOL_NMEA:
+            // A wanted NMEA ID is matched as a prefix, with '?' as
+            // a wildcard: index only five-character talker/sentence
+            // IDs, ignoring the second character of the talker since
+            // "G?" is commonly used to get any GNSS
+            pNmea = pId->id.nmea;
+            if ((strlen(pNmea) >= 5) &&
+                (!isWanted ||
+                 ((strlen(pNmea) == 5) && (pNmea[0] != '?') &&
+                  (pNmea[2] != '?') && (pNmea[3] != '?') && (pNmea[4] != '?')))) {
+                key = ((uint32_t) (uint8_t) pNmea[0]) |
+                      (((uint32_t) (uint8_t) pNmea[2]) << 8) |
+                      (((uint32_t) (uint8_t) pNmea[3]) << 16) |
+                      (((uint32_t) (uint8_t) pNmea[4]) << 24);
+                key ^= 0x30000;
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (key != 0) {
+        // Fibonacci hash, taking the upper bits
+        ppList = &(pMsgReceive->pReaderIndex[((key * 2654435769UL) >> 16) %
+                                              U_GNSS_MSG_READER_INDEX_SIZE]);
+    } else if (isWanted) {
+        ppList = &(pMsgReceive->pReaderWildcard);
+    }
+
+    return ppList;
+}
+
+// Link together, using pDispatchNext, the readers that want the
+// given message ID, most recently added first, and return the
+// first of them; readerMutexHandle should be locked before this
+// is called.
+static uGnssPrivateMsgReader_t *pReadersWanting(uGnssPrivateMsgReceive_t *pMsgReceive,
+                                                uGnssPrivateMessageId_t *pId)
+{
+    uGnssPrivateMsgReader_t *pFirst = NULL;
+    uGnssPrivateMsgReader_t **ppLast = &pFirst;
+    uGnssPrivateMsgReader_t *pIndexed = NULL;
+    uGnssPrivateMsgReader_t *pWildcard = pMsgReceive->pReaderWildcard;
+    uGnssPrivateMsgReader_t **ppList;
+    uGnssPrivateMsgReader_t *pReader;
+
+    ppList = ppReaderIndexList(pMsgReceive, pId, false);
+    if (ppList != NULL) {
+        pIndexed = *ppList;
+    }
+    // Both lists are newest (highest handle) first, merge them
+    while ((pIndexed != NULL) || (pWildcard != NULL)) {
+        if ((pWildcard == NULL) ||
+            ((pIndexed != NULL) && (pIndexed->handle > pWildcard->handle))) {
+            pReader = pIndexed;
+            pIndexed = pIndexed->pIndexNext;
+        } else {
+            pReader = pWildcard;
+            pWildcard = pWildcard->pIndexNext;
+        }
+        // A bucket may be shared with other message IDs, hence
+        // always check
+        if (uGnssPrivateMessageIdIsWanted(pId, &(pReader->privateMessageId))) {
+            *ppLast = pReader;
+            ppLast = &(pReader->pDispatchNext);
+        }
+    }
+    *ppLast = NULL;
+
+    return pFirst;
+}
+
 // Task that runs the non-blocking message receive.
 static void msgReceiveTask(void *pParam)
 {
@@ -165,7 +362,7 @@ static void msgReceiveTask(void *pParam)
     uGnssPrivateMsgReader_t *pReader;
     int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_UNKNOWN;
     int32_t receiveSize;
-    int32_t yieldTimeMs;
+    int32_t waitTimeMs;
     size_t discardSize = 0;
     int32_t timeoutMs = 0;
     uGnssMessageId_t messageId;
@@ -189,6 +386,10 @@ static void msgReceiveTask(void *pParam)
         // Note that this does NOT lock gUGnssPrivateMutex: it doesn't need to,
         // provided this task is brought up and torn down in an organised way
 
+        // Pull stuff into the ring buffer first, so that whatever
+        // woke us up is dealt with straight away
+        receiveSize = uGnssPrivateStreamFillRingBuffer(pInstance, timeoutMs, 0);
+
         // Deal with any discard from a previous run around this loop
         discardSize -= uRingBufferReadHandle(&(pInstance->ringBuffer),
                                              pMsgReceive->ringBufferReadHandle,
@@ -214,25 +415,26 @@ static void msgReceiveTask(void *pParam)
 
                     if (uGnssPrivateMessageIdToPublic(&privateMessageId, &messageId, nmeaId) == 0) {
                         // Got something, with a message ID now in public form;
-                        // go through the list of readers looking for those interested
+                        // find the readers that are interested: the reader list
+                        // is only locked while we look, the dispatch mutex stops
+                        // any of them being freed while we call their callbacks
 
+                        U_PORT_MUTEX_LOCK(pMsgReceive->dispatchMutexHandle);
                         U_PORT_MUTEX_LOCK(pMsgReceive->readerMutexHandle);
 
-                        pReader = pMsgReceive->pReaderList;
+                        pReader = pReadersWanting(pMsgReceive, &privateMessageId);
+
+                        U_PORT_MUTEX_UNLOCK(pMsgReceive->readerMutexHandle);
+
                         while (pReader != NULL) {
-                            if (uGnssPrivateMessageIdIsWanted(&privateMessageId,
-                                                              &(pReader->privateMessageId))) {
-                                // This reader is interested, call the callback
-                                ((uGnssMsgReceiveCallback_t) pReader->pCallback)(pInstance->gnssHandle,
-                                                                                 &messageId,
-                                                                                 errorCodeOrLength,
-                                                                                 pReader->pCallbackParam);
-                            }
-                            // Next!
-                            pReader = pReader->pNext;
+                            ((uGnssMsgReceiveCallback_t) pReader->pCallback)(pInstance->gnssHandle,
+                                                                             &messageId,
+                                                                             errorCodeOrLength,
+                                                                             pReader->pCallbackParam);
+                            pReader = pReader->pDispatchNext;
                         }
 
-                        U_PORT_MUTEX_UNLOCK(pMsgReceive->readerMutexHandle);
+                        U_PORT_MUTEX_UNLOCK(pMsgReceive->dispatchMutexHandle);
                     }
 
                     // Clear out any remaining data
@@ -243,17 +445,27 @@ static void msgReceiveTask(void *pParam)
             }
         }
 
-        // Pull stuff into the ring buffer
-        receiveSize = uGnssPrivateStreamFillRingBuffer(pInstance, timeoutMs, 0);
-
-        // Relax to let others in; relax for twice as long if we last
-        // received nothing and aren't desperately seeking more data,
-        // in order to allow some data to build up
-        yieldTimeMs = U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS;
-        if ((receiveSize == 0) && (errorCodeOrLength != (int32_t) U_ERROR_COMMON_TIMEOUT))  {
-            yieldTimeMs *= 2;
+        if (pMsgReceive->dataEventIsSet &&
+            ((receiveSize > 0) || uGnssPrivateMsgReceiveDataEventIsOurs(pInstance))) {
+            // The transport tells us when data arrives (and the
+            // application hasn't since taken the event over): if we
+            // just received something there may be more waiting (we
+            // only read so much in one go), else wait to be woken up
+            if (receiveSize <= 0) {
+                uPortSemaphoreTryTake(pMsgReceive->dataSemaphoreHandle,
+                                      U_GNSS_MSG_RECEIVE_TASK_EVENT_WAIT_MAX_MS);
+            }
+        } else {
+            // Polling: relax to let others in; relax for twice as long
+            // if we last received nothing and aren't desperately seeking
+            // more data, in order to allow some data to build up; a
+            // Data Ready pin, if there is one, will wake us up early
+            waitTimeMs = U_GNSS_MSG_TASK_STACK_YIELD_TIME_MS;
+            if ((receiveSize == 0) && (errorCodeOrLength != (int32_t) U_ERROR_COMMON_TIMEOUT))  {
+                waitTimeMs *= 2;
+            }
+            uPortSemaphoreTryTake(pMsgReceive->dataSemaphoreHandle, waitTimeMs);
         }
-        uPortTaskBlock(yieldTimeMs);
     }
 
     // Now we can unlock our ring buffer read handle.  Phew.
@@ -317,6 +529,7 @@ int32_t uGnssMsgPrivateReceiveStart(uGnssPrivateInstance_t *pInstance,
     int32_t errorCodeOrHandle = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
     uGnssPrivateMsgReceive_t *pMsgReceive;
     uGnssPrivateMsgReader_t *pReader;
+    uGnssPrivateMsgReader_t **ppIndexList;
     const char *pTaskName = "gnssMsgRx";
 
     if ((pInstance != NULL) && (pPrivateMessageId != NULL) && (pCallback != NULL)) {
@@ -335,53 +548,62 @@ int32_t uGnssMsgPrivateReceiveStart(uGnssPrivateInstance_t *pInstance,
                     // Take a "master" read handle
                     pMsgReceive->ringBufferReadHandle = uRingBufferTakeReadHandle(&(pInstance->ringBuffer));
                     if (pMsgReceive->ringBufferReadHandle >= 0) {
-                        // Allocate a temporary buffer that we can use to pull data
-                        // from the streaming source into the ring-buffer from our
-                        // asynchronous task
-                        pMsgReceive->pTemporaryBuffer = (char *) pUPortMalloc(U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES);
-                        if (pMsgReceive->pTemporaryBuffer != NULL) {
-                            // Create the mutex that controls access to the linked-list of readers
-                            errorCodeOrHandle = uPortMutexCreate(&(pMsgReceive->readerMutexHandle));
+                        // Create the mutex that controls access to the linked-list of readers
+                        errorCodeOrHandle = uPortMutexCreate(&(pMsgReceive->readerMutexHandle));
+                        if (errorCodeOrHandle == 0) {
+                            // Create the mutex that is held while callbacks are called
+                            errorCodeOrHandle = uPortMutexCreate(&(pMsgReceive->dispatchMutexHandle));
+                        }
+                        if (errorCodeOrHandle == 0) {
+                            // Create the queue that allows us to get the task to exit
+                            errorCodeOrHandle = uPortQueueCreate(U_GNSS_MSG_RECEIVE_TASK_QUEUE_LENGTH,
+                                                                 U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES,
+                                                                 &(pMsgReceive->taskExitQueueHandle));
                             if (errorCodeOrHandle == 0) {
-                                // Create the queue that allows us to get the task to exit
-                                errorCodeOrHandle = uPortQueueCreate(U_GNSS_MSG_RECEIVE_TASK_QUEUE_LENGTH,
-                                                                     U_GNSS_MSG_RECEIVE_TASK_QUEUE_ITEM_SIZE_BYTES,
-                                                                     &(pMsgReceive->taskExitQueueHandle));
+                                // Create the mutex for task running status
+                                errorCodeOrHandle = uPortMutexCreate(&(pMsgReceive->taskRunningMutexHandle));
                                 if (errorCodeOrHandle == 0) {
-                                    // Create the mutex for task running status
-                                    errorCodeOrHandle = uPortMutexCreate(&(pMsgReceive->taskRunningMutexHandle));
+                                    // Create the semaphore that wakes the task up
+                                    errorCodeOrHandle = uPortSemaphoreCreate(&(pMsgReceive->dataSemaphoreHandle),
+                                                                             0, 1);
+                                }
+                                if (errorCodeOrHandle == 0) {
+                                    //... and then the task
+                                    errorCodeOrHandle = uPortTaskCreate(msgReceiveTask,
+                                                                        pTaskName,
+                                                                        U_GNSS_MSG_RECEIVE_TASK_STACK_SIZE_BYTES,
+                                                                        pInstance, U_GNSS_MSG_RECEIVE_TASK_PRIORITY,
+                                                                        &(pMsgReceive->taskHandle));
                                     if (errorCodeOrHandle == 0) {
-                                        //... and then the task
-                                        errorCodeOrHandle = uPortTaskCreate(msgReceiveTask,
-                                                                            pTaskName,
-                                                                            U_GNSS_MSG_RECEIVE_TASK_STACK_SIZE_BYTES,
-                                                                            pInstance, U_GNSS_MSG_RECEIVE_TASK_PRIORITY,
-                                                                            &(pMsgReceive->taskHandle));
-                                        if (errorCodeOrHandle == 0) {
-                                            // Wait for the task to lock the mutex,
-                                            // which shows it is running
-                                            while (uPortMutexTryLock(pMsgReceive->taskRunningMutexHandle, 0) == 0) {
-                                                uPortMutexUnlock(pMsgReceive->taskRunningMutexHandle);
-                                                uPortTaskBlock(U_CFG_OS_YIELD_MS);
-                                            }
+                                        // Wait for the task to lock the mutex,
+                                        // which shows it is running
+                                        while (uPortMutexTryLock(pMsgReceive->taskRunningMutexHandle, 0) == 0) {
+                                            uPortMutexUnlock(pMsgReceive->taskRunningMutexHandle);
+                                            uPortTaskBlock(U_CFG_OS_YIELD_MS);
                                         }
+                                        // Now let the transport wake it up, if it can
+                                        pMsgReceive->dataEventIsSet = dataEventSet(pInstance);
                                     }
                                 }
                             }
                         }
                         if (errorCodeOrHandle != 0) {
                             // Tidy up if we couldn't get OS resources
+                            if (pMsgReceive->dataSemaphoreHandle != NULL) {
+                                uPortSemaphoreDelete(pMsgReceive->dataSemaphoreHandle);
+                            }
                             if (pMsgReceive->taskRunningMutexHandle != NULL) {
                                 uPortMutexDelete(pMsgReceive->taskRunningMutexHandle);
                             }
                             if (pMsgReceive->taskExitQueueHandle != NULL) {
                                 uPortQueueDelete(pMsgReceive->taskExitQueueHandle);
                             }
+                            if (pMsgReceive->dispatchMutexHandle != NULL) {
+                                uPortMutexDelete(pMsgReceive->dispatchMutexHandle);
+                            }
                             if (pMsgReceive->readerMutexHandle != NULL) {
                                 uPortMutexDelete(pMsgReceive->readerMutexHandle);
                             }
-                            uPortFree(pInstance->pTemporaryBuffer);
-                            pInstance->pTemporaryBuffer = NULL;
                             uRingBufferGiveReadHandle(&(pInstance->ringBuffer),
                                                       pMsgReceive->ringBufferReadHandle);
                             uPortFree(pInstance->pMsgReceive);
@@ -403,7 +625,8 @@ int32_t uGnssMsgPrivateReceiveStart(uGnssPrivateInstance_t *pInstance,
         if (pReader != NULL) {
             // The task etc. must be running, we have a read handle,
             // now populate the rest of the reader structure
-            // and add it to the front of the list
+            // and add it to the front of the list and of its
+            // list in the index
             pReader->handle = pInstance->pMsgReceive->nextHandle;
             pInstance->pMsgReceive->nextHandle++;
             pReader->privateMessageId = *pPrivateMessageId;
@@ -411,9 +634,14 @@ int32_t uGnssMsgPrivateReceiveStart(uGnssPrivateInstance_t *pInstance,
             pReader->pCallbackParam = pCallbackParam;
             pReader->pNext = pInstance->pMsgReceive->pReaderList;
 
+            ppIndexList = ppReaderIndexList(pInstance->pMsgReceive,
+                                            &(pReader->privateMessageId), true);
+            pReader->pIndexNext = *ppIndexList;
+
             U_PORT_MUTEX_LOCK(pInstance->pMsgReceive->readerMutexHandle);
 
             pInstance->pMsgReceive->pReaderList = pReader;
+            *ppIndexList = pReader;
 
             U_PORT_MUTEX_UNLOCK(pInstance->pMsgReceive->readerMutexHandle);
 
@@ -433,6 +661,8 @@ int32_t uGnssMsgPrivateReceiveStop(uGnssPrivateInstance_t *pInstance,
     uGnssPrivateMsgReceive_t *pMsgReceive;
     uGnssPrivateMsgReader_t *pCurrent;
     uGnssPrivateMsgReader_t *pPrev = NULL;
+    uGnssPrivateMsgReader_t *pFound = NULL;
+    uGnssPrivateMsgReader_t **ppIndex;
 
     if (pInstance != NULL) {
         errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
@@ -451,7 +681,7 @@ int32_t uGnssMsgPrivateReceiveStop(uGnssPrivateInstance_t *pInstance,
                     } else {
                         pMsgReceive->pReaderList = pCurrent->pNext;
                     }
-                    uPortFree(pCurrent);
+                    pFound = pCurrent;
                     pCurrent = NULL;
                     errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
                 } else {
@@ -459,9 +689,25 @@ int32_t uGnssMsgPrivateReceiveStop(uGnssPrivateInstance_t *pInstance,
                     pCurrent = pPrev->pNext;
                 }
             }
+            if (pFound != NULL) {
+                // Remove it from the index also
+                ppIndex = ppReaderIndexList(pMsgReceive, &(pFound->privateMessageId), true);
+                while (*ppIndex != pFound) {
+                    ppIndex = &((*ppIndex)->pIndexNext);
+                }
+                *ppIndex = pFound->pIndexNext;
+            }
 
             U_PORT_MUTEX_UNLOCK(pMsgReceive->readerMutexHandle);
 
+            if (pFound != NULL) {
+                // The task may be calling the callback of this reader
+                // right now, wait for it to finish before freeing it
+                U_PORT_MUTEX_LOCK(pMsgReceive->dispatchMutexHandle);
+                U_PORT_MUTEX_UNLOCK(pMsgReceive->dispatchMutexHandle);
+                uPortFree(pFound);
+            }
+
             if (pMsgReceive->pReaderList == NULL) {
                 // All gone, shut the task etc. down also
                 uGnssPrivateStopMsgReceive(pInstance);
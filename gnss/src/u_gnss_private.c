@@ -53,6 +53,7 @@
 #include "u_timeout.h"
 
 #include "u_hex_bin_convert.h"
+#include "u_crc.h"
 
 #include "u_at_client.h"
 
@@ -74,6 +75,7 @@
 #include "u_gnss_private.h"
 #include "u_gnss_msg.h"
 #include "u_gnss_msg_private.h"
+#include "u_gnss_capture_private.h"
 #include "u_gnss_cfg.h"
 #include "u_gnss_cfg_val_key.h"
 #include "u_gnss_cfg_private.h"
@@ -106,6 +108,14 @@
 # error U_GNSS_PRIVATE_SPI_READ_LENGTH_MIN_BYTES must be less than or equal to U_GNSS_SPI_FILL_THRESHOLD_MAX
 #endif
 
+#if U_GNSS_SPI_READ_LENGTH_MAX_BYTES > U_GNSS_SPI_BUFFER_LENGTH_BYTES
+# error U_GNSS_SPI_READ_LENGTH_MAX_BYTES must be less than or equal to U_GNSS_SPI_BUFFER_LENGTH_BYTES
+#endif
+
+#if U_GNSS_SPI_READ_LENGTH_MAX_BYTES < U_GNSS_SPI_FILL_THRESHOLD_MAX
+# error U_GNSS_SPI_READ_LENGTH_MAX_BYTES must be greater than or equal to U_GNSS_SPI_FILL_THRESHOLD_MAX
+#endif
+
 #if U_GNSS_DEFAULT_SPI_FILL_THRESHOLD > U_GNSS_SPI_BUFFER_LENGTH_BYTES
 # error U_GNSS_DEFAULT_SPI_FILL_THRESHOLD must be less than or equal to U_GNSS_SPI_BUFFER_LENGTH_BYTES
 #endif
@@ -122,6 +132,14 @@
 # define U_GNSS_PRIVATE_STREAMED_POS_ENSURE_SETTINGS_RETRIES 2
 #endif
 
+/** The number of NMEA message ID characters that parseNmea() can
+ * pack into the ring buffer parser state, which holds the NMEA
+ * phase and checksum in the first two values; if
+ * #U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS is larger than
+ * this then NMEA messages are parsed from the start each time.
+ */
+#define U_GNSS_PRIVATE_PARSE_STATE_NMEA_ID_MAX_CHARS ((U_RING_BUFFER_PARSE_STATE_NUM_VALUES - 2) * 4)
+
 #ifndef U_GNSS_PRIVATE_SENT_MESSAGE_STRING
 /** There is a Python script in the gnss/api directory which
  * looks for the string below as a key to find the commands sent
@@ -227,6 +245,11 @@ const size_t gUGnssPrivateModuleListSize = sizeof(gUGnssPrivateModuleList) /
  * VARIABLES
  * -------------------------------------------------------------- */
 
+/** The bytes that a message recognised by parseUbx(), parseNmea()
+ * or parseRtcm() begins with, in that order.
+ */
+static const char gParserStartBytes[] = {(char) 0xB5, '$', (char) 0xD3};
+
 /** Table to convert a GNSS transport type into a streaming transport type.
  */
 static const int32_t gGnssPrivateTransportTypeToStream[] = {
@@ -499,6 +522,67 @@ static void printId(uGnssPrivateMessageId_t *pId)
  * STATIC FUNCTIONS: STREAMING TRANSPORT ONLY
  * -------------------------------------------------------------- */
 
+// Return the number of SPI fill bytes at the start of pBuffer; once
+// aligned, the check is done a uint32_t at a time since, when the
+// GNSS chip has nothing to send, that is all there will be.
+static size_t spiFillLengthStart(const char *pBuffer, size_t size)
+{
+    // Note: use uint8_t to avoid issues with char being signed
+    const uint8_t *pData = (const uint8_t *) pBuffer;
+    const uint8_t *pEnd = pData + size;
+    uint32_t word;
+
+    while ((pData < pEnd) && ((((uintptr_t) pData) & (sizeof(word) - 1)) != 0) &&
+           (*pData == U_GNSS_PRIVATE_SPI_FILL)) {
+        pData++;
+    }
+    while ((size_t) (pEnd - pData) >= sizeof(word)) {
+        // memcpy() so as not to upset strict aliasing; pData is
+        // aligned so this will be a single load
+        memcpy(&word, pData, sizeof(word));
+        if (word != U_GNSS_PRIVATE_SPI_FILL * 0x01010101UL) {
+            break;
+        }
+        pData += sizeof(word);
+    }
+    // Finish off byte-wise, which also finds the first non-fill
+    // byte in a word that didn't match
+    while ((pData < pEnd) && (*pData == U_GNSS_PRIVATE_SPI_FILL)) {
+        pData++;
+    }
+
+    return (size_t) (pData - (const uint8_t *) pBuffer);
+}
+
+// Return the number of SPI fill bytes at the end of pBuffer, working
+// backwards in the same way as spiFillLengthStart(); this is used only
+// to tell that the GNSS chip has gone idle, it can't be used to remove
+// fill since a genuine 0xFF (e.g. a UBX checksum byte) that ends a
+// message is indistinguishable from the fill that follows it.
+static size_t spiFillLengthEnd(const char *pBuffer, size_t size)
+{
+    const uint8_t *pStart = (const uint8_t *) pBuffer;
+    const uint8_t *pData = pStart + size;
+    uint32_t word;
+
+    while ((pData > pStart) && ((((uintptr_t) pData) & (sizeof(word) - 1)) != 0) &&
+           (*(pData - 1) == U_GNSS_PRIVATE_SPI_FILL)) {
+        pData--;
+    }
+    while ((size_t) (pData - pStart) >= sizeof(word)) {
+        memcpy(&word, pData - sizeof(word), sizeof(word));
+        if (word != U_GNSS_PRIVATE_SPI_FILL * 0x01010101UL) {
+            break;
+        }
+        pData -= sizeof(word);
+    }
+    while ((pData > pStart) && (*(pData - 1) == U_GNSS_PRIVATE_SPI_FILL)) {
+        pData--;
+    }
+
+    return (size_t) ((pStart + size) - pData);
+}
+
 // Read or peek-at the data in the internal ring buffer.
 static int32_t streamGetFromRingBuffer(uGnssPrivateInstance_t *pInstance,
                                        int32_t readHandle,
@@ -552,6 +636,49 @@ static int32_t streamGetFromRingBuffer(uGnssPrivateInstance_t *pInstance,
     return errorCodeOrLength;
 }
 
+// Read up to size bytes of data that is waiting on the streaming
+// transport of the given type into pBuffer, which will usually be
+// a span of space reserved in the ring buffer.
+static int32_t streamRead(uGnssPrivateInstance_t *pInstance,
+                          int32_t privateStreamType,
+                          char *pBuffer, size_t size)
+{
+    int32_t errorCodeOrLength = 0;
+
+    switch (privateStreamType) {
+        case U_GNSS_PRIVATE_STREAM_TYPE_UART:
+            errorCodeOrLength = uPortUartRead(pInstance->transportHandle.uart,
+                                              pBuffer, size);
+            break;
+        case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
+            // For I2C we need to ask for exactly the amount we know is
+            // there since the I2C buffer is effectively on the GNSS chip
+            // and I2C drivers often don't say how much they've read, just
+            // giving us back the number we asked for on a successful read
+            errorCodeOrLength = uPortI2cControllerExchange(pInstance->transportHandle.i2c,
+                                                           pInstance->i2cAddress,
+                                                           NULL, 0, pBuffer,
+                                                           size, false);
+            break;
+        case U_GNSS_PRIVATE_STREAM_TYPE_SPI:
+            // For the SPI case, we need to pull the data that was
+            // received in uGnssPrivateStreamGetReceiveSize() back
+            // out of the SPI ring buffer
+            errorCodeOrLength = (int32_t) uRingBufferRead(pInstance->pSpiRingBuffer,
+                                                          pBuffer, size);
+            break;
+        case U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL: {
+            uDeviceSerial_t *pDeviceSerial = pInstance->transportHandle.pDeviceSerial;
+            errorCodeOrLength = pDeviceSerial->read(pDeviceSerial, pBuffer, size);
+        }
+        break;
+        default:
+            break;
+    }
+
+    return errorCodeOrLength;
+}
+
 // Send a message over UART or I2C or SPI.
 static int32_t sendMessageStream(uGnssPrivateInstance_t *pInstance,
                                  const char *pMessage,
@@ -933,7 +1060,10 @@ static int32_t sendReceiveUbxMessage(uGnssPrivateInstance_t *pInstance,
  * STATIC FUNCTIONS: MESSAGE PARSERS
  * -------------------------------------------------------------- */
 
-/** UBX Parser function.
+/** UBX Parser function; this and the NMEA and RTCM parsers below
+ * keep their progress in the ring buffer parser state so that,
+ * when a message is only partly there, they carry on from where
+ * they got to once more data has arrived.
  *
  * @param parseHandle    the parse handle of the ring buffer to read from.
  * @param[in] pUserParam the user parameter passed to uRingBufferParseHandle().
@@ -942,68 +1072,82 @@ static int32_t sendReceiveUbxMessage(uGnssPrivateInstance_t *pInstance,
 static int32_t parseUbx(uParseHandle_t parseHandle, void *pUserParam)
 {
     uGnssPrivateMessageId_t *pMsgId = (uGnssPrivateMessageId_t *) pUserParam;
+    uint32_t stateLocal[U_RING_BUFFER_PARSE_STATE_NUM_VALUES];
+    bool resume;
+    uint32_t *pState = pURingBufferParseStateUnprotected(parseHandle, &resume);
+    // Position is the index into the message of the next byte,
+    // where 0 is the 0xB5 header byte
+    uint32_t position = 0;
+    uint8_t cka = 0;
+    uint8_t ckb = 0;
+    uint32_t length = 0;
     uint8_t by = 0;
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if (0xB5 != by) {
-        return U_ERROR_COMMON_NOT_FOUND;    // = µ, 0xB5
-    }
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if (0x62 != by) {
-        return U_ERROR_COMMON_NOT_FOUND;    // = b
-    }
-    if (4 > uRingBufferBytesAvailableUnprotected(parseHandle)) {
-        return U_ERROR_COMMON_TIMEOUT;
+
+    if (pState == NULL) {
+        pState = stateLocal;
+    }
+    if (resume) {
+        position = pState[0];
+        cka = (uint8_t) pState[1];
+        ckb = (uint8_t) (pState[1] >> 8);
+        length = pState[2];
+        pMsgId->id.ubx = (uint16_t) pState[3];
+    }
+    while (uRingBufferGetByteUnprotected(parseHandle, &by)) {
+        if ((position >= 6) && (position < length + 6)) {
+            // Body, the most likely case
+            cka += by;
+            ckb += cka;
+        } else if (position == 0) {
+            if (0xB5 != by) {
+                return U_ERROR_COMMON_NOT_FOUND;    // = µ, 0xB5
+            }
+        } else if (position == 1) {
+            if (0x62 != by) {
+                return U_ERROR_COMMON_NOT_FOUND;    // = b
+            }
+        } else if (position < 6) {
+            // Class, ID and the two bytes of length
+            cka += by;
+            ckb += cka;
+            switch (position) {
+                case 2:
+                    pMsgId->id.ubx = (uint16_t) (((uint16_t) by) << 8);
+                    break;
+                case 3:
+                    pMsgId->id.ubx += by;
+                    break;
+                case 4:
+                    length = by;
+                    break;
+                default:
+                    length += ((uint32_t) by) << 8;
+                    break;
+            }
+        } else if (position == length + 6) {
+            if (by != cka) {
+                return U_ERROR_COMMON_NOT_FOUND;
+            }
+        } else {
+            if (by != ckb) {
+                return U_ERROR_COMMON_NOT_FOUND;
+            }
+            // We can only claim this as a UBX-format message if
+            // there was nothing that needed discarding first.
+            if (uRingBufferBytesDiscardUnprotected(parseHandle) == 0) {
+                pMsgId->type = U_GNSS_PROTOCOL_UBX;
+            }
+            return U_ERROR_COMMON_SUCCESS;
+        }
+        position++;
     }
-    uint8_t ckb = 0;
-    uint8_t cka = 0;
-    uint8_t cls, id;
-    uRingBufferGetByteUnprotected(parseHandle, &cls); // cls
-    cka += cls;
-    ckb += cka;
-    uRingBufferGetByteUnprotected(parseHandle, &id); // id
-    cka += id;
-    ckb += cka;
-    pMsgId->id.ubx = (uint16_t) ((((uint16_t) cls) << 8) + id);
-    uRingBufferGetByteUnprotected(parseHandle, &by); // len low
-    cka += by;
-    ckb += cka;
-    uint16_t l = by;
-    uRingBufferGetByteUnprotected(parseHandle, &by); // len high
-    cka += by;
-    ckb += cka;
-    l += (((uint16_t) by) << 8);
-    if (l > uRingBufferBytesAvailableUnprotected(parseHandle)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    while (l --) {
-        uRingBufferGetByteUnprotected(parseHandle, &by);
-        cka += by;
-        ckb += cka;
-    }
-    cka = cka & 0xFF;
-    ckb = ckb & 0xFF;
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if (by != cka) {
-        return U_ERROR_COMMON_NOT_FOUND;
-    }
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if (by != ckb) {
-        return U_ERROR_COMMON_NOT_FOUND;
-    }
-    // We can only claim this as a UBX-format message if
-    // there was nothing that needed discarding first.
-    if (uRingBufferBytesDiscardUnprotected(parseHandle) == 0) {
-        pMsgId->type = U_GNSS_PROTOCOL_UBX;
-    }
-    return U_ERROR_COMMON_SUCCESS;
+
+    pState[0] = position;
+    pState[1] = cka + (((uint32_t) ckb) << 8);
+    pState[2] = length;
+    pState[3] = pMsgId->id.ubx;
+
+    return U_ERROR_COMMON_TIMEOUT;
 }
 
 /** NMEA Parser function.
@@ -1015,69 +1159,107 @@ static int32_t parseUbx(uParseHandle_t parseHandle, void *pUserParam)
 static int32_t parseNmea(uParseHandle_t parseHandle, void *pUserParam)
 {
     uGnssPrivateMessageId_t *pMsgId = (uGnssPrivateMessageId_t *) pUserParam;
-    char ch = 0;
     const char *hex = "0123456789ABCDEF";
-    if (!uRingBufferGetByteUnprotected(parseHandle, &ch)) {
-        return U_ERROR_COMMON_TIMEOUT;
+    uint32_t stateLocal[U_RING_BUFFER_PARSE_STATE_NUM_VALUES];
+    bool resume = false;
+    uint32_t *pState = NULL;
+    // Phase 0 is the '$', 1 the message ID, 2 the body, 3 and 4 the
+    // two checksum characters and 5 and 6 the CR/LF
+    uint32_t phase = 0;
+    size_t i = 0;
+    char crc = 0;
+    char ch = 0;
+
+    if (U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS <= U_GNSS_PRIVATE_PARSE_STATE_NMEA_ID_MAX_CHARS) {
+        pState = pURingBufferParseStateUnprotected(parseHandle, &resume);
     }
-    if ('$' != ch) {
-        return U_ERROR_COMMON_NOT_FOUND;
+    if (pState == NULL) {
+        pState = stateLocal;
     }
-    char crc = 0;
-    int i = 0;
-    while (uRingBufferGetByteUnprotected(parseHandle, &ch)) {
-        crc ^= ch;
-        if (',' == ch) {
-            break;
-        }
-        if (i >= U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS) {
-            return U_ERROR_COMMON_NOT_FOUND;
+    if (resume) {
+        phase = pState[0] & 0xFF;
+        i = pState[0] >> 8;
+        crc = (char) pState[1];
+        for (size_t x = 0; x < i; x++) {
+            pMsgId->id.nmea[x] = (char) (pState[2 + (x >> 2)] >> ((x & 3) * 8));
         }
-        if (('0' > ch) || ('Z' < ch) || (('9' < ch) && ('A' > ch))) {
-            return U_ERROR_COMMON_NOT_FOUND;    // A-Z, 0-9
-        }
-        pMsgId->id.nmea[i++] = ch;
+        pMsgId->id.nmea[i] = '\0';
     }
-    pMsgId->id.nmea[i] = '\0';
     while (uRingBufferGetByteUnprotected(parseHandle, &ch)) {
-        if ((' ' > ch) || ('~' < ch)) {
-            return U_ERROR_COMMON_NOT_FOUND;    // not in printable range 32 - 126
-        }
-        if ('*' == ch) {
-            break;    // *
+        switch (phase) {
+            case 0:
+                if ('$' != ch) {
+                    return U_ERROR_COMMON_NOT_FOUND;
+                }
+                phase++;
+                break;
+            case 1:
+                crc ^= ch;
+                if (',' == ch) {
+                    phase++;
+                } else {
+                    if (i >= U_GNSS_NMEA_MESSAGE_MATCH_LENGTH_CHARACTERS) {
+                        return U_ERROR_COMMON_NOT_FOUND;
+                    }
+                    if (('0' > ch) || ('Z' < ch) || (('9' < ch) && ('A' > ch))) {
+                        return U_ERROR_COMMON_NOT_FOUND;    // A-Z, 0-9
+                    }
+                    pMsgId->id.nmea[i] = ch;
+                    if (i < U_GNSS_PRIVATE_PARSE_STATE_NMEA_ID_MAX_CHARS) {
+                        if ((i & 3) == 0) {
+                            pState[2 + (i >> 2)] = 0;
+                        }
+                        pState[2 + (i >> 2)] |= ((uint32_t) (uint8_t) ch) << ((i & 3) * 8);
+                    }
+                    i++;
+                }
+                pMsgId->id.nmea[i] = '\0';
+                break;
+            case 2:
+                if ((' ' > ch) || ('~' < ch)) {
+                    return U_ERROR_COMMON_NOT_FOUND;    // not in printable range 32 - 126
+                }
+                if ('*' == ch) {
+                    phase++;
+                } else {
+                    crc ^= ch;
+                }
+                break;
+            case 3:
+                if (hex[(crc >> 4) & 0xF] != ch) {
+                    return U_ERROR_COMMON_NOT_FOUND;
+                }
+                phase++;
+                break;
+            case 4:
+                if (hex[crc & 0xF] != ch) {
+                    return U_ERROR_COMMON_NOT_FOUND;
+                }
+                phase++;
+                break;
+            case 5:
+                if ('\r' != ch) {
+                    return U_ERROR_COMMON_NOT_FOUND;
+                }
+                phase++;
+                break;
+            default:
+                if ('\n' != ch) {
+                    return U_ERROR_COMMON_NOT_FOUND;
+                }
+                // We can only claim this as an NMEA-format message if
+                // there was nothing that needed discarding first.
+                if (uRingBufferBytesDiscardUnprotected(parseHandle) == 0) {
+                    pMsgId->type = U_GNSS_PROTOCOL_NMEA;
+                }
+                return U_ERROR_COMMON_SUCCESS;
         }
-        crc ^= ch;
-    }
-    if (!uRingBufferGetByteUnprotected(parseHandle, &ch)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if (hex[(crc >> 4) & 0xF] != ch) {
-        return U_ERROR_COMMON_NOT_FOUND;
-    }
-    if (!uRingBufferGetByteUnprotected(parseHandle, &ch)) {
-        return U_ERROR_COMMON_TIMEOUT;
     }
-    if (hex[crc & 0xF] != ch) {
-        return U_ERROR_COMMON_NOT_FOUND;
-    }
-    if (!uRingBufferGetByteUnprotected(parseHandle, &ch)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if ('\r' != ch) {
-        return U_ERROR_COMMON_NOT_FOUND;
-    }
-    if (!uRingBufferGetByteUnprotected(parseHandle, &ch)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if ('\n' != ch) {
-        return U_ERROR_COMMON_NOT_FOUND;
-    }
-    // We can only claim this as an NMEA-format message if
-    // there was nothing that needed discarding first.
-    if (uRingBufferBytesDiscardUnprotected(parseHandle) == 0) {
-        pMsgId->type = U_GNSS_PROTOCOL_NMEA;
-    }
-    return U_ERROR_COMMON_SUCCESS;
+
+    pState[0] = phase + (((uint32_t) i) << 8);
+    pState[1] = (uint8_t) crc;
+
+    return U_ERROR_COMMON_TIMEOUT;
 }
 
 /** RTCM Parser function.
@@ -1089,99 +1271,93 @@ static int32_t parseNmea(uParseHandle_t parseHandle, void *pUserParam)
 static int32_t parseRtcm(uParseHandle_t parseHandle, void *pUserParam)
 {
     uGnssPrivateMessageId_t *pMsgId = (uGnssPrivateMessageId_t *) pUserParam;
-    uint8_t by;
+    uint32_t stateLocal[U_RING_BUFFER_PARSE_STATE_NUM_VALUES];
+    bool resume;
+    uint32_t *pState = pURingBufferParseStateUnprotected(parseHandle, &resume);
+    // Position is the index into the message of the next byte,
+    // where 0 is the 0xD3 header byte
+    uint32_t position = 0;
     uint32_t crc = 0;
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if (0xD3 != by) {
-        return U_ERROR_COMMON_NOT_FOUND;
-    }
-    // CRC24Q check
-    const uint32_t _crc24qTable[] = {
-        /* 00 */ 0x000000, 0x864cfb, 0x8ad50d, 0x0c99f6, 0x93e6e1, 0x15aa1a, 0x1933ec, 0x9f7f17,
-        /* 08 */ 0xa18139, 0x27cdc2, 0x2b5434, 0xad18cf, 0x3267d8, 0xb42b23, 0xb8b2d5, 0x3efe2e,
-        /* 10 */ 0xc54e89, 0x430272, 0x4f9b84, 0xc9d77f, 0x56a868, 0xd0e493, 0xdc7d65, 0x5a319e,
-        /* 18 */ 0x64cfb0, 0xe2834b, 0xee1abd, 0x685646, 0xf72951, 0x7165aa, 0x7dfc5c, 0xfbb0a7,
-        /* 20 */ 0x0cd1e9, 0x8a9d12, 0x8604e4, 0x00481f, 0x9f3708, 0x197bf3, 0x15e205, 0x93aefe,
-        /* 28 */ 0xad50d0, 0x2b1c2b, 0x2785dd, 0xa1c926, 0x3eb631, 0xb8faca, 0xb4633c, 0x322fc7,
-        /* 30 */ 0xc99f60, 0x4fd39b, 0x434a6d, 0xc50696, 0x5a7981, 0xdc357a, 0xd0ac8c, 0x56e077,
-        /* 38 */ 0x681e59, 0xee52a2, 0xe2cb54, 0x6487af, 0xfbf8b8, 0x7db443, 0x712db5, 0xf7614e,
-        /* 40 */ 0x19a3d2, 0x9fef29, 0x9376df, 0x153a24, 0x8a4533, 0x0c09c8, 0x00903e, 0x86dcc5,
-        /* 48 */ 0xb822eb, 0x3e6e10, 0x32f7e6, 0xb4bb1d, 0x2bc40a, 0xad88f1, 0xa11107, 0x275dfc,
-        /* 50 */ 0xdced5b, 0x5aa1a0, 0x563856, 0xd074ad, 0x4f0bba, 0xc94741, 0xc5deb7, 0x43924c,
-        /* 58 */ 0x7d6c62, 0xfb2099, 0xf7b96f, 0x71f594, 0xee8a83, 0x68c678, 0x645f8e, 0xe21375,
-        /* 60 */ 0x15723b, 0x933ec0, 0x9fa736, 0x19ebcd, 0x8694da, 0x00d821, 0x0c41d7, 0x8a0d2c,
-        /* 68 */ 0xb4f302, 0x32bff9, 0x3e260f, 0xb86af4, 0x2715e3, 0xa15918, 0xadc0ee, 0x2b8c15,
-        /* 70 */ 0xd03cb2, 0x567049, 0x5ae9bf, 0xdca544, 0x43da53, 0xc596a8, 0xc90f5e, 0x4f43a5,
-        /* 78 */ 0x71bd8b, 0xf7f170, 0xfb6886, 0x7d247d, 0xe25b6a, 0x641791, 0x688e67, 0xeec29c,
-        /* 80 */ 0x3347a4, 0xb50b5f, 0xb992a9, 0x3fde52, 0xa0a145, 0x26edbe, 0x2a7448, 0xac38b3,
-        /* 88 */ 0x92c69d, 0x148a66, 0x181390, 0x9e5f6b, 0x01207c, 0x876c87, 0x8bf571, 0x0db98a,
-        /* 90 */ 0xf6092d, 0x7045d6, 0x7cdc20, 0xfa90db, 0x65efcc, 0xe3a337, 0xef3ac1, 0x69763a,
-        /* 98 */ 0x578814, 0xd1c4ef, 0xdd5d19, 0x5b11e2, 0xc46ef5, 0x42220e, 0x4ebbf8, 0xc8f703,
-        /* a0 */ 0x3f964d, 0xb9dab6, 0xb54340, 0x330fbb, 0xac70ac, 0x2a3c57, 0x26a5a1, 0xa0e95a,
-        /* a8 */ 0x9e1774, 0x185b8f, 0x14c279, 0x928e82, 0x0df195, 0x8bbd6e, 0x872498, 0x016863,
-        /* b0 */ 0xfad8c4, 0x7c943f, 0x700dc9, 0xf64132, 0x693e25, 0xef72de, 0xe3eb28, 0x65a7d3,
-        /* b8 */ 0x5b59fd, 0xdd1506, 0xd18cf0, 0x57c00b, 0xc8bf1c, 0x4ef3e7, 0x426a11, 0xc426ea,
-        /* c0 */ 0x2ae476, 0xaca88d, 0xa0317b, 0x267d80, 0xb90297, 0x3f4e6c, 0x33d79a, 0xb59b61,
-        /* c8 */ 0x8b654f, 0x0d29b4, 0x01b042, 0x87fcb9, 0x1883ae, 0x9ecf55, 0x9256a3, 0x141a58,
-        /* d0 */ 0xefaaff, 0x69e604, 0x657ff2, 0xe33309, 0x7c4c1e, 0xfa00e5, 0xf69913, 0x70d5e8,
-        /* d8 */ 0x4e2bc6, 0xc8673d, 0xc4fecb, 0x42b230, 0xddcd27, 0x5b81dc, 0x57182a, 0xd154d1,
-        /* e0 */ 0x26359f, 0xa07964, 0xace092, 0x2aac69, 0xb5d37e, 0x339f85, 0x3f0673, 0xb94a88,
-        /* e8 */ 0x87b4a6, 0x01f85d, 0x0d61ab, 0x8b2d50, 0x145247, 0x921ebc, 0x9e874a, 0x18cbb1,
-        /* f0 */ 0xe37b16, 0x6537ed, 0x69ae1b, 0xefe2e0, 0x709df7, 0xf6d10c, 0xfa48fa, 0x7c0401,
-        /* f8 */ 0x42fa2f, 0xc4b6d4, 0xc82f22, 0x4e63d9, 0xd11cce, 0x575035, 0x5bc9c3, 0xdd8538
-    };
-#define RTCM_CRC(crc, by) (crc << 8) ^ _crc24qTable[(by ^ (crc >> 16)) & 0xff]
-    // CRC is over the entire message, 0xD3 included
-    crc = RTCM_CRC(crc, by);
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    if ((0xFC & by) != 0) {
-        return U_ERROR_COMMON_NOT_FOUND;
-    }
-    uint16_t l = (uint16_t) ((by & 0x3) << 8);
-    crc = RTCM_CRC(crc, by);
-    if (!uRingBufferGetByteUnprotected(parseHandle, &by)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    l += by;
     // Length includes the two-byte message ID and the message
     // body, i.e. up to the start of the 3-byte CRC, i.e.
     // the total message length - 6.
-    if (l > uRingBufferBytesAvailableUnprotected(parseHandle) + 3) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    crc = RTCM_CRC(crc, by);
-    uint8_t idLo, idHi;
-    if (!uRingBufferGetByteUnprotected(parseHandle, &idLo)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    l--;
-    crc = RTCM_CRC(crc, idLo);
-    if (!uRingBufferGetByteUnprotected(parseHandle, &idHi)) {
-        return U_ERROR_COMMON_TIMEOUT;
-    }
-    l--;
-    crc = RTCM_CRC(crc, idHi);
-    pMsgId->id.rtcm = (idHi >> 4) + (uint16_t) (idLo << 4);
-    while (l--) {
-        uRingBufferGetByteUnprotected(parseHandle, &by);
-        crc = RTCM_CRC(crc, by);
-    }
-    // Compare CRC
-    for (int32_t x = 2; (x >= 0) && uRingBufferGetByteUnprotected(parseHandle, &by); x--) {
-        if (by != (uint8_t) (crc >> (8 * x))) {
-            return U_ERROR_COMMON_TIMEOUT;
+    uint32_t length = 0;
+    uint8_t by = 0;
+    const char *pSpan;
+    size_t spanLength;
+    bool done = false;
+
+    if (pState == NULL) {
+        pState = stateLocal;
+    }
+    if (resume) {
+        position = pState[0];
+        crc = pState[1];
+        length = pState[2];
+        pMsgId->id.rtcm = (uint16_t) pState[3];
+    }
+    while (!done) {
+        if ((position >= 5) && (position < length + 3)) {
+            // Body, the most likely case: CRC as much of it as is
+            // contiguous in the ring buffer in one go
+            spanLength = uRingBufferGetSpanUnprotected(parseHandle, &pSpan,
+                                                       length + 3 - position);
+            crc = uCrc24QUpdate(crc, pSpan, spanLength);
+            position += spanLength;
+            done = (spanLength == 0);
+        } else if (uRingBufferGetByteUnprotected(parseHandle, &by)) {
+            // Header or CRC, a byte at a time
+            if (position == 0) {
+                if (0xD3 != by) {
+                    return U_ERROR_COMMON_NOT_FOUND;
+                }
+                // CRC is over the entire message, 0xD3 included
+                crc = uCrc24QUpdate(crc, (const char *) &by, 1);
+            } else if (position == 1) {
+                if ((0xFC & by) != 0) {
+                    return U_ERROR_COMMON_NOT_FOUND;
+                }
+                length = ((uint32_t) (by & 0x3)) << 8;
+                crc = uCrc24QUpdate(crc, (const char *) &by, 1);
+            } else if (position == 2) {
+                length += by;
+                if (length < 2) {
+                    // Not even room for the message ID
+                    return U_ERROR_COMMON_NOT_FOUND;
+                }
+                crc = uCrc24QUpdate(crc, (const char *) &by, 1);
+            } else if (position == 3) {
+                pMsgId->id.rtcm = (uint16_t) (by << 4);
+                crc = uCrc24QUpdate(crc, (const char *) &by, 1);
+            } else if (position == 4) {
+                pMsgId->id.rtcm += by >> 4;
+                crc = uCrc24QUpdate(crc, (const char *) &by, 1);
+            } else {
+                // Compare CRC, most significant byte first
+                if (by != (uint8_t) (crc >> (8 * (length + 5 - position)))) {
+                    return U_ERROR_COMMON_NOT_FOUND;
+                }
+                if (position == length + 5) {
+                    // We can only claim this as an RTCM-format message if
+                    // there was nothing that needed discarding first.
+                    if (uRingBufferBytesDiscardUnprotected(parseHandle) == 0) {
+                        pMsgId->type = U_GNSS_PROTOCOL_RTCM;
+                    }
+                    return U_ERROR_COMMON_SUCCESS;
+                }
+            }
+            position++;
+        } else {
+            done = true;
         }
     }
-    // We can only claim this as an RTCM-format message if
-    // there was nothing that needed discarding first.
-    if (uRingBufferBytesDiscardUnprotected(parseHandle) == 0) {
-        pMsgId->type = U_GNSS_PROTOCOL_RTCM;
-    }
-    return U_ERROR_COMMON_SUCCESS;
+
+    pState[0] = position;
+    pState[1] = crc;
+    pState[2] = length;
+    pState[3] = pMsgId->id.rtcm;
+
+    return U_ERROR_COMMON_TIMEOUT;
 }
 
 /* ----------------------------------------------------------------
@@ -2266,6 +2442,33 @@ bool uGnssPrivateIsInsideCell(const uGnssPrivateInstance_t *pInstance)
     return isInside;
 }
 
+// Check whether the "data received" event callback of the transport
+// is still the one set by the message receive task.
+bool uGnssPrivateMsgReceiveDataEventIsOurs(const uGnssPrivateInstance_t *pInstance)
+{
+    bool isOurs = false;
+    uDeviceSerial_t *pDeviceSerial;
+
+    switch (uGnssPrivateGetStreamType(pInstance->transportType)) {
+        case U_GNSS_PRIVATE_STREAM_TYPE_UART:
+            isOurs = (uPortUartEventCallbackFilterGet(pInstance->transportHandle.uart) ==
+                      (U_GNSS_PRIVATE_MSG_RECEIVE_EVENT_FILTER_OURS |
+                       U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED));
+            break;
+        case U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL:
+            pDeviceSerial = pInstance->transportHandle.pDeviceSerial;
+            isOurs = (pDeviceSerial->eventCallbackFilterGet != NULL) &&
+                     (pDeviceSerial->eventCallbackFilterGet(pDeviceSerial) ==
+                      (U_GNSS_PRIVATE_MSG_RECEIVE_EVENT_FILTER_OURS |
+                       U_DEVICE_SERIAL_EVENT_BITMASK_DATA_RECEIVED));
+            break;
+        default:
+            break;
+    }
+
+    return isOurs;
+}
+
 // Stop the asynchronous message receive task.
 void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance)
 {
@@ -2276,10 +2479,39 @@ void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance)
     if ((pInstance != NULL) && (pInstance->pMsgReceive != NULL)) {
         pMsgReceive = pInstance->pMsgReceive;
 
-        // Sending the task anything will cause it to exit
+        // Stop the transport waking the task up, provided that
+        // the event callback is still ours: if the application
+        // has since set its own we must leave that alone
+        if (pMsgReceive->dataEventIsSet &&
+            uGnssPrivateMsgReceiveDataEventIsOurs(pInstance)) {
+            switch (uGnssPrivateGetStreamType(pInstance->transportType)) {
+                case U_GNSS_PRIVATE_STREAM_TYPE_UART:
+                    uPortUartEventCallbackRemove(pInstance->transportHandle.uart);
+                    break;
+                case U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL: {
+                    uDeviceSerial_t *pDeviceSerial = pInstance->transportHandle.pDeviceSerial;
+                    pDeviceSerial->eventCallbackRemove(pDeviceSerial);
+                }
+                break;
+                default:
+                    break;
+            }
+        }
+        pMsgReceive->dataEventIsSet = false;
+
+        // Sending the task anything will cause it to exit; give
+        // the semaphore so that it notices immediately
         uPortQueueSend(pMsgReceive->taskExitQueueHandle, queueItem);
+        uPortSemaphoreGive(pMsgReceive->dataSemaphoreHandle);
         U_PORT_MUTEX_LOCK(pMsgReceive->taskRunningMutexHandle);
         U_PORT_MUTEX_UNLOCK(pMsgReceive->taskRunningMutexHandle);
+
+        // Detach the message receive context from the instance
+        // before any of it is freed so that the Data Ready
+        // interrupt no longer finds it; the wait below also
+        // lets an interrupt that found it just before finish
+        pInstance->pMsgReceive = NULL;
+
         // Wait for the task to actually exit: the STM32F4 platform
         // needs this additional delay for some reason or it stalls here
         uPortTaskBlock(U_CFG_OS_YIELD_MS);
@@ -2296,22 +2528,20 @@ void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance)
         uPortMutexDelete(pMsgReceive->taskRunningMutexHandle);
         uPortQueueDelete(pMsgReceive->taskExitQueueHandle);
         uPortMutexDelete(pMsgReceive->readerMutexHandle);
+        uPortMutexDelete(pMsgReceive->dispatchMutexHandle);
+        uPortSemaphoreDelete(pMsgReceive->dataSemaphoreHandle);
 
         // Pause here to allow the deletions
         // to actually occur in the idle thread,
         // required by some RTOSs (e.g. FreeRTOS)
         uPortTaskBlock(U_CFG_OS_YIELD_MS);
 
-        // Free the temporary buffer
-        uPortFree(pMsgReceive->pTemporaryBuffer);
-
         // Give the ring buffer handle back
         uRingBufferGiveReadHandle(&(pInstance->ringBuffer),
                                   pMsgReceive->ringBufferReadHandle);
 
         // Add it's done
-        uPortFree(pInstance->pMsgReceive);
-        pInstance->pMsgReceive = NULL;
+        uPortFree(pMsgReceive);
     }
 }
 
@@ -2526,28 +2756,69 @@ int32_t uGnssPrivateStreamGetReceiveSize(uGnssPrivateInstance_t *pInstance)
             break;
             case U_GNSS_PRIVATE_STREAM_TYPE_SPI: {
                 char spiBuffer[U_GNSS_SPI_FILL_THRESHOLD_MAX] = {0}; // Zero'ed to keep Valgrind happy
+                size_t spiReadLengthIdle;
                 size_t spiReadLength;
+                size_t spiReadTotal = 0;
+                size_t thisLength;
+                size_t usefulBytes = pInstance->spiUsefulBytes;
+                size_t fillBytesDiscarded;
+                bool idle = false;
+                int32_t x = 0;
                 // SPI handling is a little different: since there is no way
                 // to tell if there is any valid data, one just has to read
                 // it and see if it is not 0xFF fill, we actually do a read
-                // of up to spiFillThreshold bytes here, then we can determine
+                // of at least spiFillThreshold bytes here, then we can determine
                 // whether there is any real stuff.  The data that is read is
                 // stored in the internal SPI ring buffer and can be read out
-                // by whoever called this function
-                spiReadLength = pInstance->spiFillThreshold;
-                if (spiReadLength < U_GNSS_PRIVATE_SPI_READ_LENGTH_MIN_BYTES) {
-                    spiReadLength = U_GNSS_PRIVATE_SPI_READ_LENGTH_MIN_BYTES;
+                // by whoever called this function.  So as not to clock in
+                // lots of fill when the GNSS chip has nothing to say, but
+                // to keep up when it does, the read length grows while
+                // data is flowing and falls back when fill is seen
+                spiReadLengthIdle = pInstance->spiFillThreshold;
+                if (spiReadLengthIdle < U_GNSS_PRIVATE_SPI_READ_LENGTH_MIN_BYTES) {
+                    spiReadLengthIdle = U_GNSS_PRIVATE_SPI_READ_LENGTH_MIN_BYTES;
                 }
-                errorCodeOrReceiveSize = uPortSpiControllerSendReceiveBlock(pInstance->transportHandle.spi,
-                                                                            NULL, 0,
-                                                                            spiBuffer,
-                                                                            spiReadLength);
-                if (errorCodeOrReceiveSize > 0) {
-                    // This will add any non-fill SPI received data to the
-                    // internal SPI ring buffer
-                    errorCodeOrReceiveSize = uGnssPrivateSpiAddReceivedData(pInstance,
-                                                                            spiBuffer,
-                                                                            errorCodeOrReceiveSize);
+                spiReadLength = pInstance->spiReadLength;
+                if (spiReadLength < spiReadLengthIdle) {
+                    spiReadLength = spiReadLengthIdle;
+                }
+                while ((spiReadTotal < spiReadLength) && !idle && (x >= 0)) {
+                    thisLength = spiReadLength - spiReadTotal;
+                    if (thisLength > sizeof(spiBuffer)) {
+                        thisLength = sizeof(spiBuffer);
+                    }
+                    x = uPortSpiControllerSendReceiveBlock(pInstance->transportHandle.spi,
+                                                           NULL, 0, spiBuffer, thisLength);
+                    if (x > 0) {
+                        spiReadTotal += x;
+                        // This will add any non-fill SPI received data to the
+                        // internal SPI ring buffer; if it had to throw any
+                        // fill away then the GNSS chip has run out of things
+                        // to say, no point in reading more
+                        fillBytesDiscarded = pInstance->spiFillBytesDiscarded;
+                        errorCodeOrReceiveSize = uGnssPrivateSpiAddReceivedData(pInstance,
+                                                                                spiBuffer, x);
+                        idle = (pInstance->spiFillBytesDiscarded != fillBytesDiscarded) ||
+                               ((pInstance->spiFillThreshold > 0) &&
+                                (spiFillLengthEnd(spiBuffer, x) >= (size_t) pInstance->spiFillThreshold));
+                    } else if (spiReadTotal == 0) {
+                        errorCodeOrReceiveSize = x;
+                    }
+                }
+                if (pInstance->spiFillThreshold > 0) {
+                    // Without a fill threshold we can't tell idle from
+                    // busy, so only adapt the read length if there is one
+                    if (pInstance->spiUsefulBytes <= usefulBytes) {
+                        // Nothing useful: the GNSS chip is idle
+                        spiReadLength = spiReadLengthIdle;
+                    } else if (!idle) {
+                        // All useful: read more next time
+                        spiReadLength <<= 1;
+                        if (spiReadLength > U_GNSS_SPI_READ_LENGTH_MAX_BYTES) {
+                            spiReadLength = U_GNSS_SPI_READ_LENGTH_MAX_BYTES;
+                        }
+                    }
+                    pInstance->spiReadLength = spiReadLength;
                 }
             }
             break;
@@ -2587,7 +2858,10 @@ int32_t uGnssPrivateStreamDecodeRingBuffer(uRingBuffer_t *pRingBuffer,
             uGnssPrivateMessageId_t msg;
             memset(&msg, 0, sizeof(msg));
             msg.type = U_GNSS_PROTOCOL_UNKNOWN;
-            errorCodeOrLength = uRingBufferParseHandle(pRingBuffer, readHandle, parserList, &msg);
+            errorCodeOrLength = uRingBufferParseHandleSync(pRingBuffer, readHandle, parserList,
+                                                           gParserStartBytes,
+                                                           sizeof(gParserStartBytes),
+                                                           &msg);
             if (errorCodeOrLength <= 0) {
                 break;
             } else if (uGnssPrivateMessageIdIsWanted(&msg, pPrivateMessageId)) {
@@ -2654,18 +2928,13 @@ int32_t uGnssPrivateStreamFillRingBuffer(uGnssPrivateInstance_t *pInstance,
     int32_t receiveSize;
     int32_t totalReceiveSize = 0;
     int32_t ringBufferAvailableSize;
-    char *pTemporaryBuffer;
+    char *pData1;
+    size_t length1;
+    char *pData2;
+    size_t length2;
+    int32_t x;
 
     if (pInstance != NULL) {
-        pTemporaryBuffer = pInstance->pTemporaryBuffer;
-        if ((pInstance->pMsgReceive != NULL) &&
-            uPortTaskIsThis(pInstance->pMsgReceive->taskHandle)) {
-            // If we're being called from the message receive task,
-            // which does not lock gUGnssPrivateMutex, we use its
-            // temporary buffer in order to avoid clashes with
-            // the main application task
-            pTemporaryBuffer = pInstance->pMsgReceive->pTemporaryBuffer;
-        }
         errorCodeOrLength = (int32_t) U_ERROR_COMMON_NOT_SUPPORTED;
         privateStreamTypeOrError = uGnssPrivateGetStreamType(pInstance->transportType);
         if (privateStreamTypeOrError >= 0) {
@@ -2675,64 +2944,64 @@ int32_t uGnssPrivateStreamFillRingBuffer(uGnssPrivateInstance_t *pInstance,
             // it always has one go even with a zero timeout
             do {
                 receiveSize = uGnssPrivateStreamGetReceiveSize(pInstance);
-                // Don't try to read in more than uRingBufferForceAdd()
+                // Don't try to read in more than a forced add
                 // can put into the ring buffer
                 ringBufferAvailableSize = uRingBufferAvailableSizeMax(&(pInstance->ringBuffer));
                 if (receiveSize > ringBufferAvailableSize) {
                     receiveSize = ringBufferAvailableSize;
                 }
+                if (receiveSize > U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES) {
+                    receiveSize = U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES;
+                }
                 if (receiveSize > 0) {
-                    // Read into a temporary buffer
-                    if (receiveSize > U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES) {
-                        receiveSize = U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES;
-                    }
-                    switch (privateStreamTypeOrError) {
-                        case U_GNSS_PRIVATE_STREAM_TYPE_UART:
-                            // For UART we ask for as much data as we can, it will just
-                            // bring in more if more has arrived between the "receive
-                            // size" call above and now
-                            receiveSize = uPortUartRead(pInstance->transportHandle.uart, pTemporaryBuffer,
-                                                        U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES);
-                            break;
-                        case U_GNSS_PRIVATE_STREAM_TYPE_I2C:
-                            // For I2C we need to ask for the amount we know is there since
-                            // the I2C buffer is effectively on the GNSS chip and I2C drivers
-                            // often don't say how much they've read, just giving us back
-                            // the number we asked for on a successful read
-                            receiveSize = uPortI2cControllerExchange(pInstance->transportHandle.i2c,
-                                                                     pInstance->i2cAddress,
-                                                                     NULL, 0,
-                                                                     pTemporaryBuffer,
-                                                                     receiveSize, false);
-                            break;
-                        case U_GNSS_PRIVATE_STREAM_TYPE_SPI:
-                            // For the SPI case, we need to pull the data that was
-                            // received in uGnssPrivateStreamGetReceiveSize() back
-                            // out of the SPI ring buffer and into our temporary buffer
-                            receiveSize = (int32_t) uRingBufferRead(pInstance->pSpiRingBuffer,
-                                                                    pTemporaryBuffer, receiveSize);
-                            break;
-                        case U_GNSS_PRIVATE_STREAM_TYPE_VIRTUAL_SERIAL: {
-                            // As for the UART case, we ask for as much data as we can
-                            uDeviceSerial_t *pDeviceSerial = pInstance->transportHandle.pDeviceSerial;
-                            receiveSize = pDeviceSerial->read(pDeviceSerial, pTemporaryBuffer,
-                                                              U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES);
+                    // Reserve space in the ring buffer to read straight into;
+                    // this is forced: it is up to this MCU to keep up, we don't
+                    // want to block data from the GNSS chip, after all it has
+                    // no UART flow control lines that we can stop it with.
+                    // Only ask for what we know is there, since forcing throws
+                    // data away from readers to make room.  If the message
+                    // receive task and the main application task both get
+                    // here at once, one of them will be given no space and
+                    // will simply wait, below, for another go
+                    receiveSize = (int32_t) uRingBufferReserveSpans(&(pInstance->ringBuffer),
+                                                                    receiveSize, true,
+                                                                    &pData1, &length1,
+                                                                    &pData2, &length2);
+                }
+                if (receiveSize > 0) {
+                    receiveSize = streamRead(pInstance, privateStreamTypeOrError,
+                                             pData1, length1);
+                    if ((receiveSize == (int32_t) length1) && (length2 > 0)) {
+                        // Carry on into the space that wrapped around to
+                        // the start of the ring buffer; should this fail
+                        // we keep what we have and the error will
+                        // show up next time
+                        x = streamRead(pInstance, privateStreamTypeOrError,
+                                       pData2, length2);
+                        if (x > 0) {
+                            receiveSize += x;
                         }
-                        break;
-                        default:
-                            break;
+                    }
+                    if (receiveSize > 0) {
+                        // Capture what we got, if required, while it
+                        // is still ours
+                        uGnssCapturePrivateAdd(pInstance, pData1,
+                                               (size_t) receiveSize > length1 ? length1 : (size_t) receiveSize,
+                                               pData2,
+                                               (size_t) receiveSize > length1 ? (size_t) receiveSize - length1 : 0);
+                    }
+                    // Hand what we got over to the readers
+                    uRingBufferCommit(&(pInstance->ringBuffer),
+                                      receiveSize > 0 ? receiveSize : 0);
+                    if ((receiveSize > 0) && (pInstance->pMsgReceive != NULL) &&
+                        !uPortTaskIsThis(pInstance->pMsgReceive->taskHandle)) {
+                        // The data may have been what the message receive
+                        // task was waiting for: wake it up
+                        uPortSemaphoreGive(pInstance->pMsgReceive->dataSemaphoreHandle);
                     }
                     if (receiveSize >= 0) {
                         totalReceiveSize += receiveSize;
                         errorCodeOrLength = totalReceiveSize;
-                        // Now stuff this into the ring buffer; we use a forced
-                        // add: it is up to this MCU to keep up, we don't want
-                        // to block data from the GNSS chip, after all it has
-                        // no UART flow control lines that we can stop it with
-                        if (!uRingBufferForceAdd(&(pInstance->ringBuffer),
-                                                 pTemporaryBuffer, receiveSize)) {
-                            errorCodeOrLength = (int32_t) U_ERROR_COMMON_NO_MEMORY;
-                        }
                     } else {
                         // Error case
                         errorCodeOrLength = receiveSize;
@@ -3011,32 +3280,49 @@ int32_t uGnssPrivateSpiAddReceivedData(uGnssPrivateInstance_t *pInstance,
                                        const char *pBuffer, size_t size)
 {
     int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
-    const char *pTmp = pBuffer;
-    int32_t y;
+    size_t fillThreshold;
+    size_t fillLength;
+    size_t dataSize;
 
     if ((pInstance != NULL) && (pInstance->pSpiRingBuffer != NULL) &&
         (pBuffer != NULL) && (size > 0)) {
-        if ((pInstance->spiFillThreshold > 0) && (size >= (size_t) pInstance->spiFillThreshold)) {
-            // Check if all we have is fill and chuck stuff away if so
-            // Note: do the comparison as a uint8_t pointer to avoid
-            // issues with char being signed
-            for (size_t x = 0; (x < size) && ((*(const uint8_t *) pTmp) == U_GNSS_PRIVATE_SPI_FILL); x++) {
-                pTmp++;
-            }
-            y = pTmp - pBuffer;
-            if (y >= pInstance->spiFillThreshold) {
-                pBuffer += y;
-                size -= y;
+        pInstance->spiTransfers++;
+        if (pInstance->spiFillThreshold > 0) {
+            fillThreshold = (size_t) pInstance->spiFillThreshold;
+            // Chuck away any run of fill at the start of what we
+            // have, which means that a long run of fill never gets
+            // as far as the ring buffer; this is safe because no
+            // UBX, NMEA or RTCM message begins with 0xFF.  Fill at
+            // the end is left alone: the last byte of a message may
+            // genuinely be 0xFF, so it can only be removed once the
+            // message in front of it has been read (see below)
+            fillLength = spiFillLengthStart(pBuffer, size);
+            if (fillLength >= fillThreshold) {
+                pBuffer += fillLength;
+                size -= fillLength;
+                pInstance->spiFillBytesDiscarded += fillLength;
             }
         }
-        // Do a forced add so we always keep the most recent data
-        uRingBufferForceAdd(pInstance->pSpiRingBuffer, pBuffer, size);
-        if (pInstance->spiFillThreshold > 0) {
-            // Fill might still have got into the ring buffer, e.g. if
-            // we are receiving data in chunks smaller than the fill
-            // threshold, so check for any fill in the buffer also
-            uRingBufferFlushValue(pInstance->pSpiRingBuffer, U_GNSS_PRIVATE_SPI_FILL,
-                                  pInstance->spiFillThreshold);
+        if (size > 0) {
+            // Do a forced add so we always keep the most recent data
+            uRingBufferForceAdd(pInstance->pSpiRingBuffer, pBuffer, size);
+            pInstance->spiUsefulBytes += size;
+            if (pInstance->spiFillThreshold > 0) {
+                // Fill might still have got into the ring buffer, e.g. if
+                // we are receiving data in chunks smaller than the fill
+                // threshold, or be left over from the end of an earlier
+                // chunk, so check for any fill at the start of the
+                // buffer also
+                dataSize = uRingBufferDataSize(pInstance->pSpiRingBuffer);
+                uRingBufferFlushValue(pInstance->pSpiRingBuffer, U_GNSS_PRIVATE_SPI_FILL,
+                                      pInstance->spiFillThreshold);
+                fillLength = dataSize - uRingBufferDataSize(pInstance->pSpiRingBuffer);
+                if (fillLength > 0) {
+                    // These were counted as useful when they were added
+                    pInstance->spiFillBytesDiscarded += fillLength;
+                    pInstance->spiUsefulBytes -= fillLength;
+                }
+            }
         }
         errorCodeOrLength = (int32_t) uRingBufferDataSize(pInstance->pSpiRingBuffer);
     }
@@ -81,6 +81,17 @@ extern "C" {
 # define U_GNSS_RING_BUFFER_MIN_FILL_TIME_MS 100
 #endif
 
+#ifndef U_GNSS_MSG_READER_INDEX_SIZE
+/** The number of buckets in the index that the message receive
+ * task uses to find the readers, started with
+ * uGnssMsgReceiveStart(), that want a given message: readers of
+ * a specific UBX class/ID, RTCM type or NMEA talker/sentence are
+ * put into a bucket, readers with a wildcard are put into a
+ * separate list that is always checked.
+ */
+# define U_GNSS_MSG_READER_INDEX_SIZE 16
+#endif
+
 /** Determine if the given feature is supported or not
  * by the pointed-to module.
  */
@@ -110,6 +121,14 @@ extern "C" {
  */
 #define U_GNSS_PRIVATE_SPI_FILL 0xFF
 
+/** A bit, not an event, that the asynchronous message receive task
+ * adds to the filter when it sets the "data received" event callback
+ * of a UART or virtual serial transport, so that it can tell whether
+ * the callback is still its own or has been replaced by one of the
+ * application's.
+ */
+#define U_GNSS_PRIVATE_MSG_RECEIVE_EVENT_FILTER_OURS 0x80000000UL
+
 #ifndef U_GNSS_CFG_LAYERS_SET
 /** The layers to use when using CFG-VAL to set a configuration
  * value: both RAM and BBRAM if on/off power saving might be used
@@ -209,6 +228,9 @@ typedef struct uGnssPrivateMsgReader_t {
                           into everything. */
     void *pCallbackParam;
     struct uGnssPrivateMsgReader_t *pNext;
+    struct uGnssPrivateMsgReader_t *pIndexNext; /**< the next reader in the same index bucket
+                                                     or in the wildcard list. */
+    struct uGnssPrivateMsgReader_t *pDispatchNext; /**< only used by the message receive task. */
 } uGnssPrivateMsgReader_t;
 
 /** Structure to hold the data associated with the task running
@@ -217,13 +239,21 @@ typedef struct uGnssPrivateMsgReader_t {
 typedef struct {
     int32_t nextHandle;
     uPortTaskHandle_t taskHandle;
-    char *pTemporaryBuffer;
     uPortMutexHandle_t taskRunningMutexHandle;
     uPortQueueHandle_t taskExitQueueHandle;
     uPortMutexHandle_t readerMutexHandle;
     int32_t ringBufferReadHandle;
     size_t msgBytesLeftToRead;
     uGnssPrivateMsgReader_t *pReaderList;
+    uGnssPrivateMsgReader_t *pReaderIndex[U_GNSS_MSG_READER_INDEX_SIZE]; /**< readers of a specific
+                                                                              message ID, by bucket,
+                                                                              newest first. */
+    uGnssPrivateMsgReader_t *pReaderWildcard; /**< readers with a wildcard in their message ID,
+                                                   newest first. */
+    uPortMutexHandle_t dispatchMutexHandle; /**< held by the message receive task while it
+                                                 calls reader callbacks. */
+    uPortSemaphoreHandle_t dataSemaphoreHandle; /**< given when there may be new data to process. */
+    bool dataEventIsSet; /**< true if the "data received" event of the transport gives dataSemaphoreHandle. */
 } uGnssPrivateMsgReceive_t;
 
 /** Parameters to pass to the streamed position callback.
@@ -297,12 +327,15 @@ typedef struct uGnssPrivateInstance_t {
     char *pSpiLinearBuffer; /**< the linear buffer that will be used by pSpiRingBuffer. */
     uRingBuffer_t ringBuffer; /**< the ring buffer where we put messages from the GNSS chip. */
     char *pLinearBuffer; /**< the linear buffer that will be used by ringBuffer. */
-    char *pTemporaryBuffer; /**< a temporary buffer, used to get stuff into ringBuffer. */
     int32_t ringBufferReadHandlePrivate; /**< the read handle for this code to use, -1 if there isn't one. */
     int32_t ringBufferReadHandleMsgReceive; /**< the read handle for uGnssUtilTransparentReceive(). */
     uint16_t i2cAddress; /**< the I2C address of the GNSS chip, only relevant if the transport is I2C. */
     int32_t timeoutMs; /**< the timeout for responses from the GNSS chip in milliseconds. */
     int32_t spiFillThreshold; /**< the number of 0xFF fill bytes which constitute "no data" on SPI. */
+    size_t spiReadLength; /**< the current adaptive SPI read length, zero until the first read. */
+    size_t spiTransfers; /**< the number of SPI transfers that have delivered data to pSpiRingBuffer. */
+    size_t spiFillBytesDiscarded; /**< the number of SPI fill bytes thrown away. */
+    size_t spiUsefulBytes; /**< the number of SPI bytes that were not fill. */
     bool printUbxMessages; /**< whether debug printing of UBX messages is on or off. */
     int32_t retriesOnNoResponse; /**< number of times to retry message transmission if there is no response. */
     int32_t pinGnssEnablePower; /**< the pin of the MCU that enables power to the GNSS module. */
@@ -324,6 +357,7 @@ typedef struct uGnssPrivateInstance_t {
     uGnssRrlpMode_t rrlpMode; /**< the type of MEASX to use with RRLP capture. */
     uGnssPrivateMga_t *pMga; /**< storage for AssistNow. */
     void *pFenceContext; /**< storage for a uGeofenceContext_t. */
+    void *pCapture; /**< storage for capture, see u_gnss_capture.c. */
     uGnssPrivateDataReadyMcu_t *pDataReadyMcu; /**< storage for MCU-side Data Ready functionality. */
     struct uGnssPrivateInstance_t *pNext;
 } uGnssPrivateInstance_t;
@@ -656,6 +690,15 @@ bool uGnssPrivateIsInsideCell(const uGnssPrivateInstance_t *pInstance);
  */
 void uGnssPrivateStopMsgReceive(uGnssPrivateInstance_t *pInstance);
 
+/** Check whether the "data received" event callback of the transport
+ * is still the one that the asynchronous message receive task set,
+ * i.e. that it has not since been removed or replaced by someone else.
+ *
+ * @param[in] pInstance  a pointer to the GNSS instance, cannot be NULL.
+ * @return               true if the event callback is ours, else false.
+ */
+bool uGnssPrivateMsgReceiveDataEventIsOurs(const uGnssPrivateInstance_t *pInstance);
+
 /* ----------------------------------------------------------------
  * FUNCTIONS: MESSAGE RELATED
  * -------------------------------------------------------------- */
@@ -0,0 +1,499 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* Only #includes of u_* and the C standard library are allowed here,
+ * no platform stuff and no OS stuff.  Anything required from
+ * the platform/OS must be brought in through u_port* to maintain
+ * portability.
+ */
+
+/** @file
+ * @brief Tests for the GNSS capture/replay API: they do not require a
+ * GNSS module to run, hence these should pass on all platforms; the
+ * file part of the test is only run where the uPortFileXxx() API is
+ * implemented.
+ * IMPORTANT: see notes in u_cfg_test_platform_specific.h for the
+ * naming rules that must be followed when using the U_PORT_TEST_FUNCTION()
+ * macro.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"    // memset(), memcmp(), strlen()
+#include "stdio.h"     // snprintf()
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+#include "u_cfg_app_platform_specific.h"
+#include "u_cfg_test_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_file.h"
+
+#include "u_test_util_resource_check.h"
+
+#include "u_ubx_protocol.h"
+
+#include "u_device_serial.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"
+#include "u_gnss_msg.h"
+#include "u_gnss_capture.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/** The base string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX_BASE "U_GNSS_CAPTURE_TEST"
+
+/** The string to put at the start of all prints from this test.
+ */
+#define U_TEST_PREFIX U_TEST_PREFIX_BASE ": "
+
+/** Print a whole line, with terminator, prefixed for this test file.
+ */
+#define U_TEST_PRINT_LINE(format, ...) uPortLog(U_TEST_PREFIX format "\n", ##__VA_ARGS__)
+
+#ifndef U_GNSS_CAPTURE_TEST_RECORDS
+/** The number of records, each an NMEA sentence, in the test capture.
+ */
+# define U_GNSS_CAPTURE_TEST_RECORDS 40
+#endif
+
+#ifndef U_GNSS_CAPTURE_TEST_RECORD_INTERVAL_MS
+/** The time between records in the test capture.
+ */
+# define U_GNSS_CAPTURE_TEST_RECORD_INTERVAL_MS 20
+#endif
+
+#ifndef U_GNSS_CAPTURE_TEST_SENTENCE_MAX_LENGTH_BYTES
+/** Room for one of the NMEA sentences of the test capture.
+ */
+# define U_GNSS_CAPTURE_TEST_SENTENCE_MAX_LENGTH_BYTES 48
+#endif
+
+#ifndef U_GNSS_CAPTURE_TEST_CAPTURE_MAX_LENGTH_BYTES
+/** Room for the whole test capture.
+ */
+# define U_GNSS_CAPTURE_TEST_CAPTURE_MAX_LENGTH_BYTES (U_GNSS_CAPTURE_HEADER_LENGTH_BYTES +      \
+                                                       (U_GNSS_CAPTURE_TEST_RECORDS + 1) *    \
+                                                       (U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES + \
+                                                        U_GNSS_CAPTURE_TEST_SENTENCE_MAX_LENGTH_BYTES))
+#endif
+
+#ifndef U_GNSS_CAPTURE_TEST_TIMEOUT_MS
+/** How long to wait for a replay to complete.
+ */
+# define U_GNSS_CAPTURE_TEST_TIMEOUT_MS 10000
+#endif
+
+#ifndef U_GNSS_CAPTURE_TEST_FILE_NAME
+/** The file to use when testing capture to, and replay from, file.
+ */
+# define U_GNSS_CAPTURE_TEST_FILE_NAME "/tmp/u_gnss_capture_test.ugc"
+#endif
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** The NMEA sentences that make up the test capture.
+ */
+static char gSentence[U_GNSS_CAPTURE_TEST_RECORDS][U_GNSS_CAPTURE_TEST_SENTENCE_MAX_LENGTH_BYTES];
+
+/** The test capture.
+ */
+static char gCapture[U_GNSS_CAPTURE_TEST_CAPTURE_MAX_LENGTH_BYTES];
+
+/** A capture made while replaying the test capture.
+ */
+static char gCaptured[U_GNSS_CAPTURE_TEST_CAPTURE_MAX_LENGTH_BYTES];
+
+/** The number of bytes at gCaptured.
+ */
+static size_t gCapturedSize = 0;
+
+/** Buffer for data read from the replay device or from
+ * captured records.
+ */
+static char gData[U_GNSS_CAPTURE_TEST_CAPTURE_MAX_LENGTH_BYTES];
+
+/** The number of sentences received by messageCallback(), negative
+ * if one of them was not as expected.
+ */
+static volatile int32_t gMessageCount = 0;
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Append a record to a capture, returning the new size.
+static size_t recordAdd(char *pCapture, size_t size, uint32_t timeMs,
+                        const char *pData, size_t length)
+{
+    uint32_t x32 = uUbxProtocolUint32Encode(timeMs);
+    uint16_t x16 = uUbxProtocolUint16Encode((uint16_t) length);
+
+    memcpy(pCapture + size, &x32, sizeof(x32));
+    memcpy(pCapture + size + sizeof(x32), &x16, sizeof(x16));
+    memcpy(pCapture + size + U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES, pData, length);
+
+    return size + U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES + length;
+}
+
+// Build the NMEA sentences and the test capture from them,
+// ending with a truncated record; returns the size of the capture.
+static size_t captureBuild()
+{
+    size_t size = U_GNSS_CAPTURE_HEADER_LENGTH_BYTES;
+    char checksum;
+    size_t length;
+
+    memset(gCapture, 0, U_GNSS_CAPTURE_HEADER_LENGTH_BYTES);
+    memcpy(gCapture, U_GNSS_CAPTURE_MAGIC, 4);
+    gCapture[4] = U_GNSS_CAPTURE_VERSION;
+    for (size_t x = 0; x < U_GNSS_CAPTURE_TEST_RECORDS; x++) {
+        length = snprintf(gSentence[x], sizeof(gSentence[x]),
+                          "$GPTXT,01,01,02,capture test %02d*", (int) x);
+        checksum = 0;
+        for (size_t y = 1; y < length - 1; y++) {
+            checksum ^= gSentence[x][y];
+        }
+        snprintf(gSentence[x] + length, sizeof(gSentence[x]) - length, "%02X\r\n",
+                 (unsigned char) checksum);
+        size = recordAdd(gCapture, size, x * U_GNSS_CAPTURE_TEST_RECORD_INTERVAL_MS,
+                         gSentence[x], strlen(gSentence[x]));
+    }
+    // Add a truncated record, as if capture was interrupted, by
+    // leaving off the last few bytes of a record
+    size = recordAdd(gCapture, size,
+                     U_GNSS_CAPTURE_TEST_RECORDS * U_GNSS_CAPTURE_TEST_RECORD_INTERVAL_MS,
+                     gSentence[0], strlen(gSentence[0])) - 3;
+
+    return size;
+}
+
+// Pull the data out of the records of a capture into gData,
+// returning the amount of data.
+static size_t captureData(const char *pCapture, size_t size)
+{
+    size_t dataSize = 0;
+    size_t offset = U_GNSS_CAPTURE_HEADER_LENGTH_BYTES;
+    size_t length;
+
+    while (offset + U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES <= size) {
+        length = uUbxProtocolUint16Decode(pCapture + offset + 4);
+        if (offset + U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES + length <= size) {
+            memcpy(gData + dataSize,
+                   pCapture + offset + U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES, length);
+            dataSize += length;
+        }
+        offset += U_GNSS_CAPTURE_RECORD_HEADER_LENGTH_BYTES + length;
+    }
+
+    return dataSize;
+}
+
+// Check that data is the test sentences in order.
+static bool dataIsSentences(const char *pData, size_t size)
+{
+    bool isSentences = true;
+    size_t offset = 0;
+    size_t length;
+
+    for (size_t x = 0; (x < U_GNSS_CAPTURE_TEST_RECORDS) && isSentences; x++) {
+        length = strlen(gSentence[x]);
+        isSentences = (offset + length <= size) &&
+                      (memcmp(pData + offset, gSentence[x], length) == 0);
+        offset += length;
+    }
+
+    return isSentences && (offset == size);
+}
+
+// Read everything from a replay device into gData, returning the
+// amount read.
+static size_t replayReadAll(uDeviceSerial_t *pDeviceSerial)
+{
+    size_t size = 0;
+    int32_t x;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    while (!uGnssCaptureReplayIsAtEnd(pDeviceSerial) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_GNSS_CAPTURE_TEST_TIMEOUT_MS)) {
+        x = pDeviceSerial->read(pDeviceSerial, gData + size, sizeof(gData) - size);
+        if (x > 0) {
+            size += x;
+        } else {
+            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+        }
+    }
+
+    return size;
+}
+
+// Capture callback: append to gCaptured.
+static void captureCallback(uDeviceHandle_t gnssHandle, const char *pData,
+                            size_t size, void *pCallbackParam)
+{
+    (void) gnssHandle;
+    (void) pCallbackParam;
+
+    if (gCapturedSize + size <= sizeof(gCaptured)) {
+        memcpy(gCaptured + gCapturedSize, pData, size);
+    }
+    gCapturedSize += size;
+}
+
+// Message receive callback: check that the sentences arrive in order.
+static void messageCallback(uDeviceHandle_t gnssHandle,
+                            const uGnssMessageId_t *pMessageId,
+                            int32_t errorCodeOrLength,
+                            void *pCallbackParam)
+{
+    char buffer[U_GNSS_CAPTURE_TEST_SENTENCE_MAX_LENGTH_BYTES];
+
+    (void) pMessageId;
+    (void) pCallbackParam;
+
+    if (gMessageCount >= 0) {
+        if ((gMessageCount < U_GNSS_CAPTURE_TEST_RECORDS) &&
+            (errorCodeOrLength == (int32_t) strlen(gSentence[gMessageCount])) &&
+            (uGnssMsgReceiveCallbackRead(gnssHandle, buffer,
+                                         errorCodeOrLength) == errorCodeOrLength) &&
+            (memcmp(buffer, gSentence[gMessageCount], errorCodeOrLength) == 0)) {
+            gMessageCount++;
+        } else {
+            gMessageCount = -1;
+        }
+    }
+}
+
+// Replay a capture, at maximum speed, through a GNSS instance
+// while capturing what arrives, either to captureCallback() or,
+// if pFileName is not NULL, to file; the replay device is only
+// opened once everything is set up since anything replayed
+// before then could be lost.  Returns what uGnssCaptureStop()
+// returned.
+static int32_t replayThroughGnss(uDeviceSerial_t *pDeviceSerial,
+                                 const char *pFileName)
+{
+    uGnssTransportHandle_t transportHandle;
+    uDeviceHandle_t gnssHandle;
+    uGnssMessageId_t messageId;
+    int32_t asyncHandle;
+    int32_t startTimeMs;
+    int32_t x;
+
+    transportHandle.pDeviceSerial = pDeviceSerial;
+    U_PORT_TEST_ASSERT(uGnssAdd(U_GNSS_MODULE_TYPE_M9, U_GNSS_TRANSPORT_VIRTUAL_SERIAL,
+                                transportHandle, -1, false, &gnssHandle) == 0);
+    if (pFileName != NULL) {
+        U_PORT_TEST_ASSERT(uGnssCaptureStartFile(gnssHandle, pFileName) == 0);
+    } else {
+        U_PORT_TEST_ASSERT(uGnssCaptureStart(gnssHandle, captureCallback, NULL) == 0);
+        // The header should have been written already
+        U_PORT_TEST_ASSERT(gCapturedSize == U_GNSS_CAPTURE_HEADER_LENGTH_BYTES);
+    }
+    gMessageCount = 0;
+    messageId.type = U_GNSS_PROTOCOL_NMEA;
+    messageId.id.pNmea = "GPTXT";
+    asyncHandle = uGnssMsgReceiveStart(gnssHandle, &messageId, messageCallback, NULL);
+    U_PORT_TEST_ASSERT(asyncHandle >= 0);
+    U_PORT_TEST_ASSERT(pDeviceSerial->open(pDeviceSerial, NULL, 0) == 0);
+    startTimeMs = uPortGetTickTimeMs();
+    while ((gMessageCount >= 0) && (gMessageCount < U_GNSS_CAPTURE_TEST_RECORDS) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_GNSS_CAPTURE_TEST_TIMEOUT_MS)) {
+        uPortTaskBlock(10);
+    }
+    U_TEST_PRINT_LINE("%d sentence(s) received in %d ms.", gMessageCount,
+                      uPortGetTickTimeMs() - startTimeMs);
+    U_PORT_TEST_ASSERT(gMessageCount == U_GNSS_CAPTURE_TEST_RECORDS);
+    U_PORT_TEST_ASSERT(uGnssCaptureReplayIsAtEnd(pDeviceSerial));
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, asyncHandle) == 0);
+    x = uGnssCaptureStop(gnssHandle);
+    // Stopping again should do no harm
+    U_PORT_TEST_ASSERT(uGnssCaptureStop(gnssHandle) == x);
+    uGnssRemove(gnssHandle);
+    pDeviceSerial->close(pDeviceSerial);
+    uGnssCaptureReplayDelete(pDeviceSerial);
+
+    return x;
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Replay a capture through a GNSS instance, capturing it again
+ * as it goes, then replay it in real time and from file.
+ */
+U_PORT_TEST_FUNCTION("[gnssCapture]", "gnssCaptureReplay")
+{
+    int32_t resourceCount;
+    size_t captureSize;
+    uDeviceSerial_t *pDeviceSerial;
+    int32_t durationMs = (U_GNSS_CAPTURE_TEST_RECORDS - 1) * U_GNSS_CAPTURE_TEST_RECORD_INTERVAL_MS;
+    int32_t startTimeMs;
+    int32_t x;
+    size_t y;
+    uPortFileHandle_t fileHandle;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uGnssInit() == 0);
+
+    captureSize = captureBuild();
+    U_TEST_PRINT_LINE("test capture is %d byte(s), %d record(s) over %d ms.",
+                      captureSize, U_GNSS_CAPTURE_TEST_RECORDS, durationMs);
+
+    // Things that are not captures should be rejected
+    U_PORT_TEST_ASSERT(pUGnssCaptureReplayCreate(NULL, captureSize, false) == NULL);
+    U_PORT_TEST_ASSERT(pUGnssCaptureReplayCreate(gCapture, U_GNSS_CAPTURE_HEADER_LENGTH_BYTES - 1,
+                                                 false) == NULL);
+    U_PORT_TEST_ASSERT(pUGnssCaptureReplayCreate(gSentence[0], strlen(gSentence[0]),
+                                                 false) == NULL);
+
+    // Create a replay device for the test capture and seek about in it
+    pDeviceSerial = pUGnssCaptureReplayCreate(gCapture, captureSize, false);
+    U_PORT_TEST_ASSERT(pDeviceSerial != NULL);
+    U_PORT_TEST_ASSERT(uGnssCaptureReplayGetDurationMs(pDeviceSerial) == durationMs);
+    U_PORT_TEST_ASSERT(uGnssCaptureReplayGetTimeMs(pDeviceSerial) == 0);
+    U_PORT_TEST_ASSERT(!uGnssCaptureReplayIsAtEnd(pDeviceSerial));
+    for (size_t z = 0; z < U_GNSS_CAPTURE_TEST_RECORDS; z++) {
+        // Seek to just after the previous record: should land on this one
+        x = z * U_GNSS_CAPTURE_TEST_RECORD_INTERVAL_MS;
+        U_PORT_TEST_ASSERT(uGnssCaptureReplaySeek(pDeviceSerial, x - (z > 0 ? 1 : 0)) == 0);
+        U_PORT_TEST_ASSERT(uGnssCaptureReplayGetTimeMs(pDeviceSerial) == x);
+    }
+    U_PORT_TEST_ASSERT(uGnssCaptureReplaySeek(pDeviceSerial,
+                                              durationMs + 1) == (int32_t) U_ERROR_COMMON_NOT_FOUND);
+    U_PORT_TEST_ASSERT(uGnssCaptureReplayIsAtEnd(pDeviceSerial));
+    U_PORT_TEST_ASSERT(uGnssCaptureReplayGetTimeMs(pDeviceSerial) == durationMs);
+    U_PORT_TEST_ASSERT(uGnssCaptureReplaySeek(pDeviceSerial, 0) == 0);
+    // Nothing should come out until it is opened
+    U_PORT_TEST_ASSERT(pDeviceSerial->getReceiveSize(pDeviceSerial) == 0);
+
+    // Replay it, at maximum speed, through a GNSS instance
+    // while capturing what arrives; the replay device is only
+    // opened once everything is set up since anything replayed
+    // before then could be lost
+    gCapturedSize = 0;
+    x = replayThroughGnss(pDeviceSerial, NULL);
+    U_TEST_PRINT_LINE("capture while replaying is %d byte(s).", x);
+    U_PORT_TEST_ASSERT(x == (int32_t) gCapturedSize);
+    U_PORT_TEST_ASSERT(gCapturedSize <= sizeof(gCaptured));
+
+    // What was captured should be a capture of the same data
+    U_PORT_TEST_ASSERT(memcmp(gCaptured, gCapture, U_GNSS_CAPTURE_HEADER_LENGTH_BYTES) == 0);
+    y = captureData(gCaptured, gCapturedSize);
+    U_PORT_TEST_ASSERT(dataIsSentences(gData, y));
+
+    // Now replay the capture in real time, reading it directly
+    pDeviceSerial = pUGnssCaptureReplayCreate(gCaptured, gCapturedSize, true);
+    U_PORT_TEST_ASSERT(pDeviceSerial != NULL);
+    U_PORT_TEST_ASSERT(pDeviceSerial->open(pDeviceSerial, NULL, 0) == 0);
+    // Should not be able to read all of the test sentences at once
+    x = pDeviceSerial->getReceiveSize(pDeviceSerial);
+    U_PORT_TEST_ASSERT(x < (int32_t) y);
+    // Replay begins at the time of the first record, which won't
+    // be zero since it took a while for the first data to arrive
+    durationMs = uGnssCaptureReplayGetDurationMs(pDeviceSerial) -
+                 uGnssCaptureReplayGetTimeMs(pDeviceSerial);
+    startTimeMs = uPortGetTickTimeMs();
+    U_PORT_TEST_ASSERT(replayReadAll(pDeviceSerial) == y);
+    x = uPortGetTickTimeMs() - startTimeMs;
+    U_TEST_PRINT_LINE("real-time replay of %d ms of capture took %d ms.", durationMs, x);
+    U_PORT_TEST_ASSERT(x >= durationMs - U_CFG_OS_YIELD_MS);
+    durationMs = (U_GNSS_CAPTURE_TEST_RECORDS - 1) * U_GNSS_CAPTURE_TEST_RECORD_INTERVAL_MS;
+    U_PORT_TEST_ASSERT(dataIsSentences(gData, y));
+    pDeviceSerial->close(pDeviceSerial);
+    uGnssCaptureReplayDelete(pDeviceSerial);
+
+    // Finally, if files are supported, write the test capture to
+    // file and replay it from there
+    x = uPortFileOpenWrite(&fileHandle, U_GNSS_CAPTURE_TEST_FILE_NAME);
+    if (x == 0) {
+        U_PORT_TEST_ASSERT(uPortFileWrite(fileHandle, gCapture, captureSize) == (int32_t) captureSize);
+        U_PORT_TEST_ASSERT(uPortFileClose(fileHandle) == 0);
+        pDeviceSerial = pUGnssCaptureReplayCreateFile(U_GNSS_CAPTURE_TEST_FILE_NAME, false);
+        U_PORT_TEST_ASSERT(pDeviceSerial != NULL);
+        U_PORT_TEST_ASSERT(uGnssCaptureReplayGetDurationMs(pDeviceSerial) == durationMs);
+        U_PORT_TEST_ASSERT(uGnssCaptureReplaySeek(pDeviceSerial,
+                                                  U_GNSS_CAPTURE_TEST_RECORD_INTERVAL_MS) == 0);
+        U_PORT_TEST_ASSERT(pDeviceSerial->open(pDeviceSerial, NULL, 0) == 0);
+        y = replayReadAll(pDeviceSerial);
+        // Should have everything except the first sentence
+        U_PORT_TEST_ASSERT(y == captureData(gCapture, captureSize) - strlen(gSentence[0]));
+        U_PORT_TEST_ASSERT(uGnssCaptureReplaySeek(pDeviceSerial, 0) == 0);
+        y = replayReadAll(pDeviceSerial);
+        U_PORT_TEST_ASSERT(dataIsSentences(gData, y));
+        pDeviceSerial->close(pDeviceSerial);
+        uGnssCaptureReplayDelete(pDeviceSerial);
+        // Replay the test capture through a GNSS instance, capturing
+        // to file this time, and check what ends up in the file
+        pDeviceSerial = pUGnssCaptureReplayCreate(gCapture, captureSize, false);
+        U_PORT_TEST_ASSERT(pDeviceSerial != NULL);
+        x = replayThroughGnss(pDeviceSerial, U_GNSS_CAPTURE_TEST_FILE_NAME);
+        U_TEST_PRINT_LINE("capture to file while replaying is %d byte(s).", x);
+        U_PORT_TEST_ASSERT(x > U_GNSS_CAPTURE_HEADER_LENGTH_BYTES);
+        pDeviceSerial = pUGnssCaptureReplayCreateFile(U_GNSS_CAPTURE_TEST_FILE_NAME, false);
+        U_PORT_TEST_ASSERT(pDeviceSerial != NULL);
+        U_PORT_TEST_ASSERT(pDeviceSerial->open(pDeviceSerial, NULL, 0) == 0);
+        y = replayReadAll(pDeviceSerial);
+        U_PORT_TEST_ASSERT(dataIsSentences(gData, y));
+        pDeviceSerial->close(pDeviceSerial);
+        uGnssCaptureReplayDelete(pDeviceSerial);
+    } else {
+        U_TEST_PRINT_LINE("files not supported (%d), not testing replay from file.", x);
+        U_PORT_TEST_ASSERT(pUGnssCaptureReplayCreateFile(U_GNSS_CAPTURE_TEST_FILE_NAME,
+                                                         false) == NULL);
+    }
+
+    uGnssDeinit();
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+// End of file
@@ -224,13 +224,573 @@ static const uGnssDecTestDataKnown_t gUbxNavHpposllh[] = {
     }
 };
 
+/** Decoded test data for UBX-NAV-STATUS, to be used by gUbxNavStatus (item 0).
+ */
+static const uGnssDecUbxNavStatus_t gUbxNavStatusDecoded0 = {
+    477230000 /* iTOW */, U_GNSS_DEC_UBX_NAV_STATUS_GPS_FIX_3D /* gpsFix */,
+    0x0d /* flags */, 0x00 /* fixStat */, 0x08 /* flags2 */,
+    28743 /* ttff */, 1234567 /* msss */
+};
+
+/** Array of test data for UBX-NAV-STATUS.
+ */
+static const uGnssDecTestDataKnown_t gUbxNavStatus[] = {
+    {
+        {
+            "\xb5\x62\x01\x03\x10\x00\xb0\xf3\x71\x1c\x03\x0d\x00\x08\x47\x70"
+            "\x00\x00\x87\xd6\x12\x00\x82\x49", 24
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0103, NULL
+        },
+        (void *) &gUbxNavStatusDecoded0
+    }
+};
+
+/** Decoded test data for UBX-NAV-DOP, to be used by gUbxNavDop (item 0).
+ */
+static const uGnssDecUbxNavDop_t gUbxNavDopDecoded0 = {
+    477230000 /* iTOW */, 156 /* gDOP */, 118 /* pDOP */, 87 /* tDOP */,
+    95 /* vDOP */, 70 /* hDOP */, 52 /* nDOP */, 47 /* eDOP */
+};
+
+/** Array of test data for UBX-NAV-DOP.
+ */
+static const uGnssDecTestDataKnown_t gUbxNavDop[] = {
+    {
+        {
+            "\xb5\x62\x01\x04\x12\x00\xb0\xf3\x71\x1c\x9c\x00\x76\x00\x57\x00"
+            "\x5f\x00\x46\x00\x34\x00\x2f\x00\xb8\x49", 26
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0104, NULL
+        },
+        (void *) &gUbxNavDopDecoded0
+    }
+};
+
+/** Decoded test data for UBX-NAV-COV, to be used by gUbxNavCov (item 0).
+ */
+static const uGnssDecUbxNavCov_t gUbxNavCovDecoded0 = {
+    477230000 /* iTOW */, 0 /* version */, 1 /* posCovValid */,
+    1 /* velCovValid */, 0.25f /* posCovNN */, -0.125f /* posCovNE */,
+    0.0625f /* posCovND */, 0.5f /* posCovEE */, 0.03125f /* posCovED */,
+    1.5f /* posCovDD */, 0.0078125f /* velCovNN */, 0 /* velCovNE */,
+    -0.00390625f /* velCovND */, 0.015625f /* velCovEE */, 0 /* velCovED */,
+    0.0625f /* velCovDD */
+};
+
+/** Array of test data for UBX-NAV-COV.
+ */
+static const uGnssDecTestDataKnown_t gUbxNavCov[] = {
+    {
+        {
+            "\xb5\x62\x01\x36\x40\x00\xb0\xf3\x71\x1c\x00\x01\x01\x00\x00\x00"
+            "\x00\x00\x00\x00\x00\x00\x00\x00\x80\x3e\x00\x00\x00\xbe\x00\x00"
+            "\x80\x3d\x00\x00\x00\x3f\x00\x00\x00\x3d\x00\x00\xc0\x3f\x00\x00"
+            "\x00\x3c\x00\x00\x00\x00\x00\x00\x80\xbb\x00\x00\x80\x3c\x00\x00"
+            "\x00\x00\x00\x00\x80\x3d\x4d\xca", 72
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0136, NULL
+        },
+        (void *) &gUbxNavCovDecoded0
+    }
+};
+
+/** Decoded test data for UBX-NAV-SAT, to be used by gUbxNavSat (item 0):
+ * a message with a repeated block.
+ */
+static const uGnssDecUbxNavSat_t gUbxNavSatDecoded0 = {
+    477230000 /* iTOW */, 1 /* version */, 2 /* numSvs */,
+    {
+        {0 /* gnssId */, 5 /* svId */, 42 /* cno */, 61 /* elev */, 287 /* azim */, -13 /* prRes */, 0x1f /* flags */},
+        {2 /* gnssId */, 11 /* svId */, 35 /* cno */, -3 /* elev */, 12 /* azim */, 4 /* prRes */, 0x1917 /* flags */}
+    }
+};
+
+/** Array of test data for UBX-NAV-SAT.
+ */
+static const uGnssDecTestDataKnown_t gUbxNavSat[] = {
+    {
+        {
+            "\xb5\x62\x01\x35\x20\x00\xb0\xf3\x71\x1c\x01\x02\x00\x00\x00\x05"
+            "\x2a\x3d\x1f\x01\xf3\xff\x1f\x00\x00\x00\x02\x0b\x23\xfd\x0c\x00"
+            "\x04\x00\x17\x19\x00\x00\x93\x43", 40
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0135, NULL
+        },
+        (void *) &gUbxNavSatDecoded0
+    }
+};
+
+/** Decoded test data for UBX-NAV-SIG, to be used by gUbxNavSig (item 0):
+ * a message with a repeated block.
+ */
+static const uGnssDecUbxNavSig_t gUbxNavSigDecoded0 = {
+    477230000 /* iTOW */, 0 /* version */, 2 /* numSigs */,
+    {
+        {
+            0 /* gnssId */, 5 /* svId */, 0 /* sigId */, 0 /* freqId */,
+            -13 /* prRes */, 42 /* cno */, 7 /* qualityInd */, 0 /* corrSource */,
+            1 /* ionoModel */, 0x01e9 /* sigFlags */
+        },
+        {
+            2 /* gnssId */, 11 /* svId */, 6 /* sigId */, 0 /* freqId */,
+            4 /* prRes */, 35 /* cno */, 4 /* qualityInd */, 0 /* corrSource */,
+            0 /* ionoModel */, 0x0009 /* sigFlags */
+        }
+    }
+};
+
+/** Array of test data for UBX-NAV-SIG.
+ */
+static const uGnssDecTestDataKnown_t gUbxNavSig[] = {
+    {
+        {
+            "\xb5\x62\x01\x43\x28\x00\xb0\xf3\x71\x1c\x00\x02\x00\x00\x00\x05"
+            "\x00\x00\xf3\xff\x2a\x07\x00\x01\xe9\x01\x00\x00\x00\x00\x02\x0b"
+            "\x06\x00\x04\x00\x23\x04\x00\x00\x09\x00\x00\x00\x00\x00\xf8\xd4", 48
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0143, NULL
+        },
+        (void *) &gUbxNavSigDecoded0
+    }
+};
+
+/** Decoded test data for UBX-RXM-RAWX, to be used by gUbxRxmRawx (item 0):
+ * a message with a repeated block.
+ */
+static const uGnssDecUbxRxmRawx_t gUbxRxmRawxDecoded0 = {
+    477230.25 /* rcvTow */, 2278 /* week */, 18 /* leapS */, 2 /* numMeas */,
+    0x01 /* recStat */, 1 /* version */,
+    {
+        {
+            21456789.5 /* prMes */, 112751234.25 /* cpMes */, -1234.5f /* doMes */,
+            0 /* gnssId */, 5 /* svId */, 0 /* sigId */, 0 /* freqId */,
+            64500 /* locktime */, 42 /* cno */, 5 /* prStdev */, 2 /* cpStdev */,
+            6 /* doStdev */, 0x07 /* trkStat */
+        },
+        {
+            23000000.125 /* prMes */, 120868245.75 /* cpMes */, 567.25f /* doMes */,
+            6 /* gnssId */, 3 /* svId */, 0 /* sigId */, 9 /* freqId */,
+            12000 /* locktime */, 35 /* cno */, 7 /* prStdev */, 15 /* cpStdev */,
+            8 /* doStdev */, 0x01 /* trkStat */
+        }
+    }
+};
+
+/** Array of test data for UBX-RXM-RAWX.
+ */
+static const uGnssDecTestDataKnown_t gUbxRxmRawx[] = {
+    {
+        {
+            "\xb5\x62\x02\x15\x50\x00\x00\x00\x00\x00\xb9\x20\x1d\x41\xe6\x08"
+            "\x12\x02\x01\x01\x00\x00\x00\x00\x00\x58\x79\x76\x74\x41\x00\x00"
+            "\x00\x09\xca\xe1\x9a\x41\x00\x50\x9a\xc4\x00\x05\x00\x00\xf4\xfb"
+            "\x2a\x05\x02\x06\x07\x00\x00\x00\x00\x02\x3c\xef\x75\x41\x00\x00"
+            "\x00\x57\x36\xd1\x9c\x41\x00\xd0\x0d\x44\x06\x03\x00\x09\xe0\x2e"
+            "\x23\x07\x0f\x08\x01\x00\xae\xba", 88
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0215, NULL
+        },
+        (void *) &gUbxRxmRawxDecoded0
+    }
+};
+
+/** Decoded test data for UBX-RXM-SFRBX, to be used by gUbxRxmSfrbx (item 0):
+ * a message with a repeated block of whole words.
+ */
+static const uGnssDecUbxRxmSfrbx_t gUbxRxmSfrbxDecoded0 = {
+    0 /* gnssId */, 5 /* svId */, 0 /* sigId */, 0 /* freqId */,
+    10 /* numWords */, 3 /* chn */, 2 /* version */,
+    {
+        0x22c0b0d4, 0x1a2b3c4d, 0x00000000, 0xffffffff, 0x12345678,
+        0x9abcdef0, 0x0badcafe, 0x3fc00000, 0x00c0ffee, 0x2a2a2a2a
+    } /* dwrd */
+};
+
+/** Array of test data for UBX-RXM-SFRBX.
+ */
+static const uGnssDecTestDataKnown_t gUbxRxmSfrbx[] = {
+    {
+        {
+            "\xb5\x62\x02\x13\x30\x00\x00\x05\x00\x00\x0a\x03\x02\x00\xd4\xb0"
+            "\xc0\x22\x4d\x3c\x2b\x1a\x00\x00\x00\x00\xff\xff\xff\xff\x78\x56"
+            "\x34\x12\xf0\xde\xbc\x9a\xfe\xca\xad\x0b\x00\x00\xc0\x3f\xee\xff"
+            "\xc0\x00\x2a\x2a\x2a\x2a\x95\xa8", 56
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0213, NULL
+        },
+        (void *) &gUbxRxmSfrbxDecoded0
+    }
+};
+
+/** Decoded test data for UBX-ESF-MEAS, to be used by gUbxEsfMeas (item 0):
+ * a message with a repeated block followed by a trailing field.
+ */
+static const uGnssDecUbxEsfMeas_t gUbxEsfMeasDecoded0 = {
+    123456 /* timeTag */, 0x1008 /* flags */, 0 /* id */,
+    {0x0b000123, 0x10ffff00} /* data */, 987654 /* calibTtag */
+};
+
+/** Array of test data for UBX-ESF-MEAS.
+ */
+static const uGnssDecTestDataKnown_t gUbxEsfMeas[] = {
+    {
+        {
+            "\xb5\x62\x10\x02\x14\x00\x40\xe2\x01\x00\x08\x10\x00\x00\x23\x01"
+            "\x00\x0b\x00\xff\xff\x10\x06\x12\x0f\x00\xc5\x6f", 28
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x1002, NULL
+        },
+        (void *) &gUbxEsfMeasDecoded0
+    }
+};
+
+/** Decoded test data for UBX-ESF-INS, to be used by gUbxEsfIns (item 0).
+ */
+static const uGnssDecUbxEsfIns_t gUbxEsfInsDecoded0 = {
+    0x00003f01 /* bitfield0 */, 477230000 /* iTOW */, -1234 /* xAngRate */,
+    567 /* yAngRate */, 89012 /* zAngRate */, -12 /* xAccel */,
+    34 /* yAccel */, 981 /* zAccel */
+};
+
+/** Array of test data for UBX-ESF-INS.
+ */
+static const uGnssDecTestDataKnown_t gUbxEsfIns[] = {
+    {
+        {
+            "\xb5\x62\x10\x15\x24\x00\x01\x3f\x00\x00\x00\x00\x00\x00\xb0\xf3"
+            "\x71\x1c\x2e\xfb\xff\xff\x37\x02\x00\x00\xb4\x5b\x01\x00\xf4\xff"
+            "\xff\xff\x22\x00\x00\x00\xd5\x03\x00\x00\x14\x69", 44
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x1015, NULL
+        },
+        (void *) &gUbxEsfInsDecoded0
+    }
+};
+
+/** Decoded test data for UBX-TIM-TP, to be used by gUbxTimTp (item 0).
+ */
+static const uGnssDecUbxTimTp_t gUbxTimTpDecoded0 = {
+    477231000 /* towMS */, 0x80000000 /* towSubMS */, -1234 /* qErr */,
+    2278 /* week */, 0x0b /* flags */, 0x30 /* refInfo */
+};
+
+/** Array of test data for UBX-TIM-TP.
+ */
+static const uGnssDecTestDataKnown_t gUbxTimTp[] = {
+    {
+        {
+            "\xb5\x62\x0d\x01\x10\x00\x98\xf7\x71\x1c\x00\x00\x00\x80\x2e\xfb"
+            "\xff\xff\xe6\x08\x0b\x30\x0a\x82", 24
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0d01, NULL
+        },
+        (void *) &gUbxTimTpDecoded0
+    }
+};
+
+/** Decoded test data for UBX-MON-RF, to be used by gUbxMonRf (item 0):
+ * a message with a repeated block.
+ */
+static const uGnssDecUbxMonRf_t gUbxMonRfDecoded0 = {
+    0 /* version */, 2 /* nBlocks */,
+    {
+        {
+            0 /* blockId */, 1 /* flags */, 2 /* antStatus */, 1 /* antPower */,
+            0 /* postStatus */, 87 /* noisePerMS */, 5632 /* agcCnt */,
+            12 /* jamInd */, -3 /* ofsI */, 150 /* magI */, 4 /* ofsQ */,
+            148 /* magQ */
+        },
+        {
+            1 /* blockId */, 1 /* flags */, 2 /* antStatus */, 1 /* antPower */,
+            0x12345678 /* postStatus */, 75 /* noisePerMS */, 6000 /* agcCnt */,
+            5 /* jamInd */, 2 /* ofsI */, 140 /* magI */, -5 /* ofsQ */,
+            145 /* magQ */
+        }
+    }
+};
+
+/** Array of test data for UBX-MON-RF.
+ */
+static const uGnssDecTestDataKnown_t gUbxMonRf[] = {
+    {
+        {
+            "\xb5\x62\x0a\x38\x34\x00\x00\x02\x00\x00\x00\x01\x02\x01\x00\x00"
+            "\x00\x00\x00\x00\x00\x00\x57\x00\x00\x16\x0c\xfd\x96\x04\x94\x00"
+            "\x00\x00\x01\x01\x02\x01\x78\x56\x34\x12\x00\x00\x00\x00\x4b\x00"
+            "\x70\x17\x05\x02\x8c\xfb\x91\x00\x00\x00\x2a\x23", 60
+        },
+        {
+            U_GNSS_PROTOCOL_UBX, 0x0a38, NULL
+        },
+        (void *) &gUbxMonRfDecoded0
+    }
+};
+
+/** Decoded test data for NMEA GGA, to be used by gNmeaGga (item 0).
+ */
+static const uGnssDecNmeaGga_t gNmeaGgaDecoded0 = {
+    0x1ffe /* present */, 9 /* hour */, 27 /* min */, 50 /* sec */,
+    0 /* millisecond */, 533613367 /* lat */, -65056200 /* lon */,
+    1 /* quality */, 8 /* numSV */, 103 /* HDOP */, 61700 /* alt */,
+    55200 /* sep */, 0 /* diffAge */, 0 /* diffStation */
+};
+
+/** Array of test data for NMEA GGA.
+ */
+static const uGnssDecTestDataKnown_t gNmeaGga[] = {
+    {
+        {
+            "$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,*76", 70
+        },
+        {
+            U_GNSS_PROTOCOL_NMEA, 0, "GPGGA"
+        },
+        (void *) &gNmeaGgaDecoded0
+    }
+};
+
+/** Decoded test data for NMEA RMC, to be used by gNmeaRmc (item 0).
+ */
+static const uGnssDecNmeaRmc_t gNmeaRmcDecoded0 = {
+    0x33fe /* present */, 8 /* hour */, 35 /* min */, 59 /* sec */,
+    0 /* millisecond */, 'A' /* status */, 472852395 /* lat */,
+    85652537 /* lon */, 4 /* spd */, 77520 /* cog */, 9 /* day */,
+    12 /* month */, 2002 /* year */, 0 /* mv */, 'A' /* posMode */,
+    'V' /* navStatus */
+};
+
+/** Array of test data for NMEA RMC.
+ */
+static const uGnssDecTestDataKnown_t gNmeaRmc[] = {
+    {
+        {
+            "$GNRMC,083559.00,A,4717.11437,N,00833.91522,E,0.004,77.52,091202,,,A,V*33", 73
+        },
+        {
+            U_GNSS_PROTOCOL_NMEA, 0, "GNRMC"
+        },
+        (void *) &gNmeaRmcDecoded0
+    }
+};
+
+/** Decoded test data for NMEA GSA, to be used by gNmeaGsa (item 0).
+ */
+static const uGnssDecNmeaGsa_t gNmeaGsaDecoded0 = {
+    0x387fe /* present */, 'A' /* opMode */, 3 /* navMode */,
+    {10, 7, 5, 2, 29, 4, 8, 13, 0, 0, 0, 0} /* svid */,
+    172 /* PDOP */, 103 /* HDOP */, 138 /* VDOP */, 0 /* systemId */
+};
+
+/** Array of test data for NMEA GSA.
+ */
+static const uGnssDecTestDataKnown_t gNmeaGsa[] = {
+    {
+        {
+            "$GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A", 56
+        },
+        {
+            U_GNSS_PROTOCOL_NMEA, 0, "GPGSA"
+        },
+        (void *) &gNmeaGsaDecoded0
+    }
+};
+
+/** Decoded test data for NMEA GSV, to be used by gNmeaGsv (item 0).
+ */
+static const uGnssDecNmeaGsv_t gNmeaGsvDecoded0 = {
+    0xffffe /* present */, 3 /* numMsg */, 1 /* msgNum */, 10 /* numSV */,
+    {
+        {23 /* svid */, 38 /* elv */, 230 /* az */, 44 /* cno */},
+        {29 /* svid */, 71 /* elv */, 156 /* az */, 47 /* cno */},
+        {7 /* svid */, 29 /* elv */, 116 /* az */, 41 /* cno */},
+        {8 /* svid */, 9 /* elv */, 81 /* az */, 36 /* cno */}
+    }
+};
+
+/** Array of test data for NMEA GSV.
+ */
+static const uGnssDecTestDataKnown_t gNmeaGsv[] = {
+    {
+        {
+            "$GPGSV,3,1,10,23,38,230,44,29,71,156,47,07,29,116,41,08,09,081,36*7F", 68
+        },
+        {
+            U_GNSS_PROTOCOL_NMEA, 0, "GPGSV"
+        },
+        (void *) &gNmeaGsvDecoded0
+    }
+};
+
+/** Decoded test data for NMEA VTG, to be used by gNmeaVtg (item 0).
+ */
+static const uGnssDecNmeaVtg_t gNmeaVtgDecoded0 = {
+    0x3fe /* present */, 77520 /* cogt */, 75310 /* cogm */, 4 /* sogn */,
+    8 /* sogk */, 'D' /* posMode */
+};
+
+/** Decoded test data for NMEA VTG, to be used by gNmeaVtg (item 1):
+ * the magnetic course is empty, so field 3 must be absent from
+ * present and cogm must be zero.
+ */
+static const uGnssDecNmeaVtg_t gNmeaVtgDecoded1 = {
+    0x3f6 /* present */, 77520 /* cogt */, 0 /* cogm */, 4 /* sogn */,
+    8 /* sogk */, 'A' /* posMode */
+};
+
+/** Array of test data for NMEA VTG.
+ */
+static const uGnssDecTestDataKnown_t gNmeaVtg[] = {
+    {
+        {
+            "$GNVTG,77.52,T,75.31,M,0.004,N,0.008,K,D*33", 43
+        },
+        {
+            U_GNSS_PROTOCOL_NMEA, 0, "GNVTG"
+        },
+        (void *) &gNmeaVtgDecoded0
+    },
+    {
+        {
+            "$GPVTG,77.52,T,,M,0.004,N,0.008,K,A*06", 38
+        },
+        {
+            U_GNSS_PROTOCOL_NMEA, 0, "GPVTG"
+        },
+        (void *) &gNmeaVtgDecoded1
+    }
+};
+
+/** Decoded test data for NMEA GST, to be used by gNmeaGst (item 0).
+ */
+static const uGnssDecNmeaGst_t gNmeaGstDecoded0 = {
+    0x1fe /* present */, 8 /* hour */, 23 /* min */, 56 /* sec */,
+    500 /* millisecond */, 1800 /* rangeRms */, 2500 /* stdMajor */,
+    1200 /* stdMinor */, 45300 /* orient */, 1700 /* stdLat */,
+    1300 /* stdLong */, 2200 /* stdAlt */
+};
+
+/** Decoded test data for NMEA GST, to be used by gNmeaGst (item 1):
+ * the error ellipse fields are empty, so fields 3 to 5 must be
+ * absent from present and their members must be zero.
+ */
+static const uGnssDecNmeaGst_t gNmeaGstDecoded1 = {
+    0x1c6 /* present */, 8 /* hour */, 23 /* min */, 56 /* sec */,
+    0 /* millisecond */, 1800 /* rangeRms */, 0 /* stdMajor */,
+    0 /* stdMinor */, 0 /* orient */, 1700 /* stdLat */,
+    1300 /* stdLong */, 2200 /* stdAlt */
+};
+
+/** Decoded test data for NMEA GST, to be used by gNmeaGst (item 2):
+ * field 3 has more digits than will fit into an int64_t and field 4
+ * overflows once its decimal places are added; both must be treated
+ * as empty.
+ */
+static const uGnssDecNmeaGst_t gNmeaGstDecoded2 = {
+    0x1e6 /* present */, 8 /* hour */, 23 /* min */, 56 /* sec */,
+    0 /* millisecond */, 1800 /* rangeRms */, 0 /* stdMajor */,
+    0 /* stdMinor */, 45300 /* orient */, 1700 /* stdLat */,
+    1300 /* stdLong */, 2200 /* stdAlt */
+};
+
+/** Array of test data for NMEA GST.
+ */
+static const uGnssDecTestDataKnown_t gNmeaGst[] = {
+    {
+        {
+            "$GNGST,082356.50,1.8,2.5,1.2,45.3,1.7,1.3,2.2*7D", 48
+        },
+        {
+            U_GNSS_PROTOCOL_NMEA, 0, "GNGST"
+        },
+        (void *) &gNmeaGstDecoded0
+    },
+    {
+        {
+            "$GPGST,082356.00,1.8,,,,1.7,1.3,2.2*7E", 38
+        },
+        {
+            U_GNSS_PROTOCOL_NMEA, 0, "GPGST"
+        },
+        (void *) &gNmeaGstDecoded1
+    },
+    {
+        {
+            "$GPGST,082356.00,1.8,123456789012345678901,9999999999999999,45.3,1.7,1.3,2.2*53", 79
+        },
+        {
+            U_GNSS_PROTOCOL_NMEA, 0, "GPGST"
+        },
+        (void *) &gNmeaGstDecoded2
+    }
+};
+
+/** Decoded test data for NMEA ZDA, to be used by gNmeaZda (item 0).
+ */
+static const uGnssDecNmeaZda_t gNmeaZdaDecoded0 = {
+    0x7e /* present */, 8 /* hour */, 27 /* min */, 10 /* sec */,
+    0 /* millisecond */, 16 /* day */, 9 /* month */, 2002 /* year */,
+    0 /* ltzh */, 0 /* ltzn */
+};
+
+/** Array of test data for NMEA ZDA.
+ */
+static const uGnssDecTestDataKnown_t gNmeaZda[] = {
+    {
+        {
+            "$GNZDA,082710.00,16,09,2002,00,00*7A", 36
+        },
+        {
+            U_GNSS_PROTOCOL_NMEA, 0, "GNZDA"
+        },
+        (void *) &gNmeaZdaDecoded0
+    }
+};
+
 /** Array of arrays of test vectors for all known message types.
  */
 static const uGnssDecTestDataKnownSet_t gTestDataKnownSet[] = {
     {gUbxNavPvt, sizeof(gUbxNavPvt) / sizeof(gUbxNavPvt[0]), sizeof(gUbxNavPvtDecoded0)},
-    {gUbxNavHpposllh, sizeof(gUbxNavHpposllh) / sizeof(gUbxNavHpposllh[0]), sizeof(gUbxNavHpposllhDecoded0)}
+    {gUbxNavHpposllh, sizeof(gUbxNavHpposllh) / sizeof(gUbxNavHpposllh[0]), sizeof(gUbxNavHpposllhDecoded0)},
+    {gUbxNavStatus, sizeof(gUbxNavStatus) / sizeof(gUbxNavStatus[0]), sizeof(gUbxNavStatusDecoded0)},
+    {gUbxNavDop, sizeof(gUbxNavDop) / sizeof(gUbxNavDop[0]), sizeof(gUbxNavDopDecoded0)},
+    {gUbxNavCov, sizeof(gUbxNavCov) / sizeof(gUbxNavCov[0]), sizeof(gUbxNavCovDecoded0)},
+    {gUbxNavSat, sizeof(gUbxNavSat) / sizeof(gUbxNavSat[0]), sizeof(gUbxNavSatDecoded0)},
+    {gUbxNavSig, sizeof(gUbxNavSig) / sizeof(gUbxNavSig[0]), sizeof(gUbxNavSigDecoded0)},
+    {gUbxRxmRawx, sizeof(gUbxRxmRawx) / sizeof(gUbxRxmRawx[0]), sizeof(gUbxRxmRawxDecoded0)},
+    {gUbxRxmSfrbx, sizeof(gUbxRxmSfrbx) / sizeof(gUbxRxmSfrbx[0]), sizeof(gUbxRxmSfrbxDecoded0)},
+    {gUbxEsfMeas, sizeof(gUbxEsfMeas) / sizeof(gUbxEsfMeas[0]), sizeof(gUbxEsfMeasDecoded0)},
+    {gUbxEsfIns, sizeof(gUbxEsfIns) / sizeof(gUbxEsfIns[0]), sizeof(gUbxEsfInsDecoded0)},
+    {gUbxTimTp, sizeof(gUbxTimTp) / sizeof(gUbxTimTp[0]), sizeof(gUbxTimTpDecoded0)},
+    {gUbxMonRf, sizeof(gUbxMonRf) / sizeof(gUbxMonRf[0]), sizeof(gUbxMonRfDecoded0)},
+    {gNmeaGga, sizeof(gNmeaGga) / sizeof(gNmeaGga[0]), sizeof(gNmeaGgaDecoded0)},
+    {gNmeaRmc, sizeof(gNmeaRmc) / sizeof(gNmeaRmc[0]), sizeof(gNmeaRmcDecoded0)},
+    {gNmeaGsa, sizeof(gNmeaGsa) / sizeof(gNmeaGsa[0]), sizeof(gNmeaGsaDecoded0)},
+    {gNmeaGsv, sizeof(gNmeaGsv) / sizeof(gNmeaGsv[0]), sizeof(gNmeaGsvDecoded0)},
+    {gNmeaVtg, sizeof(gNmeaVtg) / sizeof(gNmeaVtg[0]), sizeof(gNmeaVtgDecoded0)},
+    {gNmeaGst, sizeof(gNmeaGst) / sizeof(gNmeaGst[0]), sizeof(gNmeaGstDecoded0)},
+    {gNmeaZda, sizeof(gNmeaZda) / sizeof(gNmeaZda[0]), sizeof(gNmeaZdaDecoded0)}
 };
 
+/** Somewhere to decode into for uGnssDecIntoBuffer(), kept off
+ * the stack since it is large.
+ */
+static uGnssDec_t gDec;
+
+/** Storage for the body of a message decoded by uGnssDecIntoBuffer().
+ */
+static uGnssDecUnion_t gDecUnion;
+
 /** Flag to share with the user callback.
  */
 static int32_t gCallback;
@@ -274,19 +834,19 @@ static const uGnssDecTestDataCallback_t gTestDataCallback[] = {
     // NMEA
     {
         {
-            "$GPGGA,092750.000,5321.6802,N,00630.3372,W,1,8,1.03,61.7,M,55.2,M,,*76", 69
+            "$GPGLL,5321.6802,N,00630.3372,W,092750.000,A,A*4B", 49
         },
         {
-            U_GNSS_PROTOCOL_NMEA, 0, "GPGGA"
+            U_GNSS_PROTOCOL_NMEA, 0, "GPGLL"
         },
         2
     },
     {
         {
-            "$GPGSA,A,3,10,07,05,02,29,04,08,13,,,,,1.72,1.03,1.38*0A", 55
+            "$GPTXT,01,01,02,ANTSTATUS=OK*3B", 31
         },
         {
-            U_GNSS_PROTOCOL_NMEA, 0, "GPGSA"
+            U_GNSS_PROTOCOL_NMEA, 0, "GPTXT"
         },
         3
     },
@@ -634,6 +1194,7 @@ U_PORT_TEST_FUNCTION("[gnssDec]", "gnssDecKnown")
     uGnssDec_t *pDec;
     const uGnssDecTestDataKnown_t *pTestData = NULL;
     size_t decodedStructureSize;
+    int32_t errorCode;
     char prefix[64]; // Just for printing
 
     // Get the initial resource count
@@ -697,6 +1258,24 @@ U_PORT_TEST_FUNCTION("[gnssDec]", "gnssDecKnown")
             }
             // Free the structure once more
             uGnssDecFree(pDec);
+            // Now do the same without the heap, first with too
+            // little room for the message body
+            memset(&gDecUnion, 0xFF, sizeof(gDecUnion));
+            U_PORT_TEST_ASSERT(uGnssDecIntoBuffer(pTestData->raw.p,
+                                                  pTestData->raw.length - gCrcLength[pTestData->id.type],
+                                                  &gDec, &gDecUnion,
+                                                  decodedStructureSize - 1) == (int32_t) U_ERROR_COMMON_NO_MEMORY);
+            U_PORT_TEST_ASSERT(gDec.errorCode == (int32_t) U_ERROR_COMMON_NO_MEMORY);
+            U_PORT_TEST_ASSERT(gDec.pBody == NULL);
+            errorCode = uGnssDecIntoBuffer(pTestData->raw.p,
+                                           pTestData->raw.length - gCrcLength[pTestData->id.type],
+                                           &gDec, &gDecUnion, sizeof(gDecUnion));
+            U_TEST_PRINT_LINE_X_Y("uGnssDecIntoBuffer() returned %d.",  x, y, errorCode);
+            U_PORT_TEST_ASSERT(errorCode == 0);
+            U_PORT_TEST_ASSERT(gDec.errorCode == 0);
+            U_PORT_TEST_ASSERT(gDec.pBody == &gDecUnion);
+            U_PORT_TEST_ASSERT(gDec.id.type == pTestData->id.type);
+            U_PORT_TEST_ASSERT(memcmp(gDec.pBody, pTestData->pDecoded, decodedStructureSize) == 0);
         }
     }
 
@@ -130,6 +130,7 @@ U_PORT_TEST_FUNCTION("[gnssInfo]", "gnssInfoStatic")
     size_t z;
     char *pTmp;
     size_t iterations;
+    uGnssSpiStats_t spiStats;
     uGnssTransportType_t transportTypes[U_GNSS_TRANSPORT_MAX_NUM];
 
     // In case a previous test failed
@@ -232,6 +233,22 @@ U_PORT_TEST_FUNCTION("[gnssInfo]", "gnssInfoStatic")
         // Free memory
         uPortFree(pBuffer);
 
+        // The SPI stats are only available on SPI
+        y = uGnssInfoGetSpiStats(gnssHandle, &spiStats);
+        if (transportTypes[w] == U_GNSS_TRANSPORT_SPI) {
+            U_PORT_TEST_ASSERT(y == 0);
+            U_TEST_PRINT_LINE("SPI: %d transfer(s), %d useful byte(s) (%d per transfer),"
+                              " %d fill byte(s) discarded, read length now %d.",
+                              spiStats.transfers, spiStats.usefulBytes,
+                              spiStats.usefulBytesPerTransfer,
+                              spiStats.fillBytesDiscarded, spiStats.readLength);
+            U_PORT_TEST_ASSERT(spiStats.transfers > 0);
+            U_PORT_TEST_ASSERT(spiStats.usefulBytes > 0);
+            U_PORT_TEST_ASSERT(spiStats.readLength <= U_GNSS_SPI_READ_LENGTH_MAX_BYTES);
+        } else {
+            U_PORT_TEST_ASSERT(y == (int32_t) U_ERROR_COMMON_NOT_SUPPORTED);
+        }
+
         // Check that we haven't dropped any incoming data
         y = uGnssMsgReceiveStatStreamLoss(gnssHandle);
         U_TEST_PRINT_LINE("%d byte(s) lost at the input to the ring-buffer during that test.", y);
@@ -56,14 +56,18 @@
 #include "u_port_os.h"
 #include "u_port_heap.h"
 #include "u_port_debug.h"
+#include "u_port_event_queue.h" // U_PORT_EVENT_QUEUE_MIN_TASK_STACK_SIZE_BYTES
 
 #include "u_test_util_resource_check.h"
 
 #include "u_ringbuffer.h"
 
+#include "u_device_serial.h"
+
 #include "u_gnss_module_type.h"
 #include "u_gnss_type.h"
 #include "u_gnss.h"
+#include "u_gnss_msg.h" // U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES
 #include "u_gnss_private.h"
 
 /* ----------------------------------------------------------------
@@ -110,6 +114,44 @@
 # define U_GNSS_PRIVATE_TEST_RINGBUFFER_SIZE 2048
 #endif
 
+#ifndef U_GNSS_PRIVATE_TEST_EVENT_NUM
+/** The number of messages to send through gEventSerial when
+ * measuring how quickly the message receive task is woken up.
+ */
+# define U_GNSS_PRIVATE_TEST_EVENT_NUM 10
+#endif
+
+#ifndef U_GNSS_PRIVATE_TEST_EVENT_GAP_MS
+/** The gap to leave before sending each message through gEventSerial,
+ * long enough for the message receive task to have gone back to
+ * waiting; were it polling, it would then take around the polling
+ * period less this gap to find the message.
+ */
+# define U_GNSS_PRIVATE_TEST_EVENT_GAP_MS 20
+#endif
+
+#ifndef U_GNSS_PRIVATE_TEST_EVENT_LATENCY_MAX_MS
+/** The maximum average time, from the "data received" event of
+ * gEventSerial to the message arriving at a reader, that shows
+ * the message receive task is being woken up by the event.
+ */
+# define U_GNSS_PRIVATE_TEST_EVENT_LATENCY_MAX_MS 25
+#endif
+
+#ifndef U_GNSS_PRIVATE_TEST_EVENT_TIMEOUT_MS
+/** How long to wait for a message sent through gEventSerial to
+ * arrive at a reader.
+ */
+# define U_GNSS_PRIVATE_TEST_EVENT_TIMEOUT_MS 1000
+#endif
+
+#ifndef U_GNSS_PRIVATE_TEST_INDEX_LOG_LENGTH
+/** The maximum number of reader callbacks to log per message
+ * when testing the reader index of the message receive task.
+ */
+# define U_GNSS_PRIVATE_TEST_INDEX_LOG_LENGTH 16
+#endif
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -139,6 +181,15 @@ typedef struct {
     uint16_t id;
 } uGnssPrivateTestRtcmMatch_t;
 
+/** Struct to hold the message ID wanted by a reader when testing
+ * the reader index of the message receive task.
+ */
+typedef struct {
+    uGnssProtocol_t type;
+    const char *pNmea;
+    uint16_t ubx;
+} uGnssPrivateTestReader_t;
+
 /* ----------------------------------------------------------------
  * VARIABLES
  * -------------------------------------------------------------- */
@@ -161,6 +212,107 @@ static char *gpBody = NULL;
 
 # ifndef __ZEPHYR__
 
+/** The number of bytes that testSerialRead() has returned so far.
+ */
+static size_t gTestSerialReadBytes = 0;
+
+/** The number of bytes that testSerialGetReceiveSize() should say
+ * are waiting.
+ */
+static size_t gTestSerialWaitingBytes = 0;
+
+/** A serial device, of which only the receive size and read
+ * functions are populated, used when testing
+ * uGnssPrivateStreamFillRingBuffer().
+ */
+static uDeviceSerial_t gTestSerial = {0};
+
+/** A serial device with a "data received" event, used when testing
+ * the asynchronous message receive task through a GNSS instance.
+ */
+static uDeviceSerial_t gEventSerial = {0};
+
+/** Mutex to protect the data that gEventSerial has to give.
+ */
+static uPortMutexHandle_t gEventSerialMutex = NULL;
+
+/** The data that gEventSerial has to give.
+ */
+static char gEventSerialData[U_GNSS_PRIVATE_TEST_NMEA_SENTENCE_MAX_LENGTH_BYTES];
+
+/** The amount of data in gEventSerialData.
+ */
+static size_t gEventSerialDataSize = 0;
+
+/** The amount of gEventSerialData that has been read.
+ */
+static size_t gEventSerialDataRead = 0;
+
+/** The filter of the event callback set on gEventSerial, zero
+ * if there is none.
+ */
+static uint32_t gEventSerialFilter = 0;
+
+/** The event callback set on gEventSerial.
+ */
+static void (*gpEventSerialCallback)(struct uDeviceSerial_t *, uint32_t, void *) = NULL;
+
+/** The parameter to pass to gpEventSerialCallback.
+ */
+static void *gpEventSerialCallbackParam = NULL;
+
+/** The number of messages that have arrived at a reader
+ * of gEventSerial.
+ */
+static volatile int32_t gEventMessageCount = 0;
+
+/** The time at which the last message arrived at a reader
+ * of gEventSerial.
+ */
+static volatile int32_t gEventMessageTimeMs = 0;
+
+/** The readers to start when testing the reader index of the
+ * message receive task: between them they cover the specific
+ * message IDs, which are indexed, including two that share a
+ * bucket because the index ignores the second character of an
+ * NMEA talker, and the wildcards, which are not.
+ */
+static const uGnssPrivateTestReader_t gIndexReader[] = {
+    {U_GNSS_PROTOCOL_NMEA, "GPGGA", 0},  // 0: indexed
+    {U_GNSS_PROTOCOL_NMEA, "G?GGA", 0},  // 1: indexed, in the bucket of "GPGGA"
+    {U_GNSS_PROTOCOL_NMEA, "GPRMC", 0},  // 2: indexed
+    {U_GNSS_PROTOCOL_NMEA, "?PGGA", 0},  // 3: wildcard
+    {U_GNSS_PROTOCOL_NMEA, "GP", 0},     // 4: wildcard
+    {U_GNSS_PROTOCOL_UBX, NULL, 0x0107}, // 5: indexed, UBX-NAV-PVT
+    {U_GNSS_PROTOCOL_NMEA, "GNGGA", 0},  // 6: indexed, in the bucket of "GPGGA"
+    {U_GNSS_PROTOCOL_ALL, NULL, 0}       // 7: wildcard
+};
+
+/** The readers of gIndexReader, in the order they should be called,
+ * newest first, for a "GPGGA" message.
+ */
+static const int32_t gIndexExpectedGga[] = {7, 4, 3, 1, 0};
+
+/** The readers of gIndexReader, in the order they should be called,
+ * newest first, for a "GPRMC" message.
+ */
+static const int32_t gIndexExpectedRmc[] = {7, 4, 2};
+
+/** The readers of gIndexReader, in the order they should be called,
+ * newest first, for a "GPGGA" message once readers 1 and 3 have
+ * been stopped.
+ */
+static const int32_t gIndexExpectedGgaAfterStop[] = {7, 4, 0};
+
+/** The log of reader callbacks: each entry is the index in
+ * gIndexReader of the reader that was called.
+ */
+static volatile int32_t gIndexLog[U_GNSS_PRIVATE_TEST_INDEX_LOG_LENGTH];
+
+/** The number of entries in gIndexLog.
+ */
+static volatile size_t gIndexLogCount = 0;
+
 /** Some sample NMEA message strings, taken from
  * https://en.wikipedia.org/wiki/NMEA_0183.
  */
@@ -318,6 +470,247 @@ static void fillBufferRand(char *pBuffer, size_t size)
     }
 }
 
+// Return the byte that should appear at the given offset in the
+// stream received from gTestSerial.
+static char testSerialByte(size_t offset)
+{
+    return (char) (offset % 251);
+}
+
+// Receive size function for gTestSerial.
+static int32_t testSerialGetReceiveSize(struct uDeviceSerial_t *pDeviceSerial)
+{
+    (void) pDeviceSerial;
+    return (int32_t) gTestSerialWaitingBytes;
+}
+
+// Read function for gTestSerial.
+static int32_t testSerialRead(struct uDeviceSerial_t *pDeviceSerial,
+                              void *pBuffer, size_t sizeBytes)
+{
+    (void) pDeviceSerial;
+    if (sizeBytes > gTestSerialWaitingBytes) {
+        sizeBytes = gTestSerialWaitingBytes;
+    }
+    for (size_t x = 0; x < sizeBytes; x++) {
+        *(((char *) pBuffer) + x) = testSerialByte(gTestSerialReadBytes);
+        gTestSerialReadBytes++;
+    }
+    gTestSerialWaitingBytes -= sizeBytes;
+
+    return (int32_t) sizeBytes;
+}
+
+// Receive size function for gEventSerial.
+static int32_t eventSerialGetReceiveSize(struct uDeviceSerial_t *pDeviceSerial)
+{
+    int32_t receiveSize;
+
+    (void) pDeviceSerial;
+
+    U_PORT_MUTEX_LOCK(gEventSerialMutex);
+    receiveSize = (int32_t) (gEventSerialDataSize - gEventSerialDataRead);
+    U_PORT_MUTEX_UNLOCK(gEventSerialMutex);
+
+    return receiveSize;
+}
+
+// Read function for gEventSerial.
+static int32_t eventSerialRead(struct uDeviceSerial_t *pDeviceSerial,
+                               void *pBuffer, size_t sizeBytes)
+{
+    (void) pDeviceSerial;
+
+    U_PORT_MUTEX_LOCK(gEventSerialMutex);
+    if (sizeBytes > gEventSerialDataSize - gEventSerialDataRead) {
+        sizeBytes = gEventSerialDataSize - gEventSerialDataRead;
+    }
+    memcpy(pBuffer, gEventSerialData + gEventSerialDataRead, sizeBytes);
+    gEventSerialDataRead += sizeBytes;
+    U_PORT_MUTEX_UNLOCK(gEventSerialMutex);
+
+    return (int32_t) sizeBytes;
+}
+
+// Write function for gEventSerial: everything written is thrown away.
+static int32_t eventSerialWrite(struct uDeviceSerial_t *pDeviceSerial,
+                                const void *pBuffer, size_t sizeBytes)
+{
+    (void) pDeviceSerial;
+    (void) pBuffer;
+
+    return (int32_t) sizeBytes;
+}
+
+// Event callback set function for gEventSerial.
+static int32_t eventSerialEventCallbackSet(struct uDeviceSerial_t *pDeviceSerial,
+                                           uint32_t filter,
+                                           void (*pFunction)(struct uDeviceSerial_t *,
+                                                             uint32_t,
+                                                             void *),
+                                           void *pParam,
+                                           size_t stackSizeBytes,
+                                           int32_t priority)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    (void) pDeviceSerial;
+    (void) stackSizeBytes;
+    (void) priority;
+
+    if ((filter != 0) && (pFunction != NULL)) {
+        gpEventSerialCallback = pFunction;
+        gpEventSerialCallbackParam = pParam;
+        gEventSerialFilter = filter;
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+    }
+
+    return errorCode;
+}
+
+// Event callback remove function for gEventSerial.
+static void eventSerialEventCallbackRemove(struct uDeviceSerial_t *pDeviceSerial)
+{
+    (void) pDeviceSerial;
+
+    gEventSerialFilter = 0;
+    gpEventSerialCallback = NULL;
+    gpEventSerialCallbackParam = NULL;
+}
+
+// Event callback filter get function for gEventSerial.
+static uint32_t eventSerialEventCallbackFilterGet(struct uDeviceSerial_t *pDeviceSerial)
+{
+    (void) pDeviceSerial;
+
+    return gEventSerialFilter;
+}
+
+// Set up gEventSerial, with nothing to give and no event callback.
+static void eventSerialInit(void)
+{
+    memset(&gEventSerial, 0, sizeof(gEventSerial));
+    gEventSerial.getReceiveSize = eventSerialGetReceiveSize;
+    gEventSerial.read = eventSerialRead;
+    gEventSerial.write = eventSerialWrite;
+    gEventSerial.eventCallbackSet = eventSerialEventCallbackSet;
+    gEventSerial.eventCallbackRemove = eventSerialEventCallbackRemove;
+    gEventSerial.eventCallbackFilterGet = eventSerialEventCallbackFilterGet;
+    gEventSerialDataSize = 0;
+    gEventSerialDataRead = 0;
+    eventSerialEventCallbackRemove(&gEventSerial);
+}
+
+// Give the given data to anyone reading gEventSerial and then, as
+// the event task of a real serial device would, call the event
+// callback, if there is one.
+static void eventSerialSend(const char *pData, size_t size)
+{
+    U_PORT_MUTEX_LOCK(gEventSerialMutex);
+    memcpy(gEventSerialData, pData, size);
+    gEventSerialDataSize = size;
+    gEventSerialDataRead = 0;
+    U_PORT_MUTEX_UNLOCK(gEventSerialMutex);
+
+    if ((gpEventSerialCallback != NULL) &&
+        ((gEventSerialFilter & U_DEVICE_SERIAL_EVENT_BITMASK_DATA_RECEIVED) != 0)) {
+        gpEventSerialCallback(&gEventSerial, U_DEVICE_SERIAL_EVENT_BITMASK_DATA_RECEIVED,
+                              gpEventSerialCallbackParam);
+    }
+}
+
+// An event callback for gEventSerial belonging to the "application".
+static void appEventCallback(struct uDeviceSerial_t *pDeviceSerial,
+                             uint32_t eventBitMap, void *pParameters)
+{
+    (void) pDeviceSerial;
+    (void) eventBitMap;
+    (void) pParameters;
+}
+
+// Message receive callback for messages from gEventSerial: count
+// them and note the time of arrival.
+static void eventMessageCallback(uDeviceHandle_t gnssHandle,
+                                 const uGnssMessageId_t *pMessageId,
+                                 int32_t errorCodeOrLength,
+                                 void *pCallbackParam)
+{
+    (void) gnssHandle;
+    (void) pMessageId;
+    (void) errorCodeOrLength;
+    (void) pCallbackParam;
+
+    gEventMessageTimeMs = uPortGetTickTimeMs();
+    gEventMessageCount++;
+}
+
+// Send a message through gEventSerial and return how long it took to
+// arrive at eventMessageCallback(), or -1 if it did not.
+static int32_t eventMessageSend(const char *pMessage, size_t size)
+{
+    int32_t latencyMs = -1;
+    int32_t count = gEventMessageCount;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    eventSerialSend(pMessage, size);
+    while ((gEventMessageCount == count) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_GNSS_PRIVATE_TEST_EVENT_TIMEOUT_MS)) {
+        uPortTaskBlock(1);
+    }
+    if (gEventMessageCount == count + 1) {
+        latencyMs = gEventMessageTimeMs - startTimeMs;
+    }
+
+    return latencyMs;
+}
+
+// Message receive callback when testing the reader index: log the
+// index in gIndexReader of the reader, which is pCallbackParam.
+static void indexMessageCallback(uDeviceHandle_t gnssHandle,
+                                 const uGnssMessageId_t *pMessageId,
+                                 int32_t errorCodeOrLength,
+                                 void *pCallbackParam)
+{
+    (void) gnssHandle;
+    (void) pMessageId;
+    (void) errorCodeOrLength;
+
+    if (gIndexLogCount < sizeof(gIndexLog) / sizeof(gIndexLog[0])) {
+        gIndexLog[gIndexLogCount] = (int32_t) (intptr_t) pCallbackParam;
+    }
+    gIndexLogCount++;
+}
+
+// Send a message through gEventSerial and check that exactly the
+// expected readers are called for it, each once and in order.
+static bool indexMessageSendCheck(const char *pMessage, size_t size,
+                                  const int32_t *pExpected, size_t numExpected)
+{
+    bool isGood;
+    int32_t startTimeMs = uPortGetTickTimeMs();
+
+    gIndexLogCount = 0;
+    eventSerialSend(pMessage, size);
+    while ((gIndexLogCount < numExpected) &&
+           (uPortGetTickTimeMs() - startTimeMs < U_GNSS_PRIVATE_TEST_EVENT_TIMEOUT_MS)) {
+        uPortTaskBlock(1);
+    }
+    // Give any unexpected readers a chance to be called also
+    uPortTaskBlock(U_GNSS_PRIVATE_TEST_EVENT_GAP_MS);
+
+    isGood = (gIndexLogCount == numExpected);
+    for (size_t x = 0; x < gIndexLogCount; x++) {
+        if (x < sizeof(gIndexLog) / sizeof(gIndexLog[0])) {
+            U_TEST_PRINT_LINE("  %d: reader %d.", x + 1, gIndexLog[x]);
+            if ((x >= numExpected) || (gIndexLog[x] != *(pExpected + x))) {
+                isGood = false;
+            }
+        }
+    }
+
+    return isGood;
+}
+
 // Assemble an NMEA message from the components into pBuffer
 // (which must include room for at least U_GNSS_NMEA_SENTENCE_MAX_LENGTH_BYTES)
 // and return the size of the message; NO null termnator is included.
@@ -892,6 +1285,538 @@ U_PORT_TEST_FUNCTION("[gnss]", "gnssPrivateUbx")
     U_PORT_TEST_ASSERT(resourceCount <= 0);
 }
 
+/** Test that UBX, NMEA and RTCM messages which arrive in pieces
+ * are decoded correctly by the resumable parsers; not tested on
+ * Zephyr for the same reasons as the test gnssPrivateNmea.
+ */
+U_PORT_TEST_FUNCTION("[gnss]", "gnssPrivateChunked")
+{
+    int32_t readHandle;
+    uGnssPrivateMessageId_t msgId;
+    uGnssProtocol_t expectedType[3] = {U_GNSS_PROTOCOL_UBX,
+                                       U_GNSS_PROTOCOL_NMEA,
+                                       U_GNSS_PROTOCOL_RTCM
+                                      };
+    size_t expectedSize[3];
+    const uGnssPrivateTestNmea_t *pNmeaTest;
+    const uGnssPrivateTestRtcmMatch_t *pRtcmTest;
+    size_t bodySize;
+    size_t bufferSize;
+    size_t offset;
+    size_t chunkSize;
+    size_t numDecoded;
+    int32_t errorCodeOrSize;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Allocate memory to use for the ring buffer
+    gpLinearBuffer = (char *) pUPortMalloc(U_GNSS_PRIVATE_TEST_RINGBUFFER_SIZE);
+    U_PORT_TEST_ASSERT(gpLinearBuffer != NULL);
+
+    // Create a ring buffer from the linear buffer with a single read handle allowed
+    U_PORT_TEST_ASSERT(uRingBufferCreateWithReadHandle(&gRingBuffer, gpLinearBuffer,
+                                                       U_GNSS_PRIVATE_TEST_RINGBUFFER_SIZE,
+                                                       1) == 0);
+    uRingBufferSetReadRequiresHandle(&gRingBuffer, true);
+    readHandle = uRingBufferTakeReadHandle(&gRingBuffer);
+    U_PORT_TEST_ASSERT(readHandle >= 0);
+
+    // A buffer big enough for a UBX message of up to half the
+    // ring buffer, an NMEA message, the largest of the RTCM
+    // messages and rubbish in front of each
+    bufferSize = 0;
+    for (size_t x = 0; x < sizeof(gRtcmTestMessage) / sizeof(gRtcmTestMessage[0]); x++) {
+        if (gRtcmTestMessage[x].rtcmSize > bufferSize) {
+            bufferSize = gRtcmTestMessage[x].rtcmSize;
+        }
+    }
+    bufferSize += (U_GNSS_PRIVATE_TEST_RINGBUFFER_SIZE / 2) + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES +
+                  U_GNSS_PRIVATE_TEST_NMEA_SENTENCE_MAX_LENGTH_BYTES +
+                  (U_GNSS_PRIVATE_TEST_RUBBISH_ROOM_BYTES * 3);
+    gpBuffer = (char *) pUPortMalloc(bufferSize);
+    U_PORT_TEST_ASSERT(gpBuffer != NULL);
+    gpBody = (char *) pUPortMalloc(U_GNSS_PRIVATE_TEST_RINGBUFFER_SIZE / 2);
+    U_PORT_TEST_ASSERT(gpBody != NULL);
+
+    for (size_t x = 0; x < U_GNSS_PRIVATE_TEST_NUM_LOOPS / 10; x++) {
+        // Rubbish, a UBX message, rubbish, an NMEA message,
+        // rubbish and then an RTCM message
+        offset = rand() % U_GNSS_PRIVATE_TEST_RUBBISH_ROOM_BYTES;
+        fillBufferRand(gpBuffer, offset);
+        bodySize = rand() % (U_GNSS_PRIVATE_TEST_RINGBUFFER_SIZE / 2);
+        fillBufferRand(gpBody, bodySize);
+        expectedSize[0] = bodySize + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES;
+        U_PORT_TEST_ASSERT(uUbxProtocolEncode((uint8_t) rand(), (uint8_t) rand(),
+                                              (const char *) gpBody, bodySize,
+                                              gpBuffer + offset) == (int32_t) expectedSize[0]);
+        offset += expectedSize[0];
+        chunkSize = rand() % U_GNSS_PRIVATE_TEST_RUBBISH_ROOM_BYTES;
+        fillBufferRand(gpBuffer + offset, chunkSize);
+        offset += chunkSize;
+        pNmeaTest = &(gNmeaTestMessage[rand() % (sizeof(gNmeaTestMessage) /
+                                                  sizeof(gNmeaTestMessage[0]))]);
+        expectedSize[1] = makeNmeaMessage(gpBuffer + offset, pNmeaTest->pTalkerSentenceStr,
+                                          pNmeaTest->pBodyStr, pNmeaTest->pChecksumHexStr);
+        offset += expectedSize[1];
+        chunkSize = rand() % U_GNSS_PRIVATE_TEST_RUBBISH_ROOM_BYTES;
+        fillBufferRand(gpBuffer + offset, chunkSize);
+        offset += chunkSize;
+        pRtcmTest = &(gRtcmTestMessage[rand() % (sizeof(gRtcmTestMessage) /
+                                                  sizeof(gRtcmTestMessage[0]))]);
+        expectedSize[2] = pRtcmTest->rtcmSize;
+        memcpy(gpBuffer + offset, pRtcmTest->pRtcm, pRtcmTest->rtcmSize);
+        offset += pRtcmTest->rtcmSize;
+        U_PORT_TEST_ASSERT(offset <= bufferSize);
+
+        // Feed it into the ring buffer a random number of bytes at
+        // a time, decoding whatever we can after each piece
+        numDecoded = 0;
+        for (size_t y = 0; y < offset; y += chunkSize) {
+            chunkSize = 1 + (rand() % 32);
+            if (chunkSize > offset - y) {
+                chunkSize = offset - y;
+            }
+            U_PORT_TEST_ASSERT(uRingBufferAdd(&gRingBuffer, gpBuffer + y, chunkSize));
+            do {
+                memset(&msgId, 0, sizeof(msgId));
+                msgId.type = U_GNSS_PROTOCOL_ALL;
+                errorCodeOrSize = uGnssPrivateStreamDecodeRingBuffer(&gRingBuffer,
+                                                                     readHandle, &msgId);
+                if (errorCodeOrSize > 0) {
+                    if (msgId.type != U_GNSS_PROTOCOL_UNKNOWN) {
+                        U_PORT_TEST_ASSERT(numDecoded < sizeof(expectedSize) / sizeof(expectedSize[0]));
+                        U_PORT_TEST_ASSERT(msgId.type == expectedType[numDecoded]);
+                        U_PORT_TEST_ASSERT(errorCodeOrSize == (int32_t) expectedSize[numDecoded]);
+                        if (msgId.type == U_GNSS_PROTOCOL_NMEA) {
+                            U_PORT_TEST_ASSERT(strcmp(msgId.id.nmea, pNmeaTest->pTalkerSentenceStr) == 0);
+                        } else if (msgId.type == U_GNSS_PROTOCOL_RTCM) {
+                            U_PORT_TEST_ASSERT(msgId.id.rtcm == pRtcmTest->id);
+                        }
+                        numDecoded++;
+                    }
+                    uRingBufferReadHandle(&gRingBuffer, readHandle, NULL, errorCodeOrSize);
+                }
+            } while (errorCodeOrSize > 0);
+        }
+        U_PORT_TEST_ASSERT(numDecoded == sizeof(expectedSize) / sizeof(expectedSize[0]));
+        U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&gRingBuffer, readHandle) == 0);
+
+        if ((x % 10) == 0) {
+            // Give any task watchdog a bone
+            uPortTaskBlock(U_CFG_OS_YIELD_MS);
+        }
+    }
+
+    // Free memory
+    uPortFree(gpBody);
+    gpBody = NULL;
+    uPortFree(gpBuffer);
+    gpBuffer = NULL;
+    uRingBufferDelete(&gRingBuffer);
+    uPortFree(gpLinearBuffer);
+    gpLinearBuffer = NULL;
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test that uGnssPrivateStreamFillRingBuffer() gets data into the
+ * ring buffer intact, including when the space it reads into wraps
+ * around the end of the ring buffer.
+ */
+U_PORT_TEST_FUNCTION("[gnss]", "gnssPrivateFill")
+{
+    uGnssPrivateInstance_t *pInstance;
+    int32_t readHandle;
+    size_t expectedBytes = 0;
+    size_t wantedBytes;
+    size_t waitingBytes;
+    int32_t errorCodeOrSize;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Just enough of a GNSS instance for a virtual serial
+    // streaming transport
+    gTestSerialReadBytes = 0;
+    gTestSerialWaitingBytes = 0;
+    gTestSerial.getReceiveSize = testSerialGetReceiveSize;
+    gTestSerial.read = testSerialRead;
+    pInstance = (uGnssPrivateInstance_t *) pUPortMalloc(sizeof(uGnssPrivateInstance_t));
+    U_PORT_TEST_ASSERT(pInstance != NULL);
+    memset(pInstance, 0, sizeof(*pInstance));
+    pInstance->transportType = U_GNSS_TRANSPORT_VIRTUAL_SERIAL;
+    pInstance->transportHandle.pDeviceSerial = &gTestSerial;
+    gpLinearBuffer = (char *) pUPortMalloc(U_GNSS_PRIVATE_TEST_RINGBUFFER_SIZE);
+    U_PORT_TEST_ASSERT(gpLinearBuffer != NULL);
+    U_PORT_TEST_ASSERT(uRingBufferCreateWithReadHandle(&(pInstance->ringBuffer), gpLinearBuffer,
+                                                       U_GNSS_PRIVATE_TEST_RINGBUFFER_SIZE,
+                                                       1) == 0);
+    uRingBufferSetReadRequiresHandle(&(pInstance->ringBuffer), true);
+    readHandle = uRingBufferTakeReadHandle(&(pInstance->ringBuffer));
+    U_PORT_TEST_ASSERT(readHandle >= 0);
+    gpBuffer = (char *) pUPortMalloc(U_GNSS_PRIVATE_TEST_RINGBUFFER_SIZE);
+    U_PORT_TEST_ASSERT(gpBuffer != NULL);
+
+    U_TEST_PRINT_LINE("filling the ring buffer in random-sized chunks.");
+    for (size_t x = 0; x < U_GNSS_PRIVATE_TEST_NUM_LOOPS; x++) {
+        waitingBytes = rand() % (U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES * 2);
+        gTestSerialWaitingBytes = waitingBytes;
+        // With no timeout, one go only
+        wantedBytes = waitingBytes;
+        if (wantedBytes > U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES) {
+            wantedBytes = U_GNSS_MSG_TEMPORARY_BUFFER_LENGTH_BYTES;
+        }
+        errorCodeOrSize = uGnssPrivateStreamFillRingBuffer(pInstance, 0, 0);
+        if (wantedBytes > 0) {
+            U_PORT_TEST_ASSERT(errorCodeOrSize == (int32_t) wantedBytes);
+        } else {
+            U_PORT_TEST_ASSERT(errorCodeOrSize == (int32_t) U_ERROR_COMMON_TIMEOUT);
+        }
+        U_PORT_TEST_ASSERT(gTestSerialWaitingBytes == waitingBytes - wantedBytes);
+        U_PORT_TEST_ASSERT(uRingBufferDataSizeHandle(&(pInstance->ringBuffer),
+                                                     readHandle) == wantedBytes);
+        U_PORT_TEST_ASSERT(uRingBufferReadHandle(&(pInstance->ringBuffer), readHandle,
+                                                 gpBuffer, U_GNSS_PRIVATE_TEST_RINGBUFFER_SIZE) == wantedBytes);
+        for (size_t y = 0; y < wantedBytes; y++) {
+            U_PORT_TEST_ASSERT(*(gpBuffer + y) == testSerialByte(expectedBytes));
+            expectedBytes++;
+        }
+    }
+    U_PORT_TEST_ASSERT(gTestSerialReadBytes == expectedBytes);
+    U_PORT_TEST_ASSERT(uRingBufferStatReadLossHandle(&(pInstance->ringBuffer), readHandle) == 0);
+
+    uPortFree(gpBuffer);
+    gpBuffer = NULL;
+    uRingBufferDelete(&(pInstance->ringBuffer));
+    uPortFree(gpLinearBuffer);
+    gpLinearBuffer = NULL;
+    uPortFree(pInstance);
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test that uGnssPrivateSpiAddReceivedData() removes SPI fill without
+ * losing a message which genuinely ends in 0xFF, as a UBX message
+ * will when its checksum happens to be 0xFF, when that message is
+ * followed in the same chunk by more than the threshold of fill.
+ */
+U_PORT_TEST_FUNCTION("[gnss]", "gnssPrivateSpiFill")
+{
+    uGnssPrivateInstance_t *pInstance;
+    char body[2] = {0};
+    char message[2 + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    int32_t messageSize = 0;
+    size_t fillThreshold = U_GNSS_DEFAULT_SPI_FILL_THRESHOLD;
+    size_t chunkSize;
+    size_t fillBytesDiscarded = 0;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    // Find a UBX message that ends in two 0xFF checksum bytes
+    for (size_t x = 0; (x < 0x10000) && (messageSize == 0); x++) {
+        body[0] = (char) (x >> 8);
+        body[1] = (char) x;
+        U_PORT_TEST_ASSERT(uUbxProtocolEncode(0x01, 0x02, body, sizeof(body),
+                                              message) == sizeof(message));
+        if (((uint8_t) message[sizeof(message) - 2] == U_GNSS_PRIVATE_SPI_FILL) &&
+            ((uint8_t) message[sizeof(message) - 1] == U_GNSS_PRIVATE_SPI_FILL)) {
+            messageSize = sizeof(message);
+        }
+    }
+    U_PORT_TEST_ASSERT(messageSize == sizeof(message));
+
+    // Just enough of a GNSS instance for SPI
+    pInstance = (uGnssPrivateInstance_t *) pUPortMalloc(sizeof(uGnssPrivateInstance_t));
+    U_PORT_TEST_ASSERT(pInstance != NULL);
+    memset(pInstance, 0, sizeof(*pInstance));
+    pInstance->spiFillThreshold = (int32_t) fillThreshold;
+    pInstance->pSpiRingBuffer = &gRingBuffer;
+    gpLinearBuffer = (char *) pUPortMalloc(U_GNSS_PRIVATE_TEST_RINGBUFFER_SIZE);
+    U_PORT_TEST_ASSERT(gpLinearBuffer != NULL);
+    U_PORT_TEST_ASSERT(uRingBufferCreate(&gRingBuffer, gpLinearBuffer,
+                                         U_GNSS_PRIVATE_TEST_RINGBUFFER_SIZE) == 0);
+    gpBuffer = (char *) pUPortMalloc(U_GNSS_PRIVATE_TEST_RINGBUFFER_SIZE);
+    U_PORT_TEST_ASSERT(gpBuffer != NULL);
+
+    U_TEST_PRINT_LINE("adding a message ending in 0xFF followed by %d byte(s) of fill.",
+                      fillThreshold * 2);
+    // The message, followed by more than the threshold of fill,
+    // all in one chunk: none of the message must be lost
+    memset(gpBuffer, U_GNSS_PRIVATE_SPI_FILL, U_GNSS_PRIVATE_TEST_RINGBUFFER_SIZE);
+    memcpy(gpBuffer, message, messageSize);
+    chunkSize = messageSize + (fillThreshold * 2);
+    U_PORT_TEST_ASSERT(uGnssPrivateSpiAddReceivedData(pInstance, gpBuffer,
+                                                      chunkSize) == (int32_t) chunkSize);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&gRingBuffer, gpBuffer, messageSize) == (size_t) messageSize);
+    U_PORT_TEST_ASSERT(memcmp(gpBuffer, message, messageSize) == 0);
+
+    // A chunk of nothing but fill must not reach the ring buffer
+    memset(gpBuffer, U_GNSS_PRIVATE_SPI_FILL, fillThreshold * 2);
+    U_PORT_TEST_ASSERT(uGnssPrivateSpiAddReceivedData(pInstance, gpBuffer,
+                                                      fillThreshold * 2) == (int32_t) fillThreshold * 2);
+    fillBytesDiscarded += fillThreshold * 2;
+    U_PORT_TEST_ASSERT(pInstance->spiFillBytesDiscarded == fillBytesDiscarded);
+
+    // When the next message arrives, the fill left over from the
+    // end of the first chunk must be removed, leaving just the message
+    memcpy(gpBuffer, message, messageSize);
+    U_PORT_TEST_ASSERT(uGnssPrivateSpiAddReceivedData(pInstance, gpBuffer,
+                                                      messageSize) == messageSize);
+    fillBytesDiscarded += fillThreshold * 2;
+    U_PORT_TEST_ASSERT(pInstance->spiFillBytesDiscarded == fillBytesDiscarded);
+    U_PORT_TEST_ASSERT(pInstance->spiUsefulBytes == (size_t) messageSize * 2);
+    U_PORT_TEST_ASSERT(uRingBufferRead(&gRingBuffer, gpBuffer, messageSize) == (size_t) messageSize);
+    U_PORT_TEST_ASSERT(memcmp(gpBuffer, message, messageSize) == 0);
+    U_PORT_TEST_ASSERT(uRingBufferDataSize(&gRingBuffer) == 0);
+
+    uPortFree(gpBuffer);
+    gpBuffer = NULL;
+    uRingBufferDelete(&gRingBuffer);
+    uPortFree(gpLinearBuffer);
+    gpLinearBuffer = NULL;
+    uPortFree(pInstance);
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test that the asynchronous message receive task is woken up by
+ * the "data received" event of a virtual serial transport, that
+ * it carries on by polling if the application takes the event
+ * over and that it then leaves the application's event callback
+ * alone when it stops.
+ */
+U_PORT_TEST_FUNCTION("[gnss]", "gnssPrivateMsgReceiveEvent")
+{
+    uGnssTransportHandle_t transportHandle;
+    uDeviceHandle_t gnssHandle;
+    uGnssMessageId_t messageId;
+    char message[U_GNSS_PRIVATE_TEST_NMEA_SENTENCE_MAX_LENGTH_BYTES];
+    size_t messageSize;
+    int32_t asyncHandle;
+    int32_t latencyMs;
+    int32_t totalLatencyMs = 0;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uGnssInit() == 0);
+    U_PORT_TEST_ASSERT(uPortMutexCreate(&gEventSerialMutex) == 0);
+
+    messageSize = makeNmeaMessage(message, gNmeaTestMessage[0].pTalkerSentenceStr,
+                                  gNmeaTestMessage[0].pBodyStr,
+                                  gNmeaTestMessage[0].pChecksumHexStr);
+    messageId.type = U_GNSS_PROTOCOL_NMEA;
+    messageId.id.pNmea = "GPGGA";
+    eventSerialInit();
+    transportHandle.pDeviceSerial = &gEventSerial;
+
+    U_TEST_PRINT_LINE("receiving messages woken by the \"data received\" event.");
+    U_PORT_TEST_ASSERT(uGnssAdd(U_GNSS_MODULE_TYPE_M9, U_GNSS_TRANSPORT_VIRTUAL_SERIAL,
+                                transportHandle, -1, false, &gnssHandle) == 0);
+    gEventMessageCount = 0;
+    asyncHandle = uGnssMsgReceiveStart(gnssHandle, &messageId, eventMessageCallback, NULL);
+    U_PORT_TEST_ASSERT(asyncHandle >= 0);
+    // The message receive task should have taken the event
+    U_PORT_TEST_ASSERT(gpEventSerialCallback != NULL);
+    U_PORT_TEST_ASSERT((gEventSerialFilter & U_DEVICE_SERIAL_EVENT_BITMASK_DATA_RECEIVED) != 0);
+    for (size_t x = 0; x < U_GNSS_PRIVATE_TEST_EVENT_NUM; x++) {
+        // Leave the message receive task waiting, then
+        // see how long it takes to respond
+        uPortTaskBlock(U_GNSS_PRIVATE_TEST_EVENT_GAP_MS);
+        latencyMs = eventMessageSend(message, messageSize);
+        U_PORT_TEST_ASSERT(latencyMs >= 0);
+        totalLatencyMs += latencyMs;
+    }
+    U_TEST_PRINT_LINE("average latency %d ms.", totalLatencyMs / U_GNSS_PRIVATE_TEST_EVENT_NUM);
+    U_PORT_TEST_ASSERT(totalLatencyMs / U_GNSS_PRIVATE_TEST_EVENT_NUM <=
+                       U_GNSS_PRIVATE_TEST_EVENT_LATENCY_MAX_MS);
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, asyncHandle) == 0);
+    uGnssRemove(gnssHandle);
+    // Our event callback should have been removed
+    U_PORT_TEST_ASSERT(gpEventSerialCallback == NULL);
+    U_PORT_TEST_ASSERT(gEventSerialFilter == 0);
+
+    U_TEST_PRINT_LINE("receiving messages with the application owning the event.");
+    U_PORT_TEST_ASSERT(uGnssAdd(U_GNSS_MODULE_TYPE_M9, U_GNSS_TRANSPORT_VIRTUAL_SERIAL,
+                                transportHandle, -1, false, &gnssHandle) == 0);
+    gEventMessageCount = 0;
+    asyncHandle = uGnssMsgReceiveStart(gnssHandle, &messageId, eventMessageCallback, NULL);
+    U_PORT_TEST_ASSERT(asyncHandle >= 0);
+    // The application takes over the event
+    gEventSerial.eventCallbackRemove(&gEventSerial);
+    U_PORT_TEST_ASSERT(gEventSerial.eventCallbackSet(&gEventSerial,
+                                                     U_DEVICE_SERIAL_EVENT_BITMASK_DATA_RECEIVED,
+                                                     appEventCallback, NULL,
+                                                     U_PORT_EVENT_QUEUE_MIN_TASK_STACK_SIZE_BYTES,
+                                                     U_CFG_OS_APP_TASK_PRIORITY) == 0);
+    // Messages should still get through
+    for (size_t x = 0; x < U_GNSS_PRIVATE_TEST_EVENT_NUM; x++) {
+        uPortTaskBlock(U_GNSS_PRIVATE_TEST_EVENT_GAP_MS);
+        U_PORT_TEST_ASSERT(eventMessageSend(message, messageSize) >= 0);
+    }
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, asyncHandle) == 0);
+    uGnssRemove(gnssHandle);
+    // The application's event callback should still be there
+    U_PORT_TEST_ASSERT(gpEventSerialCallback == appEventCallback);
+    U_PORT_TEST_ASSERT(gEventSerialFilter == U_DEVICE_SERIAL_EVENT_BITMASK_DATA_RECEIVED);
+    gEventSerial.eventCallbackRemove(&gEventSerial);
+
+    uPortMutexDelete(gEventSerialMutex);
+    gEventSerialMutex = NULL;
+    uGnssDeinit();
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
+/** Test that the message receive task, through its index of
+ * readers, calls exactly the readers that want a message, each
+ * once and newest first, whether they want a specific message ID
+ * or one with a wildcard, and that it no longer calls a reader
+ * that has been stopped.
+ */
+U_PORT_TEST_FUNCTION("[gnss]", "gnssPrivateMsgReceiveIndex")
+{
+    uGnssTransportHandle_t transportHandle;
+    uDeviceHandle_t gnssHandle;
+    uGnssMessageId_t messageId;
+    char ggaMessage[U_GNSS_PRIVATE_TEST_NMEA_SENTENCE_MAX_LENGTH_BYTES];
+    size_t ggaMessageSize;
+    char rmcMessage[U_GNSS_PRIVATE_TEST_NMEA_SENTENCE_MAX_LENGTH_BYTES];
+    size_t rmcMessageSize;
+    int32_t asyncHandle[sizeof(gIndexReader) / sizeof(gIndexReader[0])];
+    int32_t lastReader;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+    U_PORT_TEST_ASSERT(uGnssInit() == 0);
+    U_PORT_TEST_ASSERT(uPortMutexCreate(&gEventSerialMutex) == 0);
+
+    ggaMessageSize = makeNmeaMessage(ggaMessage, gNmeaTestMessage[0].pTalkerSentenceStr,
+                                     gNmeaTestMessage[0].pBodyStr,
+                                     gNmeaTestMessage[0].pChecksumHexStr);
+    rmcMessageSize = makeNmeaMessage(rmcMessage, gNmeaTestMessage[5].pTalkerSentenceStr,
+                                     gNmeaTestMessage[5].pBodyStr,
+                                     gNmeaTestMessage[5].pChecksumHexStr);
+    eventSerialInit();
+    transportHandle.pDeviceSerial = &gEventSerial;
+    U_PORT_TEST_ASSERT(uGnssAdd(U_GNSS_MODULE_TYPE_M9, U_GNSS_TRANSPORT_VIRTUAL_SERIAL,
+                                transportHandle, -1, false, &gnssHandle) == 0);
+
+    for (size_t x = 0; x < sizeof(gIndexReader) / sizeof(gIndexReader[0]); x++) {
+        messageId.type = gIndexReader[x].type;
+        messageId.id.ubx = gIndexReader[x].ubx;
+        if (gIndexReader[x].type == U_GNSS_PROTOCOL_NMEA) {
+            messageId.id.pNmea = (char *) gIndexReader[x].pNmea;
+        }
+        asyncHandle[x] = uGnssMsgReceiveStart(gnssHandle, &messageId, indexMessageCallback,
+                                              (void *) (intptr_t) x);
+        U_PORT_TEST_ASSERT(asyncHandle[x] >= 0);
+        // Newest first is highest handle first
+        U_PORT_TEST_ASSERT((x == 0) || (asyncHandle[x] > asyncHandle[x - 1]));
+    }
+
+    U_TEST_PRINT_LINE("sending \"%s\".", gNmeaTestMessage[0].pTalkerSentenceStr);
+    U_PORT_TEST_ASSERT(indexMessageSendCheck(ggaMessage, ggaMessageSize, gIndexExpectedGga,
+                                             sizeof(gIndexExpectedGga) /
+                                             sizeof(gIndexExpectedGga[0])));
+    U_TEST_PRINT_LINE("sending \"%s\".", gNmeaTestMessage[5].pTalkerSentenceStr);
+    U_PORT_TEST_ASSERT(indexMessageSendCheck(rmcMessage, rmcMessageSize, gIndexExpectedRmc,
+                                             sizeof(gIndexExpectedRmc) /
+                                             sizeof(gIndexExpectedRmc[0])));
+
+    // Stop an indexed reader and a wildcard reader
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, asyncHandle[1]) == 0);
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, asyncHandle[3]) == 0);
+    U_TEST_PRINT_LINE("sending \"%s\" after stopping readers 1 and 3.",
+                      gNmeaTestMessage[0].pTalkerSentenceStr);
+    U_PORT_TEST_ASSERT(indexMessageSendCheck(ggaMessage, ggaMessageSize,
+                                             gIndexExpectedGgaAfterStop,
+                                             sizeof(gIndexExpectedGgaAfterStop) /
+                                             sizeof(gIndexExpectedGgaAfterStop[0])));
+
+    // Stop the rest and start one more reader, for everything,
+    // which should then be the only one called
+    for (size_t x = 0; x < sizeof(gIndexReader) / sizeof(gIndexReader[0]); x++) {
+        if ((x != 1) && (x != 3)) {
+            U_PORT_TEST_ASSERT(uGnssMsgReceiveStop(gnssHandle, asyncHandle[x]) == 0);
+        }
+    }
+    lastReader = (int32_t) (sizeof(gIndexReader) / sizeof(gIndexReader[0]));
+    messageId.type = U_GNSS_PROTOCOL_ALL;
+    U_PORT_TEST_ASSERT(uGnssMsgReceiveStart(gnssHandle, &messageId, indexMessageCallback,
+                                            (void *) (intptr_t) lastReader) >= 0);
+    U_TEST_PRINT_LINE("sending \"%s\" after stopping all readers but a new one.",
+                      gNmeaTestMessage[0].pTalkerSentenceStr);
+    U_PORT_TEST_ASSERT(indexMessageSendCheck(ggaMessage, ggaMessageSize, &lastReader, 1));
+
+    uGnssRemove(gnssHandle);
+
+    uPortMutexDelete(gEventSerialMutex);
+    gEventSerialMutex = NULL;
+    uGnssDeinit();
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
 #endif // #ifndef __ZEPHYR__
 
 /** Clean-up to be run at the end of this round of tests, just
@@ -904,6 +1829,9 @@ U_PORT_TEST_FUNCTION("[gnss]", "gnssPrivateCleanUp")
     uPortFree(gpBuffer);
     uRingBufferDelete(&gRingBuffer);
     uPortFree(gpLinearBuffer);
+    if (gEventSerialMutex != NULL) {
+        uPortMutexDelete(gEventSerialMutex);
+    }
 
     uGnssDeinit();
     uPortDeinit();
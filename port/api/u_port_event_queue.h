@@ -103,6 +103,15 @@ extern "C" {
 # define U_PORT_EVENT_QUEUE_MAX_NUM 20
 #endif
 
+#ifndef U_PORT_EVENT_QUEUE_MAX_NUM_COALESCE
+/** The maximum number of events sent with
+ * uPortEventQueueSendCoalesce(), with different keys, that may
+ * be pending on an event queue at any one time; beyond this
+ * events are sent as if uPortEventQueueSend() had been called.
+ */
+# define U_PORT_EVENT_QUEUE_MAX_NUM_COALESCE 4
+#endif
+
 /** The length of uEventQueueControlOrSize_t (see implementation).
  */
 #define U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES 4
@@ -225,6 +234,43 @@ int32_t uPortEventQueueOpen(void (*pFunction) (void *, size_t),
 int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
                             size_t paramLengthBytes);
 
+/** Send to an event queue, coalescing the event with any
+ * event of the same key that is already waiting on the queue.
+ * This is intended for events that carry a bit-map, e.g. a
+ * "data received" event, where a burst of activity would
+ * otherwise fill the queue with identical events: if an event
+ * sent with the same key is still waiting to be handled, the
+ * bit-map of this event (a uint32_t at bitMapOffset in the
+ * parameter block) is OR'ed into the bit-map of the waiting
+ * event, which is then delivered with the rest of its parameter
+ * block unchanged, and nothing more is added to the queue.
+ * Otherwise the event is sent as for uPortEventQueueSend() and,
+ * if the queue is full, this function will block until room is
+ * available.  Use uPortEventQueueGetNumCoalesced() to find out
+ * how many events have been coalesced.  This function should
+ * not be called from an interrupt.
+ *
+ * @param handle            the handle for the event queue.
+ * @param[in] pParam        a pointer to the parameters structure
+ *                          to send, cannot be NULL.
+ * @param paramLengthBytes  the length of the parameters
+ *                          structure.  Must be less than or
+ *                          equal to paramMaxLengthBytes as
+ *                          given to uPortEventQueueOpen().
+ * @param key               the key of the event, e.g. a handle:
+ *                          only events with the same key are
+ *                          coalesced.
+ * @param bitMapOffset      the offset of the uint32_t bit-map
+ *                          in the parameters structure, e.g.
+ *                          as given by offsetof(); there must
+ *                          be room for the bit-map within
+ *                          paramLengthBytes.
+ * @return                  zero on success else negative error code.
+ */
+int32_t uPortEventQueueSendCoalesce(int32_t handle, const void *pParam,
+                                    size_t paramLengthBytes, int32_t key,
+                                    size_t bitMapOffset);
+
 /** Send to an event queue from an interrupt.  The data at
  * pParam will be copied onto the queue.  If the queue is full
  * the event will not be sent and an error will be returned.
@@ -324,6 +370,17 @@ int32_t uPortEventQueueClose(int32_t handle);
  */
 int32_t uPortEventQueueGetFree(int32_t handle);
 
+/** Get the number of events that have been coalesced with
+ * a waiting event, and hence not added to the queue, by
+ * uPortEventQueueSendCoalesce().
+ *
+ * @param handle  the handle of the event queue.
+ * @return        on success the number of events coalesced
+ *                since the event queue was opened, else
+ *                negative error code.
+ */
+int32_t uPortEventQueueGetNumCoalesced(int32_t handle);
+
 /** Free memory occupied by closed event queues.
  */
 void uPortEventQueueCleanUp(void);
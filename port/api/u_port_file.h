@@ -0,0 +1,126 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef _U_PORT_FILE_H_
+#define _U_PORT_FILE_H_
+
+/* Only header files representing a direct and unavoidable
+ * dependency between the API of this module and the API
+ * of another module should be included here; otherwise
+ * please keep #includes to your .c files. */
+
+/** \addtogroup __port
+ *  @{
+ */
+
+/** @file
+ * @brief Porting layer for simple access to files: writing a file
+ * in append fashion and mapping a whole file into memory for reading.
+ *
+ * Note: this API is currently only used by the GNSS capture/replay
+ * feature (see u_gnss_capture.h), it is not used in the core ubxlib
+ * code.  It is currently only implemented on the native Linux
+ * platform.  If you are creating your own port and do not need
+ * GNSS capture/replay to files you do not need to implement it.
+ * Where it is not implemented a weak implementation in
+ * u_port_file_default.c will take over and return
+ * #U_ERROR_COMMON_NOT_SUPPORTED.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** File handle.
+ */
+typedef void *uPortFileHandle_t;
+
+/* ----------------------------------------------------------------
+ * FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/** Open a file for writing; if the file already exists it is
+ * truncated.
+ *
+ * @param[out] pFileHandle a place to put the handle of the file,
+ *                         may NOT be NULL.
+ * @param[in]  pName       a null-terminated string naming the file,
+ *                         may NOT be NULL.
+ * @return                 zero on success else negative error code.
+ */
+int32_t uPortFileOpenWrite(uPortFileHandle_t *pFileHandle, const char *pName);
+
+/** Write to the end of a file opened with uPortFileOpenWrite().
+ *
+ * @param fileHandle the handle of the file.
+ * @param[in] pData  the data to write, may NOT be NULL.
+ * @param size       the number of bytes at pData.
+ * @return           the number of bytes written on success, else
+ *                   negative error code.
+ */
+int32_t uPortFileWrite(uPortFileHandle_t fileHandle, const char *pData,
+                       size_t size);
+
+/** Close a file opened with uPortFileOpenWrite(); fileHandle can
+ * no longer be used once this has returned.
+ *
+ * @param fileHandle the handle of the file.
+ * @return           zero on success else negative error code.
+ */
+int32_t uPortFileClose(uPortFileHandle_t fileHandle);
+
+/** Map the whole of an existing file, read-only, into memory; the
+ * mapping must be released with uPortFileUnmap().  Where the
+ * platform supports it the contents are paged in on demand, i.e.
+ * this is quick even for a very large file.
+ *
+ * @param[in] pName  a null-terminated string naming the file, may
+ *                   NOT be NULL.
+ * @param[out] ppData a place to put a pointer to the contents of
+ *                   the file, may NOT be NULL.
+ * @param[out] pSize a place to put the size of the file in bytes,
+ *                   may NOT be NULL.
+ * @return           zero on success else negative error code;
+ *                   #U_ERROR_COMMON_EMPTY is returned if the file
+ *                   is of zero length.
+ */
+int32_t uPortFileMap(const char *pName, const char **ppData, size_t *pSize);
+
+/** Release a mapping made by uPortFileMap().
+ *
+ * @param[in] pData the pointer returned by uPortFileMap().
+ * @param size      the size returned by uPortFileMap().
+ * @return          zero on success else negative error code.
+ */
+int32_t uPortFileUnmap(const char *pData, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @}*/
+
+#endif // _U_PORT_FILE_H_
+
+// End of file
@@ -56,6 +56,17 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** An event sent with uPortEventQueueSendCoalesce() that is
+ * waiting on the OS queue.
+ */
+typedef struct {
+    bool pending;        /** true if this entry is in use. */
+    int32_t key;         /** The key of the event. */
+    size_t paramLengthBytes; /** The length of the parameter block. */
+    size_t bitMapOffset; /** Offset of the bit-map in the parameter block. */
+    uint32_t bitMap;     /** Bits from coalesced events, to be OR'ed in. */
+} uEventQueueCoalesce_t;
+
 /** The info for an event queue.
  */
 typedef struct uEventQueue_t {
@@ -66,6 +77,13 @@ typedef struct uEventQueue_t {
     size_t paramMaxLengthBytes; /** Max length of an item on this OS queue. */
     uPortTaskHandle_t task; /** Handle for the OS task. */
     uPortMutexHandle_t taskRunningMutex; /** Mutex to determine if task has exited. */
+    uPortMutexHandle_t coalesceMutex; /** Mutex to protect coalesce[], only
+                                          created if uPortEventQueueSendCoalesce()
+                                          is called. */
+    uEventQueueCoalesce_t coalesce[U_PORT_EVENT_QUEUE_MAX_NUM_COALESCE]; /** Pending
+                                                                             coalescable
+                                                                             events. */
+    int32_t numCoalesced; /** The number of events coalesced. */
 } uEventQueue_t;
 
 /** The control/size word, prefixed to the parameter block sent to
@@ -78,7 +96,12 @@ typedef enum {
                                                * be 32 bit so that it can
                                                * also be used as a size. */
     U_EVENT_CONTROL_NONE = 0,
-    U_EVENT_CONTROL_EXIT_NOW = -1
+    U_EVENT_CONTROL_EXIT_NOW = -1,
+    U_EVENT_CONTROL_COALESCE_0 = -2 /* This and values below it indicate
+                                     * an event sent with
+                                     * uPortEventQueueSendCoalesce(), the
+                                     * value being U_EVENT_CONTROL_COALESCE_0
+                                     * minus the index into coalesce[]. */
 } uEventQueueControlOrSize_t;
 
 /* ----------------------------------------------------------------
@@ -97,6 +120,31 @@ static uEventQueue_t *gpEventQueue[U_PORT_EVENT_QUEUE_MAX_NUM];
  * STATIC FUNCTIONS
  * -------------------------------------------------------------- */
 
+// Take the pending coalesced event at the given index for the event
+// queue task, OR'ing in the bits of any events that were coalesced
+// with it; returns the length of the parameter block.
+static size_t coalesceTake(uEventQueue_t *pEventQueue, size_t index,
+                           char *pParam)
+{
+    uEventQueueCoalesce_t *pCoalesce = &(pEventQueue->coalesce[index]);
+    size_t paramLengthBytes;
+    uint32_t bitMap;
+
+    U_PORT_MUTEX_LOCK(pEventQueue->coalesceMutex);
+
+    paramLengthBytes = pCoalesce->paramLengthBytes;
+    // memcpy() since the bit-map may not be aligned
+    memcpy(&bitMap, pParam + pCoalesce->bitMapOffset, sizeof(bitMap));
+    bitMap |= pCoalesce->bitMap;
+    memcpy(pParam + pCoalesce->bitMapOffset, &bitMap, sizeof(bitMap));
+    // From here on another event with this key will be sent afresh
+    pCoalesce->pending = false;
+
+    U_PORT_MUTEX_UNLOCK(pEventQueue->coalesceMutex);
+
+    return paramLengthBytes;
+}
+
 // Run the user function.  This will be run multiple times in a
 // task of its own.
 static void eventQueueTask(void *pParam)
@@ -139,6 +187,12 @@ static void eventQueueTask(void *pParam)
                 } else {
                     pEventQueue->pFunction(NULL, 0);
                 }
+            } else if ((int32_t) *pControlOrSize <= (int32_t) U_EVENT_CONTROL_COALESCE_0) {
+                pEventQueue->pFunction((void *) & (param[U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES]),
+                                       coalesceTake(pEventQueue,
+                                                    (size_t) ((int32_t) U_EVENT_CONTROL_COALESCE_0 -
+                                                              (int32_t) *pControlOrSize),
+                                                    &(param[U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES])));
             }
         }
     }
@@ -181,6 +235,9 @@ static int32_t eventQueueFree(uEventQueue_t *pEventQueue)
 
         // Tidy up
         uPortMutexDelete(pEventQueue->taskRunningMutex);
+        if (pEventQueue->coalesceMutex != NULL) {
+            uPortMutexDelete(pEventQueue->coalesceMutex);
+        }
         errorCode = uPortQueueDelete(pEventQueue->queue);
 
         // Pause here to allow the deletions
@@ -196,6 +253,51 @@ static int32_t eventQueueFree(uEventQueue_t *pEventQueue)
     return errorCode;
 }
 
+// Allocate a block to send to the OS queue of an event queue,
+// with the control word at the start and a copy of the parameter
+// block after it.
+// The mutex must be locked before this is called.
+static char *pBlockCreate(const uEventQueue_t *pEventQueue,
+                          uEventQueueControlOrSize_t controlOrSize,
+                          const void *pParam, size_t paramLengthBytes)
+{
+    char *pBlock;
+
+    // We need to add the control word to the start, so pUPortMalloc
+    // a block that is paramMaxLengthBytes (i.e. paramMaxLengthBytes
+    // of the queue, not just the paramLengthBytes passed in, since
+    // uPortQueueSend() will expect to copy the full length) plus
+    // plus the control word length
+    pBlock = (char *) pUPortMalloc(pEventQueue->paramMaxLengthBytes +
+                                   U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES);
+    if (pBlock != NULL) {
+        // Keep memory checkers (e.g. Valgrind) happy
+        memset(pBlock, 0, pEventQueue->paramMaxLengthBytes +
+               U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES);
+        // Copy in the control word
+        //lint -e(826) Suppress area too small; the size of pBlock is always
+        // at least U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES in size
+        *((uEventQueueControlOrSize_t *) pBlock) = controlOrSize;
+        if (pParam != NULL) {
+            // Copy in param
+            //lint -e{826} Suppress pointed-to area too small, we make sure it is OK above
+            memcpy(pBlock + U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES,
+                   pParam, paramLengthBytes);
+        }
+    }
+
+    return pBlock;
+}
+
+// Give up an entry in the coalesce[] table of an event queue that
+// was claimed for an event which could not then be sent.
+static void coalesceRelease(uEventQueue_t *pEventQueue, size_t index)
+{
+    U_PORT_MUTEX_LOCK(pEventQueue->coalesceMutex);
+    pEventQueue->coalesce[index].pending = false;
+    U_PORT_MUTEX_UNLOCK(pEventQueue->coalesceMutex);
+}
+
 // Get the next free event handle.
 // The mutex must be locked before this is called.
 static int32_t nextEventHandleGet()
@@ -325,6 +427,7 @@ int32_t uPortEventQueueOpen(void (*pFunction) (void *, size_t),
                 // Malloc a structure to represent the event queue
                 pEventQueue = (uEventQueue_t *) pUPortMalloc(sizeof(uEventQueue_t));
                 if (pEventQueue != NULL) {
+                    memset(pEventQueue, 0, sizeof(*pEventQueue));
                     pEventQueue->closed = false;
                     pEventQueue->pFunction = pFunction;
                     pEventQueue->paramMaxLengthBytes = paramMaxLengthBytes;
@@ -406,29 +509,10 @@ int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
             ((pParam != NULL) || (paramLengthBytes == 0))) {
             queue = pEventQueue->queue;
             errorCode = U_ERROR_COMMON_NO_MEMORY;
-            // We need to add the control word to the start, so pUPortMalloc
-            // a block that is paramMaxLengthBytes (i.e. paramMaxLengthBytes
-            // of the queue, not just the paramLengthBytes passed in, since
-            // uPortQueueSend() will expect to copy the full length) plus
-            // plus the control word length
-            pBlock = (char *) pUPortMalloc(pEventQueue->paramMaxLengthBytes +
-                                           U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES);
-            if (pBlock != NULL) {
-                // Keep memory checkers (e.g. Valgrind) happy
-                memset(pBlock, 0, pEventQueue->paramMaxLengthBytes +
-                       U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES);
-                // Copy in the control word, which is actually just
-                // the size in this case
-                //lint -e(826) Suppress area too small; the size of pBlock is always
-                // at least U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES in size
-                *((uEventQueueControlOrSize_t *) pBlock) = (uEventQueueControlOrSize_t) paramLengthBytes;
-                if (pParam != NULL) {
-                    // Copy in param
-                    //lint -e{826} Suppress pointed-to area too small, we make sure it is OK above
-                    memcpy(pBlock + U_PORT_EVENT_QUEUE_CONTROL_OR_SIZE_LENGTH_BYTES,
-                           pParam, paramLengthBytes);
-                }
-            }
+            // The control word is actually just the size in this case
+            pBlock = pBlockCreate(pEventQueue,
+                                  (uEventQueueControlOrSize_t) paramLengthBytes,
+                                  pParam, paramLengthBytes);
         }
 
         // We release the mutex before sending to the
@@ -450,6 +534,97 @@ int32_t uPortEventQueueSend(int32_t handle, const void *pParam,
     return (int32_t) errorCode;
 }
 
+// Send to an event queue, coalescing with any pending event of
+// the same key.
+int32_t uPortEventQueueSendCoalesce(int32_t handle, const void *pParam,
+                                    size_t paramLengthBytes, int32_t key,
+                                    size_t bitMapOffset)
+{
+    uErrorCode_t errorCode = U_ERROR_COMMON_NOT_INITIALISED;
+    uEventQueue_t *pEventQueue = NULL;
+    uEventQueueCoalesce_t *pCoalesce;
+    uEventQueueControlOrSize_t controlOrSize;
+    int32_t index = -1;
+    char *pBlock = NULL;
+    uPortQueueHandle_t queue = NULL;
+    uint32_t bitMap;
+    bool coalesced = false;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
+        pEventQueue = pEventQueueGet(handle);
+        if ((pEventQueue != NULL) && (pParam != NULL) &&
+            (paramLengthBytes <= pEventQueue->paramMaxLengthBytes) &&
+            (bitMapOffset + sizeof(bitMap) <= paramLengthBytes)) {
+            errorCode = U_ERROR_COMMON_SUCCESS;
+            if (pEventQueue->coalesceMutex == NULL) {
+                errorCode = (uErrorCode_t) uPortMutexCreate(&(pEventQueue->coalesceMutex));
+            }
+            if (errorCode == U_ERROR_COMMON_SUCCESS) {
+                queue = pEventQueue->queue;
+                // If there is no room to record the event it is
+                // just sent normally
+                controlOrSize = (uEventQueueControlOrSize_t) paramLengthBytes;
+
+                U_PORT_MUTEX_LOCK(pEventQueue->coalesceMutex);
+
+                for (size_t x = 0; (x < sizeof(pEventQueue->coalesce) /
+                                    sizeof(pEventQueue->coalesce[0])) && !coalesced; x++) {
+                    pCoalesce = &(pEventQueue->coalesce[x]);
+                    if (pCoalesce->pending) {
+                        if (pCoalesce->key == key) {
+                            // memcpy() since the bit-map may not be aligned
+                            memcpy(&bitMap, (const char *) pParam + bitMapOffset, sizeof(bitMap));
+                            pCoalesce->bitMap |= bitMap;
+                            pEventQueue->numCoalesced++;
+                            coalesced = true;
+                        }
+                    } else if (index < 0) {
+                        index = (int32_t) x;
+                    }
+                }
+                if (!coalesced && (index >= 0)) {
+                    pCoalesce = &(pEventQueue->coalesce[index]);
+                    pCoalesce->pending = true;
+                    pCoalesce->key = key;
+                    pCoalesce->paramLengthBytes = paramLengthBytes;
+                    pCoalesce->bitMapOffset = bitMapOffset;
+                    pCoalesce->bitMap = 0;
+                    controlOrSize = (uEventQueueControlOrSize_t) ((int32_t) U_EVENT_CONTROL_COALESCE_0 - index);
+                }
+
+                U_PORT_MUTEX_UNLOCK(pEventQueue->coalesceMutex);
+
+                if (!coalesced) {
+                    errorCode = U_ERROR_COMMON_NO_MEMORY;
+                    pBlock = pBlockCreate(pEventQueue, controlOrSize,
+                                          pParam, paramLengthBytes);
+                    if ((pBlock == NULL) && (index >= 0)) {
+                        coalesceRelease(pEventQueue, index);
+                    }
+                }
+            }
+        }
+
+        // As in uPortEventQueueSend(), release the mutex before
+        // sending since the send may block
+        U_PORT_MUTEX_UNLOCK(gMutex);
+
+        if (pBlock != NULL) {
+            errorCode = (uErrorCode_t) uPortQueueSend(queue, pBlock);
+            if ((errorCode != U_ERROR_COMMON_SUCCESS) && (index >= 0)) {
+                coalesceRelease(pEventQueue, index);
+            }
+            uPortFree(pBlock);
+        }
+    }
+
+    return (int32_t) errorCode;
+}
+
 // Send to an event queue from an interrupt.
 int32_t uPortEventQueueSendIrq(int32_t handle, const void *pParam,
                                size_t paramLengthBytes)
@@ -598,6 +773,27 @@ int32_t uPortEventQueueGetFree(int32_t handle)
     return errorCodeOrFree;
 }
 
+// Get the number of events that have been coalesced.
+int32_t uPortEventQueueGetNumCoalesced(int32_t handle)
+{
+    int32_t errorCodeOrCount = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uEventQueue_t *pEventQueue;
+
+    if (gMutex != NULL) {
+
+        U_PORT_MUTEX_LOCK(gMutex);
+
+        pEventQueue = pEventQueueGet(handle);
+        if (pEventQueue != NULL) {
+            errorCodeOrCount = pEventQueue->numCoalesced;
+        }
+
+        U_PORT_MUTEX_UNLOCK(gMutex);
+    }
+
+    return errorCodeOrCount;
+}
+
 // Free memory in closed event queues
 void uPortEventQueueCleanUp(void)
 {
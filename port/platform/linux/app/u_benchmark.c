@@ -0,0 +1,943 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief The application entry point for the Linux benchmark runner.
+ * Runs a set of performance benchmarks of ubxlib code, none of which
+ * need any hardware (the AT client is talked to over a pseudo-terminal
+ * with canned module responses), and writes the results as JSON,
+ * either to stdout or to the file named on the command line.
+ *
+ * As with the test runner, the environment variable U_CFG_APP_FILTER
+ * may be set to run only the benchmarks whose names begin with the
+ * given string.  The environment variable U_BENCHMARK_DURATION_MS may
+ * be set to change how long each benchmark runs for.
+ */
+
+#ifdef U_CFG_OVERRIDE
+# include "u_cfg_override.h" // For a customer's configuration override
+#endif
+
+#define _GNU_SOURCE
+
+#include "stddef.h"    // NULL, size_t etc.
+#include "stdint.h"    // int32_t etc.
+#include "stdbool.h"
+#include "string.h"
+#include "stdlib.h"    // getenv(), atoi()
+#include "stdio.h"     // fprintf()
+#include "limits.h"    // INT_MIN
+#include "time.h"      // clock_gettime()
+#include "unistd.h"
+#include "fcntl.h"
+#include "errno.h"
+#include "pthread.h"
+#include "termios.h"
+
+#include "u_cfg_sw.h"
+#include "u_cfg_os_platform_specific.h"
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_debug.h"
+#include "u_port_uart.h"
+
+#include "u_at_client.h"
+
+#include "u_ringbuffer.h"
+
+#include "u_ubx_protocol.h"
+
+#include "u_spartn_crc.h"
+
+#include "u_linked_list.h"
+#include "u_geofence.h"
+
+#include "u_gnss_module_type.h"
+#include "u_gnss_type.h"
+#include "u_gnss.h"
+#include "u_gnss_private.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+#ifndef U_BENCHMARK_DURATION_MS
+/** How long to run each benchmark for, in milliseconds; may be
+ * overridden at run-time with the environment variable of the
+ * same name.
+ */
+# define U_BENCHMARK_DURATION_MS 1000
+#endif
+
+#ifndef U_BENCHMARK_UBXLIB_VERSION
+/** The ubxlib version to put in the JSON output, normally
+ * taken from library.json by the CMakeLists.txt file.
+ */
+# define U_BENCHMARK_UBXLIB_VERSION "unknown"
+#endif
+
+/** The size of the ring buffer used by the ring buffer and
+ * GNSS stream benchmarks.
+ */
+#define U_BENCHMARK_RING_BUFFER_SIZE_BYTES 4096
+
+/** The size of the buffer over which CRCs are calculated.
+ */
+#define U_BENCHMARK_CRC_BUFFER_SIZE_BYTES 4096
+
+/** The number of URCs the AT client URC benchmark sends in
+ * one go.
+ */
+#define U_BENCHMARK_AT_NUM_URCS_PER_BATCH 100
+
+/** How long to wait for the AT client to deal with a batch of
+ * URCs before giving up.
+ */
+#define U_BENCHMARK_AT_URC_TIMEOUT_MS 5000
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/** A benchmark: the function runs until gDurationNs has passed,
+ * returning the number of units (bytes, messages, calls, etc.)
+ * it processed and the time it took in nanoseconds, else a
+ * negative error code.
+ */
+typedef struct {
+    const char *pName;
+    const char *pUnit;
+    int32_t (*pFunction)(const void *pParam, uint64_t *pCount,
+                         uint64_t *pElapsedNs);
+    const void *pParam;
+} uBenchmark_t;
+
+/** Parameters for a ring buffer benchmark.
+ */
+typedef struct {
+    size_t chunkSizeBytes;
+    bool spsc;
+} uBenchmarkRingBuffer_t;
+
+/** An AT command and its canned response, as a module would
+ * send it.
+ */
+typedef struct {
+    const char *pCommand;
+    const char *pResponsePrefix;
+    size_t numParameters;
+    const char *pResponse;
+} uBenchmarkAtTranscript_t;
+
+/** The pseudo-terminal, the AT client that is talking over it and
+ * the canned-module thread that is answering.
+ */
+typedef struct {
+    int masterFd;
+    int32_t uartHandle;
+    uAtClientHandle_t atHandle;
+    pthread_t moduleThread;
+    bool moduleThreadRunning;
+    volatile int32_t numUrcs;
+} uBenchmarkAt_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/** How long each benchmark runs for in nanoseconds.
+ */
+static uint64_t gDurationNs = ((uint64_t) U_BENCHMARK_DURATION_MS) * 1000000ULL;
+
+/** The ring buffer benchmark parameters.
+ */
+static const uBenchmarkRingBuffer_t gRingBufferMutex16 = {16, false};
+static const uBenchmarkRingBuffer_t gRingBufferMutex1024 = {1024, false};
+static const uBenchmarkRingBuffer_t gRingBufferSpsc16 = {16, true};
+static const uBenchmarkRingBuffer_t gRingBufferSpsc1024 = {1024, true};
+
+/** What the canned module sends back to the AT client; the commands
+ * are typical of those sent periodically by the cellular code.
+ */
+static const uBenchmarkAtTranscript_t gAtTranscript[] = {
+    {"AT+CSQ", "+CSQ:", 2, "\r\n+CSQ: 20,99\r\n\r\nOK\r\n"},
+    {"AT+COPS?", "+COPS:", 4, "\r\n+COPS: 0,0,\"Vodafone UK\",7\r\n\r\nOK\r\n"},
+    {"AT+CEREG?", "+CEREG:", 5, "\r\n+CEREG: 2,1,\"A1B2\",\"01A2B3C4\",7\r\n\r\nOK\r\n"},
+    {"AT+CGPADDR=1", "+CGPADDR:", 2, "\r\n+CGPADDR: 1,\"10.160.23.45\"\r\n\r\nOK\r\n"},
+    {"AT+CCLK?", "+CCLK:", 1, "\r\n+CCLK: \"24/01/15,10:20:30+00\"\r\n\r\nOK\r\n"}
+};
+
+/** The URC that the canned module sends.
+ */
+static const char gAtUrc[] = "\r\n+CEREG: 5,\"A1B2\",\"01A2B3C4\",7\r\n";
+
+/** The number of benchmarks that failed.
+ */
+static int32_t gNumFailed = 0;
+
+/** The pseudo-terminal and AT client.
+ */
+static uBenchmarkAt_t gAt = {.masterFd = -1, .uartHandle = -1};
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: HELPERS
+ * -------------------------------------------------------------- */
+
+// Get a monotonic time in nanoseconds.
+static uint64_t timeNowNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (((uint64_t) ts.tv_sec) * 1000000000ULL) + (uint64_t) ts.tv_nsec;
+}
+
+// Fill a buffer with pseudo-random but repeatable data.
+static void fillBuffer(char *pBuffer, size_t length)
+{
+    uint32_t x = 0x12345678;
+    for (size_t y = 0; y < length; y++) {
+        // xorshift
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        *(pBuffer + y) = (char) x;
+    }
+}
+
+// Write an NMEA sentence, adding the checksum, returning the length.
+static size_t nmeaMake(const char *pBody, char *pBuffer)
+{
+    uint8_t checksum = 0;
+    size_t length = strlen(pBody);
+
+    // pBody starts with $, not included in the checksum
+    for (size_t x = 1; x < length; x++) {
+        checksum ^= (uint8_t) pBody[x];
+    }
+    return (size_t) sprintf(pBuffer, "%s*%02X\r\n", pBody, checksum);
+}
+
+// Write an RTCM 1005 message, returning the length.
+static size_t rtcmMake(char *pBuffer)
+{
+    size_t length = 19;
+    uint32_t crc;
+
+    pBuffer[0] = (char) 0xD3;
+    pBuffer[1] = (char) (length >> 8);
+    pBuffer[2] = (char) length;
+    fillBuffer(pBuffer + 3, length);
+    // 12-bit message number 1005
+    pBuffer[3] = (char) 0x3E;
+    pBuffer[4] = (char) ((pBuffer[4] & 0x0F) | 0xD0);
+    crc = uSpartnCrc24(pBuffer, length + 3);
+    pBuffer[length + 3] = (char) (crc >> 16);
+    pBuffer[length + 4] = (char) (crc >> 8);
+    pBuffer[length + 5] = (char) crc;
+
+    return length + 6;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: BENCHMARKS THAT NEED NO I/O
+ * -------------------------------------------------------------- */
+
+// Add data to and read it from a ring buffer, in chunks.
+static int32_t ringBuffer(const void *pParam, uint64_t *pCount,
+                          uint64_t *pElapsedNs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    const uBenchmarkRingBuffer_t *pRingBufferParam = (const uBenchmarkRingBuffer_t *) pParam;
+    size_t chunkSize = pRingBufferParam->chunkSizeBytes;
+    uRingBuffer_t ringBuffer;
+    char *pLinear = (char *) pUPortMalloc(U_BENCHMARK_RING_BUFFER_SIZE_BYTES);
+    char *pData = (char *) pUPortMalloc(chunkSize * 2);
+    uint64_t startNs;
+    uint64_t count = 0;
+
+    if ((pLinear != NULL) && (pData != NULL)) {
+        fillBuffer(pData, chunkSize);
+        if (pRingBufferParam->spsc) {
+            errorCode = uRingBufferCreateSpsc(&ringBuffer, pLinear,
+                                              U_BENCHMARK_RING_BUFFER_SIZE_BYTES);
+        } else {
+            errorCode = uRingBufferCreate(&ringBuffer, pLinear,
+                                          U_BENCHMARK_RING_BUFFER_SIZE_BYTES);
+        }
+        if (errorCode == 0) {
+            startNs = timeNowNs();
+            do {
+                // Batches of 1000 to keep the clock out of it
+                for (size_t x = 0; (x < 1000) && (errorCode == 0); x++) {
+                    if (!uRingBufferAdd(&ringBuffer, pData, chunkSize) ||
+                        (uRingBufferRead(&ringBuffer, pData + chunkSize, chunkSize) != chunkSize)) {
+                        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+                    }
+                }
+                count += chunkSize * 1000;
+            } while ((errorCode == 0) && (timeNowNs() - startNs < gDurationNs));
+            *pElapsedNs = timeNowNs() - startNs;
+            *pCount = count;
+            if (memcmp(pData, pData + chunkSize, chunkSize) != 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+            }
+            uRingBufferDelete(&ringBuffer);
+        }
+    }
+    uPortFree(pData);
+    uPortFree(pLinear);
+
+    return errorCode;
+}
+
+// Decode a UBX-NAV-PVT message with uUbxProtocolDecode().
+static int32_t ubxProtocolDecode(const void *pParam, uint64_t *pCount,
+                                 uint64_t *pElapsedNs)
+{
+    int32_t errorCode = 0;
+    char body[92];
+    char message[92 + U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES];
+    char bodyOut[92];
+    int32_t messageClass;
+    int32_t messageId;
+    uint64_t startNs;
+    uint64_t count = 0;
+
+    (void) pParam;
+    fillBuffer(body, sizeof(body));
+    uUbxProtocolEncode(0x01, 0x07, body, sizeof(body), message);
+    startNs = timeNowNs();
+    do {
+        for (size_t x = 0; (x < 1000) && (errorCode == 0); x++) {
+            if (uUbxProtocolDecode(message, sizeof(message), &messageClass,
+                                   &messageId, bodyOut, sizeof(bodyOut),
+                                   NULL) != sizeof(bodyOut)) {
+                errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+            }
+        }
+        count += 1000;
+    } while ((errorCode == 0) && (timeNowNs() - startNs < gDurationNs));
+    *pElapsedNs = timeNowNs() - startNs;
+    *pCount = count;
+
+    return errorCode;
+}
+
+// Decode a stream of UBX, NMEA and RTCM messages with
+// uGnssPrivateStreamDecodeRingBuffer(), as the GNSS message
+// receive task would.
+static int32_t gnssStreamDecode(const void *pParam, uint64_t *pCount,
+                                uint64_t *pElapsedNs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    char *pLinear = (char *) pUPortMalloc(U_BENCHMARK_RING_BUFFER_SIZE_BYTES);
+    char stream[512];
+    char body[92];
+    size_t streamLength = 0;
+    size_t numMessages = 0;
+    uRingBuffer_t ringBuffer;
+    int32_t readHandle = -1;
+    uGnssPrivateMessageId_t messageId;
+    int32_t length;
+    uint64_t startNs;
+    uint64_t count = 0;
+
+    (void) pParam;
+    // A typical second's worth of output: NAV-PVT, GGA, RMC, RTCM
+    fillBuffer(body, sizeof(body));
+    streamLength += uUbxProtocolEncode(0x01, 0x07, body, sizeof(body), stream);
+    numMessages++;
+    streamLength += nmeaMake("$GNGGA,092725.00,4717.11399,N,00833.91590,E,1,08,1.01,499.6,M,48.0,M,,",
+                             stream + streamLength);
+    numMessages++;
+    streamLength += nmeaMake("$GNRMC,092725.00,A,4717.11399,N,00833.91590,E,0.004,77.52,091202,,,A",
+                             stream + streamLength);
+    numMessages++;
+    streamLength += rtcmMake(stream + streamLength);
+    numMessages++;
+
+    if (pLinear != NULL) {
+        errorCode = uRingBufferCreateWithReadHandle(&ringBuffer, pLinear,
+                                                    U_BENCHMARK_RING_BUFFER_SIZE_BYTES, 1);
+        if (errorCode == 0) {
+            // As the GNSS code does
+            uRingBufferSetReadRequiresHandle(&ringBuffer, true);
+            readHandle = uRingBufferTakeReadHandle(&ringBuffer);
+            errorCode = readHandle;
+        }
+        if (errorCode >= 0) {
+            errorCode = 0;
+            startNs = timeNowNs();
+            do {
+                for (size_t x = 0; (x < 100) && (errorCode == 0); x++) {
+                    uRingBufferAdd(&ringBuffer, stream, streamLength);
+                    for (size_t y = 0; (y < numMessages) && (errorCode == 0); y++) {
+                        messageId.type = U_GNSS_PROTOCOL_ALL;
+                        length = uGnssPrivateStreamDecodeRingBuffer(&ringBuffer, readHandle,
+                                                                    &messageId);
+                        if (length > 0) {
+                            uRingBufferReadHandle(&ringBuffer, readHandle, NULL, length);
+                        } else {
+                            errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+                        }
+                    }
+                }
+                count += numMessages * 100;
+            } while ((errorCode == 0) && (timeNowNs() - startNs < gDurationNs));
+            *pElapsedNs = timeNowNs() - startNs;
+            *pCount = count;
+            uRingBufferGiveReadHandle(&ringBuffer, readHandle);
+        }
+        uRingBufferDelete(&ringBuffer);
+    }
+    uPortFree(pLinear);
+
+    return errorCode;
+}
+
+// Decode a stream that is mostly garbage, as might follow a UART
+// overrun or joining a stream part way through a message, with
+// uGnssPrivateStreamDecodeRingBuffer(), counting the bytes it gets
+// through.
+static int32_t gnssStreamDiscard(const void *pParam, uint64_t *pCount,
+                                 uint64_t *pElapsedNs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    char *pLinear = (char *) pUPortMalloc(U_BENCHMARK_RING_BUFFER_SIZE_BYTES);
+    char stream[U_BENCHMARK_RING_BUFFER_SIZE_BYTES / 2];
+    char body[92];
+    size_t messageLength;
+    uRingBuffer_t ringBuffer;
+    int32_t readHandle = -1;
+    uGnssPrivateMessageId_t messageId;
+    int32_t length;
+    uint64_t startNs;
+    uint64_t count = 0;
+
+    (void) pParam;
+    // Garbage, which must not contain any of the bytes a UBX, NMEA
+    // or RTCM message starts with, followed by a single NAV-PVT
+    fillBuffer(body, sizeof(body));
+    fillBuffer(stream, sizeof(stream));
+    for (size_t x = 0; x < sizeof(stream); x++) {
+        if ((stream[x] == (char) 0xB5) || (stream[x] == '$') || (stream[x] == (char) 0xD3)) {
+            stream[x] = '_';
+        }
+    }
+    messageLength = U_UBX_PROTOCOL_OVERHEAD_LENGTH_BYTES + sizeof(body);
+    uUbxProtocolEncode(0x01, 0x07, body, sizeof(body),
+                       stream + sizeof(stream) - messageLength);
+
+    if (pLinear != NULL) {
+        errorCode = uRingBufferCreateWithReadHandle(&ringBuffer, pLinear,
+                                                    U_BENCHMARK_RING_BUFFER_SIZE_BYTES, 1);
+        if (errorCode == 0) {
+            // As the GNSS code does
+            uRingBufferSetReadRequiresHandle(&ringBuffer, true);
+            readHandle = uRingBufferTakeReadHandle(&ringBuffer);
+            errorCode = readHandle;
+        }
+        if (errorCode >= 0) {
+            errorCode = 0;
+            startNs = timeNowNs();
+            do {
+                for (size_t x = 0; (x < 100) && (errorCode == 0); x++) {
+                    uRingBufferAdd(&ringBuffer, stream, sizeof(stream));
+                    // Ask for the message: the garbage is discarded on the way
+                    messageId.type = U_GNSS_PROTOCOL_UBX;
+                    messageId.id.ubx = 0x0107;
+                    length = uGnssPrivateStreamDecodeRingBuffer(&ringBuffer, readHandle,
+                                                                &messageId);
+                    if (length == (int32_t) messageLength) {
+                        uRingBufferReadHandle(&ringBuffer, readHandle, NULL, length);
+                    } else {
+                        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+                    }
+                }
+                count += (sizeof(stream) - messageLength) * 100;
+            } while ((errorCode == 0) && (timeNowNs() - startNs < gDurationNs));
+            *pElapsedNs = timeNowNs() - startNs;
+            *pCount = count;
+            uRingBufferGiveReadHandle(&ringBuffer, readHandle);
+        }
+        uRingBufferDelete(&ringBuffer);
+    }
+    uPortFree(pLinear);
+
+    return errorCode;
+}
+
+// Run a SPARTN CRC over a buffer.
+static int32_t spartnCrc(const void *pParam, uint64_t *pCount,
+                         uint64_t *pElapsedNs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    uint32_t (*pCrc)(const char *, size_t) = (uint32_t (*)(const char *, size_t)) pParam;
+    char *pBuffer = (char *) pUPortMalloc(U_BENCHMARK_CRC_BUFFER_SIZE_BYTES);
+    volatile uint32_t crc = 0;
+    uint64_t startNs;
+    uint64_t count = 0;
+
+    if (pBuffer != NULL) {
+        errorCode = 0;
+        fillBuffer(pBuffer, U_BENCHMARK_CRC_BUFFER_SIZE_BYTES);
+        startNs = timeNowNs();
+        do {
+            for (size_t x = 0; x < 100; x++) {
+                crc ^= pCrc(pBuffer, U_BENCHMARK_CRC_BUFFER_SIZE_BYTES);
+            }
+            count += U_BENCHMARK_CRC_BUFFER_SIZE_BYTES * 100;
+        } while (timeNowNs() - startNs < gDurationNs);
+        *pElapsedNs = timeNowNs() - startNs;
+        *pCount = count;
+        uPortFree(pBuffer);
+    }
+
+    return errorCode;
+}
+
+// uSpartnCrc24() in the form spartnCrc() wants.
+static uint32_t spartnCrc24(const char *pData, size_t size)
+{
+    return uSpartnCrc24(pData, size);
+}
+
+// uSpartnCrc32() in the form spartnCrc() wants.
+static uint32_t spartnCrc32(const char *pData, size_t size)
+{
+    return uSpartnCrc32(pData, size);
+}
+
+#ifdef U_CFG_GEOFENCE
+// Test positions against a geofence with uGeofenceTest(); pParam
+// is the number of vertices, zero for a circle.
+static int32_t geofenceTest(const void *pParam, uint64_t *pCount,
+                            uint64_t *pElapsedNs)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+    size_t numVertices = (size_t) (uintptr_t) pParam;
+    uGeofence_t *pFence = pUGeofenceCreate("benchmark");
+    // Somewhere in Thalwil, a few hundred metres across
+    int64_t latitudeX1e9 = 47295000000LL;
+    int64_t longitudeX1e9 = 8564000000LL;
+    int64_t offsetX1e9 = 2000000LL;
+    volatile size_t numInside = 0;
+    uint64_t startNs;
+    uint64_t count = 0;
+
+    if (pFence != NULL) {
+        if (numVertices == 0) {
+            errorCode = uGeofenceAddCircle(pFence, latitudeX1e9, longitudeX1e9, 200000);
+        } else {
+            errorCode = 0;
+            // A star-ish shape so that not every edge is the same
+            for (size_t x = 0; (x < numVertices) && (errorCode == 0); x++) {
+                int64_t a = (x & 1) ? offsetX1e9 : offsetX1e9 / 2;
+                int64_t latX1e9 = latitudeX1e9;
+                int64_t lonX1e9 = longitudeX1e9;
+                switch ((x * 8) / numVertices) {
+                    case 0:
+                        latX1e9 += a;
+                        break;
+                    case 1:
+                        latX1e9 += a;
+                        lonX1e9 += a;
+                        break;
+                    case 2:
+                        lonX1e9 += a;
+                        break;
+                    case 3:
+                        latX1e9 -= a;
+                        lonX1e9 += a;
+                        break;
+                    case 4:
+                        latX1e9 -= a;
+                        break;
+                    case 5:
+                        latX1e9 -= a;
+                        lonX1e9 -= a;
+                        break;
+                    case 6:
+                        lonX1e9 -= a;
+                        break;
+                    default:
+                        latX1e9 += a;
+                        lonX1e9 -= a;
+                        break;
+                }
+                errorCode = uGeofenceAddVertex(pFence, latX1e9, lonX1e9, false);
+            }
+        }
+        if (errorCode == 0) {
+            startNs = timeNowNs();
+            do {
+                // Walk a position across the fence
+                for (int32_t x = 0; x < 100; x++) {
+                    if (uGeofenceTest(pFence, U_GEOFENCE_TEST_TYPE_INSIDE, false,
+                                      latitudeX1e9 - (offsetX1e9 * 2) + (offsetX1e9 * x / 25),
+                                      longitudeX1e9 + (offsetX1e9 * x / 100),
+                                      INT_MIN, 5000, -1)) {
+                        numInside++;
+                    }
+                }
+                count += 100;
+            } while (timeNowNs() - startNs < gDurationNs);
+            *pElapsedNs = timeNowNs() - startNs;
+            *pCount = count;
+        }
+        uGeofenceFree(pFence);
+    }
+
+    return errorCode;
+}
+#endif // #ifdef U_CFG_GEOFENCE
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: AT CLIENT BENCHMARKS
+ * -------------------------------------------------------------- */
+
+// The canned module: read AT commands from the master side of the
+// pseudo-terminal and write back the matching canned response.
+static void *moduleThread(void *pParam)
+{
+    char line[64];
+    size_t length = 0;
+    char c;
+    const char *pResponse;
+
+    (void) pParam;
+    while (read(gAt.masterFd, &c, 1) == 1) {
+        if (c == '\r') {
+            line[length] = 0;
+            pResponse = "\r\nERROR\r\n";
+            for (size_t x = 0; x < sizeof(gAtTranscript) / sizeof(gAtTranscript[0]); x++) {
+                if (strcmp(line, gAtTranscript[x].pCommand) == 0) {
+                    pResponse = gAtTranscript[x].pResponse;
+                }
+            }
+            if (write(gAt.masterFd, pResponse, strlen(pResponse)) < 0) {
+                break;
+            }
+            length = 0;
+        } else if ((c != '\n') && (length < sizeof(line) - 1)) {
+            line[length] = c;
+            length++;
+        }
+    }
+
+    return NULL;
+}
+
+// URC handler for the AT client URC benchmark.
+static void urcHandler(uAtClientHandle_t atHandle, void *pParam)
+{
+    char buffer[16];
+
+    (void) pParam;
+    uAtClientReadInt(atHandle);
+    uAtClientReadString(atHandle, buffer, sizeof(buffer), false);
+    uAtClientReadString(atHandle, buffer, sizeof(buffer), false);
+    uAtClientReadInt(atHandle);
+    gAt.numUrcs++;
+}
+
+// Close the AT client and the pseudo-terminal.
+static void atClose()
+{
+    if (gAt.atHandle != NULL) {
+        uAtClientRemove(gAt.atHandle);
+        gAt.atHandle = NULL;
+    }
+    uAtClientDeinit();
+    if (gAt.uartHandle >= 0) {
+        uPortUartClose(gAt.uartHandle);
+        gAt.uartHandle = -1;
+    }
+    if (gAt.masterFd >= 0) {
+        // Closing the master ends the canned module
+        close(gAt.masterFd);
+        gAt.masterFd = -1;
+    }
+    if (gAt.moduleThreadRunning) {
+        pthread_join(gAt.moduleThread, NULL);
+        gAt.moduleThreadRunning = false;
+    }
+}
+
+// Open a pseudo-terminal with the canned module on the master side
+// and an AT client on a UART opened on the slave side.
+static int32_t atOpen()
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+    struct termios termios;
+    const char *pSlaveName = NULL;
+
+    gAt.masterFd = posix_openpt(O_RDWR | O_NOCTTY);
+    if ((gAt.masterFd >= 0) && (grantpt(gAt.masterFd) == 0) &&
+        (unlockpt(gAt.masterFd) == 0) &&
+        (tcgetattr(gAt.masterFd, &termios) == 0)) {
+        cfmakeraw(&termios);
+        tcsetattr(gAt.masterFd, TCSANOW, &termios);
+        pSlaveName = ptsname(gAt.masterFd);
+    }
+    if ((pSlaveName != NULL) && (uPortUartPrefix(pSlaveName) == 0)) {
+        // A negative UART number means use the prefix alone
+        gAt.uartHandle = uPortUartOpen(-1, 115200, NULL, 8192, -1, -1, -1, -1);
+    }
+    if ((gAt.uartHandle >= 0) && (uAtClientInit() == 0)) {
+        gAt.atHandle = uAtClientAdd(gAt.uartHandle, U_AT_CLIENT_STREAM_TYPE_UART,
+                                    NULL, U_AT_CLIENT_BUFFER_LENGTH_BYTES);
+    }
+    if ((gAt.atHandle != NULL) &&
+        (pthread_create(&gAt.moduleThread, NULL, moduleThread, NULL) == 0)) {
+        gAt.moduleThreadRunning = true;
+        uAtClientPrintAtSet(gAt.atHandle, false);
+        uAtClientDebugSet(gAt.atHandle, false);
+        // Take out the deliberate delays, which are there for the
+        // sake of real modules, so that it is the AT client that
+        // is measured
+        uAtClientDelaySet(gAt.atHandle, 0);
+        uAtClientReadRetryDelaySet(gAt.atHandle, 0);
+        uAtClientTimeoutSet(gAt.atHandle, 1000);
+        errorCode = 0;
+    }
+    if (errorCode != 0) {
+        atClose();
+    }
+
+    return errorCode;
+}
+
+// Send AT commands to the canned module and parse the responses.
+static int32_t atClientCommand(const void *pParam, uint64_t *pCount,
+                               uint64_t *pElapsedNs)
+{
+    int32_t errorCode;
+    char buffer[32];
+    const uBenchmarkAtTranscript_t *pTranscript;
+    uint64_t startNs;
+    uint64_t count = 0;
+
+    (void) pParam;
+    errorCode = atOpen();
+    if (errorCode == 0) {
+        startNs = timeNowNs();
+        do {
+            for (size_t x = 0; (x < sizeof(gAtTranscript) / sizeof(gAtTranscript[0])) &&
+                 (errorCode == 0); x++) {
+                pTranscript = &(gAtTranscript[x]);
+                uAtClientLock(gAt.atHandle);
+                uAtClientCommandStart(gAt.atHandle, pTranscript->pCommand);
+                uAtClientCommandStop(gAt.atHandle);
+                uAtClientResponseStart(gAt.atHandle, pTranscript->pResponsePrefix);
+                for (size_t y = 0; y < pTranscript->numParameters; y++) {
+                    uAtClientReadString(gAt.atHandle, buffer, sizeof(buffer), false);
+                }
+                uAtClientResponseStop(gAt.atHandle);
+                errorCode = uAtClientUnlock(gAt.atHandle);
+                count++;
+            }
+        } while ((errorCode == 0) && (timeNowNs() - startNs < gDurationNs));
+        *pElapsedNs = timeNowNs() - startNs;
+        *pCount = count;
+        atClose();
+    }
+
+    return errorCode;
+}
+
+// Have the canned module send URCs as fast as it can and count
+// how quickly the AT client handles them.
+static int32_t atClientUrc(const void *pParam, uint64_t *pCount,
+                           uint64_t *pElapsedNs)
+{
+    int32_t errorCode;
+    char *pBatch;
+    size_t urcLength = strlen(gAtUrc);
+    int32_t numUrcsSent = 0;
+    uint64_t startNs;
+    uint64_t waitStartNs;
+
+    (void) pParam;
+    errorCode = atOpen();
+    if (errorCode == 0) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pBatch = (char *) pUPortMalloc(urcLength * U_BENCHMARK_AT_NUM_URCS_PER_BATCH);
+        if (pBatch != NULL) {
+            for (size_t x = 0; x < U_BENCHMARK_AT_NUM_URCS_PER_BATCH; x++) {
+                memcpy(pBatch + (x * urcLength), gAtUrc, urcLength);
+            }
+            gAt.numUrcs = 0;
+            errorCode = uAtClientSetUrcHandler(gAt.atHandle, "+CEREG:", urcHandler, NULL);
+            if (errorCode == 0) {
+                startNs = timeNowNs();
+                do {
+                    if (write(gAt.masterFd, pBatch,
+                              urcLength * U_BENCHMARK_AT_NUM_URCS_PER_BATCH) < 0) {
+                        errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+                    }
+                    numUrcsSent += U_BENCHMARK_AT_NUM_URCS_PER_BATCH;
+                } while ((errorCode == 0) && (timeNowNs() - startNs < gDurationNs));
+                // Wait for the AT client to catch up
+                waitStartNs = timeNowNs();
+                while ((errorCode == 0) && (gAt.numUrcs < numUrcsSent)) {
+                    if (timeNowNs() - waitStartNs > U_BENCHMARK_AT_URC_TIMEOUT_MS * 1000000ULL) {
+                        errorCode = (int32_t) U_ERROR_COMMON_TIMEOUT;
+                    }
+                    uPortTaskBlock(1);
+                }
+                *pElapsedNs = timeNowNs() - startNs;
+                *pCount = gAt.numUrcs;
+                uAtClientRemoveUrcHandler(gAt.atHandle, "+CEREG:");
+            }
+            uPortFree(pBatch);
+        }
+        atClose();
+    }
+
+    return errorCode;
+}
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS: RUNNING
+ * -------------------------------------------------------------- */
+
+/** The benchmarks.
+ */
+static const uBenchmark_t gBenchmark[] = {
+    {"ringBufferMutex16", "bytes/s", ringBuffer, &gRingBufferMutex16},
+    {"ringBufferMutex1024", "bytes/s", ringBuffer, &gRingBufferMutex1024},
+    {"ringBufferSpsc16", "bytes/s", ringBuffer, &gRingBufferSpsc16},
+    {"ringBufferSpsc1024", "bytes/s", ringBuffer, &gRingBufferSpsc1024},
+    {"ubxProtocolDecode", "messages/s", ubxProtocolDecode, NULL},
+    {"gnssStreamDecode", "messages/s", gnssStreamDecode, NULL},
+    {"gnssStreamDiscard", "bytes/s", gnssStreamDiscard, NULL},
+    {"spartnCrc24", "bytes/s", spartnCrc, (const void *) spartnCrc24},
+    {"spartnCrc32", "bytes/s", spartnCrc, (const void *) spartnCrc32},
+#ifdef U_CFG_GEOFENCE
+    {"geofenceTestCircle", "calls/s", geofenceTest, (const void *) 0},
+    {"geofenceTestPolygon8", "calls/s", geofenceTest, (const void *) 8},
+    {"geofenceTestPolygon64", "calls/s", geofenceTest, (const void *) 64},
+#endif
+    {"atClientCommand", "commands/s", atClientCommand, NULL},
+    {"atClientUrc", "urcs/s", atClientUrc, NULL}
+};
+
+// Run the benchmarks, writing JSON to pFile.
+static int32_t run(FILE *pFile, const char *pFilter)
+{
+    int32_t numFailed = 0;
+    int32_t errorCode;
+    const uBenchmark_t *pBenchmark;
+    uint64_t count;
+    uint64_t elapsedNs;
+    bool first = true;
+
+    fprintf(pFile, "{\n");
+    fprintf(pFile, "  \"ubxlib\": \"%s\",\n", U_BENCHMARK_UBXLIB_VERSION);
+    fprintf(pFile, "  \"platform\": \"linux\",\n");
+    fprintf(pFile, "  \"durationMs\": %llu,\n", (unsigned long long) (gDurationNs / 1000000));
+    fprintf(pFile, "  \"benchmarks\": [");
+    for (size_t x = 0; x < sizeof(gBenchmark) / sizeof(gBenchmark[0]); x++) {
+        pBenchmark = &(gBenchmark[x]);
+        if ((pFilter == NULL) ||
+            (strncmp(pBenchmark->pName, pFilter, strlen(pFilter)) == 0)) {
+            count = 0;
+            elapsedNs = 0;
+            errorCode = pBenchmark->pFunction(pBenchmark->pParam, &count, &elapsedNs);
+            fprintf(pFile, "%s\n    {\"name\": \"%s\", \"unit\": \"%s\", ",
+                    first ? "" : ",", pBenchmark->pName, pBenchmark->pUnit);
+            if ((errorCode == 0) && (elapsedNs > 0)) {
+                fprintf(pFile, "\"value\": %.1f, \"count\": %llu, \"elapsedMs\": %.3f}",
+                        ((double) count) * 1e9 / (double) elapsedNs,
+                        (unsigned long long) count, ((double) elapsedNs) / 1e6);
+            } else {
+                fprintf(pFile, "\"value\": null, \"errorCode\": %d}", (int) errorCode);
+                numFailed++;
+            }
+            fflush(pFile);
+            first = false;
+        }
+    }
+    fprintf(pFile, "\n  ]\n}\n");
+
+    return numFailed;
+}
+
+// The task within which the benchmarks run.
+static void appTask(void *pParam)
+{
+    FILE *pFile = (FILE *) pParam;
+    const char *pFilter = getenv("U_CFG_APP_FILTER");
+    const char *pDuration = getenv("U_BENCHMARK_DURATION_MS");
+
+    if ((pFilter != NULL) && (strlen(pFilter) == 0)) {
+        pFilter = NULL;
+    }
+    if ((pDuration != NULL) && (atoi(pDuration) > 0)) {
+        gDurationNs = ((uint64_t) atoi(pDuration)) * 1000000ULL;
+    }
+
+    uPortInit();
+    // Nothing but JSON should go to stdout
+    uPortLogOff();
+    gNumFailed = run(pFile, pFilter);
+    if (gNumFailed != 0) {
+        fprintf(stderr, "U_BENCHMARK: %d benchmark(s) failed.\n", (int) gNumFailed);
+    }
+    uPortDeinit();
+}
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+// Entry point: the only argument, if present, is the name of the
+// file to write the JSON results to; returns non-zero if any
+// benchmark failed.
+int main(int argc, char *argv[])
+{
+    int32_t errorCode;
+    FILE *pFile = stdout;
+
+    if (argc > 1) {
+        pFile = fopen(argv[1], "w");
+        if (pFile == NULL) {
+            fprintf(stderr, "U_BENCHMARK: unable to open \"%s\" (%s).\n",
+                    argv[1], strerror(errno));
+            return 1;
+        }
+    }
+
+    errorCode = uPortPlatformStart(appTask, pFile,
+                                   U_CFG_OS_APP_TASK_STACK_SIZE_BYTES,
+                                   U_CFG_OS_APP_TASK_PRIORITY);
+    if (pFile != stdout) {
+        fclose(pFile);
+    }
+
+    if ((errorCode == 0) && (gNumFailed != 0)) {
+        errorCode = 1;
+    }
+
+    return (int) errorCode;
+}
+
+// End of file
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2019-2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief Implementation of file access on the Linux platform.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+
+#include "u_error_common.h"
+
+#include "u_port.h"
+#include "u_port_os.h"
+#include "u_port_heap.h"
+#include "u_port_file.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+typedef struct {
+    int fd;
+} uPortFile_t;
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+int32_t uPortFileOpenWrite(uPortFileHandle_t *pFileHandle, const char *pName)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortFile_t *pFile;
+
+    if ((pFileHandle != NULL) && (pName != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NO_MEMORY;
+        pFile = (uPortFile_t *) pUPortMalloc(sizeof(uPortFile_t));
+        if (pFile != NULL) {
+            errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+            pFile->fd = open(pName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if (pFile->fd >= 0) {
+                *pFileHandle = (uPortFileHandle_t) pFile;
+                errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+            } else {
+                uPortFree(pFile);
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+int32_t uPortFileWrite(uPortFileHandle_t fileHandle, const char *pData,
+                       size_t size)
+{
+    int32_t errorCodeOrLength = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortFile_t *pFile = (uPortFile_t *) fileHandle;
+    size_t written = 0;
+    ssize_t x;
+
+    if ((pFile != NULL) && (pData != NULL)) {
+        errorCodeOrLength = (int32_t) U_ERROR_COMMON_SUCCESS;
+        // write() may do only part of the job
+        while ((written < size) && (errorCodeOrLength == 0)) {
+            x = write(pFile->fd, pData + written, size - written);
+            if (x > 0) {
+                written += x;
+            } else if ((x == 0) || (errno != EINTR)) {
+                // Nothing written without an error would have
+                // us going round forever, treat it as one
+                errorCodeOrLength = (int32_t) U_ERROR_COMMON_PLATFORM;
+            }
+        }
+        if (errorCodeOrLength == 0) {
+            errorCodeOrLength = (int32_t) written;
+        }
+    }
+
+    return errorCodeOrLength;
+}
+
+int32_t uPortFileClose(uPortFileHandle_t fileHandle)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    uPortFile_t *pFile = (uPortFile_t *) fileHandle;
+
+    if (pFile != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (close(pFile->fd) != 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        }
+        uPortFree(pFile);
+    }
+
+    return errorCode;
+}
+
+int32_t uPortFileMap(const char *pName, const char **ppData, size_t *pSize)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+    int fd;
+    struct stat fileStat;
+    void *pMap;
+
+    if ((pName != NULL) && (ppData != NULL) && (pSize != NULL)) {
+        errorCode = (int32_t) U_ERROR_COMMON_NOT_FOUND;
+        fd = open(pName, O_RDONLY);
+        if (fd >= 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+            if (fstat(fd, &fileStat) == 0) {
+                errorCode = (int32_t) U_ERROR_COMMON_EMPTY;
+                if (fileStat.st_size > 0) {
+                    errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+                    pMap = mmap(NULL, (size_t) fileStat.st_size, PROT_READ,
+                                MAP_PRIVATE, fd, 0);
+                    if (pMap != MAP_FAILED) {
+                        // The file is going to be read from start to
+                        // finish, let the kernel know so that it can
+                        // read ahead
+                        madvise(pMap, (size_t) fileStat.st_size, MADV_SEQUENTIAL);
+                        *ppData = (const char *) pMap;
+                        *pSize = (size_t) fileStat.st_size;
+                        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+                    }
+                }
+            }
+            // The mapping, if there is one, keeps the file open
+            close(fd);
+        }
+    }
+
+    return errorCode;
+}
+
+int32_t uPortFileUnmap(const char *pData, size_t size)
+{
+    int32_t errorCode = (int32_t) U_ERROR_COMMON_INVALID_PARAMETER;
+
+    if (pData != NULL) {
+        errorCode = (int32_t) U_ERROR_COMMON_SUCCESS;
+        if (munmap((void *) pData, size) != 0) {
+            errorCode = (int32_t) U_ERROR_COMMON_PLATFORM;
+        }
+    }
+
+    return errorCode;
+}
+
+// End of file
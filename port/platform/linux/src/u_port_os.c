@@ -77,6 +77,7 @@
 #include "time.h"
 #include "signal.h"
 #include "errno.h"
+#include "sys/timerfd.h"
 
 #include "u_cfg_sw.h"
 #include "u_cfg_os_platform_specific.h"
@@ -106,6 +107,28 @@ int32_t _uPortMutexUnlock(uPortMutexHandle_t mutexHandle);
  * COMPILE-TIME MACROS
  * -------------------------------------------------------------- */
 
+#ifndef U_PORT_TIMER_WHEEL_TICK_MS
+/** The resolution of the timer wheel which runs all of the
+ * uPortTimer timers, in milliseconds.
+ */
+# define U_PORT_TIMER_WHEEL_TICK_MS 1
+#endif
+
+/** The number of bits of the tick count covered by one level of
+ * the timer wheel.
+ */
+#define U_PORT_TIMER_WHEEL_LEVEL_BITS 6
+
+/** The number of slots in one level of the timer wheel.
+ */
+#define U_PORT_TIMER_WHEEL_NUM_SLOTS (1 << U_PORT_TIMER_WHEEL_LEVEL_BITS)
+
+/** The number of levels of the timer wheel; with a 1 ms tick, four
+ * levels reach to a little over four and a half hours, longer
+ * timers simply being cascaded through the top level again.
+ */
+#define U_PORT_TIMER_WHEEL_NUM_LEVELS 4
+
 /* ----------------------------------------------------------------
  * TYPES
  * -------------------------------------------------------------- */
@@ -125,16 +148,37 @@ typedef struct {
     size_t readCount;     /*!< Unread bytes in the queue. */
 } uPortQueue_t;
 
-/** Timers are implemented using Posix timer_t timers.
+/** Timers are kept in a hierarchical timer wheel, all of them
+ * being run from a single thread which waits on a timerfd; each
+ * slot of the wheel is a doubly-linked list of timers.
 */
-typedef struct {
-    timer_t timerId;             /*!< Posix timer ID. */
-    struct itimerspec timerSpec; /*!< Posix structure for timer start values and intervals.*/
+typedef struct uPortTimer_t {
+    struct uPortTimer_t *pNext;
+    struct uPortTimer_t *pPrev;
+    struct uPortTimer_t **ppSlot; /*!< The slot the timer is in, NULL if not running. */
+    uint64_t expiryTick;          /*!< When the timer expires, in wheel ticks. */
+    uint64_t periodTicks;         /*!< The interval at the last start, in wheel ticks. */
+    uint32_t intervalMs;
     bool periodic;
     pTimerCallback_t *pCallback;
     void *pCallbackParam;
 } uPortTimer_t;
 
+/** The timer wheel.
+ */
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_t thread;
+    bool threadRunning;
+    bool stop;
+    int timerFd;
+    struct timespec startTime; /*!< CLOCK_MONOTONIC time of tick zero. */
+    uint64_t tick;             /*!< The last tick that has been processed. */
+    size_t numTimers;          /*!< The number of timers in the wheel. */
+    uPortTimer_t *pRunning;    /*!< The timer whose callback is being called. */
+    uPortTimer_t *pSlot[U_PORT_TIMER_WHEEL_NUM_LEVELS][U_PORT_TIMER_WHEEL_NUM_SLOTS];
+} uPortTimerWheel_t;
+
 /** Threads are implemented using Posix pthreads. As the Posix api wants the callback
  *  to return a void pointer we have to use this struct as a middle man.
 */
@@ -163,6 +207,13 @@ uLinkedList_t *gpThreadList = NULL;
 uPortMutexHandle_t gMutexTimer = NULL;
 uLinkedList_t *gpTimerList = NULL;
 
+// The timer wheel; the mutex is a plain pthread one, and the
+// service thread is created with pthread_create() directly, since
+// both outlive uPortDeinit() for any timers that are still running.
+static uPortTimerWheel_t gTimerWheel = {.mutex = PTHREAD_MUTEX_INITIALIZER,
+                                        .timerFd = -1
+                                       };
+
 // Posix has no suspend/resume functions for threads and this is needed
 // for the critical section implementation of the port layer. We therefore
 // use a mutex in combination with a Linux signal USR1 to achieve this.
@@ -247,11 +298,227 @@ static int32_t suspendOrResumeAllTasks(bool suspend)
 }
 #endif
 
-// Posix timer callback function in required format.
-static void timerCallback(union sigval sv)
+// Return the current tick of the timer wheel, derived from
+// CLOCK_MONOTONIC.
+static uint64_t timerWheelTickNow()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    int64_t ms = ((int64_t)(now.tv_sec - gTimerWheel.startTime.tv_sec) * 1000) +
+                 ((now.tv_nsec - gTimerWheel.startTime.tv_nsec) / 1000000);
+    if (ms < 0) {
+        ms = 0;
+    }
+    return (uint64_t)ms / U_PORT_TIMER_WHEEL_TICK_MS;
+}
+
+// Add a timer to the timer wheel: the timer goes into the lowest
+// level at which its expiry and the current tick differ only in the
+// bits of that level and those below it, so it is always in a slot
+// ahead of the current one and is cascaded down to the level below
+// when that slot comes round.  A timer too far ahead for the top
+// level goes into the next slot of the top level, to be put back
+// in again from there.  gTimerWheel.mutex must be locked.
+static void timerWheelAdd(uPortTimer_t *pTimer)
+{
+    uPortTimer_t **ppSlot = NULL;
+    uint64_t expiryTick = pTimer->expiryTick;
+    size_t shift;
+
+    if (expiryTick <= gTimerWheel.tick) {
+        // Can happen when cascading: due now, which is
+        // the slot about to be processed
+        expiryTick = gTimerWheel.tick;
+    }
+    for (size_t level = 0; (level < U_PORT_TIMER_WHEEL_NUM_LEVELS) &&
+         (ppSlot == NULL); level++) {
+        shift = level * U_PORT_TIMER_WHEEL_LEVEL_BITS;
+        if ((expiryTick >> (shift + U_PORT_TIMER_WHEEL_LEVEL_BITS)) ==
+            (gTimerWheel.tick >> (shift + U_PORT_TIMER_WHEEL_LEVEL_BITS))) {
+            ppSlot = &(gTimerWheel.pSlot[level][(expiryTick >> shift) &
+                                                (U_PORT_TIMER_WHEEL_NUM_SLOTS - 1)]);
+        }
+    }
+    if (ppSlot == NULL) {
+        shift = (U_PORT_TIMER_WHEEL_NUM_LEVELS - 1) * U_PORT_TIMER_WHEEL_LEVEL_BITS;
+        ppSlot = &(gTimerWheel.pSlot[U_PORT_TIMER_WHEEL_NUM_LEVELS - 1]
+                   [((gTimerWheel.tick >> shift) + 1) & (U_PORT_TIMER_WHEEL_NUM_SLOTS - 1)]);
+    }
+    pTimer->ppSlot = ppSlot;
+    pTimer->pPrev = NULL;
+    pTimer->pNext = *ppSlot;
+    if (pTimer->pNext != NULL) {
+        pTimer->pNext->pPrev = pTimer;
+    }
+    *ppSlot = pTimer;
+    gTimerWheel.numTimers++;
+}
+
+// Remove a timer from the timer wheel, if it is in it;
+// gTimerWheel.mutex must be locked.
+static void timerWheelRemove(uPortTimer_t *pTimer)
+{
+    if (pTimer->ppSlot != NULL) {
+        if (pTimer->pPrev != NULL) {
+            pTimer->pPrev->pNext = pTimer->pNext;
+        } else {
+            *(pTimer->ppSlot) = pTimer->pNext;
+        }
+        if (pTimer->pNext != NULL) {
+            pTimer->pNext->pPrev = pTimer->pPrev;
+        }
+        pTimer->ppSlot = NULL;
+        pTimer->pNext = NULL;
+        pTimer->pPrev = NULL;
+        gTimerWheel.numTimers--;
+    }
+}
+
+// Set the timerfd to go off at the next tick on which there is
+// something to do: the next occupied slot of the bottom level or,
+// if there is none before the bottom level wraps, the wrap, where
+// the level above is cascaded.  If there are no timers the timerfd
+// is disarmed.  gTimerWheel.mutex must be locked.
+static void timerWheelArm()
+{
+    struct itimerspec its = {0};
+    uint64_t tick = gTimerWheel.tick + 1;
+
+    if (gTimerWheel.stop) {
+        // Any time in the past will wake the service thread
+        its.it_value.tv_nsec = 1;
+    } else if (gTimerWheel.numTimers > 0) {
+        while (((tick & (U_PORT_TIMER_WHEEL_NUM_SLOTS - 1)) != 0) &&
+               (gTimerWheel.pSlot[0][tick & (U_PORT_TIMER_WHEEL_NUM_SLOTS - 1)] == NULL)) {
+            tick++;
+        }
+        uint64_t ms = tick * U_PORT_TIMER_WHEEL_TICK_MS;
+        its.it_value.tv_sec = gTimerWheel.startTime.tv_sec + (time_t)(ms / 1000);
+        its.it_value.tv_nsec = gTimerWheel.startTime.tv_nsec + (long)(ms % 1000) * 1000000;
+        if (its.it_value.tv_nsec >= 1000000000) {
+            its.it_value.tv_nsec -= 1000000000;
+            its.it_value.tv_sec++;
+        }
+    }
+    timerfd_settime(gTimerWheel.timerFd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+// Process one tick of the timer wheel: cascade down any upper-level
+// slots that have come round and then call the callbacks of the
+// timers in the current bottom-level slot.  The callbacks are called
+// with gTimerWheel.mutex unlocked so that they may start, stop or
+// delete timers, including their own; gTimerWheel.mutex must be
+// locked.
+static void timerWheelTick(uint64_t tick)
+{
+    uPortTimer_t *pTimer;
+    uPortTimer_t *pList;
+    size_t shift;
+
+    gTimerWheel.tick = tick;
+    for (size_t level = U_PORT_TIMER_WHEEL_NUM_LEVELS - 1; level > 0; level--) {
+        shift = level * U_PORT_TIMER_WHEEL_LEVEL_BITS;
+        if ((tick & ((((uint64_t) 1) << shift) - 1)) == 0) {
+            pList = gTimerWheel.pSlot[level][(tick >> shift) & (U_PORT_TIMER_WHEEL_NUM_SLOTS - 1)];
+            while (pList != NULL) {
+                pTimer = pList;
+                pList = pList->pNext;
+                timerWheelRemove(pTimer);
+                timerWheelAdd(pTimer);
+            }
+        }
+    }
+    while ((pTimer = gTimerWheel.pSlot[0][tick & (U_PORT_TIMER_WHEEL_NUM_SLOTS - 1)]) != NULL) {
+        timerWheelRemove(pTimer);
+        if (pTimer->periodic) {
+            pTimer->expiryTick = tick + pTimer->periodTicks;
+            timerWheelAdd(pTimer);
+        }
+        gTimerWheel.pRunning = pTimer;
+        pthread_mutex_unlock(&gTimerWheel.mutex);
+        pTimer->pCallback(pTimer, pTimer->pCallbackParam);
+        pthread_mutex_lock(&gTimerWheel.mutex);
+        gTimerWheel.pRunning = NULL;
+    }
+}
+
+// The timer wheel service thread: wait on the timerfd and then
+// process all of the ticks up to now.
+static void *timerWheelThread(void *pParam)
+{
+    uint64_t expirations;
+    uint64_t tickNow;
+
+    (void)pParam;
+    pthread_mutex_lock(&gTimerWheel.mutex);
+    while (!gTimerWheel.stop) {
+        pthread_mutex_unlock(&gTimerWheel.mutex);
+        if ((read(gTimerWheel.timerFd, &expirations, sizeof(expirations)) < 0) &&
+            (errno != EINTR) && (errno != EAGAIN)) {
+            // Shouldn't happen but don't spin if it does
+            uPortTaskBlock(U_PORT_TIMER_WHEEL_TICK_MS);
+        }
+        pthread_mutex_lock(&gTimerWheel.mutex);
+        tickNow = timerWheelTickNow();
+        while (!gTimerWheel.stop && (gTimerWheel.numTimers > 0) &&
+               (gTimerWheel.tick < tickNow)) {
+            timerWheelTick(gTimerWheel.tick + 1);
+        }
+        if ((gTimerWheel.numTimers == 0) && (gTimerWheel.tick < tickNow)) {
+            // Nothing to do in between so just jump forward
+            gTimerWheel.tick = tickNow;
+        }
+        timerWheelArm();
+    }
+    pthread_mutex_unlock(&gTimerWheel.mutex);
+
+    return NULL;
+}
+
+// Start the timer wheel service thread if it is not already
+// running; gTimerWheel.mutex must be locked.
+static uErrorCode_t timerWheelStart()
+{
+    uErrorCode_t errorCode = U_ERROR_COMMON_SUCCESS;
+
+    if (!gTimerWheel.threadRunning) {
+        errorCode = U_ERROR_COMMON_PLATFORM;
+        if (gTimerWheel.timerFd < 0) {
+            gTimerWheel.timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC);
+            clock_gettime(CLOCK_MONOTONIC, &gTimerWheel.startTime);
+            gTimerWheel.tick = 0;
+        }
+        if (gTimerWheel.timerFd >= 0) {
+            gTimerWheel.stop = false;
+            if (pthread_create(&gTimerWheel.thread, NULL,
+                               timerWheelThread, NULL) == 0) {
+                gTimerWheel.threadRunning = true;
+                errorCode = U_ERROR_COMMON_SUCCESS;
+            }
+        }
+    }
+
+    return errorCode;
+}
+
+// Stop the timer wheel service thread; any timers that are
+// still running will be picked up again when it is next started.
+static void timerWheelStop()
 {
-    uPortTimer_t *pTimer = (uPortTimer_t *)sv.sival_ptr;
-    pTimer->pCallback(pTimer, pTimer->pCallbackParam);
+    pthread_mutex_lock(&gTimerWheel.mutex);
+    if (gTimerWheel.threadRunning) {
+        gTimerWheel.stop = true;
+        timerWheelArm();
+        pthread_mutex_unlock(&gTimerWheel.mutex);
+        if (!pthread_equal(pthread_self(), gTimerWheel.thread)) {
+            pthread_join(gTimerWheel.thread, NULL);
+        } else {
+            pthread_detach(gTimerWheel.thread);
+        }
+        pthread_mutex_lock(&gTimerWheel.mutex);
+        gTimerWheel.threadRunning = false;
+    }
+    pthread_mutex_unlock(&gTimerWheel.mutex);
 }
 
 // Read from a queue if an event is available.
@@ -376,6 +643,7 @@ void uPortOsPrivateDeinit(void)
         MTX_FN(uPortMutexDelete(gMutexTimer));
         gMutexTimer = NULL;
     }
+    timerWheelStop();
 
     if (gMutexThread != NULL) {
         // Note: cannot tidy away the tasks here,
@@ -887,20 +1155,16 @@ int32_t uPortTimerCreate(uPortTimerHandle_t *pTimerHandle,
         errorCode = U_ERROR_COMMON_NO_MEMORY;
         uPortTimer_t *pTimer = pUPortMalloc(sizeof(uPortTimer_t));
         if (pTimer != NULL) {
-            errorCode = U_ERROR_COMMON_PLATFORM;
-            struct sigevent sev = {0};
-            sev.sigev_notify = SIGEV_THREAD;
-            sev.sigev_notify_function = timerCallback;
-            sev.sigev_value.sival_ptr = (void *)pTimer;
+            memset(pTimer, 0, sizeof(*pTimer));
             pTimer->periodic = periodic;
             pTimer->pCallback = pCallback;
             pTimer->pCallbackParam = pCallbackParam;
-            msToTimeSpec((int32_t)intervalMs, &(pTimer->timerSpec.it_value), false);
-            msToTimeSpec(pTimer->periodic ? (int32_t)intervalMs : 0,
-                         &(pTimer->timerSpec.it_interval), false);
-            if (timer_create(CLOCK_REALTIME, &sev, &(pTimer->timerId)) == 0) {
+            pTimer->intervalMs = intervalMs;
+            pthread_mutex_lock(&gTimerWheel.mutex);
+            errorCode = timerWheelStart();
+            pthread_mutex_unlock(&gTimerWheel.mutex);
+            if (errorCode == U_ERROR_COMMON_SUCCESS) {
                 *pTimerHandle = (uPortTimerHandle_t *)pTimer;
-                errorCode = U_ERROR_COMMON_SUCCESS;
                 U_ATOMIC_INCREMENT(&gResourceAllocCount);
                 U_PORT_OS_DEBUG_PRINT_TIMER_CREATE(*pTimerHandle, pName, intervalMs, periodic);
             } else {
@@ -916,14 +1180,23 @@ int32_t uPortTimerDelete(const uPortTimerHandle_t timerHandle)
 {
     uErrorCode_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
     if (timerHandle != NULL) {
-        errorCode = U_ERROR_COMMON_PLATFORM;
         uPortTimer_t *pTimer = (uPortTimer_t *)timerHandle;
-        if (timer_delete(pTimer->timerId) == 0) {
-            uPortFree(pTimer);
-            errorCode = U_ERROR_COMMON_SUCCESS;
-            U_ATOMIC_DECREMENT(&gResourceAllocCount);
-            U_PORT_OS_DEBUG_PRINT_TIMER_DELETE(timerHandle);
+        pthread_mutex_lock(&gTimerWheel.mutex);
+        timerWheelRemove(pTimer);
+        // Don't free the timer from under its own callback,
+        // unless that is where we're being called from
+        while ((gTimerWheel.pRunning == pTimer) &&
+               !pthread_equal(pthread_self(), gTimerWheel.thread)) {
+            pthread_mutex_unlock(&gTimerWheel.mutex);
+            uPortTaskBlock(U_PORT_TIMER_WHEEL_TICK_MS);
+            pthread_mutex_lock(&gTimerWheel.mutex);
         }
+        timerWheelArm();
+        pthread_mutex_unlock(&gTimerWheel.mutex);
+        uPortFree(pTimer);
+        errorCode = U_ERROR_COMMON_SUCCESS;
+        U_ATOMIC_DECREMENT(&gResourceAllocCount);
+        U_PORT_OS_DEBUG_PRINT_TIMER_DELETE(timerHandle);
     }
     return (int32_t)errorCode;
 }
@@ -933,11 +1206,34 @@ int32_t uPortTimerStart(const uPortTimerHandle_t timerHandle)
 {
     uErrorCode_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
     if (timerHandle != NULL) {
-        errorCode = U_ERROR_COMMON_PLATFORM;
         uPortTimer_t *pTimer = (uPortTimer_t *)timerHandle;
-        if (timer_settime(pTimer->timerId, 0, &(pTimer->timerSpec), NULL) == 0) {
-            errorCode = U_ERROR_COMMON_SUCCESS;
+        pthread_mutex_lock(&gTimerWheel.mutex);
+        errorCode = timerWheelStart();
+        if (errorCode == U_ERROR_COMMON_SUCCESS) {
+            timerWheelRemove(pTimer);
+            // As with a Posix timer, a zero interval leaves
+            // the timer stopped
+            if (pTimer->intervalMs > 0) {
+                if ((gTimerWheel.numTimers == 0) && (gTimerWheel.pRunning == NULL)) {
+                    // The service thread lets the wheel stand
+                    // still while it is empty: bring it up to date
+                    // so that it doesn't have to step through the
+                    // ticks that have passed
+                    uint64_t tickNow = timerWheelTickNow();
+                    if (tickNow > gTimerWheel.tick) {
+                        gTimerWheel.tick = tickNow;
+                    }
+                }
+                pTimer->periodTicks = (pTimer->intervalMs + U_PORT_TIMER_WHEEL_TICK_MS - 1) /
+                                      U_PORT_TIMER_WHEEL_TICK_MS;
+                // Plus one since we may be part way through the
+                // current tick and a timer must never expire early
+                pTimer->expiryTick = timerWheelTickNow() + 1 + pTimer->periodTicks;
+                timerWheelAdd(pTimer);
+            }
+            timerWheelArm();
         }
+        pthread_mutex_unlock(&gTimerWheel.mutex);
     }
     return (int32_t)errorCode;
 }
@@ -947,13 +1243,11 @@ int32_t uPortTimerStop(const uPortTimerHandle_t timerHandle)
 {
     uErrorCode_t errorCode = U_ERROR_COMMON_INVALID_PARAMETER;
     if (timerHandle != NULL) {
-        errorCode = U_ERROR_COMMON_PLATFORM;
+        errorCode = U_ERROR_COMMON_SUCCESS;
         uPortTimer_t *pTimer = (uPortTimer_t *)timerHandle;
-        struct itimerspec its;
-        memset(&its, 0, sizeof(its));
-        if (timer_settime(pTimer->timerId, 0, &its, NULL) == 0) {
-            errorCode = U_ERROR_COMMON_SUCCESS;
-        }
+        pthread_mutex_lock(&gTimerWheel.mutex);
+        timerWheelRemove(pTimer);
+        pthread_mutex_unlock(&gTimerWheel.mutex);
     }
     return (int32_t)errorCode;
 }
@@ -966,9 +1260,10 @@ int32_t uPortTimerChange(const uPortTimerHandle_t timerHandle,
     if (timerHandle != NULL) {
         errorCode = U_ERROR_COMMON_SUCCESS;
         uPortTimer_t *pTimer = (uPortTimer_t *)timerHandle;
-        msToTimeSpec((int32_t)intervalMs, &(pTimer->timerSpec.it_value), false);
-        msToTimeSpec(pTimer->periodic ? (int32_t)intervalMs : 0,
-                     &(pTimer->timerSpec.it_interval), false);
+        // As before, takes effect when the timer is next started
+        pthread_mutex_lock(&gTimerWheel.mutex);
+        pTimer->intervalMs = intervalMs;
+        pthread_mutex_unlock(&gTimerWheel.mutex);
     }
     return (int32_t)errorCode;
 }
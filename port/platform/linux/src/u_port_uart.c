@@ -31,10 +31,14 @@
 #include "fcntl.h"
 #include "termios.h"
 #include "unistd.h"
-#include "sys/select.h"
+#include "sys/epoll.h"
+#include "sys/eventfd.h"
 #include "pthread.h"  // threadId
 #include "sys/ioctl.h"
 #include "sys/param.h"
+#ifdef U_CFG_PORT_UART_LOW_LATENCY
+# include "linux/serial.h" // struct serial_struct, ASYNC_LOW_LATENCY
+#endif
 #include "u_error_common.h"
 #include "u_linked_list.h"
 
@@ -60,6 +64,28 @@
 # define U_PORT_UART_READ_WAIT_MS 10
 #endif
 
+#ifndef U_PORT_UART_VMIN
+/** The VMIN termios setting: the read task only reads from the
+ * UART when epoll has indicated that there is something to read,
+ * so there is no need for a minimum.
+ */
+# define U_PORT_UART_VMIN 0
+#endif
+
+#ifndef U_PORT_UART_VTIME
+# ifdef U_CFG_PORT_UART_LOW_LATENCY
+/** The VTIME termios setting, in tenths of a second: zero in the
+ * low latency case so that read() returns whatever has arrived
+ * immediately.
+ */
+#  define U_PORT_UART_VTIME 0
+# else
+/** The VTIME termios setting, in tenths of a second.
+ */
+#  define U_PORT_UART_VTIME 1
+# endif
+#endif
+
 #ifndef U_PORT_UART_START_STOP_WAIT_MS
 /** How long to wait for a UART, mostly the read task, to start up
  * and shut down.
@@ -83,6 +109,10 @@ typedef struct uPortUartData_t {
     size_t readPos;
     size_t writePos;
     bool bufferFull;
+    int eventFd;    /**< signalled by uPortUartRead() when it frees
+                         space in a full buffer. */
+    int epollFd;    /**< the read task waits on this for either
+                         received data or eventFd. */
     bool hwHandshake;
     bool handshakeSuspended;
     int32_t eventQueueHandle;
@@ -145,76 +175,111 @@ static void eventHandler(void *pParam, size_t paramLength)
     }
 }
 
-// Task handling incoming uart data
+// Set whether the read task is waiting on the UART or not;
+// when the buffer is full, or the UART has hung up, it only
+// waits on the event file descriptor, so that it sleeps until
+// uPortUartRead() frees some space.  The UART is taken out of
+// the epoll set rather than left in it with no events since
+// epoll always reports EPOLLHUP/EPOLLERR, which would otherwise
+// have the read task spinning, e.g. when a USB-serial adapter
+// is unplugged.
+static void readTaskWaitOnUart(uPortUartData_t *p, bool *pWaitOnUart,
+                               bool waitOnUart)
+{
+    struct epoll_event event = {0};
+
+    if (*pWaitOnUart != waitOnUart) {
+        event.events = EPOLLIN;
+        event.data.fd = p->uartFd;
+        epoll_ctl(p->epollFd, waitOnUart ? EPOLL_CTL_ADD : EPOLL_CTL_DEL,
+                  p->uartFd, &event);
+        *pWaitOnUart = waitOnUart;
+    }
+}
+
+// Task handling incoming uart data: blocks on epoll until either
+// data arrives or a full buffer is emptied by uPortUartRead().
 static void readTask(void *pParam)
 {
     uPortUartData_t *p = (uPortUartData_t *)pParam;
-    // Need a brief pause before calling select after open.
-    uPortTaskBlock(10);
+    struct epoll_event events[2];
+    bool waitOnUart = true;
+    bool hungUp = false;
+    uint64_t eventCount;
+    size_t space;
+    ssize_t cnt;
+    int numEvents;
+
     while (!p->markedForDeletion) {
-        // Initiate a set for select operation.
-        fd_set set;
-        FD_ZERO(&set);
-        FD_SET(p->uartFd, &set);
-        // Select timeout
-        struct timeval tv = {0};
-        tv.tv_usec = U_CFG_OS_YIELD_MS * 1000;
-        // Wait for input
-        int res = select(p->uartFd + 1, &set, NULL, NULL, &tv);
-        if (res > 0) {
-            // Input is available.
-            int available;
-            do {
-                available = 0;
-                ioctl(p->uartFd, FIONREAD, &available);
-                size_t cnt = 0;
-                size_t tot = 0;
-                // Sample readPos
-                size_t readPos = p->readPos;
-                U_PORT_MUTEX_LOCK(p->mutex);
-                if (p->writePos >= readPos) {
-                    // Write pos ahead of read. Use the remaining area in the
-                    // buffer first.
-                    cnt = MIN(available, p->bufferSize - p->writePos);
-                    cnt = read(p->uartFd, p->pBuffer + p->writePos, cnt);
-                    if (cnt > 0) {
-                        available -= cnt;
-                        p->writePos = (p->writePos + cnt) % p->bufferSize;
-                    }
-                    tot = cnt;
-                }
-                if ((available > 0) && (p->writePos < readPos)) {
-                    // Read pos ahead of write.
-                    cnt = MIN(available, readPos - p->writePos);
-                    cnt = read(p->uartFd, p->pBuffer + p->writePos, cnt);
-                    if (cnt > 0) {
-                        available -= cnt;
-                        p->writePos = (p->writePos + cnt) % p->bufferSize;
-                        // We might have filled up the buffer, in which case we must wait below.
-                        p->bufferFull = p->writePos == readPos;
-                    }
-                    tot += cnt;
+        // Work out how much contiguous space there is; only this
+        // task moves writePos and uPortUartRead() never touches
+        // the space between writePos and readPos, so the data
+        // can be read into it without holding the mutex
+        U_PORT_MUTEX_LOCK(p->mutex);
+        if (p->bufferFull) {
+            space = 0;
+        } else if (p->writePos >= p->readPos) {
+            space = p->bufferSize - p->writePos;
+        } else {
+            space = p->readPos - p->writePos;
+        }
+        U_PORT_MUTEX_UNLOCK(p->mutex);
+        readTaskWaitOnUart(p, &waitOnUart, (space > 0) && !hungUp);
+        numEvents = epoll_wait(p->epollFd, events, sizeof(events) / sizeof(events[0]), -1);
+        for (int x = 0; x < numEvents; x++) {
+            if (events[x].data.fd == p->eventFd) {
+                // Just clear it, the loop will re-evaluate the space
+                cnt = read(p->eventFd, &eventCount, sizeof(eventCount));
+            } else if (events[x].data.fd == p->uartFd) {
+                if ((events[x].events & (EPOLLHUP | EPOLLERR)) != 0) {
+                    // The UART has gone away: there is nothing more
+                    // to wait for from it, so stop waiting on it
+                    hungUp = true;
                 }
-                U_PORT_MUTEX_UNLOCK(p->mutex);
-                if ((tot > 0) &&
-                    (p->eventQueueHandle >= 0)) {
-                    // Call the user callback
-                    uPortUartEvent_t event;
-                    event.uartHandle = p->uartFd;
-                    event.eventBitMap = U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED;
-                    event.pEventCallback = p->pEventCallback;
-                    event.pEventCallbackParam = p->pEventCallbackParam;
-                    uPortEventQueueSend(p->eventQueueHandle, &event, sizeof(event));
+                cnt = 0;
+                if (space > 0) {
+                    cnt = read(p->uartFd, p->pBuffer + p->writePos, space);
                 }
-                while (p->bufferFull && !p->markedForDeletion) {
-                    // Buffer is full, wait for consumption.
-                    uPortTaskBlock(U_PORT_UART_READ_WAIT_MS);
+                if (cnt > 0) {
+                    U_PORT_MUTEX_LOCK(p->mutex);
+                    p->writePos = (p->writePos + cnt) % p->bufferSize;
+                    p->bufferFull = (p->writePos == p->readPos);
+                    U_PORT_MUTEX_UNLOCK(p->mutex);
+                    if (p->eventQueueHandle >= 0) {
+                        // Call the user callback
+                        uPortUartEvent_t event;
+                        event.uartHandle = p->uartFd;
+                        event.eventBitMap = U_PORT_UART_EVENT_BITMASK_DATA_RECEIVED;
+                        event.pEventCallback = p->pEventCallback;
+                        event.pEventCallbackParam = p->pEventCallbackParam;
+                        // Coalesce with any event that is still waiting
+                        // so that a burst of data doesn't flood the queue
+                        uPortEventQueueSendCoalesce(p->eventQueueHandle, &event,
+                                                    sizeof(event), p->uartFd,
+                                                    offsetof(uPortUartEvent_t, eventBitMap));
+                    }
                 }
-            } while ((available > 0) && !p->markedForDeletion);
+            }
         }
     }
 }
 
+#ifdef U_CFG_PORT_UART_LOW_LATENCY
+// Ask the serial driver to pass on received data without delay;
+// for USB-serial adapters this typically reduces the latency
+// timer of the adapter to its minimum.  Not all drivers support
+// this, hence failure is ignored.
+static void setLowLatency(int uartFd)
+{
+    struct serial_struct serial;
+
+    if (ioctl(uartFd, TIOCGSERIAL, &serial) == 0) {
+        serial.flags |= ASYNC_LOW_LATENCY;
+        ioctl(uartFd, TIOCSSERIAL, &serial);
+    }
+}
+#endif
+
 static uPortUartPrefix_t *pFindPrefix(pthread_t threadId)
 {
     uLinkedList_t *p = gpUartPrefixList;
@@ -267,6 +332,12 @@ static void disposeUartData(uPortUartData_t *p)
         if (p->eventQueueHandle >= 0) {
             uPortEventQueueClose(p->eventQueueHandle);
         }
+        if (p->epollFd >= 0) {
+            close(p->epollFd);
+        }
+        if (p->eventFd >= 0) {
+            close(p->eventFd);
+        }
         if (p->uartFd >= 0) {
             close(p->uartFd);
         }
@@ -425,6 +496,8 @@ int32_t uPortUartOpen(int32_t uart, int32_t baudRate,
     }
     memset(pUartData, 0, sizeof(uPortUartData_t));
     pUartData->uartFd = -1;
+    pUartData->eventFd = -1;
+    pUartData->epollFd = -1;
     pUartData->id = -1;
     pUartData->eventQueueHandle = -1;
     if ((pinTx >= 0) || (pinRx >= 0)) {
@@ -481,14 +554,36 @@ int32_t uPortUartOpen(int32_t uart, int32_t baudRate,
     } else {
         options.c_cflag &= ~CRTSCTS;
     }
-    // Set timed read with 100 ms timeout
-    options.c_cc[VMIN] = 0;
-    options.c_cc[VTIME] = 1;
+    // Set timed read; the read task only reads when epoll has
+    // indicated that there is data so this rarely matters
+    options.c_cc[VMIN] = U_PORT_UART_VMIN;
+    options.c_cc[VTIME] = U_PORT_UART_VTIME;
     if (tcsetattr(pUartData->uartFd, TCSANOW, &options) == 0) {
         tcflush(pUartData->uartFd, TCIOFLUSH);
     } else {
         FAIL(U_ERROR_COMMON_PLATFORM);
     }
+#ifdef U_CFG_PORT_UART_LOW_LATENCY
+    setLowLatency(pUartData->uartFd);
+#endif
+    // Set up epoll for the read task to wait on the UART and
+    // on an event which uPortUartRead() signals to say that
+    // space has been freed
+    pUartData->eventFd = eventfd(0, EFD_NONBLOCK);
+    pUartData->epollFd = epoll_create1(0);
+    if ((pUartData->eventFd < 0) || (pUartData->epollFd < 0)) {
+        FAIL(U_ERROR_COMMON_PLATFORM);
+    }
+    struct epoll_event event = {0};
+    event.events = EPOLLIN;
+    event.data.fd = pUartData->uartFd;
+    if (epoll_ctl(pUartData->epollFd, EPOLL_CTL_ADD, pUartData->uartFd, &event) != 0) {
+        FAIL(U_ERROR_COMMON_PLATFORM);
+    }
+    event.data.fd = pUartData->eventFd;
+    if (epoll_ctl(pUartData->epollFd, EPOLL_CTL_ADD, pUartData->eventFd, &event) != 0) {
+        FAIL(U_ERROR_COMMON_PLATFORM);
+    }
 
     if (pReceiveBuffer == NULL) {
         pUartData->pBuffer = pUPortMalloc(bufferSize);
@@ -611,8 +706,15 @@ int32_t uPortUartRead(int32_t handle, void *pBuffer,
                 }
             }
             if (pUartData->bufferFull && (sizeOrErrorCode > 0)) {
-                // Release possible waiting read task.
+                // Wake up the read task, which will be waiting
+                // for space
                 pUartData->bufferFull = false;
+                // Nothing can be done if this fails, which would only
+                // happen if the count were already huge, in which case
+                // the read task is awake anyway
+                uint64_t eventCount = 1;
+                ssize_t written = write(pUartData->eventFd, &eventCount, sizeof(eventCount));
+                (void) written;
             }
             U_PORT_MUTEX_UNLOCK(pUartData->mutex);
         }
@@ -312,6 +312,13 @@
  * TYPES
  * -------------------------------------------------------------- */
 
+/** Parameter block for testing event coalescing.
+ */
+typedef struct {
+    int32_t key;
+    uint32_t bitMap;
+} uPortTestEventCoalesce_t;
+
 #if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B < 0)
 
 /** Type to hold the stuff that the UART test task needs to know
@@ -395,6 +402,15 @@ static int32_t gEventQueueMinErrorFlag;
 // Counter for event queue callback min length
 static int32_t gEventQueueMinCounter;
 
+// The events received by the event queue coalesce callback.
+static uPortTestEventCoalesce_t gEventQueueCoalesceReceived[4];
+
+// Counter for the event queue coalesce callback.
+static volatile int32_t gEventQueueCoalesceCounter;
+
+// Flag to release the event queue coalesce callback.
+static volatile bool gEventQueueCoalesceGo;
+
 #if (U_CFG_TEST_UART_A >= 0) && (U_CFG_TEST_UART_B < 0)
 
 // The data to send during UART testing.
@@ -483,6 +499,24 @@ static size_t gTimerParameterIndex = 0;
  */
 static uPortTimerHandle_t gTimerHandle[4] = {0};
 
+#ifdef __linux__
+/** Timer handles for the timer wheel test; the last timer, which
+ * deletes itself, is long enough to be cascaded down through
+ * more than one level of the wheel.
+ */
+static uPortTimerHandle_t gTimerWheelHandle[65] = {0};
+
+/** The time at which each of the timers of the timer wheel
+ * test expired.
+ */
+static int32_t gTimerWheelExpiryMs[65] = {0};
+
+/** The number of times that each of the timers of the timer wheel
+ * test expired.
+ */
+static int32_t gTimerWheelCount[65] = {0};
+#endif
+
 /** A variable to use during critical section, heap
  * and GPIO interrupt testing.
  */
@@ -837,6 +871,23 @@ static void eventQueueMaxFunction(void *pParam,
     gEventQueueMaxCounter++;
 }
 
+// Event queue function for testing coalescing: blocks on the first
+// event until released so that further events pile up.
+static void eventQueueCoalesceFunction(void *pParam,
+                                       size_t paramLength)
+{
+    if ((paramLength == sizeof(uPortTestEventCoalesce_t)) &&
+        (gEventQueueCoalesceCounter < (int32_t) (sizeof(gEventQueueCoalesceReceived) /
+                                                 sizeof(gEventQueueCoalesceReceived[0])))) {
+        memcpy(&(gEventQueueCoalesceReceived[gEventQueueCoalesceCounter]),
+               pParam, sizeof(uPortTestEventCoalesce_t));
+    }
+    gEventQueueCoalesceCounter++;
+    while (!gEventQueueCoalesceGo) {
+        uPortTaskBlock(10);
+    }
+}
+
 // Event queue function for minimum length parameter.
 //lint -esym(818, pParam) Suppress "could be const"
 // since this has to match the function signature
@@ -1235,6 +1286,26 @@ static void timerCallback(const uPortTimerHandle_t timerHandle, void *pParameter
     }
 }
 
+#ifdef __linux__
+// Timer callback for the timer wheel test: record when the
+// timer expired and, for the last one, delete the timer
+// from its own callback.
+static void timerWheelCallback(const uPortTimerHandle_t timerHandle, void *pParameter)
+{
+    //lint -e(507) Suppress size incompatibility, we know what we're doing
+    int32_t parameter = U_PTR_TO_INT32(pParameter);
+
+    if ((parameter >= 0) &&
+        (parameter < (int32_t) (sizeof(gTimerWheelExpiryMs) / sizeof(gTimerWheelExpiryMs[0])))) {
+        gTimerWheelExpiryMs[parameter] = uPortGetTickTimeMs();
+        gTimerWheelCount[parameter]++;
+        if (parameter == (int32_t) (sizeof(gTimerWheelExpiryMs) / sizeof(gTimerWheelExpiryMs[0])) - 1) {
+            uPortTimerDelete(timerHandle);
+        }
+    }
+}
+#endif
+
 // The test task for critical sections: if it can lock
 // gMutex it increments the uint32_t variable it was passed
 // in pParameter in a loop, else it exits
@@ -2160,6 +2231,108 @@ U_PORT_TEST_FUNCTION("[port]", "portEventQueue")
     U_PORT_TEST_ASSERT(resourceCount <= 0);
 }
 
+/** Test coalescing of events on an event queue.
+ */
+U_PORT_TEST_FUNCTION("[port]", "portEventQueueCoalesce")
+{
+    int32_t handle;
+    uPortTestEventCoalesce_t event;
+    int32_t resourceCount;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+    resourceCount = uTestUtilGetDynamicResourceCount();
+
+    gEventQueueCoalesceCounter = 0;
+    gEventQueueCoalesceGo = false;
+    memset(gEventQueueCoalesceReceived, 0, sizeof(gEventQueueCoalesceReceived));
+
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_TEST_PRINT_LINE("testing event coalescing.");
+    handle = uPortEventQueueOpen(eventQueueCoalesceFunction, "coalesce",
+                                 sizeof(event),
+                                 U_PORT_EVENT_QUEUE_MIN_TASK_STACK_SIZE_BYTES,
+                                 U_CFG_TEST_OS_TASK_PRIORITY,
+                                 U_PORT_TEST_QUEUE_LENGTH);
+    U_PORT_TEST_ASSERT(handle >= 0);
+    U_PORT_TEST_ASSERT(uPortEventQueueGetNumCoalesced(handle) == 0);
+
+    // Bad parameters: no room for the bit-map
+    event.key = 1;
+    event.bitMap = 0x01;
+    U_PORT_TEST_ASSERT(uPortEventQueueSendCoalesce(handle, &event, sizeof(event), event.key,
+                                                   sizeof(event)) < 0);
+    U_PORT_TEST_ASSERT(uPortEventQueueSendCoalesce(handle, NULL, 0, event.key, 0) < 0);
+
+    // Send one event and wait for the callback to be stuck on it
+    U_PORT_TEST_ASSERT(uPortEventQueueSendCoalesce(handle, &event, sizeof(event), event.key,
+                                                   offsetof(uPortTestEventCoalesce_t, bitMap)) == 0);
+    for (size_t x = 0; (x < 100) && (gEventQueueCoalesceCounter == 0); x++) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gEventQueueCoalesceCounter == 1);
+
+    // Now send events for two keys, some of which should be coalesced
+    event.bitMap = 0x02;
+    U_PORT_TEST_ASSERT(uPortEventQueueSendCoalesce(handle, &event, sizeof(event), event.key,
+                                                   offsetof(uPortTestEventCoalesce_t, bitMap)) == 0);
+    event.bitMap = 0x04;
+    U_PORT_TEST_ASSERT(uPortEventQueueSendCoalesce(handle, &event, sizeof(event), event.key,
+                                                   offsetof(uPortTestEventCoalesce_t, bitMap)) == 0);
+    event.key = 2;
+    event.bitMap = 0x08;
+    U_PORT_TEST_ASSERT(uPortEventQueueSendCoalesce(handle, &event, sizeof(event), event.key,
+                                                   offsetof(uPortTestEventCoalesce_t, bitMap)) == 0);
+    event.key = 1;
+    event.bitMap = 0x10;
+    U_PORT_TEST_ASSERT(uPortEventQueueSendCoalesce(handle, &event, sizeof(event), event.key,
+                                                   offsetof(uPortTestEventCoalesce_t, bitMap)) == 0);
+    U_PORT_TEST_ASSERT(uPortEventQueueGetNumCoalesced(handle) == 2);
+
+    // Let them through: we should get just one more event for each key
+    gEventQueueCoalesceGo = true;
+    for (size_t x = 0; (x < 100) && (gEventQueueCoalesceCounter < 3); x++) {
+        uPortTaskBlock(10);
+    }
+    uPortTaskBlock(100);
+    U_TEST_PRINT_LINE("%d event(s) received, %d coalesced.", gEventQueueCoalesceCounter,
+                      uPortEventQueueGetNumCoalesced(handle));
+    U_PORT_TEST_ASSERT(gEventQueueCoalesceCounter == 3);
+    U_PORT_TEST_ASSERT(gEventQueueCoalesceReceived[0].key == 1);
+    U_PORT_TEST_ASSERT(gEventQueueCoalesceReceived[0].bitMap == 0x01);
+    U_PORT_TEST_ASSERT(gEventQueueCoalesceReceived[1].key == 1);
+    U_PORT_TEST_ASSERT(gEventQueueCoalesceReceived[1].bitMap == 0x16);
+    U_PORT_TEST_ASSERT(gEventQueueCoalesceReceived[2].key == 2);
+    U_PORT_TEST_ASSERT(gEventQueueCoalesceReceived[2].bitMap == 0x08);
+
+    // Once the pending event has gone, a new one is sent afresh
+    U_PORT_TEST_ASSERT(uPortEventQueueSendCoalesce(handle, &event, sizeof(event), event.key,
+                                                   offsetof(uPortTestEventCoalesce_t, bitMap)) == 0);
+    for (size_t x = 0; (x < 100) && (gEventQueueCoalesceCounter < 4); x++) {
+        uPortTaskBlock(10);
+    }
+    U_PORT_TEST_ASSERT(gEventQueueCoalesceCounter == 4);
+    U_PORT_TEST_ASSERT(gEventQueueCoalesceReceived[3].bitMap == 0x10);
+    U_PORT_TEST_ASSERT(uPortEventQueueGetNumCoalesced(handle) == 2);
+
+    U_PORT_TEST_ASSERT(uPortEventQueueClose(handle) == 0);
+    U_PORT_TEST_ASSERT(uPortEventQueueGetNumCoalesced(handle) < 0);
+
+    uPortDeinit();
+
+    // Give the RTOS idle task time to tidy-away the tasks
+    uPortTaskBlock(1000);
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+
 /** Test heap API.
  *
  * NOTE: for this to work fully U_ASSERT_HOOK_FUNCTION_TEST_RETURN must be defined.
@@ -3288,6 +3461,84 @@ U_PORT_TEST_FUNCTION("[port]", "portTimers")
     U_PORT_TEST_ASSERT(resourceCount <= 0);
 }
 
+#ifdef __linux__
+/** Test many timers at once, which on Linux are all run from
+ * a single timer wheel.
+ */
+U_PORT_TEST_FUNCTION("[port]", "portTimerWheel")
+{
+    int32_t resourceCount;
+    int32_t startTimeMs;
+    int32_t intervalMs;
+    size_t numTimers = sizeof(gTimerWheelHandle) / sizeof(gTimerWheelHandle[0]);
+    uTimeoutStart_t timeoutStart;
+
+    // Whatever called us likely initialised the
+    // port so deinitialise it here to obtain the
+    // correct initial heap size
+    uPortDeinit();
+
+    resourceCount = uTestUtilGetDynamicResourceCount();
+    U_PORT_TEST_ASSERT(uPortInit() == 0);
+
+    U_TEST_PRINT_LINE("testing %d timers...", numTimers);
+
+    // Create the timers with intervals spread across the bottom
+    // two levels of the wheel, in reverse order, the last one
+    // being beyond those two levels
+    for (size_t x = 0; x < numTimers; x++) {
+        intervalMs = (int32_t) (numTimers - 1 - x) * 7 + 5;
+        if (x == numTimers - 1) {
+            intervalMs = 4500;
+        }
+        U_PORT_TEST_ASSERT(uPortTimerCreate(&gTimerWheelHandle[x], NULL,
+                                            timerWheelCallback, (void *) x,
+                                            (uint32_t) intervalMs, false) == 0);
+    }
+    startTimeMs = uPortGetTickTimeMs();
+    for (size_t x = 0; x < numTimers; x++) {
+        U_PORT_TEST_ASSERT(uPortTimerStart(gTimerWheelHandle[x]) == 0);
+    }
+    timeoutStart = uTimeoutStart();
+    while ((gTimerWheelCount[numTimers - 1] == 0) &&
+           !uTimeoutExpiredSeconds(timeoutStart, 10)) {
+        uPortTaskBlock(100);
+    }
+    // Allow time for any extra expiries
+    uPortTaskBlock(100);
+
+    // Each timer should have expired once, no earlier than
+    // it should have and in order; the start loop takes a
+    // little while so allow some slop on the order
+    for (size_t x = 0; x < numTimers; x++) {
+        intervalMs = (int32_t) (numTimers - 1 - x) * 7 + 5;
+        if (x == numTimers - 1) {
+            intervalMs = 4500;
+        }
+        U_PORT_TEST_ASSERT(gTimerWheelCount[x] == 1);
+        U_PORT_TEST_ASSERT(gTimerWheelExpiryMs[x] - startTimeMs >= intervalMs);
+        if ((x > 0) && (x < numTimers - 1)) {
+            U_PORT_TEST_ASSERT(gTimerWheelExpiryMs[x] - gTimerWheelExpiryMs[x - 1] <= 2);
+        }
+    }
+    U_TEST_PRINT_LINE("the longest timer expired after %d ms.",
+                      gTimerWheelExpiryMs[numTimers - 1] - startTimeMs);
+
+    // The last timer deleted itself, delete the rest
+    for (size_t x = 0; x < numTimers - 1; x++) {
+        U_PORT_TEST_ASSERT(uPortTimerDelete(gTimerWheelHandle[x]) == 0);
+    }
+
+    uPortDeinit();
+
+    // Check for resource leaks
+    uTestUtilResourceCheck(U_TEST_PREFIX, NULL, true);
+    resourceCount = uTestUtilGetDynamicResourceCount() - resourceCount;
+    U_TEST_PRINT_LINE("we have leaked %d resources(s).", resourceCount);
+    U_PORT_TEST_ASSERT(resourceCount <= 0);
+}
+#endif
+
 /** Test critical sections.
  */
 U_PORT_TEST_FUNCTION("[port]", "portCriticalSection")
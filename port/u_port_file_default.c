@@ -0,0 +1,85 @@
+/*
+ * Copyright 2024 u-blox
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/** @file
+ * @brief Default (empty) Implementation of file access.
+ */
+
+#include "stddef.h" // NULL, size_t etc.
+#include "stdint.h" // int32_t etc.
+#include "stdbool.h"
+
+#include "u_compiler.h" // U_WEAK
+#include "u_error_common.h"
+#include "u_port_file.h"
+
+/* ----------------------------------------------------------------
+ * COMPILE-TIME MACROS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * TYPES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * VARIABLES
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * STATIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+/* ----------------------------------------------------------------
+ * PUBLIC FUNCTIONS
+ * -------------------------------------------------------------- */
+
+U_WEAK int32_t uPortFileOpenWrite(uPortFileHandle_t *pFileHandle, const char *pName)
+{
+    (void)pFileHandle;
+    (void)pName;
+    return (int32_t)U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
+U_WEAK int32_t uPortFileWrite(uPortFileHandle_t fileHandle, const char *pData,
+                              size_t size)
+{
+    (void)fileHandle;
+    (void)pData;
+    (void)size;
+    return (int32_t)U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
+U_WEAK int32_t uPortFileClose(uPortFileHandle_t fileHandle)
+{
+    (void)fileHandle;
+    return (int32_t)U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
+U_WEAK int32_t uPortFileMap(const char *pName, const char **ppData, size_t *pSize)
+{
+    (void)pName;
+    (void)ppData;
+    (void)pSize;
+    return (int32_t)U_ERROR_COMMON_NOT_SUPPORTED;
+}
+
+U_WEAK int32_t uPortFileUnmap(const char *pData, size_t size)
+{
+    (void)pData;
+    (void)size;
+    return (int32_t)U_ERROR_COMMON_NOT_SUPPORTED;
+}
+// End of file
@@ -180,6 +180,9 @@ list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/port/u_port_spi_default.c)
 # Default implementation for uPortNamePipeXxx()
 list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/port/u_port_named_pipe_default.c)
 
+# Default implementation for uPortFileXxx()
+list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/port/u_port_file_default.c)
+
 # Default uPortPppAttach()/uPortPppDetach() implementation
 list(APPEND UBXLIB_SRC ${UBXLIB_BASE}/port/u_port_ppp_default.c)
 
@@ -82,6 +82,9 @@ SRC_LIST += ${UBXLIB_BASE}/port/u_port_spi_default.c
 # Default implementation for uPortNamePipeXxx()
 SRC_LIST += ${UBXLIB_BASE}/port/u_port_named_pipe_default.c
 
+# Default implementation for uPortFileXxx()
+SRC_LIST += ${UBXLIB_BASE}/port/u_port_file_default.c
+
 # Default uPortPppAttach()/uPortPppDetach() implementation
 SRC_LIST += ${UBXLIB_BASE}/port/u_port_ppp_default.c
 
@@ -89,6 +89,7 @@
 #include <u_ringbuffer.h>
 #include <u_linked_list.h>
 #include <u_time.h>
+#include <u_crc.h>
 #include <u_debug_utils.h>
 #include <u_at_client.h>
 #include <u_security.h>
@@ -147,8 +148,27 @@
 #include <u_gnss_pwr.h>
 #include <u_gnss_msg.h>
 #include <u_gnss_dec.h>
+#include <u_gnss_capture.h>
 #include <u_gnss_dec_ubx_nav_pvt.h>
 #include <u_gnss_dec_ubx_nav_hpposllh.h>
+#include <u_gnss_dec_ubx_nav_status.h>
+#include <u_gnss_dec_ubx_nav_dop.h>
+#include <u_gnss_dec_ubx_nav_cov.h>
+#include <u_gnss_dec_ubx_nav_sat.h>
+#include <u_gnss_dec_ubx_nav_sig.h>
+#include <u_gnss_dec_ubx_rxm_rawx.h>
+#include <u_gnss_dec_ubx_rxm_sfrbx.h>
+#include <u_gnss_dec_ubx_esf_meas.h>
+#include <u_gnss_dec_ubx_esf_ins.h>
+#include <u_gnss_dec_ubx_tim_tp.h>
+#include <u_gnss_dec_ubx_mon_rf.h>
+#include <u_gnss_dec_nmea_gga.h>
+#include <u_gnss_dec_nmea_rmc.h>
+#include <u_gnss_dec_nmea_gsa.h>
+#include <u_gnss_dec_nmea_gsv.h>
+#include <u_gnss_dec_nmea_vtg.h>
+#include <u_gnss_dec_nmea_gst.h>
+#include <u_gnss_dec_nmea_zda.h>
 #include <u_gnss_mga.h>
 #include <u_gnss_geofence.h>
 #include <u_gnss_util.h>